@@ -0,0 +1,165 @@
+/**
+ * @file AudioCapture.cpp
+ * @brief Implementation of the capture ring and sector-aligned block writer
+ */
+
+#include "AudioCapture.h"
+#include <assert.h>
+#include <string.h>
+
+namespace AuditoryCortex
+{
+    /* ========================== CaptureRing ========================== */
+
+    CaptureRing::CaptureRing(uint8_t* storage, uint32_t capacity)
+        : m_storage(storage),
+          m_capacity(capacity),
+          m_mask(capacity - 1),
+          m_head(0),
+          m_tail(0),
+          m_overrunEvents(0),
+          m_overrunBytes(0),
+          m_bytesAccepted(0)
+    {
+        // Indices wrap by masking, which only works for a power of two
+        assert(capacity > 0 && (capacity & (capacity - 1)) == 0);
+    }
+
+    void CaptureRing::reset()
+    {
+        m_head.store(0);
+        m_tail.store(0);
+        m_overrunEvents.store(0);
+        m_overrunBytes.store(0);
+        m_bytesAccepted.store(0);
+    }
+
+    uint32_t CaptureRing::available() const
+    {
+        return m_head.load(std::memory_order_acquire) - m_tail.load(std::memory_order_acquire);
+    }
+
+    bool CaptureRing::push(const uint8_t* data, uint32_t length)
+    {
+        uint32_t head = m_head.load(std::memory_order_relaxed);
+        uint32_t tail = m_tail.load(std::memory_order_acquire);
+        if (m_capacity - (head - tail) < length)
+        {
+            m_overrunEvents.fetch_add(1, std::memory_order_relaxed);
+            m_overrunBytes.fetch_add(length, std::memory_order_relaxed);
+            return false;
+        }
+
+        uint32_t offset = head & m_mask;
+        uint32_t first = m_capacity - offset;
+        if (first > length) first = length;
+        memcpy(m_storage + offset, data, first);
+        memcpy(m_storage, data + first, length - first);
+
+        m_head.store(head + length, std::memory_order_release);
+        m_bytesAccepted.fetch_add(length, std::memory_order_relaxed);
+        return true;
+    }
+
+    uint32_t CaptureRing::pop(uint8_t* out, uint32_t length)
+    {
+        uint32_t tail = m_tail.load(std::memory_order_relaxed);
+        uint32_t head = m_head.load(std::memory_order_acquire);
+        uint32_t ready = head - tail;
+        if (length > ready) length = ready;
+
+        uint32_t offset = tail & m_mask;
+        uint32_t first = m_capacity - offset;
+        if (first > length) first = length;
+        memcpy(out, m_storage + offset, first);
+        memcpy(out + first, m_storage, length - first);
+
+        m_tail.store(tail + length, std::memory_order_release);
+        return length;
+    }
+
+    /* ========================== CaptureWriter ========================== */
+
+    CaptureWriter::CaptureWriter(CaptureRing& ring, uint8_t* block, uint32_t blockSize, uint32_t startOffset,
+                                 WriteSink sink, void* sinkContext, MicrosClock clock)
+        : m_ring(ring),
+          m_block(block),
+          m_fill(0),
+          m_sink(sink),
+          m_sinkContext(sinkContext),
+          m_clock(clock),
+          m_firstWriteMicros(0),
+          m_failed(false)
+    {
+        if (blockSize < MIN_BLOCK) blockSize = MIN_BLOCK;
+        if (blockSize > MAX_BLOCK) blockSize = MAX_BLOCK;
+        m_blockSize = blockSize - (blockSize % SECTOR_SIZE);
+
+        // Trim the first block so the second one starts on a sector boundary
+        uint32_t misalignment = startOffset % SECTOR_SIZE;
+        m_nextWriteSize = misalignment ? m_blockSize - misalignment : m_blockSize;
+
+        memset(&m_stats, 0, sizeof(m_stats));
+    }
+
+    bool CaptureWriter::writeBlock(uint32_t length)
+    {
+        if (length == 0) return true;
+
+        uint32_t start = m_clock ? m_clock() : 0;
+        size_t written = m_sink(m_sinkContext, m_block, length);
+        uint32_t end = m_clock ? m_clock() : 0;
+
+        uint32_t duration = end - start;
+        if (m_stats.writeCount == 0) m_firstWriteMicros = start;
+        m_stats.writeCount++;
+        m_stats.totalWriteMicros += duration;
+        if (duration > m_stats.maxWriteMicros) m_stats.maxWriteMicros = duration;
+        m_stats.bytesWritten += written;
+        m_stats.elapsedMicros = end - m_firstWriteMicros;
+
+        if (written != length)
+        {
+            m_failed = true;
+            return false;
+        }
+        return true;
+    }
+
+    bool CaptureWriter::pump()
+    {
+        while (!m_failed)
+        {
+            uint32_t wanted = m_nextWriteSize - m_fill;
+            if (m_ring.available() < wanted) break;
+
+            m_fill += m_ring.pop(m_block + m_fill, wanted);
+            if (!writeBlock(m_fill)) return false;
+            m_fill = 0;
+            m_nextWriteSize = m_blockSize;
+        }
+        return !m_failed;
+    }
+
+    bool CaptureWriter::finish()
+    {
+        if (!pump()) return false;
+
+        // Whatever is left is less than one block
+        m_fill += m_ring.pop(m_block + m_fill, m_nextWriteSize - m_fill);
+        bool ok = writeBlock(m_fill);
+        m_fill = 0;
+        return ok;
+    }
+
+    CaptureStats CaptureWriter::stats() const
+    {
+        CaptureStats snapshot = m_stats;
+        snapshot.bytesCaptured = m_ring.bytesAccepted();
+        snapshot.overrunEvents = m_ring.overrunEvents();
+        snapshot.overrunBytes = m_ring.overrunBytes();
+        snapshot.sustainedMBps = snapshot.elapsedMicros > 0 ?
+            static_cast<float>(snapshot.bytesWritten) / static_cast<float>(snapshot.elapsedMicros) : 0.0f;
+        return snapshot;
+    }
+}
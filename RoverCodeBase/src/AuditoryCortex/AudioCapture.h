@@ -0,0 +1,142 @@
+/**
+ * @brief AudioCapture moves microphone samples from I2S DMA to storage
+ *
+ * Split into two platform-free pieces so the hot path can be checked on host:
+ * - CaptureRing: lock-free single-producer/single-consumer byte ring filled
+ *   by the capture task and drained by the writer task
+ * - CaptureWriter: gathers ring data into fixed blocks and hands them to a
+ *   sink, keeping every write after the WAV header sector-aligned
+ *
+ * Overruns are counted rather than blocking the producer, so a slow card
+ * costs samples, never the I2S DMA chain.
+ */
+
+#ifndef AUDIO_CAPTURE_H
+#define AUDIO_CAPTURE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+namespace AuditoryCortex
+{
+    /**
+     * @brief Recorder health counters, readable from any task
+     */
+    struct CaptureStats
+    {
+        uint32_t bytesCaptured;     // Accepted into the ring
+        uint32_t bytesWritten;      // Handed to the sink
+        uint32_t overrunEvents;     // Producer chunks dropped for lack of space
+        uint32_t overrunBytes;
+        uint32_t writeCount;
+        uint32_t maxWriteMicros;    // Slowest single sink write
+        uint32_t totalWriteMicros;
+        uint32_t elapsedMicros;     // First to last write
+        float sustainedMBps;        // bytesWritten over elapsedMicros
+    };
+
+    class CaptureRing
+    {
+    public:
+        /**
+         * @param storage Caller-owned buffer; capacity must be a power of two
+         */
+        CaptureRing(uint8_t* storage, uint32_t capacity);
+
+        /**
+         * @brief Producer side: copy a chunk in whole or not at all
+         * @return false (and counts an overrun) when the chunk does not fit
+         */
+        bool push(const uint8_t* data, uint32_t length);
+
+        /**
+         * @brief Consumer side: copy out up to length bytes
+         */
+        uint32_t pop(uint8_t* out, uint32_t length);
+
+        uint32_t available() const;
+        uint32_t freeSpace() const { return m_capacity - available(); }
+        uint32_t capacity() const { return m_capacity; }
+        uint32_t overrunEvents() const { return m_overrunEvents.load(std::memory_order_relaxed); }
+        uint32_t overrunBytes() const { return m_overrunBytes.load(std::memory_order_relaxed); }
+        uint32_t bytesAccepted() const { return m_bytesAccepted.load(std::memory_order_relaxed); }
+
+        /**
+         * @brief Reset indices; only while neither side is running
+         */
+        void reset();
+
+    private:
+        uint8_t* m_storage;
+        uint32_t m_capacity;
+        uint32_t m_mask;
+        std::atomic<uint32_t> m_head;   // Total bytes written
+        std::atomic<uint32_t> m_tail;   // Total bytes read
+        std::atomic<uint32_t> m_overrunEvents;
+        std::atomic<uint32_t> m_overrunBytes;
+        std::atomic<uint32_t> m_bytesAccepted;
+    };
+
+    class CaptureWriter
+    {
+    public:
+        static constexpr uint32_t SECTOR_SIZE = 512;
+        static constexpr uint32_t MIN_BLOCK = 4096;
+        static constexpr uint32_t MAX_BLOCK = 16384;
+
+        /**
+         * @brief Storage sink; returns bytes actually written
+         */
+        typedef size_t (*WriteSink)(void* context, const uint8_t* data, size_t length);
+
+        /**
+         * @brief Monotonic microsecond clock (micros() on the rover)
+         */
+        typedef uint32_t (*MicrosClock)();
+
+        /**
+         * @param block Caller-owned staging buffer
+         * @param blockSize Bytes per write, clamped to MIN_BLOCK..MAX_BLOCK and
+         *                  rounded down to whole sectors
+         * @param startOffset File offset of the first sample byte (WAV header size)
+         */
+        CaptureWriter(CaptureRing& ring, uint8_t* block, uint32_t blockSize, uint32_t startOffset,
+                      WriteSink sink, void* sinkContext, MicrosClock clock);
+
+        /**
+         * @brief Write every full block currently available
+         * @return false if the sink reported a short write
+         */
+        bool pump();
+
+        /**
+         * @brief Drain the ring and write the trailing partial block
+         */
+        bool finish();
+
+        uint32_t dataBytes() const { return m_stats.bytesWritten; }
+
+        /**
+         * @brief Snapshot including the ring's overrun counters
+         */
+        CaptureStats stats() const;
+
+    private:
+        CaptureRing& m_ring;
+        uint8_t* m_block;
+        uint32_t m_blockSize;
+        uint32_t m_fill;
+        uint32_t m_nextWriteSize;   // Shortened first block realigns after the header
+        WriteSink m_sink;
+        void* m_sinkContext;
+        MicrosClock m_clock;
+        uint32_t m_firstWriteMicros;
+        bool m_failed;
+        CaptureStats m_stats;
+
+        bool writeBlock(uint32_t length);
+    };
+}
+
+#endif // AUDIO_CAPTURE_H
@@ -0,0 +1,518 @@
+/**
+ * @file AudioCodecs.cpp
+ * @brief Implementation of the IMA-ADPCM / µ-law codecs, decimator and WAV framing
+ */
+
+#include "AudioCodecs.h"
+#include <string.h>
+
+namespace AuditoryCortex
+{
+    /* ========================== µ-law ========================== */
+
+    const uint8_t MuLaw::EXPONENT_TABLE[256] =
+    {
+        0,0,1,1,2,2,2,2,3,3,3,3,3,3,3,3,
+        4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,4,
+        5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+        5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,5,
+        6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+        6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+        6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+        6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,6,
+        7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,
+        7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,
+        7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,
+        7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,
+        7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,
+        7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,
+        7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,
+        7,7,7,7,7,7,7,7,7,7,7,7,7,7,7,7
+    };
+
+    const int16_t MuLaw::DECODE_TABLE[256] =
+    {
+        -32124,-31100,-30076,-29052,-28028,-27004,-25980,-24956,
+        -23932,-22908,-21884,-20860,-19836,-18812,-17788,-16764,
+        -15996,-15484,-14972,-14460,-13948,-13436,-12924,-12412,
+        -11900,-11388,-10876,-10364, -9852, -9340, -8828, -8316,
+         -7932, -7676, -7420, -7164, -6908, -6652, -6396, -6140,
+         -5884, -5628, -5372, -5116, -4860, -4604, -4348, -4092,
+         -3900, -3772, -3644, -3516, -3388, -3260, -3132, -3004,
+         -2876, -2748, -2620, -2492, -2364, -2236, -2108, -1980,
+         -1884, -1820, -1756, -1692, -1628, -1564, -1500, -1436,
+         -1372, -1308, -1244, -1180, -1116, -1052,  -988,  -924,
+          -876,  -844,  -812,  -780,  -748,  -716,  -684,  -652,
+          -620,  -588,  -556,  -524,  -492,  -460,  -428,  -396,
+          -372,  -356,  -340,  -324,  -308,  -292,  -276,  -260,
+          -244,  -228,  -212,  -196,  -180,  -164,  -148,  -132,
+          -120,  -112,  -104,   -96,   -88,   -80,   -72,   -64,
+           -56,   -48,   -40,   -32,   -24,   -16,    -8,     0,
+         32124, 31100, 30076, 29052, 28028, 27004, 25980, 24956,
+         23932, 22908, 21884, 20860, 19836, 18812, 17788, 16764,
+         15996, 15484, 14972, 14460, 13948, 13436, 12924, 12412,
+         11900, 11388, 10876, 10364,  9852,  9340,  8828,  8316,
+          7932,  7676,  7420,  7164,  6908,  6652,  6396,  6140,
+          5884,  5628,  5372,  5116,  4860,  4604,  4348,  4092,
+          3900,  3772,  3644,  3516,  3388,  3260,  3132,  3004,
+          2876,  2748,  2620,  2492,  2364,  2236,  2108,  1980,
+          1884,  1820,  1756,  1692,  1628,  1564,  1500,  1436,
+          1372,  1308,  1244,  1180,  1116,  1052,   988,   924,
+           876,   844,   812,   780,   748,   716,   684,   652,
+           620,   588,   556,   524,   492,   460,   428,   396,
+           372,   356,   340,   324,   308,   292,   276,   260,
+           244,   228,   212,   196,   180,   164,   148,   132,
+           120,   112,   104,    96,    88,    80,    72,    64,
+            56,    48,    40,    32,    24,    16,     8,     0
+    };
+
+    uint8_t MuLaw::encode(int16_t sample)
+    {
+        const int32_t BIAS = 0x84;
+        const int32_t CLIP = 32635;
+
+        int32_t value = sample;
+        uint8_t sign = (value >> 8) & 0x80;
+        if (sign) value = -value;
+        if (value > CLIP) value = CLIP;
+        value += BIAS;
+
+        uint8_t exponent = EXPONENT_TABLE[(value >> 7) & 0xFF];
+        uint8_t mantissa = (value >> (exponent + 3)) & 0x0F;
+        return ~(sign | (exponent << 4) | mantissa);
+    }
+
+    /* ========================== IMA-ADPCM ========================== */
+
+    const int16_t ImaAdpcm::STEP_TABLE[89] =
+    {
+        7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31,
+        34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143,
+        157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658,
+        724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024,
+        3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+        15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+    };
+
+    const int8_t ImaAdpcm::INDEX_TABLE[16] =
+    {
+        -1, -1, -1, -1, 2, 4, 6, 8,
+        -1, -1, -1, -1, 2, 4, 6, 8
+    };
+
+    static inline int32_t clampSample(int32_t value)
+    {
+        return value > 32767 ? 32767 : (value < -32768 ? -32768 : value);
+    }
+
+    static inline uint8_t clampIndex(int32_t index)
+    {
+        return index < 0 ? 0 : (index > 88 ? 88 : index);
+    }
+
+    int16_t ImaAdpcm::decodeSample(uint8_t nibble, AdpcmState& state)
+    {
+        int32_t step = STEP_TABLE[state.index];
+        int32_t delta = step >> 3;
+        if (nibble & 1) delta += step >> 2;
+        if (nibble & 2) delta += step >> 1;
+        if (nibble & 4) delta += step;
+        if (nibble & 8) delta = -delta;
+
+        state.predictor = clampSample(state.predictor + delta);
+        state.index = clampIndex(state.index + INDEX_TABLE[nibble & 0x0F]);
+        return state.predictor;
+    }
+
+    uint8_t ImaAdpcm::encodeSample(int16_t sample, AdpcmState& state)
+    {
+        int32_t step = STEP_TABLE[state.index];
+        int32_t diff = static_cast<int32_t>(sample) - state.predictor;
+        uint8_t nibble = 0;
+        if (diff < 0)
+        {
+            nibble = 8;
+            diff = -diff;
+        }
+        if (diff >= step) { nibble |= 4; diff -= step; }
+        step >>= 1;
+        if (diff >= step) { nibble |= 2; diff -= step; }
+        step >>= 1;
+        if (diff >= step) { nibble |= 1; }
+
+        // Track the decoder exactly so rounding never drifts
+        decodeSample(nibble, state);
+        return nibble;
+    }
+
+    void ImaAdpcm::encodeBlock(const int16_t* samples, AdpcmState& state, uint8_t* block)
+    {
+        // Header: first sample verbatim plus the step index
+        state.predictor = samples[0];
+        block[0] = state.predictor & 0xFF;
+        block[1] = (state.predictor >> 8) & 0xFF;
+        block[2] = state.index;
+        block[3] = 0;
+
+        uint8_t* out = block + 4;
+        for (uint16_t i = 1; i < SAMPLES_PER_BLOCK; i += 2)
+        {
+            uint8_t low = encodeSample(samples[i], state);
+            uint8_t high = encodeSample(samples[i + 1], state);
+            *out++ = low | (high << 4);
+        }
+    }
+
+    size_t ImaAdpcm::decodeBlock(const uint8_t* block, size_t blockBytes, int16_t* out)
+    {
+        if (blockBytes < 4) return 0;
+
+        AdpcmState state;
+        state.predictor = static_cast<int16_t>(block[0] | (block[1] << 8));
+        state.index = clampIndex(block[2]);
+        out[0] = state.predictor;
+
+        size_t written = 1;
+        for (size_t i = 4; i < blockBytes; i++)
+        {
+            out[written++] = decodeSample(block[i] & 0x0F, state);
+            out[written++] = decodeSample(block[i] >> 4, state);
+        }
+        return written;
+    }
+
+    /* ========================== Decimator ========================== */
+
+    // Odd-offset taps of a Hamming-windowed half-band low-pass (Q15, center 16445)
+    static const int32_t HALFBAND_CENTER = 16445;
+    static const int32_t HALFBAND_TAPS[4] = { 9993, -2242, 530, -120 };
+
+    Decimator::Decimator(uint8_t factor)
+    {
+        setFactor(factor);
+    }
+
+    void Decimator::setFactor(uint8_t factor)
+    {
+        m_factor = factor >= 4 ? 4 : (factor >= 2 ? 2 : 1);
+        m_stageCount = m_factor == 4 ? 2 : (m_factor == 2 ? 1 : 0);
+        reset();
+    }
+
+    void Decimator::reset()
+    {
+        memset(m_stages, 0, sizeof(m_stages));
+    }
+
+    bool Decimator::runStage(Stage& stage, int16_t input, int16_t& output)
+    {
+        stage.history[stage.position] = input;
+        stage.position = (stage.position + 1) % TAPS;
+        stage.phase = !stage.phase;
+        if (stage.phase) return false;
+
+        // history[position] is now the oldest sample; center sits 7 back from newest
+        const int16_t* h = stage.history;
+        uint8_t center = (stage.position + 7) % TAPS;
+        int32_t acc = HALFBAND_CENTER * h[center];
+        for (uint8_t k = 0; k < 4; k++)
+        {
+            uint8_t offset = 2 * k + 1;
+            acc += HALFBAND_TAPS[k] * (h[(center + offset) % TAPS] + h[(center + TAPS - offset) % TAPS]);
+        }
+        output = clampSample((acc + (1 << 14)) >> 15);
+        return true;
+    }
+
+    size_t Decimator::process(const int16_t* in, size_t count, int16_t* out)
+    {
+        if (m_stageCount == 0)
+        {
+            if (out != in) memmove(out, in, count * sizeof(int16_t));
+            return count;
+        }
+
+        size_t written = 0;
+        for (size_t i = 0; i < count; i++)
+        {
+            int16_t sample = in[i];
+            bool ready = true;
+            for (uint8_t s = 0; s < m_stageCount && ready; s++)
+            {
+                ready = runStage(m_stages[s], sample, sample);
+            }
+            if (ready) out[written++] = sample;
+        }
+        return written;
+    }
+
+    /* ========================== AudioEncoder ========================== */
+
+    AudioEncoder::AudioEncoder()
+        : m_format(RecordingFormat::PCM16),
+          m_decimator(1),
+          m_pendingCount(0)
+    {
+        m_state.predictor = 0;
+        m_state.index = 0;
+    }
+
+    void AudioEncoder::begin(RecordingFormat format, uint8_t decimation)
+    {
+        m_format = format;
+        m_decimator.setFactor(decimation);
+        m_state.predictor = 0;
+        m_state.index = 0;
+        m_pendingCount = 0;
+    }
+
+    size_t AudioEncoder::encode(int16_t* samples, size_t count, uint8_t* out)
+    {
+        count = m_decimator.process(samples, count, samples);
+
+        switch (m_format)
+        {
+            case RecordingFormat::PCM16:
+                memcpy(out, samples, count * sizeof(int16_t));  // Little-endian on ESP32
+                return count * sizeof(int16_t);
+
+            case RecordingFormat::MU_LAW:
+                for (size_t i = 0; i < count; i++)
+                {
+                    out[i] = MuLaw::encode(samples[i]);
+                }
+                return count;
+
+            case RecordingFormat::IMA_ADPCM:
+            {
+                size_t written = 0;
+                size_t used = 0;
+                while (used < count)
+                {
+                    size_t take = ImaAdpcm::SAMPLES_PER_BLOCK - m_pendingCount;
+                    if (take > count - used) take = count - used;
+                    memcpy(m_pending + m_pendingCount, samples + used, take * sizeof(int16_t));
+                    m_pendingCount += take;
+                    used += take;
+
+                    if (m_pendingCount == ImaAdpcm::SAMPLES_PER_BLOCK)
+                    {
+                        ImaAdpcm::encodeBlock(m_pending, m_state, out + written);
+                        written += ImaAdpcm::BLOCK_ALIGN;
+                        m_pendingCount = 0;
+                    }
+                }
+                return written;
+            }
+        }
+        return 0;
+    }
+
+    size_t AudioEncoder::flush(uint8_t* out)
+    {
+        if (m_format != RecordingFormat::IMA_ADPCM || m_pendingCount == 0) return 0;
+
+        memset(m_pending + m_pendingCount, 0, (ImaAdpcm::SAMPLES_PER_BLOCK - m_pendingCount) * sizeof(int16_t));
+        ImaAdpcm::encodeBlock(m_pending, m_state, out);
+        m_pendingCount = 0;
+        return ImaAdpcm::BLOCK_ALIGN;
+    }
+
+    /* ========================== WAV framing ========================== */
+
+    static inline uint8_t* put16(uint8_t* p, uint16_t value)
+    {
+        p[0] = value & 0xFF;
+        p[1] = value >> 8;
+        return p + 2;
+    }
+
+    static inline uint8_t* put32(uint8_t* p, uint32_t value)
+    {
+        p[0] = value & 0xFF;
+        p[1] = (value >> 8) & 0xFF;
+        p[2] = (value >> 16) & 0xFF;
+        p[3] = (value >> 24) & 0xFF;
+        return p + 4;
+    }
+
+    static inline uint16_t get16(const uint8_t* p) { return p[0] | (p[1] << 8); }
+    static inline uint32_t get32(const uint8_t* p) { return get16(p) | (static_cast<uint32_t>(get16(p + 2)) << 16); }
+
+    size_t WavCodec::buildHeader(uint8_t* out, RecordingFormat format, uint32_t sampleRate, uint32_t dataBytes)
+    {
+        uint16_t formatTag = 1;
+        uint16_t blockAlign = 2;
+        uint16_t bitsPerSample = 16;
+        uint32_t byteRate = sampleRate * 2;
+        uint16_t fmtSize = 16;
+        uint32_t sampleFrames = dataBytes / 2;
+
+        if (format == RecordingFormat::MU_LAW)
+        {
+            formatTag = 7;
+            blockAlign = 1;
+            bitsPerSample = 8;
+            byteRate = sampleRate;
+            fmtSize = 18;
+            sampleFrames = dataBytes;
+        }
+        else if (format == RecordingFormat::IMA_ADPCM)
+        {
+            formatTag = 0x11;
+            blockAlign = ImaAdpcm::BLOCK_ALIGN;
+            bitsPerSample = 4;
+            byteRate = (sampleRate * ImaAdpcm::BLOCK_ALIGN) / ImaAdpcm::SAMPLES_PER_BLOCK;
+            fmtSize = 20;
+            sampleFrames = (dataBytes / ImaAdpcm::BLOCK_ALIGN) * ImaAdpcm::SAMPLES_PER_BLOCK;
+        }
+
+        bool hasFact = format != RecordingFormat::PCM16;
+        size_t headerBytes = 12 + 8 + fmtSize + (hasFact ? 12 : 0) + 8;
+
+        uint8_t* p = out;
+        memcpy(p, "RIFF", 4); p += 4;
+        p = put32(p, headerBytes - 8 + dataBytes);
+        memcpy(p, "WAVE", 4); p += 4;
+
+        memcpy(p, "fmt ", 4); p += 4;
+        p = put32(p, fmtSize);
+        p = put16(p, formatTag);
+        p = put16(p, 1);  // Mono
+        p = put32(p, sampleRate);
+        p = put32(p, byteRate);
+        p = put16(p, blockAlign);
+        p = put16(p, bitsPerSample);
+        if (fmtSize >= 18) p = put16(p, fmtSize - 18);  // cbSize
+        if (fmtSize == 20) p = put16(p, ImaAdpcm::SAMPLES_PER_BLOCK);
+
+        if (hasFact)
+        {
+            memcpy(p, "fact", 4); p += 4;
+            p = put32(p, 4);
+            p = put32(p, sampleFrames);
+        }
+
+        memcpy(p, "data", 4); p += 4;
+        p = put32(p, dataBytes);
+        return p - out;
+    }
+
+    bool WavCodec::parseHeader(const uint8_t* data, size_t length, WavFormatInfo& info)
+    {
+        if (length < 12 || memcmp(data, "RIFF", 4) != 0 || memcmp(data + 8, "WAVE", 4) != 0) return false;
+
+        bool haveFormat = false;
+        size_t offset = 12;
+        while (offset + 8 <= length)
+        {
+            const uint8_t* chunk = data + offset;
+            uint32_t chunkSize = get32(chunk + 4);
+
+            if (memcmp(chunk, "fmt ", 4) == 0 && offset + 8 + 16 <= length)
+            {
+                uint16_t tag = get16(chunk + 8);
+                if (tag == 1) info.format = RecordingFormat::PCM16;
+                else if (tag == 7) info.format = RecordingFormat::MU_LAW;
+                else if (tag == 0x11) info.format = RecordingFormat::IMA_ADPCM;
+                else return false;
+
+                info.channels = get16(chunk + 10);
+                info.sampleRate = get32(chunk + 12);
+                info.blockAlign = get16(chunk + 20);
+                info.bitsPerSample = get16(chunk + 22);
+                haveFormat = true;
+            }
+            else if (memcmp(chunk, "data", 4) == 0)
+            {
+                info.dataOffset = offset + 8;
+                info.dataBytes = chunkSize;
+                return haveFormat && info.channels == 1 &&
+                       (info.format != RecordingFormat::IMA_ADPCM || info.blockAlign <= ImaAdpcm::BLOCK_ALIGN);
+            }
+            offset += 8 + chunkSize + (chunkSize & 1);
+        }
+        return false;
+    }
+
+    /* ========================== StreamDecoder ========================== */
+
+    StreamDecoder::StreamDecoder()
+        : m_blockFill(0),
+          m_decodedCount(0),
+          m_decodedRead(0)
+    {
+        memset(&m_info, 0, sizeof(m_info));
+    }
+
+    void StreamDecoder::begin(const WavFormatInfo& info)
+    {
+        m_info = info;
+        m_blockFill = 0;
+        m_decodedCount = 0;
+        m_decodedRead = 0;
+    }
+
+    size_t StreamDecoder::decode(const uint8_t* input, size_t length, size_t& consumed, int16_t* out, size_t capacity)
+    {
+        consumed = 0;
+        size_t written = 0;
+
+        switch (m_info.format)
+        {
+            case RecordingFormat::PCM16:
+            {
+                size_t samples = length / 2;
+                if (samples > capacity) samples = capacity;
+                for (size_t i = 0; i < samples; i++)
+                {
+                    out[i] = static_cast<int16_t>(get16(input + i * 2));
+                }
+                consumed = samples * 2;
+                return samples;
+            }
+
+            case RecordingFormat::MU_LAW:
+            {
+                size_t samples = length < capacity ? length : capacity;
+                for (size_t i = 0; i < samples; i++)
+                {
+                    out[i] = MuLaw::decode(input[i]);
+                }
+                consumed = samples;
+                return samples;
+            }
+
+            case RecordingFormat::IMA_ADPCM:
+                while (written < capacity)
+                {
+                    if (m_decodedRead < m_decodedCount)
+                    {
+                        size_t take = m_decodedCount - m_decodedRead;
+                        if (take > capacity - written) take = capacity - written;
+                        memcpy(out + written, m_decoded + m_decodedRead, take * sizeof(int16_t));
+                        m_decodedRead += take;
+                        written += take;
+                        continue;
+                    }
+
+                    // Gather the next whole block before decoding it
+                    if (consumed >= length) break;
+                    size_t need = m_info.blockAlign - m_blockFill;
+                    size_t take = length - consumed < need ? length - consumed : need;
+                    memcpy(m_block + m_blockFill, input + consumed, take);
+                    m_blockFill += take;
+                    consumed += take;
+
+                    if (m_blockFill == m_info.blockAlign)
+                    {
+                        m_decodedCount = ImaAdpcm::decodeBlock(m_block, m_blockFill, m_decoded);
+                        m_decodedRead = 0;
+                        m_blockFill = 0;
+                    }
+                }
+                return written;
+        }
+        return 0;
+    }
+}
@@ -0,0 +1,212 @@
+/**
+ * @brief AudioCodecs compresses recordings for the shared SPI/SD bus
+ *
+ * Table-driven, allocation-free building blocks for the recording path:
+ * - IMA-ADPCM (4:1) in the standard WAV block layout (format 0x11)
+ * - G.711 µ-law (2:1, format 7)
+ * - Half-band decimator for 22.05 / 11.025 kHz voice recordings
+ * - WAV header builder and a push-style streaming decoder for playback
+ *
+ * Nothing here touches Arduino, so encode/decode can be exercised on host.
+ */
+
+#ifndef AUDIO_CODECS_H
+#define AUDIO_CODECS_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace AuditoryCortex
+{
+    /**
+     * @brief On-disk sample encodings for recordings
+     */
+    enum class RecordingFormat : uint8_t
+    {
+        PCM16 = 0,
+        IMA_ADPCM = 1,
+        MU_LAW = 2
+    };
+
+    class MuLaw
+    {
+    public:
+        static uint8_t encode(int16_t sample);
+        static int16_t decode(uint8_t code) { return DECODE_TABLE[code]; }
+
+    private:
+        static const int16_t DECODE_TABLE[256];
+        static const uint8_t EXPONENT_TABLE[256];
+    };
+
+    /**
+     * @brief Predictor state carried between ADPCM samples
+     */
+    struct AdpcmState
+    {
+        int16_t predictor;
+        uint8_t index;
+    };
+
+    class ImaAdpcm
+    {
+    public:
+        static constexpr uint16_t BLOCK_ALIGN = 512;  // One SD sector per block
+        static constexpr uint16_t SAMPLES_PER_BLOCK = (BLOCK_ALIGN - 4) * 2 + 1;
+
+        static uint8_t encodeSample(int16_t sample, AdpcmState& state);
+        static int16_t decodeSample(uint8_t nibble, AdpcmState& state);
+
+        /**
+         * @brief Encode exactly SAMPLES_PER_BLOCK samples into one BLOCK_ALIGN block
+         */
+        static void encodeBlock(const int16_t* samples, AdpcmState& state, uint8_t* block);
+
+        /**
+         * @brief Decode one block; returns samples written (up to SAMPLES_PER_BLOCK)
+         */
+        static size_t decodeBlock(const uint8_t* block, size_t blockBytes, int16_t* out);
+
+    private:
+        static const int16_t STEP_TABLE[89];
+        static const int8_t INDEX_TABLE[16];
+    };
+
+    /**
+     * @brief Cascaded 15-tap half-band FIR, factor 1, 2 or 4
+     */
+    class Decimator
+    {
+    public:
+        explicit Decimator(uint8_t factor = 1);
+
+        void setFactor(uint8_t factor);
+        uint8_t factor() const { return m_factor; }
+        void reset();
+
+        /**
+         * @brief Filter and decimate; out needs count / factor + 1 entries.
+         *        Safe to call in place (out == in).
+         */
+        size_t process(const int16_t* in, size_t count, int16_t* out);
+
+    private:
+        static constexpr uint8_t TAPS = 15;
+        static constexpr uint8_t MAX_STAGES = 2;
+
+        struct Stage
+        {
+            int16_t history[TAPS];
+            uint8_t position;
+            bool phase;  // Emit on every second input
+        };
+
+        uint8_t m_factor;
+        uint8_t m_stageCount;
+        Stage m_stages[MAX_STAGES];
+
+        static bool runStage(Stage& stage, int16_t input, int16_t& output);
+    };
+
+    /**
+     * @brief Capture-side encoder: PCM in, file bytes out, whole blocks only
+     */
+    class AudioEncoder
+    {
+    public:
+        AudioEncoder();
+
+        void begin(RecordingFormat format, uint8_t decimation);
+
+        /**
+         * @brief Worst-case output bytes for count input samples
+         */
+        static constexpr size_t maxEncodedBytes(size_t count)
+        {
+            // PCM is the widest; ADPCM can release one extra block from carried samples
+            return count * 2 + ImaAdpcm::BLOCK_ALIGN;
+        }
+
+        /**
+         * @brief Encode PCM; samples are decimated in place
+         * @return Bytes written to out
+         */
+        size_t encode(int16_t* samples, size_t count, uint8_t* out);
+
+        /**
+         * @brief Emit a final, zero-padded ADPCM block if one is pending
+         */
+        size_t flush(uint8_t* out);
+
+        RecordingFormat format() const { return m_format; }
+        uint32_t outputRate(uint32_t inputRate) const { return inputRate / m_decimator.factor(); }
+
+    private:
+        RecordingFormat m_format;
+        Decimator m_decimator;
+        AdpcmState m_state;
+        int16_t m_pending[ImaAdpcm::SAMPLES_PER_BLOCK];
+        uint16_t m_pendingCount;
+    };
+
+    /**
+     * @brief Parsed essentials of a WAV header
+     */
+    struct WavFormatInfo
+    {
+        RecordingFormat format;
+        uint16_t channels;
+        uint32_t sampleRate;
+        uint16_t blockAlign;
+        uint16_t bitsPerSample;
+        uint32_t dataOffset;
+        uint32_t dataBytes;
+    };
+
+    class WavCodec
+    {
+    public:
+        static constexpr size_t MAX_HEADER_BYTES = 60;
+
+        /**
+         * @brief Write a complete mono RIFF/WAVE header
+         * @return Header length in bytes
+         */
+        static size_t buildHeader(uint8_t* out, RecordingFormat format, uint32_t sampleRate, uint32_t dataBytes);
+
+        /**
+         * @brief Locate fmt and data chunks in the first bytes of a file
+         */
+        static bool parseHeader(const uint8_t* data, size_t length, WavFormatInfo& info);
+    };
+
+    /**
+     * @brief Push-style decoder: feed file bytes, pull PCM
+     */
+    class StreamDecoder
+    {
+    public:
+        StreamDecoder();
+
+        void begin(const WavFormatInfo& info);
+
+        /**
+         * @brief Decode as much of input as fits in out
+         * @param consumed Input bytes used; unconsumed bytes must be offered again
+         * @return Samples written
+         */
+        size_t decode(const uint8_t* input, size_t length, size_t& consumed, int16_t* out, size_t capacity);
+
+        const WavFormatInfo& info() const { return m_info; }
+
+    private:
+        WavFormatInfo m_info;
+        uint8_t m_block[ImaAdpcm::BLOCK_ALIGN];
+        uint16_t m_blockFill;
+        int16_t m_decoded[ImaAdpcm::SAMPLES_PER_BLOCK];
+        uint16_t m_decodedCount;
+        uint16_t m_decodedRead;
+    };
+}
+
+#endif // AUDIO_CODECS_H
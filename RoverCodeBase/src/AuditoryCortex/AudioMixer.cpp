@@ -0,0 +1,194 @@
+/**
+ * @file AudioMixer.cpp
+ * @brief Implementation of the prioritised, ducking output bus
+ */
+
+#include "AudioMixer.h"
+#include <string.h>
+
+namespace AuditoryCortex
+{
+    AudioMixer::AudioMixer(WavetableSynth& synth, MicrosClock clock)
+        : m_synth(synth),
+          m_clock(clock),
+          m_attackRate(16),    // ~8 blocks of 128 frames to full duck
+          m_releaseRate(4)
+    {
+        for (uint8_t c = 0; c < CHANNEL_COUNT; c++)
+        {
+            m_streams[c] = nullptr;
+            m_streamContexts[c] = nullptr;
+            for (uint8_t t = 0; t < CHANNEL_COUNT; t++)
+            {
+                m_rules[c][t].level = UNITY;
+                m_rules[c][t].pause = false;
+            }
+            m_gains[c].store(UNITY);
+            m_triggerMicros[c].store(0);
+            m_triggerPending[c].store(false);
+            m_active[c].store(false);
+            m_duck[c] = UNITY;
+        }
+        resetStats();
+    }
+
+    void AudioMixer::setStream(MixChannel channel, StreamSource source, void* context)
+    {
+        uint8_t c = static_cast<uint8_t>(channel);
+        if (c >= CHANNEL_COUNT) return;
+        m_streamContexts[c] = context;
+        m_streams[c] = source;
+    }
+
+    void AudioMixer::setChannelGain(MixChannel channel, uint8_t gain)
+    {
+        uint8_t c = static_cast<uint8_t>(channel);
+        if (c >= CHANNEL_COUNT) return;
+        m_gains[c].store(gain > UNITY ? UNITY : gain, std::memory_order_relaxed);
+    }
+
+    uint8_t AudioMixer::channelGain(MixChannel channel) const
+    {
+        uint8_t c = static_cast<uint8_t>(channel);
+        return c < CHANNEL_COUNT ? m_gains[c].load(std::memory_order_relaxed) : 0;
+    }
+
+    void AudioMixer::setDucking(MixChannel target, MixChannel trigger, uint8_t level, bool pause)
+    {
+        uint8_t c = static_cast<uint8_t>(target);
+        uint8_t t = static_cast<uint8_t>(trigger);
+        if (c >= CHANNEL_COUNT || t >= CHANNEL_COUNT || c == t) return;
+        m_rules[c][t].level = level > UNITY ? UNITY : level;
+        m_rules[c][t].pause = pause && level == 0;
+    }
+
+    void AudioMixer::setDuckRates(uint8_t attackPerBlock, uint8_t releasePerBlock)
+    {
+        m_attackRate = attackPerBlock > 0 ? attackPerBlock : 1;
+        m_releaseRate = releasePerBlock > 0 ? releasePerBlock : 1;
+    }
+
+    void AudioMixer::trigger(MixChannel channel)
+    {
+        uint8_t c = static_cast<uint8_t>(channel);
+        if (c >= CHANNEL_COUNT || !m_clock) return;
+        m_triggerMicros[c].store(m_clock(), std::memory_order_relaxed);
+        m_triggerPending[c].store(true, std::memory_order_release);
+    }
+
+    bool AudioMixer::isActive(MixChannel channel) const
+    {
+        uint8_t c = static_cast<uint8_t>(channel);
+        return c < CHANNEL_COUNT && m_active[c].load(std::memory_order_relaxed);
+    }
+
+    void AudioMixer::render(int16_t* out, size_t frames)
+    {
+        uint32_t start = m_clock ? m_clock() : 0;
+        while (frames > 0)
+        {
+            size_t count = frames < MAX_BLOCK ? frames : MAX_BLOCK;
+            renderPass(out, count);
+            out += count * 2;
+            frames -= count;
+        }
+        if (m_clock)
+        {
+            uint32_t elapsed = m_clock() - start;
+            if (elapsed > m_maxRender.load(std::memory_order_relaxed)) m_maxRender.store(elapsed, std::memory_order_relaxed);
+        }
+        m_blocksRendered.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void AudioMixer::renderPass(int16_t* out, size_t frames)
+    {
+        // Duck targets from the activity seen in the previous pass
+        bool paused[CHANNEL_COUNT];
+        uint8_t effective[CHANNEL_COUNT];
+        for (uint8_t c = 0; c < CHANNEL_COUNT; c++)
+        {
+            uint8_t target = UNITY;
+            paused[c] = false;
+            for (uint8_t t = 0; t < CHANNEL_COUNT; t++)
+            {
+                if (!m_active[t].load(std::memory_order_relaxed) || m_rules[c][t].level >= target) continue;
+                target = m_rules[c][t].level;
+                paused[c] = m_rules[c][t].pause;
+            }
+
+            if (m_duck[c] > target) m_duck[c] = m_duck[c] - target > m_attackRate ? m_duck[c] - m_attackRate : target;
+            else if (m_duck[c] < target) m_duck[c] = target - m_duck[c] > m_releaseRate ? m_duck[c] + m_releaseRate : target;
+
+            effective[c] = static_cast<uint8_t>((m_gains[c].load(std::memory_order_relaxed) * m_duck[c]) >> 7);
+            m_synth.setGroupGain(c, effective[c]);
+        }
+
+        m_synth.renderStereo(out, frames);
+
+        uint32_t now = m_clock ? m_clock() : 0;
+        for (uint8_t c = 0; c < CHANNEL_COUNT; c++)
+        {
+            bool active = m_synth.groupVoices(c) > 0;
+
+            // A paused stream is left untouched so it resumes without a gap
+            if (m_streams[c] && !(paused[c] && m_duck[c] == 0))
+            {
+                size_t produced = m_streams[c](m_streamContexts[c], m_stream, frames);
+                int32_t gain = effective[c];
+                for (size_t i = 0; i < produced && i < frames; i++)
+                {
+                    int32_t sample = (m_stream[i] * gain) >> 7;
+                    for (uint8_t side = 0; side < 2; side++)
+                    {
+                        int32_t mixed = out[i * 2 + side] + sample;
+                        out[i * 2 + side] = mixed > 32767 ? 32767 : (mixed < -32768 ? -32768 : mixed);
+                    }
+                }
+                active = active || produced > 0;
+            }
+            else if (m_streams[c] && paused[c])
+            {
+                active = m_active[c].load(std::memory_order_relaxed);  // Held, not finished
+            }
+
+            m_active[c].store(active, std::memory_order_relaxed);
+            if (active) recordLatency(c, now);
+        }
+    }
+
+    void AudioMixer::recordLatency(uint8_t channel, uint32_t now)
+    {
+        if (!m_triggerPending[channel].load(std::memory_order_acquire)) return;
+        m_triggerPending[channel].store(false, std::memory_order_relaxed);
+
+        uint32_t latency = now - m_triggerMicros[channel].load(std::memory_order_relaxed);
+        m_lastLatency.store(latency, std::memory_order_relaxed);
+        m_totalLatency.fetch_add(latency, std::memory_order_relaxed);
+        m_latencySamples.fetch_add(1, std::memory_order_relaxed);
+        if (latency > m_maxLatency.load(std::memory_order_relaxed)) m_maxLatency.store(latency, std::memory_order_relaxed);
+    }
+
+    MixerStats AudioMixer::stats() const
+    {
+        MixerStats snapshot;
+        snapshot.blocksRendered = m_blocksRendered.load(std::memory_order_relaxed);
+        snapshot.latencySamples = m_latencySamples.load(std::memory_order_relaxed);
+        snapshot.lastLatencyMicros = m_lastLatency.load(std::memory_order_relaxed);
+        snapshot.maxLatencyMicros = m_maxLatency.load(std::memory_order_relaxed);
+        snapshot.totalLatencyMicros = m_totalLatency.load(std::memory_order_relaxed);
+        snapshot.maxRenderMicros = m_maxRender.load(std::memory_order_relaxed);
+        snapshot.voicesStolen = m_synth.stolenVoices();
+        snapshot.notesRejected = m_synth.rejectedNotes();
+        return snapshot;
+    }
+
+    void AudioMixer::resetStats()
+    {
+        m_blocksRendered.store(0);
+        m_latencySamples.store(0);
+        m_lastLatency.store(0);
+        m_maxLatency.store(0);
+        m_totalLatency.store(0);
+        m_maxRender.store(0);
+    }
+}
@@ -0,0 +1,145 @@
+/**
+ * @brief AudioMixer is the single output bus behind the I2S render task
+ *
+ * Every sound the rover makes passes through one of four named channels:
+ * - MUSIC: Tunes, card melodies and imported songs
+ * - UI: Rotary clicks, menu sounds and confirmations
+ * - VOICE: Recordings and other streamed PCM
+ * - ALERT: Error codes and warnings
+ *
+ * Channels are listed in ascending priority. Each has its own gain, and
+ * ducking rules lower (or silence and pause) a channel while a more important
+ * one is sounding. Tone channels map onto WavetableSynth voice groups, so
+ * voice stealing follows the same priority order.
+ *
+ * Platform-free: the clock is injected so trigger-to-sample latency can be
+ * measured on host as well as on the rover.
+ */
+
+#ifndef AUDIO_MIXER_H
+#define AUDIO_MIXER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "WavetableSynth.h"
+
+namespace AuditoryCortex
+{
+    enum class MixChannel : uint8_t
+    {
+        MUSIC = 0,
+        UI = 1,
+        VOICE = 2,
+        ALERT = 3
+    };
+
+    /**
+     * @brief Bus counters; latency is trigger() to the first rendered sample
+     */
+    struct MixerStats
+    {
+        uint32_t blocksRendered;
+        uint32_t latencySamples;        // Triggers that reached the output
+        uint32_t lastLatencyMicros;
+        uint32_t maxLatencyMicros;
+        uint32_t totalLatencyMicros;
+        uint32_t maxRenderMicros;       // Slowest render() call
+        uint32_t voicesStolen;
+        uint32_t notesRejected;
+    };
+
+    class AudioMixer
+    {
+    public:
+        static constexpr uint8_t CHANNEL_COUNT = 4;
+        static constexpr uint8_t UNITY = 128;
+        static constexpr uint16_t MAX_BLOCK = 256;    // Frames per render pass
+
+        /**
+         * @brief Pull-style PCM source; returns mono frames produced (0 = idle)
+         */
+        typedef size_t (*StreamSource)(void* context, int16_t* out, size_t frames);
+
+        /**
+         * @brief Monotonic microsecond clock (micros() on the rover)
+         */
+        typedef uint32_t (*MicrosClock)();
+
+        AudioMixer(WavetableSynth& synth, MicrosClock clock);
+
+        /**
+         * @brief Attach a streamed source to a channel (one per channel)
+         */
+        void setStream(MixChannel channel, StreamSource source, void* context);
+
+        /**
+         * @brief Channel gain 0-128 (unity)
+         */
+        void setChannelGain(MixChannel channel, uint8_t gain);
+        uint8_t channelGain(MixChannel channel) const;
+
+        /**
+         * @brief While trigger is sounding, scale target down to level (0-128)
+         * @param pause With level 0, stop pulling target's stream so it resumes
+         *              where it left off instead of losing audio
+         */
+        void setDucking(MixChannel target, MixChannel trigger, uint8_t level, bool pause = false);
+
+        /**
+         * @brief Gain change per rendered block when ducking and recovering
+         */
+        void setDuckRates(uint8_t attackPerBlock, uint8_t releasePerBlock);
+
+        /**
+         * @brief Stamp a sound request; the next audible block on the channel
+         *        records the latency. Callable from any task.
+         */
+        void trigger(MixChannel channel);
+
+        /**
+         * @brief Render one stereo block; called only by the output task
+         */
+        void render(int16_t* out, size_t frames);
+
+        bool isActive(MixChannel channel) const;
+        MixerStats stats() const;
+        void resetStats();
+
+    private:
+        struct DuckRule
+        {
+            uint8_t level;      // UNITY = no ducking
+            bool pause;
+        };
+
+        WavetableSynth& m_synth;
+        MicrosClock m_clock;
+
+        StreamSource m_streams[CHANNEL_COUNT];
+        void* m_streamContexts[CHANNEL_COUNT];
+        DuckRule m_rules[CHANNEL_COUNT][CHANNEL_COUNT];   // [target][trigger]
+        uint8_t m_attackRate;
+        uint8_t m_releaseRate;
+
+        std::atomic<uint8_t> m_gains[CHANNEL_COUNT];
+        std::atomic<uint32_t> m_triggerMicros[CHANNEL_COUNT];
+        std::atomic<bool> m_triggerPending[CHANNEL_COUNT];
+        std::atomic<bool> m_active[CHANNEL_COUNT];
+        uint8_t m_duck[CHANNEL_COUNT];                    // Current duck gain, ramps toward the rule
+
+        std::atomic<uint32_t> m_blocksRendered;
+        std::atomic<uint32_t> m_latencySamples;
+        std::atomic<uint32_t> m_lastLatency;
+        std::atomic<uint32_t> m_maxLatency;
+        std::atomic<uint32_t> m_totalLatency;
+        std::atomic<uint32_t> m_maxRender;
+
+        int16_t m_stream[MAX_BLOCK];
+
+        void renderPass(int16_t* out, size_t frames);
+        void recordLatency(uint8_t channel, uint32_t now);
+    };
+}
+
+#endif // AUDIO_MIXER_H
@@ -0,0 +1,119 @@
+/**
+ * @file MediaClock.cpp
+ * @brief Implementation of the sample-count media clock
+ */
+
+#include "MediaClock.h"
+
+namespace AuditoryCortex
+{
+    MediaClock::MediaClock(uint32_t sampleRate, MicrosClock clock)
+        : m_sampleRate(sampleRate),
+          m_clock(clock),
+          m_latencyFrames(0),
+          m_sequence(0),
+          m_lastMicros(0)
+    {
+        // Until the speaker starts, media time is simply the timer
+        m_writer.baseMicros = 0;
+        m_writer.anchorFrame = 0;
+        m_writer.queuedFrames = 0;
+        m_writer.anchorClock = 0;
+        m_writer.running = false;
+        m_published = m_writer;
+    }
+
+    void MediaClock::start()
+    {
+        uint32_t now = m_clock();
+        m_writer.baseMicros = timeAt(m_writer, now);
+        m_writer.anchorFrame = 0;
+        m_writer.queuedFrames = 0;
+        m_writer.anchorClock = now;
+        m_writer.running = true;
+        publish();
+    }
+
+    void MediaClock::stop()
+    {
+        uint32_t now = m_clock();
+        m_writer.baseMicros = timeAt(m_writer, now);
+        m_writer.anchorClock = now;
+        m_writer.running = false;
+        publish();
+    }
+
+    void MediaClock::queued(uint32_t frames)
+    {
+        m_writer.queuedFrames += frames;
+        publish();
+    }
+
+    void MediaClock::written()
+    {
+        // A write returns once the DMA queue has room, so everything but the
+        // last latency's worth of frames has already been played
+        if (m_writer.queuedFrames <= m_latencyFrames) return;
+        m_writer.anchorFrame = m_writer.queuedFrames - m_latencyFrames;
+        m_writer.anchorClock = m_clock();
+        publish();
+    }
+
+    uint64_t MediaClock::nowMicros()
+    {
+        uint64_t micros = timeAt(snapshot(), m_clock());
+        if (micros < m_lastMicros) return m_lastMicros;  // Re-anchoring never steps time back
+        m_lastMicros = micros;
+        return micros;
+    }
+
+    uint64_t MediaClock::queuedMicros()
+    {
+        Anchor anchor = snapshot();
+        if (!anchor.running) return nowMicros();
+        uint64_t micros = anchor.baseMicros + framesToMicros(anchor.queuedFrames);
+        uint64_t now = nowMicros();
+        return micros > now ? micros : now;
+    }
+
+    void MediaClock::publish()
+    {
+        uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+        m_sequence.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        m_published = m_writer;
+        std::atomic_thread_fence(std::memory_order_release);
+        m_sequence.store(sequence + 2, std::memory_order_relaxed);
+    }
+
+    MediaClock::Anchor MediaClock::snapshot() const
+    {
+        Anchor anchor;
+        uint32_t before;
+        uint32_t after;
+        do
+        {
+            before = m_sequence.load(std::memory_order_acquire);
+            anchor = m_published;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            after = m_sequence.load(std::memory_order_relaxed);
+        } while ((before & 1) || before != after);
+        return anchor;
+    }
+
+    uint64_t MediaClock::timeAt(const Anchor& anchor, uint32_t now) const
+    {
+        uint32_t elapsed = now - anchor.anchorClock;
+        if (!anchor.running) return anchor.baseMicros + elapsed;
+
+        // Interpolate from the last anchor, but never past what has been rendered
+        uint64_t frame = anchor.anchorFrame + static_cast<uint64_t>(elapsed) * m_sampleRate / 1000000;
+        if (frame > anchor.queuedFrames) frame = anchor.queuedFrames;
+        return anchor.baseMicros + framesToMicros(frame);
+    }
+
+    uint64_t MediaClock::framesToMicros(uint64_t frames) const
+    {
+        return frames * 1000000 / m_sampleRate;
+    }
+}
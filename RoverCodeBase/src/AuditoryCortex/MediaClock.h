@@ -0,0 +1,94 @@
+/**
+ * @brief MediaClock is the shared timeline for sound and light
+ *
+ * Media time is the presentation time of the sample currently leaving the
+ * DAC, derived from frames handed to I2S:
+ * - The render task reports each block as it is queued and written
+ * - Readers interpolate between blocks with the microsecond timer, clamped
+ *   so time never runs ahead of what has actually been rendered
+ * - While the speaker is released (microphone recording) the clock free-runs
+ *   on the timer and picks up again without a jump
+ *
+ * A note handed to the synth now will be heard at queuedMicros(), so visuals
+ * scheduled for that time land on the note's first sample rather than on the
+ * loop iteration that requested it.
+ */
+
+#ifndef MEDIA_CLOCK_H
+#define MEDIA_CLOCK_H
+
+#include <stdint.h>
+#include <atomic>
+
+namespace AuditoryCortex
+{
+    class MediaClock
+    {
+    public:
+        typedef uint32_t (*MicrosClock)();
+
+        MediaClock(uint32_t sampleRate, MicrosClock clock);
+
+        /**
+         * @brief Frames buffered between a completed write and the DAC
+         */
+        void setLatency(uint32_t frames) { m_latencyFrames = frames; }
+
+        /* ========================== Output owner (one writer at a time) ========================== */
+        void start();
+        void stop();
+
+        /**
+         * @brief A block has been rendered and is about to be written
+         */
+        void queued(uint32_t frames);
+
+        /**
+         * @brief The last queued block was accepted by the output driver
+         */
+        void written();
+
+        /* ========================== Readers (one task) ========================== */
+        /**
+         * @brief Media time of the sample being presented now
+         */
+        uint64_t nowMicros();
+        uint32_t nowMs() { return static_cast<uint32_t>(nowMicros() / 1000); }
+
+        /**
+         * @brief Media time at which the next rendered sample will be heard
+         */
+        uint64_t queuedMicros();
+
+        bool isRunning() const { return snapshot().running; }
+
+    private:
+        /**
+         * @brief Render-side timeline published under a sequence lock
+         */
+        struct Anchor
+        {
+            uint64_t baseMicros;        // Media time of frame 0, or of anchorClock while stopped
+            uint64_t anchorFrame;       // Frame presented at anchorClock
+            uint64_t queuedFrames;      // Frames rendered this run
+            uint32_t anchorClock;
+            bool running;
+        };
+
+        uint32_t m_sampleRate;
+        MicrosClock m_clock;
+        uint32_t m_latencyFrames;
+
+        Anchor m_writer;                        // Render task's working copy
+        Anchor m_published;
+        std::atomic<uint32_t> m_sequence;       // Odd while m_published is being written
+        uint64_t m_lastMicros;                  // Readers share one task; keeps time monotonic
+
+        void publish();
+        Anchor snapshot() const;
+        uint64_t timeAt(const Anchor& anchor, uint32_t now) const;
+        uint64_t framesToMicros(uint64_t frames) const;
+    };
+}
+
+#endif // MEDIA_CLOCK_H
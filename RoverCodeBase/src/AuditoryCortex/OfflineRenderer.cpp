@@ -0,0 +1,213 @@
+/**
+ * @file OfflineRenderer.cpp
+ * @brief Block-stepped rendering of tunes and effects without audio hardware
+ */
+
+#include "OfflineRenderer.h"
+#include "Tunes.h"
+
+namespace AuditoryCortex
+{
+    namespace
+    {
+        constexpr uint32_t FNV_OFFSET = 2166136261u;
+        constexpr uint32_t FNV_PRIME = 16777619u;
+
+        /**
+         * @brief Synth group per sequencer lane, matching the mixer's channel order
+         */
+        uint8_t laneGroup(uint8_t slot)
+        {
+            switch (static_cast<TonePriority>(slot / ToneSequencer::VOICES_PER_LANE))
+            {
+                case TonePriority::TUNE:  return 0;
+                case TonePriority::ALERT: return 3;
+                default:                  return 1;
+            }
+        }
+    }
+
+    OfflineRenderer* OfflineRenderer::s_active = nullptr;
+
+    OfflineRenderer::OfflineRenderer(uint32_t sampleRate, MicrosClock clock)
+        : m_sampleRate(sampleRate)
+        , m_clock(clock)
+        , m_pcmSink(nullptr)
+        , m_pcmContext(nullptr)
+        , m_ledSink(nullptr)
+        , m_ledContext(nullptr)
+        , m_synth(sampleRate)
+        , m_source{nullptr, nullptr, 0, 0}
+        , m_result{}
+        , m_frame(0)
+        , m_baseMs(0)
+    {
+        // Same arrangement as the rover: lanes sound together and the bus sorts them out
+        m_sequencer.setPreemptive(false);
+    }
+
+    void OfflineRenderer::setPcmSink(PcmSink sink, void* context)
+    {
+        m_pcmSink = sink;
+        m_pcmContext = context;
+    }
+
+    void OfflineRenderer::setLedSink(LedSink sink, void* context)
+    {
+        m_ledSink = sink;
+        m_ledContext = context;
+    }
+
+    RenderResult OfflineRenderer::renderTune(const Tune& tune, uint8_t volume)
+    {
+        Source source = { &tune, nullptr, 0, volume };
+        return run(source);
+    }
+
+    RenderResult OfflineRenderer::renderEffect(const SoundEffect& effect)
+    {
+        Source source = { nullptr, &effect, 0, 0 };
+        return run(source);
+    }
+
+    RenderResult OfflineRenderer::run(const Source& source)
+    {
+        m_source = source;
+        m_result = RenderResult{};
+        m_result.timelineHash = FNV_OFFSET;
+        m_result.pcmHash = FNV_OFFSET;
+        m_frame = 0;
+
+        m_sequencer.setOutput(onStart, onStop);
+        s_active = this;
+        m_sequencer.stopAll();
+        m_synth.allNotesOff();
+
+        // The sequencer only ever moves forward, so each render starts on a fresh
+        // whole millisecond after the last one and anchors there before feeding
+        m_sequencer.update(m_baseMs);
+
+        const uint64_t maxFrames = static_cast<uint64_t>(MAX_SECONDS) * m_sampleRate;
+        uint32_t startMicros = m_clock ? m_clock() : 0;
+        int16_t block[BLOCK_FRAMES];
+
+        while (true)
+        {
+            bool more = feed();
+            m_sequencer.update(m_baseMs + static_cast<uint32_t>(static_cast<uint64_t>(m_frame) * 1000 / m_sampleRate));
+
+            m_synth.render(block, BLOCK_FRAMES);
+            m_result.pcmHash = fnv(m_result.pcmHash, block, sizeof(block));
+            if (m_pcmSink)
+            {
+                m_pcmSink(m_pcmContext, block, BLOCK_FRAMES);
+            }
+            m_frame += BLOCK_FRAMES;
+
+            // Done once everything is queued, played out and the release tails have faded
+            if (!more && !m_sequencer.isBusy() && m_synth.activeVoices() == 0)
+            {
+                break;
+            }
+            if (m_frame >= maxFrames)
+            {
+                m_result.truncated = true;
+                m_sequencer.stopAll();
+                break;
+            }
+        }
+
+        if (m_clock)
+        {
+            m_result.renderMicros = m_clock() - startMicros;
+        }
+        m_result.frames = m_frame;
+        m_result.durationMs = static_cast<uint32_t>(static_cast<uint64_t>(m_frame) * 1000 / m_sampleRate);
+        m_baseMs += m_result.durationMs + 1;
+
+        m_sequencer.setOutput(nullptr, nullptr);
+        s_active = nullptr;
+        return m_result;
+    }
+
+    bool OfflineRenderer::feed()
+    {
+        if (m_source.tune)
+        {
+            const Tune& tune = *m_source.tune;
+            while (m_source.next < tune.steps.size() && m_sequencer.freeSpace(TonePriority::TUNE) > 0)
+            {
+                m_sequencer.enqueue(TonePriority::TUNE, Tunes::toneEvent(tune, m_source.next, m_source.volume));
+                m_source.next++;
+            }
+            return m_source.next < tune.steps.size();
+        }
+
+        const SoundEffect& effect = *m_source.effect;
+        while (m_source.next < effect.events.size() && m_sequencer.freeSpace(effect.lane) > 0)
+        {
+            m_sequencer.enqueue(effect.lane, effect.events[m_source.next]);
+            m_source.next++;
+        }
+        return m_source.next < effect.events.size();
+    }
+
+    void OfflineRenderer::hashTimeline(uint32_t value)
+    {
+        m_result.timelineHash = fnv(m_result.timelineHash, &value, sizeof(value));
+    }
+
+    void OfflineRenderer::onStart(uint8_t slot, const ToneEvent& event)
+    {
+        OfflineRenderer* self = s_active;
+        if (self == nullptr)
+        {
+            return;
+        }
+
+        self->m_synth.noteOn(slot, event.frequency, event.volume, laneGroup(slot));
+        self->m_result.notes++;
+
+        // Volume is left out so the timeline does not change with the user's setting
+        uint32_t ledMask = 0;
+        if (event.cue > 0 && self->m_source.tune)
+        {
+            size_t noteIndex = event.cue - 1;
+            const Tune& tune = *self->m_source.tune;
+            if (noteIndex < tune.ledAnimation.size())
+            {
+                ledMask = tune.ledAnimation[noteIndex];
+                self->m_result.ledFrames++;
+                if (self->m_ledSink)
+                {
+                    self->m_ledSink(self->m_ledContext, self->m_frame, ledMask, static_cast<uint16_t>(noteIndex));
+                }
+            }
+        }
+
+        self->hashTimeline(self->m_frame);
+        self->hashTimeline(slot);
+        self->hashTimeline(event.frequency);
+        self->hashTimeline(event.durationMs);
+        self->hashTimeline(ledMask);
+    }
+
+    void OfflineRenderer::onStop(uint8_t slot)
+    {
+        if (s_active)
+        {
+            s_active->m_synth.noteOff(slot);
+        }
+    }
+
+    uint32_t OfflineRenderer::fnv(uint32_t hash, const void* data, size_t length)
+    {
+        const uint8_t* bytes = static_cast<const uint8_t*>(data);
+        for (size_t i = 0; i < length; i++)
+        {
+            hash ^= bytes[i];
+            hash *= FNV_PRIME;
+        }
+        return hash;
+    }
+}
@@ -0,0 +1,97 @@
+/**
+ * @brief OfflineRenderer plays tunes and effects through the real audio path
+ *        against a simulated clock
+ *
+ * The same ToneSequencer and WavetableSynth the rover uses are stepped one
+ * block at a time with no I2S and no waiting:
+ * - Optional PCM and LED-frame sinks (WAV export, timeline dumps)
+ * - A timeline hash over onsets, pitches, lengths and note lights that is
+ *   identical on every platform
+ * - A PCM hash for same-toolchain comparisons, plus render throughput
+ *
+ * The recorded goldens and the WAV/timeline export live with the host suite
+ * in test/test_offline_renderer.
+ */
+
+#ifndef OFFLINE_RENDERER_H
+#define OFFLINE_RENDERER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../CorpusCallosum/SynapticPathways.h"
+#include "../PrefrontalCortex/ProtoPerceptions.h"
+#include "ToneSequencer.h"
+#include "WavetableSynth.h"
+#include "SoundEffects.h"
+
+namespace AuditoryCortex
+{
+    using namespace CorpusCallosum;
+    using PC::AudioTypes::Tune;
+
+    struct RenderResult
+    {
+        uint32_t frames;
+        uint32_t durationMs;
+        uint16_t notes;
+        uint16_t ledFrames;
+        uint32_t timelineHash;      // Platform independent
+        uint32_t pcmHash;           // Depends on the toolchain's sinf() and on what rendered before
+        uint32_t renderMicros;      // 0 without a clock
+        bool truncated;             // Hit MAX_SECONDS before going quiet
+    };
+
+    class OfflineRenderer
+    {
+    public:
+        static constexpr uint16_t BLOCK_FRAMES = 128;
+        static constexpr uint16_t MAX_SECONDS = 300;
+
+        typedef void (*PcmSink)(void* context, const int16_t* samples, size_t frames);
+        typedef void (*LedSink)(void* context, uint32_t frame, uint32_t ledMask, uint16_t noteIndex);
+        typedef uint32_t (*MicrosClock)();
+
+        explicit OfflineRenderer(uint32_t sampleRate = 44100, MicrosClock clock = nullptr);
+
+        void setPcmSink(PcmSink sink, void* context);
+        void setLedSink(LedSink sink, void* context);
+
+        RenderResult renderTune(const Tune& tune, uint8_t volume = SoundEffects::DEFAULT_VOLUME);
+        RenderResult renderEffect(const SoundEffect& effect);
+
+    private:
+        struct Source
+        {
+            const Tune* tune;
+            const SoundEffect* effect;
+            size_t next;
+            uint8_t volume;
+        };
+
+        static OfflineRenderer* s_active;   // Sequencer callbacks carry no context
+
+        uint32_t m_sampleRate;
+        MicrosClock m_clock;
+        PcmSink m_pcmSink;
+        void* m_pcmContext;
+        LedSink m_ledSink;
+        void* m_ledContext;
+
+        ToneSequencer m_sequencer;
+        WavetableSynth m_synth;
+        Source m_source;
+        RenderResult m_result;
+        uint32_t m_frame;               // Relative to the start of the current render
+        uint32_t m_baseMs;              // Sequencer time at which the current render started
+
+        RenderResult run(const Source& source);
+        bool feed();
+        void hashTimeline(uint32_t value);
+
+        static void onStart(uint8_t slot, const ToneEvent& event);
+        static void onStop(uint8_t slot);
+        static uint32_t fnv(uint32_t hash, const void* data, size_t length);
+    };
+}
+
+#endif // OFFLINE_RENDERER_H
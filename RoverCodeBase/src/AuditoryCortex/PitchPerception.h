@@ -17,6 +17,8 @@
 #include "../CorpusCallosum/SynapticPathways.h"
 #include "../PrefrontalCortex/ProtoPerceptions.h"
 #include <cstdint> // For fixed-width integer types
+#include <atomic>
+#include "PitchTracker.h"
 
 namespace AuditoryCortex
 {
@@ -132,7 +134,16 @@ namespace AuditoryCortex
         static const uint16_t NOTE_D8 = 4699;
         static const uint16_t NOTE_DS8 = 4978;
 
-        static const uint16_t NOTE_FREQUENCIES[];
+        static constexpr uint16_t NOTE_FREQUENCIES[] = {
+            NOTE_B0, NOTE_C1, NOTE_CS1, NOTE_D1, NOTE_DS1, NOTE_E1, NOTE_F1, NOTE_FS1, NOTE_G1, NOTE_GS1, NOTE_A1, NOTE_AS1, NOTE_B1,
+            NOTE_C2, NOTE_CS2, NOTE_D2, NOTE_DS2, NOTE_E2, NOTE_F2, NOTE_FS2, NOTE_G2, NOTE_GS2, NOTE_A2, NOTE_AS2, NOTE_B2,
+            NOTE_C3, NOTE_CS3, NOTE_D3, NOTE_DS3, NOTE_E3, NOTE_F3, NOTE_FS3, NOTE_G3, NOTE_GS3, NOTE_A3, NOTE_AS3, NOTE_B3,
+            NOTE_C4, NOTE_CS4, NOTE_D4, NOTE_DS4, NOTE_E4, NOTE_F4, NOTE_FS4, NOTE_G4, NOTE_GS4, NOTE_A4, NOTE_AS4, NOTE_B4,
+            NOTE_C5, NOTE_CS5, NOTE_D5, NOTE_DS5, NOTE_E5, NOTE_F5, NOTE_FS5, NOTE_G5, NOTE_GS5, NOTE_A5, NOTE_AS5, NOTE_B5,
+            NOTE_C6, NOTE_CS6, NOTE_D6, NOTE_DS6, NOTE_E6, NOTE_F6, NOTE_FS6, NOTE_G6, NOTE_GS6, NOTE_A6, NOTE_AS6, NOTE_B6,
+            NOTE_C7, NOTE_CS7, NOTE_D7, NOTE_DS7, NOTE_E7, NOTE_F7, NOTE_FS7, NOTE_G7, NOTE_GS7, NOTE_A7, NOTE_AS7, NOTE_B7,
+            NOTE_C8, NOTE_CS8, NOTE_D8, NOTE_DS8
+        };
         static const char* NOTE_NAMES[];
 
         /**
@@ -149,16 +160,58 @@ namespace AuditoryCortex
          */
         static uint16_t getStandardFrequency(uint16_t frequency);
 
-        static uint16_t getNoteFrequency(const PC::AudioTypes::NoteInfo& info);
+        static constexpr uint16_t getNoteFrequency(const PC::AudioTypes::NoteInfo& info) {
+            return NOTE_FREQUENCIES[(info.octave - 1) * 12 + static_cast<int>(info.note)];
+        }
         static const char* getNoteName(const PC::AudioTypes::NoteInfo& info);
         static uint16_t getDayBaseNote4();
         static uint16_t getDayBaseNote5();
         static uint16_t getDayBaseNote(bool is4thOctave);
         static bool isSharp(uint16_t frequency);
-        static uint16_t getNoteDuration(
-            PrefrontalCortex::AudioTypes::NoteType note, 
-            PrefrontalCortex::AudioTypes::TimeSignature timeSignature
-        );
+        // Note duration in milliseconds based on note type and time signature
+        static constexpr uint16_t getNoteDuration(NoteType note, TimeSignature timeSignature) 
+        {
+            // Base duration for a quarter note in 4/4 time (default reference point)
+            uint16_t baseDuration = WHOLE_NOTE_MS / 4;
+
+            // Adjust base duration based on the time signature denominator
+            switch (timeSignature) 
+            {
+                case TimeSignature::TIME_2_2: 
+                    baseDuration = WHOLE_NOTE_MS / 2;  // Half note gets the beat
+                    break;
+
+                case TimeSignature::TIME_4_4: 
+                    baseDuration = WHOLE_NOTE_MS / 4;  // Quarter note gets the beat
+                    break;
+
+                case TimeSignature::TIME_6_8: 
+                    baseDuration = WHOLE_NOTE_MS / 8;  // Eighth note gets the beat
+                    break;
+
+                case TimeSignature::TIME_12_16: 
+                    baseDuration = WHOLE_NOTE_MS / 16;  // Sixteenth note gets the beat
+                    break;
+
+                default: 
+                    baseDuration = WHOLE_NOTE_MS / 4;  // Default to quarter note
+                    break;
+            }
+
+            // Scale the note duration based on the note type
+            switch (note) 
+            {
+                case NoteType::WHOLE: return baseDuration * 4;        // Whole note
+                case NoteType::HALF: return baseDuration * 2;         // Half note
+                case NoteType::QUARTER: return baseDuration;          // Quarter note
+                case NoteType::EIGHTH: return baseDuration / 2;       // Eighth note
+                case NoteType::SIXTEENTH: return baseDuration / 4;    // Sixteenth note
+                case NoteType::THIRTY_SECOND: return baseDuration / 8; // Thirty-second note
+                case NoteType::SIXTY_FOURTH: return baseDuration / 16; // Sixty-fourth note
+                case NoteType::HUNDRED_TWENTY_EIGHTH: return baseDuration / 32; // Hundred-twenty-eighth note
+                default: return baseDuration;               // Default to quarter note
+            }
+        }
 
         // Helper for SoundFxManager
         static uint16_t getOctaveUp(uint16_t baseNote) { return baseNote * 2; }
@@ -174,12 +227,31 @@ namespace AuditoryCortex
         static bool isInTune(uint16_t frequency);
         
         // Frequency analysis methods
-        static uint16_t detectPitch();
         static uint16_t getFrequencyFromNote(uint8_t note);
         static uint8_t getNoteFromFrequency(uint16_t frequency);
 
+        /**
+         * @brief Live pitch tracking for tuner and sing-along modes
+         *
+         * processMicrophone() runs on the capture task; readers on any other
+         * task get the most recent complete estimate.
+         */
+        static bool beginTracking(uint32_t sampleRate);
+        static void processMicrophone(const int16_t* samples, size_t count);
+        static bool getLivePitch(PitchEstimate& estimate);
+
+        /**
+         * @brief Latest voiced frequency in Hz, 0 when silent or unpitched
+         */
+        static uint16_t detectPitch();
+
     private:
         static const uint16_t FREQUENCY_TOLERANCE = 1; // Hz tolerance for pitch detection
+        static const int8_t IN_TUNE_CENTS = 10;
+
+        static PitchTracker tracker;
+        static PitchEstimate published[2];
+        static std::atomic<uint8_t> publishedSlot;
     }; 
 
 }
@@ -0,0 +1,225 @@
+/**
+ * @file PitchTracker.cpp
+ * @brief Implementation of the fixed-point YIN pitch tracker
+ */
+
+#include "PitchTracker.h"
+#include <string.h>
+
+namespace AuditoryCortex
+{
+    // log2(1 + i/64) in Q16
+    const uint32_t PitchTracker::LOG2_TABLE[65] = {
+        0, 1466, 2909, 4331, 5732, 7112, 8473, 9814,
+        11136, 12440, 13727, 14996, 16248, 17484, 18704, 19909,
+        21098, 22272, 23433, 24579, 25711, 26830, 27936, 29029,
+        30109, 31178, 32234, 33279, 34312, 35334, 36346, 37346,
+        38336, 39316, 40286, 41246, 42196, 43137, 44068, 44990,
+        45904, 46809, 47705, 48593, 49472, 50344, 51207, 52063,
+        52911, 53751, 54584, 55410, 56229, 57040, 57845, 58643,
+        59434, 60219, 60997, 61769, 62534, 63294, 64047, 64794,
+        65536
+    };
+
+    PitchTracker::PitchTracker()
+        : m_decimator(1),
+          m_analysisRate(0),
+          m_minLag(2),
+          m_maxLag(MAX_LAG),
+          m_hop(WINDOW),
+          m_fill(0),
+          m_threshold(DEFAULT_THRESHOLD),
+          m_silenceLevel(100)
+    {
+        memset(&m_latest, 0, sizeof(m_latest));
+    }
+
+    bool PitchTracker::begin(uint32_t sampleRate, uint16_t minFrequency, uint16_t maxFrequency,
+                             uint8_t updatesPerSecond)
+    {
+        if (sampleRate == 0 || minFrequency == 0 || maxFrequency <= minFrequency || updatesPerSecond == 0)
+        {
+            return false;
+        }
+
+        uint8_t factor = 1;
+        while (sampleRate / factor > MAX_ANALYSIS_RATE && factor < 4) factor *= 2;
+        m_decimator.setFactor(factor);
+        m_analysisRate = sampleRate / factor;
+
+        uint32_t minLag = m_analysisRate / maxFrequency;
+        uint32_t maxLag = m_analysisRate / minFrequency + 1;
+        if (minLag < 2 || maxLag > MAX_LAG) return false;
+        m_minLag = static_cast<uint16_t>(minLag);
+        m_maxLag = static_cast<uint16_t>(maxLag);
+
+        uint32_t hop = m_analysisRate / updatesPerSecond;
+        m_hop = static_cast<uint16_t>(hop == 0 ? 1 : (hop > WINDOW ? WINDOW : hop));
+
+        reset();
+        return true;
+    }
+
+    void PitchTracker::reset()
+    {
+        m_decimator.reset();
+        m_fill = 0;
+        uint32_t sequence = m_latest.sequence;
+        memset(&m_latest, 0, sizeof(m_latest));
+        m_latest.sequence = sequence;
+    }
+
+    bool PitchTracker::process(const int16_t* samples, size_t count)
+    {
+        if (m_analysisRate == 0) return false;
+
+        bool produced = false;
+        int16_t chunk[INPUT_CHUNK + 1];
+        while (count > 0)
+        {
+            size_t take = count < INPUT_CHUNK ? count : INPUT_CHUNK;
+            memcpy(chunk, samples, take * sizeof(int16_t));
+            size_t ready = m_decimator.process(chunk, take, chunk);
+            samples += take;
+            count -= take;
+
+            for (size_t i = 0; i < ready; i++)
+            {
+                // One bit of headroom keeps every squared difference inside 32 bits
+                m_window[m_fill++] = static_cast<int16_t>(chunk[i] >> 1);
+                if (m_fill < WINDOW) continue;
+
+                analyze();
+                produced = true;
+                memmove(m_window, m_window + m_hop, (WINDOW - m_hop) * sizeof(int16_t));
+                m_fill = WINDOW - m_hop;
+            }
+        }
+        return produced;
+    }
+
+    void PitchTracker::analyze()
+    {
+        const uint16_t span = WINDOW - m_maxLag - 1;
+        m_latest.sequence++;
+
+        uint64_t energy = 0;
+        for (uint16_t j = 0; j < span; j++)
+        {
+            int32_t x = m_window[j];
+            energy += static_cast<uint32_t>(x * x);
+        }
+        // Window samples are halved, so compare against (level / 2)^2
+        uint32_t floor = (static_cast<uint32_t>(m_silenceLevel) * m_silenceLevel) / 4;
+        bool loudEnough = energy / span >= floor;
+
+        // Difference function, then cumulative-mean normalisation
+        m_difference[0] = 0;
+        m_normalized[0] = 0x7FFF;
+        uint64_t running = 0;
+        for (uint16_t tau = 1; tau <= m_maxLag + 1; tau++)
+        {
+            const int16_t* a = m_window;
+            const int16_t* b = m_window + tau;
+            uint64_t sum = 0;
+            for (uint16_t j = 0; j < span; j++)
+            {
+                int32_t delta = a[j] - b[j];
+                sum += static_cast<uint32_t>(delta * delta);
+            }
+            uint32_t difference = static_cast<uint32_t>(sum >> 10);
+            m_difference[tau] = difference;
+
+            running += difference;
+            if (running == 0)
+            {
+                m_normalized[tau] = 0x7FFF;
+                continue;
+            }
+            uint64_t ratio = ((static_cast<uint64_t>(difference) * tau) << 15) / running;
+            m_normalized[tau] = static_cast<uint16_t>(ratio > 0xFFFF ? 0xFFFF : ratio);
+        }
+
+        uint16_t tau = chooseLag();
+        int32_t s0 = m_normalized[tau - 1];
+        int32_t s1 = m_normalized[tau];
+        int32_t s2 = m_normalized[tau + 1];
+
+        m_latest.confidence = s1 >= 32768 ? 0 : static_cast<uint8_t>(255 - (s1 >> 7));
+        m_latest.voiced = loudEnough && s1 < m_threshold;
+        if (!m_latest.voiced)
+        {
+            m_latest.frequencyQ4 = 0;
+            m_latest.note.index = 0;
+            m_latest.note.cents = 0;
+            return;
+        }
+
+        // Parabolic vertex through the three points around the dip, in 1/256 lag
+        int32_t curvature = s0 - 2 * s1 + s2;
+        int32_t offset = curvature > 0 ? ((s0 - s2) * 128) / curvature : 0;
+        offset = offset > 128 ? 128 : (offset < -128 ? -128 : offset);
+        uint32_t periodQ8 = (static_cast<uint32_t>(tau) << 8) + offset;
+
+        m_latest.frequencyQ4 = static_cast<uint32_t>((static_cast<uint64_t>(m_analysisRate) << 12) / periodQ8);
+        m_latest.note = nearestNote(m_latest.frequencyQ4);
+    }
+
+    uint16_t PitchTracker::chooseLag() const
+    {
+        // First dip under the threshold, followed down to its floor, avoids octave-low errors
+        for (uint16_t tau = m_minLag; tau <= m_maxLag; tau++)
+        {
+            if (m_normalized[tau] >= m_threshold) continue;
+            while (tau < m_maxLag && m_normalized[tau + 1] < m_normalized[tau]) tau++;
+            return tau;
+        }
+
+        uint16_t best = m_minLag;
+        for (uint16_t tau = m_minLag + 1; tau <= m_maxLag; tau++)
+        {
+            if (m_normalized[tau] < m_normalized[best]) best = tau;
+        }
+        return best;
+    }
+
+    int32_t PitchTracker::log2Q16(uint32_t value)
+    {
+        int32_t exponent = 31 - __builtin_clz(value);
+        uint32_t mantissa = exponent >= 16 ? value >> (exponent - 16) : value << (16 - exponent);
+        mantissa &= 0xFFFF;
+
+        uint32_t index = mantissa >> 10;
+        uint32_t fraction = mantissa & 0x3FF;
+        uint32_t low = LOG2_TABLE[index];
+        uint32_t high = LOG2_TABLE[index + 1];
+        return (exponent << 16) + static_cast<int32_t>(low + (((high - low) * fraction) >> 10));
+    }
+
+    NoteMatch PitchTracker::nearestNote(uint32_t frequencyQ4)
+    {
+        NoteMatch match = { 0, 0 };
+        if (frequencyQ4 == 0) return match;
+
+        int32_t semitonesQ16 = (log2Q16(frequencyQ4) - log2Q16(440u << 4)) * 12;
+        int32_t rounded = (semitonesQ16 + 32768) >> 16;
+        int32_t residual = semitonesQ16 - rounded * 65536;
+        int32_t cents = (residual * 100 + (residual >= 0 ? 32768 : -32768)) / 65536;
+
+        int32_t index = A4_INDEX + rounded;
+        if (index < 0)
+        {
+            cents += index * 100;
+            index = 0;
+        }
+        else if (index >= NOTE_COUNT)
+        {
+            cents += (index - (NOTE_COUNT - 1)) * 100;
+            index = NOTE_COUNT - 1;
+        }
+
+        match.index = static_cast<uint8_t>(index);
+        match.cents = static_cast<int8_t>(cents > 127 ? 127 : (cents < -127 ? -127 : cents));
+        return match;
+    }
+}
@@ -0,0 +1,121 @@
+/**
+ * @brief PitchTracker estimates the fundamental of live microphone audio
+ *
+ * Fixed-point YIN over a sliding window:
+ * - Input is decimated to at most 24 kHz with the recorder's half-band filter
+ * - Difference function and cumulative-mean normalisation in integer math
+ * - Parabolic refinement of the chosen lag for sub-sample period accuracy
+ * - Log-domain note lookup (no table scan) giving note index and cents
+ *
+ * All storage is inline and nothing touches Arduino, so accuracy and
+ * throughput can be checked on host with synthetic tones.
+ */
+
+#ifndef PITCH_TRACKER_H
+#define PITCH_TRACKER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "AudioCodecs.h"
+
+namespace AuditoryCortex
+{
+    /**
+     * @brief Nearest equal-tempered note for a frequency
+     */
+    struct NoteMatch
+    {
+        uint8_t index;  // Semitones above B0, as in PitchPerception::NOTE_FREQUENCIES
+        int8_t cents;   // -50..+50 in range; saturates outside B0..D#8
+    };
+
+    /**
+     * @brief One tracker update
+     */
+    struct PitchEstimate
+    {
+        uint32_t frequencyQ4;   // Hz * 16, 0 when unvoiced
+        uint8_t confidence;     // 0..255, 255 = perfectly periodic
+        bool voiced;
+        NoteMatch note;
+        uint32_t sequence;      // Increments on every analysed window
+    };
+
+    class PitchTracker
+    {
+    public:
+        static constexpr uint16_t WINDOW = 1024;            // Analysis window after decimation
+        static constexpr uint16_t MAX_LAG = WINDOW / 2;
+        static constexpr uint32_t MAX_ANALYSIS_RATE = 24000;
+        static constexpr uint16_t DEFAULT_THRESHOLD = 4915; // 0.15 in Q15, YIN's usual dip threshold
+        static constexpr uint8_t A4_INDEX = 46;
+        static constexpr uint8_t NOTE_COUNT = 88;
+
+        PitchTracker();
+
+        /**
+         * @brief Configure for an input rate and search range
+         * @param updatesPerSecond Hop size is chosen to hit this rate
+         * @return false if the range does not fit the window at this rate
+         */
+        bool begin(uint32_t sampleRate, uint16_t minFrequency = 70, uint16_t maxFrequency = 1600,
+                   uint8_t updatesPerSecond = 25);
+
+        /**
+         * @brief Drop buffered audio and the last estimate
+         */
+        void reset();
+
+        /**
+         * @brief Dip threshold in Q15; lower is stricter about voicing
+         */
+        void setThreshold(uint16_t thresholdQ15) { m_threshold = thresholdQ15; }
+
+        /**
+         * @brief RMS below which a window is reported unvoiced
+         */
+        void setSilenceLevel(uint16_t rms) { m_silenceLevel = rms; }
+
+        /**
+         * @brief Feed PCM at the configured input rate
+         * @return true if at least one new estimate was produced
+         */
+        bool process(const int16_t* samples, size_t count);
+
+        const PitchEstimate& latest() const { return m_latest; }
+        uint32_t analysisRate() const { return m_analysisRate; }
+
+        /**
+         * @brief O(1) frequency-to-note mapping in the log domain
+         */
+        static NoteMatch nearestNote(uint32_t frequencyQ4);
+
+        /**
+         * @brief log2(value) in Q16, table-interpolated; value must be non-zero
+         */
+        static int32_t log2Q16(uint32_t value);
+
+    private:
+        static const uint32_t LOG2_TABLE[65];
+        static constexpr uint16_t INPUT_CHUNK = 64;
+
+        Decimator m_decimator;
+        uint32_t m_analysisRate;
+        uint16_t m_minLag;
+        uint16_t m_maxLag;
+        uint16_t m_hop;
+        uint16_t m_fill;
+        uint16_t m_threshold;
+        uint16_t m_silenceLevel;
+        PitchEstimate m_latest;
+
+        int16_t m_window[WINDOW];
+        uint32_t m_difference[MAX_LAG + 2];
+        uint16_t m_normalized[MAX_LAG + 2];  // Cumulative-mean normalised difference, Q15
+
+        void analyze();
+        uint16_t chooseLag() const;
+    };
+}
+
+#endif // PITCH_TRACKER_H
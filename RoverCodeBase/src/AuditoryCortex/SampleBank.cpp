@@ -0,0 +1,441 @@
+/**
+ * @file SampleBank.cpp
+ * @brief Implementation of the in-memory clip cache and its player
+ */
+
+#include "SampleBank.h"
+#include <string.h>
+
+namespace AuditoryCortex
+{
+    namespace
+    {
+        const SampleClip STOP_MARKER = { nullptr, 0, 0 };
+    }
+
+    const SampleClip* const SamplePlayer::STOP = &STOP_MARKER;
+
+    SampleBank::SampleBank(const SampleSource& source, Allocate allocate, Release release)
+        : m_source(source),
+          m_allocate(allocate),
+          m_release(release),
+          m_budget(DEFAULT_BUDGET),
+          m_bytesUsed(0),
+          m_peakBytes(0),
+          m_clock(0),
+          m_hits(0),
+          m_misses(0),
+          m_loads(0),
+          m_loadFailures(0),
+          m_evictions(0)
+    {
+        for (uint8_t i = 0; i < MAX_CLIPS; i++)
+        {
+            Entry& entry = m_entries[i];
+            entry.clip.samples = nullptr;
+            entry.clip.count = 0;
+            entry.clip.sampleRate = 0;
+            entry.path[0] = '\0';
+            entry.hash = 0;
+            entry.bytes = 0;
+            entry.lastUse = 0;
+            entry.holds.store(0);
+            entry.used = false;
+            entry.pinned = false;
+            entry.missing = false;
+        }
+    }
+
+    SampleBank::~SampleBank()
+    {
+        for (uint8_t i = 0; i < MAX_CLIPS; i++)
+        {
+            if (m_entries[i].used) evict(m_entries[i]);
+        }
+    }
+
+    void SampleBank::setBudget(uint32_t bytes)
+    {
+        m_budget = bytes;
+        makeRoom(0);
+    }
+
+    bool SampleBank::preload(const char* path)
+    {
+        const SampleClip* clip = acquire(path);
+        if (!clip) return false;
+
+        Entry* entry = find(path, hashPath(path));
+        entry->pinned = true;
+        release(clip);
+        return true;
+    }
+
+    const SampleClip* SampleBank::acquire(const char* path)
+    {
+        if (!path || strlen(path) >= PATH_LENGTH) return nullptr;
+
+        uint32_t hash = hashPath(path);
+        Entry* entry = find(path, hash);
+        if (entry)
+        {
+            entry->lastUse = ++m_clock;
+            if (entry->missing)
+            {
+                m_misses++;
+                return nullptr;
+            }
+            m_hits++;
+        }
+        else
+        {
+            m_misses++;
+            entry = load(path, hash);
+            if (!entry || entry->missing) return nullptr;
+        }
+
+        entry->holds.fetch_add(1, std::memory_order_acquire);
+        return &entry->clip;
+    }
+
+    void SampleBank::release(const SampleClip* clip)
+    {
+        for (uint8_t i = 0; i < MAX_CLIPS; i++)
+        {
+            if (&m_entries[i].clip == clip)
+            {
+                m_entries[i].holds.fetch_sub(1, std::memory_order_release);
+                return;
+            }
+        }
+    }
+
+    bool SampleBank::contains(const char* path) const
+    {
+        if (!path) return false;
+        uint32_t hash = hashPath(path);
+        for (uint8_t i = 0; i < MAX_CLIPS; i++)
+        {
+            const Entry& entry = m_entries[i];
+            if (entry.used && !entry.missing && entry.hash == hash && strcmp(entry.path, path) == 0) return true;
+        }
+        return false;
+    }
+
+    void SampleBank::clear()
+    {
+        for (uint8_t i = 0; i < MAX_CLIPS; i++)
+        {
+            Entry& entry = m_entries[i];
+            if (entry.used && entry.holds.load(std::memory_order_acquire) == 0) evict(entry);
+        }
+    }
+
+    SampleBankStats SampleBank::stats() const
+    {
+        SampleBankStats snapshot;
+        snapshot.hits = m_hits;
+        snapshot.misses = m_misses;
+        snapshot.loads = m_loads;
+        snapshot.loadFailures = m_loadFailures;
+        snapshot.evictions = m_evictions;
+        snapshot.bytesUsed = m_bytesUsed;
+        snapshot.peakBytes = m_peakBytes;
+        snapshot.budgetBytes = m_budget;
+        snapshot.clips = 0;
+        snapshot.pinned = 0;
+        for (uint8_t i = 0; i < MAX_CLIPS; i++)
+        {
+            if (!m_entries[i].used || m_entries[i].missing) continue;
+            snapshot.clips++;
+            if (m_entries[i].pinned) snapshot.pinned++;
+        }
+        return snapshot;
+    }
+
+    SampleBank::Entry* SampleBank::find(const char* path, uint32_t hash)
+    {
+        for (uint8_t i = 0; i < MAX_CLIPS; i++)
+        {
+            Entry& entry = m_entries[i];
+            if (entry.used && entry.hash == hash && strcmp(entry.path, path) == 0) return &entry;
+        }
+        return nullptr;
+    }
+
+    SampleBank::Entry* SampleBank::load(const char* path, uint32_t hash)
+    {
+        Entry* entry = freeEntry();
+        if (!entry)
+        {
+            m_loadFailures++;
+            return nullptr;
+        }
+
+        strcpy(entry->path, path);
+        entry->hash = hash;
+        entry->used = true;
+        entry->pinned = false;
+        entry->missing = true;
+        entry->lastUse = ++m_clock;
+
+        if (!m_source.open || !m_source.open(m_source.context, path))
+        {
+            m_loadFailures++;
+            return entry;
+        }
+
+        WavFormatInfo info;
+        uint8_t header[WavCodec::MAX_HEADER_BYTES];
+        size_t headerLength = 0;
+        uint32_t capacity = 0;
+        int16_t* samples = nullptr;
+        if (readHeader(info, header, headerLength))
+        {
+            capacity = decodedSamples(info);
+            uint32_t bytes = capacity * sizeof(int16_t);
+            if (capacity > 0 && (!makeRoom(bytes) || !(samples = static_cast<int16_t*>(m_allocate(bytes)))))
+            {
+                // Out of room is not a property of the file; retry on a later trigger
+                m_source.close(m_source.context);
+                evict(*entry);
+                m_loadFailures++;
+                return nullptr;
+            }
+        }
+
+        uint32_t count = 0;
+        if (samples)
+        {
+            size_t lead = headerLength > info.dataOffset ? headerLength - info.dataOffset : 0;
+            count = decode(info, header + headerLength - lead, lead, samples, capacity);
+        }
+        m_source.close(m_source.context);
+
+        if (count == 0)
+        {
+            if (samples) m_release(samples);
+            m_loadFailures++;
+            return entry;
+        }
+
+        entry->clip.samples = samples;
+        entry->clip.count = count;
+        entry->clip.sampleRate = info.sampleRate;
+        entry->bytes = capacity * sizeof(int16_t);
+        entry->missing = false;
+
+        m_bytesUsed += entry->bytes;
+        if (m_bytesUsed > m_peakBytes) m_peakBytes = m_bytesUsed;
+        m_loads++;
+        return entry;
+    }
+
+    SampleBank::Entry* SampleBank::freeEntry()
+    {
+        Entry* oldest = nullptr;
+        for (uint8_t i = 0; i < MAX_CLIPS; i++)
+        {
+            Entry& entry = m_entries[i];
+            if (!entry.used) return &entry;
+            if (entry.pinned || entry.holds.load(std::memory_order_acquire) > 0) continue;
+            if (!oldest || entry.lastUse < oldest->lastUse) oldest = &entry;
+        }
+
+        if (oldest) evict(*oldest);
+        return oldest;
+    }
+
+    bool SampleBank::makeRoom(uint32_t bytes)
+    {
+        if (bytes > m_budget) return false;
+
+        while (m_bytesUsed + bytes > m_budget)
+        {
+            Entry* oldest = nullptr;
+            for (uint8_t i = 0; i < MAX_CLIPS; i++)
+            {
+                Entry& entry = m_entries[i];
+                if (!entry.used || entry.bytes == 0 || entry.pinned) continue;
+                if (entry.holds.load(std::memory_order_acquire) > 0) continue;
+                if (!oldest || entry.lastUse < oldest->lastUse) oldest = &entry;
+            }
+            if (!oldest) return false;
+            evict(*oldest);
+        }
+        return true;
+    }
+
+    void SampleBank::evict(Entry& entry)
+    {
+        if (entry.clip.samples)
+        {
+            m_release(const_cast<int16_t*>(entry.clip.samples));
+            m_bytesUsed -= entry.bytes;
+            m_evictions++;
+        }
+        entry.clip.samples = nullptr;
+        entry.clip.count = 0;
+        entry.bytes = 0;
+        entry.used = false;
+        entry.pinned = false;
+        entry.missing = false;
+    }
+
+    bool SampleBank::readHeader(WavFormatInfo& info, uint8_t* header, size_t& length)
+    {
+        length = m_source.read(m_source.context, header, WavCodec::MAX_HEADER_BYTES);
+        if (!WavCodec::parseHeader(header, length, info) || info.sampleRate == 0) return false;
+
+        // Skip whatever lies between the parsed bytes and the data chunk
+        uint8_t discard[32];
+        uint32_t position = length;
+        while (position < info.dataOffset)
+        {
+            size_t want = info.dataOffset - position < sizeof(discard) ? info.dataOffset - position : sizeof(discard);
+            size_t got = m_source.read(m_source.context, discard, want);
+            if (got == 0) return false;
+            position += got;
+        }
+
+        m_decoder.begin(info);
+        return true;
+    }
+
+    uint32_t SampleBank::decode(const WavFormatInfo& info, const uint8_t* lead, size_t leadLength,
+                                int16_t* out, uint32_t capacity)
+    {
+        uint8_t input[256];
+        uint32_t remaining = info.dataBytes;
+        uint32_t count = 0;
+
+        // Data bytes that arrived with the header go first
+        const uint8_t* data = lead;
+        size_t length = leadLength < remaining ? leadLength : remaining;
+
+        while (count < capacity)
+        {
+            if (length == 0)
+            {
+                if (remaining == 0) break;
+                size_t want = remaining < sizeof(input) ? remaining : sizeof(input);
+                length = m_source.read(m_source.context, input, want);
+                if (length == 0) break;  // Truncated file: keep what decoded
+                data = input;
+            }
+            remaining -= length;
+
+            size_t position = 0;
+            while (position < length && count < capacity)
+            {
+                size_t consumed = 0;
+                size_t samples = m_decoder.decode(data + position, length - position, consumed,
+                                                  out + count, capacity - count);
+                position += consumed;
+                count += samples;
+                if (consumed == 0 && samples == 0) break;
+            }
+            length = 0;
+        }
+        return count;
+    }
+
+    uint32_t SampleBank::hashPath(const char* path)
+    {
+        uint32_t hash = 2166136261u;  // FNV-1a
+        while (*path)
+        {
+            hash ^= static_cast<uint8_t>(*path++);
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    uint32_t SampleBank::decodedSamples(const WavFormatInfo& info)
+    {
+        switch (info.format)
+        {
+            case RecordingFormat::PCM16:
+                return info.dataBytes / sizeof(int16_t);
+            case RecordingFormat::MU_LAW:
+                return info.dataBytes;
+            case RecordingFormat::IMA_ADPCM:
+            {
+                if (info.blockAlign <= 4) return 0;
+                uint32_t blocks = (info.dataBytes + info.blockAlign - 1) / info.blockAlign;
+                return blocks * ((info.blockAlign - 4) * 2u + 1u);
+            }
+        }
+        return 0;
+    }
+
+    SamplePlayer::SamplePlayer(SampleBank& bank, uint32_t outputRate)
+        : m_bank(bank),
+          m_outputRate(outputRate),
+          m_pending(nullptr),
+          m_playing(false),
+          m_current(nullptr),
+          m_position(0),
+          m_fraction(0),
+          m_increment(1u << 16)
+    {
+    }
+
+    void SamplePlayer::start(const SampleClip* clip)
+    {
+        if (!clip) return;
+        const SampleClip* previous = m_pending.exchange(clip, std::memory_order_acq_rel);
+        if (previous && previous != STOP) m_bank.release(previous);
+    }
+
+    void SamplePlayer::stop()
+    {
+        const SampleClip* previous = m_pending.exchange(STOP, std::memory_order_acq_rel);
+        if (previous && previous != STOP) m_bank.release(previous);
+    }
+
+    size_t SamplePlayer::read(void* context, int16_t* out, size_t frames)
+    {
+        return static_cast<SamplePlayer*>(context)->render(out, frames);
+    }
+
+    size_t SamplePlayer::render(int16_t* out, size_t frames)
+    {
+        const SampleClip* next = m_pending.exchange(nullptr, std::memory_order_acq_rel);
+        if (next)
+        {
+            if (m_current) m_bank.release(m_current);
+            m_current = next == STOP ? nullptr : next;
+            m_position = 0;
+            m_fraction = 0;
+            if (m_current)
+            {
+                m_increment = static_cast<uint32_t>((static_cast<uint64_t>(m_current->sampleRate) << 16) / m_outputRate);
+                m_playing.store(true, std::memory_order_relaxed);
+            }
+        }
+        if (!m_current)
+        {
+            m_playing.store(false, std::memory_order_relaxed);
+            return 0;
+        }
+
+        // Nearest-sample resampling; clips are short UI sounds recorded at or below the output rate
+        size_t produced = 0;
+        while (produced < frames && m_position < m_current->count)
+        {
+            out[produced++] = m_current->samples[m_position];
+            m_fraction += m_increment;
+            m_position += m_fraction >> 16;
+            m_fraction &= 0xFFFF;
+        }
+
+        if (m_position >= m_current->count)
+        {
+            m_bank.release(m_current);
+            m_current = nullptr;
+            m_playing.store(false, std::memory_order_relaxed);
+        }
+        return produced;
+    }
+}
@@ -0,0 +1,194 @@
+/**
+ * @brief SampleBank keeps short sound clips decoded in memory
+ *
+ * UI sounds and voice lines are loaded once and triggered from RAM:
+ * - Mono WAV in PCM16, µ-law or IMA-ADPCM, decoded to PCM on load
+ * - Preloaded (pinned) at boot, or loaded on first use
+ * - Least-recently-used clips are evicted to stay under a byte budget
+ * - Clips in use by the render task are never evicted
+ *
+ * Storage and allocation are injected, so the bank runs against SPIFFS/SD
+ * and PSRAM on the rover and against plain memory on host.
+ */
+
+#ifndef SAMPLE_BANK_H
+#define SAMPLE_BANK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "AudioCodecs.h"
+
+namespace AuditoryCortex
+{
+    /**
+     * @brief Sequential file access used while loading a clip
+     */
+    struct SampleSource
+    {
+        bool (*open)(void* context, const char* path);
+        size_t (*read)(void* context, uint8_t* data, size_t length);
+        void (*close)(void* context);
+        void* context;
+    };
+
+    /**
+     * @brief A decoded clip; valid while held via acquire()
+     */
+    struct SampleClip
+    {
+        const int16_t* samples;
+        uint32_t count;
+        uint32_t sampleRate;
+    };
+
+    struct SampleBankStats
+    {
+        uint32_t hits;
+        uint32_t misses;
+        uint32_t loads;
+        uint32_t loadFailures;      // Missing, unsupported or over budget
+        uint32_t evictions;
+        uint32_t bytesUsed;
+        uint32_t peakBytes;
+        uint32_t budgetBytes;
+        uint8_t clips;
+        uint8_t pinned;
+    };
+
+    class SampleBank
+    {
+    public:
+        static constexpr uint8_t MAX_CLIPS = 24;
+        static constexpr uint8_t PATH_LENGTH = 40;
+        static constexpr uint32_t DEFAULT_BUDGET = 512 * 1024;
+
+        typedef void* (*Allocate)(size_t bytes);
+        typedef void (*Release)(void* memory);
+
+        SampleBank(const SampleSource& source, Allocate allocate, Release release);
+        ~SampleBank();
+
+        /**
+         * @brief Byte budget for decoded audio; shrinking evicts unpinned clips
+         */
+        void setBudget(uint32_t bytes);
+
+        /**
+         * @brief Load now and keep resident regardless of LRU order
+         */
+        bool preload(const char* path);
+
+        /**
+         * @brief Find or load a clip and hold it until release()
+         * @return nullptr if the clip cannot be loaded
+         */
+        const SampleClip* acquire(const char* path);
+
+        /**
+         * @brief Drop a hold; safe to call from the render task
+         */
+        void release(const SampleClip* clip);
+
+        /**
+         * @brief Whether a clip is resident, without loading or touching LRU order
+         */
+        bool contains(const char* path) const;
+
+        /**
+         * @brief Free every clip that is not held, pinned ones included
+         */
+        void clear();
+
+        SampleBankStats stats() const;
+
+    private:
+        struct Entry
+        {
+            SampleClip clip;
+            char path[PATH_LENGTH];
+            uint32_t hash;
+            uint32_t bytes;
+            uint32_t lastUse;
+            std::atomic<uint8_t> holds;
+            bool used;
+            bool pinned;
+            bool missing;               // Cached failure, so a bad path is not retried every trigger
+        };
+
+        SampleSource m_source;
+        Allocate m_allocate;
+        Release m_release;
+        uint32_t m_budget;
+        uint32_t m_bytesUsed;
+        uint32_t m_peakBytes;
+        uint32_t m_clock;
+        StreamDecoder m_decoder;
+
+        uint32_t m_hits;
+        uint32_t m_misses;
+        uint32_t m_loads;
+        uint32_t m_loadFailures;
+        uint32_t m_evictions;
+
+        Entry m_entries[MAX_CLIPS];
+
+        Entry* find(const char* path, uint32_t hash);
+        Entry* load(const char* path, uint32_t hash);
+        Entry* freeEntry();
+        bool makeRoom(uint32_t bytes);
+        void evict(Entry& entry);
+        bool readHeader(WavFormatInfo& info, uint8_t* header, size_t& length);
+        uint32_t decode(const WavFormatInfo& info, const uint8_t* lead, size_t leadLength,
+                        int16_t* out, uint32_t capacity);
+
+        static uint32_t hashPath(const char* path);
+        static uint32_t decodedSamples(const WavFormatInfo& info);
+    };
+
+    /**
+     * @brief Plays one clip at a time as an AudioMixer stream source
+     *
+     * start() is called from the control task; read() runs on the render task.
+     * The hand-off is a single atomic pointer, and finished clips are released
+     * back to the bank from the render side.
+     */
+    class SamplePlayer
+    {
+    public:
+        SamplePlayer(SampleBank& bank, uint32_t outputRate);
+
+        /**
+         * @brief Replace whatever is playing; takes over the caller's hold
+         */
+        void start(const SampleClip* clip);
+        void stop();
+        bool isPlaying() const
+        {
+            return m_playing.load(std::memory_order_relaxed) || m_pending.load(std::memory_order_relaxed) != nullptr;
+        }
+
+        /**
+         * @brief AudioMixer::StreamSource; context is the SamplePlayer
+         */
+        static size_t read(void* context, int16_t* out, size_t frames);
+
+    private:
+        static const SampleClip* const STOP;
+
+        SampleBank& m_bank;
+        uint32_t m_outputRate;
+        std::atomic<const SampleClip*> m_pending;
+        std::atomic<bool> m_playing;
+
+        // Render task only
+        const SampleClip* m_current;
+        uint32_t m_position;            // Source sample
+        uint32_t m_fraction;            // Q16 part of the position
+        uint32_t m_increment;           // Q16 source samples per output frame
+
+        size_t render(int16_t* out, size_t frames);
+    };
+}
+
+#endif // SAMPLE_BANK_H
@@ -0,0 +1,598 @@
+/**
+ * @file SongParser.cpp
+ * @brief Implementation of the streaming RTTTL and Standard MIDI File parser
+ */
+
+#include "SongParser.h"
+#include <string.h>
+
+namespace AuditoryCortex
+{
+    namespace
+    {
+        // C9..B9 in Hz; lower octaves are rounded right shifts
+        const uint16_t TOP_OCTAVE[12] = {
+            8372, 8870, 9397, 9956, 10548, 11175, 11840, 12544, 13290, 14080, 14917, 15804
+        };
+
+        // RTTTL letters a..h to semitones above C (h is the German B)
+        const int8_t RTTTL_SEMITONES[8] = { 9, 11, 0, 2, 4, 5, 7, 11 };
+
+        const uint32_t DEFAULT_TEMPO_MICROS = 500000;  // 120 BPM
+
+        uint32_t readBigEndian(const uint8_t* data, uint8_t bytes)
+        {
+            uint32_t value = 0;
+            for (uint8_t i = 0; i < bytes; i++) value = (value << 8) | data[i];
+            return value;
+        }
+
+        uint16_t clampMs(uint64_t micros)
+        {
+            uint64_t ms = (micros + 500) / 1000;
+            return static_cast<uint16_t>(ms > 0xFFFF ? 0xFFFF : ms);
+        }
+    }
+
+    SongParser::SongParser()
+    {
+        close();
+    }
+
+    void SongParser::close()
+    {
+        m_read = nullptr;
+        m_context = nullptr;
+        m_size = 0;
+        m_format = SongFormat::UNKNOWN;
+        m_error = SongError::NONE;
+        m_title[0] = '\0';
+        m_tempoMicros = DEFAULT_TEMPO_MICROS;
+        m_signatureNumerator = 4;
+        m_signatureDenominator = 4;
+        m_pendingStartMicros = 0;
+        m_hasPending = false;
+        m_defaultValue = 4;
+        m_defaultOctave = 6;
+        m_division = 0;
+        m_trackCount = 0;
+        m_tempoTick = 0;
+        m_tempoStartMicros = 0;
+    }
+
+    bool SongParser::fail(SongError error)
+    {
+        if (m_error == SongError::NONE) m_error = error;
+        return false;
+    }
+
+    /* ========================== Byte cursor ========================== */
+
+    void SongParser::startCursor(Cursor& cursor, uint32_t position, uint32_t end)
+    {
+        cursor.position = position;
+        cursor.end = end < m_size ? end : m_size;
+        cursor.index = 0;
+        cursor.length = 0;
+    }
+
+    bool SongParser::fill(Cursor& cursor)
+    {
+        if (cursor.index < cursor.length) return true;
+
+        cursor.position += cursor.length;
+        cursor.index = 0;
+        cursor.length = 0;
+        if (cursor.position >= cursor.end) return false;
+
+        uint32_t wanted = cursor.end - cursor.position;
+        if (wanted > WINDOW_BYTES) wanted = WINDOW_BYTES;
+        size_t got = m_read(m_context, cursor.position, cursor.buffer, wanted);
+        if (got == 0 || got > wanted) return fail(SongError::READ_FAILED);
+        cursor.length = static_cast<uint8_t>(got);
+        return true;
+    }
+
+    bool SongParser::readByte(Cursor& cursor, uint8_t& value)
+    {
+        if (!fill(cursor)) return false;
+        value = cursor.buffer[cursor.index++];
+        return true;
+    }
+
+    bool SongParser::peekByte(Cursor& cursor, uint8_t& value)
+    {
+        if (!fill(cursor)) return false;
+        value = cursor.buffer[cursor.index];
+        return true;
+    }
+
+    bool SongParser::skip(Cursor& cursor, uint32_t count)
+    {
+        uint32_t buffered = cursor.length - cursor.index;
+        if (count <= buffered)
+        {
+            cursor.index += count;
+            return true;
+        }
+
+        // Jump straight past the skipped region instead of reading it
+        uint32_t target = cursor.position + cursor.length + (count - buffered);
+        if (target > cursor.end || target < cursor.position) return false;
+        cursor.position = target;
+        cursor.index = 0;
+        cursor.length = 0;
+        return true;
+    }
+
+    bool SongParser::readVarLength(Cursor& cursor, uint32_t& value)
+    {
+        value = 0;
+        for (uint8_t i = 0; i < 4; i++)
+        {
+            uint8_t byte;
+            if (!readByte(cursor, byte)) return false;
+            value = (value << 7) | (byte & 0x7F);
+            if (!(byte & 0x80)) return true;
+        }
+        return fail(SongError::MALFORMED);
+    }
+
+    /* ========================== Output ordering ========================== */
+
+    bool SongParser::emit(const SongEvent& event, uint64_t startMicros, SongEvent& out)
+    {
+        // A note's advance is only known once the following onset is seen
+        if (!m_hasPending)
+        {
+            m_pending = event;
+            m_pendingStartMicros = startMicros;
+            m_hasPending = true;
+            return false;
+        }
+
+        out = m_pending;
+        out.advanceMs = clampMs(startMicros - m_pendingStartMicros);
+        m_pending = event;
+        m_pendingStartMicros = startMicros;
+        return true;
+    }
+
+    bool SongParser::flushPending(SongEvent& out)
+    {
+        if (!m_hasPending) return false;
+        out = m_pending;
+        out.advanceMs = out.durationMs;
+        m_hasPending = false;
+        return true;
+    }
+
+    void SongParser::classifyLength(uint32_t ticks, uint32_t ticksPerWhole, SongEvent& event)
+    {
+        event.noteValue = 0;
+        event.dotted = false;
+        for (uint16_t value = 1; value <= 128; value *= 2)
+        {
+            uint32_t plain = ticksPerWhole / value;
+            uint32_t dotted = plain + plain / 2;
+            uint32_t plainError = ticks > plain ? ticks - plain : plain - ticks;
+            uint32_t dottedError = ticks > dotted ? ticks - dotted : dotted - ticks;
+            if (plainError * 16 <= plain)
+            {
+                event.noteValue = static_cast<uint8_t>(value);
+                return;
+            }
+            if (dottedError * 16 <= dotted)
+            {
+                event.noteValue = static_cast<uint8_t>(value);
+                event.dotted = true;
+                return;
+            }
+        }
+    }
+
+    uint16_t SongParser::noteFrequency(uint8_t midiNote)
+    {
+        if (midiNote > 127) midiNote = 127;
+        uint8_t octave = midiNote / 12;
+        uint16_t top = TOP_OCTAVE[midiNote % 12];
+        if (octave >= 10) return top;
+        uint8_t shift = 10 - octave;
+        return static_cast<uint16_t>((top + (1u << (shift - 1))) >> shift);
+    }
+
+    /* ========================== Entry points ========================== */
+
+    bool SongParser::open(ReadAt read, void* context, uint32_t size)
+    {
+        close();
+        if (!read || size == 0) return fail(SongError::BAD_HEADER);
+        m_read = read;
+        m_context = context;
+        m_size = size;
+
+        uint8_t magic[4];
+        if (size >= 4 && m_read(m_context, 0, magic, 4) == 4 && memcmp(magic, "MThd", 4) == 0)
+        {
+            m_format = SongFormat::MIDI;
+            return openMidi();
+        }
+        m_format = SongFormat::RTTTL;
+        return openRtttl();
+    }
+
+    bool SongParser::next(SongEvent& event)
+    {
+        if (m_error != SongError::NONE) return false;
+        switch (m_format)
+        {
+            case SongFormat::RTTTL: return nextRtttl(event);
+            case SongFormat::MIDI: return nextMidi(event);
+            default: return false;
+        }
+    }
+
+    /* ========================== RTTTL ========================== */
+
+    bool SongParser::readRtttlNumber(uint16_t& value)
+    {
+        Cursor& cursor = m_tracks[0].cursor;
+        bool any = false;
+        value = 0;
+        uint8_t c;
+        while (peekByte(cursor, c) && c >= '0' && c <= '9')
+        {
+            value = value > 999 ? 9999 : value * 10 + (c - '0');
+            cursor.index++;
+            any = true;
+        }
+        return any;
+    }
+
+    bool SongParser::openRtttl()
+    {
+        Cursor& cursor = m_tracks[0].cursor;
+        startCursor(cursor, 0, m_size);
+
+        // name:
+        uint8_t c;
+        uint8_t titleLength = 0;
+        while (true)
+        {
+            if (!readByte(cursor, c)) return fail(SongError::BAD_HEADER);
+            if (c == ':') break;
+            if (c < 0x20 && c != '\r' && c != '\n' && c != '\t') return fail(SongError::BAD_HEADER);
+            if (titleLength < TITLE_LENGTH - 1) m_title[titleLength++] = static_cast<char>(c);
+        }
+        m_title[titleLength] = '\0';
+
+        // d=4,o=5,b=120:
+        uint16_t bpm = 63;
+        while (true)
+        {
+            if (!readByte(cursor, c)) return fail(SongError::BAD_HEADER);
+            if (c == ':') break;
+            if (c == ' ' || c == ',' || c == '\r' || c == '\n' || c == '\t') continue;
+
+            uint8_t key = c | 0x20;
+            uint8_t equals;
+            uint16_t value;
+            if (!readByte(cursor, equals) || equals != '=' || !readRtttlNumber(value))
+            {
+                return fail(SongError::BAD_HEADER);
+            }
+            // Unknown keys (l=, s=, ...) from other ringtone dialects are ignored
+            bool valid = true;
+            if (key == 'd') valid = value >= 1 && value <= 128 && (value & (value - 1)) == 0;
+            else if (key == 'o') valid = value <= 8;
+            else if (key == 'b') valid = value >= 1 && value <= 900;
+            if (!valid) return fail(SongError::BAD_HEADER);
+
+            if (key == 'd') m_defaultValue = static_cast<uint8_t>(value);
+            else if (key == 'o') m_defaultOctave = static_cast<uint8_t>(value);
+            else if (key == 'b') bpm = value;
+        }
+
+        m_tempoMicros = 60000000UL / bpm;
+        return true;
+    }
+
+    bool SongParser::nextRtttl(SongEvent& event)
+    {
+        Cursor& cursor = m_tracks[0].cursor;
+        uint8_t c;
+        while (peekByte(cursor, c) && (c == ',' || c == ' ' || c == '\r' || c == '\n' || c == '\t'))
+        {
+            cursor.index++;
+        }
+        if (!peekByte(cursor, c)) return false;
+
+        uint16_t value = m_defaultValue;
+        uint16_t parsed;
+        if (readRtttlNumber(parsed)) value = parsed;
+        if (value == 0 || value > 128 || (value & (value - 1)) != 0) return fail(SongError::MALFORMED);
+
+        if (!readByte(cursor, c)) return fail(SongError::MALFORMED);
+        c |= 0x20;
+        bool rest = c == 'p';
+        if (!rest && (c < 'a' || c > 'h')) return fail(SongError::MALFORMED);
+        int semitone = rest ? 0 : RTTTL_SEMITONES[c - 'a'];
+
+        bool dotted = false;
+        uint8_t octave = m_defaultOctave;
+        while (peekByte(cursor, c) && c != ',')
+        {
+            if (c == '#') semitone++;
+            else if (c == '.') dotted = true;
+            else if (c >= '0' && c <= '9') octave = c - '0';
+            else if (c == ' ' || c == '\r' || c == '\n' || c == '\t') { }
+            else return fail(SongError::MALFORMED);
+            cursor.index++;
+        }
+        if (m_error != SongError::NONE) return false;
+
+        uint64_t micros = static_cast<uint64_t>(m_tempoMicros) * 4 / value;
+        if (dotted) micros += micros / 2;
+
+        int midiNote = (octave + 1) * 12 + semitone;
+        event.frequency = rest ? 0 : noteFrequency(static_cast<uint8_t>(midiNote > 127 ? 127 : midiNote));
+        event.midiNote = rest ? 0 : static_cast<uint8_t>(midiNote > 127 ? 127 : midiNote);
+        event.durationMs = clampMs(micros);
+        event.advanceMs = event.durationMs;
+        event.velocity = 100;
+        event.noteValue = static_cast<uint8_t>(value);
+        event.dotted = dotted;
+        return true;
+    }
+
+    /* ========================== Standard MIDI File ========================== */
+
+    bool SongParser::openMidi()
+    {
+        uint8_t header[14];
+        if (m_size < sizeof(header) || m_read(m_context, 0, header, sizeof(header)) != sizeof(header))
+        {
+            return fail(SongError::BAD_HEADER);
+        }
+
+        uint32_t headerLength = readBigEndian(header + 4, 4);
+        uint16_t format = static_cast<uint16_t>(readBigEndian(header + 8, 2));
+        uint16_t declaredTracks = static_cast<uint16_t>(readBigEndian(header + 10, 2));
+        uint16_t division = static_cast<uint16_t>(readBigEndian(header + 12, 2));
+        if (headerLength < 6 || declaredTracks == 0) return fail(SongError::BAD_HEADER);
+        if (format > 1 || (division & 0x8000) || division == 0) return fail(SongError::UNSUPPORTED);
+        m_division = division;
+
+        // Walk chunk headers only; track bodies are streamed later
+        uint32_t offset = 8 + headerLength;
+        while (m_trackCount < MAX_TRACKS && m_trackCount < declaredTracks && offset >= 8 && offset + 8 <= m_size)
+        {
+            uint8_t chunk[8];
+            if (m_read(m_context, offset, chunk, sizeof(chunk)) != sizeof(chunk)) return fail(SongError::READ_FAILED);
+            uint32_t length = readBigEndian(chunk + 4, 4);
+            uint32_t body = offset + 8;
+
+            if (memcmp(chunk, "MTrk", 4) == 0)
+            {
+                Track& track = m_tracks[m_trackCount++];
+                uint32_t end = length > m_size - body ? m_size : body + length;
+                startCursor(track.cursor, body, end);
+                track.nextTick = 0;
+                track.runningStatus = 0;
+                track.done = false;
+                readDelta(track);
+            }
+
+            if (length > m_size - body) break;
+            offset = body + length;
+        }
+
+        if (m_trackCount == 0) return fail(SongError::BAD_HEADER);
+        return m_error == SongError::NONE;
+    }
+
+    bool SongParser::readDelta(Track& track)
+    {
+        uint32_t delta;
+        if (!readVarLength(track.cursor, delta))
+        {
+            // A track that stops without End of Track simply ends here
+            track.done = true;
+            return false;
+        }
+        track.nextTick += delta;
+        if (track.nextTick < delta) track.done = true;
+        return !track.done;
+    }
+
+    SongParser::ReadResult SongParser::readMessage(Cursor& cursor, uint8_t& runningStatus, Message& message)
+    {
+        uint8_t byte;
+        if (!readByte(cursor, byte)) return ReadResult::END;
+
+        bool haveData1 = false;
+        if (byte & 0x80)
+        {
+            message.status = byte;
+        }
+        else
+        {
+            if (runningStatus == 0) return ReadResult::BAD;
+            message.status = runningStatus;
+            message.data1 = byte;
+            haveData1 = true;
+        }
+        message.data2 = 0;
+        message.metaType = 0;
+        message.length = 0;
+
+        if (message.status == 0xFF)
+        {
+            runningStatus = 0;
+            if (!readByte(cursor, message.metaType)) return ReadResult::END;
+            if (!readVarLength(cursor, message.length)) return m_error == SongError::NONE ? ReadResult::END : ReadResult::BAD;
+            return ReadResult::OK;
+        }
+
+        if (message.status == 0xF0 || message.status == 0xF7)
+        {
+            runningStatus = 0;
+            uint32_t length;
+            if (!readVarLength(cursor, length)) return m_error == SongError::NONE ? ReadResult::END : ReadResult::BAD;
+            return skip(cursor, length) ? ReadResult::OK : ReadResult::END;
+        }
+
+        if (message.status >= 0xF0) return ReadResult::BAD;
+
+        runningStatus = message.status;
+        uint8_t type = message.status & 0xF0;
+        if (!haveData1 && !readByte(cursor, message.data1)) return ReadResult::END;
+        if (message.data1 & 0x80) return ReadResult::BAD;
+        if (type != 0xC0 && type != 0xD0)
+        {
+            if (!readByte(cursor, message.data2)) return ReadResult::END;
+            if (message.data2 & 0x80) return ReadResult::BAD;
+        }
+        return ReadResult::OK;
+    }
+
+    uint64_t SongParser::tickToMicros(uint32_t tick) const
+    {
+        return m_tempoStartMicros + static_cast<uint64_t>(tick - m_tempoTick) * m_tempoMicros / m_division;
+    }
+
+    uint32_t SongParser::findNoteLength(const Track& track, uint8_t channel, uint8_t note)
+    {
+        // Scan a private copy of the track for the matching release
+        Cursor cursor = track.cursor;
+        uint8_t runningStatus = track.runningStatus;
+        uint32_t start = cursor.position + cursor.index;
+        uint32_t ticks = 0;
+
+        while (cursor.position + cursor.index - start < LOOKAHEAD_BYTES)
+        {
+            uint32_t delta;
+            if (!readVarLength(cursor, delta)) break;
+            ticks += delta;
+
+            Message message;
+            if (readMessage(cursor, runningStatus, message) != ReadResult::OK) break;
+            if (message.status == 0xFF)
+            {
+                if (message.metaType == 0x2F || !skip(cursor, message.length)) break;
+                continue;
+            }
+
+            uint8_t type = message.status & 0xF0;
+            bool sameKey = (message.status & 0x0F) == channel && message.data1 == note;
+            if (sameKey && (type == 0x80 || type == 0x90)) return ticks;
+        }
+
+        // Unterminated within reach: hold for one beat
+        return ticks > 0 && ticks < m_division ? ticks : m_division;
+    }
+
+    bool SongParser::nextMidi(SongEvent& event)
+    {
+        while (m_error == SongError::NONE)
+        {
+            Track* track = nullptr;
+            for (uint8_t t = 0; t < m_trackCount; t++)
+            {
+                if (m_tracks[t].done) continue;
+                if (!track || m_tracks[t].nextTick < track->nextTick) track = &m_tracks[t];
+            }
+            if (!track) return flushPending(event);
+
+            uint32_t tick = track->nextTick;
+            if (tick < m_tempoTick) return fail(SongError::MALFORMED);
+
+            Message message;
+            ReadResult result = readMessage(track->cursor, track->runningStatus, message);
+            if (result == ReadResult::BAD) return fail(SongError::MALFORMED);
+            if (result == ReadResult::END)
+            {
+                track->done = true;
+                continue;
+            }
+
+            if (message.status == 0xFF)
+            {
+                uint8_t data[4];
+                uint32_t kept = message.length < sizeof(data) ? message.length : sizeof(data);
+                if (message.metaType == 0x03 && m_title[0] == '\0')
+                {
+                    uint32_t copy = message.length < TITLE_LENGTH - 1 ? message.length : TITLE_LENGTH - 1;
+                    uint8_t i = 0;
+                    for (; i < copy; i++)
+                    {
+                        uint8_t c;
+                        if (!readByte(track->cursor, c)) break;
+                        m_title[i] = c >= 0x20 && c < 0x7F ? static_cast<char>(c) : '?';
+                    }
+                    m_title[i] = '\0';
+                    kept = i;
+                }
+                else
+                {
+                    for (uint32_t i = 0; i < kept; i++)
+                    {
+                        if (!readByte(track->cursor, data[i])) kept = i;
+                    }
+                }
+
+                if (message.metaType == 0x2F)
+                {
+                    track->done = true;
+                    continue;
+                }
+                if (!skip(track->cursor, message.length - kept))
+                {
+                    track->done = true;
+                    continue;
+                }
+
+                if (message.metaType == 0x51 && message.length == 3)
+                {
+                    uint32_t tempo = readBigEndian(data, 3);
+                    if (tempo > 0)
+                    {
+                        m_tempoStartMicros = tickToMicros(tick);
+                        m_tempoTick = tick;
+                        m_tempoMicros = tempo;
+                    }
+                }
+                else if (message.metaType == 0x58 && message.length >= 2 && data[1] <= 7 && data[0] > 0)
+                {
+                    m_signatureNumerator = data[0];
+                    m_signatureDenominator = static_cast<uint8_t>(1u << data[1]);
+                }
+                readDelta(*track);
+                continue;
+            }
+
+            uint8_t type = message.status & 0xF0;
+            uint8_t channel = message.status & 0x0F;
+            bool noteOn = type == 0x90 && message.data2 > 0 && channel != 9;  // Channel 10 is percussion
+            if (!noteOn)
+            {
+                readDelta(*track);
+                continue;
+            }
+
+            uint32_t lengthTicks = findNoteLength(*track, channel, message.data1);
+            SongEvent note;
+            note.frequency = noteFrequency(message.data1);
+            note.midiNote = message.data1;
+            note.velocity = message.data2;
+            note.durationMs = clampMs(static_cast<uint64_t>(lengthTicks) * m_tempoMicros / m_division);
+            note.advanceMs = note.durationMs;
+            classifyLength(lengthTicks, static_cast<uint32_t>(m_division) * 4, note);
+
+            uint64_t start = tickToMicros(tick);
+            readDelta(*track);
+            if (emit(note, start, event)) return true;
+        }
+        return false;
+    }
+}
@@ -0,0 +1,190 @@
+/**
+ * @brief SongParser streams RTTTL and Standard MIDI songs from storage
+ *
+ * Songs are pulled one note at a time through a random-access read callback:
+ * - RTTTL ringtone strings ("name:d=4,o=5,b=120:8c6,8p,...")
+ * - SMF format 0 and 1, tracks merged by tick, tempo map applied
+ * - Each MIDI track reads through its own small window, so memory use is
+ *   fixed regardless of file size
+ *
+ * Note lengths are also reported as note values (quarter, eighth, ...) so the
+ * player can map them onto PitchPerception::getNoteDuration. Nothing here
+ * touches Arduino, so the parser can be fed fuzzed input on host.
+ */
+
+#ifndef SONG_PARSER_H
+#define SONG_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace AuditoryCortex
+{
+    enum class SongFormat : uint8_t
+    {
+        UNKNOWN = 0,
+        RTTTL = 1,
+        MIDI = 2
+    };
+
+    enum class SongError : uint8_t
+    {
+        NONE = 0,
+        READ_FAILED,
+        BAD_HEADER,
+        UNSUPPORTED,    // SMPTE time division or format 2
+        MALFORMED       // Truncated or inconsistent event data
+    };
+
+    /**
+     * @brief One note in onset order
+     */
+    struct SongEvent
+    {
+        uint16_t frequency;     // Hz, 0 = rest
+        uint16_t durationMs;    // Sounding time
+        uint16_t advanceMs;     // Onset to the next onset
+        uint8_t velocity;       // 1..127
+        uint8_t midiNote;       // 0 for rests
+        uint8_t noteValue;      // 1 = whole, 4 = quarter ... 128; 0 if not a plain value
+        bool dotted;
+    };
+
+    class SongParser
+    {
+    public:
+        static constexpr uint8_t MAX_TRACKS = 16;
+        static constexpr uint8_t WINDOW_BYTES = 64;
+        static constexpr uint16_t LOOKAHEAD_BYTES = 2048;  // Note-off search limit
+        static constexpr uint8_t TITLE_LENGTH = 24;
+
+        /**
+         * @brief Random-access source; returns bytes read (short at end of file)
+         */
+        typedef size_t (*ReadAt)(void* context, uint32_t offset, uint8_t* data, size_t length);
+
+        SongParser();
+
+        /**
+         * @brief Detect the format and read the song header
+         * @param size Total source length in bytes
+         */
+        bool open(ReadAt read, void* context, uint32_t size);
+
+        /**
+         * @brief Produce the next note
+         * @return false at the end of the song or on error()
+         */
+        bool next(SongEvent& event);
+
+        void close();
+
+        SongFormat format() const { return m_format; }
+        SongError error() const { return m_error; }
+        const char* title() const { return m_title; }
+
+        /**
+         * @brief Current tempo and time signature as seen by the last event
+         */
+        uint16_t beatMs() const { return static_cast<uint16_t>(m_tempoMicros / 1000); }
+        uint8_t signatureNumerator() const { return m_signatureNumerator; }
+        uint8_t signatureDenominator() const { return m_signatureDenominator; }
+
+        /**
+         * @brief MIDI note number to Hz, equal temperament at A4 = 440
+         */
+        static uint16_t noteFrequency(uint8_t midiNote);
+
+    private:
+        /**
+         * @brief Buffered forward reader over one region of the source
+         */
+        struct Cursor
+        {
+            uint32_t position;   // Source offset of buffer[0]
+            uint32_t end;
+            uint8_t index;
+            uint8_t length;
+            uint8_t buffer[WINDOW_BYTES];
+        };
+
+        /**
+         * @brief One decoded MIDI message; meta payloads are left unread
+         */
+        struct Message
+        {
+            uint8_t status;
+            uint8_t data1;
+            uint8_t data2;
+            uint8_t metaType;
+            uint32_t length;    // Meta payload bytes
+        };
+
+        enum class ReadResult : uint8_t
+        {
+            OK,
+            END,        // Source ran out mid-track
+            BAD         // Not valid SMF event data
+        };
+
+        struct Track
+        {
+            Cursor cursor;
+            uint32_t nextTick;
+            uint8_t runningStatus;
+            bool done;
+        };
+
+        ReadAt m_read;
+        void* m_context;
+        uint32_t m_size;
+        SongFormat m_format;
+        SongError m_error;
+        char m_title[TITLE_LENGTH];
+
+        // Shared timing state
+        uint32_t m_tempoMicros;         // Per quarter note
+        uint8_t m_signatureNumerator;
+        uint8_t m_signatureDenominator;
+        SongEvent m_pending;
+        uint64_t m_pendingStartMicros;
+        bool m_hasPending;
+
+        // RTTTL defaults
+        uint8_t m_defaultValue;
+        uint8_t m_defaultOctave;
+
+        // MIDI state
+        uint16_t m_division;            // Ticks per quarter note
+        uint8_t m_trackCount;
+        uint32_t m_tempoTick;           // Tick of the last tempo change
+        uint64_t m_tempoStartMicros;    // Song time at m_tempoTick
+        Track m_tracks[MAX_TRACKS];
+
+        bool fail(SongError error);
+        bool fill(Cursor& cursor);
+        bool readByte(Cursor& cursor, uint8_t& value);
+        bool peekByte(Cursor& cursor, uint8_t& value);
+        bool skip(Cursor& cursor, uint32_t count);
+        bool readVarLength(Cursor& cursor, uint32_t& value);
+        void startCursor(Cursor& cursor, uint32_t position, uint32_t end);
+
+        bool emit(const SongEvent& event, uint64_t startMicros, SongEvent& out);
+        bool flushPending(SongEvent& out);
+
+        bool openRtttl();
+        bool nextRtttl(SongEvent& event);
+        bool readRtttlNumber(uint16_t& value);
+
+        bool openMidi();
+        bool nextMidi(SongEvent& event);
+        bool readDelta(Track& track);
+        ReadResult readMessage(Cursor& cursor, uint8_t& runningStatus, Message& message);
+        uint64_t tickToMicros(uint32_t tick) const;
+        uint32_t findNoteLength(const Track& track, uint8_t channel, uint8_t note);
+
+        static void classifyLength(uint32_t ticks, uint32_t ticksPerWhole, SongEvent& event);
+    };
+}
+
+#endif // SONG_PARSER_H
@@ -0,0 +1,117 @@
+/**
+ * @file SoundEffects.cpp
+ * @brief Event tables for the fixed UI and error sounds
+ */
+
+#include "SoundEffects.h"
+#include "PitchPerception.h"
+
+namespace AuditoryCortex
+{
+    using PC::AudioTypes::Tone;
+
+    namespace
+    {
+        constexpr uint8_t V = SoundEffects::DEFAULT_VOLUME;
+
+        // { frequency, duration, onset-to-onset, volume, cue }
+        constexpr ToneEvent RECORDING_ERROR_EVENTS[] = 
+        {
+            { PitchPerception::NOTE_B5, 200, 300, V, 0 },
+            { PitchPerception::NOTE_G5, 200, 300, V, 0 },
+            { PitchPerception::NOTE_D5, 400, 400, V, 0 }
+        };
+
+        constexpr ToneEvent STORAGE_ERROR_EVENTS[] = 
+        {
+            { PitchPerception::NOTE_G5, 200, 300, V, 0 },
+            { PitchPerception::NOTE_G5, 200, 300, V, 0 },
+            { PitchPerception::NOTE_G4, 400, 400, V, 0 }
+        };
+
+        constexpr ToneEvent PLAYBACK_ERROR_EVENTS[] = 
+        {
+            { PitchPerception::NOTE_D5, 200, 300, V, 0 },
+            { PitchPerception::NOTE_D5, 200, 300, V, 0 },
+            { PitchPerception::NOTE_D4, 400, 400, V, 0 }
+        };
+
+        constexpr ToneEvent SUCCESS_EVENTS[] = 
+        {
+            { PitchPerception::NOTE_C5, 100, 150, V, 0 },
+            { PitchPerception::NOTE_E5, 100, 150, V, 0 },
+            { PitchPerception::NOTE_G5, 200, 200, V, 0 }
+        };
+
+        constexpr ToneEvent NOTIFICATION_EVENTS[] = 
+        {
+            { PitchPerception::NOTE_C5, 100, 100, V, 0 }
+        };
+
+        // Rising arpeggio resolving onto a held major chord (stacked onsets advance 0)
+        constexpr ToneEvent LEVEL_UP_EVENTS[] = 
+        {
+            { PitchPerception::NOTE_G4, 80, 100, V, 0 },
+            { PitchPerception::NOTE_C5, 80, 100, V, 0 },
+            { PitchPerception::NOTE_E5, 80, 100, V, 0 },
+            { PitchPerception::NOTE_C5, 300, 0, V, 0 },
+            { PitchPerception::NOTE_E5, 300, 0, V, 0 },
+            { PitchPerception::NOTE_G5, 300, 0, V, 0 },
+            { PitchPerception::NOTE_C6, 300, 300, V, 0 }
+        };
+
+        constexpr ToneEvent MENU_SELECT_EVENTS[] = 
+        {
+            { PitchPerception::NOTE_E5, 100, 150, V, 0 },
+            { PitchPerception::NOTE_C5, 100, 150, V, 0 },
+            { PitchPerception::NOTE_E5, 100, 150, V, 0 },
+            { PitchPerception::NOTE_G5, 100, 100, V, 0 }
+        };
+
+        const SoundEffect RECORDING_ERROR = { "error_recording", TonePriority::ALERT, RECORDING_ERROR_EVENTS };
+        const SoundEffect STORAGE_ERROR = { "error_storage", TonePriority::ALERT, STORAGE_ERROR_EVENTS };
+        const SoundEffect PLAYBACK_ERROR = { "error_playback", TonePriority::ALERT, PLAYBACK_ERROR_EVENTS };
+        const SoundEffect SUCCESS = { "success", TonePriority::UI, SUCCESS_EVENTS };
+        const SoundEffect NOTIFICATION = { "notification", TonePriority::UI, NOTIFICATION_EVENTS };
+        const SoundEffect LEVEL_UP = { "level_up", TonePriority::UI, LEVEL_UP_EVENTS };
+        const SoundEffect MENU_SELECT = { "menu_select", TonePriority::UI, MENU_SELECT_EVENTS };
+        const SoundEffect NO_EFFECT = { "none", TonePriority::UI, ConstSpan<ToneEvent>() };
+
+        const SoundEffect* const ALL_EFFECTS[] = 
+        {
+            &RECORDING_ERROR, &STORAGE_ERROR, &PLAYBACK_ERROR,
+            &SUCCESS, &NOTIFICATION, &LEVEL_UP, &MENU_SELECT
+        };
+    }
+
+    const SoundEffect& SoundEffects::get(Tone type) 
+    {
+        switch (type) 
+        {
+            case Tone::SUCCESS:      return SUCCESS;
+            case Tone::ERROR:        return PLAYBACK_ERROR;
+            case Tone::WARNING:      return STORAGE_ERROR;
+            case Tone::NOTIFICATION: return NOTIFICATION;
+            case Tone::LEVEL_UP:     return LEVEL_UP;
+            case Tone::GAME_OVER:    return PLAYBACK_ERROR;
+            case Tone::MENU_SELECT:  return MENU_SELECT;
+            default:                 return NO_EFFECT;    // NONE, TIMER_DROP, MENU_CHANGE
+        }
+    }
+
+    const SoundEffect& SoundEffects::get(ErrorSoundType type) 
+    {
+        switch (type) 
+        {
+            case ErrorSoundType::RECORDING: return RECORDING_ERROR;
+            case ErrorSoundType::STORAGE:   return STORAGE_ERROR;
+            case ErrorSoundType::PLAYBACK:  return PLAYBACK_ERROR;
+        }
+        return NO_EFFECT;
+    }
+
+    ConstSpan<const SoundEffect*> SoundEffects::all() 
+    {
+        return ALL_EFFECTS;
+    }
+}
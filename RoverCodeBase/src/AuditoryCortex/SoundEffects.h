@@ -0,0 +1,45 @@
+/**
+ * @brief SoundEffects holds the fixed UI and error sounds as event tables
+ *
+ * Each effect is a constexpr list of sequencer events plus the lane it plays
+ * on, so SoundFxManager queues them and OfflineRenderer can replay exactly the
+ * same data on host. Effects that depend on runtime context (the day-based
+ * rotary click, colour-mapped timer drops, card melodies) stay in code.
+ */
+
+#ifndef SOUND_EFFECTS_H
+#define SOUND_EFFECTS_H
+
+#include "../CorpusCallosum/SynapticPathways.h"
+#include "../PrefrontalCortex/ProtoPerceptions.h"
+#include "ToneSequencer.h"
+
+namespace AuditoryCortex
+{
+    using namespace CorpusCallosum;
+    using PC::ConstSpan;
+    using PC::AudioTypes::ErrorSoundType;
+
+    struct SoundEffect
+    {
+        const char* name;
+        TonePriority lane;
+        ConstSpan<ToneEvent> events;    // Empty for context-dependent effects
+    };
+
+    class SoundEffects
+    {
+    public:
+        static constexpr uint8_t DEFAULT_VOLUME = 42;
+
+        static const SoundEffect& get(PC::AudioTypes::Tone type);
+        static const SoundEffect& get(ErrorSoundType type);
+
+        /**
+         * @brief Every table-driven effect, for offline rendering
+         */
+        static ConstSpan<const SoundEffect*> all();
+    };
+}
+
+#endif // SOUND_EFFECTS_H
@@ -13,6 +13,7 @@
 #include <time.h>
 #include <SPIFFS.h>
 #include "../PrefrontalCortex/SDManager.h"
+#include "../PrefrontalCortex/SPIManager.h"
 #include "../VisualCortex/RoverViewManager.h"
 #include "../VisualCortex/RoverManager.h"
 #include "../VisualCortex/LEDManager.h"
@@ -33,6 +34,8 @@ namespace AuditoryCortex
     using PC::AudioTypes::Tune;
     using PC::AudioTypes::NoteInfo;
     using PC::AudioTypes::TimeSignature;
+    using AuditoryCortex::ToneEvent;
+    using AuditoryCortex::TonePriority;
 
     // Initialize static members with meaningful defaults
     bool SoundFxManager::_isInitialized = false;
@@ -44,25 +47,307 @@ namespace AuditoryCortex
     int SoundFxManager::currentNote = 0;
     unsigned long SoundFxManager::lastNoteTime = 0;
     bool SoundFxManager::m_isTunePlaying = false;
-    Audio SoundFxManager::audio;
     const char* SoundFxManager::RECORD_FILENAME = "/sdcard/temp_record.wav";
-    File SoundFxManager::recordFile;
+    PC::StorageBackend::Handle SoundFxManager::recordFile = nullptr;
+    uint32_t SoundFxManager::recordOffset = 0;
+    PC::StorageFuture SoundFxManager::recordWrite;
+    uint8_t* SoundFxManager::captureStorage = nullptr;
+    uint8_t* SoundFxManager::captureBlock = nullptr;
+    CaptureRing* SoundFxManager::captureRing = nullptr;
+    CaptureWriter* SoundFxManager::captureWriter = nullptr;
+    TaskHandle_t SoundFxManager::captureTaskHandle = nullptr;
+    TaskHandle_t SoundFxManager::writerTaskHandle = nullptr;
+    volatile bool SoundFxManager::captureRunning = false;
+    EventGroupHandle_t SoundFxManager::captureEvents = nullptr;
+    std::atomic<uint8_t> SoundFxManager::captureHolds(0);
+    volatile bool SoundFxManager::pitchTracking = false;
+    AudioEncoder SoundFxManager::captureEncoder;
+    RecordingFormat SoundFxManager::recordingFormat = RecordingFormat::IMA_ADPCM;
+    uint8_t SoundFxManager::recordingDecimation = 1;
+    File SoundFxManager::playbackFile;
+    StreamDecoder SoundFxManager::playbackDecoder;
+    uint8_t* SoundFxManager::playbackStorage = nullptr;
+    CaptureRing* SoundFxManager::playbackRing = nullptr;
+    uint8_t SoundFxManager::playbackStep = 1;
+    std::atomic<bool> SoundFxManager::streamPlaying(false);
+    std::atomic<bool> SoundFxManager::playbackReading(false);
+    File SoundFxManager::songFile;
+    SongParser SoundFxManager::songParser;
+    bool SoundFxManager::songPlaying = false;
+    NoteSource SoundFxManager::noteSource = nullptr;
+    void* SoundFxManager::noteSourceContext = nullptr;
 
     PC::AudioTypes::TunesTypes SoundFxManager::selectedSong = PC::AudioTypes::TunesTypes::ROVERBYTE_JINGLE;
     PC::AudioTypes::Tune SoundFxManager::activeTune;
+    ToneSequencer SoundFxManager::sequencer;
+    WavetableSynth SoundFxManager::synth(EXAMPLE_SAMPLE_RATE);
+    AudioMixer SoundFxManager::mixer(SoundFxManager::synth, SoundFxManager::captureClock);
+    MediaClock SoundFxManager::mediaClock(EXAMPLE_SAMPLE_RATE, SoundFxManager::captureClock);
+    File SoundFxManager::sampleFile;
+    bool SoundFxManager::sampleOnCard = false;
+    SoundFxManager::LitTone SoundFxManager::litTones[SoundFxManager::LIT_TONE_SLOTS];
+    uint8_t SoundFxManager::nextLitTone = 0;
+    SampleBank SoundFxManager::sampleBank(
+        { SoundFxManager::openSampleFile, SoundFxManager::readSampleFile, SoundFxManager::closeSampleFile, nullptr },
+        SoundFxManager::allocateSample, SoundFxManager::releaseSample);
+    SamplePlayer SoundFxManager::samplePlayer(SoundFxManager::sampleBank, EXAMPLE_SAMPLE_RATE);
+
+    namespace
+    {
+        // Voice lines with a recorded clip replace their tone chains in playVoiceLine
+        const char* const VOICE_LINES[] = 
+        {
+            "waiting_for_card", "scan_complete", "scan_error", "level_up", "volume_up", "volume_down"
+        };
+        const char* const VOICE_LINE_FORMAT = "/voice/%s.wav";
+    }
+    TaskHandle_t SoundFxManager::synthTaskHandle = nullptr;
+    volatile bool SoundFxManager::synthOutputReady = false;
 
     void SoundFxManager::playTone(int frequency, int duration, int volume) 
     {
         if (frequency <= 0) return;
 
-        const int TONE_PWM_CHANNEL = 0;  // Define PWM channel
-        ledcSetup(TONE_PWM_CHANNEL, frequency, 8);  // 8-bit resolution
-        ledcWrite(TONE_PWM_CHANNEL, volume);
-        
-        if (duration > 0) 
+        if (duration <= 0) 
+        {
+            // Sustained tone: held until stopTones()
+            synth.noteOn(SUSTAIN_TAG, frequency, constrain(volume, 0, 255), static_cast<uint8_t>(MixChannel::UI));
+            mixer.trigger(MixChannel::UI);
+            return;
+        }
+
+        queueTone(frequency, duration, 0, TonePriority::UI, volume);
+    }
+
+    void SoundFxManager::queueTone(uint16_t frequency, uint16_t duration, uint16_t gap,
+                                   TonePriority priority, int volume)
+    {
+        if (!sequencer.enqueueTone(priority, frequency, duration, gap, constrain(volume, 0, 255))) 
+        {
+            Utilities::LOG_WARNING("Tone queue full, dropping %u Hz", frequency);
+        }
+    }
+
+    void SoundFxManager::queueChord(const uint16_t* frequencies, uint8_t count, uint16_t duration,
+                                    uint16_t gap, TonePriority priority, int volume)
+    {
+        if (count > ToneSequencer::VOICES_PER_LANE) count = ToneSequencer::VOICES_PER_LANE;
+        if (count == 0 || sequencer.freeSpace(priority) < count) 
+        {
+            Utilities::LOG_WARNING("Tone queue full, dropping chord");
+            return;
+        }
+
+        for (uint8_t i = 0; i < count; i++) 
+        {
+            ToneEvent event;
+            event.frequency = frequencies[i];
+            event.durationMs = duration;
+            event.advanceMs = (i + 1 < count) ? 0 : duration + gap;  // Stack onsets, advance once
+            event.volume = constrain(volume, 0, 255);
+            event.cue = 0;
+            sequencer.enqueue(priority, event);
+        }
+    }
+
+    void SoundFxManager::queueLitTone(uint16_t frequency, uint16_t duration, uint16_t gap, const ToneLight* lights,
+                                      uint8_t count, TonePriority priority, int volume)
+    {
+        uint8_t slot = nextLitTone;
+        LitTone& lit = litTones[slot];
+        lit.count = count < LIGHTS_PER_TONE ? count : LIGHTS_PER_TONE;
+        for (uint8_t i = 0; i < lit.count; i++) lit.lights[i] = lights[i];
+
+        if (!sequencer.enqueueTone(priority, frequency, duration, gap, constrain(volume, 0, 255), LIT_TONE_CUE | slot)) 
+        {
+            Utilities::LOG_WARNING("Tone queue full, dropping %u Hz", frequency);
+            return;
+        }
+        nextLitTone = (slot + 1) % LIT_TONE_SLOTS;
+    }
+
+    bool SoundFxManager::playEffect(const SoundEffect& effect, int volume)
+    {
+        if (effect.events.empty()) return false;
+        if (sequencer.freeSpace(effect.lane) < effect.events.size()) 
+        {
+            Utilities::LOG_WARNING("Tone queue full, dropping %s", effect.name);
+            return false;
+        }
+
+        for (const ToneEvent& tableEvent : effect.events) 
+        {
+            ToneEvent event = tableEvent;
+            event.volume = constrain(volume, 0, 255);
+            sequencer.enqueue(effect.lane, event);
+        }
+        return true;
+    }
+
+    void SoundFxManager::stopTones() 
+    {
+        sequencer.stopAll();
+        synth.noteOff(SUSTAIN_TAG);
+    }
+
+    void SoundFxManager::onToneStart(uint8_t slot, const ToneEvent& event) 
+    {
+        // Sequencer slots map one-to-one onto synth note tags; lanes pick the bus channel
+        MixChannel channel = laneChannel(slot);
+        synth.noteOn(slot, event.frequency, event.volume, static_cast<uint8_t>(channel));
+        mixer.trigger(channel);
+
+        if (event.cue & LIT_TONE_CUE) 
+        {
+            // Lights go up with the block that carries the tone, like tune notes below
+            const LitTone& lit = litTones[(event.cue & ~LIT_TONE_CUE) % LIT_TONE_SLOTS];
+            uint64_t heardAt = mediaClock.queuedMicros();
+            for (uint8_t i = 0; i < lit.count; i++) 
+            {
+                LEDManager::scheduleFrame(heardAt, lit.lights[i].ledMask, lit.lights[i].color);
+            }
+        }
+        else if (event.cue > 0 && m_isTunePlaying) 
+        {
+            // Tune notes carry their index so LEDs light exactly at onset
+            size_t noteIndex = event.cue - 1;
+            if (noteIndex < activeTune.notes.size() && noteIndex < activeTune.ledAnimation.size()) 
+            {
+                // The synth picks the note up with the next block; light it when that block is heard
+                const NoteInfo& note = activeTune.notes[noteIndex];
+                CRGB color = VisualSynesthesia::getNoteColorBlended(note);
+                LEDManager::scheduleFrame(mediaClock.queuedMicros(), activeTune.ledAnimation[noteIndex], color);
+            }
+        }
+    }
+
+    void SoundFxManager::onToneStop(uint8_t slot) 
+    {
+        synth.noteOff(slot);
+    }
+
+    MixChannel SoundFxManager::laneChannel(uint8_t slot) 
+    {
+        switch (static_cast<TonePriority>(slot / ToneSequencer::VOICES_PER_LANE)) 
+        {
+            case TonePriority::TUNE:  return MixChannel::MUSIC;
+            case TonePriority::ALERT: return MixChannel::ALERT;
+            default:                  return MixChannel::UI;
+        }
+    }
+
+    void SoundFxManager::configureMixer() 
+    {
+        // Lanes now sound together; the bus decides who gets heard
+        sequencer.setPreemptive(false);
+        mixer.setStream(MixChannel::VOICE, readPlayback, nullptr);
+        mixer.setStream(MixChannel::UI, SamplePlayer::read, &samplePlayer);
+
+        mixer.setDucking(MixChannel::MUSIC, MixChannel::UI, 64);
+        mixer.setDucking(MixChannel::MUSIC, MixChannel::VOICE, 32);
+        mixer.setDucking(MixChannel::MUSIC, MixChannel::ALERT, 0);
+        mixer.setDucking(MixChannel::UI, MixChannel::ALERT, 32);
+        mixer.setDucking(MixChannel::VOICE, MixChannel::ALERT, 0, true);  // Recording waits out the alert
+    }
+
+    bool SoundFxManager::installSpeakerOutput() 
+    {
+        i2s_config_t i2s_config = 
+        {
+            .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_TX),
+            .sample_rate = EXAMPLE_SAMPLE_RATE,
+            .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
+            .channel_format = I2S_CHANNEL_FMT_RIGHT_LEFT,
+            .communication_format = I2S_COMM_FORMAT_STAND_I2S,
+            .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
+            .dma_buf_count = SYNTH_DMA_BUFFERS,  // Increased from 4 for better buffering
+            .dma_buf_len = SYNTH_BLOCK_FRAMES,
+            .use_apll = true     // Changed to true for better audio quality
+        };
+
+        i2s_pin_config_t pin_config = 
+        {
+            .mck_io_num = I2S_PIN_NO_CHANGE,
+            .bck_io_num = BOARD_VOICE_BCLK,
+            .ws_io_num = BOARD_VOICE_LRCLK,
+            .data_out_num = BOARD_VOICE_DIN,
+            .data_in_num = I2S_PIN_NO_CHANGE
+        };
+
+        if (i2s_driver_install(I2S_NUM_0, &i2s_config, 0, NULL) != ESP_OK) 
+        {
+            Utilities::LOG_ERROR("I2S driver installation failed");
+            return false;
+        }
+        if (i2s_set_pin(I2S_NUM_0, &pin_config) != ESP_OK) 
+        {
+            Utilities::LOG_ERROR("I2S speaker pin setup failed");
+            i2s_driver_uninstall(I2S_NUM_0);
+            return false;
+        }
+
+        // A returned write leaves every DMA buffer full, which is the distance to the DAC
+        mediaClock.setLatency(SYNTH_DMA_BUFFERS * SYNTH_BLOCK_FRAMES);
+        mediaClock.start();
+        synthOutputReady = true;
+        return true;
+    }
+
+    void SoundFxManager::releaseSpeakerOutput() 
+    {
+        if (!synthOutputReady) return;
+        synthOutputReady = false;
+        vTaskDelay(pdMS_TO_TICKS(SYNTH_WRITE_TIMEOUT_MS));  // Let an in-flight block finish
+        i2s_driver_uninstall(I2S_NUM_0);
+        mediaClock.stop();
+    }
+
+    void SoundFxManager::synthTask(void* parameter) 
+    {
+        static int16_t block[SYNTH_BLOCK_FRAMES * 2];  // Interleaved L/R
+
+        for (;;) 
+        {
+            if (!synthOutputReady) 
+            {
+                vTaskDelay(pdMS_TO_TICKS(10));
+                continue;
+            }
+
+            // i2s_write blocks until a DMA buffer frees up, which paces rendering
+            mixer.render(block, SYNTH_BLOCK_FRAMES);
+            mediaClock.queued(SYNTH_BLOCK_FRAMES);
+            size_t written = 0;
+            if (i2s_write(I2S_NUM_0, block, sizeof(block), &written, 
+                          pdMS_TO_TICKS(SYNTH_WRITE_TIMEOUT_MS)) != ESP_OK) 
+            {
+                vTaskDelay(pdMS_TO_TICKS(10));
+                continue;
+            }
+            mediaClock.written();
+        }
+    }
+
+    void SoundFxManager::update() 
+    {
+        if (m_isTunePlaying) 
+        {
+            updateTune();
+        }
+        if (songPlaying) 
+        {
+            updateSong();
+        }
+        if (noteSource) 
+        {
+            updateNoteSource();
+        }
+        // Schedule against the presented-sample clock so tones and note lights share one timeline
+        sequencer.update(mediaClock.nowMs());
+        LEDManager::presentScheduledFrames();
+        if (isPlayingSound) 
         {
-            delay(duration);
-            ledcWrite(TONE_PWM_CHANNEL, 0);
+            pumpPlayback();
         }
     }
 
@@ -97,58 +382,194 @@ namespace AuditoryCortex
 
     void SoundFxManager::startTune() 
     {
+        stopSong();
+        stopNoteSource();
+        sequencer.clear(TonePriority::TUNE);
         currentNote = 0;
         m_isTunePlaying = true;
-        lastNoteTime = 0;
+        lastNoteTime = mediaClock.nowMs();
         activeTune = Tunes::getTune(selectedSong);
     }
 
+    void SoundFxManager::stopTune() 
+    {
+        m_isTunePlaying = false;
+        sequencer.clear(TonePriority::TUNE);
+        LEDManager::clearScheduledFrames();
+    }
+
     void SoundFxManager::updateTune() 
     {
-        if (!m_isTunePlaying || currentNote >= activeTune.notes.size()) 
+        // Keep a few notes queued ahead; the sequencer owns the actual timing
+        while (currentNote < activeTune.notes.size() && 
+               sequencer.pendingCount(TonePriority::TUNE) < TUNE_LOOKAHEAD) 
+        {
+            ToneEvent event = Tunes::toneEvent(activeTune, currentNote, volume);
+            if (!sequencer.enqueue(TonePriority::TUNE, event)) break;
+
+            currentNote++;
+        }
+
+        if (currentNote >= activeTune.notes.size() && !sequencer.isLaneBusy(TonePriority::TUNE)) 
         {
             m_isTunePlaying = false;
-            return;
         }
-        
-        unsigned long currentTime = millis();
-        const PC::AudioTypes::NoteInfo& note = activeTune.notes[currentNote];
-        int noteDuration = PitchPerception::getNoteDuration(note.type, activeTune.timeSignature);
-        
-        if (currentTime - lastNoteTime >= noteDuration) 
+    }
+
+    bool SoundFxManager::playSongFile(const char* path) 
+    {
+        if (!PC::SDManager::isInitialized()) return false;
+
+        stopTune();
+        stopSong();
+        stopNoteSource();
+        PC::SPILease lease(PC::SPIDevice::SD, PC::SPIPriority::NORMAL);
+        songFile = SD.open(path, FILE_READ);
+        if (!songFile) 
         {
-            if (currentNote < activeTune.notes.size()) 
+            Utilities::LOG_ERROR("Song not found: %s", path);
+            return false;
+        }
+
+        if (!songParser.open(readSongFile, &songFile, songFile.size())) 
+        {
+            Utilities::LOG_ERROR("Song %s rejected (error %d)", path, static_cast<int>(songParser.error()));
+            songFile.close();
+            return false;
+        }
+
+        Utilities::LOG_DEBUG("Playing song '%s' from %s", songParser.title(), path);
+        songPlaying = true;
+        updateSong();
+        return true;
+    }
+
+    void SoundFxManager::stopSong() 
+    {
+        if (!songPlaying) return;
+        songPlaying = false;
+        songParser.close();
+        songFile.close();
+        sequencer.clear(TonePriority::TUNE);
+    }
+
+    size_t SoundFxManager::readSongFile(void* context, uint32_t offset, uint8_t* data, size_t length) 
+    {
+        File* file = static_cast<File*>(context);
+        PC::SPILease lease(PC::SPIDevice::SD, PC::SPIPriority::NORMAL);
+        if (file->position() != offset && !file->seek(offset)) return 0;
+        return file->read(data, length);
+    }
+
+    uint16_t SoundFxManager::songNoteDuration(const SongEvent& note) 
+    {
+        NoteType type;
+        switch (note.noteValue) 
+        {
+            case 1: type = NoteType::WHOLE; break;
+            case 2: type = NoteType::HALF; break;
+            case 4: type = NoteType::QUARTER; break;
+            case 8: type = NoteType::EIGHTH; break;
+            case 16: type = NoteType::SIXTEENTH; break;
+            case 32: type = NoteType::THIRTY_SECOND; break;
+            case 64: type = NoteType::SIXTY_FOURTH; break;
+            case 128: type = NoteType::HUNDRED_TWENTY_EIGHTH; break;
+            default: return note.durationMs;  // Irregular lengths keep their exact timing
+        }
+
+        TimeSignature signature;
+        switch (songParser.signatureDenominator()) 
+        {
+            case 2: signature = TimeSignature::TIME_2_2; break;
+            case 8: signature = TimeSignature::TIME_6_8; break;
+            case 16: signature = TimeSignature::TIME_12_16; break;
+            default: 
+                signature = songParser.signatureNumerator() == 3 ? TimeSignature::TIME_3_4 : TimeSignature::TIME_4_4;
+                break;
+        }
+
+        // Same duration table as the built-in tunes, rescaled from its fixed beat to the song's tempo
+        uint32_t beat = PitchPerception::getNoteDuration(NoteType::QUARTER, signature);
+        uint32_t ms = static_cast<uint32_t>(PitchPerception::getNoteDuration(type, signature)) * songParser.beatMs() / beat;
+        if (note.dotted) ms += ms / 2;
+        return static_cast<uint16_t>(ms > 0xFFFF ? 0xFFFF : ms);
+    }
+
+    void SoundFxManager::updateSong() 
+    {
+        // Same lookahead as built-in tunes: the file is read a few notes at a time
+        SongEvent note;
+        bool exhausted = false;
+        while (sequencer.pendingCount(TonePriority::TUNE) < TUNE_LOOKAHEAD) 
+        {
+            if (!songParser.next(note)) 
             {
-                uint16_t frequency = PitchPerception::getNoteFrequency(note);
-                playTone(frequency, noteDuration, volume);
-                
-                // Update LED visualization
-                for (int j = 0; j < MC::PinDefinitions::VisualPathways::WS2812_NUM_LEDS; j++) 
-                {
-                    if (bitRead(activeTune.ledAnimation[currentNote], j)) 
-                    {
-                        CRGB color = VisualSynesthesia::getNoteColorBlended(note);
-                        LEDManager::setLED(j, color);
-                    }
-                }
-                LEDManager::showLEDs();
-                
-                lastNoteTime = currentTime;
-                currentNote++;
-            } 
-            else 
+                exhausted = true;
+                break;
+            }
+
+            ToneEvent event;
+            event.frequency = note.frequency;
+            event.durationMs = songNoteDuration(note);
+            event.advanceMs = note.advanceMs;
+            event.volume = static_cast<uint8_t>(volume * note.velocity / 127);
+            event.cue = 0;
+            sequencer.enqueue(TonePriority::TUNE, event);
+        }
+
+        // Let the queued tail ring out before releasing the file
+        if (!exhausted || sequencer.isLaneBusy(TonePriority::TUNE)) return;
+
+        if (songParser.error() != SongError::NONE) 
+        {
+            Utilities::LOG_WARNING("Song stopped early (error %d)", static_cast<int>(songParser.error()));
+        }
+        songPlaying = false;
+        songParser.close();
+        songFile.close();
+    }
+
+    void SoundFxManager::playNoteSource(NoteSource source, void* context) 
+    {
+        stopTune();
+        stopSong();
+        stopNoteSource();
+        noteSource = source;
+        noteSourceContext = context;
+        updateNoteSource();
+    }
+
+    void SoundFxManager::stopNoteSource() 
+    {
+        if (!noteSource) return;
+        noteSource = nullptr;
+        noteSourceContext = nullptr;
+        sequencer.clear(TonePriority::TUNE);
+    }
+
+    void SoundFxManager::updateNoteSource() 
+    {
+        // Same lookahead as songs, so a sequence of any length fits the lane
+        ToneEvent event;
+        bool exhausted = false;
+        while (sequencer.pendingCount(TonePriority::TUNE) < TUNE_LOOKAHEAD) 
+        {
+            if (!noteSource(noteSourceContext, event)) 
             {
-                m_isTunePlaying = false;
+                exhausted = true;
+                break;
             }
+            sequencer.enqueue(TonePriority::TUNE, event);
         }
+
+        // The source may still be extended while its tail rings out
+        if (!exhausted || sequencer.isLaneBusy(TonePriority::TUNE)) return;
+        noteSource = nullptr;
+        noteSourceContext = nullptr;
     }
 
     void SoundFxManager::playSuccessSound() {
-        playTone(PitchPerception::NOTE_C5, 100);
-        delay(50);
-        playTone(PitchPerception::NOTE_E5, 100);
-        delay(50);
-        playTone(PitchPerception::NOTE_G5, 200);
+        playEffect(SoundEffects::get(PC::AudioTypes::Tone::SUCCESS));
     }
 
     void SoundFxManager::playRotaryPressSound(int mode)  // 0=Full, 1=Week, 2=Timer
@@ -161,73 +582,50 @@ namespace AuditoryCortex
         switch(mode) 
         {
             case 0: 
-                playTone(baseNote, 100);
+                queueTone(baseNote, 100);
                 break;
             case 1:  
-                playTone(baseNote, 100);  
+                queueTone(baseNote, 100);  
                 break;
             case 2:  // Timer mode - octave up + fifth
-                playTone(baseNote * 2, 100);
+                queueTone(baseNote * 2, 100);
                 break;
         }
     }
 
     void SoundFxManager::playRotaryTurnSound(bool clockwise) {
-        if (clockwise) {
-            playTone(PitchPerception::getDayBaseNote4(), 50);
-            playTone(PitchPerception::getDayBaseNote5(), 50);
-        } else {
-            playTone(PitchPerception::getDayBaseNote5(), 50);
-            playTone(PitchPerception::getDayBaseNote4(), 50);
-        }
+        uint16_t first = clockwise ? PitchPerception::getDayBaseNote4() : PitchPerception::getDayBaseNote5();
+        uint16_t second = clockwise ? PitchPerception::getDayBaseNote5() : PitchPerception::getDayBaseNote4();
+
+        // Fast spins replace the previous click instead of piling up behind it
+        ToneEvent click = { first, 50, 50, static_cast<uint8_t>(42), 0 };
+        sequencer.enqueue(TonePriority::UI, click, true);
+        queueTone(second, 50);
     }
 
     void SoundFxManager::playSideButtonSound(bool start) {
         if (start) {
-            playTone(PitchPerception::getDayBaseNote4(), 50);
-            playTone(PitchPerception::getDayBaseNote4(), 50);
+            queueTone(PitchPerception::getDayBaseNote4(), 50);
+            queueTone(PitchPerception::getDayBaseNote4(), 50);
         } else {
-            playTone(PitchPerception::getDayBaseNote5(), 100);
+            queueTone(PitchPerception::getDayBaseNote5(), 100);
             int baseNote = PitchPerception::getDayBaseNote5();
-            playTone(PitchPerception::getNoteMinus2(baseNote), 100);
+            queueTone(PitchPerception::getNoteMinus2(baseNote), 100);
         }
     }
 
     void SoundFxManager::playErrorSound(ErrorSoundType type) 
     {
-        switch(type) 
-        {
-            case ErrorSoundType::RECORDING:
-                SoundFxManager::playTone(PitchPerception::NOTE_B5, 200);
-                delay(100);
-                SoundFxManager::playTone(PitchPerception::NOTE_G5, 200);
-                delay(100);
-                SoundFxManager::playTone(PitchPerception::NOTE_D5, 400);
-                break;
-                
-            case ErrorSoundType::STORAGE:
-                SoundFxManager::playTone(PitchPerception::NOTE_G5, 200);
-                delay(100);
-                SoundFxManager::playTone(PitchPerception::NOTE_G5, 200);
-                delay(100);
-                SoundFxManager::playTone(PitchPerception::NOTE_G4, 400);
-                break;
-                
-            case ErrorSoundType::PLAYBACK:
-                SoundFxManager::playTone(PitchPerception::NOTE_D5, 200);
-                delay(100);
-                SoundFxManager::playTone(PitchPerception::NOTE_D5, 200);
-                delay(100);
-                SoundFxManager::playTone(PitchPerception::NOTE_D4, 400);
-                break;
-        }
+        playEffect(SoundEffects::get(type));
     }
 
     // Add audio callback
     void SoundFxManager::audio_eof_mp3(const char *info) {
         Serial.printf("Audio playback finished: %s\n", info);
         // Delete temporary recording after playback
-        if (!SD.remove(RECORD_FILENAME)) {
+        const PC::StorageBackend& storage = PC::SDManager::getStorage();
+        PC::SPILease lease(PC::SPIDevice::SD, PC::SPIPriority::NORMAL);
+        if (!storage.remove(storage.context, RECORD_FILENAME)) {
             Serial.println("Failed to delete temporary recording file");
             playErrorSound(ErrorSoundType::STORAGE);
         }
@@ -238,60 +636,67 @@ namespace AuditoryCortex
     void SoundFxManager::startRecording() {
         if (!PC::SDManager::isInitialized()) return;
         if (isRecording) return;
+        if (captureHolds.load() != 0) 
+        {
+            Utilities::LOG_WARNING("Last recording's writer has not finished yet");
+            return;
+        }
         
         Serial.println("=== Starting Recording ===");
         
-        // Initialize microphone
-        i2s_config_t i2s_config = {
-            .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX | I2S_MODE_PDM),
-            .sample_rate = EXAMPLE_SAMPLE_RATE,
-            .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
-            .channel_format = I2S_CHANNEL_FMT_ONLY_LEFT,
-            .communication_format = I2S_COMM_FORMAT_STAND_I2S,
-            .intr_alloc_flags = ESP_INTR_FLAG_LEVEL2,
-            .dma_buf_count = 4,
-            .dma_buf_len = 64,
-            .use_apll = false,
-        };
+        // The tuner's listen-only capture gives way to the recorder
+        if (pitchTracking) stopPitchTracking();
 
-        i2s_pin_config_t pin_config = {
-            .mck_io_num = I2S_PIN_NO_CHANGE,
-            .bck_io_num = I2S_PIN_NO_CHANGE,
-            .ws_io_num = BOARD_MIC_CLK,
-            .data_out_num = I2S_PIN_NO_CHANGE,
-            .data_in_num = BOARD_MIC_DATA,
-        };
+        // The microphone shares I2S port 0 with the speaker
+        releaseSpeakerOutput();
 
-        if (i2s_driver_install((i2s_port_t)EXAMPLE_I2S_CH, &i2s_config, 0, NULL) != ESP_OK) {
-            Serial.println("ERROR: Failed to install I2S driver");
+        if (!installMicrophoneInput()) {
+            installSpeakerOutput();
             playErrorSound(ErrorSoundType::RECORDING);
             RoverManager::setEarsPerked(false);
             return;
         }
-        
-        if (i2s_set_pin((i2s_port_t)EXAMPLE_I2S_CH, &pin_config) != ESP_OK) {
-            Serial.println("ERROR: Failed to set I2S pins");
+
+        // Create new WAV file; through the card's backend so usage sees it grow.
+        // The lease lasts until the writer starts, so its first block queues behind the header
+        const PC::StorageBackend& storage = PC::SDManager::getStorage();
+        PC::SPILease lease(PC::SPIDevice::SD, PC::SPIPriority::NORMAL);
+        storage.remove(storage.context, RECORD_FILENAME);
+        recordFile = storage.open(storage.context, RECORD_FILENAME, true);
+        if (!recordFile) {
+            Serial.println("ERROR: Failed to open file for recording");
             i2s_driver_uninstall((i2s_port_t)EXAMPLE_I2S_CH);
+            installSpeakerOutput();
             playErrorSound(ErrorSoundType::RECORDING);
             RoverManager::setEarsPerked(false);
             return;
         }
 
-        // Create new WAV file
-        recordFile = SD.open(RECORD_FILENAME, FILE_WRITE);
-        if (!recordFile) {
-            Serial.println("ERROR: Failed to open file for recording");
+        // Reserve space for the header, patched in stopRecording()
+        captureEncoder.begin(recordingFormat, recordingDecimation);
+        uint8_t placeholder[WavCodec::MAX_HEADER_BYTES];
+        size_t headerBytes = generate_wav_header(placeholder, 0, captureEncoder.outputRate(EXAMPLE_SAMPLE_RATE));
+        storage.write(storage.context, recordFile, 0, placeholder, headerBytes);
+        recordOffset = headerBytes;
+
+        captureStorage = static_cast<uint8_t*>(malloc(CAPTURE_RING_BYTES));
+        captureBlock = static_cast<uint8_t*>(malloc(CAPTURE_BLOCK_BYTES));
+        if (!captureStorage || !captureBlock) {
+            Serial.println("ERROR: Failed to allocate capture buffers");
+            releaseCapture();
+            storage.close(storage.context, recordFile);
+            recordFile = nullptr;
             i2s_driver_uninstall((i2s_port_t)EXAMPLE_I2S_CH);
+            installSpeakerOutput();
             playErrorSound(ErrorSoundType::RECORDING);
             RoverManager::setEarsPerked(false);
             return;
         }
+        captureRing = new CaptureRing(captureStorage, CAPTURE_RING_BYTES);
+        captureWriter = new CaptureWriter(*captureRing, captureBlock, CAPTURE_BLOCK_BYTES, headerBytes,
+                                          writeCaptureBlock, recordFile, captureClock);
 
-        // Reserve space for the header
-        for (int i = 0; i < WAVE_HEADER_SIZE; i++) {
-            recordFile.write(0);
-        }
-
+        startCaptureTasks(true);
         isRecording = true;
         Serial.println("Recording started!");
     }
@@ -302,29 +707,63 @@ namespace AuditoryCortex
 
         Serial.println("=== Stopping Recording ===");
         isRecording = false;
+
+        // The capture task leaves within one i2s_read timeout; the writer can be held up by a slow card
+        captureRunning = false;
+        xEventGroupWaitBits(captureEvents, CAPTURE_TASK_EXITED, pdFALSE, pdTRUE, portMAX_DELAY);
+        EventBits_t exited = xEventGroupWaitBits(captureEvents, WRITER_TASK_EXITED, pdFALSE, pdTRUE,
+                                                 pdMS_TO_TICKS(WRITER_STOP_TIMEOUT_MS));
+        if (!(exited & WRITER_TASK_EXITED) && captureHolds.fetch_sub(1) != 1) 
+        {
+            // Still inside a write: the ring, block and file stay with the writer, which frees them on its way out
+            Utilities::LOG_ERROR("Recording writer stalled; recording dropped");
+            i2s_driver_uninstall((i2s_port_t)EXAMPLE_I2S_CH);
+            installSpeakerOutput();
+            playErrorSound(ErrorSoundType::RECORDING);
+            RoverManager::setEarsPerked(false);
+            return;
+        }
+
+        // Both tasks are gone; flush the tail from here
+        uint8_t tail[ImaAdpcm::BLOCK_ALIGN];
+        size_t tailBytes = captureEncoder.flush(tail);
+        if (tailBytes > 0) 
+        {
+            captureRing->push(tail, tailBytes);
+        }
+        if (!captureWriter->finish()) 
+        {
+            Serial.println("ERROR: Short write while recording");
+        }
+
+        CaptureStats stats = captureWriter->stats();
+        Utilities::LOG_PROD("Recording: %u bytes, %.2f MB/s sustained, max write %u us, %u overruns (%u bytes)",
+            stats.bytesWritten, stats.sustainedMBps, stats.maxWriteMicros, 
+            stats.overrunEvents, stats.overrunBytes);
         
         // Memory-safe header generation
-        uint32_t fileSize = recordFile.size() - WAVE_HEADER_SIZE;
-        char wavHeader[WAVE_HEADER_SIZE];
-        generate_wav_header(wavHeader, fileSize, EXAMPLE_SAMPLE_RATE);
+        uint32_t fileSize = captureWriter->dataBytes();
+        captureHolds.store(0);
+        releaseCapture();
+        uint8_t wavHeader[WavCodec::MAX_HEADER_BYTES];
+        size_t headerBytes = generate_wav_header(wavHeader, fileSize, captureEncoder.outputRate(EXAMPLE_SAMPLE_RATE));
         
         // Error handling with cognitive state tracking
         bool headerWriteSuccess = true;
         
-        if (!recordFile.seek(0)) 
-        {
-            Serial.println("ERROR: Failed to seek in file");
-            headerWriteSuccess = false;
-        }
-        else if (recordFile.write((uint8_t *)wavHeader, WAVE_HEADER_SIZE) != WAVE_HEADER_SIZE) 
+        const PC::StorageBackend& storage = PC::SDManager::getStorage();
+        PC::SPILease lease(PC::SPIDevice::SD, PC::SPIPriority::NORMAL);
+        if (storage.write(storage.context, recordFile, 0, wavHeader, headerBytes) != headerBytes) 
         {
             Serial.println("ERROR: Failed to write WAV header");
             headerWriteSuccess = false;
         }
         
         // Cleanup resources
-        recordFile.close();
+        storage.close(storage.context, recordFile);
+        recordFile = nullptr;
         i2s_driver_uninstall((i2s_port_t)EXAMPLE_I2S_CH);
+        installSpeakerOutput();
         
         if (!headerWriteSuccess) 
         {
@@ -334,18 +773,403 @@ namespace AuditoryCortex
         }
 
         // Attempt playback
-        audio.setVolume(volume);
-        if (!SD.exists(RECORD_FILENAME) || !audio.connecttoFS(SD, RECORD_FILENAME)) 
+        playRecording();
+        RoverManager::setEarsPerked(false);
+    }
+
+    bool SoundFxManager::installMicrophoneInput() 
+    {
+        i2s_config_t i2s_config = {
+            .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_RX | I2S_MODE_PDM),
+            .sample_rate = EXAMPLE_SAMPLE_RATE,
+            .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
+            .channel_format = I2S_CHANNEL_FMT_ONLY_LEFT,
+            .communication_format = I2S_COMM_FORMAT_STAND_I2S,
+            .intr_alloc_flags = ESP_INTR_FLAG_LEVEL2,
+            .dma_buf_count = 8,
+            .dma_buf_len = 512,  // ~93 ms of DMA headroom before the capture task must run
+            .use_apll = false,
+        };
+
+        i2s_pin_config_t pin_config = {
+            .mck_io_num = I2S_PIN_NO_CHANGE,
+            .bck_io_num = I2S_PIN_NO_CHANGE,
+            .ws_io_num = BOARD_MIC_CLK,
+            .data_out_num = I2S_PIN_NO_CHANGE,
+            .data_in_num = BOARD_MIC_DATA,
+        };
+
+        if (i2s_driver_install((i2s_port_t)EXAMPLE_I2S_CH, &i2s_config, 0, NULL) != ESP_OK) {
+            Serial.println("ERROR: Failed to install I2S driver");
+            return false;
+        }
+        
+        if (i2s_set_pin((i2s_port_t)EXAMPLE_I2S_CH, &pin_config) != ESP_OK) {
+            Serial.println("ERROR: Failed to set I2S pins");
+            i2s_driver_uninstall((i2s_port_t)EXAMPLE_I2S_CH);
+            return false;
+        }
+        return true;
+    }
+
+    void SoundFxManager::startPitchTracking() 
+    {
+        if (pitchTracking || isRecording || captureHolds.load() != 0) return;
+
+        if (!PitchPerception::beginTracking(EXAMPLE_SAMPLE_RATE)) 
+        {
+            Utilities::LOG_ERROR("Pitch tracker rejected %d Hz input", EXAMPLE_SAMPLE_RATE);
+            return;
+        }
+
+        // Listen-only capture: same task as recording, no ring or writer behind it
+        releaseSpeakerOutput();
+        if (!installMicrophoneInput()) 
+        {
+            installSpeakerOutput();
+            return;
+        }
+
+        pitchTracking = true;
+        startCaptureTasks(false);
+    }
+
+    void SoundFxManager::stopPitchTracking() 
+    {
+        if (!pitchTracking) return;
+
+        pitchTracking = false;
+        captureRunning = false;
+        xEventGroupWaitBits(captureEvents, CAPTURE_TASK_EXITED, pdFALSE, pdTRUE, portMAX_DELAY);
+        captureHolds.store(0);
+        i2s_driver_uninstall((i2s_port_t)EXAMPLE_I2S_CH);
+        installSpeakerOutput();
+    }
+
+    void SoundFxManager::setRecordingFormat(RecordingFormat format, uint8_t decimation) 
+    {
+        if (isRecording) return;
+        recordingFormat = format;
+        recordingDecimation = decimation;
+    }
+
+    void SoundFxManager::playRecording() 
+    {
+        if (isPlayingSound || isRecording) return;
+
+        PC::SPILease lease(PC::SPIDevice::SD, PC::SPIPriority::NORMAL);
+        playbackFile = SD.open(RECORD_FILENAME, FILE_READ);
+        if (!playbackFile) 
         {
             Serial.println("ERROR: Playback failed");
             playErrorSound(ErrorSoundType::PLAYBACK);
-            RoverManager::setEarsPerked(false);
             return;
         }
 
-        RoverManager::setEarsPerked(false);
+        // fmt/fact/data chunks all sit in the first few dozen bytes for our files
+        uint8_t header[128];
+        size_t headerRead = playbackFile.read(header, sizeof(header));
+        WavFormatInfo info;
+        if (!WavCodec::parseHeader(header, headerRead, info) || 
+            info.sampleRate == 0 || EXAMPLE_SAMPLE_RATE % info.sampleRate != 0 ||
+            !playbackFile.seek(info.dataOffset)) 
+        {
+            Serial.println("ERROR: Unsupported recording format");
+            playbackFile.close();
+            playErrorSound(ErrorSoundType::PLAYBACK);
+            return;
+        }
+
+        playbackStorage = static_cast<uint8_t*>(malloc(PLAYBACK_RING_BYTES));
+        if (!playbackStorage) 
+        {
+            playbackFile.close();
+            playErrorSound(ErrorSoundType::PLAYBACK);
+            return;
+        }
+        playbackRing = new CaptureRing(playbackStorage, PLAYBACK_RING_BYTES);
+        playbackDecoder.begin(info);
+        playbackStep = EXAMPLE_SAMPLE_RATE / info.sampleRate;
+
+        isPlayingSound = true;
+        pumpPlayback();
+        streamPlaying = true;
+        mixer.trigger(MixChannel::VOICE);
+    }
+
+    void SoundFxManager::pumpPlayback() 
+    {
+        static uint8_t input[PLAYBACK_READ_BYTES];
+        static size_t inputLength = 0;
+        static size_t inputPosition = 0;
+        int16_t pcm[PLAYBACK_READ_BYTES];
+
+        if (!playbackRing) return;
+        if (!playbackFile) 
+        {
+            // File exhausted: drain until the render task has emptied the ring
+            if (streamPlaying.load() && playbackRing->available() == 0) 
+            {
+                streamPlaying.store(false);
+            }
+
+            // Free the ring on a later update if a render block is still reading from it
+            if (streamPlaying.load() || playbackReading.load()) return;
+            delete playbackRing;
+            free(playbackStorage);
+            playbackRing = nullptr;
+            playbackStorage = nullptr;
+            inputLength = inputPosition = 0;
+            audio_eof_mp3(RECORD_FILENAME);
+            return;
+        }
+
+        // Keep the PCM ring topped up from the main loop, holding the bus for the whole top-up
+        if (playbackRing->freeSpace() < sizeof(pcm)) return;
+        PC::SPILease lease(PC::SPIDevice::SD, PC::SPIPriority::NORMAL);
+        while (playbackRing->freeSpace() >= sizeof(pcm)) 
+        {
+            if (inputPosition >= inputLength) 
+            {
+                inputLength = playbackFile.read(input, sizeof(input));
+                inputPosition = 0;
+            }
+
+            size_t consumed = 0;
+            size_t samples = playbackDecoder.decode(input + inputPosition, inputLength - inputPosition, 
+                                                    consumed, pcm, PLAYBACK_READ_BYTES);
+            inputPosition += consumed;
+            if (samples > 0) 
+            {
+                playbackRing->push(reinterpret_cast<uint8_t*>(pcm), samples * sizeof(int16_t));
+            }
+            else if (inputLength == 0) 
+            {
+                playbackFile.close();
+                break;
+            }
+            else if (consumed == 0) 
+            {
+                inputPosition = inputLength;  // Trailing partial sample
+            }
+        }
+    }
+
+
+    bool SoundFxManager::playSample(const char* path) 
+    {
+        const SampleClip* clip = sampleBank.acquire(path);
+        if (!clip) return false;
+
+        samplePlayer.start(clip);
+        mixer.trigger(MixChannel::UI);
+        return true;
+    }
+
+    bool SoundFxManager::openSampleFile(void* context, const char* path) 
+    {
+        // Built-in clips live in SPIFFS; the card can add or override the rest
+        sampleOnCard = false;
+        if (SPIFFS.exists(path)) 
+        {
+            sampleFile = SPIFFS.open(path, FILE_READ);
+        }
+        else if (PC::SDManager::isInitialized()) 
+        {
+            PC::SPILease lease(PC::SPIDevice::SD, PC::SPIPriority::NORMAL);
+            sampleFile = SD.open(path, FILE_READ);
+            sampleOnCard = true;
+        }
+        return static_cast<bool>(sampleFile);
+    }
+
+    size_t SoundFxManager::readSampleFile(void* context, uint8_t* data, size_t length) 
+    {
+        if (!sampleOnCard) return sampleFile.read(data, length);
+        PC::SPILease lease(PC::SPIDevice::SD, PC::SPIPriority::NORMAL);
+        return sampleFile.read(data, length);
+    }
+
+    void SoundFxManager::closeSampleFile(void* context) 
+    {
+        sampleFile.close();
+        sampleOnCard = false;
+    }
+
+    void* SoundFxManager::allocateSample(size_t bytes) 
+    {
+        return psramFound() ? ps_malloc(bytes) : malloc(bytes);
     }
 
+    void SoundFxManager::releaseSample(void* memory) 
+    {
+        free(memory);
+    }
+
+    void SoundFxManager::preloadSamples() 
+    {
+        sampleBank.setBudget(psramFound() ? SAMPLE_BUDGET_PSRAM : SAMPLE_BUDGET_HEAP);
+
+        char path[SampleBank::PATH_LENGTH];
+        uint8_t loaded = 0;
+        for (const char* line : VOICE_LINES) 
+        {
+            snprintf(path, sizeof(path), VOICE_LINE_FORMAT, line);
+            if (sampleBank.preload(path)) loaded++;
+        }
+
+        SampleBankStats stats = sampleBank.stats();
+        Utilities::LOG_DEBUG("Sample bank: %u voice lines, %u of %u bytes", loaded, stats.bytesUsed, stats.budgetBytes);
+    }
+
+    size_t SoundFxManager::readPlayback(void* context, int16_t* out, size_t frames) 
+    {
+        // Flagged before looking at streamPlaying, so pumpPlayback() never frees the ring under this read
+        playbackReading.store(true);
+        if (!streamPlaying.load() || !playbackRing) 
+        {
+            playbackReading.store(false);
+            return 0;
+        }
+
+        // Lower-rate recordings are upsampled by holding each sample playbackStep frames
+        int16_t samples[AudioMixer::MAX_BLOCK];
+        size_t wanted = frames / playbackStep;
+        size_t count = playbackRing->pop(reinterpret_cast<uint8_t*>(samples), wanted * sizeof(int16_t)) / sizeof(int16_t);
+
+        for (size_t i = 0; i < count * playbackStep; i++) 
+        {
+            out[i] = samples[i / playbackStep];
+        }
+        playbackReading.store(false);
+        return count * playbackStep;
+    }
+
+    void SoundFxManager::startCaptureTasks(bool withWriter) 
+    {
+        if (!captureEvents) captureEvents = xEventGroupCreate();
+        xEventGroupClearBits(captureEvents, CAPTURE_TASK_EXITED | WRITER_TASK_EXITED);
+
+        // One hold for whoever stops capture, one per task
+        captureHolds.store(withWriter ? 3 : 2);
+        captureRunning = true;
+
+        // Capture outranks the writer: a slow card may drop samples, never stall DMA
+        xTaskCreatePinnedToCore(captureTask, "MicCapture", 3072, NULL, 6, &captureTaskHandle, 0);
+        if (withWriter) 
+        {
+            xTaskCreatePinnedToCore(writerTask, "MicWriter", 4096, NULL, 3, &writerTaskHandle, 1);
+        }
+    }
+
+    void SoundFxManager::captureTaskExited(EventBits_t bit) 
+    {
+        // Last out after a stop that stopped waiting: nobody else will free the buffers or close the file
+        if (captureHolds.fetch_sub(1) == 1) 
+        {
+            const PC::StorageBackend& storage = PC::SDManager::getStorage();
+            PC::SPILease lease(PC::SPIDevice::SD, PC::SPIPriority::NORMAL);
+            if (recordFile) storage.close(storage.context, recordFile);
+            recordFile = nullptr;
+            releaseCapture();
+        }
+        xEventGroupSetBits(captureEvents, bit);
+    }
+
+    void SoundFxManager::captureTask(void* parameter) 
+    {
+        static int16_t chunk[CAPTURE_DMA_CHUNK / sizeof(int16_t)];
+        static uint8_t encoded[AudioEncoder::maxEncodedBytes(CAPTURE_DMA_CHUNK / sizeof(int16_t))];
+
+        while (captureRunning) 
+        {
+            size_t bytesRead = 0;
+            if (i2s_read((i2s_port_t)EXAMPLE_I2S_CH, chunk, sizeof(chunk), &bytesRead, pdMS_TO_TICKS(20)) == ESP_OK &&
+                bytesRead > 0) 
+            {
+                // Tap before encoding, which decimates the chunk in place
+                if (pitchTracking) 
+                {
+                    PitchPerception::processMicrophone(chunk, bytesRead / sizeof(int16_t));
+                }
+                if (!captureRing) continue;
+
+                size_t encodedBytes = captureEncoder.encode(chunk, bytesRead / sizeof(int16_t), encoded);
+                if (encodedBytes > 0) 
+                {
+                    captureRing->push(encoded, encodedBytes);  // Overruns are counted by the ring
+                }
+            }
+        }
+
+        captureTaskHandle = nullptr;
+        captureTaskExited(CAPTURE_TASK_EXITED);
+        vTaskDelete(NULL);
+    }
+
+    void SoundFxManager::writerTask(void* parameter) 
+    {
+        while (captureRunning) 
+        {
+            if (!captureWriter->pump()) 
+            {
+                Serial.println("ERROR: Recording write failed");
+                break;
+            }
+            vTaskDelay(pdMS_TO_TICKS(5));
+        }
+
+        writerTaskHandle = nullptr;
+        captureTaskExited(WRITER_TASK_EXITED);
+        vTaskDelete(NULL);
+    }
+
+    size_t SoundFxManager::writeCaptureBlock(void* context, const uint8_t* data, size_t length) 
+    {
+        // Through the storage task at audio priority, ahead of any queued logging;
+        // only this task waits, the ring keeps absorbing capture meanwhile
+        PC::StorageRequest request = PC::StorageWorker::makeRequest(PC::StorageOp::WRITE, nullptr, PC::StoragePriority::AUDIO);
+        request.file = context;
+        request.offset = recordOffset;
+        request.data = const_cast<uint8_t*>(data);
+        request.length = length;
+        request.future = &recordWrite;
+
+        size_t written;
+        if (PC::SDManager::submit(request)) 
+        {
+            while (!recordWrite.done.load(std::memory_order_acquire)) 
+            {
+                vTaskDelay(1);
+            }
+            written = recordWrite.result.bytes;
+        }
+        else 
+        {
+            const PC::StorageBackend& storage = PC::SDManager::getStorage();
+            PC::SPILease lease(PC::SPIDevice::SD, PC::SPIPriority::NORMAL);
+            written = storage.write(storage.context, context, recordOffset, data, length);
+        }
+        recordOffset += written;
+        return written;
+    }
+
+    uint32_t SoundFxManager::captureClock() 
+    {
+        return micros();
+    }
+
+    void SoundFxManager::releaseCapture() 
+    {
+        delete captureWriter;
+        delete captureRing;
+        free(captureBlock);
+        free(captureStorage);
+        captureWriter = nullptr;
+        captureRing = nullptr;
+        captureBlock = nullptr;
+        captureStorage = nullptr;
+    }
 
     void SoundFxManager::init_microphone() {
         i2s_config_t i2s_config = {
@@ -374,97 +1198,36 @@ namespace AuditoryCortex
     }
 
 
-    void SoundFxManager::generate_wav_header(char* wav_header, uint32_t wav_size, uint32_t sample_rate)
+    size_t SoundFxManager::generate_wav_header(uint8_t* wav_header, uint32_t wav_size, uint32_t sample_rate)
     {
-        // Cognitive mapping of WAV format structure
-        const WavHeaderInfo headerInfo = 
-        {
-            .fileSize = wav_size + WAVE_HEADER_SIZE - 8,
-            .byteRate = BYTE_RATE,
-            .sampleRate = sample_rate,
-            .numChannels = 1,  // Mono recording
-            .bitsPerSample = 16
-        };
-
-        // Memory-safe header construction using array bounds
-        const size_t headerSize = WAVE_HEADER_SIZE;
-        
-        // Validate output buffer
-        if (!wav_header) return;
-
-        // Clear header memory first
-        memset(wav_header, 0, headerSize);
-
-        // Construct header in a memory-safe way
-        const char header[WAVE_HEADER_SIZE] = 
-        {
-            // RIFF chunk descriptor
-            'R', 'I', 'F', 'F',
-            static_cast<char>(headerInfo.fileSize & 0xFF),
-            static_cast<char>((headerInfo.fileSize >> 8) & 0xFF),
-            static_cast<char>((headerInfo.fileSize >> 16) & 0xFF), 
-            static_cast<char>((headerInfo.fileSize >> 24) & 0xFF),
-            
-            // WAVE chunk
-            'W', 'A', 'V', 'E',
-            
-            // Format subchunk
-            'f', 'm', 't', ' ',
-            0x10, 0x00, 0x00, 0x00,  // Subchunk1Size (16 for PCM)
-            0x01, 0x00,              // AudioFormat (1 for PCM)
-            static_cast<char>(headerInfo.numChannels & 0xFF),
-            0x00,
-            
-            // Sample rate
-            static_cast<char>(headerInfo.sampleRate & 0xFF),
-            static_cast<char>((headerInfo.sampleRate >> 8) & 0xFF),
-            static_cast<char>((headerInfo.sampleRate >> 16) & 0xFF),
-            static_cast<char>((headerInfo.sampleRate >> 24) & 0xFF),
-            
-            // Byte rate
-            static_cast<char>(headerInfo.byteRate & 0xFF),
-            static_cast<char>((headerInfo.byteRate >> 8) & 0xFF),
-            static_cast<char>((headerInfo.byteRate >> 16) & 0xFF),
-            static_cast<char>((headerInfo.byteRate >> 24) & 0xFF)
-        };
-
-        // Copy constructed header to output buffer
-        memcpy(wav_header, header, headerSize);
+        if (!wav_header) return 0;
+        return WavCodec::buildHeader(wav_header, recordingFormat, sample_rate, wav_size);
     }
 
     void SoundFxManager::init() {
         if (_isInitialized) return;
-        // Initialize audio hardware
-        audio.setPinout(BOARD_VOICE_BCLK, BOARD_VOICE_LRCLK, BOARD_VOICE_DIN);
-        audio.setVolume(volume);  // Set a reasonable volume level
-        
         // Initialize SPIFFS for sound files
         if (!SPIFFS.begin(true)) {
             Utilities::LOG_ERROR("Failed to initialize SPIFFS");
             return;
         }
         
-        // Initialize I2S
-        i2s_config_t i2s_config = 
-        {
-            .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_TX),
-            .sample_rate = 44100,
-            .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
-            .channel_format = I2S_CHANNEL_FMT_RIGHT_LEFT,
-            .communication_format = I2S_COMM_FORMAT_STAND_I2S,
-            .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
-            .dma_buf_count = 8,  // Increased from 4 for better buffering
-            .dma_buf_len = 64,   // Increased from 32 for better performance
-            .use_apll = true     // Changed to true for better audio quality
-        };
-        
-        if (i2s_driver_install(I2S_NUM_0, &i2s_config, 0, NULL) != ESP_OK) 
+        // Initialize I2S speaker output and the synth render task
+        if (!installSpeakerOutput()) 
         {
-            Utilities::LOG_ERROR("I2S driver installation failed");
             return;
         }
 
         Utilities::LOG_PROD("I2S driver installed successfully");
+        volume = constrain(static_cast<int>(PC::SDManager::getSetting(PC::SDManager::SETTING_VOLUME, volume)), 0, 100);
+        synth.setMasterGain(map(volume, 0, 100, 0, 255));
+        sequencer.setOutput(onToneStart, onToneStop);
+        configureMixer();
+        preloadSamples();
+        if (synthTaskHandle == nullptr) 
+        {
+            xTaskCreatePinnedToCore(synthTask, "SynthRender", 3072, NULL, 5, &synthTaskHandle, 0);
+        }
         playStartupSound();
         _isInitialized = true;
     }
@@ -482,105 +1245,82 @@ namespace AuditoryCortex
             volume = 0;   // Wrap around to mute
         }
         
-        audio.setVolume(volume);
+        synth.setMasterGain(map(volume, 0, 100, 0, 255));
+        PC::SDManager::putSetting(PC::SDManager::SETTING_VOLUME, volume);
     }
 
   
 
     void SoundFxManager::playVoiceLine(const char* line, uint32_t cardId) {
+        char path[SampleBank::PATH_LENGTH];
+        snprintf(path, sizeof(path), VOICE_LINE_FORMAT, line);
+        if (cardId == 0 && playSample(path)) return;
+
         if (strcmp(line, "card_detected") == 0 && cardId != 0) {
             playCardMelody(cardId);
         }
         else if (strcmp(line, "waiting_for_card") == 0) {
             // Inquisitive searching tune
-            SoundFxManager::playTone(PitchPerception::NOTE_E5, 100, 0);
-            delay(50);
-            SoundFxManager::playTone(PitchPerception::NOTE_G5, 100, 1);
-            delay(50);
-            SoundFxManager::playTone(PitchPerception::NOTE_A5, 150, 2);
+            queueTone(PitchPerception::NOTE_E5, 100, 50, TonePriority::UI, 0);
+            queueTone(PitchPerception::NOTE_G5, 100, 50, TonePriority::UI, 1);
+            queueTone(PitchPerception::NOTE_A5, 150, 0, TonePriority::UI, 2);
         }
         else if (strcmp(line, "scan_complete") == 0) {
             // Success tune
-            SoundFxManager::playTone(PitchPerception::NOTE_C5, 100, 0);
-            delay(30);
-            SoundFxManager::playTone(PitchPerception::NOTE_E5, 100, 1);
-            delay(30);
-            SoundFxManager::playTone(PitchPerception::NOTE_G5, 100, 2);
-            delay(30);
-            SoundFxManager::playTone(PitchPerception::NOTE_C6, 200);
+            queueTone(PitchPerception::NOTE_C5, 100, 30, TonePriority::UI, 0);
+            queueTone(PitchPerception::NOTE_E5, 100, 30, TonePriority::UI, 1);
+            queueTone(PitchPerception::NOTE_G5, 100, 30, TonePriority::UI, 2);
+            queueTone(PitchPerception::NOTE_C6, 200);
         }
         else if (strcmp(line, "scan_error") == 0) {
             // Error tune
-            SoundFxManager::playTone(PitchPerception::NOTE_G4, 200, 0);
-            delay(50);
-            SoundFxManager::playTone(PitchPerception::NOTE_E4, 200, 1);
-            delay(50);
-            SoundFxManager::playTone(PitchPerception::NOTE_C4, 300, 2);
+            queueTone(PitchPerception::NOTE_G4, 200, 50, TonePriority::UI, 0);
+            queueTone(PitchPerception::NOTE_E4, 200, 50, TonePriority::UI, 1);
+            queueTone(PitchPerception::NOTE_C4, 300, 0, TonePriority::UI, 2);
         }
         else if (strcmp(line, "level_up") == 0) {
             // Mario-style level up fanfare
-            SoundFxManager::playTone(PitchPerception::NOTE_G4, 100, 0);
-            delay(50);
-            SoundFxManager::playTone(PitchPerception::NOTE_C5, 100, 1);
-            delay(50);
-            SoundFxManager::playTone(PitchPerception::NOTE_E5, 100, 2);
-            delay(50);
-            SoundFxManager::playTone(PitchPerception::NOTE_G5, 100, 3);
-            delay(50);
-            SoundFxManager::playTone(PitchPerception::NOTE_C6, 150, 4);
-            delay(100);
-            SoundFxManager::playTone(PitchPerception::NOTE_E6, 400);
+            queueTone(PitchPerception::NOTE_G4, 100, 50, TonePriority::UI, 0);
+            queueTone(PitchPerception::NOTE_C5, 100, 50, TonePriority::UI, 1);
+            queueTone(PitchPerception::NOTE_E5, 100, 50, TonePriority::UI, 2);
+            queueTone(PitchPerception::NOTE_G5, 100, 50, TonePriority::UI, 3);
+            queueTone(PitchPerception::NOTE_C6, 150, 100, TonePriority::UI, 4);
+            queueTone(PitchPerception::NOTE_E6, 400);
         }
         else if (strcmp(line, "volume_up") == 0) {
             // Volume up tune
-            SoundFxManager::playTone(PitchPerception::NOTE_C5, 100, 0);
-            delay(50);
-            SoundFxManager::playTone(PitchPerception::NOTE_E5, 100, 1);
-            delay(50);
-            SoundFxManager::playTone(PitchPerception::NOTE_G5, 100, 2);
+            queueTone(PitchPerception::NOTE_C5, 100, 50, TonePriority::UI, 0);
+            queueTone(PitchPerception::NOTE_E5, 100, 50, TonePriority::UI, 1);
+            queueTone(PitchPerception::NOTE_G5, 100, 0, TonePriority::UI, 2);
         }
         else if (strcmp(line, "volume_down") == 0) {
             // Volume down tune
-            SoundFxManager::playTone(PitchPerception::NOTE_G4, 100, 0);
-            delay(50);
-            SoundFxManager::playTone(PitchPerception::NOTE_E4, 100, 1);
-            delay(50);
-            SoundFxManager::playTone(PitchPerception::NOTE_C4, 100, 2);
+            queueTone(PitchPerception::NOTE_G4, 100, 50, TonePriority::UI, 0);
+            queueTone(PitchPerception::NOTE_E4, 100, 50, TonePriority::UI, 1);
+            queueTone(PitchPerception::NOTE_C4, 100, 0, TonePriority::UI, 2);
         }
         
     }
 
     void SoundFxManager::playMenuCloseSound() {
         // Play a descending tone sequence for closing
-        playTone(PitchPerception::NOTE_C5, 100); // C5
-        delay(50);
-        playTone(PitchPerception::NOTE_B4, 100); // B4
-        delay(50);
-        playTone(PitchPerception::NOTE_A4, 100); // A4
-        delay(50);
-        playTone(PitchPerception::NOTE_G4, 100); // G4
+        queueTone(PitchPerception::NOTE_C5, 100, 50); // C5
+        queueTone(PitchPerception::NOTE_B4, 100, 50); // B4
+        queueTone(PitchPerception::NOTE_A4, 100, 50); // A4
+        queueTone(PitchPerception::NOTE_G4, 100);     // G4
     }
 
     void SoundFxManager::playMenuOpenSound() {
         // Play an ascending tone sequence for opening
-        playTone(PitchPerception::NOTE_G4, 100); // G4
-        delay(50);
-        playTone(PitchPerception::NOTE_A4, 100); // A4
-        delay(50);
-        playTone(PitchPerception::NOTE_B4, 100); // B4
-        delay(50);
-        playTone(PitchPerception::NOTE_C5, 100); // C5
+        queueTone(PitchPerception::NOTE_G4, 100, 50); // G4
+        queueTone(PitchPerception::NOTE_A4, 100, 50); // A4
+        queueTone(PitchPerception::NOTE_B4, 100, 50); // B4
+        queueTone(PitchPerception::NOTE_C5, 100);     // C5
     }
 
     void SoundFxManager::playMenuSelectSound() {
-        // Play a short, sharp tone with a slight variation
-        playTone(PitchPerception::NOTE_E5, 100); // E5 for selection
-        delay(50);
-        playTone(PitchPerception::NOTE_C5, 100); // C5
-        delay(50);
-        playTone(PitchPerception::NOTE_E5, 100); // E5 again
-        delay(50);
-        playTone(PitchPerception::NOTE_G5, 100); // G5 for a higher note
+        // E5 C5 E5 G5: short, sharp and rising at the end
+        playEffect(SoundEffects::get(PC::AudioTypes::Tone::MENU_SELECT));
     }
 
     void SoundFxManager::playCardMelody(uint32_t cardId) 
@@ -617,8 +1357,7 @@ namespace AuditoryCortex
         for (int i = 0; i < MELODY_LENGTH; i++) 
         {
             uint8_t duration = 50 + (notes[i] % 100);  // Variable note length
-            SoundFxManager::playTone(baseNotes[notes[i]], duration, i);
-            delay(duration * 0.6);  // Overlap notes slightly for smoother transition
+            queueTone(baseNotes[notes[i]], duration, duration * 0.6, TonePriority::TUNE, i);
         }
     }
 
@@ -649,8 +1388,7 @@ namespace AuditoryCortex
         else if (color == CRGB::White) baseNote = colorToNoteMap[7];
         
         // Initial clear note for attention
-        SoundFxManager::playTone(baseNote, 50, 0);
-        delay(10);
+        queueTone(baseNote, 50, 10, TonePriority::UI, 0);
         
         // Enhanced water drop effect with harmonic series
         const int STEPS = 4;
@@ -660,8 +1398,7 @@ namespace AuditoryCortex
         for (int i = 0; i < STEPS; i++) 
         {
             int pitch = baseNote - (DROP_RANGE >> i);  // Exponential pitch drop
-            SoundFxManager::playTone(pitch, DURATION, 0);
-            delay(DURATION - (i * 2));  // Accelerating tempo
+            queueTone(pitch, DURATION, DURATION - (i * 2), TonePriority::UI, 0);  // Accelerating tempo
         }
     }
 
@@ -672,62 +1409,40 @@ namespace AuditoryCortex
         // Play binary representation of error code
         for (int i = 7; i >= 0; i--) {
             if (errorCode & (1 << i)) {
-                playTone(baseFreq, 100);
+                queueTone(baseFreq, 100, 50, TonePriority::ALERT);
             } else {
-                playTone(baseFreq/2, 100);
+                queueTone(baseFreq/2, 100, 50, TonePriority::ALERT);
             }
-            delay(50);
         }
         
         // Final tone indicates fatal/warning
         if (isFatal) {
-            playTone(220, 500); // Low A3 for fatal
+            queueTone(220, 500, 0, TonePriority::ALERT); // Low A3 for fatal
         } else {
-            playTone(1760, 200); // High A6 for warning
+            queueTone(1760, 200, 0, TonePriority::ALERT); // High A6 for warning
         }
     }
 
     void SoundFxManager::playToneFx(PC::AudioTypes::Tone type) 
     {
-        switch (type) 
+        // Fixed effects come from the shared tables; the rest depend on context
+        const SoundEffect& effect = SoundEffects::get(type);
+        if (!effect.events.empty()) 
         {
-            case PC::AudioTypes::Tone::SUCCESS:
-                playSuccessSound();
-                break;
-
-            case PC::AudioTypes::Tone::ERROR:
-                playErrorSound(ErrorSoundType::PLAYBACK);
-                break;
-
-            case PC::AudioTypes::Tone::WARNING:
-                playErrorSound(ErrorSoundType::STORAGE);
-                break;
-
-            case PC::AudioTypes::Tone::NOTIFICATION:
-                playTone(PitchPerception::NOTE_C5, 100);
-                break;
+            playEffect(effect);
+            return;
+        }
 
+        switch (type) 
+        {
             case PC::AudioTypes::Tone::TIMER_DROP:
                 playTimerDropSound(CRGB::Blue);
                 break;
 
-            case PC::AudioTypes::Tone::LEVEL_UP:
-                playSuccessSound();  // Could be customized for level up
-                break;
-
-            case PC::AudioTypes::Tone::GAME_OVER:
-                playErrorSound(ErrorSoundType::PLAYBACK);
-                break;
-
-            case PC::AudioTypes::Tone::MENU_SELECT:
-                playMenuSelectSound();
-                break;
-
             case PC::AudioTypes::Tone::MENU_CHANGE:
                 playRotaryTurnSound(true);
                 break;
 
-            case PC::AudioTypes::Tone::NONE:
             default:
                 break;
         }
@@ -19,15 +19,26 @@
 #include "PitchPerception.h"
 #include "../PrefrontalCortex/Utilities.h"
 #include "../PrefrontalCortex/ProtoPerceptions.h"
+#include "../PrefrontalCortex/StorageWorker.h"
 #include "../VisualCortex/RoverManager.h"
 #include "../MotorCortex/PinDefinitions.h"
 #include "Tunes.h"
+#include "ToneSequencer.h"
+#include "SoundEffects.h"
+#include "WavetableSynth.h"
+#include "AudioMixer.h"
+#include "SampleBank.h"
+#include "MediaClock.h"
+#include "AudioCapture.h"
+#include "AudioCodecs.h"
+#include "SongParser.h"
 
 #include <time.h>
 #include <SPIFFS.h>
 #include <FS.h>
-#include <Audio.h>
 #include <SD.h>
+#include <atomic>
+#include <freertos/event_groups.h>
 
 namespace AuditoryCortex
 {
@@ -49,6 +60,19 @@ namespace AuditoryCortex
     static const int WAVE_HEADER_SIZE = 44;  // WAV header size in bytes
     static const int BYTE_RATE = (EXAMPLE_SAMPLE_RATE * 2);  // 16-bit mono = 2 bytes per sample
 
+    /**
+     * @brief Fills in the next note of a streamed sequence; false once there are no more
+     */
+    typedef bool (*NoteSource)(void* context, ToneEvent& event);
+
+    /**
+     * @brief LEDs to light in one colour when a queued tone is heard
+     */
+    struct ToneLight
+    {
+        uint32_t ledMask;
+        CRGB color;
+    };
 
     class SoundFxManager {
     private:
@@ -68,10 +92,60 @@ namespace AuditoryCortex
          * @brief Audio recording and playback state
          */
         static bool isRecording;
-        static File recordFile;
-        static Audio audio;
+        static PC::StorageBackend::Handle recordFile;
+        static uint32_t recordOffset;               // Next capture block position in recordFile
+        static PC::StorageFuture recordWrite;       // Completion of the block on the storage task
         static bool isPlayingSound;
 
+        /**
+         * @brief Streaming capture: I2S -> ring (capture task) -> SD blocks (writer task)
+         */
+        static uint8_t* captureStorage;
+        static uint8_t* captureBlock;
+        static CaptureRing* captureRing;
+        static CaptureWriter* captureWriter;
+        static TaskHandle_t captureTaskHandle;
+        static TaskHandle_t writerTaskHandle;
+        static volatile bool captureRunning;
+        static volatile bool pitchTracking;     // Capture task feeds PitchPerception
+        static EventGroupHandle_t captureEvents;    // Each capture task sets its bit as it exits
+        static std::atomic<uint8_t> captureHolds;   // Stop and the tasks still using the buffers; the last frees them
+        static const EventBits_t CAPTURE_TASK_EXITED = BIT0;
+        static const EventBits_t WRITER_TASK_EXITED = BIT1;
+        static const uint32_t WRITER_STOP_TIMEOUT_MS = 2000;  // A stalled card write is left to finish on its own
+        static const uint32_t CAPTURE_RING_BYTES = 32768;   // ~370 ms at 16-bit/44.1 kHz
+        static const uint32_t CAPTURE_BLOCK_BYTES = 8192;
+        static const uint32_t CAPTURE_DMA_CHUNK = 1024;
+        static AudioEncoder captureEncoder;
+        static RecordingFormat recordingFormat;
+        static uint8_t recordingDecimation;
+
+        /**
+         * @brief Streamed playback: SD -> decoder (main loop) -> PCM ring -> synth task mix
+         */
+        static File playbackFile;
+        static StreamDecoder playbackDecoder;
+        static uint8_t* playbackStorage;
+        static CaptureRing* playbackRing;
+        static uint8_t playbackStep;
+        static std::atomic<bool> streamPlaying;
+        static std::atomic<bool> playbackReading;   // The render task is inside readPlayback()
+        static const uint32_t PLAYBACK_RING_BYTES = 16384;
+        static const size_t PLAYBACK_READ_BYTES = 256;
+
+        /**
+         * @brief RTTTL / MIDI songs streamed from SD into the tune lane
+         */
+        static File songFile;
+        static SongParser songParser;
+        static bool songPlaying;
+
+        /**
+         * @brief Notes generated on the fly into the tune lane, such as a card's song
+         */
+        static NoteSource noteSource;
+        static void* noteSourceContext;
+
         /**
          * @brief System configuration and state
          */
@@ -81,6 +155,45 @@ namespace AuditoryCortex
         static Tune activeTune;
         static int activeTuneLength;
 
+        /**
+         * @brief Non-blocking tone scheduling and synth rendering
+         */
+        static ToneSequencer sequencer;
+        static WavetableSynth synth;
+        static AudioMixer mixer;
+        static MediaClock mediaClock;
+
+        /**
+         * @brief Short clips decoded into PSRAM and played on the UI channel
+         */
+        static SampleBank sampleBank;
+        static SamplePlayer samplePlayer;
+        static File sampleFile;
+        static bool sampleOnCard;                       // sampleFile is on SD, so reads lease the bus
+        static const uint32_t SAMPLE_BUDGET_PSRAM = 1024 * 1024;
+        static const uint32_t SAMPLE_BUDGET_HEAP = 64 * 1024;
+        static TaskHandle_t synthTaskHandle;
+        static volatile bool synthOutputReady;
+        static const uint8_t TUNE_LOOKAHEAD = 4;  // Tune notes queued ahead of playback
+        static const uint8_t SUSTAIN_TAG = 0xFE;  // Synth tag for untimed playTone() notes
+        static const uint16_t SYNTH_BLOCK_FRAMES = 128;
+        static const uint8_t SYNTH_DMA_BUFFERS = 8;
+        static const uint16_t SYNTH_WRITE_TIMEOUT_MS = 20;
+
+        /**
+         * @brief Lights waiting for their tones to start, in a ring reused oldest first
+         */
+        static const uint8_t LIT_TONE_SLOTS = 16;
+        static const uint8_t LIGHTS_PER_TONE = 2;
+        static const uint16_t LIT_TONE_CUE = 0x8000;    // Cue bit: the rest picks a lit tone, not a tune note
+        struct LitTone
+        {
+            ToneLight lights[LIGHTS_PER_TONE];
+            uint8_t count;
+        };
+        static LitTone litTones[LIT_TONE_SLOTS];
+        static uint8_t nextLitTone;
+
         /* ========================== Private Methods ========================== */
         /**
          * @brief Initialize audio hardware components
@@ -89,9 +202,57 @@ namespace AuditoryCortex
         static void initializeAudio();
         
         /**
-         * @brief Generate WAV header for recording
+         * @brief Generate WAV header for recording in the selected format
+         * @return Header length in bytes
+         */
+        static size_t generate_wav_header(uint8_t* wav_header, uint32_t wav_size, uint32_t sample_rate);
+
+        /**
+         * @brief Sequencer output pathways into the synth
+         */
+        static void onToneStart(uint8_t slot, const AuditoryCortex::ToneEvent& event);
+        static void onToneStop(uint8_t slot);
+        static MixChannel laneChannel(uint8_t slot);
+        static void configureMixer();
+
+        /**
+         * @brief I2S speaker ownership; the microphone borrows the same port
+         */
+        static bool installSpeakerOutput();
+        static void releaseSpeakerOutput();
+        static void synthTask(void* parameter);
+
+        /**
+         * @brief Recording pipeline tasks and storage hooks
+         */
+        static bool installMicrophoneInput();
+        static void startCaptureTasks(bool withWriter);
+        static void captureTaskExited(EventBits_t bit);
+        static void captureTask(void* parameter);
+        static void writerTask(void* parameter);
+        static size_t writeCaptureBlock(void* context, const uint8_t* data, size_t length);
+        static uint32_t captureClock();
+        static void releaseCapture();
+        static void pumpPlayback();
+        static size_t readPlayback(void* context, int16_t* out, size_t frames);
+
+        /**
+         * @brief Sample bank storage and memory hooks
          */
-        static void generate_wav_header(char* wav_header, uint32_t wav_size, uint32_t sample_rate);
+        static bool openSampleFile(void* context, const char* path);
+        static size_t readSampleFile(void* context, uint8_t* data, size_t length);
+        static void closeSampleFile(void* context);
+        static void* allocateSample(size_t bytes);
+        static void releaseSample(void* memory);
+        static void preloadSamples();
+
+        /**
+         * @brief Song import helpers
+         */
+        static size_t readSongFile(void* context, uint32_t offset, uint8_t* data, size_t length);
+        static uint16_t songNoteDuration(const SongEvent& note);
+        static void updateSong();
+        static void updateNoteSource();
 
     public:
         /* ========================== Core Functionality ========================== */
@@ -110,6 +271,48 @@ namespace AuditoryCortex
         static void playTune(PC::AudioTypes::TunesTypes type);
         static void playTone(int frequency, int duration, int volume = 42);
 
+        /**
+         * @brief Queue a tone followed by a silent gap; returns immediately
+         */
+        static void queueTone(uint16_t frequency, uint16_t duration, uint16_t gap = 0,
+                              TonePriority priority = TonePriority::UI, int volume = 42);
+        static void queueChord(const uint16_t* frequencies, uint8_t count, uint16_t duration, uint16_t gap = 0,
+                               TonePriority priority = TonePriority::UI, int volume = 42);
+
+        /**
+         * @brief Queue a tone and light its LEDs as it is heard, not as it is queued
+         * @param count Lights used, at most LIGHTS_PER_TONE
+         */
+        static void queueLitTone(uint16_t frequency, uint16_t duration, uint16_t gap, const ToneLight* lights,
+                                 uint8_t count, TonePriority priority = TonePriority::UI, int volume = 42);
+        /**
+         * @brief Queue a table-driven effect whole, or drop it if its lane is full
+         */
+        static bool playEffect(const SoundEffect& effect, int volume = SoundEffects::DEFAULT_VOLUME);
+        static bool isTonePlaying() { return sequencer.isBusy(); }
+        static void stopTones();
+        static uint8_t tuneQueueSpace() { return sequencer.freeSpace(TonePriority::TUNE); }
+
+        /**
+         * @brief Output bus levels and trigger-to-sound latency
+         */
+        static void setChannelVolume(MixChannel channel, uint8_t gain) { mixer.setChannelGain(channel, gain); }
+        static MixerStats getMixerStats() { return mixer.stats(); }
+
+        /**
+         * @brief Shared audio/visual timeline, in presented-sample time
+         */
+        static uint64_t mediaMicros() { return mediaClock.nowMicros(); }
+        static uint32_t mediaMs() { return mediaClock.nowMs(); }
+
+        /**
+         * @brief Play a mono WAV clip from the sample bank, loading it on a miss
+         * @return false if the clip is missing, unsupported or over budget
+         */
+        static bool playSample(const char* path);
+        static bool isSamplePlaying() { return samplePlayer.isPlaying(); }
+        static SampleBankStats getSampleStats() { return sampleBank.stats(); }
+
         /**
          * @brief UI interaction sound effects
          */
@@ -137,7 +340,22 @@ namespace AuditoryCortex
         static void startTune();
         static void updateTune();
         static bool isTunePlaying() { return m_isTunePlaying; }
-        static void stopTune() { m_isTunePlaying = false; }
+        static void stopTune();
+
+        /* ========================== Song Import ========================== */
+        /**
+         * @brief Stream an .rtttl/.txt ringtone or .mid file from SD; no firmware rebuild needed
+         */
+        static bool playSongFile(const char* path);
+        static void stopSong();
+        static bool isSongPlaying() { return songPlaying; }
+
+        /**
+         * @brief Play notes from source on the tune lane, asked for a few at a time so none are dropped
+         */
+        static void playNoteSource(NoteSource source, void* context);
+        static void stopNoteSource();
+        static bool isNoteSourcePlaying() { return noteSource != nullptr; }
 
         /* ========================== Volume Control ========================== */
         static void adjustVolume(int amount);
@@ -146,22 +364,28 @@ namespace AuditoryCortex
         static void startRecording();
         static void stopRecording();
         static void playRecording();
+
+        /**
+         * @brief Select capture encoding; decimation 2 or 4 halves/quarters the rate for voice
+         */
+        static void setRecordingFormat(RecordingFormat format, uint8_t decimation = 1);
+        static RecordingFormat getRecordingFormat() { return recordingFormat; }
         static bool isCurrentlyRecording() { return isRecording; }
         static bool isCurrentlyPlaying() { return isPlayingSound; }
         static bool isPlaying() { return isPlayingSound; }
 
+        /**
+         * @brief Tuner / sing-along listening; the speaker is silent while the mic owns I2S
+         */
+        static void startPitchTracking();
+        static void stopPitchTracking();
+        static bool isPitchTracking() { return pitchTracking; }
+
         /* ========================== Error Playback ========================== */
         static void playErrorCode(uint32_t errorCode, bool isFatal);
 
         /* ========================== Update Function ========================== */
-        static void update() {
-            if (m_isTunePlaying) {
-                updateTune();
-            }
-            if (isPlayingSound) {
-                audio_eof_mp3("update");
-            }
-        }
+        static void update();
 
         /* ========================== Audio Event Callbacks ========================== */
         static void audio_eof_mp3(const char* info);
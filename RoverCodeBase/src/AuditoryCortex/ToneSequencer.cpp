@@ -0,0 +1,303 @@
+/**
+ * @file ToneSequencer.cpp
+ * @brief Implementation of the non-blocking, priority-laned tone scheduler
+ */
+
+#include "ToneSequencer.h"
+#include <string.h>
+
+namespace AuditoryCortex
+{
+    ToneSequencer::ToneSequencer()
+        : m_onStart(nullptr),
+          m_onStop(nullptr),
+          m_activeLane(-1),
+          m_nowMs(0),
+          m_preemptive(true)
+    {
+        memset(m_lanes, 0, sizeof(m_lanes));
+    }
+
+    void ToneSequencer::setOutput(StartCallback onStart, StopCallback onStop)
+    {
+        m_onStart = onStart;
+        m_onStop = onStop;
+    }
+
+    bool ToneSequencer::enqueue(TonePriority priority, const ToneEvent& event, bool replacePending)
+    {
+        uint8_t laneIndex = static_cast<uint8_t>(priority);
+        if (laneIndex >= LANE_COUNT) return false;
+
+        Lane& lane = m_lanes[laneIndex];
+        if (replacePending)
+        {
+            // Interrupt: forget queued notes and re-anchor on the next update
+            lane.head = 0;
+            lane.count = 0;
+            lane.running = false;
+            lane.paused = false;
+            silenceLane(laneIndex);
+        }
+
+        if (lane.count >= LANE_CAPACITY) return false;
+
+        uint8_t tail = (lane.head + lane.count) % LANE_CAPACITY;
+        lane.events[tail] = event;
+        lane.count++;
+        return true;
+    }
+
+    bool ToneSequencer::enqueueTone(TonePriority priority, uint16_t frequency, uint16_t durationMs,
+                                    uint16_t gapMs, uint8_t volume, uint16_t cue)
+    {
+        ToneEvent event;
+        event.frequency = frequency;
+        event.durationMs = durationMs;
+        event.advanceMs = durationMs + gapMs;
+        event.volume = volume;
+        event.cue = cue;
+        return enqueue(priority, event);
+    }
+
+    void ToneSequencer::update(uint32_t nowMs)
+    {
+        m_nowMs = nowMs;
+
+        for (uint8_t i = 0; i < LANE_COUNT; i++)
+        {
+            releaseExpired(i, nowMs);
+        }
+
+        // Highest busy lane; when preemptive it owns the output and everything below waits
+        int top = -1;
+        for (int i = LANE_COUNT - 1; i >= 0; i--)
+        {
+            if (laneBusy(m_lanes[i], nowMs))
+            {
+                top = i;
+                break;
+            }
+        }
+
+        if (m_preemptive)
+        {
+            for (int i = 0; i < top; i++)
+            {
+                if (!m_lanes[i].paused && laneBusy(m_lanes[i], nowMs))
+                {
+                    pauseLane(i, nowMs);
+                }
+            }
+            if (top >= 0)
+            {
+                advanceLane(top, nowMs);
+            }
+        }
+        else
+        {
+            // A mixer downstream ducks the lower lanes instead
+            for (uint8_t i = 0; i < LANE_COUNT; i++)
+            {
+                if (laneBusy(m_lanes[i], nowMs)) advanceLane(i, nowMs);
+            }
+        }
+
+        for (uint8_t i = 0; i < LANE_COUNT; i++)
+        {
+            Lane& lane = m_lanes[i];
+            if (lane.running && !laneBusy(lane, nowMs))
+            {
+                lane.running = false;
+                lane.paused = false;
+            }
+        }
+
+        m_activeLane = top;
+    }
+
+    void ToneSequencer::advanceLane(uint8_t laneIndex, uint32_t nowMs)
+    {
+        Lane& lane = m_lanes[laneIndex];
+        if (lane.paused)
+        {
+            resumeLane(laneIndex, nowMs);
+        }
+        if (!lane.running && lane.count > 0)
+        {
+            lane.running = true;
+            lane.nextOnsetMs = nowMs;
+        }
+
+        // Catch up on every onset that is due, using scheduled rather than
+        // observed times so a late tick never stretches the rhythm
+        while (lane.count > 0 && reached(nowMs, lane.nextOnsetMs))
+        {
+            ToneEvent event = lane.events[lane.head];
+            lane.head = (lane.head + 1) % LANE_CAPACITY;
+            lane.count--;
+
+            uint32_t onsetMs = lane.nextOnsetMs;
+            lane.nextOnsetMs += event.advanceMs;
+            startEvent(laneIndex, event, onsetMs, nowMs);
+        }
+    }
+
+    void ToneSequencer::setPreemptive(bool preemptive)
+    {
+        if (!preemptive)
+        {
+            // Resume anything currently held so it rejoins the mix
+            for (uint8_t i = 0; i < LANE_COUNT; i++)
+            {
+                if (m_lanes[i].paused) resumeLane(i, m_nowMs);
+            }
+        }
+        m_preemptive = preemptive;
+    }
+
+    void ToneSequencer::clear(TonePriority priority)
+    {
+        uint8_t laneIndex = static_cast<uint8_t>(priority);
+        if (laneIndex >= LANE_COUNT) return;
+
+        Lane& lane = m_lanes[laneIndex];
+        lane.head = 0;
+        lane.count = 0;
+        lane.running = false;
+        lane.paused = false;
+        silenceLane(laneIndex);
+    }
+
+    void ToneSequencer::stopAll()
+    {
+        for (uint8_t i = 0; i < LANE_COUNT; i++)
+        {
+            clear(static_cast<TonePriority>(i));
+        }
+        m_activeLane = -1;
+    }
+
+    bool ToneSequencer::isBusy() const
+    {
+        for (uint8_t i = 0; i < LANE_COUNT; i++)
+        {
+            if (laneBusy(m_lanes[i], m_nowMs)) return true;
+        }
+        return false;
+    }
+
+    bool ToneSequencer::isLaneBusy(TonePriority priority) const
+    {
+        uint8_t laneIndex = static_cast<uint8_t>(priority);
+        if (laneIndex >= LANE_COUNT) return false;
+        return laneBusy(m_lanes[laneIndex], m_nowMs);
+    }
+
+    uint8_t ToneSequencer::pendingCount(TonePriority priority) const
+    {
+        uint8_t laneIndex = static_cast<uint8_t>(priority);
+        if (laneIndex >= LANE_COUNT) return 0;
+        return m_lanes[laneIndex].count;
+    }
+
+    uint8_t ToneSequencer::freeSpace(TonePriority priority) const
+    {
+        return LANE_CAPACITY - pendingCount(priority);
+    }
+
+    bool ToneSequencer::laneBusy(const Lane& lane, uint32_t nowMs) const
+    {
+        if (lane.count > 0) return true;
+        for (uint8_t v = 0; v < VOICES_PER_LANE; v++)
+        {
+            if (lane.voices[v].active) return true;
+        }
+        // Honor the trailing gap of the last note before lower lanes resume
+        if (lane.running && lane.paused) return true;
+        return lane.running && !reached(nowMs, lane.nextOnsetMs);
+    }
+
+    void ToneSequencer::releaseExpired(uint8_t laneIndex, uint32_t nowMs)
+    {
+        Lane& lane = m_lanes[laneIndex];
+        for (uint8_t v = 0; v < VOICES_PER_LANE; v++)
+        {
+            SoundingVoice& voice = lane.voices[v];
+            if (voice.active && reached(nowMs, voice.endMs))
+            {
+                voice.active = false;
+                if (m_onStop) m_onStop(laneIndex * VOICES_PER_LANE + v);
+            }
+        }
+    }
+
+    void ToneSequencer::silenceLane(uint8_t laneIndex)
+    {
+        Lane& lane = m_lanes[laneIndex];
+        for (uint8_t v = 0; v < VOICES_PER_LANE; v++)
+        {
+            if (lane.voices[v].active)
+            {
+                lane.voices[v].active = false;
+                if (m_onStop) m_onStop(laneIndex * VOICES_PER_LANE + v);
+            }
+        }
+    }
+
+    void ToneSequencer::startEvent(uint8_t laneIndex, const ToneEvent& event, uint32_t onsetMs, uint32_t nowMs)
+    {
+        if (event.frequency == 0 || event.durationMs == 0) return;  // Rest
+
+        uint32_t endMs = onsetMs + event.durationMs;
+        if (reached(nowMs, endMs)) return;  // Already over after a stall
+
+        Lane& lane = m_lanes[laneIndex];
+
+        // Free voice, or steal the one closest to its release
+        uint8_t chosen = NO_SLOT;
+        for (uint8_t v = 0; v < VOICES_PER_LANE; v++)
+        {
+            if (!lane.voices[v].active)
+            {
+                chosen = v;
+                break;
+            }
+        }
+        if (chosen == NO_SLOT)
+        {
+            chosen = 0;
+            for (uint8_t v = 1; v < VOICES_PER_LANE; v++)
+            {
+                if (static_cast<int32_t>(lane.voices[v].endMs - lane.voices[chosen].endMs) < 0)
+                {
+                    chosen = v;
+                }
+            }
+            if (m_onStop) m_onStop(laneIndex * VOICES_PER_LANE + chosen);
+        }
+
+        lane.voices[chosen].active = true;
+        lane.voices[chosen].endMs = endMs;
+        if (m_onStart) m_onStart(laneIndex * VOICES_PER_LANE + chosen, event);
+    }
+
+    void ToneSequencer::pauseLane(uint8_t laneIndex, uint32_t nowMs)
+    {
+        Lane& lane = m_lanes[laneIndex];
+        silenceLane(laneIndex);
+        lane.paused = true;
+        lane.pausedAtMs = nowMs;
+    }
+
+    void ToneSequencer::resumeLane(uint8_t laneIndex, uint32_t nowMs)
+    {
+        Lane& lane = m_lanes[laneIndex];
+        if (lane.running)
+        {
+            // Shift the remaining timeline by however long we were preempted
+            lane.nextOnsetMs += nowMs - lane.pausedAtMs;
+        }
+        lane.paused = false;
+    }
+}
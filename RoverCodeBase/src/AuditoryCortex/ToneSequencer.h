@@ -0,0 +1,149 @@
+/**
+ * @brief ToneSequencer schedules tone onsets and releases without blocking
+ *
+ * Replaces the delay()-driven tone chains with a time-driven event queue:
+ * - Fixed-size note queue per priority lane (no heap use)
+ * - Scheduled start and stop events emitted through output callbacks
+ * - Priority preemption: a busier, higher lane pauses every lane below it
+ * - Paused lanes resume where they left off once the higher lane drains
+ * - Preemption can be switched off when a mixer ducks lanes instead
+ *
+ * The sequencer only depends on the clock value handed to update(), so the
+ * same code runs against millis() on the rover and a simulated clock on host.
+ */
+
+#ifndef TONE_SEQUENCER_H
+#define TONE_SEQUENCER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace AuditoryCortex
+{
+    /**
+     * @brief Priority lanes, lowest to highest
+     *
+     * - TUNE: Songs, jingles and card melodies
+     * - UI: Rotary clicks, menu sounds and confirmations
+     * - ALERT: Error codes and warnings that must always be heard
+     */
+    enum class TonePriority : uint8_t
+    {
+        TUNE = 0,
+        UI = 1,
+        ALERT = 2
+    };
+
+    /**
+     * @brief A single scheduled tone
+     *
+     * durationMs is how long the tone sounds, advanceMs is the time from this
+     * onset to the next onset in the same lane. advanceMs > durationMs leaves a
+     * gap, advanceMs < durationMs overlaps the next tone.
+     */
+    struct ToneEvent
+    {
+        uint16_t frequency;   // Hz, 0 = rest
+        uint16_t durationMs;  // Sounding time
+        uint16_t advanceMs;   // Onset-to-onset time
+        uint8_t volume;       // Output level handed to the backend
+        uint16_t cue;         // Caller tag echoed at onset (0 = none)
+    };
+
+    class ToneSequencer
+    {
+    public:
+        static constexpr uint8_t LANE_COUNT = 3;
+        static constexpr uint8_t LANE_CAPACITY = 64;
+        static constexpr uint8_t VOICES_PER_LANE = 4;
+        static constexpr uint8_t NO_SLOT = 0xFF;
+
+        /**
+         * @brief Output pathways, slot = lane * VOICES_PER_LANE + voice
+         */
+        typedef void (*StartCallback)(uint8_t slot, const ToneEvent& event);
+        typedef void (*StopCallback)(uint8_t slot);
+
+        ToneSequencer();
+
+        void setOutput(StartCallback onStart, StopCallback onStop);
+
+        /**
+         * @brief When false, every busy lane plays at once and the output
+         *        stage is left to balance them (default true)
+         */
+        void setPreemptive(bool preemptive);
+
+        /**
+         * @brief Queue a tone on a lane
+         * @param replacePending Drop notes still waiting in this lane first
+         * @return false if the lane is full
+         */
+        bool enqueue(TonePriority priority, const ToneEvent& event, bool replacePending = false);
+
+        /**
+         * @brief Convenience wrapper: tone followed by a silent gap
+         */
+        bool enqueueTone(TonePriority priority, uint16_t frequency, uint16_t durationMs,
+                         uint16_t gapMs = 0, uint8_t volume = 42, uint16_t cue = 0);
+
+        /**
+         * @brief Advance the schedule, emitting every start/stop due at nowMs
+         */
+        void update(uint32_t nowMs);
+
+        void clear(TonePriority priority);
+        void stopAll();
+
+        bool isBusy() const;
+        bool isLaneBusy(TonePriority priority) const;
+        uint8_t pendingCount(TonePriority priority) const;
+        uint8_t freeSpace(TonePriority priority) const;
+
+        /**
+         * @brief Lane currently allowed to sound, or -1 when idle
+         */
+        int activeLane() const { return m_activeLane; }
+
+    private:
+        struct SoundingVoice
+        {
+            bool active;
+            uint32_t endMs;
+        };
+
+        struct Lane
+        {
+            ToneEvent events[LANE_CAPACITY];
+            uint8_t head;
+            uint8_t count;
+            bool running;          // Timeline anchored (nextOnsetMs valid)
+            bool paused;           // Preempted by a higher lane
+            uint32_t nextOnsetMs;
+            uint32_t pausedAtMs;
+            SoundingVoice voices[VOICES_PER_LANE];
+        };
+
+        Lane m_lanes[LANE_COUNT];
+        StartCallback m_onStart;
+        StopCallback m_onStop;
+        int m_activeLane;
+        uint32_t m_nowMs;
+        bool m_preemptive;
+
+        bool laneBusy(const Lane& lane, uint32_t nowMs) const;
+        void releaseExpired(uint8_t laneIndex, uint32_t nowMs);
+        void silenceLane(uint8_t laneIndex);
+        void advanceLane(uint8_t laneIndex, uint32_t nowMs);
+        void startEvent(uint8_t laneIndex, const ToneEvent& event, uint32_t onsetMs, uint32_t nowMs);
+        void pauseLane(uint8_t laneIndex, uint32_t nowMs);
+        void resumeLane(uint8_t laneIndex, uint32_t nowMs);
+
+        static bool reached(uint32_t nowMs, uint32_t targetMs)
+        {
+            return static_cast<int32_t>(nowMs - targetMs) >= 0;
+        }
+    };
+}
+
+#endif // TONE_SEQUENCER_H
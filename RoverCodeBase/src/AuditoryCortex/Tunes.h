@@ -16,7 +16,8 @@
 #include "../CorpusCallosum/SynapticPathways.h"
 #include "../PrefrontalCortex/ProtoPerceptions.h"
 #include "PitchPerception.h"
-#include <vector>
+#include "ToneSequencer.h"
+#include <array>
 #include "../PrefrontalCortex/Utilities.h"
 
 namespace AuditoryCortex
@@ -28,17 +29,34 @@ namespace AuditoryCortex
     using PC::AudioTypes::NoteType;
     using PC::AudioTypes::Tune;
     using PC::AudioTypes::TunesTypes;
+    using PC::AudioTypes::TuneStep;
     using PC::Utilities;
 
+    /**
+     * @brief Resolves each note's frequency and duration at compile time
+     * Rests resolve to frequency 0 so playback can skip them without a lookup
+     */
+    template <size_t N>
+    constexpr std::array<TuneStep, N> buildTuneSteps(const NoteInfo (&notes)[N], TimeSignature timeSignature)
+    {
+        std::array<TuneStep, N> steps{};
+        for (size_t i = 0; i < N; i++) 
+        {
+            steps[i].frequency = (notes[i].note == NoteIndex::REST) ? 0 : PitchPerception::getNoteFrequency(notes[i]);
+            steps[i].durationMs = PitchPerception::getNoteDuration(notes[i].type, timeSignature);
+        }
+        return steps;
+    }
+
     class Tunes 
     {
     public:
         /**
          * @brief Retrieves a specific tune based on the provided type
          * @param type The type of tune to retrieve
-         * @return The requested Tune structure containing the musical composition
+         * @return View of the flash-resident tune; valid for the program lifetime
          */
-        static Tune getTune(TunesTypes type);
+        static const Tune& getTune(TunesTypes type);
 
         /**
          * @brief Gets the length (number of notes) in a specific tune
@@ -47,6 +65,12 @@ namespace AuditoryCortex
          */
         static int getTuneLength(TunesTypes type);
 
+        /**
+         * @brief Sequencer event for one step of a tune
+         * @return Event whose cue is index + 1, so note lights can follow onsets
+         */
+        static ToneEvent toneEvent(const Tune& tune, size_t index, uint8_t volume);
+
         /**
          * @brief Calculates the delay in milliseconds for a given time signature
          * @param timeSignature The musical time signature to calculate for
@@ -57,7 +81,8 @@ namespace AuditoryCortex
     private:
         /**
          * @brief Predefined musical compositions for various occasions and moods
-         * Each tune is stored as a constant Tune structure containing the melody
+         * Each tune is a constant view over constexpr note, LED and step arrays,
+         * so nothing is built at boot and nothing lives on the heap
          */
         static const Tune ROVERBYTE_JINGLE;      // Startup/identity jingle
         static const Tune JINGLE_BELLS;          // Holiday tune
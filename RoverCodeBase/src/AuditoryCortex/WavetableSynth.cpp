@@ -0,0 +1,326 @@
+/**
+ * @file WavetableSynth.cpp
+ * @brief Implementation of the fixed-point polyphonic wavetable voice engine
+ */
+
+#include "WavetableSynth.h"
+#include <math.h>
+#include <string.h>
+
+namespace AuditoryCortex
+{
+    int16_t WavetableSynth::s_tables[WavetableSynth::WAVEFORM_COUNT][WavetableSynth::TABLE_SIZE + 1];
+    bool WavetableSynth::s_tablesReady = false;
+
+    WavetableSynth::WavetableSynth(uint32_t sampleRate)
+        : m_sampleRate(sampleRate),
+          m_ageCounter(0),
+          m_commandHead(0),
+          m_commandTail(0),
+          m_droppedCommands(0),
+          m_activeVoices(0),
+          m_waveform(static_cast<uint8_t>(SynthWaveform::TRIANGLE)),
+          m_masterGain(128),
+          m_stolenVoices(0),
+          m_rejectedNotes(0)
+    {
+        buildTables();
+        memset(m_voices, 0, sizeof(m_voices));
+        for (uint8_t g = 0; g < GROUP_COUNT; g++)
+        {
+            m_groupGains[g].store(128);
+            m_groupVoices[g].store(0);
+        }
+        memset(m_mix, 0, sizeof(m_mix));
+
+        // Short plucked default: fast attack, gentle decay, soft release
+        SynthEnvelope envelope = { 5, 60, 180, 80 };
+        setEnvelope(envelope);
+    }
+
+    void WavetableSynth::buildTables()
+    {
+        if (s_tablesReady) return;
+
+        for (uint16_t i = 0; i <= TABLE_SIZE; i++)
+        {
+            uint16_t n = i % TABLE_SIZE;
+            float position = static_cast<float>(n) / TABLE_SIZE;
+
+            s_tables[0][i] = static_cast<int16_t>(32767.0f * sinf(2.0f * static_cast<float>(M_PI) * position));
+
+            float triangle = position < 0.25f ? position * 4.0f :
+                             position < 0.75f ? 2.0f - position * 4.0f :
+                             position * 4.0f - 4.0f;
+            s_tables[1][i] = static_cast<int16_t>(32767.0f * triangle);
+
+            s_tables[2][i] = n < TABLE_SIZE / 2 ? 24000 : -24000;  // Trimmed to match perceived loudness
+
+            s_tables[3][i] = static_cast<int16_t>(32767.0f * (2.0f * position - 1.0f));
+        }
+        s_tablesReady = true;
+    }
+
+    uint32_t WavetableSynth::msToBlocks(uint16_t ms) const
+    {
+        uint32_t blocks = (static_cast<uint32_t>(ms) * m_sampleRate) / (1000UL * CONTROL_BLOCK);
+        return blocks > 0 ? blocks : 1;
+    }
+
+    void WavetableSynth::setEnvelope(const SynthEnvelope& envelope)
+    {
+        m_attackBlocks = msToBlocks(envelope.attackMs);
+        m_decayBlocks = msToBlocks(envelope.decayMs);
+        m_releaseBlocks = msToBlocks(envelope.releaseMs);
+        m_sustainLevel = envelope.sustainLevel + 1;
+    }
+
+    void WavetableSynth::setGroupGain(uint8_t group, uint8_t gain)
+    {
+        if (group >= GROUP_COUNT) return;
+        m_groupGains[group].store(gain > 128 ? 128 : gain, std::memory_order_relaxed);
+    }
+
+    bool WavetableSynth::noteOn(uint8_t tag, uint16_t frequency, uint8_t level, uint8_t group)
+    {
+        Command command = { CommandType::NOTE_ON, tag, level, group < GROUP_COUNT ? group : static_cast<uint8_t>(GROUP_COUNT - 1), frequency };
+        return pushCommand(command);
+    }
+
+    bool WavetableSynth::noteOff(uint8_t tag)
+    {
+        Command command = { CommandType::NOTE_OFF, tag, 0, 0, 0 };
+        return pushCommand(command);
+    }
+
+    bool WavetableSynth::allNotesOff()
+    {
+        Command command = { CommandType::ALL_OFF, 0, 0, 0, 0 };
+        return pushCommand(command);
+    }
+
+    bool WavetableSynth::pushCommand(const Command& command)
+    {
+        uint8_t head = m_commandHead.load(std::memory_order_relaxed);
+        uint8_t next = (head + 1) % COMMAND_CAPACITY;
+        if (next == m_commandTail.load(std::memory_order_acquire))
+        {
+            m_droppedCommands.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        m_commands[head] = command;
+        m_commandHead.store(next, std::memory_order_release);
+        return true;
+    }
+
+    void WavetableSynth::drainCommands()
+    {
+        uint8_t tail = m_commandTail.load(std::memory_order_relaxed);
+        uint8_t head = m_commandHead.load(std::memory_order_acquire);
+        while (tail != head)
+        {
+            const Command& command = m_commands[tail];
+            switch (command.type)
+            {
+                case CommandType::NOTE_ON:
+                    startVoice(command.tag, command.frequency, command.level, command.group);
+                    break;
+                case CommandType::NOTE_OFF:
+                    releaseVoices(command.tag);
+                    break;
+                case CommandType::ALL_OFF:
+                    for (uint8_t v = 0; v < MAX_VOICES; v++)
+                    {
+                        m_voices[v].stage = Stage::IDLE;
+                        m_voices[v].envelope = 0;
+                        m_voices[v].output = 0;
+                    }
+                    break;
+            }
+            tail = (tail + 1) % COMMAND_CAPACITY;
+        }
+        m_commandTail.store(tail, std::memory_order_release);
+    }
+
+    void WavetableSynth::startVoice(uint8_t tag, uint16_t frequency, uint8_t level, uint8_t group)
+    {
+        if (frequency == 0 || frequency >= m_sampleRate / 2) return;
+
+        // Prefer a silent voice; otherwise steal from the lowest group not above
+        // this note's, taking its quietest releasing voice before its oldest
+        int chosen = -1;
+        for (uint8_t v = 0; v < MAX_VOICES && chosen < 0; v++)
+        {
+            if (m_voices[v].stage == Stage::IDLE) chosen = v;
+        }
+        for (uint8_t g = 0; g <= group && chosen < 0; g++)
+        {
+            for (uint8_t v = 0; v < MAX_VOICES; v++)
+            {
+                const Voice& candidate = m_voices[v];
+                if (candidate.group != g || candidate.stage != Stage::RELEASE) continue;
+                if (chosen < 0 || candidate.envelope < m_voices[chosen].envelope) chosen = v;
+            }
+            for (uint8_t v = 0; v < MAX_VOICES && chosen < 0; v++)
+            {
+                if (m_voices[v].group != g) continue;
+                chosen = v;
+                for (uint8_t w = v + 1; w < MAX_VOICES; w++)
+                {
+                    if (m_voices[w].group == g && static_cast<int32_t>(m_voices[w].age - m_voices[chosen].age) < 0)
+                    {
+                        chosen = w;
+                    }
+                }
+            }
+            if (chosen >= 0) m_stolenVoices.fetch_add(1, std::memory_order_relaxed);
+        }
+        if (chosen < 0)
+        {
+            // Every voice belongs to a more important group
+            m_rejectedNotes.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        Voice& voice = m_voices[chosen];
+        voice.increment = static_cast<uint32_t>((static_cast<uint64_t>(frequency) << 32) / m_sampleRate);
+        voice.peak = (static_cast<int32_t>(level) << 7) << 14;
+        voice.step = voice.peak / static_cast<int32_t>(m_attackBlocks);
+        voice.stage = Stage::ATTACK;
+        voice.tag = tag;
+        voice.group = group;
+        voice.age = m_ageCounter++;
+        // Phase and current envelope are kept so a stolen voice glides instead of clicking
+    }
+
+    void WavetableSynth::releaseVoices(uint8_t tag)
+    {
+        for (uint8_t v = 0; v < MAX_VOICES; v++)
+        {
+            Voice& voice = m_voices[v];
+            if (voice.tag != tag || voice.stage == Stage::IDLE || voice.stage == Stage::RELEASE) continue;
+            voice.stage = Stage::RELEASE;
+            voice.step = -(voice.envelope / static_cast<int32_t>(m_releaseBlocks)) - 1;
+        }
+    }
+
+    int32_t WavetableSynth::stepEnvelope(Voice& voice)
+    {
+        int32_t target = voice.envelope + voice.step;
+        switch (voice.stage)
+        {
+            case Stage::ATTACK:
+                if (target >= voice.peak)
+                {
+                    target = voice.peak;
+                    int32_t sustain = (voice.peak >> 8) * m_sustainLevel;
+                    voice.stage = Stage::DECAY;
+                    voice.step = -((voice.peak - sustain) / static_cast<int32_t>(m_decayBlocks));
+                }
+                break;
+
+            case Stage::DECAY:
+            {
+                int32_t sustain = (voice.peak >> 8) * m_sustainLevel;
+                if (target <= sustain)
+                {
+                    target = sustain;
+                    voice.stage = Stage::SUSTAIN;
+                    voice.step = 0;
+                }
+                break;
+            }
+
+            case Stage::RELEASE:
+                if (target <= 0)
+                {
+                    target = 0;
+                    voice.stage = Stage::IDLE;
+                }
+                break;
+
+            case Stage::SUSTAIN:
+            case Stage::IDLE:
+                break;
+        }
+        return target;
+    }
+
+    void WavetableSynth::render(int16_t* out, size_t frames)
+    {
+        renderBlock(out, frames, 1);
+    }
+
+    void WavetableSynth::renderStereo(int16_t* out, size_t frames)
+    {
+        renderBlock(out, frames, 2);
+    }
+
+    void WavetableSynth::renderBlock(int16_t* out, size_t frames, size_t channels)
+    {
+        drainCommands();
+
+        const int16_t* table = s_tables[m_waveform.load(std::memory_order_relaxed) % WAVEFORM_COUNT];
+        const int32_t master = m_masterGain.load(std::memory_order_relaxed);
+
+        while (frames > 0)
+        {
+            size_t count = frames < CONTROL_BLOCK ? frames : CONTROL_BLOCK;
+            memset(m_mix, 0, count * sizeof(int32_t));
+
+            uint8_t active = 0;
+            uint8_t groupActive[GROUP_COUNT] = { 0 };
+            for (uint8_t v = 0; v < MAX_VOICES; v++)
+            {
+                Voice& voice = m_voices[v];
+                if (voice.stage == Stage::IDLE) continue;
+                active++;
+                groupActive[voice.group]++;
+
+                // Ramp amplitude linearly across the block so envelope and group
+                // gain changes never click
+                int32_t target = stepEnvelope(voice);
+                int32_t groupGain = m_groupGains[voice.group].load(std::memory_order_relaxed);
+                int32_t gain = voice.output;
+                int32_t end = ((target >> 14) * groupGain) >> 7;
+                int32_t gainStep = (end - gain) / static_cast<int32_t>(count);
+                uint32_t phase = voice.phase;
+                const uint32_t increment = voice.increment;
+
+                for (size_t n = 0; n < count; n++)
+                {
+                    uint32_t index = phase >> (32 - TABLE_BITS);
+                    int32_t frac = (phase >> (17 - TABLE_BITS)) & 0x7FFF;
+                    int32_t a = table[index];
+                    int32_t b = table[index + 1];
+                    int32_t sample = a + (((b - a) * frac) >> 15);
+                    m_mix[n] += (sample * gain) >> 15;
+                    gain += gainStep;
+                    phase += increment;
+                }
+
+                voice.phase = phase;
+                voice.envelope = target;
+                voice.output = end;
+            }
+            m_activeVoices.store(active, std::memory_order_relaxed);
+            for (uint8_t g = 0; g < GROUP_COUNT; g++)
+            {
+                m_groupVoices[g].store(groupActive[g], std::memory_order_relaxed);
+            }
+
+            // Master gain and saturation onto the 16-bit bus
+            for (size_t n = 0; n < count; n++)
+            {
+                int32_t mixed = (m_mix[n] * master) >> 7;
+                mixed = mixed > 32767 ? 32767 : mixed;
+                mixed = mixed < -32768 ? -32768 : mixed;
+                for (size_t c = 0; c < channels; c++)
+                {
+                    *out++ = static_cast<int16_t>(mixed);
+                }
+            }
+            frames -= count;
+        }
+    }
+}
@@ -0,0 +1,179 @@
+/**
+ * @brief WavetableSynth renders polyphonic tones into 16-bit PCM blocks
+ *
+ * Software voice engine feeding the I2S output:
+ * - Up to MAX_VOICES simultaneous wavetable oscillators
+ * - Per-voice ADSR envelopes evaluated at control rate
+ * - Fixed-point (Q15) oscillators and an int32 mixing bus with saturation
+ * - Lock-free command ring so notes can be started from the main loop
+ *   while a dedicated task renders
+ * - Voice groups with their own gain; stealing never takes a voice from a
+ *   higher group to start a note in a lower one
+ *
+ * The render kernel has no Arduino or FreeRTOS dependency; the only per-sample
+ * work is a table lookup, an interpolation and a multiply-accumulate.
+ */
+
+#ifndef WAVETABLE_SYNTH_H
+#define WAVETABLE_SYNTH_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+
+namespace AuditoryCortex
+{
+    /**
+     * @brief Oscillator shapes available to every voice
+     */
+    enum class SynthWaveform : uint8_t
+    {
+        SINE = 0,
+        TRIANGLE = 1,
+        SQUARE = 2,
+        SAW = 3
+    };
+
+    /**
+     * @brief Envelope timing in milliseconds, sustain as 0-255 level
+     */
+    struct SynthEnvelope
+    {
+        uint16_t attackMs;
+        uint16_t decayMs;
+        uint8_t sustainLevel;
+        uint16_t releaseMs;
+    };
+
+    class WavetableSynth
+    {
+    public:
+        static constexpr uint8_t MAX_VOICES = 8;
+        static constexpr uint16_t CONTROL_BLOCK = 32;  // Samples per envelope step
+        static constexpr uint16_t TABLE_BITS = 8;
+        static constexpr uint16_t TABLE_SIZE = 1 << TABLE_BITS;
+        static constexpr uint8_t WAVEFORM_COUNT = 4;
+        static constexpr uint8_t COMMAND_CAPACITY = 32;
+        static constexpr uint8_t GROUP_COUNT = 4;      // Ascending priority
+
+        explicit WavetableSynth(uint32_t sampleRate = 44100);
+
+        /* ========================== Control (any one producer) ========================== */
+        /**
+         * @brief Start a note; tag identifies it for the matching noteOff
+         * @param level Peak level 0-255
+         * @param group Voice group, also its stealing priority
+         */
+        bool noteOn(uint8_t tag, uint16_t frequency, uint8_t level, uint8_t group = 0);
+        bool noteOff(uint8_t tag);
+        bool allNotesOff();
+
+        void setWaveform(SynthWaveform waveform) { m_waveform.store(static_cast<uint8_t>(waveform)); }
+        void setMasterGain(uint8_t gain) { m_masterGain.store(gain); }  // 128 = unity
+
+        /**
+         * @brief Per-group gain, 0-128 (unity); changes ramp over one control block
+         */
+        void setGroupGain(uint8_t group, uint8_t gain);
+
+        /**
+         * @brief Configure envelope timing; call before the render task starts
+         */
+        void setEnvelope(const SynthEnvelope& envelope);
+
+        /* ========================== Rendering (single consumer) ========================== */
+        /**
+         * @brief Render mono samples; frames should be a multiple of CONTROL_BLOCK
+         */
+        void render(int16_t* out, size_t frames);
+
+        /**
+         * @brief Render interleaved stereo (same signal on both channels)
+         */
+        void renderStereo(int16_t* out, size_t frames);
+
+        uint8_t activeVoices() const { return m_activeVoices.load(); }
+        uint8_t groupVoices(uint8_t group) const { return group < GROUP_COUNT ? m_groupVoices[group].load() : 0; }
+        uint32_t stolenVoices() const { return m_stolenVoices.load(); }
+        uint32_t rejectedNotes() const { return m_rejectedNotes.load(); }
+        uint32_t droppedCommands() const { return m_droppedCommands.load(); }
+        uint32_t sampleRate() const { return m_sampleRate; }
+
+    private:
+        enum class Stage : uint8_t
+        {
+            IDLE,
+            ATTACK,
+            DECAY,
+            SUSTAIN,
+            RELEASE
+        };
+
+        enum class CommandType : uint8_t
+        {
+            NOTE_ON,
+            NOTE_OFF,
+            ALL_OFF
+        };
+
+        struct Command
+        {
+            CommandType type;
+            uint8_t tag;
+            uint8_t level;
+            uint8_t group;
+            uint16_t frequency;
+        };
+
+        struct Voice
+        {
+            uint32_t phase;
+            uint32_t increment;
+            int32_t envelope;      // Q15 gain << 14
+            int32_t peak;          // Same scale as envelope
+            int32_t step;          // Envelope change per control block
+            int32_t output;        // Q15 amplitude applied at the end of the last block
+            Stage stage;
+            uint8_t tag;
+            uint8_t group;
+            uint32_t age;          // Start order, for stealing
+        };
+
+        static int16_t s_tables[WAVEFORM_COUNT][TABLE_SIZE + 1];  // +1 guard for interpolation
+        static bool s_tablesReady;
+        static void buildTables();
+
+        uint32_t m_sampleRate;
+        Voice m_voices[MAX_VOICES];
+        uint32_t m_ageCounter;
+        int32_t m_mix[CONTROL_BLOCK];
+
+        // Envelope segment lengths in control blocks
+        uint32_t m_attackBlocks;
+        uint32_t m_decayBlocks;
+        uint32_t m_releaseBlocks;
+        int32_t m_sustainLevel;  // 0-256
+
+        Command m_commands[COMMAND_CAPACITY];
+        std::atomic<uint8_t> m_commandHead;
+        std::atomic<uint8_t> m_commandTail;
+        std::atomic<uint32_t> m_droppedCommands;
+        std::atomic<uint8_t> m_activeVoices;
+        std::atomic<uint8_t> m_waveform;
+        std::atomic<uint8_t> m_masterGain;
+        std::atomic<uint8_t> m_groupGains[GROUP_COUNT];
+        std::atomic<uint8_t> m_groupVoices[GROUP_COUNT];
+        std::atomic<uint32_t> m_stolenVoices;
+        std::atomic<uint32_t> m_rejectedNotes;
+
+        bool pushCommand(const Command& command);
+        void drainCommands();
+        void startVoice(uint8_t tag, uint16_t frequency, uint8_t level, uint8_t group);
+        void releaseVoices(uint8_t tag);
+        int32_t stepEnvelope(Voice& voice);
+        void renderBlock(int16_t* out, size_t frames, size_t channels);
+        uint32_t msToBlocks(uint16_t ms) const;
+    };
+}
+
+#endif // WAVETABLE_SYNTH_H
@@ -0,0 +1,118 @@
+/**
+ * @brief BoundedQueue is a fixed-capacity lock-free multi-producer/multi-consumer queue
+ *
+ * Each cell carries a sequence number that tells producers and consumers
+ * whose turn it is, so pushes and pops from any task or ISR-free context
+ * never block and never allocate. A full queue refuses the push instead
+ * of waiting.
+ */
+
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <stdint.h>
+#include <atomic>
+
+namespace PrefrontalCortex
+{
+    template <typename T, uint32_t CAPACITY>
+    class BoundedQueue
+    {
+        static_assert(CAPACITY >= 2 && (CAPACITY & (CAPACITY - 1)) == 0, "Capacity must be a power of two");
+
+    public:
+        BoundedQueue()
+            : m_enqueue(0)
+            , m_dequeue(0)
+        {
+            for (uint32_t i = 0; i < CAPACITY; i++)
+            {
+                m_cells[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * @return false if the queue is full
+         */
+        bool push(const T& value)
+        {
+            uint32_t position = m_enqueue.load(std::memory_order_relaxed);
+            while (true)
+            {
+                Cell& cell = m_cells[position & (CAPACITY - 1)];
+                int32_t turn = static_cast<int32_t>(cell.sequence.load(std::memory_order_acquire) - position);
+                if (turn == 0)
+                {
+                    if (m_enqueue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        cell.value = value;
+                        cell.sequence.store(position + 1, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (turn < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    position = m_enqueue.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /**
+         * @return false if the queue is empty
+         */
+        bool pop(T& value)
+        {
+            uint32_t position = m_dequeue.load(std::memory_order_relaxed);
+            while (true)
+            {
+                Cell& cell = m_cells[position & (CAPACITY - 1)];
+                int32_t turn = static_cast<int32_t>(cell.sequence.load(std::memory_order_acquire) - (position + 1));
+                if (turn == 0)
+                {
+                    if (m_dequeue.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        value = cell.value;
+                        cell.sequence.store(position + CAPACITY, std::memory_order_release);
+                        return true;
+                    }
+                }
+                else if (turn < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    position = m_dequeue.load(std::memory_order_relaxed);
+                }
+            }
+        }
+
+        /**
+         * @brief Approximate while other tasks are pushing or popping
+         */
+        uint32_t size() const
+        {
+            return m_enqueue.load(std::memory_order_relaxed) - m_dequeue.load(std::memory_order_relaxed);
+        }
+
+        bool empty() const { return size() == 0; }
+        static constexpr uint32_t capacity() { return CAPACITY; }
+
+    private:
+        struct Cell
+        {
+            std::atomic<uint32_t> sequence;
+            T value;
+        };
+
+        Cell m_cells[CAPACITY];
+        std::atomic<uint32_t> m_enqueue;
+        std::atomic<uint32_t> m_dequeue;
+    };
+}
+
+#endif // BOUNDED_QUEUE_H
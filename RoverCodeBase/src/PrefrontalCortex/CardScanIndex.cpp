@@ -0,0 +1,623 @@
+/**
+ * @file CardScanIndex.cpp
+ * @brief Bucketed hash table on storage with a RAM Bloom filter and write-ahead log
+ */
+
+#include "CardScanIndex.h"
+#include <string.h>
+
+namespace PrefrontalCortex
+{
+    namespace
+    {
+        constexpr uint32_t INDEX_MAGIC = 0x49435352;    // "RSCI"
+        constexpr uint16_t INDEX_VERSION = 1;
+        constexpr uint32_t WAL_SALT = 0x314C4157;       // "WAL1"
+        constexpr uint32_t NO_BUCKET = 0xFFFFFFFF;
+        constexpr uint8_t REPLAY_CHUNK = 32;            // Log records read at a time
+
+        /**
+         * @brief Growth target next to the table; open() guarantees it fits
+         */
+        void tempPath(char* out, const char* path)
+        {
+            size_t length = strlen(path);
+            memcpy(out, path, length);
+            memcpy(out + length, ".tmp", 5);
+        }
+    }
+
+    static_assert(sizeof(uint16_t) * 2 + sizeof(uint32_t) * CardScanIndex::SLOTS_PER_BUCKET == CardScanIndex::SECTOR_SIZE,
+                  "A bucket must fill exactly one sector");
+
+    CardScanIndex::CardScanIndex(const StorageBackend& storage, Allocate allocate, Release release)
+        : m_storage(storage)
+        , m_allocate(allocate)
+        , m_release(release)
+        , m_index(nullptr)
+        , m_wal(nullptr)
+        , m_buckets(0)
+        , m_merged(0)
+        , m_walLength(0)
+        , m_bloom(nullptr)
+        , m_bloomMask(0)
+        , m_pendingCount(0)
+        , m_lookups(0)
+        , m_bloomRejects(0)
+        , m_sectorReads(0)
+        , m_records(0)
+        , m_checkpoints(0)
+        , m_growths(0)
+        , m_writeFailures(0)
+    {
+        m_indexPath[0] = '\0';
+        m_walPath[0] = '\0';
+        memset(&m_bucket, 0, sizeof(m_bucket));
+    }
+
+    CardScanIndex::~CardScanIndex()
+    {
+        close();
+    }
+
+    bool CardScanIndex::open(const char* indexPath, const char* walPath, size_t bloomBytes)
+    {
+        if (isOpen()) return true;
+        if (strlen(indexPath) + 5 > PATH_LENGTH || strlen(walPath) >= PATH_LENGTH) return false;
+
+        strcpy(m_indexPath, indexPath);
+        strcpy(m_walPath, walPath);
+
+        // A finished growth may have been cut off between removing the old
+        // table and renaming the new one into place
+        char temp[PATH_LENGTH];
+        tempPath(temp, m_indexPath);
+        if (m_storage.exists(m_storage.context, temp))
+        {
+            if (!m_storage.exists(m_storage.context, m_indexPath))
+            {
+                m_storage.rename(m_storage.context, temp, m_indexPath);
+            }
+            else
+            {
+                m_storage.remove(m_storage.context, temp);
+            }
+        }
+
+        m_index = m_storage.open(m_storage.context, m_indexPath, true);
+        if (m_index == nullptr) return false;
+
+        bool ready = m_storage.size(m_storage.context, m_index) == 0
+            ? createTable(m_index, MIN_BUCKETS)
+            : readHeader();
+        if (!ready)
+        {
+            m_storage.close(m_storage.context, m_index);
+            m_index = nullptr;
+            return false;
+        }
+
+        size_t bytes = 1;
+        while (bytes * 2 <= bloomBytes) bytes *= 2;
+        if (bloomBytes > 0 && m_allocate)
+        {
+            m_bloom = static_cast<uint8_t*>(m_allocate(bytes));
+        }
+        if (m_bloom)
+        {
+            memset(m_bloom, 0, bytes);
+            m_bloomMask = static_cast<uint32_t>(bytes * 8 - 1);
+            fillBloom();
+        }
+
+        m_wal = m_storage.open(m_storage.context, m_walPath, true);
+        if (m_wal == nullptr)
+        {
+            close();
+            return false;
+        }
+        if (!replayWal())
+        {
+            close();
+            return false;
+        }
+        return true;
+    }
+
+    void CardScanIndex::close()
+    {
+        if (m_index && m_wal)
+        {
+            checkpoint();
+        }
+        if (m_wal)
+        {
+            m_storage.close(m_storage.context, m_wal);
+            m_wal = nullptr;
+        }
+        if (m_index)
+        {
+            m_storage.close(m_storage.context, m_index);
+            m_index = nullptr;
+        }
+        if (m_bloom)
+        {
+            m_release(m_bloom);
+            m_bloom = nullptr;
+            m_bloomMask = 0;
+        }
+        m_pendingCount = 0;
+    }
+
+    bool CardScanIndex::contains(uint32_t id)
+    {
+        if (!isOpen()) return false;
+
+        m_lookups++;
+        if (m_bloom && !bloomMayContain(id))
+        {
+            m_bloomRejects++;
+            return false;
+        }
+        return pendingContains(id) || tableContains(id);
+    }
+
+    bool CardScanIndex::record(uint32_t id)
+    {
+        if (!isOpen() || contains(id)) return false;
+
+        // Logged first so the ID survives a reset before the next merge
+        WalRecord entry = { id, walCheck(id) };
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&entry);
+        if (m_storage.write(m_storage.context, m_wal, m_walLength, bytes, sizeof(entry)) == sizeof(entry) &&
+            m_storage.sync(m_storage.context, m_wal))
+        {
+            m_walLength += sizeof(entry);
+        }
+        else
+        {
+            m_writeFailures++;
+        }
+
+        m_pending[m_pendingCount++] = id;
+        if (m_bloom) bloomAdd(id);
+        m_records++;
+
+        if (m_pendingCount >= WAL_BATCH)
+        {
+            checkpoint();
+        }
+        return true;
+    }
+
+    bool CardScanIndex::checkpoint()
+    {
+        if (!isOpen()) return false;
+        if (m_pendingCount == 0 && m_walLength == 0) return true;
+
+        if (!mergePending()) return false;
+        m_checkpoints++;
+        return resetWal();
+    }
+
+    CardScanStats CardScanIndex::stats() const
+    {
+        CardScanStats result;
+        result.entries = m_merged + m_pendingCount;
+        result.buckets = m_buckets;
+        result.pending = m_pendingCount;
+        result.lookups = m_lookups;
+        result.bloomRejects = m_bloomRejects;
+        result.sectorReads = m_sectorReads;
+        result.records = m_records;
+        result.checkpoints = m_checkpoints;
+        result.growths = m_growths;
+        result.writeFailures = m_writeFailures;
+        return result;
+    }
+
+    bool CardScanIndex::createTable(StorageBackend::Handle file, uint32_t buckets)
+    {
+        memset(&m_bucket, 0, sizeof(m_bucket));
+        for (uint32_t b = 0; b < buckets; b++)
+        {
+            if (!writeBucket(file, b, m_bucket)) return false;
+        }
+        if (!writeHeader(file, buckets, 0)) return false;
+
+        m_buckets = buckets;
+        m_merged = 0;
+        return m_storage.sync(m_storage.context, file);
+    }
+
+    bool CardScanIndex::readHeader()
+    {
+        Header header;
+        uint8_t* bytes = reinterpret_cast<uint8_t*>(&header);
+        if (m_storage.read(m_storage.context, m_index, 0, bytes, sizeof(header)) != sizeof(header)) return false;
+
+        if (header.magic != INDEX_MAGIC || header.version != INDEX_VERSION ||
+            header.slotsPerBucket != SLOTS_PER_BUCKET || header.checksum != checksum(header))
+        {
+            return false;
+        }
+
+        // Bucket selection masks the hash, so the count must stay a power of two
+        if (header.buckets < MIN_BUCKETS || (header.buckets & (header.buckets - 1)) != 0) return false;
+
+        m_buckets = header.buckets;
+        m_merged = header.entries;
+        return true;
+    }
+
+    bool CardScanIndex::writeHeader(StorageBackend::Handle file, uint32_t buckets, uint32_t entries)
+    {
+        uint8_t sector[SECTOR_SIZE];
+        memset(sector, 0, sizeof(sector));
+
+        Header header;
+        header.magic = INDEX_MAGIC;
+        header.version = INDEX_VERSION;
+        header.slotsPerBucket = SLOTS_PER_BUCKET;
+        header.buckets = buckets;
+        header.entries = entries;
+        header.checksum = checksum(header);
+        memcpy(sector, &header, sizeof(header));
+
+        return m_storage.write(m_storage.context, file, 0, sector, sizeof(sector)) == sizeof(sector);
+    }
+
+    bool CardScanIndex::readBucket(StorageBackend::Handle file, uint32_t bucket, Bucket& out)
+    {
+        uint32_t offset = (bucket + 1) * SECTOR_SIZE;
+        uint8_t* bytes = reinterpret_cast<uint8_t*>(&out);
+        if (m_storage.read(m_storage.context, file, offset, bytes, SECTOR_SIZE) != SECTOR_SIZE) return false;
+
+        if (out.count > SLOTS_PER_BUCKET) out.count = SLOTS_PER_BUCKET;
+        return true;
+    }
+
+    bool CardScanIndex::writeBucket(StorageBackend::Handle file, uint32_t bucket, const Bucket& data)
+    {
+        uint32_t offset = (bucket + 1) * SECTOR_SIZE;
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&data);
+        return m_storage.write(m_storage.context, file, offset, bytes, SECTOR_SIZE) == SECTOR_SIZE;
+    }
+
+    bool CardScanIndex::tableContains(uint32_t id)
+    {
+        // Buckets fill in probe order, so a bucket with room ends the chain
+        uint32_t bucket = homeBucket(id, m_buckets);
+        for (uint32_t probe = 0; probe < m_buckets; probe++)
+        {
+            m_sectorReads++;
+            if (!readBucket(m_index, bucket, m_bucket)) return false;
+
+            for (uint16_t i = 0; i < m_bucket.count; i++)
+            {
+                if (m_bucket.ids[i] == id) return true;
+            }
+            if (m_bucket.count < SLOTS_PER_BUCKET) return false;
+            bucket = (bucket + 1) & (m_buckets - 1);
+        }
+        return false;
+    }
+
+    bool CardScanIndex::pendingContains(uint32_t id) const
+    {
+        for (uint8_t i = 0; i < m_pendingCount; i++)
+        {
+            if (m_pending[i] == id) return true;
+        }
+        return false;
+    }
+
+    int CardScanIndex::insert(StorageBackend::Handle file, uint32_t buckets, uint32_t id)
+    {
+        uint32_t bucket = homeBucket(id, buckets);
+        for (uint32_t probe = 0; probe < buckets; probe++)
+        {
+            if (!readBucket(file, bucket, m_bucket)) return -1;
+
+            for (uint16_t i = 0; i < m_bucket.count; i++)
+            {
+                if (m_bucket.ids[i] == id) return 0;
+            }
+            if (m_bucket.count < SLOTS_PER_BUCKET)
+            {
+                m_bucket.ids[m_bucket.count++] = id;
+                return writeBucket(file, bucket, m_bucket) ? 1 : -1;
+            }
+            bucket = (bucket + 1) & (buckets - 1);
+        }
+        return -1;
+    }
+
+    bool CardScanIndex::mergePending()
+    {
+        uint64_t capacity = static_cast<uint64_t>(m_buckets) * SLOTS_PER_BUCKET;
+        if ((static_cast<uint64_t>(m_merged) + m_pendingCount) * 4 > capacity * 3)
+        {
+            // Keep going on the current table if it cannot grow; it still has room
+            grow();
+        }
+
+        // Home-bucket order so IDs sharing a bucket cost one read and one write
+        for (uint8_t i = 1; i < m_pendingCount; i++)
+        {
+            uint32_t id = m_pending[i];
+            uint32_t home = homeBucket(id, m_buckets);
+            int j = i - 1;
+            while (j >= 0 && homeBucket(m_pending[j], m_buckets) > home)
+            {
+                m_pending[j + 1] = m_pending[j];
+                j--;
+            }
+            m_pending[j + 1] = id;
+        }
+
+        uint32_t loaded = NO_BUCKET;
+        bool dirty = false;
+        bool ok = true;
+        uint32_t added = 0;
+
+        for (uint8_t i = 0; i < m_pendingCount && ok; i++)
+        {
+            uint32_t id = m_pending[i];
+            uint32_t bucket = homeBucket(id, m_buckets);
+            bool placed = false;
+
+            for (uint32_t probe = 0; probe < m_buckets && !placed && ok; probe++)
+            {
+                if (bucket != loaded)
+                {
+                    if (dirty && !writeBucket(m_index, loaded, m_bucket))
+                    {
+                        ok = false;
+                        break;
+                    }
+                    dirty = false;
+                    if (!readBucket(m_index, bucket, m_bucket))
+                    {
+                        ok = false;
+                        break;
+                    }
+                    loaded = bucket;
+                }
+
+                for (uint16_t s = 0; s < m_bucket.count && !placed; s++)
+                {
+                    placed = m_bucket.ids[s] == id;   // Already merged by an interrupted checkpoint
+                }
+                if (!placed && m_bucket.count < SLOTS_PER_BUCKET)
+                {
+                    m_bucket.ids[m_bucket.count++] = id;
+                    dirty = true;
+                    added++;
+                    placed = true;
+                }
+                bucket = (bucket + 1) & (m_buckets - 1);
+            }
+            if (!placed) ok = false;     // Table full
+        }
+
+        if (ok && dirty) ok = writeBucket(m_index, loaded, m_bucket);
+        if (ok) ok = writeHeader(m_index, m_buckets, m_merged + added);
+        if (ok) ok = m_storage.sync(m_storage.context, m_index);
+
+        if (!ok)
+        {
+            // Whatever reached the table is found again when the log is replayed
+            m_writeFailures++;
+            return false;
+        }
+
+        m_merged += added;
+        m_pendingCount = 0;
+        return true;
+    }
+
+    bool CardScanIndex::grow()
+    {
+        uint32_t oldBuckets = m_buckets;
+        uint32_t newBuckets = oldBuckets * 2;
+        char temp[PATH_LENGTH];
+        tempPath(temp, m_indexPath);
+
+        m_storage.remove(m_storage.context, temp);
+        StorageBackend::Handle file = m_storage.open(m_storage.context, temp, true);
+        if (file == nullptr) return false;
+
+        uint32_t* spill = static_cast<uint32_t*>(m_allocate(SPILL_CAPACITY * sizeof(uint32_t)));
+        Bucket* split = static_cast<Bucket*>(m_allocate(sizeof(Bucket)));
+        uint16_t spillCount = 0;
+        bool ok = spill != nullptr && split != nullptr;
+
+        // Placeholder header, so the buckets below are written strictly in order
+        // and an interrupted growth never looks valid
+        if (ok)
+        {
+            uint8_t blank[SECTOR_SIZE];
+            memset(blank, 0, sizeof(blank));
+            ok = m_storage.write(m_storage.context, file, 0, blank, sizeof(blank)) == sizeof(blank);
+        }
+
+        // Doubling adds one hash bit: old bucket b splits into b and b + old size.
+        // Entries that had overflowed into b from elsewhere are set aside and
+        // placed by probing once every bucket exists.
+        for (uint8_t half = 0; half < 2 && ok; half++)
+        {
+            for (uint32_t b = 0; b < oldBuckets && ok; b++)
+            {
+                if (!readBucket(m_index, b, m_bucket))
+                {
+                    ok = false;
+                    break;
+                }
+
+                uint32_t target = b + half * oldBuckets;
+                memset(split, 0, sizeof(Bucket));
+                for (uint16_t i = 0; i < m_bucket.count; i++)
+                {
+                    uint32_t id = m_bucket.ids[i];
+                    uint32_t home = homeBucket(id, newBuckets);
+                    if (home == target)
+                    {
+                        split->ids[split->count++] = id;
+                    }
+                    else if (half == 0 && home != b + oldBuckets)
+                    {
+                        if (spillCount == SPILL_CAPACITY)
+                        {
+                            ok = false;
+                            break;
+                        }
+                        spill[spillCount++] = id;
+                    }
+                }
+                if (ok) ok = writeBucket(file, target, *split);
+            }
+        }
+
+        for (uint16_t i = 0; i < spillCount && ok; i++)
+        {
+            ok = insert(file, newBuckets, spill[i]) >= 0;
+        }
+        if (ok) ok = writeHeader(file, newBuckets, m_merged);
+        if (ok) ok = m_storage.sync(m_storage.context, file);
+        m_storage.close(m_storage.context, file);
+
+        if (spill) m_release(spill);
+        if (split) m_release(split);
+
+        if (!ok)
+        {
+            m_storage.remove(m_storage.context, temp);
+            return false;
+        }
+
+        // From here a reset leaves a complete temporary table that open() adopts
+        m_storage.close(m_storage.context, m_index);
+        m_storage.remove(m_storage.context, m_indexPath);
+        bool renamed = m_storage.rename(m_storage.context, temp, m_indexPath);
+        m_index = m_storage.open(m_storage.context, renamed ? m_indexPath : temp, false);
+        if (m_index == nullptr)
+        {
+            return false;
+        }
+
+        m_buckets = newBuckets;
+        m_growths++;
+        return true;
+    }
+
+    bool CardScanIndex::replayWal()
+    {
+        uint32_t length = m_storage.size(m_storage.context, m_wal);
+        uint32_t offset = 0;
+        WalRecord records[REPLAY_CHUNK];
+        bool intact = true;
+
+        while (offset + sizeof(WalRecord) <= length && intact)
+        {
+            uint32_t count = (length - offset) / sizeof(WalRecord);
+            if (count > REPLAY_CHUNK) count = REPLAY_CHUNK;
+
+            size_t bytes = count * sizeof(WalRecord);
+            if (m_storage.read(m_storage.context, m_wal, offset, reinterpret_cast<uint8_t*>(records), bytes) != bytes) break;
+            offset += bytes;
+
+            for (uint32_t i = 0; i < count; i++)
+            {
+                // A torn final append ends the log
+                if (records[i].check != walCheck(records[i].id))
+                {
+                    intact = false;
+                    break;
+                }
+
+                uint32_t id = records[i].id;
+                if (pendingContains(id) || tableContains(id)) continue;
+
+                m_pending[m_pendingCount++] = id;
+                if (m_bloom) bloomAdd(id);
+                if (m_pendingCount == WAL_BATCH && !mergePending()) return false;
+            }
+        }
+
+        m_walLength = length;
+        return checkpoint();
+    }
+
+    bool CardScanIndex::resetWal()
+    {
+        m_storage.close(m_storage.context, m_wal);
+        m_storage.remove(m_storage.context, m_walPath);
+        m_wal = m_storage.open(m_storage.context, m_walPath, true);
+        m_walLength = 0;
+        return m_wal != nullptr;
+    }
+
+    void CardScanIndex::fillBloom()
+    {
+        for (uint32_t b = 0; b < m_buckets; b++)
+        {
+            if (!readBucket(m_index, b, m_bucket)) return;
+            for (uint16_t i = 0; i < m_bucket.count; i++)
+            {
+                bloomAdd(m_bucket.ids[i]);
+            }
+        }
+    }
+
+    void CardScanIndex::bloomAdd(uint32_t id)
+    {
+        uint32_t h1 = mix(id);
+        uint32_t h2 = mix(id ^ 0x9E3779B9) | 1;
+        for (uint8_t k = 0; k < BLOOM_HASHES; k++)
+        {
+            uint32_t bit = (h1 + k * h2) & m_bloomMask;
+            m_bloom[bit >> 3] |= static_cast<uint8_t>(1 << (bit & 7));
+        }
+    }
+
+    bool CardScanIndex::bloomMayContain(uint32_t id) const
+    {
+        uint32_t h1 = mix(id);
+        uint32_t h2 = mix(id ^ 0x9E3779B9) | 1;
+        for (uint8_t k = 0; k < BLOOM_HASHES; k++)
+        {
+            uint32_t bit = (h1 + k * h2) & m_bloomMask;
+            if ((m_bloom[bit >> 3] & (1 << (bit & 7))) == 0) return false;
+        }
+        return true;
+    }
+
+    uint32_t CardScanIndex::mix(uint32_t value)
+    {
+        // MurmurHash3 finalizer; card UIDs are far from uniform in their low bits
+        value ^= value >> 16;
+        value *= 0x85EBCA6B;
+        value ^= value >> 13;
+        value *= 0xC2B2AE35;
+        value ^= value >> 16;
+        return value;
+    }
+
+    uint32_t CardScanIndex::checksum(const Header& header)
+    {
+        const uint8_t* bytes = reinterpret_cast<const uint8_t*>(&header);
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < offsetof(Header, checksum); i++)
+        {
+            hash ^= bytes[i];
+            hash *= 16777619u;
+        }
+        return hash;
+    }
+
+    uint32_t CardScanIndex::walCheck(uint32_t id)
+    {
+        return mix(id ^ WAL_SALT);
+    }
+}
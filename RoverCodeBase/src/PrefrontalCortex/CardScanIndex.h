@@ -0,0 +1,162 @@
+/**
+ * @brief CardScanIndex remembers every card the rover has seen
+ *
+ * Scan history is a persistent hash set of card IDs:
+ * - The index file is an open-addressing table of 512-byte buckets, so a
+ *   lookup costs one sector read (overflow into the next bucket is rare
+ *   below the 75% load limit)
+ * - A Bloom filter in RAM answers most "never seen" lookups with no I/O
+ * - New IDs are appended to a write-ahead log and merged into the table in
+ *   batches, one read-modify-write per touched bucket
+ * - The table doubles by rewriting into a temporary file that replaces the
+ *   old one only once it is complete
+ *
+ * After a crash the log is replayed on open; replay is idempotent, so a
+ * merge interrupted halfway is simply repeated.
+ */
+
+#ifndef CARD_SCAN_INDEX_H
+#define CARD_SCAN_INDEX_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "StorageBackend.h"
+
+namespace PrefrontalCortex
+{
+    struct CardScanStats
+    {
+        uint32_t entries;           // Merged plus pending
+        uint32_t buckets;
+        uint8_t pending;            // Logged but not merged yet
+        uint32_t lookups;
+        uint32_t bloomRejects;      // Answered without touching the card
+        uint32_t sectorReads;       // Bucket reads made by lookups
+        uint32_t records;
+        uint32_t checkpoints;
+        uint32_t growths;
+        uint32_t writeFailures;
+    };
+
+    class CardScanIndex
+    {
+    public:
+        static constexpr uint16_t SECTOR_SIZE = 512;
+        static constexpr uint8_t SLOTS_PER_BUCKET = 127;
+        static constexpr uint32_t MIN_BUCKETS = 16;
+        static constexpr uint8_t BLOOM_HASHES = 6;
+        static constexpr uint8_t WAL_BATCH = 64;        // Logged IDs per merge
+        static constexpr uint16_t SPILL_CAPACITY = 512; // Displaced IDs a growth can re-place
+        static constexpr uint8_t PATH_LENGTH = 40;
+
+        typedef void* (*Allocate)(size_t bytes);
+        typedef void (*Release)(void* memory);
+
+        CardScanIndex(const StorageBackend& storage, Allocate allocate, Release release);
+        ~CardScanIndex();
+
+        /**
+         * @brief Open or create the index, replay the log and fill the Bloom filter
+         * @param bloomBytes Filter size, rounded down to a power of two; 0 disables it
+         */
+        bool open(const char* indexPath, const char* walPath, size_t bloomBytes);
+
+        /**
+         * @brief Merge what is logged and close both files
+         */
+        void close();
+        bool isOpen() const { return m_index != nullptr; }
+
+        bool contains(uint32_t id);
+
+        /**
+         * @brief Remember an ID
+         * @return true if it had not been seen before
+         */
+        bool record(uint32_t id);
+
+        /**
+         * @brief Merge logged IDs into the table now and empty the log
+         */
+        bool checkpoint();
+
+        CardScanStats stats() const;
+
+    private:
+        struct Header
+        {
+            uint32_t magic;
+            uint16_t version;
+            uint16_t slotsPerBucket;
+            uint32_t buckets;
+            uint32_t entries;
+            uint32_t checksum;
+        };
+
+        struct Bucket
+        {
+            uint16_t count;
+            uint16_t reserved;
+            uint32_t ids[SLOTS_PER_BUCKET];
+        };
+
+        struct WalRecord
+        {
+            uint32_t id;
+            uint32_t check;
+        };
+
+        StorageBackend m_storage;
+        Allocate m_allocate;
+        Release m_release;
+        StorageBackend::Handle m_index;
+        StorageBackend::Handle m_wal;
+        char m_indexPath[PATH_LENGTH];
+        char m_walPath[PATH_LENGTH];
+
+        uint32_t m_buckets;
+        uint32_t m_merged;              // Entries in the table file
+        uint32_t m_walLength;           // Bytes in the log
+
+        uint8_t* m_bloom;
+        uint32_t m_bloomMask;           // Bits - 1
+
+        uint32_t m_pending[WAL_BATCH];  // Logged, not yet in the table
+        uint8_t m_pendingCount;
+
+        Bucket m_bucket;                // Sector buffer
+
+        uint32_t m_lookups;
+        uint32_t m_bloomRejects;
+        uint32_t m_sectorReads;
+        uint32_t m_records;
+        uint32_t m_checkpoints;
+        uint32_t m_growths;
+        uint32_t m_writeFailures;
+
+        bool createTable(StorageBackend::Handle file, uint32_t buckets);
+        bool readHeader();
+        bool writeHeader(StorageBackend::Handle file, uint32_t buckets, uint32_t entries);
+        bool readBucket(StorageBackend::Handle file, uint32_t bucket, Bucket& out);
+        bool writeBucket(StorageBackend::Handle file, uint32_t bucket, const Bucket& data);
+
+        bool tableContains(uint32_t id);
+        bool pendingContains(uint32_t id) const;
+        int insert(StorageBackend::Handle file, uint32_t buckets, uint32_t id);
+        bool mergePending();
+        bool grow();
+        bool replayWal();
+        bool resetWal();
+        void fillBloom();
+
+        void bloomAdd(uint32_t id);
+        bool bloomMayContain(uint32_t id) const;
+
+        static uint32_t mix(uint32_t value);
+        static uint32_t homeBucket(uint32_t id, uint32_t buckets) { return mix(id) & (buckets - 1); }
+        static uint32_t checksum(const Header& header);
+        static uint32_t walCheck(uint32_t id);
+    };
+}
+
+#endif // CARD_SCAN_INDEX_H
@@ -0,0 +1,174 @@
+/**
+ * @file DirectoryWalker.cpp
+ * @brief Bounded-stack directory tree iteration
+ */
+
+#include "DirectoryWalker.h"
+#include <string.h>
+
+namespace PrefrontalCortex
+{
+    DirectoryWalker::DirectoryWalker(const DirectoryBackend& backend)
+        : m_backend(backend)
+        , m_depth(0)
+        , m_maxDepth(MAX_DEPTH)
+        , m_descend(false)
+        , m_details(false)
+        , m_skipped(0)
+    {
+        m_path[0] = '\0';
+    }
+
+    DirectoryWalker::~DirectoryWalker()
+    {
+        close();
+    }
+
+    bool DirectoryWalker::open(const char* root, uint8_t maxDepth, bool details)
+    {
+        close();
+        size_t length = strlen(root);
+        if (length == 0 || length >= PATH_LENGTH || maxDepth == 0)
+        {
+            return false;
+        }
+
+        // "/music/" and "/music" walk the same tree
+        while (length > 1 && root[length - 1] == '/') length--;
+        memcpy(m_path, root, length);
+        m_path[length] = '\0';
+
+        m_maxDepth = maxDepth > MAX_DEPTH ? MAX_DEPTH : maxDepth;
+        m_details = details;
+        m_skipped = 0;
+        return push(static_cast<uint16_t>(length));
+    }
+
+    void DirectoryWalker::close()
+    {
+        while (m_depth > 0)
+        {
+            m_depth--;
+            m_backend.close(m_backend.context, m_levels[m_depth].handle);
+        }
+        m_descend = false;
+    }
+
+    bool DirectoryWalker::next(WalkEntry& entry)
+    {
+        if (m_descend)
+        {
+            m_descend = false;
+            if (!push(static_cast<uint16_t>(strlen(m_path))))
+            {
+                m_skipped++;
+            }
+        }
+
+        while (m_depth > 0)
+        {
+            Level& level = m_levels[m_depth - 1];
+            DirectoryEntry found;
+            if (!m_backend.next(m_backend.context, level.handle, &found, m_details))
+            {
+                m_backend.close(m_backend.context, level.handle);
+                m_depth--;
+                continue;
+            }
+
+            // Join in place; the root "/" needs no separator of its own
+            uint16_t base = level.pathLength;
+            bool separator = !(base == 1 && m_path[0] == '/');
+            size_t nameLength = strnlen(found.name, sizeof(found.name));
+            if (nameLength == 0 || base + separator + nameLength >= PATH_LENGTH)
+            {
+                m_skipped++;
+                continue;
+            }
+            if (separator) m_path[base] = '/';
+            memcpy(m_path + base + separator, found.name, nameLength);
+            m_path[base + separator + nameLength] = '\0';
+
+            entry.path = m_path;
+            entry.name = m_path + base + separator;
+            entry.size = found.size;
+            entry.modified = found.modified;
+            entry.isDirectory = found.isDirectory;
+            entry.depth = m_depth - 1;
+            m_descend = found.isDirectory && m_depth < m_maxDepth;
+            return true;
+        }
+        return false;
+    }
+
+    bool DirectoryWalker::save(Cursor& cursor)
+    {
+        if (!m_backend.tell || m_depth == 0)
+        {
+            return false;
+        }
+
+        memcpy(cursor.path, m_path, sizeof(cursor.path));
+        for (uint8_t i = 0; i < m_depth; i++)
+        {
+            cursor.lengths[i] = m_levels[i].pathLength;
+            cursor.positions[i] = m_backend.tell(m_backend.context, m_levels[i].handle);
+        }
+        cursor.depth = m_depth;
+        cursor.maxDepth = m_maxDepth;
+        cursor.descend = m_descend;
+        cursor.details = m_details;
+        close();
+        return true;
+    }
+
+    bool DirectoryWalker::resume(const Cursor& cursor)
+    {
+        close();
+        if (!m_backend.seek || cursor.depth == 0 || cursor.depth > MAX_DEPTH)
+        {
+            return false;
+        }
+
+        memcpy(m_path, cursor.path, sizeof(m_path));
+        m_path[PATH_LENGTH - 1] = '\0';
+        m_maxDepth = cursor.maxDepth;
+        m_details = cursor.details;
+
+        for (uint8_t i = 0; i < cursor.depth; i++)
+        {
+            // Each level's path is a prefix of the saved one
+            uint16_t length = cursor.lengths[i];
+            if (length >= PATH_LENGTH || !push(length))
+            {
+                close();
+                return false;
+            }
+            m_backend.seek(m_backend.context, m_levels[i].handle, cursor.positions[i]);
+        }
+        m_descend = cursor.descend;
+        return true;
+    }
+
+    bool DirectoryWalker::push(uint16_t pathLength)
+    {
+        if (m_depth >= MAX_DEPTH)
+        {
+            return false;
+        }
+
+        char saved = m_path[pathLength];
+        m_path[pathLength] = '\0';
+        DirectoryBackend::Handle handle = m_backend.open(m_backend.context, m_path);
+        m_path[pathLength] = saved;
+        if (!handle)
+        {
+            return false;
+        }
+
+        m_levels[m_depth].handle = handle;
+        m_levels[m_depth].pathLength = pathLength;
+        m_depth++;
+        return true;
+    }
+}
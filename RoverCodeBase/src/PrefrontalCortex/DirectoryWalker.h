@@ -0,0 +1,125 @@
+/**
+ * @brief DirectoryWalker lists a directory tree one entry at a time
+ *
+ * Replaces recursion with a fixed stack of open directories:
+ * - Depth-first, each directory reported before its contents; skipChildren()
+ *   right after a directory leaves it unopened
+ * - The full path is built in one buffer owned by the walker, so entries
+ *   cost no heap allocation; only opening a directory may allocate
+ * - save() captures the walk as directory offsets, so it can be closed and
+ *   resumed later (with the card still mounted and unchanged)
+ * - Paths longer than PATH_LENGTH are skipped and counted, never truncated
+ */
+
+#ifndef DIRECTORY_WALKER_H
+#define DIRECTORY_WALKER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace PrefrontalCortex
+{
+    struct DirectoryEntry
+    {
+        static constexpr uint8_t NAME_LENGTH = 64;
+
+        char name[NAME_LENGTH];
+        uint32_t size;
+        uint32_t modified;          // Seconds since the epoch; 0 if unknown
+        bool isDirectory;
+    };
+
+    struct DirectoryBackend
+    {
+        typedef void* Handle;
+
+        Handle (*open)(void* context, const char* path);
+
+        /**
+         * @brief Next entry, skipping "." and ".."; a name too long for the entry comes back empty
+         * @param details Fill size and modified, which may cost a lookup per entry
+         * @return false at the end of the directory
+         */
+        bool (*next)(void* context, Handle directory, DirectoryEntry* entry, bool details);
+        uint32_t (*tell)(void* context, Handle directory);
+        void (*seek)(void* context, Handle directory, uint32_t position);
+        void (*close)(void* context, Handle directory);
+        void* context;
+    };
+
+    struct WalkEntry
+    {
+        const char* path;           // Valid until the next call to next()
+        const char* name;
+        uint32_t size;
+        uint32_t modified;
+        bool isDirectory;
+        uint8_t depth;              // 0 for entries directly under the root
+    };
+
+    class DirectoryWalker
+    {
+    public:
+        static constexpr uint8_t MAX_DEPTH = 8;
+        static constexpr uint16_t PATH_LENGTH = 128;
+
+        /**
+         * @brief A paused walk; holds no open directories
+         */
+        struct Cursor
+        {
+            char path[PATH_LENGTH];
+            uint16_t lengths[MAX_DEPTH];        // Path length of each open level
+            uint32_t positions[MAX_DEPTH];
+            uint8_t depth;
+            uint8_t maxDepth;
+            bool descend;
+            bool details;
+        };
+
+        explicit DirectoryWalker(const DirectoryBackend& backend);
+        ~DirectoryWalker();
+
+        /**
+         * @param maxDepth Levels to list; 1 lists only the root's own entries
+         */
+        bool open(const char* root, uint8_t maxDepth = MAX_DEPTH, bool details = false);
+        void close();
+        bool isOpen() const { return m_depth > 0 || m_descend; }
+
+        bool next(WalkEntry& entry);
+
+        /**
+         * @brief Do not descend into the directory next() just returned
+         */
+        void skipChildren() { m_descend = false; }
+
+        /**
+         * @brief Close the walk, keeping where it got to; needs tell and seek
+         */
+        bool save(Cursor& cursor);
+        bool resume(const Cursor& cursor);
+
+        uint32_t skipped() const { return m_skipped; }
+
+    private:
+        struct Level
+        {
+            DirectoryBackend::Handle handle;
+            uint16_t pathLength;
+        };
+
+        DirectoryBackend m_backend;
+        char m_path[PATH_LENGTH];
+        Level m_levels[MAX_DEPTH];
+        uint8_t m_depth;                // Open levels
+        uint8_t m_maxDepth;
+        bool m_descend;                 // Last entry was a directory to open on the next call
+        bool m_details;
+        uint32_t m_skipped;
+
+        bool push(uint16_t pathLength);
+    };
+}
+
+#endif // DIRECTORY_WALKER_H
@@ -0,0 +1,576 @@
+/**
+ * @file FileIndex.cpp
+ * @brief Persisted path-hash index maintained from I/O notes
+ */
+
+#include "FileIndex.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+namespace PrefrontalCortex
+{
+    namespace
+    {
+        constexpr uint64_t FNV64_OFFSET = 0xCBF29CE484222325ull;
+        constexpr uint64_t FNV64_PRIME = 0x100000001B3ull;
+
+        size_t trimmedLength(const char* path)
+        {
+            // "/music/" names the same directory as "/music"
+            size_t length = strlen(path);
+            while (length > 1 && path[length - 1] == '/') length--;
+            return length;
+        }
+
+        bool hasExtension(const char* extension, const char* wanted)
+        {
+            for (; *wanted; extension++, wanted++)
+            {
+                char c = *extension;
+                if (c >= 'A' && c <= 'Z') c = static_cast<char>(c - 'A' + 'a');
+                if (c != *wanted) return false;
+            }
+            return *extension == '\0';
+        }
+    }
+
+    FileIndex::FileIndex(const StorageBackend& storage, const DirectoryBackend& directories, Allocate allocate, Release release)
+        : m_storage(storage)
+        , m_walker(directories)
+        , m_allocate(allocate)
+        , m_release(release)
+        , m_pathHash(0)
+        , m_tempHash(0)
+        , m_entries(nullptr)
+        , m_capacity(0)
+        , m_count(0)
+        , m_open(false)
+        , m_sorted(true)
+        , m_rebuilding(false)
+        , m_full(false)
+        , m_dirty(false)
+        , m_savedChanged(false)
+        , m_dirtySinceMs(0)
+        , m_maxDelayMs(DEFAULT_MAX_DELAY_MS)
+        , m_overflow(false)
+    {
+        m_path[0] = '\0';
+        m_tempPath[0] = '\0';
+        m_root[0] = '\0';
+        memset(&m_header, 0, sizeof(m_header));
+        memset(&m_stats, 0, sizeof(m_stats));
+    }
+
+    FileIndex::~FileIndex()
+    {
+        m_walker.close();
+        if (m_entries) m_release(m_entries);
+    }
+
+    bool FileIndex::open(const char* indexPath, const char* root, uint32_t capacity, uint32_t usedKB)
+    {
+        close();
+        int written = snprintf(m_tempPath, sizeof(m_tempPath), "%s.tmp", indexPath);
+        if (written <= 0 || written >= PATH_LENGTH || strlen(root) >= PATH_LENGTH || capacity == 0)
+        {
+            return false;
+        }
+        strcpy(m_path, indexPath);
+        strcpy(m_root, root);
+        m_pathHash = hashPath(m_path, strlen(m_path));
+        m_tempHash = hashPath(m_tempPath, strlen(m_tempPath));
+
+        m_entries = static_cast<FileIndexEntry*>(m_allocate(static_cast<size_t>(capacity) * sizeof(FileIndexEntry)));
+        if (!m_entries)
+        {
+            return false;
+        }
+        m_capacity = capacity;
+
+        // Notes queued before now describe a card this index has not seen yet
+        Change stale;
+        while (m_changes.pop(stale)) {}
+        m_overflow.store(false, std::memory_order_relaxed);
+
+        m_open = true;
+        if (!load(usedKB))
+        {
+            rebuild();
+        }
+        return true;
+    }
+
+    void FileIndex::close()
+    {
+        if (!m_open) return;
+
+        if (m_dirty) flush();
+        m_walker.close();
+        m_release(m_entries);
+        m_entries = nullptr;
+        m_capacity = 0;
+        m_count = 0;
+        m_open = false;
+        m_rebuilding = false;
+        m_full = false;
+        m_dirty = false;
+        memset(&m_header, 0, sizeof(m_header));
+    }
+
+    void FileIndex::noteWritten(const char* path, uint32_t size, uint32_t modified, bool isDirectory)
+    {
+        size_t length = trimmedLength(path);
+        Change change;
+        change.pathHash = hashPath(path, length);
+        if (change.pathHash == m_pathHash || change.pathHash == m_tempHash) return;
+
+        change.parentHash = parentOf(path, length);
+        change.size = isDirectory ? 0 : size;
+        change.modified = modified;
+        change.kind = kindOf(path, isDirectory);
+        change.removed = false;
+        enqueue(change);
+    }
+
+    void FileIndex::noteRemoved(const char* path)
+    {
+        Change change;
+        memset(&change, 0, sizeof(change));
+        change.pathHash = hashPath(path, trimmedLength(path));
+        if (change.pathHash == m_pathHash || change.pathHash == m_tempHash) return;
+
+        change.removed = true;
+        enqueue(change);
+    }
+
+    void FileIndex::enqueue(const Change& change)
+    {
+        if (!m_changes.push(change))
+        {
+            m_overflow.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    void FileIndex::update(uint32_t nowMs, uint32_t budget)
+    {
+        if (!m_open) return;
+
+        if (m_overflow.exchange(false, std::memory_order_relaxed))
+        {
+            m_stats.changesDropped++;
+            rebuild();
+        }
+
+        bool wasDirty = m_dirty;
+        Change change;
+        while (m_changes.pop(change))
+        {
+            apply(change);
+        }
+
+        if (m_rebuilding)
+        {
+            // A walk that could not start is retried here
+            if (!m_walker.isOpen() && !m_walker.open(m_root, DirectoryWalker::MAX_DEPTH, true))
+            {
+                return;
+            }
+
+            WalkEntry entry;
+            uint32_t walked = 0;
+            while (walked < budget && m_walker.next(entry))
+            {
+                walked++;
+                uint64_t hash = hashPath(entry.path, strlen(entry.path));
+                if (hash == m_pathHash || hash == m_tempHash) continue;
+
+                FileIndexEntry added;
+                memset(&added, 0, sizeof(added));
+                added.pathHash = hash;
+                added.parentHash = parentOf(entry.path, strlen(entry.path));
+                added.size = entry.isDirectory ? 0 : entry.size;
+                added.modified = entry.modified;
+                added.kind = kindOf(entry.path, entry.isDirectory);
+                insert(added);
+            }
+            if (walked < budget)
+            {
+                finishRebuild();
+            }
+        }
+
+        // Whatever is saved no longer matches; say so before a reset can trust it
+        if ((m_dirty || m_rebuilding) && !m_savedChanged)
+        {
+            markChanged();
+        }
+
+        if (m_dirty && !wasDirty)
+        {
+            m_dirtySinceMs = nowMs;
+        }
+        if (m_dirty && !m_rebuilding && nowMs - m_dirtySinceMs >= m_maxDelayMs)
+        {
+            flush();
+        }
+    }
+
+    void FileIndex::apply(const Change& change)
+    {
+        m_stats.changesApplied++;
+        if (change.removed)
+        {
+            erase(change.pathHash);
+            return;
+        }
+
+        FileIndexEntry entry;
+        memset(&entry, 0, sizeof(entry));
+        entry.pathHash = change.pathHash;
+        entry.parentHash = change.parentHash;
+        entry.size = change.size;
+        entry.modified = change.modified;
+        entry.kind = change.kind;
+
+        if (!m_sorted)
+        {
+            // Mid-rebuild: a note replaces whatever the walk already found
+            for (uint32_t i = 0; i < m_count; i++)
+            {
+                if (m_entries[i].pathHash == entry.pathHash)
+                {
+                    m_entries[i] = entry;
+                    m_dirty = true;
+                    return;
+                }
+            }
+        }
+        insert(entry);
+    }
+
+    bool FileIndex::locate(uint64_t hash, uint32_t& index) const
+    {
+        uint32_t low = 0;
+        uint32_t high = m_count;
+        while (low < high)
+        {
+            uint32_t middle = low + (high - low) / 2;
+            if (m_entries[middle].pathHash < hash) low = middle + 1;
+            else high = middle;
+        }
+        index = low;
+        return low < m_count && m_entries[low].pathHash == hash;
+    }
+
+    void FileIndex::insert(const FileIndexEntry& entry)
+    {
+        if (!m_sorted)
+        {
+            if (m_count >= m_capacity)
+            {
+                m_full = true;
+                return;
+            }
+            m_entries[m_count++] = entry;
+            m_dirty = true;
+            return;
+        }
+
+        uint32_t index;
+        if (locate(entry.pathHash, index))
+        {
+            m_entries[index] = entry;
+        }
+        else
+        {
+            if (m_count >= m_capacity)
+            {
+                m_full = true;
+                return;
+            }
+            memmove(&m_entries[index + 1], &m_entries[index], (m_count - index) * sizeof(FileIndexEntry));
+            m_entries[index] = entry;
+            m_count++;
+        }
+        m_dirty = true;
+    }
+
+    void FileIndex::erase(uint64_t hash)
+    {
+        if (!m_sorted)
+        {
+            for (uint32_t i = 0; i < m_count; )
+            {
+                if (m_entries[i].pathHash == hash)
+                {
+                    m_entries[i] = m_entries[--m_count];
+                    m_dirty = true;
+                }
+                else
+                {
+                    i++;
+                }
+            }
+            return;
+        }
+
+        uint32_t index;
+        if (locate(hash, index))
+        {
+            memmove(&m_entries[index], &m_entries[index + 1], (m_count - index - 1) * sizeof(FileIndexEntry));
+            m_count--;
+            m_dirty = true;
+        }
+    }
+
+    void FileIndex::rebuild()
+    {
+        if (!m_open) return;
+
+        m_count = 0;
+        m_sorted = false;
+        m_full = false;
+        m_rebuilding = true;
+        m_dirty = true;
+        m_stats.rebuilds++;
+        m_walker.open(m_root, DirectoryWalker::MAX_DEPTH, true);
+    }
+
+    void FileIndex::finishRebuild()
+    {
+        m_walker.close();
+        qsort(m_entries, m_count, sizeof(FileIndexEntry), compare);
+
+        // A note and the walk can both report a file in a directory walked after the note
+        uint32_t kept = 0;
+        for (uint32_t i = 0; i < m_count; i++)
+        {
+            if (kept == 0 || m_entries[kept - 1].pathHash != m_entries[i].pathHash)
+            {
+                m_entries[kept++] = m_entries[i];
+            }
+        }
+        m_count = kept;
+        m_sorted = true;
+        m_rebuilding = false;
+        flush();
+    }
+
+    bool FileIndex::load(uint32_t usedKB)
+    {
+        StorageBackend::Handle file = m_storage.open(m_storage.context, m_path, false);
+        if (!file)
+        {
+            return false;
+        }
+
+        Header header;
+        bool valid = m_storage.read(m_storage.context, file, 0, reinterpret_cast<uint8_t*>(&header), sizeof(header)) == sizeof(header) &&
+                     header.magic == MAGIC && header.version == VERSION &&
+                     header.crc == crc32(0, reinterpret_cast<const uint8_t*>(&header), offsetof(Header, crc)) &&
+                     header.state == STATE_CLEAN && header.count <= m_capacity &&
+                     (header.usedKB == 0 || usedKB == 0 || header.usedKB == usedKB);
+
+        size_t bytes = valid ? header.count * sizeof(FileIndexEntry) : 0;
+        valid = valid &&
+                m_storage.read(m_storage.context, file, sizeof(header), reinterpret_cast<uint8_t*>(m_entries), bytes) == bytes &&
+                crc32(0, reinterpret_cast<const uint8_t*>(m_entries), bytes) == header.entriesCrc;
+        m_storage.close(m_storage.context, file);
+        if (!valid)
+        {
+            return false;
+        }
+
+        m_count = header.count;
+        m_sorted = true;
+        m_dirty = false;
+        m_header = header;
+        m_savedChanged = false;
+        return true;
+    }
+
+    bool FileIndex::flush()
+    {
+        if (!m_open || m_rebuilding || m_full)
+        {
+            return false;
+        }
+        if (!m_dirty && !m_savedChanged)
+        {
+            return true;
+        }
+
+        Header header;
+        memset(&header, 0, sizeof(header));
+        header.magic = MAGIC;
+        header.version = VERSION;
+        header.state = STATE_CLEAN;
+        header.count = m_count;
+        size_t bytes = m_count * sizeof(FileIndexEntry);
+        header.entriesCrc = crc32(0, reinterpret_cast<const uint8_t*>(m_entries), bytes);
+
+        // Entries first and the header last, so a cut-short save never validates
+        m_storage.remove(m_storage.context, m_tempPath);
+        StorageBackend::Handle file = m_storage.open(m_storage.context, m_tempPath, true);
+        if (!file)
+        {
+            return false;
+        }
+        bool ok = m_storage.write(m_storage.context, file, sizeof(header), reinterpret_cast<const uint8_t*>(m_entries), bytes) == bytes;
+        m_storage.close(m_storage.context, file);
+        ok = ok && writeHeader(m_tempPath, header);
+
+        // FAT cannot rename over a file; losing both in between just means a rebuild
+        ok = ok && (!m_storage.exists(m_storage.context, m_path) || m_storage.remove(m_storage.context, m_path));
+        ok = ok && m_storage.rename(m_storage.context, m_tempPath, m_path);
+        if (!ok)
+        {
+            return false;
+        }
+
+        m_dirty = false;
+        m_savedChanged = false;
+        m_stats.flushes++;
+        return true;
+    }
+
+    bool FileIndex::seal(uint32_t usedKB)
+    {
+        if (!m_open || m_dirty || m_rebuilding || m_savedChanged || m_header.magic != MAGIC)
+        {
+            return false;
+        }
+        Header header = m_header;
+        header.usedKB = usedKB;
+        return writeHeader(m_path, header);
+    }
+
+    bool FileIndex::markChanged()
+    {
+        m_savedChanged = true;
+        if (m_header.magic != MAGIC)
+        {
+            return true;        // Nothing saved to contradict
+        }
+        Header header = m_header;
+        header.state = STATE_CHANGED;
+        header.usedKB = 0;
+        return writeHeader(m_path, header);
+    }
+
+    bool FileIndex::writeHeader(const char* path, const Header& header)
+    {
+        Header sealed = header;
+        sealed.crc = crc32(0, reinterpret_cast<const uint8_t*>(&sealed), offsetof(Header, crc));
+
+        StorageBackend::Handle file = m_storage.open(m_storage.context, path, false);
+        if (!file)
+        {
+            return false;
+        }
+        bool ok = m_storage.write(m_storage.context, file, 0, reinterpret_cast<const uint8_t*>(&sealed), sizeof(sealed)) == sizeof(sealed) &&
+                  m_storage.sync(m_storage.context, file);
+        m_storage.close(m_storage.context, file);
+        if (ok)
+        {
+            m_header = sealed;
+        }
+        return ok;
+    }
+
+    bool FileIndex::find(const char* path, FileIndexEntry& entry)
+    {
+        m_stats.lookups++;
+        uint32_t index;
+        if (!isReady() || !locate(hashPath(path, trimmedLength(path)), index))
+        {
+            return false;
+        }
+        m_stats.hits++;
+        entry = m_entries[index];
+        return true;
+    }
+
+    uint32_t FileIndex::count(const char* directory, FileKind kind) const
+    {
+        if (!isReady()) return 0;
+
+        uint32_t parent = static_cast<uint32_t>(hashPath(directory, trimmedLength(directory)));
+        uint32_t found = 0;
+        for (uint32_t i = 0; i < m_count; i++)
+        {
+            if (m_entries[i].parentHash == parent && m_entries[i].kind == kind) found++;
+        }
+        return found;
+    }
+
+    FileIndexStats FileIndex::stats() const
+    {
+        FileIndexStats stats = m_stats;
+        stats.entries = m_count;
+        stats.capacity = m_capacity;
+        stats.ready = isReady();
+        return stats;
+    }
+
+    uint64_t FileIndex::hashPath(const char* path, size_t length)
+    {
+        uint64_t hash = FNV64_OFFSET;
+        for (size_t i = 0; i < length; i++)
+        {
+            hash ^= static_cast<uint8_t>(path[i]);
+            hash *= FNV64_PRIME;
+        }
+        return hash;
+    }
+
+    FileKind FileIndex::kindOf(const char* path, bool isDirectory)
+    {
+        if (isDirectory) return FileKind::DIRECTORY;
+
+        const char* dot = strrchr(path, '.');
+        if (!dot || strchr(dot, '/')) return FileKind::OTHER;
+        const char* extension = dot + 1;
+
+        if (hasExtension(extension, "wav") || hasExtension(extension, "mp3")) return FileKind::AUDIO;
+        if (hasExtension(extension, "rtttl") || hasExtension(extension, "txt") || hasExtension(extension, "mid")) return FileKind::SONG;
+        if (hasExtension(extension, "nfc")) return FileKind::NFC_DUMP;
+        return FileKind::OTHER;
+    }
+
+    uint32_t FileIndex::parentOf(const char* path, size_t length)
+    {
+        size_t slash = length;
+        while (slash > 0 && path[slash - 1] != '/') slash--;
+
+        // Entries directly under the root belong to "/"
+        size_t parentLength = slash > 1 ? slash - 1 : 1;
+        return static_cast<uint32_t>(hashPath(path, parentLength));
+    }
+
+    uint32_t FileIndex::crc32(uint32_t crc, const uint8_t* data, size_t length)
+    {
+        // Nibble table: 64 bytes of flash instead of 1 KB
+        static const uint32_t TABLE[16] =
+        {
+            0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+            0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+        };
+
+        crc = ~crc;
+        for (size_t i = 0; i < length; i++)
+        {
+            crc = TABLE[(crc ^ data[i]) & 0x0F] ^ (crc >> 4);
+            crc = TABLE[(crc ^ (data[i] >> 4)) & 0x0F] ^ (crc >> 4);
+        }
+        return ~crc;
+    }
+
+    int FileIndex::compare(const void* a, const void* b)
+    {
+        uint64_t left = static_cast<const FileIndexEntry*>(a)->pathHash;
+        uint64_t right = static_cast<const FileIndexEntry*>(b)->pathHash;
+        return left < right ? -1 : (left > right ? 1 : 0);
+    }
+}
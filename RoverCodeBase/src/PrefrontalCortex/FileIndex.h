@@ -0,0 +1,194 @@
+/**
+ * @brief FileIndex answers "does this file exist, how big, what kind" without walking the card
+ *
+ * A sorted table of path hash, parent directory hash, size, modification
+ * time and kind, persisted to one file:
+ * - Built once by walking the tree a budget of entries per update(), then
+ *   kept current by the I/O layer noting each file it writes, creates or
+ *   removes; notes are queued lock-free from any task and applied by update()
+ * - Saved as entries then header to a temporary file and renamed into place
+ * - The saved header says whether changes were pending (the file is marked
+ *   as soon as the first change lands) and, once sealed before sleep, how
+ *   much of the card was in use; an unsaved change, a lost note or a card
+ *   edited elsewhere all lead to a rebuild on the next open
+ *
+ * Only hashes are kept, so the index cannot list names; browsing still
+ * walks, but existence, size and per-directory counts do not.
+ */
+
+#ifndef FILE_INDEX_H
+#define FILE_INDEX_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "StorageBackend.h"
+#include "DirectoryWalker.h"
+#include "BoundedQueue.h"
+
+namespace PrefrontalCortex
+{
+    enum class FileKind : uint8_t
+    {
+        DIRECTORY,
+        AUDIO,          // .wav, .mp3
+        SONG,           // .rtttl, .txt, .mid
+        NFC_DUMP,       // .nfc
+        OTHER
+    };
+
+    struct FileIndexEntry
+    {
+        uint64_t pathHash;
+        uint32_t parentHash;        // Low half of the directory's path hash
+        uint32_t size;
+        uint32_t modified;
+        FileKind kind;
+        uint8_t reserved[3];
+    };
+
+    struct FileIndexStats
+    {
+        uint32_t entries;
+        uint32_t capacity;
+        uint32_t rebuilds;
+        uint32_t changesApplied;
+        uint32_t changesDropped;    // Queue overflows; each forces a rebuild
+        uint32_t flushes;
+        uint32_t lookups;
+        uint32_t hits;
+        bool ready;
+    };
+
+    class FileIndex
+    {
+    public:
+        typedef void* (*Allocate)(size_t bytes);
+        typedef void (*Release)(void* memory);
+
+        static constexpr uint32_t CHANGE_DEPTH = 64;
+        static constexpr uint32_t DEFAULT_MAX_DELAY_MS = 30000;
+        static constexpr uint8_t PATH_LENGTH = 48;
+
+        FileIndex(const StorageBackend& storage, const DirectoryBackend& directories, Allocate allocate, Release release);
+        ~FileIndex();
+
+        /**
+         * @brief Load the saved index, or start rebuilding it by walking root
+         * @param usedKB Card usage measured now; 0 skips the edited-elsewhere check
+         */
+        bool open(const char* indexPath, const char* root, uint32_t capacity, uint32_t usedKB);
+        void close();
+
+        /**
+         * @brief False while rebuilding or after running out of capacity
+         */
+        bool isReady() const { return m_open && !m_rebuilding && !m_full; }
+
+        /**
+         * @brief Record a file or directory as it now is; any task
+         */
+        void noteWritten(const char* path, uint32_t size, uint32_t modified, bool isDirectory);
+        void noteRemoved(const char* path);
+
+        /**
+         * @brief Apply notes, walk up to budget entries of a rebuild, and save once due
+         */
+        void update(uint32_t nowMs, uint32_t budget);
+        void setMaxDelay(uint32_t maxDelayMs) { m_maxDelayMs = maxDelayMs; }
+
+        /**
+         * @brief Save now if anything changed; fails while rebuilding
+         */
+        bool flush();
+
+        /**
+         * @brief Stamp the saved index with current usage; call last before power goes away
+         */
+        bool seal(uint32_t usedKB);
+
+        /**
+         * @brief Start over from the card; lookups miss until the walk finishes
+         */
+        void rebuild();
+
+        bool find(const char* path, FileIndexEntry& entry);
+        uint32_t count(const char* directory, FileKind kind) const;
+
+        FileIndexStats stats() const;
+
+        static uint64_t hashPath(const char* path, size_t length);
+        static FileKind kindOf(const char* path, bool isDirectory);
+
+    private:
+        static constexpr uint32_t MAGIC = 0x58444946;   // "FIDX"
+        static constexpr uint16_t VERSION = 1;
+        static constexpr uint8_t STATE_CLEAN = 1;
+        static constexpr uint8_t STATE_CHANGED = 2;
+
+        struct Header
+        {
+            uint32_t magic;
+            uint16_t version;
+            uint8_t state;
+            uint8_t reserved;
+            uint32_t count;
+            uint32_t usedKB;            // Card usage when sealed; 0 if not sealed since the last save
+            uint32_t entriesCrc;
+            uint32_t crc;               // Header with crc = 0
+        };
+
+        struct Change
+        {
+            uint64_t pathHash;
+            uint32_t parentHash;
+            uint32_t size;
+            uint32_t modified;
+            FileKind kind;
+            bool removed;
+        };
+
+        StorageBackend m_storage;
+        DirectoryWalker m_walker;
+        Allocate m_allocate;
+        Release m_release;
+        char m_path[PATH_LENGTH];
+        char m_tempPath[PATH_LENGTH];
+        char m_root[PATH_LENGTH];
+        uint64_t m_pathHash;            // Notes about the index's own files are ignored
+        uint64_t m_tempHash;
+
+        FileIndexEntry* m_entries;
+        uint32_t m_capacity;
+        uint32_t m_count;
+        bool m_open;
+        bool m_sorted;                  // False during a rebuild, when entries are appended
+        bool m_rebuilding;
+        bool m_full;
+        bool m_dirty;
+        bool m_savedChanged;            // The saved header already says STATE_CHANGED
+        uint32_t m_dirtySinceMs;
+        uint32_t m_maxDelayMs;
+        Header m_header;                // As saved
+
+        BoundedQueue<Change, CHANGE_DEPTH> m_changes;
+        std::atomic<bool> m_overflow;
+
+        FileIndexStats m_stats;
+
+        void enqueue(const Change& change);
+        void apply(const Change& change);
+        bool locate(uint64_t hash, uint32_t& index) const;
+        void insert(const FileIndexEntry& entry);
+        void erase(uint64_t hash);
+        void finishRebuild();
+        bool load(uint32_t usedKB);
+        bool writeHeader(const char* path, const Header& header);
+        bool markChanged();
+        static uint32_t parentOf(const char* path, size_t length);
+        static uint32_t crc32(uint32_t crc, const uint8_t* data, size_t length);
+        static int compare(const void* a, const void* b);
+    };
+}
+
+#endif // FILE_INDEX_H
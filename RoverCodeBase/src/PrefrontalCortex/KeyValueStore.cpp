@@ -0,0 +1,446 @@
+/**
+ * @file KeyValueStore.cpp
+ * @brief RAM-indexed settings with batched, generation-stamped log records
+ */
+
+#include "KeyValueStore.h"
+#include "WriteJournal.h"
+#include <stdio.h>
+#include <string.h>
+
+namespace PrefrontalCortex
+{
+    namespace
+    {
+        constexpr uint32_t SEGMENT_MAGIC = 0x3153564B;      // "KVS1"
+        constexpr uint16_t RECORD_MAGIC = 0x564B;           // "KV"
+        constexpr size_t BATCH_BYTES = 512;
+    }
+
+    KeyValueStore::KeyValueStore(const StorageBackend& storage)
+        : m_storage(storage)
+        , m_open(false)
+        , m_segment(SEGMENTS - 1)
+        , m_generation(0)
+        , m_sequence(1)
+        , m_segmentLength(0)
+        , m_dirtySinceMs(0)
+        , m_maxDelayMs(DEFAULT_MAX_DELAY_MS)
+        , m_entryCount(0)
+        , m_dirtyCount(0)
+    {
+        m_directory[0] = '\0';
+        memset(m_table, NO_ENTRY, sizeof(m_table));
+        memset(&m_stats, 0, sizeof(m_stats));
+    }
+
+    KeyValueStore::~KeyValueStore()
+    {
+        close();
+    }
+
+    bool KeyValueStore::open(const char* directory)
+    {
+        if (m_open) return true;
+        if (strlen(directory) >= sizeof(m_directory)) return false;
+        strcpy(m_directory, directory);
+
+        // Only the newest complete segment is read; older ones are history
+        uint8_t newest = SEGMENTS;
+        for (uint8_t slot = 0; slot < SEGMENTS; slot++)
+        {
+            uint32_t generation;
+            if (readSegmentHeader(slot, generation) && generation > m_generation)
+            {
+                m_generation = generation;
+                newest = slot;
+            }
+        }
+
+        m_open = true;
+        if (newest == SEGMENTS)
+        {
+            // Nothing yet; the first flush creates generation 1 in slot 0
+            m_segment = SEGMENTS - 1;
+            m_generation = 0;
+            m_segmentLength = 0;
+            return true;
+        }
+
+        m_segment = newest;
+        if (!load(newest))
+        {
+            m_stats.failures++;
+        }
+        return true;
+    }
+
+    void KeyValueStore::close()
+    {
+        if (!m_open) return;
+
+        flush();
+        m_open = false;
+    }
+
+    bool KeyValueStore::get(const char* key, void* value, uint8_t length) const
+    {
+        const Entry* entry = find(key);
+        if (entry == nullptr || !entry->live || entry->length != length) return false;
+
+        if (length) memcpy(value, entry->value, length);
+        return true;
+    }
+
+    bool KeyValueStore::contains(const char* key) const
+    {
+        const Entry* entry = find(key);
+        return entry != nullptr && entry->live;
+    }
+
+    bool KeyValueStore::set(const char* key, const void* value, uint8_t length, uint32_t nowMs)
+    {
+        size_t keyLength = strlen(key);
+        if (keyLength == 0 || keyLength > KEY_LENGTH || length > VALUE_LENGTH) return false;
+
+        Entry* entry = const_cast<Entry*>(find(key));
+        if (entry == nullptr)
+        {
+            entry = insert(key, keyLength);
+            if (entry == nullptr) return false;
+        }
+        else if (entry->live && entry->length == length && (length == 0 || memcmp(entry->value, value, length) == 0))
+        {
+            return true;
+        }
+
+        // An empty value may come with no buffer at all
+        if (length) memcpy(entry->value, value, length);
+        entry->length = length;
+        entry->live = true;
+        markDirty(*entry, nowMs);
+        return true;
+    }
+
+    bool KeyValueStore::remove(const char* key, uint32_t nowMs)
+    {
+        Entry* entry = const_cast<Entry*>(find(key));
+        if (entry == nullptr || !entry->live) return true;
+
+        entry->live = false;
+        entry->length = 0;
+        markDirty(*entry, nowMs);
+        return true;
+    }
+
+    uint32_t KeyValueStore::getUInt(const char* key, uint32_t fallback) const
+    {
+        uint32_t value;
+        return get(key, &value, sizeof(value)) ? value : fallback;
+    }
+
+    void KeyValueStore::update(uint32_t nowMs)
+    {
+        if (!m_open) return;
+
+        if (m_dirtyCount > 0)
+        {
+            if (nowMs - m_dirtySinceMs >= m_maxDelayMs && !flush())
+            {
+                m_dirtySinceMs = nowMs;     // Back off before retrying
+            }
+        }
+        else if (m_segmentLength > COMPACT_BYTES)
+        {
+            // Between batches, so set() never waits on a rewrite
+            compact();
+        }
+    }
+
+    bool KeyValueStore::flush()
+    {
+        if (!m_open) return false;
+        if (m_dirtyCount == 0) return true;
+
+        size_t needed = 0;
+        for (uint8_t i = 0; i < m_entryCount; i++)
+        {
+            if (m_entries[i].dirty) needed += sizeof(RecordHeader) + strlen(m_entries[i].key) + m_entries[i].length;
+        }
+        if (m_generation == 0 || m_segmentLength + needed > SEGMENT_BYTES)
+        {
+            return compact();
+        }
+
+        char path[PATH_LENGTH];
+        segmentPath(m_segment, path);
+        StorageBackend::Handle file = m_storage.open(m_storage.context, path, false);
+        uint32_t offset = m_segmentLength;
+        bool ok = file != nullptr && writeRecords(file, offset, true, m_generation) &&
+                  m_storage.sync(m_storage.context, file);
+        if (file) m_storage.close(m_storage.context, file);
+
+        if (!ok)
+        {
+            // A partial batch is a torn tail; the next batch overwrites it
+            m_stats.failures++;
+            return false;
+        }
+
+        for (uint8_t i = 0; i < m_entryCount; i++)
+        {
+            m_entries[i].dirty = false;
+        }
+        m_dirtyCount = 0;
+        m_segmentLength = offset;
+        m_stats.batches++;
+        return true;
+    }
+
+    bool KeyValueStore::compact()
+    {
+        if (!m_open) return false;
+
+        uint8_t slot = static_cast<uint8_t>((m_segment + 1) % SEGMENTS);
+        uint32_t generation = m_generation + 1;
+        char path[PATH_LENGTH];
+        segmentPath(slot, path);
+
+        // Start from an empty file so nothing of the slot's last generation survives
+        m_storage.remove(m_storage.context, path);
+        StorageBackend::Handle file = m_storage.open(m_storage.context, path, true);
+        uint32_t offset = sizeof(SegmentHeader);
+        bool ok = file != nullptr && writeRecords(file, offset, false, generation) &&
+                  m_storage.sync(m_storage.context, file);
+
+        if (ok)
+        {
+            // The header goes last: until it lands, the previous segment is still newest
+            SegmentHeader header;
+            header.magic = SEGMENT_MAGIC;
+            header.generation = generation;
+            header.reserved = 0;
+            header.crc = WriteJournal::crc32(0, reinterpret_cast<const uint8_t*>(&header), offsetof(SegmentHeader, crc));
+            ok = m_storage.write(m_storage.context, file, 0, reinterpret_cast<const uint8_t*>(&header), sizeof(header)) == sizeof(header) &&
+                 m_storage.sync(m_storage.context, file);
+        }
+        if (file) m_storage.close(m_storage.context, file);
+
+        if (!ok)
+        {
+            m_stats.failures++;
+            return false;
+        }
+
+        m_segment = slot;
+        m_generation = generation;
+        m_segmentLength = offset;
+        for (uint8_t i = 0; i < m_entryCount; i++)
+        {
+            m_entries[i].dirty = false;
+        }
+        m_dirtyCount = 0;
+        m_stats.compactions++;
+        return true;
+    }
+
+    KeyValueStats KeyValueStore::stats() const
+    {
+        KeyValueStats result = m_stats;
+        result.generation = m_generation;
+        result.segmentBytes = m_segmentLength;
+        result.dirty = m_dirtyCount;
+        result.keys = 0;
+        for (uint8_t i = 0; i < m_entryCount; i++)
+        {
+            if (m_entries[i].live) result.keys++;
+        }
+        return result;
+    }
+
+    const KeyValueStore::Entry* KeyValueStore::find(const char* key) const
+    {
+        size_t keyLength = strlen(key);
+        for (uint8_t probe = 0, slot = slotFor(key, keyLength); probe < TABLE_SLOTS; probe++, slot = (slot + 1) % TABLE_SLOTS)
+        {
+            uint8_t index = m_table[slot];
+            if (index == NO_ENTRY) return nullptr;
+            if (strcmp(m_entries[index].key, key) == 0) return &m_entries[index];
+        }
+        return nullptr;
+    }
+
+    KeyValueStore::Entry* KeyValueStore::insert(const char* key, size_t keyLength)
+    {
+        if (m_entryCount == MAX_KEYS) return nullptr;
+
+        // Entries are never unlinked, so a removed key keeps its slot for reuse
+        uint8_t slot = slotFor(key, keyLength);
+        while (m_table[slot] != NO_ENTRY)
+        {
+            slot = (slot + 1) % TABLE_SLOTS;
+        }
+
+        Entry& entry = m_entries[m_entryCount];
+        memcpy(entry.key, key, keyLength);
+        entry.key[keyLength] = '\0';
+        entry.length = 0;
+        entry.live = false;
+        entry.dirty = false;
+        m_table[slot] = m_entryCount++;
+        return &entry;
+    }
+
+    void KeyValueStore::markDirty(Entry& entry, uint32_t nowMs)
+    {
+        if (!entry.dirty)
+        {
+            entry.dirty = true;
+            if (m_dirtyCount++ == 0) m_dirtySinceMs = nowMs;
+        }
+        m_stats.sets++;
+    }
+
+    bool KeyValueStore::segmentPath(uint8_t slot, char* path) const
+    {
+        int written = snprintf(path, PATH_LENGTH, "%s/kv%u.log", m_directory, static_cast<unsigned>(slot));
+        return written > 0 && written < PATH_LENGTH;
+    }
+
+    bool KeyValueStore::readSegmentHeader(uint8_t slot, uint32_t& generation)
+    {
+        char path[PATH_LENGTH];
+        if (!segmentPath(slot, path) || !m_storage.exists(m_storage.context, path)) return false;
+
+        StorageBackend::Handle file = m_storage.open(m_storage.context, path, false);
+        if (file == nullptr) return false;
+
+        SegmentHeader header;
+        bool valid = m_storage.read(m_storage.context, file, 0, reinterpret_cast<uint8_t*>(&header), sizeof(header)) == sizeof(header) &&
+                     header.magic == SEGMENT_MAGIC &&
+                     header.crc == WriteJournal::crc32(0, reinterpret_cast<const uint8_t*>(&header), offsetof(SegmentHeader, crc));
+        m_storage.close(m_storage.context, file);
+
+        generation = header.generation;
+        return valid;
+    }
+
+    bool KeyValueStore::load(uint8_t slot)
+    {
+        char path[PATH_LENGTH];
+        segmentPath(slot, path);
+        StorageBackend::Handle file = m_storage.open(m_storage.context, path, false);
+        if (file == nullptr) return false;
+
+        uint32_t size = m_storage.size(m_storage.context, file);
+        uint32_t offset = sizeof(SegmentHeader);
+        uint32_t previous = 0;
+        uint8_t record[RECORD_MAX];
+
+        while (offset + sizeof(RecordHeader) <= size)
+        {
+            RecordHeader header;
+            if (m_storage.read(m_storage.context, file, offset, record, sizeof(header)) != sizeof(header)) break;
+            memcpy(&header, record, sizeof(header));
+
+            size_t payload = header.keyLength + header.valueLength;
+            bool valid = header.magic == RECORD_MAGIC && header.generation == m_generation && header.sequence > previous &&
+                         header.keyLength > 0 && header.keyLength <= KEY_LENGTH && header.valueLength <= VALUE_LENGTH &&
+                         offset + sizeof(header) + payload <= size &&
+                         m_storage.read(m_storage.context, file, offset + sizeof(header), record + sizeof(header), payload) == payload;
+            if (valid)
+            {
+                uint32_t crc = header.crc;
+                header.crc = 0;
+                memcpy(record, &header, sizeof(header));
+                valid = crc == WriteJournal::crc32(0, record, sizeof(header) + payload);
+            }
+            if (!valid)
+            {
+                m_stats.tornRecords++;
+                break;
+            }
+
+            char key[KEY_LENGTH + 1];
+            memcpy(key, record + sizeof(header), header.keyLength);
+            key[header.keyLength] = '\0';
+
+            Entry* entry = const_cast<Entry*>(find(key));
+            if (entry == nullptr) entry = insert(key, header.keyLength);
+            if (entry)
+            {
+                entry->live = (header.flags & DELETED) == 0;
+                entry->length = entry->live ? header.valueLength : 0;
+                memcpy(entry->value, record + sizeof(header) + header.keyLength, entry->length);
+            }
+            m_stats.recordsLoaded++;
+            previous = header.sequence;
+            offset += sizeof(header) + payload;
+        }
+
+        m_storage.close(m_storage.context, file);
+        m_segmentLength = offset;
+        m_sequence = previous + 1;
+        return true;
+    }
+
+    bool KeyValueStore::writeRecords(StorageBackend::Handle file, uint32_t& offset, bool dirtyOnly, uint32_t generation)
+    {
+        // Records are gathered so a batch is a few sector-sized writes
+        uint8_t batch[BATCH_BYTES];
+        size_t used = 0;
+
+        for (uint8_t i = 0; i <= m_entryCount; i++)
+        {
+            bool last = i == m_entryCount;
+            bool wanted = !last && (dirtyOnly ? m_entries[i].dirty : m_entries[i].live);
+            if (used > 0 && (last || (wanted && used + RECORD_MAX > sizeof(batch))))
+            {
+                if (m_storage.write(m_storage.context, file, offset, batch, used) != used) return false;
+                offset += used;
+                used = 0;
+            }
+            if (wanted)
+            {
+                used += encode(m_entries[i], generation, batch + used);
+                m_stats.recordsWritten++;
+            }
+        }
+        return true;
+    }
+
+    size_t KeyValueStore::encode(const Entry& entry, uint32_t generation, uint8_t* out)
+    {
+        size_t keyLength = strlen(entry.key);
+
+        RecordHeader header;
+        header.magic = RECORD_MAGIC;
+        header.keyLength = static_cast<uint8_t>(keyLength);
+        header.valueLength = entry.live ? entry.length : 0;
+        header.flags = entry.live ? 0 : DELETED;
+        memset(header.reserved, 0, sizeof(header.reserved));
+        header.generation = generation;
+        header.sequence = m_sequence++;
+        header.crc = 0;
+
+        memcpy(out, &header, sizeof(header));
+        memcpy(out + sizeof(header), entry.key, keyLength);
+        memcpy(out + sizeof(header) + keyLength, entry.value, header.valueLength);
+
+        size_t length = sizeof(header) + keyLength + header.valueLength;
+        header.crc = WriteJournal::crc32(0, out, length);
+        memcpy(out + offsetof(RecordHeader, crc), &header.crc, sizeof(header.crc));
+        return length;
+    }
+
+    uint8_t KeyValueStore::slotFor(const char* key, size_t keyLength)
+    {
+        // FNV-1a
+        uint32_t hash = 2166136261u;
+        for (size_t i = 0; i < keyLength; i++)
+        {
+            hash = (hash ^ static_cast<uint8_t>(key[i])) * 16777619u;
+        }
+        return static_cast<uint8_t>(hash % TABLE_SLOTS);
+    }
+}
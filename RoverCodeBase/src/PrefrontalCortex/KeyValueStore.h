@@ -0,0 +1,166 @@
+/**
+ * @brief KeyValueStore keeps small settings and counters in a log-structured file
+ *
+ * Every value lives in RAM, so reads never touch storage:
+ * - set() only updates RAM and marks the key dirty; update() appends all
+ *   dirty keys as one batch once the oldest change is old enough, so a
+ *   counter bumped on every card scan costs one record per batch
+ * - Each record carries the segment generation, a sequence number and a
+ *   CRC-32; loading replays the newest segment and stops at the first
+ *   torn or out-of-order record
+ * - When a segment fills past its threshold the live values are compacted
+ *   into the next segment file, and its header is written last, so a
+ *   compaction cut short leaves the previous segment in charge
+ * - Compaction rotates through SEGMENTS files, spreading rewrites instead
+ *   of wearing the same blocks every time
+ */
+
+#ifndef KEY_VALUE_STORE_H
+#define KEY_VALUE_STORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "StorageBackend.h"
+
+namespace PrefrontalCortex
+{
+    struct KeyValueStats
+    {
+        uint32_t sets;              // set()/remove() calls that changed a value
+        uint32_t recordsWritten;
+        uint32_t batches;
+        uint32_t compactions;
+        uint32_t generation;        // Current segment generation
+        uint32_t segmentBytes;      // Used bytes in the current segment
+        uint32_t recordsLoaded;
+        uint32_t tornRecords;       // Invalid tail found on open
+        uint32_t failures;
+        uint8_t keys;
+        uint8_t dirty;
+    };
+
+    class KeyValueStore
+    {
+    public:
+        static constexpr uint8_t MAX_KEYS = 32;
+        static constexpr uint8_t KEY_LENGTH = 15;
+        static constexpr uint8_t VALUE_LENGTH = 16;
+        static constexpr uint8_t SEGMENTS = 4;
+        static constexpr uint32_t SEGMENT_BYTES = 8192;
+        static constexpr uint32_t COMPACT_BYTES = SEGMENT_BYTES * 3 / 4;   // Compact from update() past this
+        static constexpr uint32_t DEFAULT_MAX_DELAY_MS = 5000;
+        static constexpr uint8_t PATH_LENGTH = 48;
+
+        explicit KeyValueStore(const StorageBackend& storage);
+        ~KeyValueStore();
+
+        /**
+         * @brief Load the newest segment under a directory (which must exist)
+         */
+        bool open(const char* directory);
+        void close();
+        bool isOpen() const { return m_open; }
+
+        /**
+         * @brief Copy a value out of RAM
+         * @return false if the key is missing or stored with another length
+         */
+        bool get(const char* key, void* value, uint8_t length) const;
+        bool contains(const char* key) const;
+
+        /**
+         * @brief Change a value in RAM; persisted by the next batch
+         * @return false if the key or value is too long or the table is full
+         */
+        bool set(const char* key, const void* value, uint8_t length, uint32_t nowMs);
+        bool remove(const char* key, uint32_t nowMs);
+
+        uint32_t getUInt(const char* key, uint32_t fallback) const;
+        bool setUInt(const char* key, uint32_t value, uint32_t nowMs) { return set(key, &value, sizeof(value), nowMs); }
+
+        /**
+         * @brief Write dirty keys once the oldest has waited maxDelayMs, and compact when due
+         */
+        void update(uint32_t nowMs);
+        void setMaxDelay(uint32_t maxDelayMs) { m_maxDelayMs = maxDelayMs; }
+
+        /**
+         * @brief Write every dirty key now
+         */
+        bool flush();
+
+        /**
+         * @brief Rewrite the live values into the next segment
+         */
+        bool compact();
+
+        KeyValueStats stats() const;
+
+    private:
+        static constexpr uint8_t NO_ENTRY = 0xFF;
+        static constexpr uint8_t TABLE_SLOTS = MAX_KEYS * 2;    // Open addressing, at most half full
+        static constexpr uint8_t DELETED = 0x01;
+
+        struct SegmentHeader
+        {
+            uint32_t magic;
+            uint32_t generation;
+            uint32_t reserved;
+            uint32_t crc;
+        };
+
+        struct RecordHeader
+        {
+            uint16_t magic;
+            uint8_t keyLength;
+            uint8_t valueLength;
+            uint8_t flags;
+            uint8_t reserved[3];
+            uint32_t generation;
+            uint32_t sequence;          // Never reused, so leftovers past a torn tail are older
+            uint32_t crc;               // Header with crc = 0, then key and value
+        };
+
+        struct Entry
+        {
+            char key[KEY_LENGTH + 1];
+            uint8_t value[VALUE_LENGTH];
+            uint8_t length;
+            bool live;
+            bool dirty;
+        };
+
+        static constexpr size_t RECORD_MAX = sizeof(RecordHeader) + KEY_LENGTH + VALUE_LENGTH;
+
+        StorageBackend m_storage;
+        char m_directory[PATH_LENGTH - 12];     // Room for "/kvN.log"
+        bool m_open;
+        uint8_t m_segment;              // Slot holding the current generation
+        uint32_t m_generation;
+        uint32_t m_sequence;            // Next record sequence
+        uint32_t m_segmentLength;
+        uint32_t m_dirtySinceMs;
+        uint32_t m_maxDelayMs;
+
+        Entry m_entries[MAX_KEYS];
+        uint8_t m_entryCount;
+        uint8_t m_table[TABLE_SLOTS];
+        uint8_t m_dirtyCount;
+
+        KeyValueStats m_stats;
+
+        const Entry* find(const char* key) const;
+        Entry* insert(const char* key, size_t keyLength);
+        void markDirty(Entry& entry, uint32_t nowMs);
+
+        bool segmentPath(uint8_t slot, char* path) const;
+        bool readSegmentHeader(uint8_t slot, uint32_t& generation);
+        bool load(uint8_t slot);
+        bool writeRecords(StorageBackend::Handle file, uint32_t& offset, bool dirtyOnly, uint32_t generation);
+        size_t encode(const Entry& entry, uint32_t generation, uint8_t* out);
+
+        static uint8_t slotFor(const char* key, size_t keyLength);
+    };
+}
+
+#endif // KEY_VALUE_STORE_H
@@ -2,6 +2,7 @@
 #include "../VisualCortex/LEDManager.h"
 #include "../VisualCortex/RoverViewManager.h"
 #include "../VisualCortex/RoverManager.h"
+#include "SDManager.h"
 
 namespace PrefrontalCortex 
 {
@@ -185,6 +186,8 @@ namespace PrefrontalCortex
     }
 
     void PowerManager::enterDeepSleep() {
+        // Staged file writes only live in RAM until committed
+        SDManager::prepareForSleep();
         LEDManager::stopLoadingAnimation();
 
         FastLED.show();
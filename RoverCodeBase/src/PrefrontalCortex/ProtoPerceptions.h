@@ -21,6 +21,7 @@
 #include <Arduino.h>
 #include <FastLED.h>
 #include <vector>
+#include <array>
 #include <string>
 #include <functional>
 
@@ -443,6 +444,29 @@ namespace PrefrontalCortex
     using SensoryBuffer = std::vector<SensoryInput>;
     using ResponseQueue = std::vector<NeuralResponse>;
 
+    /**
+     * @brief Non-owning view over a constant array (pointer + count)
+     */
+    template <typename T>
+    struct ConstSpan 
+    {
+        const T* data;
+        size_t count;
+
+        constexpr ConstSpan() : data(nullptr), count(0) {}
+        constexpr ConstSpan(const T* d, size_t n) : data(d), count(n) {}
+        template <size_t N>
+        constexpr ConstSpan(const T (&array)[N]) : data(array), count(N) {}
+        template <size_t N>
+        constexpr ConstSpan(const std::array<T, N>& array) : data(array.data()), count(N) {}
+
+        constexpr size_t size() const { return count; }
+        constexpr bool empty() const { return count == 0; }
+        constexpr const T& operator[](size_t index) const { return data[index]; }
+        constexpr const T* begin() const { return data; }
+        constexpr const T* end() const { return data + count; }
+    };
+
     // Auditory Perception Types
     namespace AudioTypes 
     {
@@ -491,7 +515,7 @@ namespace PrefrontalCortex
             NoteType type;
             bool isSharp;
 
-            NoteInfo(NoteIndex n, uint8_t o, NoteType t) 
+            constexpr NoteInfo(NoteIndex n, uint8_t o, NoteType t) 
                 : note(n), octave(o), type(t), isSharp(false) {}
         };
 
@@ -510,12 +534,25 @@ namespace PrefrontalCortex
             uint16_t bitsPerSample;
         };
 
+        /**
+         * @brief Per-note playback values resolved at compile time
+         */
+        struct TuneStep 
+        {
+            uint16_t frequency;   // Hz, 0 for rests
+            uint16_t durationMs;
+        };
+
+        /**
+         * @brief Read-only view of a flash-resident tune
+         */
         struct Tune 
         {
             const char* name;
-            std::vector<NoteInfo> notes;
-            std::vector<uint8_t> ledAnimation;
+            ConstSpan<NoteInfo> notes;
+            ConstSpan<uint8_t> ledAnimation;
             TimeSignature timeSignature;
+            ConstSpan<TuneStep> steps;
         };
 
         enum class TunesTypes 
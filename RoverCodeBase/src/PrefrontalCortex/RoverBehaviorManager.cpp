@@ -57,6 +57,7 @@ namespace PrefrontalCortex
             // Initialize core memory and storage systems
             Utilities::LOG_DEBUG("Initializing SD Manager...");
             SDManager::init(BOARD_SD_CS);
+            RoverViewManager::restoreProgress();
             Utilities::LOG_DEBUG("Memory pathways initialized");
 
             // Initialize core visual systems
@@ -6,9 +6,12 @@
 #include <SPI.h>
 #include "../VisualCortex/LEDManager.h"
 #include "../VisualCortex/RoverManager.h"
+#include "../VisualCortex/RoverViewManager.h"
 #include "../PrefrontalCortex/RoverBehaviorManager.h"
 #include "../MotorCortex/PinDefinitions.h"
 #include "../PrefrontalCortex/SPIManager.h"
+#include <sys/stat.h>
+#include <time.h>
 
 namespace PrefrontalCortex 
 {
@@ -20,21 +23,56 @@ namespace PrefrontalCortex
     bool SDManager::initialized = false;
     uint8_t SDManager::cardType = 0;
     const char* SDManager::NFC_FOLDER = "/nfc";
-    const char* SDManager::SCANNED_CARDS_FILE = "/nfc/scanned_cards.txt";
-    uint64_t SDManager::cardSize = 0;
-    uint64_t SDManager::totalSpace = 0;
-    uint64_t SDManager::usedSpace = 0;
+    const char* SDManager::SCANNED_CARDS_FILE = "/nfc/scanned_cards.idx";
+    const char* SDManager::SCANNED_CARDS_LOG = "/nfc/scanned_cards.wal";
+    const char* SDManager::JOURNAL_FILE = "/journal.bin";
+    const char* SDManager::SETTINGS_FOLDER = "/settings";
+    const char* SDManager::SETTING_EXPERIENCE = "xp";
+    const char* SDManager::SETTING_LEVEL = "level";
+    const char* SDManager::SETTING_TOTAL_SCANS = "total_scans";
+    const char* SDManager::SETTING_VOLUME = "volume";
+    const char* SDManager::SETTING_LED_MODE = "led_mode";
+    const char* SDManager::SETTING_FESTIVE_THEME = "festive_theme";
+    const char* SDManager::SETTING_ENCODING_MODE = "encoding_mode";
+    uint32_t SDManager::lastStorageActivity = 0;
+    uint32_t SDManager::lastMaintenance = 0;
+
+    const StorageBackend SDManager::SD_STORAGE = 
+    {
+        openStorageFile, closeStorageFile, readStorageFile, writeStorageFile, storageFileSize,
+        syncStorageFile, storageExists, removeStorageFile, renameStorageFile, &SD
+    };
+    CardScanIndex SDManager::scanIndex(SDManager::SD_STORAGE, SDManager::allocateIndex, free);
+    WriteJournal SDManager::journal(SDManager::SD_STORAGE);
+    KeyValueStore SDManager::settings(SDManager::SD_STORAGE);
+    const StorageWorkerHooks SDManager::WORKER_HOOKS = 
+    {
+        workerMicros, listWorkerDirectory, wakeWorker, &SD
+    };
+    StorageWorker SDManager::worker(SDManager::SD_STORAGE, SDManager::WORKER_HOOKS);
+    TaskHandle_t SDManager::workerTaskHandle = nullptr;
+    const StorageUsageHooks SDManager::USAGE_HOOKS = { measureCard, &SD };
+    StorageUsage SDManager::usage(SDManager::USAGE_HOOKS);
+    const char* SDManager::SD_MOUNT = "/sd";
+    const char* SDManager::SPIFFS_MOUNT = "/spiffs";
+    const DirectoryBackend SDManager::SD_DIRECTORIES = 
+    {
+        openDirectory, nextDirectoryEntry, tellDirectory, seekDirectory, closeDirectory,
+        const_cast<char*>(SDManager::SD_MOUNT)
+    };
+    const char* SDManager::FILE_INDEX = "/files.idx";
+    FileIndex SDManager::fileIndex(SDManager::SD_STORAGE, SDManager::SD_DIRECTORIES, SDManager::allocateIndex, free);
 
     uint64_t SDManager::getTotalSpace() {
-        return SDManager::totalSpace;
+        return usage.snapshot().totalKB / 1024;
     }
 
     uint64_t SDManager::getUsedSpace() {
-        return SDManager::usedSpace;
+        return usage.snapshot().usedKB / 1024;
     }
 
     uint64_t SDManager::getCardSize() {
-        return SDManager::cardSize;
+        return usage.snapshot().cardKB / 1024;
     }
 
     #define REASSIGN_PINS
@@ -45,40 +83,42 @@ namespace PrefrontalCortex
 
     void SDManager::listDir(fs::FS &fs, const char *dirname, uint8_t levels) 
     {
-        File root = fs.open(dirname);
-        if (!root) 
+        SPILease lease(SPIDevice::SD, SPIPriority::NORMAL, &fs == &SD);
+
+        flushJournal(fs);
+
+        // levels counts the subdirectories below dirname that are also listed
+        DirectoryWalker walker(directoriesFor(fs));
+        uint8_t depth = levels < DirectoryWalker::MAX_DEPTH ? levels + 1 : DirectoryWalker::MAX_DEPTH;
+        if (!walker.open(dirname, depth, true)) 
         {
             Utilities::LOG_ERROR("Memory pathway access failed: %s", dirname);
             return;
         }
-        if (!root.isDirectory()) 
-        {
-            Utilities::LOG_ERROR("Not a memory cluster: %s", dirname);
-            return;
-        }
 
-        File file = root.openNextFile();
-        while (file) 
+        WalkEntry entry;
+        while (walker.next(entry)) 
         {
-            if (file.isDirectory()) 
+            if (entry.isDirectory) 
             {
-                Utilities::LOG_DEBUG("Memory cluster: %s", file.name());
-                if (levels) 
-                {
-                    listDir(fs, file.path(), levels - 1);
-                }
+                Utilities::LOG_DEBUG("Memory cluster: %s", entry.path);
             } 
             else 
             {
-                Utilities::LOG_DEBUG("Memory fragment: %s, size: %d", file.name(), file.size());
+                Utilities::LOG_DEBUG("Memory fragment: %s, size: %u", entry.path, entry.size);
             }
-            file = root.openNextFile();
+        }
+        if (walker.skipped() > 0) 
+        {
+            Utilities::LOG_DEBUG("%u entries not listed: path too long or directory unreadable", walker.skipped());
         }
     }
 
     void SDManager::createDir(fs::FS &fs, const char *path) 
     {
+        SPILease lease(SPIDevice::SD, SPIPriority::NORMAL, &fs == &SD);
         if(fs.mkdir(path)){
+            noteFile(fs, path);
             Utilities::LOG_DEBUG("Dir created");
         } else {
             Utilities::LOG_DEBUG("mkdir failed");
@@ -87,7 +127,9 @@ namespace PrefrontalCortex
 
     void SDManager::removeDir(fs::FS &fs, const char *path) 
     {
+        SPILease lease(SPIDevice::SD, SPIPriority::NORMAL, &fs == &SD);
         if(fs.rmdir(path)){
+            if (&fs == &SD) fileIndex.noteRemoved(path);
             Utilities::LOG_DEBUG("Dir removed");
         } else {
             Utilities::LOG_DEBUG("rmdir failed");
@@ -96,6 +138,9 @@ namespace PrefrontalCortex
 
     void SDManager::readFile(fs::FS &fs, const char *path) 
     {
+        SPILease lease(SPIDevice::SD, SPIPriority::NORMAL, &fs == &SD);
+
+        flushJournal(fs, path);
         File file = fs.open(path);
         if(!file){
             Utilities::LOG_ERROR("Failed to open file for reading");
@@ -111,6 +156,17 @@ namespace PrefrontalCortex
 
     void SDManager::writeFile(fs::FS &fs, const char *path, const char *message) 
     {
+        SPILease lease(SPIDevice::SD, SPIPriority::NORMAL, &fs == &SD);
+        if (&fs == &SD && journal.isOpen()) 
+        {
+            if (journal.write(path, reinterpret_cast<const uint8_t*>(message), strlen(message), millis())) {
+                Utilities::LOG_DEBUG("File written");
+            } else {
+                Utilities::LOG_ERROR("Write failed");
+            }
+            return;
+        }
+
         File file = fs.open(path, FILE_WRITE);
         if(!file){
             Utilities::LOG_ERROR("Failed to open file for writing");
@@ -122,26 +178,47 @@ namespace PrefrontalCortex
             Utilities::LOG_ERROR("Write failed");
         }
         file.close();
+        noteFile(fs, path);
     }
 
     void SDManager::appendFile(fs::FS &fs, const char *path, const char *message) 
     {
+        SPILease lease(SPIDevice::SD, SPIPriority::NORMAL, &fs == &SD);
+        if (&fs == &SD && journal.isOpen()) 
+        {
+            if (journal.append(path, reinterpret_cast<const uint8_t*>(message), strlen(message), millis())) {
+                Utilities::LOG_DEBUG("Message appended");
+            } else {
+                Utilities::LOG_ERROR("Append failed");
+            }
+            return;
+        }
+
         File file = fs.open(path, FILE_APPEND);
         if(!file){
             Utilities::LOG_ERROR("Failed to open file for appending");
             return;
         }
-        if(file.print(message)){
+        size_t appended = file.print(message);
+        if(appended){
+            if (&fs == &SD) usage.recordDelta(appended);
             Utilities::LOG_DEBUG("Message appended");
         } else {
             Utilities::LOG_ERROR("Append failed");
         }
         file.close();
+        noteFile(fs, path);
     }
 
     void SDManager::renameFile(fs::FS &fs, const char *path1, const char *path2) 
     {
+        SPILease lease(SPIDevice::SD, SPIPriority::NORMAL, &fs == &SD);
+
+        flushJournal(fs, path1);
+        flushJournal(fs, path2);
         if (fs.rename(path1, path2)) {
+            if (&fs == &SD) fileIndex.noteRemoved(path1);
+            noteFile(fs, path2);
             Utilities::LOG_DEBUG("File renamed");
         } else {
             Utilities::LOG_ERROR("Rename failed");
@@ -150,59 +227,75 @@ namespace PrefrontalCortex
 
     void SDManager::deleteFile(fs::FS &fs, const char *path) 
     {
-        if(fs.remove(path)){
+        SPILease lease(SPIDevice::SD, SPIPriority::NORMAL, &fs == &SD);
+
+        flushJournal(fs, path);
+        if(removeCounted(fs, path)){
             Utilities::LOG_DEBUG("File deleted");
         } else {
             Utilities::LOG_ERROR("Delete failed");
         }
     }
 
-    void SDManager::testFileIO(fs::FS &fs, const char *path) 
+    bool SDManager::runBenchmark(fs::FS &fs, const char *directory, const char *csvPath) 
     {
-        File file = fs.open(path);
-        static uint8_t buf[512];
-        size_t len = 0;
-        uint32_t start = millis();
-        uint32_t end = start;
-        if(file){
-            len = file.size();
-            size_t flen = len;
-            start = millis();
-            while(len){
-                size_t toRead = len;
-                if(toRead > 512){
-                    toRead = 512;
-                }
-                file.read(buf, toRead);
-                len -= toRead;
-            }
-            end = millis() - start;
-            Utilities::LOG_DEBUG("%u bytes read for %lu ms\n", flen, end);
-            file.close();
-        } else {
-            Utilities::LOG_ERROR("Failed to open file for reading");
+        if (&fs == &SD && !initialized) return false;
+
+        // Held throughout: the frames pushed as bus load go straight to the display under it
+        SPILease lease(SPIDevice::SD, SPIPriority::NORMAL, &fs == &SD);
+
+        // Staged writes landing halfway through would show up in the timings
+        flushJournal(fs);
+        if (!fs.exists(directory) && !fs.mkdir(directory)) 
+        {
+            Utilities::LOG_ERROR("Benchmark directory unavailable: %s", directory);
+            return false;
         }
 
-        file = fs.open(path, FILE_WRITE);
-        if(!file){
-            Utilities::LOG_ERROR("Failed to open file for writing");
-            return;
+        bool psram = psramFound();
+        uint32_t bufferSize = psram ? StorageBenchmark::MAX_BLOCK : BENCHMARK_HEAP_BUFFER;
+        uint8_t* buffer = static_cast<uint8_t*>(psram ? ps_malloc(bufferSize) : malloc(bufferSize));
+        if (buffer == nullptr) 
+        {
+            Utilities::LOG_ERROR("No memory for a %u byte benchmark buffer", bufferSize);
+            return false;
         }
 
-        size_t i;
-        start = millis();
-        for(i=0; i<2048; i++){
-            file.write(buf, 512);
+        // Same callbacks as the SD stores, pointed at whichever filesystem is measured
+        StorageBackend storage = SD_STORAGE;
+        storage.context = &fs;
+        BenchmarkSink sink = { &fs, csvPath };
+        BenchmarkHooks hooks = 
+        {
+            benchmarkMicros, listBenchmarkDirectory,
+            &fs == &SD ? pushBenchmarkFrame : nullptr,      // The display shares the SD card's SPI bus
+            emitBenchmarkRow, &sink
+        };
+
+        StorageBenchmark benchmark(storage, hooks, buffer, bufferSize);
+        benchmark.setLabel(&fs == &SD ? "sd" : "spiffs");
+        if (&fs != &SD) 
+        {
+            benchmark.setFileBytes(FLASH_BENCHMARK_BYTES);
         }
-        end = millis() - start;
-        Utilities::LOG_DEBUG("%u bytes written for %lu ms\n", 2048 * 512, end);
-        file.close();
-        delete[] buf;
+
+        uint32_t start = millis();
+        uint16_t failures = benchmark.run(directory);
+        free(buffer);
+        flushJournal(SD);
+
+        Utilities::LOG_DEBUG("Storage benchmark finished in %lu ms, %u failed tests", millis() - start, failures);
+        return failures == 0;
     }
 
     void SDManager::init(uint8_t cs) 
     {
-        if (!SD.begin(cs)) 
+        // Mounting, the usage scan and opening the stores all talk to the card
+        SPILease lease(SPIDevice::SD, SPIPriority::NORMAL);
+
+        // The card's clock as registered with the bus; the library's 4 MHz default before that
+        uint32_t clockHz = SPIManager::isInitialized() ? SPIManager::getDevice(SPIDevice::SD).clockHz : 4000000;
+        if (!SD.begin(cs, SPI, clockHz)) 
         {
             Utilities::LOG_ERROR("Memory pathway initialization failed");
             return;
@@ -215,10 +308,20 @@ namespace PrefrontalCortex
             return;
         }
 
-        // Initialize memory capacity metrics
-        cardSize = SD.cardSize() / (1024 * 1024);
-        totalSpace = SD.totalBytes() / (1024 * 1024);
-        usedSpace = SD.usedBytes() / (1024 * 1024);
+        // The only full usage scan until storage has changed and gone quiet
+        usage.mount(SD.cardSize(), millis());
+        StorageUsageSnapshot capacity = usage.snapshot();
+
+        // A saved index is trusted only if it was sealed at exactly this usage
+        uint32_t indexCapacity = psramFound() ? FILE_INDEX_PSRAM : FILE_INDEX_HEAP;
+        if (!fileIndex.open(FILE_INDEX, "/", indexCapacity, capacity.usedKB)) 
+        {
+            Utilities::LOG_ERROR("File index unavailable: %s", FILE_INDEX);
+        }
+        else if (!fileIndex.isReady()) 
+        {
+            Utilities::LOG_DEBUG("File index stale, rebuilding in the background");
+        }
 
         const char* cardTypeStr = 
             cardType == CARD_MMC ? "MMC" :
@@ -226,19 +329,148 @@ namespace PrefrontalCortex
             cardType == CARD_SDHC ? "SDHC" : "UNKNOWN";
         
         Utilities::LOG_DEBUG("SD Card Type: %s", cardTypeStr);
-        Utilities::LOG_DEBUG("SD Card Size: %llu MB", cardSize);
-        Utilities::LOG_DEBUG("Total space: %llu MB", totalSpace);
-        Utilities::LOG_DEBUG("Used space: %llu MB", usedSpace);
+        Utilities::LOG_DEBUG("SD Card Size: %u MB", capacity.cardKB / 1024);
+        Utilities::LOG_DEBUG("Total space: %u MB", capacity.totalKB / 1024);
+        Utilities::LOG_DEBUG("Used space: %u MB", capacity.usedKB / 1024);
         
         initialized = true;
         Utilities::LOG_DEBUG("Memory pathways initialized successfully");
         
         // Ensure experiential memory structure exists
         ensureNFCFolderExists();
+
+        size_t bloomBytes = psramFound() ? SCAN_BLOOM_PSRAM : SCAN_BLOOM_HEAP;
+        if (scanIndex.open(SCANNED_CARDS_FILE, SCANNED_CARDS_LOG, bloomBytes)) 
+        {
+            CardScanStats stats = scanIndex.stats();
+            Utilities::LOG_DEBUG("Scan history: %u cards in %u buckets", stats.entries, stats.buckets);
+        }
+        else 
+        {
+            Utilities::LOG_ERROR("Scan history unavailable: %s", SCANNED_CARDS_FILE);
+        }
+
+        // Replays anything a reset cut off before it reached its file
+        if (journal.open(JOURNAL_FILE)) 
+        {
+            JournalStats stats = journal.stats();
+            if (stats.replayedRecords > 0 || stats.rejectedRecords > 0) 
+            {
+                Utilities::LOG_DEBUG("Write journal: %u records replayed, %u torn records dropped", 
+                    stats.replayedRecords, stats.rejectedRecords);
+            }
+        }
+        else 
+        {
+            Utilities::LOG_ERROR("Write journal unavailable, writing files directly: %s", JOURNAL_FILE);
+        }
+
+        if ((SD.exists(SETTINGS_FOLDER) || SD.mkdir(SETTINGS_FOLDER)) && settings.open(SETTINGS_FOLDER)) 
+        {
+            KeyValueStats stats = settings.stats();
+            Utilities::LOG_DEBUG("Settings: %u keys, generation %u", stats.keys, stats.generation);
+        }
+        else 
+        {
+            Utilities::LOG_ERROR("Settings unavailable: %s", SETTINGS_FOLDER);
+        }
+
+        // Just above the recording writer, so a queued capture block is written before the next fills
+        if (workerTaskHandle == nullptr) 
+        {
+            xTaskCreatePinnedToCore(workerTask, "StorageIO", 4096, NULL, 4, &workerTaskHandle, 1);
+        }
+    }
+
+    uint32_t SDManager::submit(const StorageRequest& request) 
+    {
+        if (!initialized || workerTaskHandle == nullptr) return 0;
+        return worker.submit(request);
+    }
+
+    uint32_t SDManager::getSetting(const char* key, uint32_t fallback) 
+    {
+        return settings.getUInt(key, fallback);
+    }
+
+    void SDManager::putSetting(const char* key, uint32_t value) 
+    {
+        if (settings.isOpen() && !settings.setUInt(key, value, millis())) 
+        {
+            Utilities::LOG_ERROR("Setting not stored: %s", key);
+        }
+    }
+
+    void SDManager::update() 
+    {
+        if (initialized) 
+        {
+            worker.poll();
+
+            // One lease for a round of upkeep, rather than the main loop touching the card unannounced every pass
+            if (millis() - lastMaintenance < MAINTENANCE_MS) return;
+            lastMaintenance = millis();
+            SPILease lease(SPIDevice::SD, SPIPriority::NORMAL);
+            journal.update(millis());
+            settings.update(millis());
+            fileIndex.update(millis(), FILE_INDEX_BUDGET);
+        }
+    }
+
+    void SDManager::prepareForSleep() 
+    {
+        if (!initialized) return;
+
+        for (uint32_t waited = 0; !worker.idle() && waited < WORKER_DRAIN_MS; waited += 5) 
+        {
+            vTaskDelay(pdMS_TO_TICKS(5));
+        }
+        worker.poll();
+
+        // Only after the drain: the worker needs the bus to finish
+        SPILease lease(SPIDevice::SD, SPIPriority::NORMAL);
+        if (!journal.flush()) 
+        {
+            Utilities::LOG_ERROR("Write journal flush failed; replaying on next boot");
+        }
+        if (!settings.flush()) 
+        {
+            Utilities::LOG_ERROR("Settings flush failed");
+        }
+        flushCardScans();
+
+        // Last, so the usage it is sealed with includes everything above
+        fileIndex.update(millis(), 0);
+        if (!fileIndex.flush() || !fileIndex.seal(static_cast<uint32_t>(SD.usedBytes() / 1024))) 
+        {
+            Utilities::LOG_ERROR("File index not sealed; rebuilding on next boot");
+        }
+    }
+
+    bool SDManager::findFile(const char* path, FileIndexEntry& entry) 
+    {
+        return initialized && fileIndex.find(path, entry);
+    }
+
+    uint32_t SDManager::countFiles(const char* directory, FileKind kind) 
+    {
+        return initialized ? fileIndex.count(directory, kind) : 0;
+    }
+
+    void SDManager::flushJournal(fs::FS &fs, const char *path) 
+    {
+        if (&fs != &SD) return;
+
+        bool pending = path ? journal.hasPending(path) : journal.hasPending();
+        if (pending && !journal.flush()) 
+        {
+            Utilities::LOG_ERROR("Write journal flush failed");
+        }
     }
 
     void SDManager::ensureNFCFolderExists() 
     {
+        SPILease lease(SPIDevice::SD, SPIPriority::NORMAL);
         if (!SD.exists(NFC_FOLDER)) {
             SD.mkdir(NFC_FOLDER);
         }
@@ -246,45 +478,348 @@ namespace PrefrontalCortex
 
     bool SDManager::hasCardBeenScanned(uint32_t cardId) 
     {
-        return false;
-        /*
         if (!initialized) return false;
-        
-        File file = SD.open(SCANNED_CARDS_FILE, FILE_READ);
-        if (!file) return false;
-        
-        uint32_t storedId;
-        bool found = false;
-        
-        while (file.available() >= sizeof(uint32_t)) {
-            file.read((uint8_t*)&storedId, sizeof(uint32_t));
-            if (storedId == cardId) {
-                found = true;
-                break;
-            }
-        }
-        
-        file.close();
-        return found;
-        */
+        SPILease lease(SPIDevice::SD, SPIPriority::NORMAL);
+        return scanIndex.contains(cardId);
     }
 
     void SDManager::recordCardScan(uint32_t cardId) 
     {
-        return;
-        /*
         if (!initialized) return;
-        
-        ensureNFCFolderExists();
-        
-        File file = SD.open(SCANNED_CARDS_FILE, FILE_APPEND);
-        if (!file) {
-            Utilities::LOG_ERROR("Failed to open scanned cards file for writing");
+
+        SPILease lease(SPIDevice::SD, SPIPriority::NORMAL);
+        if (scanIndex.record(cardId)) 
+        {
+            Utilities::LOG_DEBUG("First scan of card %08X", cardId);
+        }
+    }
+
+    void SDManager::flushCardScans() 
+    {
+        if (!initialized) return;
+
+        SPILease lease(SPIDevice::SD, SPIPriority::NORMAL);
+        if (!scanIndex.checkpoint()) 
+        {
+            Utilities::LOG_ERROR("Scan history merge failed");
+        }
+    }
+
+    StorageBackend::Handle SDManager::openStorageFile(void* context, const char* path, bool create) 
+    {
+        // Each call leases the bus itself, unless it is part of a caller's lease already
+        SPILease lease(SPIDevice::SD, SPIPriority::NORMAL, context == &SD);
+        fs::FS& fs = *static_cast<fs::FS*>(context);
+        const char* mode = fs.exists(path) ? "r+" : (create ? "w+" : nullptr);
+        if (mode == nullptr) return nullptr;
+
+        File file = fs.open(path, mode);
+        if (!file) return nullptr;
+
+        StorageFile* handle = new StorageFile{ file, static_cast<uint32_t>(file.size()), false, "" };
+        size_t pathLength = strlen(path);
+        if (pathLength < sizeof(handle->path)) 
+        {
+            memcpy(handle->path, path, pathLength + 1);
+        }
+        return handle;
+    }
+
+    void SDManager::closeStorageFile(void* context, StorageBackend::Handle file) 
+    {
+        SPILease lease(SPIDevice::SD, SPIPriority::NORMAL, context == &SD);
+        StorageFile* handle = static_cast<StorageFile*>(file);
+        handle->file.close();
+
+        // One note per handle rather than per write; the size is already known
+        if (handle->written && context == &SD && handle->path[0] != '\0') 
+        {
+            fileIndex.noteWritten(handle->path, handle->size, static_cast<uint32_t>(time(nullptr)), false);
+        }
+        delete handle;
+    }
+
+    size_t SDManager::readStorageFile(void* context, StorageBackend::Handle file, uint32_t offset, uint8_t* data, size_t length) 
+    {
+        SPILease lease(SPIDevice::SD, SPIPriority::NORMAL, context == &SD);
+        File& handle = static_cast<StorageFile*>(file)->file;
+        if (!handle.seek(offset)) return 0;
+        return handle.read(data, length);
+    }
+
+    size_t SDManager::writeStorageFile(void* context, StorageBackend::Handle file, uint32_t offset, const uint8_t* data, size_t length) 
+    {
+        SPILease lease(SPIDevice::SD, SPIPriority::NORMAL, context == &SD);
+        StorageFile* handle = static_cast<StorageFile*>(file);
+        if (!handle->file.seek(offset)) return 0;
+        size_t written = handle->file.write(data, length);
+        handle->written |= written > 0;
+
+        // Tracked here rather than asked of the file: size() flushes and stats
+        uint32_t end = offset + written;
+        if (end > handle->size) 
+        {
+            if (context == &SD) usage.recordDelta(end - handle->size);
+            handle->size = end;
+        }
+        return written;
+    }
+
+    uint32_t SDManager::storageFileSize(void* context, StorageBackend::Handle file) 
+    {
+        SPILease lease(SPIDevice::SD, SPIPriority::NORMAL, context == &SD);
+        return static_cast<StorageFile*>(file)->file.size();
+    }
+
+    bool SDManager::syncStorageFile(void* context, StorageBackend::Handle file) 
+    {
+        SPILease lease(SPIDevice::SD, SPIPriority::NORMAL, context == &SD);
+        static_cast<StorageFile*>(file)->file.flush();
+        return true;
+    }
+
+    bool SDManager::storageExists(void* context, const char* path) 
+    {
+        SPILease lease(SPIDevice::SD, SPIPriority::NORMAL, context == &SD);
+        return static_cast<fs::FS*>(context)->exists(path);
+    }
+
+    bool SDManager::removeStorageFile(void* context, const char* path) 
+    {
+        SPILease lease(SPIDevice::SD, SPIPriority::NORMAL, context == &SD);
+        return removeCounted(*static_cast<fs::FS*>(context), path);
+    }
+
+    bool SDManager::removeCounted(fs::FS &fs, const char *path) 
+    {
+        uint32_t size = 0;
+        if (&fs == &SD) 
+        {
+            File file = fs.open(path);
+            if (file && !file.isDirectory()) size = file.size();
+        }
+        if (!fs.remove(path)) return false;
+
+        if (&fs == &SD) 
+        {
+            usage.recordDelta(-static_cast<int32_t>(size));
+            fileIndex.noteRemoved(path);
+        }
+        return true;
+    }
+
+    bool SDManager::measureCard(void* context, uint64_t* totalBytes, uint64_t* usedBytes) 
+    {
+        SPILease lease(SPIDevice::SD, SPIPriority::NORMAL);
+        *totalBytes = SD.totalBytes();
+        *usedBytes = SD.usedBytes();
+        return *totalBytes > 0;
+    }
+
+    bool SDManager::renameStorageFile(void* context, const char* from, const char* to) 
+    {
+        SPILease lease(SPIDevice::SD, SPIPriority::NORMAL, context == &SD);
+        fs::FS& fs = *static_cast<fs::FS*>(context);
+        if (!fs.rename(from, to)) return false;
+
+        if (&fs == &SD) fileIndex.noteRemoved(from);
+        noteFile(fs, to);
+        return true;
+    }
+
+    void SDManager::noteFile(fs::FS &fs, const char *path) 
+    {
+        if (&fs != &SD) return;
+
+        // Straight to the VFS: fs.open() on a directory would allocate a File just to stat it
+        char fullPath[DirectoryWalker::PATH_LENGTH + 8];
+        struct stat info;
+        snprintf(fullPath, sizeof(fullPath), "%s%s", SD_MOUNT, path);
+        if (stat(fullPath, &info) == 0) 
+        {
+            fileIndex.noteWritten(path, static_cast<uint32_t>(info.st_size), static_cast<uint32_t>(info.st_mtime), S_ISDIR(info.st_mode));
+        }
+        else 
+        {
+            fileIndex.noteRemoved(path);
+        }
+    }
+
+    void SDManager::workerTask(void* parameter) 
+    {
+        while (true) 
+        {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(WORKER_IDLE_MS));
+
+            // A lease per request, so a display push in progress waits one request, not the backlog
+            bool worked = true;
+            while (worked) 
+            {
+                bool leased = SPIManager::acquire(SPIDevice::SD, SPIPriority::NORMAL);
+                worked = worker.processOne();
+                if (worked) lastStorageActivity = millis();
+
+                // Usage is published from here, so a rescan can only ever delay queued requests
+                if (!worked) usage.update(millis(), lastStorageActivity);
+                if (leased) SPIManager::release();
+            }
+        }
+    }
+
+    uint32_t SDManager::workerMicros(void* context) 
+    {
+        return micros();
+    }
+
+    int32_t SDManager::listWorkerDirectory(void* context, const char* path, char* out, uint32_t length, uint32_t* used) 
+    {
+        *used = 0;
+        DirectoryWalker walker(directoriesFor(*static_cast<fs::FS*>(context)));
+        if (!walker.open(path, 1)) return -1;
+
+        int32_t entries = 0;
+        WalkEntry entry;
+        while (walker.next(entry)) 
+        {
+            // Names that no longer fit are counted but not copied
+            size_t nameLength = strlen(entry.name);
+            if (*used + nameLength + 1 <= length) 
+            {
+                memcpy(out + *used, entry.name, nameLength);
+                out[*used + nameLength] = '\n';
+                *used += nameLength + 1;
+            }
+            entries++;
+        }
+        return entries;
+    }
+
+    void SDManager::wakeWorker(void* context) 
+    {
+        if (workerTaskHandle) 
+        {
+            xTaskNotifyGive(workerTaskHandle);
+        }
+    }
+
+    uint32_t SDManager::benchmarkMicros(void* context) 
+    {
+        return micros();
+    }
+
+    uint32_t SDManager::listBenchmarkDirectory(void* context, const char* path) 
+    {
+        DirectoryWalker walker(directoriesFor(*static_cast<BenchmarkSink*>(context)->fs));
+        if (!walker.open(path, 1)) return 0;
+
+        uint32_t entries = 0;
+        WalkEntry entry;
+        while (walker.next(entry)) 
+        {
+            entries++;
+        }
+        return entries;
+    }
+
+    void SDManager::pushBenchmarkFrame(void* context) 
+    {
+        if (VC::RoverViewManager::isInitialized()) 
+        {
+            VC::RoverViewManager::pushSprite();
+        }
+    }
+
+    void SDManager::emitBenchmarkRow(void* context, const char* line) 
+    {
+        const char* csvPath = static_cast<BenchmarkSink*>(context)->csvPath;
+        if (csvPath == nullptr || !initialized) 
+        {
+            Serial.println(line);
             return;
         }
-        
-        file.write((uint8_t*)&cardId, sizeof(uint32_t));
-        file.close();
-        */
-    } 
-}
\ No newline at end of file
+
+        char row[160];
+        snprintf(row, sizeof(row), "%s\n", line);
+        appendFile(SD, csvPath, row);
+    }
+
+    void* SDManager::allocateIndex(size_t bytes) 
+    {
+        // The Bloom filter is the only large block; keep it out of internal RAM when possible
+        return psramFound() ? ps_malloc(bytes) : malloc(bytes);
+    }
+
+    DirectoryBackend SDManager::directoriesFor(fs::FS &fs) 
+    {
+        DirectoryBackend directories = SD_DIRECTORIES;
+        if (&fs == &SPIFFS) directories.context = const_cast<char*>(SPIFFS_MOUNT);
+        return directories;
+    }
+
+    DirectoryBackend::Handle SDManager::openDirectory(void* context, const char* path) 
+    {
+        DirectoryHandle* handle = new DirectoryHandle;
+        int written = snprintf(handle->path, sizeof(handle->path), "%s%s", static_cast<const char*>(context), path);
+        handle->directory = written > 0 && written < static_cast<int>(sizeof(handle->path)) ? opendir(handle->path) : nullptr;
+        if (handle->directory == nullptr) 
+        {
+            delete handle;
+            return nullptr;
+        }
+        return handle;
+    }
+
+    bool SDManager::nextDirectoryEntry(void* context, DirectoryBackend::Handle directory, DirectoryEntry* entry, bool details) 
+    {
+        DirectoryHandle* handle = static_cast<DirectoryHandle*>(directory);
+        struct dirent* found;
+        do 
+        {
+            found = readdir(handle->directory);
+        } while (found && (strcmp(found->d_name, ".") == 0 || strcmp(found->d_name, "..") == 0));
+        if (found == nullptr) return false;
+
+        size_t nameLength = strlen(found->d_name);
+        if (nameLength >= sizeof(entry->name)) nameLength = 0;
+        memcpy(entry->name, found->d_name, nameLength);
+        entry->name[nameLength] = '\0';
+        entry->isDirectory = found->d_type == DT_DIR;
+        entry->size = 0;
+        entry->modified = 0;
+
+        // readdir() has the type but not the size; the stat costs a directory lookup per entry
+        if (details && nameLength > 0) 
+        {
+            char fullPath[sizeof(handle->path) + DirectoryEntry::NAME_LENGTH + 1];
+            size_t baseLength = strlen(handle->path);
+            const char* separator = baseLength > 0 && handle->path[baseLength - 1] == '/' ? "" : "/";
+            snprintf(fullPath, sizeof(fullPath), "%s%s%s", handle->path, separator, entry->name);
+
+            struct stat info;
+            if (stat(fullPath, &info) == 0) 
+            {
+                entry->size = static_cast<uint32_t>(info.st_size);
+                entry->modified = static_cast<uint32_t>(info.st_mtime);
+                entry->isDirectory = S_ISDIR(info.st_mode);
+            }
+        }
+        return true;
+    }
+
+    uint32_t SDManager::tellDirectory(void* context, DirectoryBackend::Handle directory) 
+    {
+        return static_cast<uint32_t>(telldir(static_cast<DirectoryHandle*>(directory)->directory));
+    }
+
+    void SDManager::seekDirectory(void* context, DirectoryBackend::Handle directory, uint32_t position) 
+    {
+        seekdir(static_cast<DirectoryHandle*>(directory)->directory, position);
+    }
+
+    void SDManager::closeDirectory(void* context, DirectoryBackend::Handle directory) 
+    {
+        DirectoryHandle* handle = static_cast<DirectoryHandle*>(directory);
+        closedir(handle->directory);
+        delete handle;
+    }
+}
@@ -3,12 +3,21 @@
 
 #include "Utilities.h"
 #include "ProtoPerceptions.h"
+#include "CardScanIndex.h"
+#include "WriteJournal.h"
+#include "StorageBenchmark.h"
+#include "KeyValueStore.h"
+#include "StorageWorker.h"
+#include "StorageUsage.h"
+#include "DirectoryWalker.h"
+#include "FileIndex.h"
 #include "../CorpusCallosum/SynapticPathways.h"
 #include <SD.h>
 #include <SPIFFS.h>
 #include <Arduino.h>
 #include "FS.h"
 #include <SPI.h>
+#include <dirent.h>
 #include "../VisualCortex/LEDManager.h"
 #include "../VisualCortex/RoverManager.h"
 #include "../PrefrontalCortex/RoverBehaviorManager.h"
@@ -41,14 +50,87 @@ namespace PrefrontalCortex
         static void appendFile(fs::FS &fs, const char *path, const char *message);
         static void renameFile(fs::FS &fs, const char *path1, const char *path2);
         static void deleteFile(fs::FS &fs, const char *path);
-        static void testFileIO(fs::FS &fs, const char *path);
+
+        /**
+         * @brief Run the storage benchmark suite on SD or SPIFFS inside a scratch directory
+         * @param csvPath SD file to append the CSV rows to; nullptr prints them to serial
+         * @return true if every test completed
+         */
+        static bool runBenchmark(fs::FS &fs, const char *directory, const char *csvPath = nullptr);
         static bool isInitialized() { return initialized; }
 
+        /**
+         * @brief Flush journaled writes that have waited long enough; call from the main loop
+         */
+        static void update();
+
+        /**
+         * @brief Commit journaled writes and scan history before power goes away
+         */
+        static void prepareForSleep();
+        static JournalStats getJournalStats() { return journal.stats(); }
+
+        /**
+         * @brief Persistent settings and counters, read from RAM and written in batches
+         * @return fallback when the card or the key is missing
+         */
+        static uint32_t getSetting(const char* key, uint32_t fallback);
+        static void putSetting(const char* key, uint32_t value);
+        static KeyValueStats getSettingsStats() { return settings.stats(); }
+
+        /**
+         * @brief Queue a request for the storage task; callbacks run from update()
+         * @return Request id, or 0 if the card is missing or the queue is full
+         */
+        static uint32_t submit(const StorageRequest& request);
+        static StorageWorkerStats getWorkerStats() { return worker.stats(); }
+
+        /**
+         * @brief The card as a StorageBackend; growth and removals through it update usage
+         *
+         * Each call takes the SPI bus unless the caller holds an SD lease; take one
+         * around a run of calls rather than paying for a lease per call.
+         */
+        static const StorageBackend& getStorage() { return SD_STORAGE; }
+
+        /**
+         * @brief Capacity and usage, lock-free; revision changes only when a value does
+         */
+        static StorageUsageSnapshot getUsage() { return usage.snapshot(); }
+
+        /**
+         * @brief Size and kind of a card file from the file index, without touching the card; main loop only
+         * @return false if the path is unknown or the index is still being built
+         */
+        static bool findFile(const char* path, FileIndexEntry& entry);
+        static uint32_t countFiles(const char* directory, FileKind kind);
+        static FileIndexStats getFileIndexStats() { return fileIndex.stats(); }
+
+        /**
+         * @brief The card's directories for a DirectoryWalker
+         */
+        static const DirectoryBackend& getDirectories() { return SD_DIRECTORIES; }
+
+        // Setting keys
+        static const char* SETTING_EXPERIENCE;
+        static const char* SETTING_LEVEL;
+        static const char* SETTING_TOTAL_SCANS;
+        static const char* SETTING_VOLUME;
+        static const char* SETTING_LED_MODE;
+        static const char* SETTING_FESTIVE_THEME;
+        static const char* SETTING_ENCODING_MODE;
+
         // Experiential memory management
         static void ensureNFCFolderExists();
         static bool hasCardBeenScanned(uint32_t cardId);
         static void recordCardScan(uint32_t cardId);
 
+        /**
+         * @brief Merge logged scans into the index; call before power goes away
+         */
+        static void flushCardScans();
+        static CardScanStats getCardScanStats() { return scanIndex.stats(); }
+
         // Memory capacity assessment
         static uint64_t getCardSize();
         static uint64_t getTotalSpace();
@@ -60,9 +142,100 @@ namespace PrefrontalCortex
         static uint8_t cardType;
         static const char* NFC_FOLDER;
         static const char* SCANNED_CARDS_FILE;
-        static uint64_t cardSize;
-        static uint64_t totalSpace;
-        static uint64_t usedSpace;
+        static const char* SCANNED_CARDS_LOG;
+        static const size_t SCAN_BLOOM_PSRAM = 128 * 1024;  // ~1% false positives at 100k cards
+        static const size_t SCAN_BLOOM_HEAP = 8 * 1024;     // Same at ~7k cards
+        static CardScanIndex scanIndex;
+        static const char* JOURNAL_FILE;
+        static WriteJournal journal;                        // Batches appendFile/writeFile on SD
+        static const char* SETTINGS_FOLDER;
+        static KeyValueStore settings;
+        static StorageWorker worker;                        // Runs submit()ted requests on workerTaskHandle
+        static TaskHandle_t workerTaskHandle;
+        static const uint32_t WORKER_IDLE_MS = 100;
+        static const uint32_t WORKER_DRAIN_MS = 500;        // Longest prepareForSleep() waits for the queue
+        static StorageUsage usage;                          // Published from workerTaskHandle
+        static uint32_t lastStorageActivity;
+        static const char* FILE_INDEX;
+        static const uint32_t FILE_INDEX_PSRAM = 16384;     // Entries; 24 bytes each
+        static const uint32_t FILE_INDEX_HEAP = 1024;
+        static const uint32_t MAINTENANCE_MS = 20;          // Between update()'s leased journal/settings/index rounds
+        static uint32_t lastMaintenance;
+        static const uint32_t FILE_INDEX_BUDGET = 64;       // Entries walked per round while rebuilding
+        static FileIndex fileIndex;                         // Noted by the backends below; updated from update()
+
+        /**
+         * @brief StorageBackend over an fs::FS (the context); handles are heap-allocated StorageFiles
+         */
+        struct StorageFile 
+        {
+            File file;
+            uint32_t size;          // As written through this handle, for usage deltas
+            bool written;
+            char path[DirectoryWalker::PATH_LENGTH];    // Empty if too long to index
+        };
+        static StorageBackend::Handle openStorageFile(void* context, const char* path, bool create);
+        static void closeStorageFile(void* context, StorageBackend::Handle file);
+        static size_t readStorageFile(void* context, StorageBackend::Handle file, uint32_t offset, uint8_t* data, size_t length);
+        static size_t writeStorageFile(void* context, StorageBackend::Handle file, uint32_t offset, const uint8_t* data, size_t length);
+        static uint32_t storageFileSize(void* context, StorageBackend::Handle file);
+        static bool syncStorageFile(void* context, StorageBackend::Handle file);
+        static bool storageExists(void* context, const char* path);
+        static bool removeStorageFile(void* context, const char* path);
+        static bool renameStorageFile(void* context, const char* from, const char* to);
+        static void* allocateIndex(size_t bytes);
+        static bool measureCard(void* context, uint64_t* totalBytes, uint64_t* usedBytes);
+        static bool removeCounted(fs::FS &fs, const char *path);
+        static const StorageUsageHooks USAGE_HOOKS;
+        static void noteFile(fs::FS &fs, const char *path);
+
+        /**
+         * @brief DirectoryBackend over the VFS; the context is the mount point
+         */
+        struct DirectoryHandle 
+        {
+            DIR* directory;
+            char path[DirectoryWalker::PATH_LENGTH + 8];
+        };
+        static const char* SD_MOUNT;
+        static const char* SPIFFS_MOUNT;
+        static DirectoryBackend::Handle openDirectory(void* context, const char* path);
+        static bool nextDirectoryEntry(void* context, DirectoryBackend::Handle directory, DirectoryEntry* entry, bool details);
+        static uint32_t tellDirectory(void* context, DirectoryBackend::Handle directory);
+        static void seekDirectory(void* context, DirectoryBackend::Handle directory, uint32_t position);
+        static void closeDirectory(void* context, DirectoryBackend::Handle directory);
+        static DirectoryBackend directoriesFor(fs::FS &fs);
+        static const DirectoryBackend SD_DIRECTORIES;
+
+        /**
+         * @brief Storage task and StorageWorker hooks
+         */
+        static void workerTask(void* parameter);
+        static uint32_t workerMicros(void* context);
+        static int32_t listWorkerDirectory(void* context, const char* path, char* out, uint32_t length, uint32_t* used);
+        static void wakeWorker(void* context);
+        static const StorageWorkerHooks WORKER_HOOKS;
+
+        /**
+         * @brief StorageBenchmark hooks; the context is a BenchmarkSink
+         */
+        struct BenchmarkSink 
+        {
+            fs::FS* fs;
+            const char* csvPath;
+        };
+        static const uint32_t BENCHMARK_HEAP_BUFFER = 16 * 1024;     // Largest block tested without PSRAM
+        static const uint32_t FLASH_BENCHMARK_BYTES = 256 * 1024;    // SPIFFS partitions are small
+        static uint32_t benchmarkMicros(void* context);
+        static uint32_t listBenchmarkDirectory(void* context, const char* path);
+        static void pushBenchmarkFrame(void* context);
+        static void emitBenchmarkRow(void* context, const char* line);
+
+        /**
+         * @brief Apply journaled writes before a path (or, with none, anything) is read directly
+         */
+        static void flushJournal(fs::FS &fs, const char *path = nullptr);
+        static const StorageBackend SD_STORAGE;
     };
 }
 
@@ -0,0 +1,282 @@
+/**
+ * @file SPIArbiter.cpp
+ * @brief Chunked, prioritised scheduling of a shared SPI bus
+ */
+
+#include "SPIArbiter.h"
+#include <string.h>
+
+namespace PrefrontalCortex
+{
+    SPIArbiter::SPIArbiter(const SPIBusHooks& hooks)
+        : m_hooks(hooks)
+        , m_deviceCount(0)
+        , m_nextId(0)
+        , m_submitted(0)
+        , m_rejected(0)
+        , m_busTask(nullptr)
+        , m_leaseHolder(nullptr)
+        , m_configured(NO_DEVICE)
+        , m_lastLevel(-1)
+        , m_lastMicros(0)
+        , m_clockStarted(false)
+        , m_busy(false)
+    {
+        memset(m_devices, 0, sizeof(m_devices));
+        memset(m_active, 0, sizeof(m_active));
+        memset(m_bypassed, 0, sizeof(m_bypassed));
+        memset(&m_stats, 0, sizeof(m_stats));
+        m_published.store(m_stats);
+    }
+
+    uint8_t SPIArbiter::addDevice(const SPIDeviceConfig& device)
+    {
+        if (m_deviceCount >= SPIBusStats::MAX_DEVICES)
+        {
+            return NO_DEVICE;
+        }
+        m_devices[m_deviceCount] = device;
+        return m_deviceCount++;
+    }
+
+    SPITransaction SPIArbiter::makeTransaction(uint8_t device, SPIPriority priority, uint32_t length)
+    {
+        SPITransaction transaction;
+        memset(&transaction, 0, sizeof(transaction));
+        transaction.device = device;
+        transaction.priority = priority;
+        transaction.length = length;
+        return transaction;
+    }
+
+    uint32_t SPIArbiter::submit(const SPITransaction& transaction)
+    {
+        uint8_t priority = static_cast<uint8_t>(transaction.priority);
+        bool runnable = transaction.step != nullptr || m_hooks.transfer != nullptr;
+        if (priority >= PRIORITIES || transaction.device >= m_deviceCount || transaction.length == 0 || !runnable)
+        {
+            m_rejected.fetch_add(1, std::memory_order_relaxed);
+            return 0;
+        }
+
+        SPITransaction queued = transaction;
+        do
+        {
+            queued.id = m_nextId.fetch_add(1, std::memory_order_relaxed) + 1;
+        } while (queued.id == 0);
+        queued.submittedMicros = now();
+        if (queued.future)
+        {
+            queued.future->done.store(false, std::memory_order_relaxed);
+        }
+
+        if (!m_queues[priority].push(queued))
+        {
+            m_rejected.fetch_add(1, std::memory_order_relaxed);
+            return 0;
+        }
+
+        m_submitted.fetch_add(1, std::memory_order_relaxed);
+        if (m_hooks.wake)
+        {
+            m_hooks.wake(m_hooks.context);
+        }
+        return queued.id;
+    }
+
+    bool SPIArbiter::processOne()
+    {
+        m_busy.store(true, std::memory_order_relaxed);
+        tick();
+
+        uint8_t level;
+        if (!pick(level))
+        {
+            publish();
+            m_busy.store(false, std::memory_order_release);
+            return false;
+        }
+
+        // Overtaking a transaction part-way through is what chunking is for
+        if (m_lastLevel > static_cast<int8_t>(level) && m_active[m_lastLevel].running)
+        {
+            m_stats.preemptions++;
+        }
+        m_lastLevel = static_cast<int8_t>(level);
+
+        Active& active = m_active[level];
+        SPITransaction& transaction = active.transaction;
+        const SPIDeviceConfig& device = m_devices[transaction.device];
+        if (transaction.device != m_configured)
+        {
+            if (m_hooks.configure) m_hooks.configure(m_hooks.context, device);
+            m_configured = transaction.device;
+            m_stats.reconfigurations++;
+        }
+
+        uint32_t remaining = transaction.length - active.offset;
+        uint32_t length = transaction.chunk > 0 && transaction.chunk < remaining ? transaction.chunk : remaining;
+
+        uint32_t start = now();
+        if (!active.running)
+        {
+            active.running = true;
+            active.startedMicros = start;
+            uint32_t queued = start - transaction.submittedMicros;
+            if (queued > m_stats.maxQueuedMicros[level]) m_stats.maxQueuedMicros[level] = queued;
+        }
+
+        bool ok;
+        if (transaction.step)
+        {
+            ok = transaction.step(transaction.context, active.offset, length);
+        }
+        else
+        {
+            m_hooks.select(m_hooks.context, device, true);
+            ok = m_hooks.transfer(m_hooks.context,
+                                  transaction.tx ? transaction.tx + active.offset : nullptr,
+                                  transaction.rx ? transaction.rx + active.offset : nullptr,
+                                  length);
+            m_hooks.select(m_hooks.context, device, false);
+        }
+        uint32_t elapsed = now() - start;
+
+        SPIDeviceStats& counters = m_stats.devices[transaction.device];
+        counters.chunks++;
+        counters.busyMicros += elapsed;
+        if (!transaction.step && ok) counters.bytes += length;
+        m_stats.busyMicros += elapsed;
+        if (elapsed > m_stats.maxChunkMicros) m_stats.maxChunkMicros = elapsed;
+
+        active.chunks++;
+        if (ok) active.offset += length;
+        if (!ok || active.offset >= transaction.length)
+        {
+            complete(active, ok);
+        }
+
+        tick();
+        publish();
+        return true;
+    }
+
+    bool SPIArbiter::idle() const
+    {
+        for (uint8_t i = 0; i < PRIORITIES; i++)
+        {
+            if (!m_queues[i].empty()) return false;
+        }
+        return !m_busy.load(std::memory_order_acquire);
+    }
+
+    bool SPIArbiter::canWait(TaskId task) const
+    {
+        return task != nullptr && task != m_busTask.load(std::memory_order_acquire) &&
+               task != m_leaseHolder.load(std::memory_order_acquire);
+    }
+
+    bool SPIArbiter::beginLease(TaskId task)
+    {
+        TaskId expected = nullptr;
+        return task != nullptr && m_leaseHolder.compare_exchange_strong(expected, task, std::memory_order_acq_rel);
+    }
+
+    void SPIArbiter::endLease(TaskId task)
+    {
+        TaskId expected = task;
+        m_leaseHolder.compare_exchange_strong(expected, nullptr, std::memory_order_acq_rel);
+    }
+
+    bool SPIArbiter::pending(uint8_t level) const
+    {
+        return m_active[level].running || !m_queues[level].empty();
+    }
+
+    bool SPIArbiter::pick(uint8_t& level)
+    {
+        level = PRIORITIES;
+
+        // A lower class passed over MAX_BYPASS times gets one chunk
+        for (uint8_t i = 1; i < PRIORITIES && level == PRIORITIES; i++)
+        {
+            if (m_bypassed[i] >= MAX_BYPASS && pending(i)) level = i;
+        }
+        for (uint8_t i = 0; i < PRIORITIES && level == PRIORITIES; i++)
+        {
+            if (pending(i)) level = i;
+        }
+        if (level == PRIORITIES)
+        {
+            return false;
+        }
+
+        // Chosen by a non-empty queue, so the pop only fails if another bus task raced us
+        Active& active = m_active[level];
+        if (!active.running)
+        {
+            if (!m_queues[level].pop(active.transaction))
+            {
+                return false;
+            }
+            active.offset = 0;
+            active.chunks = 0;
+        }
+
+        m_bypassed[level] = 0;
+        for (uint8_t lower = level + 1; lower < PRIORITIES; lower++)
+        {
+            if (pending(lower) && m_bypassed[lower] < MAX_BYPASS) m_bypassed[lower]++;
+        }
+        return true;
+    }
+
+    void SPIArbiter::complete(Active& active, bool ok)
+    {
+        const SPITransaction& transaction = active.transaction;
+
+        SPICompletion result;
+        memset(&result, 0, sizeof(result));
+        result.id = transaction.id;
+        result.device = transaction.device;
+        result.ok = ok;
+        result.done = active.offset;
+        result.chunks = active.chunks;
+        result.queuedMicros = active.startedMicros - transaction.submittedMicros;
+        result.serviceMicros = now() - active.startedMicros;
+
+        m_stats.completed++;
+        if (!ok) m_stats.failed++;
+        m_stats.devices[transaction.device].transactions++;
+        active.running = false;
+
+        if (transaction.future)
+        {
+            transaction.future->result = result;
+            transaction.future->done.store(true, std::memory_order_release);
+        }
+        if (transaction.callback)
+        {
+            transaction.callback(transaction.context, result);
+        }
+    }
+
+    void SPIArbiter::tick()
+    {
+        // Accumulated in steps so the 32-bit clock may wrap
+        uint32_t current = now();
+        if (m_clockStarted)
+        {
+            m_stats.elapsedMicros += current - m_lastMicros;
+        }
+        m_clockStarted = true;
+        m_lastMicros = current;
+    }
+
+    void SPIArbiter::publish()
+    {
+        m_stats.submitted = m_submitted.load(std::memory_order_relaxed);
+        m_stats.rejected = m_rejected.load(std::memory_order_relaxed);
+        m_published.store(m_stats);
+    }
+}
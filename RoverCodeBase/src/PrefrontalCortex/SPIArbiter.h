@@ -0,0 +1,246 @@
+/**
+ * @brief SPIArbiter owns a shared SPI bus and runs its devices' transactions in priority order
+ *
+ * The display, SD card and radio share one bus. Each is registered with its
+ * own clock, mode and chip select, and whatever talks to them goes through here:
+ * - Transactions are queued from any task, one bounded lock-free queue per
+ *   priority, and run by the bus task one chunk at a time
+ * - After every chunk the most urgent work goes next, so a long display push
+ *   yields to an SD request within one chunk; a class passed over MAX_BYPASS
+ *   times gets a chunk so it never starves
+ * - A transaction either moves tx/rx buffers through the transfer hook with
+ *   its device selected around each chunk, or runs a step callback that
+ *   drives the device itself (a display driver, or a lease handing the bus to
+ *   another task); each chunk must stand alone, as the device is deselected
+ *   between them
+ * - Busy time is counted per device, so utilization is busy over elapsed
+ * - The task holding a lease is tracked, so it can be refused anything that
+ *   would wait on the bus task while that task is parked in its lease
+ *
+ * Platform-free: the bus, chip selects and clock are hooks, so the scheduling
+ * can be exercised on host against simulated devices.
+ */
+
+#ifndef SPI_ARBITER_H
+#define SPI_ARBITER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "BoundedQueue.h"
+#include "SeqLock.h"
+
+namespace PrefrontalCortex
+{
+    enum class SPIPriority : uint8_t
+    {
+        URGENT,         // Audio capture blocks, radio timing
+        NORMAL,
+        BULK,           // Display pushes; long and preemptable
+        COUNT
+    };
+
+    struct SPIDeviceConfig
+    {
+        const char* name;
+        uint8_t csPin;
+        uint32_t clockHz;
+        uint8_t mode;               // SPI mode 0-3
+    };
+
+    struct SPICompletion
+    {
+        uint32_t id;
+        uint8_t device;
+        bool ok;
+        uint32_t done;              // Of length, in the transaction's units
+        uint16_t chunks;
+        uint32_t queuedMicros;      // Submit to first chunk
+        uint32_t serviceMicros;     // First chunk to last, including time preempted
+    };
+
+    typedef void (*SPICallback)(void* context, const SPICompletion& completion);
+
+    /**
+     * @brief Runs one chunk with the bus configured for the device
+     * @param offset Units already done
+     */
+    typedef bool (*SPIStep)(void* context, uint32_t offset, uint32_t length);
+
+    /**
+     * @brief Caller-owned completion slot that a task can poll
+     */
+    struct SPIFuture
+    {
+        std::atomic<bool> done;
+        SPICompletion result;
+    };
+
+    struct SPITransaction
+    {
+        uint8_t device;
+        SPIPriority priority;
+        const uint8_t* tx;          // nullptr clocks out zeros
+        uint8_t* rx;                // nullptr discards what comes back
+        uint32_t length;            // Bytes, or the step's own units
+        uint32_t chunk;             // Most run at once; 0 runs it all in one go
+        SPIStep step;               // Instead of tx and rx
+        SPICallback callback;       // Runs on the bus task; keep it short
+        void* context;              // For step and callback
+        SPIFuture* future;
+        uint32_t id;
+        uint32_t submittedMicros;
+    };
+
+    struct SPIDeviceStats
+    {
+        uint32_t transactions;
+        uint32_t chunks;
+        uint32_t bytes;             // Through the transfer hook; steps count no bytes
+        uint64_t busyMicros;
+    };
+
+    struct SPIBusStats
+    {
+        static constexpr uint8_t MAX_DEVICES = 4;
+
+        uint32_t submitted;
+        uint32_t completed;
+        uint32_t failed;
+        uint32_t rejected;
+        uint32_t reconfigurations;  // Chunks for a different device than the last
+        uint32_t preemptions;       // Transactions overtaken part-way through
+        uint32_t maxQueuedMicros[static_cast<uint8_t>(SPIPriority::COUNT)];
+        uint32_t maxChunkMicros;
+        uint64_t busyMicros;
+        uint64_t elapsedMicros;     // Since the first processOne()
+        SPIDeviceStats devices[MAX_DEVICES];
+    };
+
+    struct SPIBusHooks
+    {
+        uint32_t (*micros)(void* context);
+
+        /**
+         * @brief Set clock and mode before chunks for a different device; nullptr if select does
+         */
+        void (*configure)(void* context, const SPIDeviceConfig& device);
+        void (*select)(void* context, const SPIDeviceConfig& device, bool selected);
+        bool (*transfer)(void* context, const uint8_t* tx, uint8_t* rx, uint32_t length);
+
+        /**
+         * @brief Wake the bus task after a submit; nullptr if it polls
+         */
+        void (*wake)(void* context);
+        void* context;
+    };
+
+    class SPIArbiter
+    {
+    public:
+        /**
+         * @brief A task as the platform names it (a TaskHandle_t on the rover)
+         */
+        typedef const void* TaskId;
+
+        static constexpr uint32_t QUEUE_DEPTH = 8;          // Per priority
+        static constexpr uint8_t MAX_BYPASS = 8;
+        static constexpr uint8_t NO_DEVICE = 0xFF;
+
+        explicit SPIArbiter(const SPIBusHooks& hooks);
+
+        /**
+         * @brief Register a device before anything is submitted for it
+         * @return Device id, or NO_DEVICE when MAX_DEVICES are registered
+         */
+        uint8_t addDevice(const SPIDeviceConfig& device);
+        const SPIDeviceConfig& device(uint8_t id) const { return m_devices[id]; }
+
+        /**
+         * @brief Transaction with every optional field cleared
+         */
+        static SPITransaction makeTransaction(uint8_t device, SPIPriority priority, uint32_t length);
+
+        /**
+         * @brief Queue a transaction from any task other than the bus task
+         * @return Transaction id, or 0 if it is malformed or its queue is full
+         */
+        uint32_t submit(const SPITransaction& transaction);
+
+        /**
+         * @brief Bus task: run one chunk of the most urgent transaction
+         * @return false when there was nothing to do
+         */
+        bool processOne();
+
+        bool idle() const;
+
+        /**
+         * @brief The task that calls processOne()
+         */
+        void setBusTask(TaskId task) { m_busTask.store(task, std::memory_order_release); }
+
+        /**
+         * @brief Whether task may block until the bus task has run something for it
+         *
+         * Never on the bus task itself, and never while task holds a lease: the
+         * bus task is parked in that lease's step until it is released.
+         */
+        bool canWait(TaskId task) const;
+
+        /**
+         * @brief Record that a lease step has handed the bus to task
+         * @return false if another task holds it, which the bus task rules out
+         */
+        bool beginLease(TaskId task);
+        void endLease(TaskId task);
+        TaskId leaseHolder() const { return m_leaseHolder.load(std::memory_order_acquire); }
+
+        /**
+         * @brief Lock-free snapshot, published after every chunk; any task
+         */
+        SPIBusStats stats() const { return m_published.load(); }
+
+    private:
+        static constexpr uint8_t PRIORITIES = static_cast<uint8_t>(SPIPriority::COUNT);
+
+        struct Active
+        {
+            SPITransaction transaction;
+            uint32_t offset;
+            uint32_t startedMicros;
+            uint16_t chunks;
+            bool running;
+        };
+
+        SPIBusHooks m_hooks;
+        SPIDeviceConfig m_devices[SPIBusStats::MAX_DEVICES];
+        uint8_t m_deviceCount;
+        BoundedQueue<SPITransaction, QUEUE_DEPTH> m_queues[PRIORITIES];
+        std::atomic<uint32_t> m_nextId;
+        std::atomic<uint32_t> m_submitted;
+        std::atomic<uint32_t> m_rejected;
+        std::atomic<TaskId> m_busTask;
+        std::atomic<TaskId> m_leaseHolder;
+
+        // Bus task only
+        Active m_active[PRIORITIES];
+        uint8_t m_bypassed[PRIORITIES];
+        uint8_t m_configured;               // Device the bus was last set up for
+        int8_t m_lastLevel;
+        uint32_t m_lastMicros;
+        bool m_clockStarted;
+        std::atomic<bool> m_busy;
+        SPIBusStats m_stats;
+        SeqLock<SPIBusStats> m_published;
+
+        bool pick(uint8_t& level);
+        bool pending(uint8_t level) const;
+        void complete(Active& active, bool ok);
+        void tick();
+        void publish();
+        uint32_t now() const { return m_hooks.micros(m_hooks.context); }
+    };
+}
+
+#endif // SPI_ARBITER_H
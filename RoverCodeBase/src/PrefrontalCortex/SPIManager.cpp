@@ -9,6 +9,14 @@ namespace PrefrontalCortex
     // Initialize state tracking
     bool SPIManager::initialized = false;
 
+    const SPIBusHooks SPIManager::BUS_HOOKS = 
+    {
+        busMicros, nullptr, selectBusDevice, transferBus, wakeBus, nullptr
+    };
+    SPIArbiter SPIManager::arbiter(SPIManager::BUS_HOOKS);
+    TaskHandle_t SPIManager::busTaskHandle = nullptr;
+    SemaphoreHandle_t SPIManager::leaseReleased = nullptr;
+
     bool SPIManager::isInitialized() 
     {
         return initialized;
@@ -32,6 +40,16 @@ namespace PrefrontalCortex
         SPI.begin(BOARD_SPI_SCK, BOARD_SPI_MISO, BOARD_SPI_MOSI);
         SPI.setFrequency(20000000); // 20MHz - adjust if needed
         
+        // Same order as SPIDevice; each transfer runs at its device's own settings
+        arbiter.addDevice({ "tft", TFT_CS, 40000000, SPI_MODE0 });
+        arbiter.addDevice({ "sd", BOARD_SD_CS, 20000000, SPI_MODE0 });
+        arbiter.addDevice({ "lora", BOARD_LORA_CS, 8000000, SPI_MODE0 });
+
+        // Above the storage task, so a chunk boundary hands the bus on promptly
+        leaseReleased = xSemaphoreCreateBinary();
+        xTaskCreatePinnedToCore(busTask, "SPIBus", 4096, NULL, 5, &busTaskHandle, 1);
+        arbiter.setBusTask(busTaskHandle);
+
         Utilities::LOG_DEBUG("SPI bus and chip selects initialized");
         initialized = true;
     }
@@ -51,4 +69,128 @@ namespace PrefrontalCortex
         digitalWrite(BOARD_SD_CS, HIGH);
         digitalWrite(BOARD_LORA_CS, HIGH);
     }
-}
\ No newline at end of file
+
+    uint32_t SPIManager::submit(const SPITransaction& transaction) 
+    {
+        if (!initialized) return 0;
+        return arbiter.submit(transaction);
+    }
+
+    bool SPIManager::acquire(SPIDevice device, SPIPriority priority) 
+    {
+        TaskHandle_t self = xTaskGetCurrentTaskHandle();
+        if (!initialized || !arbiter.canWait(self)) return false;
+
+        // The transaction points at this frame, so it is waited out, never abandoned
+        StaticSemaphore_t grantedBuffer;
+        SemaphoreHandle_t granted = xSemaphoreCreateBinaryStatic(&grantedBuffer);
+        SPITransaction lease = SPIArbiter::makeTransaction(static_cast<uint8_t>(device), priority, 1);
+        lease.step = holdLease;
+        lease.context = granted;
+        while (arbiter.submit(lease) == 0) 
+        {
+            vTaskDelay(1);
+        }
+        xSemaphoreTake(granted, portMAX_DELAY);
+        vSemaphoreDelete(granted);
+        arbiter.beginLease(self);
+        return true;
+    }
+
+    void SPIManager::release() 
+    {
+        arbiter.endLease(xTaskGetCurrentTaskHandle());
+        xSemaphoreGive(leaseReleased);
+    }
+
+    bool SPIManager::submitAndWait(const SPITransaction& transaction) 
+    {
+        // On the bus task, or with it parked in this task's lease, nothing would ever run
+        if (!initialized || !arbiter.canWait(xTaskGetCurrentTaskHandle())) return false;
+
+        // As with a lease, the transaction points at this frame, so it is waited out
+        StaticSemaphore_t finishedBuffer;
+        Waiter waiter = 
+        { 
+            transaction.step, transaction.callback, transaction.context, 
+            xSemaphoreCreateBinaryStatic(&finishedBuffer), false 
+        };
+        SPITransaction waited = transaction;
+        waited.step = transaction.step ? forwardStep : nullptr;
+        waited.callback = finishWait;
+        waited.context = &waiter;
+        while (arbiter.submit(waited) == 0) 
+        {
+            vTaskDelay(1);
+        }
+        xSemaphoreTake(waiter.finished, portMAX_DELAY);
+        vSemaphoreDelete(waiter.finished);
+        return waiter.ok;
+    }
+
+    void SPIManager::busTask(void* parameter) 
+    {
+        while (true) 
+        {
+            ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(BUS_IDLE_MS));
+            while (arbiter.processOne()) 
+            {
+            }
+        }
+    }
+
+    uint32_t SPIManager::busMicros(void* context) 
+    {
+        return micros();
+    }
+
+    void SPIManager::selectBusDevice(void* context, const SPIDeviceConfig& device, bool selected) 
+    {
+        // Settings travel with the transaction, as drivers stepping in between set their own
+        if (selected) 
+        {
+            SPI.beginTransaction(SPISettings(device.clockHz, MSBFIRST, device.mode));
+            digitalWrite(device.csPin, LOW);
+        }
+        else 
+        {
+            digitalWrite(device.csPin, HIGH);
+            SPI.endTransaction();
+        }
+    }
+
+    bool SPIManager::transferBus(void* context, const uint8_t* tx, uint8_t* rx, uint32_t length) 
+    {
+        SPI.transferBytes(tx, rx, length);
+        return true;
+    }
+
+    void SPIManager::wakeBus(void* context) 
+    {
+        if (busTaskHandle) 
+        {
+            xTaskNotifyGive(busTaskHandle);
+        }
+    }
+
+    bool SPIManager::holdLease(void* context, uint32_t offset, uint32_t length) 
+    {
+        xSemaphoreGive(static_cast<SemaphoreHandle_t>(context));
+        xSemaphoreTake(leaseReleased, portMAX_DELAY);
+        return true;
+    }
+
+    bool SPIManager::forwardStep(void* context, uint32_t offset, uint32_t length) 
+    {
+        Waiter& waiter = *static_cast<Waiter*>(context);
+        return waiter.step(waiter.context, offset, length);
+    }
+
+    void SPIManager::finishWait(void* context, const SPICompletion& completion) 
+    {
+        Waiter& waiter = *static_cast<Waiter*>(context);
+        if (waiter.callback) waiter.callback(waiter.context, completion);
+        waiter.ok = completion.ok;
+        xSemaphoreGive(waiter.finished);
+    }
+}
@@ -6,11 +6,23 @@
 #include "../PrefrontalCortex/ProtoPerceptions.h"
 #include "../MotorCortex/PinDefinitions.h"
 #include "../CorpusCallosum/SynapticPathways.h"
+#include "SPIArbiter.h"
 
 namespace PrefrontalCortex 
 {
     using namespace CorpusCallosum;
 
+    /**
+     * @brief Devices on the shared bus, in registration order
+     */
+    enum class SPIDevice : uint8_t 
+    {
+        TFT,
+        SD,
+        LORA,
+        COUNT
+    };
+
     /**
      * @brief Manages SPI bus communication and device selection
      * 
@@ -20,6 +32,10 @@ namespace PrefrontalCortex
      * - Multi-device coordination
      * - Safe device switching
      * - High-speed data transfer
+     *
+     * The bus belongs to an SPIArbiter run by its own task. Drivers that talk
+     * to their device themselves (TFT_eSPI, SD) either submit a step that the
+     * bus task runs, or hold a lease while they work.
      */
     class SPIManager 
     {
@@ -36,8 +52,102 @@ namespace PrefrontalCortex
         // Deselect all devices
         static void deselectAll();
 
+        static const SPIDeviceConfig& getDevice(SPIDevice device) { return arbiter.device(static_cast<uint8_t>(device)); }
+
+        /**
+         * @brief Queue a transaction for the bus task; any task
+         * @return Transaction id, or 0 before init or when its queue is full
+         */
+        static uint32_t submit(const SPITransaction& transaction);
+
+        /**
+         * @brief Queue a transaction and block until the bus task has run all of it
+         *
+         * Refused on the bus task and while this task holds a lease, as the bus
+         * task would never get to it; either way this task has the bus already.
+         * @return false before init, when refused, or when a chunk failed
+         */
+        static bool submitAndWait(const SPITransaction& transaction);
+
+        /**
+         * @brief Block until the bus task hands over the bus for device, then keep it until release()
+         *
+         * Waits behind more urgent work, but at most one chunk for a long push.
+         * submitAndWait() is refused while the lease is held.
+         * @return false before init, on the bus task, or when this task already holds
+         *         a lease; go ahead without taking the bus again then
+         */
+        static bool acquire(SPIDevice device, SPIPriority priority);
+        static void release();
+
+        static SPIBusStats getBusStats() { return arbiter.stats(); }
+
     private:
         // Track initialization state
         static bool initialized;
+
+        static SPIArbiter arbiter;
+        static const SPIBusHooks BUS_HOOKS;
+        static TaskHandle_t busTaskHandle;
+        static SemaphoreHandle_t leaseReleased;
+        static const uint32_t BUS_IDLE_MS = 100;
+
+        /**
+         * @brief A caller's step, callback and context, carried through submitAndWait()
+         */
+        struct Waiter
+        {
+            SPIStep step;
+            SPICallback callback;
+            void* context;
+            SemaphoreHandle_t finished;
+            bool ok;
+        };
+
+        /**
+         * @brief Bus task and SPIArbiter hooks
+         */
+        static void busTask(void* parameter);
+        static uint32_t busMicros(void* context);
+        static void selectBusDevice(void* context, const SPIDeviceConfig& device, bool selected);
+        static bool transferBus(void* context, const uint8_t* tx, uint8_t* rx, uint32_t length);
+        static void wakeBus(void* context);
+
+        /**
+         * @brief Step of a lease: signal the waiting task, then hold the bus until release()
+         */
+        static bool holdLease(void* context, uint32_t offset, uint32_t length);
+
+        static bool forwardStep(void* context, uint32_t offset, uint32_t length);
+        static void finishWait(void* context, const SPICompletion& completion);
+    };
+
+    /**
+     * @brief Holds the bus for one device for the lifetime of a scope
+     *
+     * Nests: an inner lease taken by the task that already holds one does nothing.
+     */
+    class SPILease 
+    {
+    public:
+        SPILease(SPIDevice device, SPIPriority priority) : m_held(SPIManager::acquire(device, priority)) {}
+
+        /**
+         * @param wanted false takes nothing, for code that may be working on SPIFFS instead
+         */
+        SPILease(SPIDevice device, SPIPriority priority, bool wanted) 
+            : m_held(wanted && SPIManager::acquire(device, priority)) {}
+        ~SPILease() 
+        {
+            if (m_held) SPIManager::release();
+        }
+
+        bool held() const { return m_held; }
+
+    private:
+        bool m_held;
+
+        SPILease(const SPILease&);
+        SPILease& operator=(const SPILease&);
     };
-}
\ No newline at end of file
+}
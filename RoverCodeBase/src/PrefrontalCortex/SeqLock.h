@@ -0,0 +1,82 @@
+/**
+ * @brief SeqLock publishes a small value from one writer task to any number of readers
+ *
+ * Readers never block the writer and never take a lock: they copy the
+ * value and retry if the sequence number shows a write overlapped the
+ * copy. Suited to stats that change rarely and are read every frame.
+ * The value is held as atomic words, so T must be trivially copyable.
+ */
+
+#ifndef SEQ_LOCK_H
+#define SEQ_LOCK_H
+
+#include <stdint.h>
+#include <string.h>
+#include <atomic>
+#include <type_traits>
+
+namespace PrefrontalCortex
+{
+    template <typename T>
+    class SeqLock
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "SeqLock values are copied word by word");
+
+    public:
+        SeqLock()
+            : m_sequence(0)
+        {
+            for (uint32_t i = 0; i < WORDS; i++)
+            {
+                m_words[i].store(0, std::memory_order_relaxed);
+            }
+        }
+
+        /**
+         * @brief Single writer only
+         */
+        void store(const T& value)
+        {
+            uint32_t words[WORDS] = {};
+            memcpy(words, &value, sizeof(T));
+
+            uint32_t sequence = m_sequence.load(std::memory_order_relaxed);
+            m_sequence.store(sequence + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            for (uint32_t i = 0; i < WORDS; i++)
+            {
+                m_words[i].store(words[i], std::memory_order_relaxed);
+            }
+            m_sequence.store(sequence + 2, std::memory_order_release);
+        }
+
+        T load() const
+        {
+            uint32_t words[WORDS];
+            uint32_t before;
+            uint32_t after;
+            do
+            {
+                before = m_sequence.load(std::memory_order_acquire);
+                for (uint32_t i = 0; i < WORDS; i++)
+                {
+                    words[i] = m_words[i].load(std::memory_order_relaxed);
+                }
+                std::atomic_thread_fence(std::memory_order_acquire);
+                after = m_sequence.load(std::memory_order_relaxed);
+            } while (before != after || (before & 1) != 0);
+
+            T value;
+            memcpy(&value, words, sizeof(T));
+            return value;
+        }
+
+    private:
+        static constexpr uint32_t WORDS = (sizeof(T) + sizeof(uint32_t) - 1) / sizeof(uint32_t);
+
+        std::atomic<uint32_t> m_sequence;       // Odd while a store is in progress
+        std::atomic<uint32_t> m_words[WORDS];
+    };
+}
+
+#endif // SEQ_LOCK_H
@@ -0,0 +1,43 @@
+/**
+ * @brief StorageBackend is the random-access file interface used by the
+ *        persistent stores
+ *
+ * Stores are written against these callbacks rather than fs::FS, so the
+ * same code runs on the SD card on the rover and on plain files on host.
+ * Offsets are absolute; a short read or write means the operation failed.
+ */
+
+#ifndef STORAGE_BACKEND_H
+#define STORAGE_BACKEND_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace PrefrontalCortex
+{
+    struct StorageBackend
+    {
+        typedef void* Handle;
+
+        /**
+         * @brief Open for reading and writing; nullptr if missing and !create
+         */
+        Handle (*open)(void* context, const char* path, bool create);
+        void (*close)(void* context, Handle file);
+        size_t (*read)(void* context, Handle file, uint32_t offset, uint8_t* data, size_t length);
+        size_t (*write)(void* context, Handle file, uint32_t offset, const uint8_t* data, size_t length);
+        uint32_t (*size)(void* context, Handle file);
+
+        /**
+         * @brief Push buffered writes to the medium
+         */
+        bool (*sync)(void* context, Handle file);
+
+        bool (*exists)(void* context, const char* path);
+        bool (*remove)(void* context, const char* path);
+        bool (*rename)(void* context, const char* from, const char* to);
+        void* context;
+    };
+}
+
+#endif // STORAGE_BACKEND_H
@@ -0,0 +1,308 @@
+/**
+ * @file StorageBenchmark.cpp
+ * @brief Block, churn and bus-contention tests over a StorageBackend
+ */
+
+#include "StorageBenchmark.h"
+#include <stdio.h>
+#include <string.h>
+
+namespace PrefrontalCortex
+{
+    const char* StorageBenchmark::CSV_HEADER = "medium,test,block_bytes,operations,bytes,elapsed_us,kb_per_s,worst_us,ok";
+
+    namespace
+    {
+        constexpr uint32_t RANDOM_SEED = 0x9E3779B9;
+        constexpr uint32_t CHURN_FILE_BYTES = 64;
+
+        bool joinPath(char* out, const char* directory, const char* name)
+        {
+            size_t length = strlen(directory);
+            const char* separator = length > 0 && directory[length - 1] == '/' ? "" : "/";
+            int written = snprintf(out, StorageBenchmark::PATH_LENGTH, "%s%s%s", directory, separator, name);
+            return written > 0 && written < StorageBenchmark::PATH_LENGTH;
+        }
+    }
+
+    StorageBenchmark::StorageBenchmark(const StorageBackend& storage, const BenchmarkHooks& hooks, uint8_t* buffer, uint32_t bufferSize)
+        : m_storage(storage)
+        , m_hooks(hooks)
+        , m_buffer(buffer)
+        , m_bufferSize(bufferSize)
+        , m_label("storage")
+        , m_fileBytes(DEFAULT_FILE_BYTES)
+        , m_random(RANDOM_SEED)
+        , m_failures(0)
+    {
+    }
+
+    uint16_t StorageBenchmark::run(const char* directory)
+    {
+        m_random = RANDOM_SEED;
+        m_failures = 0;
+        m_hooks.emit(m_hooks.context, CSV_HEADER);
+
+        char path[PATH_LENGTH];
+        if (!joinPath(path, directory, "bench.bin"))
+        {
+            return 1;
+        }
+
+        // Recognisable data, so a dump of a failed run shows what landed where
+        for (uint32_t i = 0; i < m_bufferSize; i++)
+        {
+            m_buffer[i] = static_cast<uint8_t>(i * 31 + 7);
+        }
+
+        for (uint32_t block = MIN_BLOCK; block <= MAX_BLOCK && block <= m_bufferSize && block <= m_fileBytes; block *= 2)
+        {
+            report(sequential("seq_write", path, block, true));
+            report(sequential("seq_read", path, block, false));
+            report(randomAccess("rand_read", path, block, false));
+            report(randomAccess("rand_write", path, block, true));
+            m_storage.remove(m_storage.context, path);
+        }
+
+        churn(directory);
+
+        if (m_hooks.busLoad && m_bufferSize >= MIXED_BLOCK)
+        {
+            mixed(path);
+        }
+        return m_failures;
+    }
+
+    BenchmarkResult StorageBenchmark::sequential(const char* test, const char* path, uint32_t blockSize, bool writing)
+    {
+        BenchmarkResult result = begin(test, blockSize);
+        if (writing)
+        {
+            m_storage.remove(m_storage.context, path);
+        }
+
+        // Open, sync and close are part of what a caller pays, so they are timed too
+        uint32_t start = now();
+        StorageBackend::Handle file = m_storage.open(m_storage.context, path, writing);
+        result.ok = file != nullptr;
+
+        for (uint32_t offset = 0; result.ok && offset + blockSize <= m_fileBytes; offset += blockSize)
+        {
+            uint32_t opStart = now();
+            size_t done = writing ?
+                m_storage.write(m_storage.context, file, offset, m_buffer, blockSize) :
+                m_storage.read(m_storage.context, file, offset, m_buffer, blockSize);
+            lap(result, opStart);
+            result.ok = done == blockSize;
+            result.bytes += done;
+        }
+
+        if (file)
+        {
+            if (writing) result.ok = m_storage.sync(m_storage.context, file) && result.ok;
+            m_storage.close(m_storage.context, file);
+        }
+        result.elapsedMicros = now() - start;
+        return result;
+    }
+
+    BenchmarkResult StorageBenchmark::randomAccess(const char* test, const char* path, uint32_t blockSize, bool writing)
+    {
+        BenchmarkResult result = begin(test, blockSize);
+        uint32_t blocks = m_fileBytes / blockSize;
+
+        uint32_t start = now();
+        StorageBackend::Handle file = m_storage.open(m_storage.context, path, false);
+        result.ok = file != nullptr && blocks > 0;
+
+        for (uint16_t i = 0; result.ok && i < RANDOM_OPERATIONS; i++)
+        {
+            uint32_t offset = nextRandom() % blocks * blockSize;
+            uint32_t opStart = now();
+            size_t done = writing ?
+                m_storage.write(m_storage.context, file, offset, m_buffer, blockSize) :
+                m_storage.read(m_storage.context, file, offset, m_buffer, blockSize);
+            lap(result, opStart);
+            result.ok = done == blockSize;
+            result.bytes += done;
+        }
+
+        if (file)
+        {
+            if (writing) result.ok = m_storage.sync(m_storage.context, file) && result.ok;
+            m_storage.close(m_storage.context, file);
+        }
+        result.elapsedMicros = now() - start;
+        return result;
+    }
+
+    void StorageBenchmark::churn(const char* directory)
+    {
+        char paths[CHURN_FILES][PATH_LENGTH];
+        bool ok = true;
+        for (uint16_t i = 0; i < CHURN_FILES; i++)
+        {
+            char name[16];
+            snprintf(name, sizeof(name), "churn%02u.bin", static_cast<unsigned>(i));
+            ok = joinPath(paths[i], directory, name) && ok;
+        }
+        if (!ok)
+        {
+            BenchmarkResult result = begin("create", CHURN_FILE_BYTES);
+            result.ok = false;
+            report(result);
+            return;
+        }
+
+        BenchmarkResult created = begin("create", CHURN_FILE_BYTES);
+        uint32_t start = now();
+        for (uint16_t i = 0; i < CHURN_FILES; i++)
+        {
+            uint32_t opStart = now();
+            m_storage.remove(m_storage.context, paths[i]);
+            StorageBackend::Handle file = m_storage.open(m_storage.context, paths[i], true);
+            bool written = file && m_storage.write(m_storage.context, file, 0, m_buffer, CHURN_FILE_BYTES) == CHURN_FILE_BYTES;
+            if (file) m_storage.close(m_storage.context, file);
+            lap(created, opStart);
+            created.ok = created.ok && written;
+            created.bytes += written ? CHURN_FILE_BYTES : 0;
+        }
+        created.elapsedMicros = now() - start;
+        report(created);
+
+        BenchmarkResult reopened = begin("open_close", 0);
+        start = now();
+        for (uint16_t i = 0; i < CHURN_FILES; i++)
+        {
+            uint32_t opStart = now();
+            StorageBackend::Handle file = m_storage.open(m_storage.context, paths[i], false);
+            if (file) m_storage.close(m_storage.context, file);
+            lap(reopened, opStart);
+            reopened.ok = reopened.ok && file != nullptr;
+        }
+        reopened.elapsedMicros = now() - start;
+        report(reopened);
+
+        if (m_hooks.listDirectory)
+        {
+            BenchmarkResult listed = begin("list", 0);
+            start = now();
+            listed.operations = m_hooks.listDirectory(m_hooks.context, directory);
+            listed.elapsedMicros = now() - start;
+            listed.worstMicros = listed.elapsedMicros;
+            listed.ok = listed.operations >= CHURN_FILES;
+            report(listed);
+        }
+
+        BenchmarkResult removed = begin("remove", 0);
+        start = now();
+        for (uint16_t i = 0; i < CHURN_FILES; i++)
+        {
+            uint32_t opStart = now();
+            bool gone = m_storage.remove(m_storage.context, paths[i]);
+            lap(removed, opStart);
+            removed.ok = removed.ok && gone;
+        }
+        removed.elapsedMicros = now() - start;
+        report(removed);
+    }
+
+    void StorageBenchmark::mixed(const char* path)
+    {
+        // A quarter of the file keeps the contended run short; the display
+        // push between blocks is what is being measured
+        uint32_t length = m_fileBytes / 4 / MIXED_BLOCK * MIXED_BLOCK;
+        BenchmarkResult load = begin("bus_load", 0);
+
+        for (uint8_t pass = 0; pass < 2; pass++)
+        {
+            bool writing = pass == 0;
+            BenchmarkResult result = begin(writing ? "mixed_write" : "mixed_read", MIXED_BLOCK);
+            if (writing)
+            {
+                m_storage.remove(m_storage.context, path);
+            }
+
+            uint32_t start = now();
+            uint32_t loadMicros = 0;
+            StorageBackend::Handle file = m_storage.open(m_storage.context, path, writing);
+            result.ok = file != nullptr && length > 0;
+
+            for (uint32_t offset = 0; result.ok && offset < length; offset += MIXED_BLOCK)
+            {
+                uint32_t opStart = now();
+                size_t done = writing ?
+                    m_storage.write(m_storage.context, file, offset, m_buffer, MIXED_BLOCK) :
+                    m_storage.read(m_storage.context, file, offset, m_buffer, MIXED_BLOCK);
+                lap(result, opStart);
+                result.ok = done == MIXED_BLOCK;
+                result.bytes += done;
+
+                uint32_t loadStart = now();
+                m_hooks.busLoad(m_hooks.context);
+                lap(load, loadStart);
+                loadMicros += now() - loadStart;
+            }
+
+            if (file)
+            {
+                if (writing) result.ok = m_storage.sync(m_storage.context, file) && result.ok;
+                m_storage.close(m_storage.context, file);
+            }
+
+            // Storage time only; the pushes are reported on their own row
+            result.elapsedMicros = now() - start - loadMicros;
+            load.elapsedMicros += loadMicros;
+            report(result);
+        }
+
+        m_storage.remove(m_storage.context, path);
+        report(load);
+    }
+
+    BenchmarkResult StorageBenchmark::begin(const char* test, uint32_t blockSize) const
+    {
+        BenchmarkResult result;
+        result.test = test;
+        result.blockSize = blockSize;
+        result.operations = 0;
+        result.bytes = 0;
+        result.elapsedMicros = 0;
+        result.worstMicros = 0;
+        result.ok = true;
+        return result;
+    }
+
+    void StorageBenchmark::lap(BenchmarkResult& result, uint32_t opStart) const
+    {
+        uint32_t took = now() - opStart;
+        if (took > result.worstMicros) result.worstMicros = took;
+        result.operations++;
+    }
+
+    uint32_t StorageBenchmark::nextRandom()
+    {
+        // xorshift32; a fixed seed keeps random offsets identical between runs and cards
+        m_random ^= m_random << 13;
+        m_random ^= m_random >> 17;
+        m_random ^= m_random << 5;
+        return m_random;
+    }
+
+    void StorageBenchmark::report(const BenchmarkResult& result)
+    {
+        if (!result.ok) m_failures++;
+
+        uint32_t kbPerSecond = result.elapsedMicros > 0 ?
+            static_cast<uint32_t>(static_cast<uint64_t>(result.bytes) * 1000000 / 1024 / result.elapsedMicros) : 0;
+
+        char line[128];
+        snprintf(line, sizeof(line), "%s,%s,%lu,%lu,%lu,%lu,%lu,%lu,%u",
+            m_label, result.test,
+            static_cast<unsigned long>(result.blockSize), static_cast<unsigned long>(result.operations),
+            static_cast<unsigned long>(result.bytes), static_cast<unsigned long>(result.elapsedMicros),
+            static_cast<unsigned long>(kbPerSecond), static_cast<unsigned long>(result.worstMicros),
+            result.ok ? 1u : 0u);
+        m_hooks.emit(m_hooks.context, line);
+    }
+}
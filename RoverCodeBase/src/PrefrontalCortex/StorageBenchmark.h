@@ -0,0 +1,100 @@
+/**
+ * @brief StorageBenchmark measures a StorageBackend and reports CSV rows
+ *
+ * Tests, each emitted as one row:
+ * - seq_write / seq_read / rand_write / rand_read for every power-of-two
+ *   block size from 512 B up to 64 KB (or the buffer size, if smaller)
+ * - create / open_close / list / remove over a directory of small files
+ * - mixed_write / mixed_read with other traffic on the bus between blocks,
+ *   plus a bus_load row for the time that traffic itself took
+ *
+ * The backend and the clock are callbacks, so the same suite runs on the
+ * SD card or SPIFFS on the rover and against plain files on host.
+ */
+
+#ifndef STORAGE_BENCHMARK_H
+#define STORAGE_BENCHMARK_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "StorageBackend.h"
+
+namespace PrefrontalCortex
+{
+    struct BenchmarkHooks
+    {
+        uint32_t (*micros)(void* context);
+        uint32_t (*listDirectory)(void* context, const char* path);    // Entries found; nullptr skips the list test
+        void (*busLoad)(void* context);                                 // Another device's transfer; nullptr skips the mixed tests
+        void (*emit)(void* context, const char* line);                  // One CSV row without the newline
+        void* context;
+    };
+
+    struct BenchmarkResult
+    {
+        const char* test;
+        uint32_t blockSize;
+        uint32_t operations;
+        uint32_t bytes;
+        uint32_t elapsedMicros;
+        uint32_t worstMicros;       // Slowest single operation
+        bool ok;
+    };
+
+    class StorageBenchmark
+    {
+    public:
+        static constexpr uint32_t MIN_BLOCK = 512;
+        static constexpr uint32_t MAX_BLOCK = 64 * 1024;
+        static constexpr uint32_t MIXED_BLOCK = 4096;
+        static constexpr uint32_t DEFAULT_FILE_BYTES = 1024 * 1024;
+        static constexpr uint16_t RANDOM_OPERATIONS = 64;
+        static constexpr uint16_t CHURN_FILES = 32;
+        static constexpr uint8_t PATH_LENGTH = 64;
+        static const char* CSV_HEADER;
+
+        /**
+         * @param buffer Scratch for one block; its size caps the largest block tested
+         */
+        StorageBenchmark(const StorageBackend& storage, const BenchmarkHooks& hooks, uint8_t* buffer, uint32_t bufferSize);
+
+        /**
+         * @brief First CSV column, naming the medium (e.g. "sd", "spiffs", "host")
+         */
+        void setLabel(const char* label) { m_label = label; }
+
+        /**
+         * @brief Size of the file the block tests stream through
+         */
+        void setFileBytes(uint32_t bytes) { m_fileBytes = bytes; }
+
+        /**
+         * @brief Run the suite inside an existing directory, removing what it creates
+         * @return Number of tests that failed
+         */
+        uint16_t run(const char* directory);
+
+    private:
+        StorageBackend m_storage;
+        BenchmarkHooks m_hooks;
+        uint8_t* m_buffer;
+        uint32_t m_bufferSize;
+        const char* m_label;
+        uint32_t m_fileBytes;
+        uint32_t m_random;
+        uint16_t m_failures;
+
+        BenchmarkResult sequential(const char* test, const char* path, uint32_t blockSize, bool writing);
+        BenchmarkResult randomAccess(const char* test, const char* path, uint32_t blockSize, bool writing);
+        void churn(const char* directory);
+        void mixed(const char* path);
+
+        BenchmarkResult begin(const char* test, uint32_t blockSize) const;
+        uint32_t now() const { return m_hooks.micros(m_hooks.context); }
+        void lap(BenchmarkResult& result, uint32_t opStart) const;
+        uint32_t nextRandom();
+        void report(const BenchmarkResult& result);
+    };
+}
+
+#endif // STORAGE_BENCHMARK_H
@@ -0,0 +1,103 @@
+/**
+ * @file StorageUsage.cpp
+ * @brief Incrementally maintained storage usage snapshot
+ */
+
+#include "StorageUsage.h"
+#include <string.h>
+
+namespace PrefrontalCortex
+{
+    namespace
+    {
+        uint32_t toKB(uint64_t bytes)
+        {
+            return static_cast<uint32_t>(bytes / 1024);
+        }
+    }
+
+    StorageUsage::StorageUsage(const StorageUsageHooks& hooks)
+        : m_hooks(hooks)
+        , m_pendingBytes(0)
+        , m_changed(false)
+        , m_totalBytes(0)
+        , m_usedBytes(0)
+        , m_publishedMeasuredMs(0)
+    {
+        memset(&m_current, 0, sizeof(m_current));
+    }
+
+    bool StorageUsage::mount(uint64_t cardBytes, uint32_t nowMs)
+    {
+        m_current.cardKB = toKB(cardBytes);
+        bool measured = measure(nowMs);
+        publish();
+        return measured;
+    }
+
+    void StorageUsage::recordDelta(int32_t bytes)
+    {
+        if (bytes == 0) return;
+        m_pendingBytes.fetch_add(bytes, std::memory_order_relaxed);
+        m_changed.store(true, std::memory_order_relaxed);
+    }
+
+    void StorageUsage::update(uint32_t nowMs, uint32_t lastActivityMs)
+    {
+        int32_t delta = m_pendingBytes.exchange(0, std::memory_order_relaxed);
+        if (delta < 0)
+        {
+            uint64_t shrink = static_cast<uint64_t>(-static_cast<int64_t>(delta));
+            m_usedBytes = shrink > m_usedBytes ? 0 : m_usedBytes - shrink;
+        }
+        else if (delta > 0)
+        {
+            m_usedBytes += static_cast<uint64_t>(delta);
+            if (m_totalBytes > 0 && m_usedBytes > m_totalBytes) m_usedBytes = m_totalBytes;
+        }
+
+        bool due = m_changed.load(std::memory_order_relaxed) &&
+                   nowMs - m_current.measuredMs >= REFRESH_MS &&
+                   nowMs - lastActivityMs >= QUIET_MS;
+        if (due)
+        {
+            measure(nowMs);
+        }
+        publish();
+    }
+
+    bool StorageUsage::measure(uint32_t nowMs)
+    {
+        // Anything reported so far is in the measurement; later deltas stay pending
+        m_changed.store(false, std::memory_order_relaxed);
+        m_pendingBytes.store(0, std::memory_order_relaxed);
+
+        uint64_t total = 0;
+        uint64_t used = 0;
+        if (!m_hooks.measure || !m_hooks.measure(m_hooks.context, &total, &used))
+        {
+            return false;
+        }
+        m_totalBytes = total;
+        m_usedBytes = used;
+        m_current.measuredMs = nowMs;
+        return true;
+    }
+
+    void StorageUsage::publish()
+    {
+        uint32_t totalKB = toKB(m_totalBytes);
+        uint32_t usedKB = toKB(m_usedBytes);
+        bool same = m_current.revision != 0 &&
+                    m_current.totalKB == totalKB &&
+                    m_current.usedKB == usedKB &&
+                    m_publishedMeasuredMs == m_current.measuredMs;
+        if (same) return;
+
+        m_current.totalKB = totalKB;
+        m_current.usedKB = usedKB;
+        m_current.revision++;
+        m_publishedMeasuredMs = m_current.measuredMs;
+        m_published.store(m_current);
+    }
+}
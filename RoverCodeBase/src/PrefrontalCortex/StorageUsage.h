@@ -0,0 +1,92 @@
+/**
+ * @brief StorageUsage tracks card capacity and usage without rescanning the card
+ *
+ * Working out used space means walking the allocation table, which is far
+ * too slow for a display frame. Instead:
+ * - Usage is measured once at mount
+ * - Writes and deletes report how far they grew or shrank their files, and
+ *   update() folds those deltas into the estimate
+ * - A fresh measurement replaces the estimate now and then, but only after
+ *   something changed and only once storage has been quiet for a while,
+ *   so a scan never holds the card during a recording
+ * - Readers on any task take a lock-free snapshot; its revision changes only
+ *   when a value does, so a view can skip reformatting
+ *
+ * Deltas count file bytes, not allocated clusters, so the estimate drifts
+ * slightly low between measurements.
+ */
+
+#ifndef STORAGE_USAGE_H
+#define STORAGE_USAGE_H
+
+#include <stdint.h>
+#include <atomic>
+#include "SeqLock.h"
+
+namespace PrefrontalCortex
+{
+    struct StorageUsageSnapshot
+    {
+        uint32_t cardKB;
+        uint32_t totalKB;           // Formatted capacity
+        uint32_t usedKB;
+        uint32_t revision;          // 0 until mounted
+        uint32_t measuredMs;        // When usedKB was last measured rather than estimated
+    };
+
+    struct StorageUsageHooks
+    {
+        /**
+         * @brief Measure the medium; slow
+         */
+        bool (*measure)(void* context, uint64_t* totalBytes, uint64_t* usedBytes);
+        void* context;
+    };
+
+    class StorageUsage
+    {
+    public:
+        static constexpr uint32_t REFRESH_MS = 5 * 60 * 1000;
+        static constexpr uint32_t QUIET_MS = 2000;
+
+        explicit StorageUsage(const StorageUsageHooks& hooks);
+
+        /**
+         * @brief Measure and publish the first snapshot
+         */
+        bool mount(uint64_t cardBytes, uint32_t nowMs);
+
+        /**
+         * @brief Report a file growing (or, negative, shrinking); any task
+         */
+        void recordDelta(int32_t bytes);
+
+        /**
+         * @brief Fold deltas in and re-measure when due; the only task that publishes
+         * @param lastActivityMs Last time storage was busy
+         */
+        void update(uint32_t nowMs, uint32_t lastActivityMs);
+
+        /**
+         * @brief Lock-free; safe from any task
+         */
+        StorageUsageSnapshot snapshot() const { return m_published.load(); }
+
+    private:
+        StorageUsageHooks m_hooks;
+        std::atomic<int32_t> m_pendingBytes;
+        std::atomic<bool> m_changed;            // Since the last measurement
+
+        // Publishing task only
+        uint64_t m_totalBytes;
+        uint64_t m_usedBytes;
+        StorageUsageSnapshot m_current;         // As last published, apart from measuredMs
+        uint32_t m_publishedMeasuredMs;
+        SeqLock<StorageUsageSnapshot> m_published;
+
+        bool measure(uint32_t nowMs);
+        void publish();
+    };
+}
+
+#endif // STORAGE_USAGE_H
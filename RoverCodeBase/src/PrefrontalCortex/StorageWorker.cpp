@@ -0,0 +1,289 @@
+/**
+ * @file StorageWorker.cpp
+ * @brief Prioritised request queues executed on the storage task
+ */
+
+#include "StorageWorker.h"
+#include <string.h>
+
+namespace PrefrontalCortex
+{
+    namespace
+    {
+        constexpr uint8_t PRIORITIES = static_cast<uint8_t>(StoragePriority::COUNT);
+    }
+
+    StorageWorker::StorageWorker(const StorageBackend& storage, const StorageWorkerHooks& hooks)
+        : m_storage(storage)
+        , m_hooks(hooks)
+        , m_nextId(0)
+        , m_callbacksPending(0)
+        , m_cached(nullptr)
+        , m_cachedDirty(false)
+        , m_busy(false)
+        , m_submitted(0)
+        , m_rejected(0)
+    {
+        memset(m_bypassed, 0, sizeof(m_bypassed));
+        memset(m_cachedPath, 0, sizeof(m_cachedPath));
+        memset(&m_stats, 0, sizeof(m_stats));
+    }
+
+    StorageRequest StorageWorker::makeRequest(StorageOp op, const char* path, StoragePriority priority)
+    {
+        StorageRequest request;
+        memset(&request, 0, sizeof(request));
+        request.op = op;
+        request.priority = priority;
+        if (path)
+        {
+            // Left unterminated when too long, so submit() refuses it instead of opening a truncated path
+            memcpy(request.path, path, strnlen(path, sizeof(request.path)));
+        }
+        return request;
+    }
+
+    uint32_t StorageWorker::submit(const StorageRequest& request)
+    {
+        uint8_t priority = static_cast<uint8_t>(request.priority);
+        bool truncated = request.file == nullptr && strnlen(request.path, sizeof(request.path)) == sizeof(request.path);
+        if (priority >= PRIORITIES || truncated)
+        {
+            m_rejected.fetch_add(1, std::memory_order_relaxed);
+            return 0;
+        }
+
+        // Reserve the completion slot up front so the worker never has to drop one
+        if (request.callback &&
+            m_callbacksPending.fetch_add(1, std::memory_order_relaxed) >= COMPLETION_DEPTH)
+        {
+            m_callbacksPending.fetch_sub(1, std::memory_order_relaxed);
+            m_rejected.fetch_add(1, std::memory_order_relaxed);
+            return 0;
+        }
+
+        StorageRequest queued = request;
+        do
+        {
+            queued.id = m_nextId.fetch_add(1, std::memory_order_relaxed) + 1;
+        } while (queued.id == 0);
+        queued.submittedMicros = now();
+        if (queued.future)
+        {
+            queued.future->done.store(false, std::memory_order_relaxed);
+        }
+
+        if (!m_queues[priority].push(queued))
+        {
+            if (request.callback) m_callbacksPending.fetch_sub(1, std::memory_order_relaxed);
+            m_rejected.fetch_add(1, std::memory_order_relaxed);
+            return 0;
+        }
+
+        m_submitted.fetch_add(1, std::memory_order_relaxed);
+        if (m_hooks.wake)
+        {
+            m_hooks.wake(m_hooks.context);
+        }
+        return queued.id;
+    }
+
+    bool StorageWorker::processOne()
+    {
+        m_busy.store(true, std::memory_order_relaxed);
+
+        StorageRequest request;
+        if (!next(request))
+        {
+            // Drained: release the file so other code may touch it
+            closeCached();
+            m_busy.store(false, std::memory_order_release);
+            return false;
+        }
+
+        StorageCompletion result;
+        memset(&result, 0, sizeof(result));
+        result.id = request.id;
+        result.op = request.op;
+
+        uint32_t start = now();
+        result.queuedMicros = start - request.submittedMicros;
+        execute(request, result);
+        result.serviceMicros = now() - start;
+
+        uint8_t priority = static_cast<uint8_t>(request.priority);
+        m_stats.completed++;
+        if (!result.ok) m_stats.failed++;
+        if (result.queuedMicros > m_stats.maxQueuedMicros[priority]) m_stats.maxQueuedMicros[priority] = result.queuedMicros;
+        if (result.serviceMicros > m_stats.maxServiceMicros) m_stats.maxServiceMicros = result.serviceMicros;
+
+        if (request.future)
+        {
+            request.future->result = result;
+            request.future->done.store(true, std::memory_order_release);
+        }
+        if (request.callback)
+        {
+            Completion completion;
+            completion.callback = request.callback;
+            completion.context = request.context;
+            completion.result = result;
+            m_completions.push(completion);
+        }
+        return true;
+    }
+
+    uint32_t StorageWorker::poll()
+    {
+        uint32_t delivered = 0;
+        Completion completion;
+        while (m_completions.pop(completion))
+        {
+            completion.callback(completion.context, completion.result);
+            m_callbacksPending.fetch_sub(1, std::memory_order_relaxed);
+            delivered++;
+        }
+        return delivered;
+    }
+
+    bool StorageWorker::idle() const
+    {
+        for (uint8_t i = 0; i < PRIORITIES; i++)
+        {
+            if (!m_queues[i].empty()) return false;
+        }
+        return !m_busy.load(std::memory_order_acquire);
+    }
+
+    StorageWorkerStats StorageWorker::stats() const
+    {
+        StorageWorkerStats stats = m_stats;
+        stats.submitted = m_submitted.load(std::memory_order_relaxed);
+        stats.rejected = m_rejected.load(std::memory_order_relaxed);
+        return stats;
+    }
+
+    bool StorageWorker::next(StorageRequest& request)
+    {
+        // A lower class passed over MAX_BYPASS times gets one turn
+        for (uint8_t i = 1; i < PRIORITIES; i++)
+        {
+            if (m_bypassed[i] >= MAX_BYPASS && m_queues[i].pop(request))
+            {
+                m_bypassed[i] = 0;
+                return true;
+            }
+        }
+
+        for (uint8_t i = 0; i < PRIORITIES; i++)
+        {
+            if (m_queues[i].pop(request))
+            {
+                m_bypassed[i] = 0;
+                for (uint8_t lower = i + 1; lower < PRIORITIES; lower++)
+                {
+                    if (!m_queues[lower].empty() && m_bypassed[lower] < MAX_BYPASS) m_bypassed[lower]++;
+                }
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void StorageWorker::execute(const StorageRequest& request, StorageCompletion& result)
+    {
+        switch (request.op)
+        {
+            case StorageOp::READ:
+            {
+                StorageBackend::Handle file = fileFor(request, false);
+                if (file)
+                {
+                    result.bytes = m_storage.read(m_storage.context, file, request.offset, request.data, request.length);
+                    result.ok = result.bytes == request.length;
+                }
+                break;
+            }
+
+            case StorageOp::WRITE:
+            case StorageOp::APPEND:
+            {
+                StorageBackend::Handle file = fileFor(request, true);
+                if (file)
+                {
+                    uint32_t offset = request.op == StorageOp::APPEND ?
+                        m_storage.size(m_storage.context, file) : request.offset;
+                    result.bytes = m_storage.write(m_storage.context, file, offset, request.data, request.length);
+                    result.ok = result.bytes == request.length;
+                    result.size = offset + result.bytes;
+                    if (file == m_cached) m_cachedDirty = true;
+                }
+                break;
+            }
+
+            case StorageOp::LIST:
+            {
+                if (m_hooks.list)
+                {
+                    uint32_t used = 0;
+                    int32_t entries = m_hooks.list(m_hooks.context, request.path,
+                        reinterpret_cast<char*>(request.data), request.length, &used);
+                    result.ok = entries >= 0;
+                    result.size = entries >= 0 ? static_cast<uint32_t>(entries) : 0;
+                    result.bytes = used;
+                }
+                break;
+            }
+
+            case StorageOp::STAT:
+            {
+                bool cached = request.file || (m_cached && strcmp(request.path, m_cachedPath) == 0);
+                if (cached || m_storage.exists(m_storage.context, request.path))
+                {
+                    StorageBackend::Handle file = fileFor(request, false);
+                    result.ok = file != nullptr;
+                    result.size = file ? m_storage.size(m_storage.context, file) : 0;
+                }
+                break;
+            }
+        }
+    }
+
+    StorageBackend::Handle StorageWorker::fileFor(const StorageRequest& request, bool create)
+    {
+        if (request.file)
+        {
+            return request.file;
+        }
+        if (m_cached && strcmp(request.path, m_cachedPath) == 0)
+        {
+            m_stats.handleReuses++;
+            return m_cached;
+        }
+
+        closeCached();
+        StorageBackend::Handle file = m_storage.open(m_storage.context, request.path, create);
+        if (file)
+        {
+            m_cached = file;
+            memcpy(m_cachedPath, request.path, sizeof(m_cachedPath));
+        }
+        return file;
+    }
+
+    void StorageWorker::closeCached()
+    {
+        if (!m_cached)
+        {
+            return;
+        }
+        if (m_cachedDirty)
+        {
+            m_storage.sync(m_storage.context, m_cached);
+        }
+        m_storage.close(m_storage.context, m_cached);
+        m_cached = nullptr;
+        m_cachedDirty = false;
+        m_cachedPath[0] = '\0';
+    }
+}
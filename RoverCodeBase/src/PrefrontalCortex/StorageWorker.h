@@ -0,0 +1,183 @@
+/**
+ * @brief StorageWorker runs file requests on a dedicated task
+ *
+ * Callers on any task submit read, write, append, list and stat requests
+ * and carry on; the worker task executes them in priority order:
+ * - One bounded lock-free queue per priority; audio capture is served
+ *   before normal requests, which are served before logging, with a
+ *   lower class let through after MAX_BYPASS wins so it never starves
+ * - Completions are either posted for poll() to deliver as callbacks on
+ *   the polling task, or written into a caller-owned StorageFuture
+ * - Path requests keep the last file open while requests keep coming and
+ *   close (and sync) it once the queues drain
+ *
+ * Platform-free: the task, its wake-up and the clock are supplied by the
+ * owner, so the queueing can be exercised on host against a slow backend.
+ */
+
+#ifndef STORAGE_WORKER_H
+#define STORAGE_WORKER_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <atomic>
+#include "StorageBackend.h"
+#include "BoundedQueue.h"
+
+namespace PrefrontalCortex
+{
+    enum class StorageOp : uint8_t
+    {
+        READ,           // length bytes at offset into data
+        WRITE,          // length bytes from data at offset, creating the file
+        APPEND,         // length bytes from data at the end of the file
+        LIST,           // Entry names, one per line, into data
+        STAT            // Existence and size
+    };
+
+    enum class StoragePriority : uint8_t
+    {
+        AUDIO,
+        NORMAL,
+        LOGGING,
+        COUNT
+    };
+
+    struct StorageCompletion
+    {
+        uint32_t id;
+        StorageOp op;
+        bool ok;
+        uint32_t bytes;             // Transferred (or written into data by LIST)
+        uint32_t size;              // File size for STAT and APPEND, entry count for LIST
+        uint32_t queuedMicros;      // Submit to start
+        uint32_t serviceMicros;     // Start to finish
+    };
+
+    typedef void (*StorageCallback)(void* context, const StorageCompletion& completion);
+
+    /**
+     * @brief Caller-owned completion slot that a task can poll without the main loop
+     */
+    struct StorageFuture
+    {
+        std::atomic<bool> done;
+        StorageCompletion result;
+    };
+
+    struct StorageRequest
+    {
+        static constexpr uint8_t PATH_LENGTH = 48;
+
+        StorageOp op;
+        StoragePriority priority;
+        char path[PATH_LENGTH];
+        StorageBackend::Handle file;    // An already-open file instead of path; left open
+        uint32_t offset;
+        uint8_t* data;                  // Caller-owned until completion
+        uint32_t length;
+        StorageCallback callback;       // Delivered by poll()
+        void* context;
+        StorageFuture* future;          // Completed by the worker task itself
+        uint32_t id;
+        uint32_t submittedMicros;
+    };
+
+    struct StorageWorkerStats
+    {
+        uint32_t submitted;
+        uint32_t completed;
+        uint32_t failed;
+        uint32_t rejected;                                                  // Queue or callback slots full
+        uint32_t maxQueuedMicros[static_cast<uint8_t>(StoragePriority::COUNT)];
+        uint32_t maxServiceMicros;
+        uint32_t handleReuses;                                              // Requests served by the cached open file
+    };
+
+    struct StorageWorkerHooks
+    {
+        uint32_t (*micros)(void* context);
+
+        /**
+         * @brief Write entry names into out, one per line
+         * @return Entries listed, or -1 if the path is not a directory
+         */
+        int32_t (*list)(void* context, const char* path, char* out, uint32_t length, uint32_t* used);
+
+        /**
+         * @brief Wake the worker task after a submit; nullptr if it polls
+         */
+        void (*wake)(void* context);
+        void* context;
+    };
+
+    class StorageWorker
+    {
+    public:
+        static constexpr uint32_t QUEUE_DEPTH = 16;         // Per priority
+        static constexpr uint32_t COMPLETION_DEPTH = 32;
+        static constexpr uint8_t MAX_BYPASS = 8;
+
+        StorageWorker(const StorageBackend& storage, const StorageWorkerHooks& hooks);
+
+        /**
+         * @brief Request with every optional field cleared
+         */
+        static StorageRequest makeRequest(StorageOp op, const char* path, StoragePriority priority = StoragePriority::NORMAL);
+
+        /**
+         * @brief Queue a request from any task
+         * @return Request id, or 0 if its queue (or the callback backlog) is full
+         */
+        uint32_t submit(const StorageRequest& request);
+
+        /**
+         * @brief Worker task: run the next request, or close the cached file when idle
+         * @return false when there was nothing to do
+         */
+        bool processOne();
+
+        /**
+         * @brief Deliver posted completions to their callbacks on the calling task
+         * @return Callbacks run
+         */
+        uint32_t poll();
+
+        bool idle() const;
+        StorageWorkerStats stats() const;
+
+    private:
+        struct Completion
+        {
+            StorageCallback callback;
+            void* context;
+            StorageCompletion result;
+        };
+
+        StorageBackend m_storage;
+        StorageWorkerHooks m_hooks;
+        BoundedQueue<StorageRequest, QUEUE_DEPTH> m_queues[static_cast<uint8_t>(StoragePriority::COUNT)];
+        BoundedQueue<Completion, COMPLETION_DEPTH> m_completions;
+        std::atomic<uint32_t> m_nextId;
+        std::atomic<uint32_t> m_callbacksPending;   // Bounded by COMPLETION_DEPTH, so posting never fails
+        uint8_t m_bypassed[static_cast<uint8_t>(StoragePriority::COUNT)];
+
+        // Worker task only
+        StorageBackend::Handle m_cached;
+        char m_cachedPath[StorageRequest::PATH_LENGTH];
+        bool m_cachedDirty;
+        std::atomic<bool> m_busy;                   // Cleared once drained and the cached file is closed
+
+        std::atomic<uint32_t> m_submitted;
+        std::atomic<uint32_t> m_rejected;
+        StorageWorkerStats m_stats;                 // Worker-side counters
+
+        bool next(StorageRequest& request);
+        void execute(const StorageRequest& request, StorageCompletion& result);
+        StorageBackend::Handle fileFor(const StorageRequest& request, bool create);
+        void closeCached();
+        uint32_t now() const { return m_hooks.micros(m_hooks.context); }
+    };
+}
+
+#endif // STORAGE_WORKER_H
@@ -0,0 +1,539 @@
+/**
+ * @file WriteJournal.cpp
+ * @brief Staged, checksummed and idempotently applied file writes
+ */
+
+#include "WriteJournal.h"
+#include <string.h>
+
+namespace PrefrontalCortex
+{
+    namespace
+    {
+        constexpr uint16_t RECORD_MAGIC = 0x4A52;           // "RJ"
+        constexpr uint32_t JOURNAL_MAGIC = 0x4C4E524A;      // "JRNL"
+
+        uint32_t nextSector(uint32_t position)
+        {
+            return (position / WriteJournal::SECTOR_SIZE + 1) * WriteJournal::SECTOR_SIZE;
+        }
+
+        /**
+         * @brief Record headers never straddle a sector boundary; the tail of a
+         *        sector too short for one is zero-filled and skipped
+         */
+        bool headerFits(uint32_t position, size_t headerLength)
+        {
+            return WriteJournal::SECTOR_SIZE - position % WriteJournal::SECTOR_SIZE >= headerLength;
+        }
+    }
+
+    WriteJournal::WriteJournal(const StorageBackend& storage)
+        : m_storage(storage)
+        , m_journal(nullptr)
+        , m_journalLength(0)
+        , m_nextSequence(1)
+        , m_baseSequence(1)
+        , m_staged(0)
+        , m_lastRecord(NO_RECORD)
+        , m_committed(false)
+        , m_stagedSinceMs(0)
+        , m_flushBytes(BUFFER_SIZE)
+        , m_maxDelayMs(DEFAULT_MAX_DELAY_MS)
+        , m_targetCount(0)
+    {
+        m_journalPath[0] = '\0';
+        memset(&m_stats, 0, sizeof(m_stats));
+    }
+
+    WriteJournal::~WriteJournal()
+    {
+        close();
+    }
+
+    bool WriteJournal::open(const char* journalPath)
+    {
+        if (isOpen()) return true;
+        if (strlen(journalPath) >= PATH_LENGTH) return false;
+        strcpy(m_journalPath, journalPath);
+
+        m_journal = m_storage.open(m_storage.context, m_journalPath, true);
+        if (m_journal == nullptr) return false;
+
+        if (!replay())
+        {
+            // Whatever replayed stays staged as a committed batch and is retried on flush
+            m_stats.failures++;
+        }
+        return true;
+    }
+
+    void WriteJournal::close()
+    {
+        if (!isOpen()) return;
+
+        flush();
+        m_storage.close(m_storage.context, m_journal);
+        m_journal = nullptr;
+    }
+
+    void WriteJournal::setFlushPolicy(uint16_t bytes, uint32_t maxDelayMs)
+    {
+        m_flushBytes = bytes > BUFFER_SIZE ? BUFFER_SIZE : bytes;
+        m_maxDelayMs = maxDelayMs;
+    }
+
+    bool WriteJournal::append(const char* path, const uint8_t* data, size_t length, uint32_t nowMs)
+    {
+        return stage(Op::APPEND, path, data, length, nowMs);
+    }
+
+    bool WriteJournal::write(const char* path, const uint8_t* data, size_t length, uint32_t nowMs)
+    {
+        return stage(Op::WRITE, path, data, length, nowMs);
+    }
+
+    void WriteJournal::update(uint32_t nowMs)
+    {
+        if (m_staged == 0 || nowMs - m_stagedSinceMs < m_maxDelayMs) return;
+
+        if (!flush())
+        {
+            // Back off for another interval before retrying a failing card
+            m_stagedSinceMs = nowMs;
+        }
+    }
+
+    bool WriteJournal::flush()
+    {
+        if (!isOpen()) return false;
+        if (m_staged == 0) return true;
+
+        if (!m_committed)
+        {
+            sealRecords();
+
+            // Pad to whole sectors so a batch never shares a sector with the next one
+            uint32_t padded = (m_staged + SECTOR_SIZE - 1) / SECTOR_SIZE * SECTOR_SIZE;
+            memset(m_buffer + m_staged, 0, padded - m_staged);
+
+            if (m_storage.write(m_storage.context, m_journal, m_journalLength, m_buffer, padded) != padded ||
+                !m_storage.sync(m_storage.context, m_journal))
+            {
+                m_stats.failures++;
+                return false;
+            }
+            m_staged = static_cast<uint16_t>(padded);
+            m_journalLength += padded;
+            m_stats.sectorsWritten += padded / SECTOR_SIZE;
+            m_committed = true;
+        }
+
+        // From here the batch is durable; a failure below is retried from RAM,
+        // or from the journal after a reset
+        if (!apply(m_buffer, m_staged) || !writeJournalHeader(m_nextSequence))
+        {
+            m_stats.failures++;
+            return false;
+        }
+
+        m_baseSequence = m_nextSequence;
+        m_journalLength = SECTOR_SIZE;
+        m_stats.flushes++;
+        resetBatch();
+        return true;
+    }
+
+    bool WriteJournal::hasPending(const char* path) const
+    {
+        for (uint8_t i = 0; i < m_targetCount; i++)
+        {
+            if (strcmp(m_targets[i].path, path) == 0) return true;
+        }
+        return false;
+    }
+
+    JournalStats WriteJournal::stats() const
+    {
+        JournalStats result = m_stats;
+        result.staged = m_staged;
+        return result;
+    }
+
+    bool WriteJournal::stage(Op op, const char* path, const uint8_t* data, size_t length, uint32_t nowMs)
+    {
+        if (!isOpen()) return false;
+
+        size_t pathLength = strlen(path);
+        if (pathLength == 0 || pathLength >= PATH_LENGTH) return false;
+
+        // A committed batch must be applied before anything else is staged
+        if (m_committed && !flush()) return false;
+
+        bool first = true;
+        while (true)
+        {
+            // Appends to the file the last record targets grow that record in
+            // place; CRCs are only sealed when the batch is flushed
+            bool extend = m_lastRecord != NO_RECORD && (op == Op::APPEND || !first) &&
+                          recordPathIs(m_lastRecord, path, pathLength);
+
+            uint16_t position = m_staged;
+            size_t overhead = 0;
+            if (!extend)
+            {
+                if (!headerFits(position, sizeof(RecordHeader)))
+                {
+                    position = static_cast<uint16_t>(nextSector(position));
+                }
+                overhead = sizeof(RecordHeader) + pathLength;
+            }
+            size_t room = position + overhead < BUFFER_SIZE ? BUFFER_SIZE - position - overhead : 0;
+            size_t chunk = length < room ? length : room;
+
+            // Anything that fits in one batch is kept in one batch; only writes
+            // larger than the whole buffer are split, starting on an empty one
+            bool newTarget = !hasPending(path);
+            if (position + overhead > BUFFER_SIZE || (chunk < length && m_staged > 0) ||
+                (newTarget && m_targetCount == BATCH_FILES))
+            {
+                if (m_staged == 0 || !flush()) return false;
+                continue;
+            }
+
+            TargetSize* entry = target(path);
+            if (entry == nullptr) return false;
+
+            if (extend)
+            {
+                RecordHeader header;
+                memcpy(&header, m_buffer + m_lastRecord, sizeof(header));
+                header.dataLength = static_cast<uint16_t>(header.dataLength + chunk);
+                memcpy(m_buffer + m_lastRecord, &header, sizeof(header));
+            }
+            else
+            {
+                memset(m_buffer + m_staged, 0, position - m_staged);
+
+                RecordHeader header;
+                header.magic = RECORD_MAGIC;
+                header.op = static_cast<uint8_t>(first && op == Op::WRITE ? Op::WRITE : Op::APPEND);
+                header.pathLength = static_cast<uint8_t>(pathLength);
+                header.dataLength = static_cast<uint16_t>(chunk);
+                header.reserved = 0;
+                header.sequence = m_nextSequence++;
+                header.offset = header.op == static_cast<uint8_t>(Op::WRITE) ? 0 : entry->size;
+                header.crc = 0;
+                entry->size = header.offset;
+
+                memcpy(m_buffer + position, &header, sizeof(header));
+                memcpy(m_buffer + position + sizeof(header), path, pathLength);
+                m_lastRecord = position;
+            }
+
+            if (chunk > 0) memcpy(m_buffer + position + overhead, data, chunk);
+            entry->size += chunk;
+
+            if (m_staged == 0) m_stagedSinceMs = nowMs;
+            m_staged = static_cast<uint16_t>(position + overhead + chunk);
+            m_stats.bytesStaged += chunk;
+
+            data += chunk;
+            length -= chunk;
+            first = false;
+            if (length == 0) break;
+        }
+
+        m_stats.writes++;
+        if (m_staged >= m_flushBytes)
+        {
+            flush();    // Staged data is safe in RAM either way
+        }
+        return true;
+    }
+
+    WriteJournal::TargetSize* WriteJournal::target(const char* path)
+    {
+        for (uint8_t i = 0; i < m_targetCount; i++)
+        {
+            if (strcmp(m_targets[i].path, path) == 0) return &m_targets[i];
+        }
+        if (m_targetCount == BATCH_FILES) return nullptr;
+
+        // Offsets are fixed when staged, so replaying a record always lands it in the same place
+        uint32_t size = 0;
+        if (m_storage.exists(m_storage.context, path))
+        {
+            StorageBackend::Handle file = m_storage.open(m_storage.context, path, false);
+            if (file == nullptr) return nullptr;
+            size = m_storage.size(m_storage.context, file);
+            m_storage.close(m_storage.context, file);
+        }
+
+        TargetSize& entry = m_targets[m_targetCount++];
+        strcpy(entry.path, path);
+        entry.size = size;
+        return &entry;
+    }
+
+    bool WriteJournal::recordPathIs(uint16_t position, const char* path, size_t pathLength) const
+    {
+        return m_buffer[position + offsetof(RecordHeader, pathLength)] == pathLength &&
+               memcmp(m_buffer + position + sizeof(RecordHeader), path, pathLength) == 0;
+    }
+
+    void WriteJournal::sealRecords()
+    {
+        uint16_t position = 0;
+        while (position + sizeof(RecordHeader) <= m_staged)
+        {
+            RecordHeader header;
+            memcpy(&header, m_buffer + position, sizeof(header));
+            if (!headerFits(position, sizeof(RecordHeader)) || header.magic != RECORD_MAGIC)
+            {
+                position = static_cast<uint16_t>(nextSector(position));
+                continue;
+            }
+
+            const uint8_t* path = m_buffer + position + sizeof(header);
+            header.crc = recordCrc(header, path, path + header.pathLength);
+            memcpy(m_buffer + position, &header, sizeof(header));
+            position = static_cast<uint16_t>(position + recordLength(header));
+        }
+    }
+
+    bool WriteJournal::writeJournalHeader(uint32_t baseSequence)
+    {
+        uint8_t sector[SECTOR_SIZE];
+        memset(sector, 0, sizeof(sector));
+
+        JournalHeader header;
+        header.magic = JOURNAL_MAGIC;
+        header.baseSequence = baseSequence;
+        header.crc = crc32(0, reinterpret_cast<const uint8_t*>(&header), offsetof(JournalHeader, crc));
+        memcpy(sector, &header, sizeof(header));
+
+        return m_storage.write(m_storage.context, m_journal, 0, sector, sizeof(sector)) == sizeof(sector) &&
+               m_storage.sync(m_storage.context, m_journal);
+    }
+
+    bool WriteJournal::apply(const uint8_t* records, size_t length)
+    {
+        // One pass per target file, so interleaved appends to several files
+        // still cost one open each; order only matters within a file
+        char done[BATCH_FILES][PATH_LENGTH];
+        uint8_t doneCount = 0;
+        bool ok = true;
+        WriteRun run;
+
+        while (ok)
+        {
+            StorageBackend::Handle file = nullptr;
+            char current[PATH_LENGTH] = "";
+            run.length = 0;
+            size_t position = 0;
+
+            while (ok && position + sizeof(RecordHeader) <= length)
+            {
+                RecordHeader header;
+                memcpy(&header, records + position, sizeof(header));
+                if (!headerFits(position, sizeof(RecordHeader)) || header.magic != RECORD_MAGIC)
+                {
+                    position = nextSector(position);
+                    continue;
+                }
+
+                char path[PATH_LENGTH];
+                memcpy(path, records + position + sizeof(header), header.pathLength);
+                path[header.pathLength] = '\0';
+                const uint8_t* data = records + position + sizeof(header) + header.pathLength;
+                position += recordLength(header);
+
+                if (current[0] == '\0')
+                {
+                    bool applied = false;
+                    for (uint8_t i = 0; i < doneCount && !applied; i++)
+                    {
+                        applied = strcmp(done[i], path) == 0;
+                    }
+                    if (applied || doneCount == BATCH_FILES) continue;
+                    strcpy(current, path);
+                }
+                else if (strcmp(path, current) != 0)
+                {
+                    continue;
+                }
+
+                if (header.op == static_cast<uint8_t>(Op::WRITE))
+                {
+                    if (file)
+                    {
+                        ok = writeRun(file, run);
+                        m_storage.close(m_storage.context, file);
+                        file = nullptr;
+                    }
+                    m_storage.remove(m_storage.context, path);
+                }
+                if (file == nullptr)
+                {
+                    file = m_storage.open(m_storage.context, path, true);
+                    m_stats.filesOpened++;
+                    ok = file != nullptr;
+                }
+                if (!ok || header.dataLength == 0) continue;
+
+                // Records from interleaved files are short; gather the
+                // contiguous ones into sector-sized writes
+                if (run.length > 0 && (header.offset != run.offset + run.length || run.length + header.dataLength > SECTOR_SIZE))
+                {
+                    ok = writeRun(file, run);
+                }
+                if (header.dataLength >= SECTOR_SIZE)
+                {
+                    ok = ok && m_storage.write(m_storage.context, file, header.offset, data, header.dataLength) == header.dataLength;
+                    continue;
+                }
+                if (run.length == 0) run.offset = header.offset;
+                memcpy(run.data + run.length, data, header.dataLength);
+                run.length = static_cast<uint16_t>(run.length + header.dataLength);
+            }
+
+            if (file)
+            {
+                ok = ok && writeRun(file, run);
+                ok = m_storage.sync(m_storage.context, file) && ok;
+                m_storage.close(m_storage.context, file);
+            }
+            if (current[0] == '\0') break;
+            strcpy(done[doneCount++], current);
+        }
+        return ok;
+    }
+
+    bool WriteJournal::writeRun(StorageBackend::Handle file, WriteRun& run)
+    {
+        uint16_t length = run.length;
+        run.length = 0;
+        return length == 0 || m_storage.write(m_storage.context, file, run.offset, run.data, length) == length;
+    }
+
+    bool WriteJournal::replay()
+    {
+        uint32_t size = m_storage.size(m_storage.context, m_journal);
+
+        JournalHeader header;
+        bool headerValid = size >= SECTOR_SIZE &&
+            m_storage.read(m_storage.context, m_journal, 0, reinterpret_cast<uint8_t*>(&header), sizeof(header)) == sizeof(header) &&
+            header.magic == JOURNAL_MAGIC &&
+            header.crc == crc32(0, reinterpret_cast<const uint8_t*>(&header), offsetof(JournalHeader, crc));
+
+        // New sequence numbers must be above anything still readable in the
+        // file, or a stale record behind a torn batch could pass as current
+        uint32_t highest = 0;
+        uint32_t position = SECTOR_SIZE;
+        uint32_t expected = headerValid ? header.baseSequence : 0;
+        bool inSequence = headerValid;
+        uint16_t compact = 0;
+
+        while (position + sizeof(RecordHeader) <= size)
+        {
+            RecordHeader record;
+            if (!headerFits(position, sizeof(RecordHeader)) ||
+                m_storage.read(m_storage.context, m_journal, position, reinterpret_cast<uint8_t*>(&record), sizeof(record)) != sizeof(record) ||
+                record.magic != RECORD_MAGIC)
+            {
+                position = nextSector(position);
+                continue;
+            }
+
+            size_t total = recordLength(record);
+            size_t payload = total - sizeof(record);
+            bool valid = record.pathLength > 0 && record.pathLength < PATH_LENGTH &&
+                         (record.op == static_cast<uint8_t>(Op::APPEND) || record.op == static_cast<uint8_t>(Op::WRITE)) &&
+                         position + total <= size;
+
+            // Records in sequence are read straight into place in the buffer
+            // and anything else is checked in the free space behind them
+            bool keep = valid && inSequence && record.sequence == expected;
+            if (keep && !headerFits(compact, sizeof(record)))
+            {
+                uint16_t aligned = static_cast<uint16_t>(nextSector(compact));
+                memset(m_buffer + compact, 0, aligned - compact);
+                compact = aligned;
+            }
+            uint8_t* target = m_buffer + compact + (keep ? sizeof(record) : 0);
+            valid = valid && target + payload <= m_buffer + BUFFER_SIZE &&
+                m_storage.read(m_storage.context, m_journal, position + sizeof(record), target, payload) == payload &&
+                record.crc == recordCrc(record, target, target + record.pathLength);
+
+            if (!valid)
+            {
+                if (inSequence) m_stats.rejectedRecords++;
+                inSequence = false;
+                position = nextSector(position);
+                continue;
+            }
+
+            if (record.sequence > highest) highest = record.sequence;
+            if (keep)
+            {
+                memcpy(m_buffer + compact, &record, sizeof(record));
+                compact = static_cast<uint16_t>(compact + total);
+                expected++;
+                m_stats.replayedRecords++;
+            }
+            else
+            {
+                inSequence = false;
+            }
+            position += total;
+        }
+
+        m_nextSequence = (highest >= expected ? highest : expected) + 1;
+        m_baseSequence = m_nextSequence;
+        m_journalLength = SECTOR_SIZE;
+
+        if (compact > 0)
+        {
+            // Already durable in the journal; apply like a batch that failed to apply
+            m_staged = compact;
+            m_committed = true;
+            return flush();
+        }
+        return writeJournalHeader(m_nextSequence);
+    }
+
+    void WriteJournal::resetBatch()
+    {
+        m_staged = 0;
+        m_lastRecord = NO_RECORD;
+        m_committed = false;
+        m_targetCount = 0;
+    }
+
+    uint32_t WriteJournal::recordCrc(RecordHeader header, const uint8_t* path, const uint8_t* data)
+    {
+        header.crc = 0;
+        uint32_t crc = crc32(0, reinterpret_cast<const uint8_t*>(&header), sizeof(header));
+        crc = crc32(crc, path, header.pathLength);
+        return crc32(crc, data, header.dataLength);
+    }
+
+    uint32_t WriteJournal::crc32(uint32_t crc, const uint8_t* data, size_t length)
+    {
+        // Nibble table: 64 bytes of flash instead of 1 KB
+        static const uint32_t TABLE[16] =
+        {
+            0x00000000, 0x1DB71064, 0x3B6E20C8, 0x26D930AC, 0x76DC4190, 0x6B6B51F4, 0x4DB26158, 0x5005713C,
+            0xEDB88320, 0xF00F9344, 0xD6D6A3E8, 0xCB61B38C, 0x9B64C2B0, 0x86D3D2D4, 0xA00AE278, 0xBDBDF21C
+        };
+
+        crc = ~crc;
+        for (size_t i = 0; i < length; i++)
+        {
+            crc = TABLE[(crc ^ data[i]) & 0x0F] ^ (crc >> 4);
+            crc = TABLE[(crc ^ (data[i] >> 4)) & 0x0F] ^ (crc >> 4);
+        }
+        return ~crc;
+    }
+}
@@ -0,0 +1,179 @@
+/**
+ * @brief WriteJournal coalesces small file writes and applies them crash-safely
+ *
+ * Appends and rewrites are staged in RAM and committed in batches:
+ * - A batch is flushed when the buffer fills, when the oldest staged write
+ *   reaches its age limit, or on request (before deep sleep)
+ * - The batch is first written to a journal file in whole sectors and
+ *   synced, then applied to the target files, one open per file per batch
+ * - Back-to-back appends to one file share a record, so each file costs
+ *   one open and one write per batch however many lines were logged
+ * - Every record carries a sequence number, the target offset it lands
+ *   at and a CRC-32, so applying it twice gives the same file
+ * - A write stays within one batch unless it is larger than the buffer, in
+ *   which case it is committed in buffer-sized pieces
+ *
+ * On open the journal is replayed: records that fail their checksum or
+ * break the sequence (a write cut off by power loss, or stale sectors from
+ * an earlier batch) end the replay, and everything before them is applied
+ * again. Power loss can lose what was still in RAM but never leaves a
+ * partial or reordered write in a target file.
+ */
+
+#ifndef WRITE_JOURNAL_H
+#define WRITE_JOURNAL_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "StorageBackend.h"
+
+namespace PrefrontalCortex
+{
+    struct JournalStats
+    {
+        uint32_t writes;            // append()/write() calls accepted
+        uint32_t bytesStaged;
+        uint32_t flushes;
+        uint32_t sectorsWritten;    // Journal sectors
+        uint32_t filesOpened;       // Target opens while applying
+        uint32_t replayedRecords;
+        uint32_t rejectedRecords;   // Torn or stale records found on replay
+        uint32_t failures;          // Journal or target writes that did not complete
+        uint16_t staged;            // Bytes waiting in RAM
+    };
+
+    class WriteJournal
+    {
+    public:
+        static constexpr uint16_t SECTOR_SIZE = 512;
+        static constexpr uint16_t BUFFER_SIZE = 4096;           // Whole sectors
+        static constexpr uint8_t PATH_LENGTH = 48;
+        static constexpr uint8_t BATCH_FILES = 8;               // Distinct targets per batch
+        static constexpr uint32_t DEFAULT_MAX_DELAY_MS = 2000;
+
+        explicit WriteJournal(const StorageBackend& storage);
+        ~WriteJournal();
+
+        /**
+         * @brief Open the journal and apply whatever a previous run left in it
+         */
+        bool open(const char* journalPath);
+        void close();
+        bool isOpen() const { return m_journal != nullptr; }
+
+        /**
+         * @brief Flush once this many bytes are staged or the oldest is this old
+         */
+        void setFlushPolicy(uint16_t bytes, uint32_t maxDelayMs);
+
+        /**
+         * @brief Stage bytes for the end of a file
+         * @return false if the data could not be staged (journal closed or failing)
+         */
+        bool append(const char* path, const uint8_t* data, size_t length, uint32_t nowMs);
+
+        /**
+         * @brief Stage a replacement of a file's whole contents
+         */
+        bool write(const char* path, const uint8_t* data, size_t length, uint32_t nowMs);
+
+        /**
+         * @brief Flush if the oldest staged write has waited too long
+         */
+        void update(uint32_t nowMs);
+
+        /**
+         * @brief Commit and apply everything staged
+         */
+        bool flush();
+
+        /**
+         * @brief Whether writes to a path are still waiting, so readers can flush first
+         */
+        bool hasPending(const char* path) const;
+        bool hasPending() const { return m_staged > 0; }
+
+        JournalStats stats() const;
+
+        /**
+         * @brief CRC-32 (IEEE, reflected); pass the previous result to continue
+         */
+        static uint32_t crc32(uint32_t crc, const uint8_t* data, size_t length);
+
+    private:
+        enum class Op : uint8_t
+        {
+            APPEND = 1,
+            WRITE = 2
+        };
+
+        static constexpr uint16_t NO_RECORD = 0xFFFF;
+
+        struct RecordHeader
+        {
+            uint16_t magic;
+            uint8_t op;
+            uint8_t pathLength;
+            uint16_t dataLength;
+            uint16_t reserved;
+            uint32_t sequence;
+            uint32_t offset;            // Where the data lands in the target
+            uint32_t crc;               // Header with crc = 0, then path and data
+        };
+
+        struct JournalHeader
+        {
+            uint32_t magic;
+            uint32_t baseSequence;      // First record of the current batch
+            uint32_t crc;
+        };
+
+        struct TargetSize
+        {
+            char path[PATH_LENGTH];
+            uint32_t size;              // Size once the staged records are applied
+        };
+
+        struct WriteRun
+        {
+            uint32_t offset;
+            uint16_t length;
+            uint8_t data[SECTOR_SIZE];
+        };
+
+        StorageBackend m_storage;
+        StorageBackend::Handle m_journal;
+        char m_journalPath[PATH_LENGTH];
+        uint32_t m_journalLength;       // Header sector plus unapplied batches
+        uint32_t m_nextSequence;
+        uint32_t m_baseSequence;
+
+        uint8_t m_buffer[BUFFER_SIZE];
+        uint16_t m_staged;
+        uint16_t m_lastRecord;          // Offset of the newest record, which appends may grow
+        bool m_committed;               // m_buffer is in the journal but not yet applied
+        uint32_t m_stagedSinceMs;
+        uint16_t m_flushBytes;
+        uint32_t m_maxDelayMs;
+
+        TargetSize m_targets[BATCH_FILES];
+        uint8_t m_targetCount;
+
+        JournalStats m_stats;
+
+        bool stage(Op op, const char* path, const uint8_t* data, size_t length, uint32_t nowMs);
+        TargetSize* target(const char* path);
+        bool recordPathIs(uint16_t position, const char* path, size_t pathLength) const;
+        void sealRecords();
+        bool writeJournalHeader(uint32_t baseSequence);
+        bool apply(const uint8_t* records, size_t length);
+        bool writeRun(StorageBackend::Handle file, WriteRun& run);
+        bool replay();
+        void resetBatch();
+
+        static size_t recordLength(const RecordHeader& header) { return sizeof(RecordHeader) + header.pathLength + header.dataLength; }
+        static uint32_t recordCrc(RecordHeader header, const uint8_t* path, const uint8_t* data);
+    };
+}
+
+#endif // WRITE_JOURNAL_H
@@ -0,0 +1,253 @@
+/**
+ * @file CardContentCache.cpp
+ * @brief UID-keyed LRU of decoded card content with optional persistence
+ */
+
+#include "CardContentCache.h"
+#include <string.h>
+
+namespace PsychicCortex
+{
+    namespace
+    {
+        constexpr uint32_t CACHE_MAGIC = 0x4343434E;    // "NCCC"
+        constexpr uint16_t CACHE_VERSION = 1;
+        constexpr uint32_t FNV_OFFSET = 2166136261u;
+        constexpr uint32_t FNV_PRIME = 16777619u;
+
+        uint32_t fnv(uint32_t hash, const uint8_t* data, size_t length)
+        {
+            for (size_t i = 0; i < length; i++)
+            {
+                hash ^= data[i];
+                hash *= FNV_PRIME;
+            }
+            return hash;
+        }
+    }
+
+    CardContentCache::CardContentCache()
+        : m_stamp(0)
+        , m_dirty(false)
+    {
+        memset(m_entries, 0, sizeof(m_entries));
+        memset(m_used, 0, sizeof(m_used));
+        memset(&m_stats, 0, sizeof(m_stats));
+    }
+
+    const CardContent* CardContentCache::find(const uint8_t* uid, uint8_t uidLength)
+    {
+        int slot = indexOf(uid, uidLength);
+        if (slot < 0)
+        {
+            m_stats.misses++;
+            return nullptr;
+        }
+        m_stats.hits++;
+        m_used[slot] = ++m_stamp;
+        return &m_entries[slot];
+    }
+
+    bool CardContentCache::validate(const uint8_t* uid, uint8_t uidLength, uint32_t hash, uint16_t dataLength)
+    {
+        int slot = indexOf(uid, uidLength);
+        if (slot < 0)
+        {
+            return false;
+        }
+        if (m_entries[slot].hash == hash && m_entries[slot].dataLength == dataLength)
+        {
+            m_stats.confirmed++;
+            return true;
+        }
+        m_stats.stale++;
+        m_used[slot] = 0;
+        m_dirty = true;
+        return false;
+    }
+
+    void CardContentCache::store(const CardContent& content)
+    {
+        if (content.uidLength == 0 || content.uidLength > CardContent::MAX_UID)
+        {
+            return;
+        }
+
+        int slot = indexOf(content.uid, content.uidLength);
+        if (slot < 0)
+        {
+            slot = 0;
+            for (uint8_t i = 1; i < CAPACITY; i++)
+            {
+                if (m_used[i] < m_used[slot]) slot = i;
+            }
+            if (m_used[slot] != 0) m_stats.evictions++;
+        }
+
+        m_entries[slot] = content;
+        m_used[slot] = ++m_stamp;
+        m_stats.stores++;
+        m_dirty = true;
+    }
+
+    bool CardContentCache::invalidate(const uint8_t* uid, uint8_t uidLength)
+    {
+        int slot = indexOf(uid, uidLength);
+        if (slot < 0)
+        {
+            return false;
+        }
+        m_used[slot] = 0;
+        m_dirty = true;
+        return true;
+    }
+
+    void CardContentCache::clear()
+    {
+        memset(m_used, 0, sizeof(m_used));
+        m_dirty = true;
+    }
+
+    uint8_t CardContentCache::size() const
+    {
+        uint8_t count = 0;
+        for (uint8_t i = 0; i < CAPACITY; i++)
+        {
+            if (m_used[i] != 0) count++;
+        }
+        return count;
+    }
+
+    uint8_t CardContentCache::hitRate() const
+    {
+        uint32_t lookups = m_stats.hits + m_stats.misses;
+        return lookups == 0 ? 0 : static_cast<uint8_t>(static_cast<uint64_t>(m_stats.hits) * 100 / lookups);
+    }
+
+    bool CardContentCache::load(const StorageBackend& storage, const char* path)
+    {
+        memset(m_used, 0, sizeof(m_used));
+        m_stamp = 0;
+        m_dirty = false;
+
+        StorageBackend::Handle file = storage.open(storage.context, path, false);
+        if (file == nullptr)
+        {
+            return false;
+        }
+
+        Header header;
+        bool ok = storage.read(storage.context, file, 0, reinterpret_cast<uint8_t*>(&header), sizeof(header)) == sizeof(header) &&
+                  header.magic == CACHE_MAGIC && header.version == CACHE_VERSION &&
+                  header.entrySize == sizeof(CardContent) && header.count <= CAPACITY;
+        size_t bytes = ok ? header.count * sizeof(CardContent) : 0;
+        if (ok)
+        {
+            ok = storage.read(storage.context, file, sizeof(header), reinterpret_cast<uint8_t*>(m_entries), bytes) == bytes &&
+                 fnv(FNV_OFFSET, reinterpret_cast<const uint8_t*>(m_entries), bytes) == header.checksum;
+        }
+        storage.close(storage.context, file);
+
+        if (!ok)
+        {
+            return false;
+        }
+
+        // Saved oldest first, so the stamps come back in the same order
+        for (uint32_t i = 0; i < header.count; i++)
+        {
+            const CardContent& entry = m_entries[i];
+            if (entry.uidLength != 0 && entry.uidLength <= CardContent::MAX_UID)
+            {
+                m_used[i] = ++m_stamp;
+            }
+        }
+        m_stats.loads++;
+        return true;
+    }
+
+    bool CardContentCache::save(const StorageBackend& storage, const char* path)
+    {
+        size_t length = strlen(path);
+        if (length + 5 > PATH_LENGTH)
+        {
+            return false;
+        }
+        char temp[PATH_LENGTH];
+        memcpy(temp, path, length);
+        memcpy(temp + length, ".tmp", 5);
+
+        // Slots in stamp order, least recently used first
+        uint8_t order[CAPACITY];
+        uint8_t count = 0;
+        for (uint8_t i = 0; i < CAPACITY; i++)
+        {
+            if (m_used[i] == 0) continue;
+            uint8_t at = count++;
+            while (at > 0 && m_used[order[at - 1]] > m_used[i])
+            {
+                order[at] = order[at - 1];
+                at--;
+            }
+            order[at] = i;
+        }
+
+        StorageBackend::Handle file = storage.open(storage.context, temp, true);
+        if (file == nullptr)
+        {
+            return false;
+        }
+
+        Header header;
+        header.magic = CACHE_MAGIC;
+        header.version = CACHE_VERSION;
+        header.entrySize = sizeof(CardContent);
+        header.count = count;
+        header.checksum = FNV_OFFSET;
+        bool ok = true;
+        uint32_t offset = sizeof(header);
+        for (uint8_t i = 0; i < count && ok; i++)
+        {
+            const uint8_t* entry = reinterpret_cast<const uint8_t*>(&m_entries[order[i]]);
+            header.checksum = fnv(header.checksum, entry, sizeof(CardContent));
+            ok = storage.write(storage.context, file, offset, entry, sizeof(CardContent)) == sizeof(CardContent);
+            offset += sizeof(CardContent);
+        }
+        if (ok) ok = storage.write(storage.context, file, 0, reinterpret_cast<const uint8_t*>(&header), sizeof(header)) == sizeof(header);
+        if (ok) ok = storage.sync(storage.context, file);
+        storage.close(storage.context, file);
+
+        if (!ok)
+        {
+            storage.remove(storage.context, temp);
+            return false;
+        }
+        storage.remove(storage.context, path);
+        if (!storage.rename(storage.context, temp, path))
+        {
+            return false;
+        }
+
+        m_dirty = false;
+        m_stats.saves++;
+        return true;
+    }
+
+    uint32_t CardContentCache::hash(const uint8_t* data, size_t length)
+    {
+        return fnv(FNV_OFFSET, data, length);
+    }
+
+    int CardContentCache::indexOf(const uint8_t* uid, uint8_t uidLength) const
+    {
+        for (uint8_t i = 0; i < CAPACITY; i++)
+        {
+            const CardContent& entry = m_entries[i];
+            if (m_used[i] != 0 && entry.uidLength == uidLength && memcmp(entry.uid, uid, uidLength) == 0)
+            {
+                return i;
+            }
+        }
+        return -1;
+    }
+}
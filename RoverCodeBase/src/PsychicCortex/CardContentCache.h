@@ -0,0 +1,143 @@
+/**
+ * @brief CardContentCache remembers what the last few cards carried, by UID
+ *
+ * A card is mostly tapped again and again, and every tap read its whole user
+ * area and worked out the same summary, melody and LED pattern. An entry
+ * keeps all of that, so a known card can be reacted to as soon as its UID
+ * answers:
+ * - Entries are found by UID and the least recently used one gives way
+ * - NTAG keeps no count of writes (its NFC counter counts reads), so an entry
+ *   is checked by a hash and length of the user area, taken from the read
+ *   that follows the reaction; a card written elsewhere is noticed on that tap
+ * - Entries can be saved to and loaded from storage as one small file, written
+ *   next to itself and renamed over the old one
+ *
+ * Platform-free: storage goes through StorageBackend, so the cache runs on
+ * host against plain files.
+ */
+
+#ifndef CARD_CONTENT_CACHE_H
+#define CARD_CONTENT_CACHE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../PrefrontalCortex/StorageBackend.h"
+
+namespace PsychicCortex
+{
+    using PrefrontalCortex::StorageBackend;
+
+    struct CardNote
+    {
+        uint16_t frequency;
+        uint16_t duration;          // Milliseconds, as is gap
+        uint16_t gap;
+    };
+
+    /**
+     * @brief Everything a card is reacted to with, worked out once
+     */
+    struct CardContent
+    {
+        static constexpr uint8_t MAX_UID = 10;
+        static constexpr uint16_t TEXT_LENGTH = 256;
+        static constexpr uint8_t MAX_NOTES = 64;        // The start of the song; the rest is composed from the card
+
+        uint8_t uid[MAX_UID];
+        uint8_t uidLength;
+        bool locked;
+        uint16_t dataLength;        // User area bytes the hash covers
+        uint32_t hash;
+        char text[TEXT_LENGTH];     // Summary of the NDEF records, as NFCCard::text
+        uint16_t experience;
+        uint8_t pattern[MAX_UID];   // Seeds for LEDManager::displayCardPattern
+        uint8_t patternLength;
+        uint8_t noteCount;
+        CardNote notes[MAX_NOTES];
+    };
+
+    struct CardContentStats
+    {
+        uint32_t hits;
+        uint32_t misses;
+        uint32_t stores;
+        uint32_t evictions;
+        uint32_t confirmed;         // Hits the read that followed agreed with
+        uint32_t stale;             // Hits the card had been rewritten since
+        uint32_t loads;
+        uint32_t saves;
+    };
+
+    class CardContentCache
+    {
+    public:
+        static constexpr uint8_t CAPACITY = 8;
+
+        CardContentCache();
+
+        /**
+         * @brief Entry for a UID, now the most recently used
+         * @return nullptr on a miss; valid until the next store() or load()
+         */
+        const CardContent* find(const uint8_t* uid, uint8_t uidLength);
+
+        /**
+         * @brief Check an entry against what was read off the card; a mismatch drops it
+         * @return true if the entry is still right
+         */
+        bool validate(const uint8_t* uid, uint8_t uidLength, uint32_t hash, uint16_t dataLength);
+
+        /**
+         * @brief Add or replace the entry for content.uid, evicting the least recently used
+         */
+        void store(const CardContent& content);
+        bool invalidate(const uint8_t* uid, uint8_t uidLength);
+        void clear();
+
+        uint8_t size() const;
+        bool isDirty() const { return m_dirty; }
+        const CardContentStats& stats() const { return m_stats; }
+
+        /**
+         * @brief Hits per hundred lookups
+         */
+        uint8_t hitRate() const;
+
+        /**
+         * @brief Replace the entries with a saved set; a missing, foreign or damaged file leaves none
+         */
+        bool load(const StorageBackend& storage, const char* path);
+
+        /**
+         * @brief Write the entries, least recently used first; path plus ".tmp" must be usable
+         */
+        bool save(const StorageBackend& storage, const char* path);
+
+        /**
+         * @brief FNV-1a of a user area
+         */
+        static uint32_t hash(const uint8_t* data, size_t length);
+
+    private:
+        static constexpr uint8_t PATH_LENGTH = 40;
+
+        struct Header
+        {
+            uint32_t magic;
+            uint16_t version;
+            uint16_t entrySize;     // Catches a file from firmware with another layout
+            uint32_t count;
+            uint32_t checksum;      // FNV-1a of the entries
+        };
+
+        CardContent m_entries[CAPACITY];
+        uint32_t m_used[CAPACITY];  // Stamp for least recently used; 0 is empty
+        uint32_t m_stamp;
+        bool m_dirty;
+        CardContentStats m_stats;
+
+        int indexOf(const uint8_t* uid, uint8_t uidLength) const;
+    };
+}
+
+#endif // CARD_CONTENT_CACHE_H
@@ -0,0 +1,246 @@
+/**
+ * @file IRCodeDatabase.cpp
+ * @brief Block-buffered reader and writer for the binary IR code database
+ */
+
+#include "IRCodeDatabase.h"
+#include <string.h>
+
+namespace PsychicCortex
+{
+    namespace
+    {
+        constexpr uint32_t DATABASE_MAGIC = 0x44524952;     // "RIRD"
+        constexpr uint16_t DATABASE_VERSION = 1;
+        constexpr uint8_t MAX_PAYLOAD_BITS = 32;
+
+        // Header field offsets
+        constexpr uint8_t AT_MAGIC = 0;
+        constexpr uint8_t AT_VERSION = 4;
+        constexpr uint8_t AT_RECORD_SIZE = 6;
+        constexpr uint8_t AT_COUNT = 8;
+        constexpr uint8_t AT_REGIONS = 12;
+        constexpr uint8_t AT_REGION_STARTS = 16;
+
+        void put16(uint8_t* out, uint16_t value)
+        {
+            out[0] = static_cast<uint8_t>(value);
+            out[1] = static_cast<uint8_t>(value >> 8);
+        }
+
+        void put32(uint8_t* out, uint32_t value)
+        {
+            for (uint8_t i = 0; i < 4; i++) out[i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+
+        uint16_t get16(const uint8_t* in)
+        {
+            return static_cast<uint16_t>(in[0] | (in[1] << 8));
+        }
+
+        uint32_t get32(const uint8_t* in)
+        {
+            return static_cast<uint32_t>(in[0]) | (static_cast<uint32_t>(in[1]) << 8) |
+                   (static_cast<uint32_t>(in[2]) << 16) | (static_cast<uint32_t>(in[3]) << 24);
+        }
+    }
+
+    static_assert(AT_REGION_STARTS + 4 * IRCodeDatabase::MAX_REGIONS <= IRCodeDatabase::HEADER_SIZE, "Region table must fit the header");
+
+    IRCodeDatabase::IRCodeDatabase(const StorageBackend& storage)
+        : m_storage(storage)
+        , m_file(nullptr)
+        , m_count(0)
+        , m_regionCount(0)
+        , m_position(0)
+        , m_blockStart(0)
+        , m_blockCount(0)
+    {
+        memset(m_regionStarts, 0, sizeof(m_regionStarts));
+        memset(m_block, 0, sizeof(m_block));
+        memset(&m_stats, 0, sizeof(m_stats));
+    }
+
+    IRCodeDatabase::~IRCodeDatabase()
+    {
+        close();
+    }
+
+    bool IRCodeDatabase::open(const char* path)
+    {
+        close();
+        m_file = m_storage.open(m_storage.context, path, false);
+        if (m_file == nullptr)
+        {
+            return false;
+        }
+
+        uint8_t header[HEADER_SIZE];
+        bool ok = m_storage.read(m_storage.context, m_file, 0, header, sizeof(header)) == sizeof(header) &&
+                  get32(header + AT_MAGIC) == DATABASE_MAGIC && get16(header + AT_VERSION) == DATABASE_VERSION &&
+                  get16(header + AT_RECORD_SIZE) == RECORD_SIZE && header[AT_REGIONS] <= MAX_REGIONS;
+        if (ok)
+        {
+            m_count = get32(header + AT_COUNT);
+            m_regionCount = header[AT_REGIONS];
+            ok = m_storage.size(m_storage.context, m_file) >= HEADER_SIZE + static_cast<uint64_t>(m_count) * RECORD_SIZE;
+        }
+
+        // Region starts must climb and stay inside the file
+        uint32_t previous = 0;
+        for (uint8_t r = 0; r < m_regionCount && ok; r++)
+        {
+            m_regionStarts[r] = get32(header + AT_REGION_STARTS + 4 * r);
+            ok = m_regionStarts[r] >= previous && m_regionStarts[r] <= m_count;
+            previous = m_regionStarts[r];
+        }
+
+        if (!ok)
+        {
+            close();
+            return false;
+        }
+        seek(0);
+        return true;
+    }
+
+    void IRCodeDatabase::close()
+    {
+        if (m_file != nullptr)
+        {
+            m_storage.close(m_storage.context, m_file);
+            m_file = nullptr;
+        }
+        m_count = 0;
+        m_regionCount = 0;
+        m_blockCount = 0;
+        m_position = 0;
+    }
+
+    uint32_t IRCodeDatabase::regionStart(uint8_t region) const
+    {
+        return region < m_regionCount ? m_regionStarts[region] : m_count;
+    }
+
+    void IRCodeDatabase::seek(uint32_t index)
+    {
+        m_position = index < m_count ? index : m_count;
+    }
+
+    bool IRCodeDatabase::next(IRCode& code)
+    {
+        while (m_position < m_count)
+        {
+            if ((m_position < m_blockStart || m_position >= m_blockStart + m_blockCount) && !fill())
+            {
+                return false;
+            }
+
+            unpackRecord(m_block + (m_position - m_blockStart) * RECORD_SIZE, code);
+            m_position++;
+            if (code.protocol == IRProtocol::NONE || code.protocol > IRProtocol::SAMSUNG ||
+                code.bits == 0 || code.bits > MAX_PAYLOAD_BITS)
+            {
+                m_stats.badRecords++;
+                continue;
+            }
+            m_stats.codes++;
+            return true;
+        }
+        return false;
+    }
+
+    bool IRCodeDatabase::fill()
+    {
+        uint32_t remaining = m_count - m_position;
+        uint8_t records = remaining < BLOCK_RECORDS ? static_cast<uint8_t>(remaining) : BLOCK_RECORDS;
+        size_t bytes = static_cast<size_t>(records) * RECORD_SIZE;
+        uint32_t offset = HEADER_SIZE + m_position * RECORD_SIZE;
+
+        m_blockCount = 0;
+        if (m_file == nullptr || m_storage.read(m_storage.context, m_file, offset, m_block, bytes) != bytes)
+        {
+            return false;
+        }
+        m_blockStart = m_position;
+        m_blockCount = records;
+        m_stats.blockReads++;
+        return true;
+    }
+
+    bool IRCodeDatabase::write(const StorageBackend& storage, const char* path, IRCodeSource source, void* context, uint32_t count)
+    {
+        StorageBackend::Handle file = storage.open(storage.context, path, true);
+        if (file == nullptr)
+        {
+            return false;
+        }
+
+        uint8_t header[HEADER_SIZE];
+        memset(header, 0, sizeof(header));
+        uint8_t block[BLOCK_RECORDS * RECORD_SIZE];
+        uint8_t buffered = 0;
+        uint32_t offset = HEADER_SIZE;
+        int16_t region = -1;
+        bool ok = true;
+
+        for (uint32_t i = 0; i < count && ok; i++)
+        {
+            IRCode code;
+            ok = source(context, i, code) && code.region >= region && code.region < MAX_REGIONS;
+            if (!ok) break;
+
+            // Regions are contiguous; any skipped over start where the next one does
+            while (region < code.region)
+            {
+                region++;
+                put32(header + AT_REGION_STARTS + 4 * region, i);
+            }
+
+            packRecord(code, block + buffered * RECORD_SIZE);
+            if (++buffered == BLOCK_RECORDS || i + 1 == count)
+            {
+                size_t bytes = static_cast<size_t>(buffered) * RECORD_SIZE;
+                ok = storage.write(storage.context, file, offset, block, bytes) == bytes;
+                offset += bytes;
+                buffered = 0;
+            }
+        }
+
+        if (ok)
+        {
+            put32(header + AT_MAGIC, DATABASE_MAGIC);
+            put16(header + AT_VERSION, DATABASE_VERSION);
+            put16(header + AT_RECORD_SIZE, RECORD_SIZE);
+            put32(header + AT_COUNT, count);
+            header[AT_REGIONS] = static_cast<uint8_t>(region + 1);
+            ok = storage.write(storage.context, file, 0, header, sizeof(header)) == sizeof(header) &&
+                 storage.sync(storage.context, file);
+        }
+        storage.close(storage.context, file);
+
+        if (!ok)
+        {
+            storage.remove(storage.context, path);
+        }
+        return ok;
+    }
+
+    void IRCodeDatabase::packRecord(const IRCode& code, uint8_t* out)
+    {
+        out[0] = static_cast<uint8_t>(code.protocol);
+        out[1] = code.bits;
+        out[2] = code.repeats;
+        out[3] = code.region;
+        put32(out + 4, code.payload);
+    }
+
+    void IRCodeDatabase::unpackRecord(const uint8_t* in, IRCode& code)
+    {
+        code.protocol = static_cast<IRProtocol>(in[0]);
+        code.bits = in[1];
+        code.repeats = in[2];
+        code.region = in[3];
+        code.payload = get32(in + 4);
+    }
+}
@@ -0,0 +1,125 @@
+/**
+ * @brief IRCodeDatabase streams IR codes from a compact binary file
+ *
+ * Each code is what a protocol encoder needs and nothing more, so thousands
+ * fit in a few tens of kilobytes and are read a block at a time:
+ * - A 64-byte header: magic "RIRD", version, record size, code count, and
+ *   the first code of each region, all little-endian
+ * - Then 8-byte records: protocol, bits, repeats, region, 32-bit payload
+ * - Codes are grouped by region, so a blast can start at any region and
+ *   run on to the end
+ *
+ * The same layout can be produced off the rover by any script; write()
+ * builds one from a generator, which is how the built-in set is put on SD.
+ *
+ * Platform-free: files go through StorageBackend, so the reader runs on host
+ * against plain files.
+ */
+
+#ifndef IR_CODE_DATABASE_H
+#define IR_CODE_DATABASE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../PrefrontalCortex/StorageBackend.h"
+
+namespace PsychicCortex
+{
+    using PrefrontalCortex::StorageBackend;
+
+    enum class IRProtocol : uint8_t
+    {
+        NONE,
+        NEC,
+        SONY,
+        RC5,
+        RC6,                // Mode 0
+        SAMSUNG
+    };
+
+    struct IRCode
+    {
+        IRProtocol protocol;
+        uint8_t bits;
+        uint8_t repeats;            // Frames sent after the first
+        uint8_t region;
+        uint32_t payload;           // Sent most significant bit first
+    };
+
+    struct IRDatabaseStats
+    {
+        uint32_t codes;             // Handed out by next()
+        uint32_t blockReads;
+        uint32_t badRecords;        // Skipped: unknown protocol or more bits than the payload holds
+    };
+
+    /**
+     * @brief Produces code index of a set being written
+     */
+    typedef bool (*IRCodeSource)(void* context, uint32_t index, IRCode& code);
+
+    class IRCodeDatabase
+    {
+    public:
+        static constexpr uint8_t MAX_REGIONS = 8;
+        static constexpr uint16_t HEADER_SIZE = 64;
+        static constexpr uint8_t RECORD_SIZE = 8;
+        static constexpr uint8_t BLOCK_RECORDS = 64;    // One 512-byte sector per read
+
+        explicit IRCodeDatabase(const StorageBackend& storage);
+        ~IRCodeDatabase();
+
+        /**
+         * @brief Open a database and check its header; the first code is next
+         */
+        bool open(const char* path);
+        void close();
+        bool isOpen() const { return m_file != nullptr; }
+
+        uint32_t count() const { return m_count; }
+        uint8_t regionCount() const { return m_regionCount; }
+
+        /**
+         * @brief Index of a region's first code; count() past the last region
+         */
+        uint32_t regionStart(uint8_t region) const;
+
+        /**
+         * @brief Continue from code index
+         */
+        void seek(uint32_t index);
+        uint32_t position() const { return m_position; }
+
+        /**
+         * @brief Next usable code, reading another block when the buffered one runs out
+         * @return false at the end or if the file can no longer be read
+         */
+        bool next(IRCode& code);
+
+        const IRDatabaseStats& stats() const { return m_stats; }
+
+        /**
+         * @brief Write count codes from source, grouped by region in the order given
+         * @return false if source fails, regions go backwards or exceed MAX_REGIONS, or storage fails
+         */
+        static bool write(const StorageBackend& storage, const char* path, IRCodeSource source, void* context, uint32_t count);
+
+    private:
+        StorageBackend m_storage;
+        StorageBackend::Handle m_file;
+        uint32_t m_count;
+        uint8_t m_regionCount;
+        uint32_t m_regionStarts[MAX_REGIONS];
+        uint32_t m_position;        // Index of the code next() looks at
+        uint32_t m_blockStart;      // Index of the first buffered code
+        uint8_t m_blockCount;       // Buffered codes; 0 when nothing is
+        uint8_t m_block[BLOCK_RECORDS * RECORD_SIZE];
+        IRDatabaseStats m_stats;
+
+        bool fill();
+        static void packRecord(const IRCode& code, uint8_t* out);
+        static void unpackRecord(const uint8_t* in, IRCode& code);
+    };
+}
+
+#endif // IR_CODE_DATABASE_H
@@ -0,0 +1,250 @@
+/**
+ * @file IREncoder.cpp
+ * @brief IR protocol timings laid out as RMT items
+ */
+
+#include "IREncoder.h"
+
+namespace PsychicCortex
+{
+    namespace
+    {
+        /**
+         * @brief A protocol sent as a header, a mark-and-space per bit and a footer
+         *
+         * Timings in microseconds, as IRremoteESP8266 sends them.
+         */
+        struct PulseProtocol
+        {
+            uint32_t carrierHz;
+            uint8_t dutyPercent;
+            uint16_t headerMark;
+            uint16_t headerSpace;
+            uint16_t oneMark;
+            uint16_t oneSpace;
+            uint16_t zeroMark;
+            uint16_t zeroSpace;
+            uint16_t footerMark;        // 0 for none
+            uint32_t period;            // Frame start to frame start, at least
+            uint32_t minGap;
+            uint16_t repeatSpace;       // Header space of a short repeat frame; 0 repeats the whole frame
+        };
+
+        // Indexed by PULSE_*
+        const PulseProtocol PULSE_PROTOCOLS[] = {
+            { 38000, 33, 8960, 4480, 560, 1680, 560, 560, 560, 108000, 22320, 2240 },   // NEC
+            { 40000, 33, 2400, 600, 1200, 600, 600, 600, 0, 45000, 10000, 0 },          // Sony
+            { 38000, 33, 4480, 4480, 560, 1680, 560, 560, 560, 108000, 20000, 0 }       // Samsung
+        };
+        constexpr uint8_t PULSE_NEC = 0;
+        constexpr uint8_t PULSE_SONY = 1;
+        constexpr uint8_t PULSE_SAMSUNG = 2;
+
+        // Manchester protocols
+        constexpr uint32_t MANCHESTER_HZ = 36000;
+        constexpr uint8_t MANCHESTER_DUTY = 25;
+        constexpr uint16_t RC5_T = 889;
+        constexpr uint32_t RC5_PERIOD = 113778;
+        constexpr uint32_t RC5_MIN_GAP = 10000;
+        constexpr uint8_t RC5X_BITS = 13;              // Carries the second start bit as its field bit
+        constexpr uint16_t RC6_T = 444;
+        constexpr uint16_t RC6_LEADER_MARK = 6 * RC6_T;
+        constexpr uint16_t RC6_LEADER_SPACE = 2 * RC6_T;
+        constexpr uint8_t RC6_TRAILER_BIT = 3;         // After the three mode bits; twice as long
+        constexpr uint32_t RC6_MIN_GAP = 83000;
+    }
+
+    IREncoder::IREncoder(IRFrame& frame)
+        : m_frame(frame)
+        , m_started(false)
+        , m_pendingLevel(false)
+        , m_pendingMicros(0)
+        , m_secondHalf(false)
+        , m_overflow(false)
+        , m_micros(0)
+        , m_frameStart(0)
+    {
+        frame.count = 0;
+        frame.micros = 0;
+    }
+
+    bool IREncoder::encode(const IRCode& code, IRFrame& frame)
+    {
+        IREncoder encoder(frame);
+        switch (code.protocol)
+        {
+            case IRProtocol::NEC:
+                encoder.pulses(code, PULSE_NEC);
+                break;
+            case IRProtocol::SONY:
+                encoder.pulses(code, PULSE_SONY);
+                break;
+            case IRProtocol::SAMSUNG:
+                encoder.pulses(code, PULSE_SAMSUNG);
+                break;
+            case IRProtocol::RC5:
+                encoder.manchester(code, false);
+                break;
+            case IRProtocol::RC6:
+                encoder.manchester(code, true);
+                break;
+            default:
+                return false;
+        }
+        return encoder.finish();
+    }
+
+    void IREncoder::pulses(const IRCode& code, uint8_t protocol)
+    {
+        const PulseProtocol& p = PULSE_PROTOCOLS[protocol];
+        m_frame.carrierHz = p.carrierHz;
+        m_frame.dutyPercent = p.dutyPercent;
+
+        for (uint16_t frame = 0; frame <= code.repeats; frame++)
+        {
+            m_frameStart = m_micros;
+            if (frame > 0 && p.repeatSpace != 0)
+            {
+                mark(p.headerMark);
+                space(p.repeatSpace);
+                mark(p.footerMark);
+                gap(p.period, p.minGap);
+                continue;
+            }
+
+            mark(p.headerMark);
+            space(p.headerSpace);
+            for (int8_t bit = code.bits - 1; bit >= 0; bit--)
+            {
+                bool one = (code.payload >> bit) & 1;
+                mark(one ? p.oneMark : p.zeroMark);
+                space(one ? p.oneSpace : p.zeroSpace);
+            }
+            mark(p.footerMark);
+            gap(p.period, p.minGap);
+        }
+    }
+
+    void IREncoder::manchester(const IRCode& code, bool rc6)
+    {
+        m_frame.carrierHz = MANCHESTER_HZ;
+        m_frame.dutyPercent = MANCHESTER_DUTY;
+        uint16_t t = rc6 ? RC6_T : RC5_T;
+
+        for (uint16_t frame = 0; frame <= code.repeats; frame++)
+        {
+            m_frameStart = m_micros;
+            if (rc6)
+            {
+                // Leader, then a start bit of 1
+                mark(RC6_LEADER_MARK);
+                space(RC6_LEADER_SPACE);
+                mark(t);
+                space(t);
+            }
+            else
+            {
+                // Start bits of 1; the space before the first mark is idle anyway
+                uint8_t startBits = code.bits >= RC5X_BITS ? 1 : 2;
+                for (uint8_t i = 0; i < startBits; i++)
+                {
+                    space(t);
+                    mark(t);
+                }
+            }
+
+            for (int8_t bit = code.bits - 1; bit >= 0; bit--)
+            {
+                bool one = (code.payload >> bit) & 1;
+                uint16_t half = rc6 && code.bits - 1 - bit == RC6_TRAILER_BIT ? 2 * t : t;
+
+                // RC6 sends a one as mark then space; RC5 the other way round
+                if (one == rc6)
+                {
+                    mark(half);
+                    space(half);
+                }
+                else
+                {
+                    space(half);
+                    mark(half);
+                }
+            }
+
+            if (rc6) gap(0, RC6_MIN_GAP);
+            else gap(RC5_PERIOD, RC5_MIN_GAP);
+        }
+    }
+
+    void IREncoder::gap(uint32_t period, uint32_t minGap)
+    {
+        uint32_t elapsed = m_micros - m_frameStart;
+        uint32_t length = period > elapsed + minGap ? period - elapsed : minGap;
+        space(length);
+    }
+
+    void IREncoder::add(bool high, uint32_t micros)
+    {
+        if (micros == 0)
+        {
+            return;
+        }
+        if (!m_started)
+        {
+            if (!high) return;
+            m_started = true;
+        }
+        if (m_pendingMicros != 0 && high != m_pendingLevel)
+        {
+            flush();
+        }
+        m_pendingLevel = high;
+        m_pendingMicros += micros;
+        m_micros += micros;
+    }
+
+    void IREncoder::flush()
+    {
+        while (m_pendingMicros > 0)
+        {
+            uint16_t length = m_pendingMicros > MAX_DURATION ? MAX_DURATION : static_cast<uint16_t>(m_pendingMicros);
+            half(m_pendingLevel, length);
+            m_pendingMicros -= length;
+        }
+    }
+
+    void IREncoder::half(bool high, uint16_t micros)
+    {
+        if (m_frame.count == IRFrame::CAPACITY)
+        {
+            m_overflow = true;
+            return;
+        }
+
+        uint32_t bits = micros | (high ? 0x8000u : 0u);
+        if (!m_secondHalf)
+        {
+            m_frame.items[m_frame.count] = bits;
+            m_secondHalf = true;
+        }
+        else
+        {
+            m_frame.items[m_frame.count++] |= bits << 16;
+            m_secondHalf = false;
+        }
+    }
+
+    bool IREncoder::finish()
+    {
+        flush();
+
+        // A lone first half ends in a zero duration, which the RMT takes as the end
+        if (m_secondHalf && !m_overflow)
+        {
+            m_frame.count++;
+            m_secondHalf = false;
+        }
+        m_frame.micros = m_micros;
+        return !m_overflow && m_frame.count > 0;
+    }
+}
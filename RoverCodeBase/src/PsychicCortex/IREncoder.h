@@ -0,0 +1,85 @@
+/**
+ * @brief IREncoder turns an IRCode into the mark and space timings of its protocol
+ *
+ * IRsend drives the LED by toggling a pin and spinning through each burst,
+ * so nothing else runs while a code is sent. Here a code is laid out ahead
+ * of time as RMT items, which the RMT peripheral plays on its own:
+ * - Items use the rmt_item32_t layout: two halves of a 15-bit duration and
+ *   a level, at one microsecond per tick
+ * - Adjacent halves at the same level are merged, so Manchester codes
+ *   (RC5, RC6) take no more items than they need, and durations too long
+ *   for one half are split across several
+ * - Each frame is followed by the gap its protocol needs before the next,
+ *   so a frame that has finished playing can be followed at once
+ * - Repeats are laid out too: NEC sends its short repeat frame, the others
+ *   send the whole frame again
+ *
+ * Platform-free: nothing here touches the RMT, so codes can be encoded and
+ * checked on host.
+ */
+
+#ifndef IR_ENCODER_H
+#define IR_ENCODER_H
+
+#include <stdint.h>
+#include "IRCodeDatabase.h"
+
+namespace PsychicCortex
+{
+    struct IRFrame
+    {
+        static constexpr uint16_t CAPACITY = 128;       // Items; three 15-bit Sony frames take 48
+
+        uint32_t items[CAPACITY];
+        uint16_t count;
+        uint32_t carrierHz;
+        uint8_t dutyPercent;
+        uint32_t micros;            // On air, gaps included
+    };
+
+    class IREncoder
+    {
+    public:
+        static constexpr uint16_t MAX_DURATION = 0x7FFF;    // One item half
+
+        /**
+         * @brief Lay out code and its repeats
+         * @return false for an unknown protocol or if it does not fit in the frame
+         */
+        static bool encode(const IRCode& code, IRFrame& frame);
+
+        /**
+         * @brief Duration and level of item half 0 or 1
+         */
+        static uint16_t duration(uint32_t item, uint8_t half) { return (item >> (16 * half)) & MAX_DURATION; }
+        static bool level(uint32_t item, uint8_t half) { return (item >> (16 * half + 15)) & 1; }
+
+    private:
+        IRFrame& m_frame;
+        bool m_started;             // Spaces before the first mark are dropped
+        bool m_pendingLevel;
+        uint32_t m_pendingMicros;   // Same-level time not yet written
+        bool m_secondHalf;          // The last item has its first half only
+        bool m_overflow;
+        uint32_t m_micros;          // Laid out so far, pending time included
+        uint32_t m_frameStart;      // m_micros when the frame being laid out began
+
+        explicit IREncoder(IRFrame& frame);
+
+        void mark(uint32_t micros) { add(true, micros); }
+        void space(uint32_t micros) { add(false, micros); }
+        void add(bool high, uint32_t micros);
+        void flush();
+        void half(bool high, uint16_t micros);
+        bool finish();
+
+        /**
+         * @brief Space to the end of the frame period, and at least minGap
+         */
+        void gap(uint32_t period, uint32_t minGap);
+        void pulses(const IRCode& code, uint8_t protocol);
+        void manchester(const IRCode& code, bool rc6);
+    };
+}
+
+#endif // IR_ENCODER_H
@@ -3,6 +3,10 @@
 #include "../VisualCortex/LEDManager.h"
 #include "../VisualCortex/RoverViewManager.h"
 #include "../SomatosensoryCortex/MenuManager.h"
+#include "../PrefrontalCortex/SDManager.h"
+#include "../PrefrontalCortex/SPIManager.h"
+#include "../PrefrontalCortex/Utilities.h"
+#include <driver/rmt.h>
 
 // Forward declarations
 
@@ -19,40 +23,125 @@ namespace PsychicCortex
     using AC::SoundFxManager;
     using PC::VisualTypes::VisualPattern;
 
+    namespace
+    {
+        // FastLED drives the LEDs through RMT channels 0 and 1
+        constexpr rmt_channel_t IR_RMT_CHANNEL = RMT_CHANNEL_3;
+        constexpr uint8_t RMT_CLOCK_DIVIDER = 80;       // 1 µs ticks, as IREncoder lays them out
+        constexpr uint32_t RMT_SOURCE_HZ = 80000000;    // APB clock, which the carrier counts in
+
+        static_assert(sizeof(rmt_item32_t) == sizeof(uint32_t), "IRFrame items are rmt_item32_t");
+    }
+
     /**
      * @brief Initialize static member variables
      * Sets up initial state for IR transmission system
      */
     bool IRManager::blasting = false;
-    unsigned long IRManager::lastSendTime = 0;
+    bool IRManager::transmitterReady = false;
+    bool IRManager::sending = false;
+    bool IRManager::frameReady = false;
+    uint8_t IRManager::airFrame = 0;
+    IRFrame IRManager::frames[2];
+    uint32_t IRManager::frameIndex[2] = { 0, 0 };
+    uint8_t IRManager::frameRegion[2] = { 0, 0 };
+    uint32_t IRManager::nextIndex = 0;
+    uint32_t IRManager::codesSent = 0;
+    unsigned long IRManager::blastStartTime = 0;
     unsigned long IRManager::lastLEDUpdate = 0;
-    uint16_t IRManager::currentCode = 0;
     uint8_t IRManager::currentRegion = 0;
     uint8_t IRManager::currentLEDPosition = 0;
     bool IRManager::animationDirection = true;
-    IRsend IRManager::irsend(BOARD_IR_RX);  // Initialize with IR pin
+    IRCodeDatabase IRManager::database(PC::SDManager::getStorage());
+    const char* IRManager::IR_FOLDER = "/ir";
+    const char* IRManager::CODE_DATABASE_FILE = "/ir/codes.bin";
 
     /**
      * @brief Initialize IR hardware
-     * Configures pins and IR transmitter
+     * Configures pins, the RMT transmitter and the code database
      */
     void IRManager::init() 
     {
         pinMode(BOARD_IR_EN, OUTPUT);
-        pinMode(BOARD_IR_RX, OUTPUT);
         digitalWrite(BOARD_IR_EN, LOW); // Initially disabled
-        irsend.begin();
+        setupIROutput();
+        openDatabase();
+    }
+
+    void IRManager::setupIROutput() 
+    {
+        if (transmitterReady) return;
+
+        rmt_config_t config = RMT_DEFAULT_CONFIG_TX(static_cast<gpio_num_t>(BOARD_IR_RX), IR_RMT_CHANNEL);
+        config.clk_div = RMT_CLOCK_DIVIDER;
+        config.tx_config.carrier_en = true;
+        config.tx_config.carrier_freq_hz = 38000;
+        config.tx_config.carrier_duty_percent = 33;
+        config.tx_config.carrier_level = RMT_CARRIER_LEVEL_HIGH;
+        config.tx_config.idle_level = RMT_IDLE_LEVEL_LOW;
+        config.tx_config.idle_output_en = true;
+
+        if (rmt_config(&config) != ESP_OK || rmt_driver_install(IR_RMT_CHANNEL, 0, 0) != ESP_OK) 
+        {
+            PC::Utilities::LOG_ERROR("IR transmitter setup failed");
+            return;
+        }
+        transmitterReady = true;
+    }
+
+    void IRManager::openDatabase() 
+    {
+        database.close();
+        if (!PC::SDManager::isInitialized()) 
+        {
+            PC::Utilities::LOG_PROD("No SD card, using the %u built-in IR codes", BUILTIN_REGIONS * BUILTIN_REGION_CODES);
+            return;
+        }
+
+        PC::SPILease lease(PC::SPIDevice::SD, PC::SPIPriority::NORMAL);
+        if (!database.open(CODE_DATABASE_FILE)) 
+        {
+            // First run, or a damaged file: put the built-in set down to stream from
+            PC::SDManager::createDir(SD, IR_FOLDER);
+            if (!IRCodeDatabase::write(PC::SDManager::getStorage(), CODE_DATABASE_FILE, builtinCode, nullptr,
+                                       BUILTIN_REGIONS * BUILTIN_REGION_CODES) ||
+                !database.open(CODE_DATABASE_FILE)) 
+            {
+                PC::Utilities::LOG_ERROR("IR code database unavailable, using the built-in codes");
+                return;
+            }
+        }
+        PC::Utilities::LOG_PROD("IR code database: %u codes in %u regions", database.count(), database.regionCount());
+    }
+
+    uint32_t IRManager::codeCount() 
+    {
+        return database.isOpen() ? database.count() : BUILTIN_REGIONS * BUILTIN_REGION_CODES;
+    }
+
+    uint8_t IRManager::regionCount() 
+    {
+        return database.isOpen() ? database.regionCount() : BUILTIN_REGIONS;
+    }
+
+    uint32_t IRManager::regionStart(uint8_t region) 
+    {
+        if (database.isOpen()) return database.regionStart(region);
+        return region < BUILTIN_REGIONS ? region * BUILTIN_REGION_CODES : codeCount();
     }
 
     void IRManager::handleRotaryTurn(int direction) 
     {
+        uint8_t regions = regionCount();
+        if (regions == 0) return;
+
         if (direction == 1) 
         {
-            currentRegion = (currentRegion + 1) % 4;
+            currentRegion = (currentRegion + 1) % regions;
         } 
         else if (direction == -1) 
         {
-            currentRegion = (currentRegion + 3) % 4;
+            currentRegion = (currentRegion + regions - 1) % regions;
         }
         LEDManager::setPattern(PC::VisualTypes::VisualPattern::NONE);
     }
@@ -64,111 +153,187 @@ namespace PsychicCortex
 
     void IRManager::startBlast() 
     {
+        if (!transmitterReady) return;
+        if (sending) 
+        {
+            rmt_tx_stop(IR_RMT_CHANNEL);
+            sending = false;
+        }
+
+        nextIndex = regionStart(currentRegion);
+        database.seek(nextIndex);
+        codesSent = 0;
+        blastStartTime = millis();
         blasting = true;
+        digitalWrite(BOARD_IR_EN, HIGH);
+        encodeNext();
         LEDManager::setPattern(PC::VisualTypes::VisualPattern::IR_BLAST);
     }
 
     void IRManager::stopBlast() 
     {
+        if (sending) 
+        {
+            rmt_tx_stop(IR_RMT_CHANNEL);
+            sending = false;
+        }
         blasting = false;
+        frameReady = false;
+        digitalWrite(BOARD_IR_EN, LOW);
         LEDManager::setPattern(PC::VisualTypes::VisualPattern::NONE);
     }
 
     void IRManager::update() 
     {
         if (!blasting) return;
-        
-        // Update IR codes
-        if (millis() - lastSendTime >= SEND_DELAY_MS) 
+
+        // Each frame ends with its protocol's gap, so the next can go as soon as it is done
+        if (sending && rmt_wait_tx_done(IR_RMT_CHANNEL, 0) != ESP_OK) return;
+        sending = false;
+
+        if (!frameReady) 
+        {
+            finishBlast();
+            return;
+        }
+
+        // Put the encoded frame on air, then encode the next one while it plays
+        uint8_t ready = airFrame ^ 1;
+        transmit(frames[ready]);
+        airFrame = ready;
+        frameReady = false;
+        codesSent++;
+        encodeNext();
+
+        showProgress(frameIndex[airFrame], frameRegion[airFrame]);
+    }
+
+    bool IRManager::nextCode(uint32_t& index, IRCode& code) 
+    {
+        if (database.isOpen()) 
+        {
+            // next() reads a block of records from the card every BLOCK_RECORDS codes
+            PC::SPILease lease(PC::SPIDevice::SD, PC::SPIPriority::NORMAL);
+            index = database.position();
+            return database.next(code);
+        }
+        if (nextIndex >= codeCount()) return false;
+        index = nextIndex;
+        return builtinCode(nullptr, nextIndex++, code);
+    }
+
+    void IRManager::encodeNext() 
+    {
+        uint8_t target = airFrame ^ 1;
+        IRCode code;
+        uint32_t index;
+        while (nextCode(index, code)) 
         {
-            sendCode(currentCode++);
-            lastSendTime = millis();
-            
-            if (currentCode >= 100) 
+            if (IREncoder::encode(code, frames[target])) 
             {
-                currentCode = 0;
-                currentRegion++;
-                if (currentRegion >= 4) 
-                {
-                    stopBlast();
-                    SC::MenuManager::show();
-                    return;
-                }
+                frameIndex[target] = index;
+                frameRegion[target] = code.region;
+                frameReady = true;
+                return;
             }
-            
-            // Calculate and show progress
-            int totalCodes = 100 * 4;
-            int currentTotal = (currentRegion * 100) + currentCode;
-            int progressPercent = (currentTotal * 100) / totalCodes;
-            
-            char progressStr[32];
-            snprintf(progressStr, sizeof(progressStr), "                %d%% [%d:%d]", 
-                    progressPercent, currentRegion, currentCode);
-            
-            VC::RoverViewManager::showNotification("IR", progressStr, "BLAST", 500);
+            PC::Utilities::LOG_DEBUG("IR code %u does not encode, skipped", index);
+        }
+        frameReady = false;
+    }
+
+    void IRManager::transmit(const IRFrame& frame) 
+    {
+        uint32_t period = RMT_SOURCE_HZ / frame.carrierHz;
+        uint16_t high = static_cast<uint16_t>(period * frame.dutyPercent / 100);
+        uint16_t low = static_cast<uint16_t>(period - high);
+        rmt_set_tx_carrier(IR_RMT_CHANNEL, true, high, low, RMT_CARRIER_LEVEL_HIGH);
+
+        // The driver plays straight from the frame, which stays untouched until it is done
+        rmt_write_items(IR_RMT_CHANNEL, reinterpret_cast<const rmt_item32_t*>(frame.items), frame.count, false);
+        sending = true;
+    }
+
+    void IRManager::finishBlast() 
+    {
+        unsigned long elapsed = millis() - blastStartTime;
+        PC::Utilities::LOG_PROD("IR blast: %u codes in %u ms", codesSent, static_cast<uint32_t>(elapsed));
+        if (database.isOpen()) 
+        {
+            const IRDatabaseStats& stats = database.stats();
+            PC::Utilities::LOG_DEBUG("IR database: %u block reads, %u bad records", stats.blockReads, stats.badRecords);
         }
+        stopBlast();
+        SC::MenuManager::show();
+    }
+
+    void IRManager::showProgress(uint32_t index, uint8_t region) 
+    {
+        // Calculate and show progress
+        uint32_t totalCodes = codeCount();
+        int progressPercent = totalCodes > 0 ? static_cast<int>(index * 100 / totalCodes) : 100;
+        int regionCode = static_cast<int>(index - regionStart(region));
+
+        char progressStr[32];
+        snprintf(progressStr, sizeof(progressStr), "                %d%% [%d:%d]", 
+                progressPercent, region, regionCode);
+
+        VC::RoverViewManager::showNotification("IR", progressStr, "BLAST", 500);
     }
 
-    void IRManager::sendCode(uint16_t code) 
+    bool IRManager::builtinCode(void*, uint32_t index, IRCode& code) 
     {
-        // Send different protocols based on region, following TV-B-Gone approach
-        switch(currentRegion) 
+        if (index >= BUILTIN_REGIONS * BUILTIN_REGION_CODES) return false;
+
+        // Different protocols per region, following TV-B-Gone approach
+        uint32_t value = index % BUILTIN_REGION_CODES;
+        code.region = static_cast<uint8_t>(index / BUILTIN_REGION_CODES);
+        code.repeats = 0;
+        code.bits = 32;
+        switch (code.region) 
         {
             case 0:  // Sony (SIRC) - Most common for Bravia
-                digitalWrite(BOARD_IR_EN, HIGH);
                 // Power codes: 21/0x15, 0xA90, 0x290
                 // Input codes: 25/0x19, 0xA50, 0x250
                 // Vol codes: 18/0x12 (up), 19/0x13 (down), 20/0x14 (mute)
-                if (code < 20) 
+                code.protocol = IRProtocol::SONY;
+                code.repeats = 2;                  // Sony sets want three frames
+                code.bits = 12;
+                if (value < 20) 
                 {
-                    irsend.sendSony(code + 0x10, 12);  // Basic commands (0x10-0x20)
+                    code.payload = value + 0x10;   // Basic commands (0x10-0x20)
                 } 
-                else if (code < 40) 
+                else if (value < 40) 
                 {
-                    irsend.sendSony(code + 0xA80, 12); // Extended set A
+                    code.payload = value + 0xA80;  // Extended set A
                 } 
-                else if (code < 60) 
+                else if (value < 60) 
                 {
-                    irsend.sendSony(code + 0x240, 12); // Extended set B
+                    code.payload = value + 0x240;  // Extended set B
                 } 
                 else 
                 {
-                    irsend.sendSony(code, 15);         // 15-bit codes
+                    code.payload = value;          // 15-bit codes
+                    code.bits = 15;
                 }
-                digitalWrite(BOARD_IR_EN, LOW);
                 break;
-                
+
             case 1:  // NEC - Common for many TVs
-                digitalWrite(BOARD_IR_EN, HIGH);
-                if (code < 50) 
-                {
-                    irsend.sendNEC(0x04FB0000UL + code); // Sony TV NEC variants
-                } 
-                else 
-                {
-                    irsend.sendNEC(0x10000000UL + code); // Other NEC codes
-                }
-                digitalWrite(BOARD_IR_EN, LOW);
+                code.protocol = IRProtocol::NEC;
+                code.payload = value < 50 ? 0x04FB0000UL + value   // Sony TV NEC variants
+                                          : 0x10000000UL + value;  // Other NEC codes
                 break;
-                
+
             case 2:  // RC5/RC6 - Common for European TVs
-                digitalWrite(BOARD_IR_EN, HIGH);
-                if (code % 2) 
-                {
-                    irsend.sendRC5(code, 12);
-                } 
-                else 
-                {
-                    irsend.sendRC6(code, 20);
-                }
-                digitalWrite(BOARD_IR_EN, LOW);
+                code.protocol = value % 2 ? IRProtocol::RC5 : IRProtocol::RC6;
+                code.bits = value % 2 ? 12 : 20;
+                code.payload = value;
                 break;
-                
-            case 3:  // Samsung - Common for newer TVs
-                digitalWrite(BOARD_IR_EN, HIGH);
-                irsend.sendSAMSUNG(0xE0E0 + code);
-                digitalWrite(BOARD_IR_EN, LOW);
+
+            default:  // Samsung - Common for newer TVs
+                code.protocol = IRProtocol::SAMSUNG;
+                code.payload = 0xE0E0 + value;
                 break;
         }
+        return true;
     }
-}
\ No newline at end of file
+}
@@ -2,8 +2,8 @@
 #define IR_MANAGER_H
 
 #include <Arduino.h>
-#include <IRremoteESP8266.h>
-#include <IRsend.h>
+#include "IRCodeDatabase.h"
+#include "IREncoder.h"
 #include "../CorpusCallosum/SynapticPathways.h"  // Replace individual includes with central nervous system
 #include "../MotorCortex/PinDefinitions.h"
 
@@ -16,8 +16,8 @@ namespace PsychicCortex
      * @brief Manages IR communication and device control
      * 
      * Provides:
-     * - IR signal transmission
-     * - Device control sequences
+     * - IR signal transmission through the RMT, one frame on air while the next is encoded
+     * - Device control sequences streamed from the IR code database on SD
      * - Visual feedback during transmission
      * - Interactive control via rotary input
      * - Timed transmission patterns
@@ -63,23 +63,52 @@ namespace PsychicCortex
         
     private:
         // Timing constants
-        static const uint16_t SEND_DELAY_MS = 100;   // Delay between code transmissions
         static const uint16_t LED_UPDATE_MS = 50;    // LED animation update interval
 
+        // Code database
+        static const char* IR_FOLDER;
+        static const char* CODE_DATABASE_FILE;
+        static const uint8_t BUILTIN_REGIONS = 4;
+        static const uint16_t BUILTIN_REGION_CODES = 100;
+
         // State tracking
         static bool blasting;                // Currently transmitting
-        static unsigned long lastSendTime;   // Last transmission timestamp
+        static bool transmitterReady;        // RMT channel configured
+        static bool sending;                 // A frame is on air
+        static bool frameReady;              // The other frame holds the next code
+        static uint8_t airFrame;             // Index of the frame on air
+        static IRFrame frames[2];            // One on air, one being encoded
+        static uint32_t frameIndex[2];       // Code index each frame holds
+        static uint8_t frameRegion[2];
+        static uint32_t nextIndex;           // Next code to encode without the database
+        static uint32_t codesSent;
+        static unsigned long blastStartTime;
         static unsigned long lastLEDUpdate;  // Last LED update timestamp
-        static uint16_t currentCode;         // Current IR code
-        static uint8_t currentRegion;        // Current LED region
+        static uint8_t currentRegion;        // Region the blast starts from
         static uint8_t currentLEDPosition;   // Current LED animation position
         static bool animationDirection;      // LED animation direction
-        static IRsend irsend;               // IR transmitter object
+        static IRCodeDatabase database;
 
         // Internal methods
-        static void sendCode(uint16_t code);
         static void setupIROutput();
+        static void openDatabase();
+        static uint32_t codeCount();
+        static uint8_t regionCount();
+        static uint32_t regionStart(uint8_t region);
+        static bool nextCode(uint32_t& index, IRCode& code);
+        static void encodeNext();
+        static void transmit(const IRFrame& frame);
+        static void finishBlast();
+        static void showProgress(uint32_t index, uint8_t region);
         static void updateLEDAnimation();
+
+        /**
+         * @brief The codes the blaster shipped with, four regions of a hundred
+         *
+         * Used when no SD card is mounted, and written to CODE_DATABASE_FILE
+         * when it does not exist yet.
+         */
+        static bool builtinCode(void* context, uint32_t index, IRCode& code);
     };
 }
 
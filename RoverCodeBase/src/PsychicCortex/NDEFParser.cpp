@@ -0,0 +1,378 @@
+/**
+ * @file NDEFParser.cpp
+ * @brief In-place walk of Type 2 tag TLVs and NDEF records
+ */
+
+#include "NDEFParser.h"
+#include <string.h>
+
+namespace PsychicCortex
+{
+    namespace
+    {
+        // TLV tags
+        constexpr uint8_t TLV_NULL = 0x00;
+        constexpr uint8_t TLV_NDEF_MESSAGE = 0x03;
+        constexpr uint8_t TLV_TERMINATOR = 0xFE;
+        constexpr uint8_t TLV_LONG_LENGTH = 0xFF;   // Two length bytes follow
+
+        // Record header flags
+        constexpr uint8_t FLAG_MESSAGE_BEGIN = 0x80;
+        constexpr uint8_t FLAG_MESSAGE_END = 0x40;
+        constexpr uint8_t FLAG_CHUNK = 0x20;
+        constexpr uint8_t FLAG_SHORT_RECORD = 0x10;
+        constexpr uint8_t FLAG_ID_LENGTH = 0x08;
+        constexpr uint8_t TNF_MASK = 0x07;
+
+        constexpr uint8_t TNF_EMPTY = 0;
+        constexpr uint8_t TNF_WELL_KNOWN = 1;
+        constexpr uint8_t TNF_MIME = 2;
+        constexpr uint8_t TNF_ABSOLUTE_URI = 3;
+        constexpr uint8_t TNF_EXTERNAL = 4;
+
+        constexpr uint8_t TEXT_UTF16 = 0x80;
+        constexpr uint8_t TEXT_LANGUAGE_MASK = 0x3F;
+
+        // NFC Forum URI record prefix codes 0x00-0x23
+        const char* const URI_PREFIXES[] = {
+            "", "http://www.", "https://www.", "http://", "https://", "tel:", "mailto:",
+            "ftp://anonymous:anonymous@", "ftp://ftp.", "ftps://", "sftp://", "smb://",
+            "nfs://", "ftp://", "dav://", "news:", "telnet://", "imap:", "rtsp://", "urn:",
+            "pop:", "sip:", "sips:", "tftp:", "btspp://", "btl2cap://", "btgoep://",
+            "tcpobex://", "irdaobex://", "file://", "urn:epc:id:", "urn:epc:tag:",
+            "urn:epc:pat:", "urn:epc:raw:", "urn:epc:", "urn:nfc:"
+        };
+        constexpr uint8_t URI_PREFIX_COUNT = sizeof(URI_PREFIXES) / sizeof(URI_PREFIXES[0]);
+
+        /**
+         * @brief Append the printable bytes of data; false once out is full
+         */
+        bool appendPrintable(char* out, size_t capacity, size_t& used, const uint8_t* data, size_t length, size_t stride)
+        {
+            for (size_t i = 0; i < length; i += stride)
+            {
+                if (used + 1 >= capacity) return false;
+                if (data[i] >= 32 && data[i] <= 126)
+                {
+                    out[used++] = static_cast<char>(data[i]);
+                }
+            }
+            return true;
+        }
+
+        /**
+         * @brief Append the ASCII characters of UTF-16 text, honouring a byte order mark
+         */
+        bool appendUtf16(char* out, size_t capacity, size_t& used, const uint8_t* data, size_t length)
+        {
+            // Big-endian unless the mark says otherwise
+            bool littleEndian = false;
+            size_t i = 0;
+            if (length >= 2 && ((data[0] == 0xFF && data[1] == 0xFE) || (data[0] == 0xFE && data[1] == 0xFF)))
+            {
+                littleEndian = data[0] == 0xFF;
+                i = 2;
+            }
+            for (; i + 1 < length; i += 2)
+            {
+                uint8_t high = littleEndian ? data[i + 1] : data[i];
+                uint8_t low = littleEndian ? data[i] : data[i + 1];
+                if (high != 0) continue;
+                if (!appendPrintable(out, capacity, used, &low, 1, 1)) return false;
+            }
+            return true;
+        }
+    }
+
+    NDEFParser::NDEFParser(const uint8_t* data, size_t length)
+        : m_data(data)
+        , m_length(data ? length : 0)
+    {
+        rewind();
+    }
+
+    void NDEFParser::rewind()
+    {
+        m_tlv = 0;
+        m_record = 0;
+        m_messageEnd = 0;
+        m_inMessage = false;
+        m_clamped = false;
+        m_finished = false;
+        m_status = NDEFStatus::OK;
+    }
+
+    bool NDEFParser::next(NDEFRecord& record)
+    {
+        while (m_status == NDEFStatus::OK)
+        {
+            if (!m_inMessage && !nextMessage())
+            {
+                return false;
+            }
+            if (m_record >= m_messageEnd)
+            {
+                // Ran into the end of a cut message without its last record
+                if (m_clamped) m_status = NDEFStatus::TRUNCATED;
+                m_inMessage = false;
+                continue;
+            }
+
+            // Header, type length, payload length (1 or 4 bytes), id length if present
+            const uint8_t* at = m_data + m_record;
+            size_t left = m_messageEnd - m_record;
+            uint8_t header = at[0];
+            bool shortRecord = (header & FLAG_SHORT_RECORD) != 0;
+            bool hasId = (header & FLAG_ID_LENGTH) != 0;
+            size_t fixed = 2 + (shortRecord ? 1 : 4) + (hasId ? 1 : 0);
+            if (left < fixed)
+            {
+                m_status = m_clamped ? NDEFStatus::TRUNCATED : NDEFStatus::MALFORMED;
+                return false;
+            }
+
+            uint8_t typeLength = at[1];
+            uint32_t payloadLength;
+            size_t cursor = 2;
+            if (shortRecord)
+            {
+                payloadLength = at[cursor++];
+            }
+            else
+            {
+                payloadLength = (static_cast<uint32_t>(at[2]) << 24) | (static_cast<uint32_t>(at[3]) << 16) |
+                                (static_cast<uint32_t>(at[4]) << 8) | at[5];
+                cursor += 4;
+            }
+            uint8_t idLength = hasId ? at[cursor++] : 0;
+
+            // Compared piecewise so a 32-bit payload length cannot wrap the sum
+            size_t body = left - fixed;
+            if (typeLength > body || idLength > body - typeLength || payloadLength > body - typeLength - idLength)
+            {
+                m_status = m_clamped ? NDEFStatus::TRUNCATED : NDEFStatus::MALFORMED;
+                return false;
+            }
+
+            uint8_t tnf = header & TNF_MASK;
+            record.tnf = tnf;
+            record.messageBegin = (header & FLAG_MESSAGE_BEGIN) != 0;
+            record.messageEnd = (header & FLAG_MESSAGE_END) != 0;
+            record.type = at + cursor;
+            record.typeLength = typeLength;
+            record.id = at + cursor + typeLength;
+            record.idLength = idLength;
+            record.payload = at + cursor + typeLength + idLength;
+            record.payloadLength = payloadLength;
+            record.kind = classify(tnf, record.type, typeLength, (header & FLAG_CHUNK) != 0);
+
+            m_record += cursor + typeLength + idLength + payloadLength;
+            if (record.messageEnd)
+            {
+                // Whatever follows inside the TLV is padding
+                m_inMessage = false;
+            }
+            return true;
+        }
+        return false;
+    }
+
+    bool NDEFParser::nextMessage()
+    {
+        while (!m_finished && m_tlv < m_length)
+        {
+            uint8_t tag = m_data[m_tlv];
+            if (tag == TLV_NULL)
+            {
+                m_tlv++;
+                continue;
+            }
+            if (tag == TLV_TERMINATOR)
+            {
+                m_finished = true;
+                break;
+            }
+
+            size_t header = 2;
+            if (m_tlv + 1 >= m_length)
+            {
+                m_status = NDEFStatus::TRUNCATED;
+                return false;
+            }
+            size_t length = m_data[m_tlv + 1];
+            if (length == TLV_LONG_LENGTH)
+            {
+                if (m_tlv + 3 >= m_length)
+                {
+                    m_status = NDEFStatus::TRUNCATED;
+                    return false;
+                }
+                length = (static_cast<size_t>(m_data[m_tlv + 2]) << 8) | m_data[m_tlv + 3];
+                header = 4;
+            }
+
+            // A message cut short by a partial read still yields its whole records
+            size_t value = m_tlv + header;
+            bool clamped = length > m_length - value;
+            if (clamped && tag != TLV_NDEF_MESSAGE)
+            {
+                m_status = NDEFStatus::TRUNCATED;
+                return false;
+            }
+            if (clamped)
+            {
+                length = m_length - value;
+                m_finished = true;
+            }
+            m_tlv = value + length;
+
+            if (tag == TLV_NDEF_MESSAGE && length > 0)
+            {
+                m_record = value;
+                m_messageEnd = value + length;
+                m_clamped = clamped;
+                m_inMessage = true;
+                return true;
+            }
+            if (clamped)
+            {
+                m_status = NDEFStatus::TRUNCATED;
+                return false;
+            }
+        }
+        m_finished = true;
+        return false;
+    }
+
+    NDEFRecordKind NDEFParser::classify(uint8_t tnf, const uint8_t* type, uint8_t typeLength, bool chunk)
+    {
+        if (chunk) return NDEFRecordKind::CHUNK;
+
+        switch (tnf)
+        {
+            case TNF_EMPTY:
+                return NDEFRecordKind::EMPTY;
+
+            case TNF_WELL_KNOWN:
+                if (typeLength == 1 && type[0] == 'T') return NDEFRecordKind::TEXT;
+                if (typeLength == 1 && type[0] == 'U') return NDEFRecordKind::URI;
+                if (typeLength == 2 && type[0] == 'S' && type[1] == 'p') return NDEFRecordKind::SMART_POSTER;
+                return NDEFRecordKind::WELL_KNOWN;
+
+            case TNF_MIME:
+                return NDEFRecordKind::MIME;
+
+            case TNF_ABSOLUTE_URI:
+                return NDEFRecordKind::ABSOLUTE_URI;
+
+            case TNF_EXTERNAL:
+                return NDEFRecordKind::EXTERNAL;
+
+            default:
+                return NDEFRecordKind::UNKNOWN;
+        }
+    }
+
+    bool NDEFParser::text(const NDEFRecord& record, NDEFText& view)
+    {
+        if (record.kind != NDEFRecordKind::TEXT || record.payloadLength == 0)
+        {
+            return false;
+        }
+        uint8_t status = record.payload[0];
+        uint8_t languageLength = status & TEXT_LANGUAGE_MASK;
+        if (1u + languageLength > record.payloadLength)
+        {
+            return false;
+        }
+        view.utf16 = (status & TEXT_UTF16) != 0;
+        view.language = reinterpret_cast<const char*>(record.payload + 1);
+        view.languageLength = languageLength;
+        view.text = reinterpret_cast<const char*>(record.payload + 1 + languageLength);
+        view.textLength = record.payloadLength - 1 - languageLength;
+        return true;
+    }
+
+    bool NDEFParser::uri(const NDEFRecord& record, NDEFUri& view)
+    {
+        if (record.kind == NDEFRecordKind::ABSOLUTE_URI)
+        {
+            view.prefix = "";
+            view.rest = reinterpret_cast<const char*>(record.type);
+            view.restLength = record.typeLength;
+            return true;
+        }
+        if (record.kind != NDEFRecordKind::URI || record.payloadLength == 0)
+        {
+            return false;
+        }
+        view.prefix = uriPrefix(record.payload[0]);
+        view.rest = reinterpret_cast<const char*>(record.payload + 1);
+        view.restLength = record.payloadLength - 1;
+        return true;
+    }
+
+    bool NDEFParser::mime(const NDEFRecord& record, NDEFMime& view)
+    {
+        if (record.kind != NDEFRecordKind::MIME)
+        {
+            return false;
+        }
+        view.type = reinterpret_cast<const char*>(record.type);
+        view.typeLength = record.typeLength;
+        view.data = record.payload;
+        view.length = record.payloadLength;
+        return true;
+    }
+
+    const char* NDEFParser::uriPrefix(uint8_t code)
+    {
+        return code < URI_PREFIX_COUNT ? URI_PREFIXES[code] : "";
+    }
+
+    size_t NDEFParser::summarize(const uint8_t* data, size_t length, char* out, size_t capacity)
+    {
+        if (capacity == 0) return 0;
+
+        NDEFParser parser(data, length);
+        NDEFRecord record;
+        size_t used = 0;
+        bool room = true;
+        while (room && parser.next(record))
+        {
+            size_t before = used;
+            bool separated = used > 0 && used + 1 < capacity;
+            if (separated)
+            {
+                out[used++] = ' ';
+            }
+
+            NDEFText text;
+            NDEFUri uri;
+            NDEFMime mime;
+            if (NDEFParser::text(record, text))
+            {
+                const uint8_t* bytes = reinterpret_cast<const uint8_t*>(text.text);
+                room = text.utf16 ? appendUtf16(out, capacity, used, bytes, text.textLength)
+                                  : appendPrintable(out, capacity, used, bytes, text.textLength, 1);
+            }
+            else if (NDEFParser::uri(record, uri))
+            {
+                room = appendPrintable(out, capacity, used, reinterpret_cast<const uint8_t*>(uri.prefix), strlen(uri.prefix), 1) &&
+                       appendPrintable(out, capacity, used, reinterpret_cast<const uint8_t*>(uri.rest), uri.restLength, 1);
+            }
+            else if (NDEFParser::mime(record, mime))
+            {
+                room = appendPrintable(out, capacity, used, reinterpret_cast<const uint8_t*>(mime.type), mime.typeLength, 1);
+            }
+
+            // Nothing printable came of it, so no separator either
+            if (separated && used == before + 1)
+            {
+                used = before;
+            }
+        }
+        out[used] = '\0';
+        return used;
+    }
+}
@@ -0,0 +1,138 @@
+/**
+ * @brief NDEFParser walks the NDEF messages on a tag's user area in place
+ *
+ * A Type 2 tag holds a run of TLV blocks; each NDEF Message TLV carries
+ * records with a type, an optional id and a payload. The parser hands out
+ * records one at a time as views into the caller's buffer:
+ * - Nothing is copied or allocated; a record's pointers stay valid for as
+ *   long as the buffer does
+ * - Lock and memory control TLVs are skipped, a terminator TLV ends the walk
+ * - Every length is checked against what is left, so a half-read tag or
+ *   garbage stops the walk with status() saying which, never an overrun;
+ *   the whole records of a message cut short are still handed out
+ * - Chunked records are reported as CHUNK and not joined, as that would copy
+ *
+ * Typed views decode the common record types: text with its language, URIs
+ * with the prefix code expanded to a static string, and MIME payloads.
+ */
+
+#ifndef NDEF_PARSER_H
+#define NDEF_PARSER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace PsychicCortex
+{
+    enum class NDEFRecordKind : uint8_t
+    {
+        EMPTY,
+        TEXT,               // Well-known "T"
+        URI,                // Well-known "U"
+        SMART_POSTER,       // Well-known "Sp"; its payload is itself a message
+        WELL_KNOWN,         // Any other well-known type
+        MIME,               // Type is the media type
+        ABSOLUTE_URI,       // Type is the URI
+        EXTERNAL,           // Type is domain:type
+        CHUNK,              // Part of a chunked payload
+        UNKNOWN
+    };
+
+    enum class NDEFStatus : uint8_t
+    {
+        OK,
+        TRUNCATED,          // A length ran past the end of the buffer
+        MALFORMED           // A record header did not add up
+    };
+
+    struct NDEFRecord
+    {
+        NDEFRecordKind kind;
+        uint8_t tnf;                // Type name format, 0-7
+        bool messageBegin;
+        bool messageEnd;
+        const uint8_t* type;
+        uint8_t typeLength;
+        const uint8_t* id;
+        uint8_t idLength;
+        const uint8_t* payload;
+        uint32_t payloadLength;
+    };
+
+    struct NDEFText
+    {
+        const char* language;       // IANA code, e.g. "en"; not terminated
+        uint8_t languageLength;
+        const char* text;           // Not terminated
+        uint32_t textLength;        // Bytes
+        bool utf16;                 // Else UTF-8
+    };
+
+    struct NDEFUri
+    {
+        const char* prefix;         // Expanded from the prefix code; terminated, may be empty
+        const char* rest;           // Not terminated
+        uint32_t restLength;
+    };
+
+    struct NDEFMime
+    {
+        const char* type;           // Not terminated
+        uint8_t typeLength;
+        const uint8_t* data;
+        uint32_t length;
+    };
+
+    class NDEFParser
+    {
+    public:
+        NDEFParser(const uint8_t* data, size_t length);
+
+        /**
+         * @brief Next record of any NDEF message on the tag
+         * @return false at the end, or when status() is no longer OK
+         */
+        bool next(NDEFRecord& record);
+
+        /**
+         * @brief Walk again from the first TLV
+         */
+        void rewind();
+        NDEFStatus status() const { return m_status; }
+
+        /**
+         * @brief Typed views of a record
+         * @return false if the record is of another kind or its payload is short
+         */
+        static bool text(const NDEFRecord& record, NDEFText& view);
+        static bool uri(const NDEFRecord& record, NDEFUri& view);
+        static bool mime(const NDEFRecord& record, NDEFMime& view);
+
+        /**
+         * @brief Prefix for a URI record's first payload byte; "" for codes not in the table
+         */
+        static const char* uriPrefix(uint8_t code);
+
+        /**
+         * @brief Printable summary of the text, URI and MIME records, one space between them
+         * @return Characters written, excluding the terminator; 0 if there were no such records
+         */
+        static size_t summarize(const uint8_t* data, size_t length, char* out, size_t capacity);
+
+    private:
+        const uint8_t* m_data;
+        size_t m_length;
+        size_t m_tlv;               // Next TLV
+        size_t m_record;            // Next record, inside the current message
+        size_t m_messageEnd;
+        bool m_inMessage;
+        bool m_clamped;             // Current message runs past the buffer
+        bool m_finished;
+        NDEFStatus m_status;
+
+        bool nextMessage();
+        static NDEFRecordKind classify(uint8_t tnf, const uint8_t* type, uint8_t typeLength, bool chunk);
+    };
+}
+
+#endif // NDEF_PARSER_H
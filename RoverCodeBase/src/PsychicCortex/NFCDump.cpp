@@ -0,0 +1,224 @@
+/**
+ * @file NFCDump.cpp
+ * @brief Line-at-a-time reader for Flipper .nfc tag dumps
+ */
+
+#include "NFCDump.h"
+#include <string.h>
+#include <stdlib.h>
+
+namespace PsychicCortex
+{
+    namespace
+    {
+        constexpr char FILETYPE[] = "Flipper NFC device";
+        constexpr uint8_t PAGE_SIZE = 4;
+        constexpr uint8_t BLOCK_SIZE = 16;
+        constexpr uint8_t LOAD_CHUNK = 128;
+
+        int hexDigit(char c)
+        {
+            if (c >= '0' && c <= '9') return c - '0';
+            if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+            if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+            return -1;
+        }
+
+        bool startsWith(const char* text, const char* prefix)
+        {
+            return strncmp(text, prefix, strlen(prefix)) == 0;
+        }
+    }
+
+    NFCDumpReader::NFCDumpReader(NFCDump& dump)
+        : m_dump(dump)
+        , m_line(0)
+        , m_errorLine(0)
+        , m_header(false)
+        , m_sak(false)
+    {
+        memset(&m_dump, 0, sizeof(m_dump));
+    }
+
+    bool NFCDumpReader::feed(const char* line)
+    {
+        if (m_errorLine != 0)
+        {
+            return false;
+        }
+        m_line++;
+
+        while (*line == ' ' || *line == '\t') line++;
+        if (*line == '\0' || *line == '\r' || *line == '#')
+        {
+            return true;
+        }
+
+        // "Key: value"; keys may have spaces and slashes in them
+        const char* colon = strchr(line, ':');
+        if (colon == nullptr || colon[1] != ' ')
+        {
+            return fail();
+        }
+        size_t keyLength = static_cast<size_t>(colon - line);
+        const char* value = colon + 2;
+
+        if (!m_header)
+        {
+            // Nothing is taken from a file that does not say what it is first
+            m_header = keyLength == 8 && strncmp(line, "Filetype", 8) == 0 && startsWith(value, FILETYPE);
+            return m_header ? true : fail();
+        }
+
+        NFCDump& dump = m_dump;
+        if (keyLength == 11 && strncmp(line, "Device type", 11) == 0)
+        {
+            // Version 4 says "NTAG/Ultralight" and names the chip in its own key; older files name it here
+            if (strstr(value, "NTAG")) dump.kind = NFCDumpKind::NTAG;
+            else if (strstr(value, "Ultralight")) dump.kind = NFCDumpKind::ULTRALIGHT;
+            else if (strstr(value, "Mifare Classic")) dump.kind = NFCDumpKind::MIFARE_CLASSIC;
+            return true;
+        }
+        if (keyLength == 20 && strncmp(line, "NTAG/Ultralight type", 20) == 0)
+        {
+            dump.kind = startsWith(value, "NTAG") ? NFCDumpKind::NTAG : NFCDumpKind::ULTRALIGHT;
+            return true;
+        }
+        if (keyLength == 3 && strncmp(line, "UID", 3) == 0)
+        {
+            int length = parseHex(value, dump.uid, NFCDump::MAX_UID);
+            if (length < 4) return fail();
+            dump.uidLength = static_cast<uint8_t>(length);
+            return true;
+        }
+        if (keyLength == 4 && strncmp(line, "ATQA", 4) == 0)
+        {
+            return parseHex(value, dump.atqa, sizeof(dump.atqa)) == 2 ? true : fail();
+        }
+        if (keyLength == 3 && strncmp(line, "SAK", 3) == 0)
+        {
+            m_sak = parseHex(value, &dump.sak, 1) == 1;
+            return m_sak ? true : fail();
+        }
+        if (keyLength > 5 && strncmp(line, "Page ", 5) == 0)
+        {
+            return parseMemory(line + 5, value, PAGE_SIZE);
+        }
+        if (keyLength > 6 && strncmp(line, "Block ", 6) == 0)
+        {
+            return parseMemory(line + 6, value, BLOCK_SIZE);
+        }
+        return true;
+    }
+
+    bool NFCDumpReader::finish() const
+    {
+        return m_errorLine == 0 && m_header && m_sak && m_dump.uidLength != 0 &&
+               m_dump.kind != NFCDumpKind::UNKNOWN && m_dump.length != 0;
+    }
+
+    bool NFCDumpReader::load(const StorageBackend& storage, const char* path, NFCDump& dump)
+    {
+        NFCDumpReader reader(dump);
+        StorageBackend::Handle file = storage.open(storage.context, path, false);
+        if (file == nullptr)
+        {
+            return false;
+        }
+
+        uint32_t size = storage.size(storage.context, file);
+        uint8_t chunk[LOAD_CHUNK];
+        char line[LINE_LENGTH];
+        size_t used = 0;
+        bool ok = true;
+        for (uint32_t offset = 0; offset < size && ok; )
+        {
+            size_t length = size - offset < LOAD_CHUNK ? size - offset : LOAD_CHUNK;
+            if (storage.read(storage.context, file, offset, chunk, length) != length)
+            {
+                ok = false;
+                break;
+            }
+            offset += length;
+
+            for (size_t i = 0; i < length && ok; i++)
+            {
+                if (chunk[i] == '\n')
+                {
+                    line[used] = '\0';
+                    ok = reader.feed(line);
+                    used = 0;
+                }
+                else if (used < LINE_LENGTH - 1)
+                {
+                    line[used++] = static_cast<char>(chunk[i]);
+                }
+            }
+        }
+        storage.close(storage.context, file);
+
+        if (ok && used > 0)
+        {
+            line[used] = '\0';
+            ok = reader.feed(line);
+        }
+        return ok && reader.finish();
+    }
+
+    bool NFCDumpReader::fail()
+    {
+        m_errorLine = m_line;
+        return false;
+    }
+
+    bool NFCDumpReader::parseMemory(const char* number, const char* value, uint16_t unitSize)
+    {
+        char* end = nullptr;
+        unsigned long index = strtoul(number, &end, 10);
+        if (end == number || *end != ':' || (index + 1) * unitSize > NFCDump::CAPACITY)
+        {
+            return fail();
+        }
+
+        uint8_t* unit = m_dump.memory + index * unitSize;
+        if (parseHex(value, unit, unitSize) != static_cast<int>(unitSize))
+        {
+            return fail();
+        }
+        uint16_t through = static_cast<uint16_t>((index + 1) * unitSize);
+        if (through > m_dump.length) m_dump.length = through;
+        return true;
+    }
+
+    int NFCDumpReader::parseHex(const char* text, uint8_t* out, size_t capacity)
+    {
+        size_t count = 0;
+        while (*text != '\0' && *text != '\r')
+        {
+            if (*text == ' ')
+            {
+                text++;
+                continue;
+            }
+            if (count == capacity || text[1] == '\0')
+            {
+                return -1;
+            }
+
+            if (text[0] == '?' && text[1] == '?')
+            {
+                out[count++] = 0;
+                m_dump.unknown++;
+            }
+            else
+            {
+                int high = hexDigit(text[0]);
+                int low = hexDigit(text[1]);
+                if (high < 0 || low < 0) return -1;
+                out[count++] = static_cast<uint8_t>((high << 4) | low);
+            }
+            text += 2;
+        }
+        return static_cast<int>(count);
+    }
+}
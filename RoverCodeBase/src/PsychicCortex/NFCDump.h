@@ -0,0 +1,95 @@
+/**
+ * @brief NFCDump holds a tag captured by a Flipper Zero, for the PN532Emulator to present
+ *
+ * Flipper .nfc files are text: a header, "Key: value" lines for the UID,
+ * ATQA and SAK, then the memory one "Page N:" (NTAG, Ultralight) or
+ * "Block N:" (Mifare Classic) line at a time in hex. NFCDumpReader takes
+ * such a file a line at a time, so it never has to be held whole:
+ * - Comments, blank lines and keys it has no use for are skipped
+ * - "??" bytes the Flipper could not read come back as 0 and are counted
+ * - The first line that does not parse stops the read and is remembered
+ *
+ * Platform-free: files come through StorageBackend, so a dump loads from SD
+ * on the rover and from plain files on host.
+ */
+
+#ifndef NFC_DUMP_H
+#define NFC_DUMP_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "../PrefrontalCortex/StorageBackend.h"
+
+namespace PsychicCortex
+{
+    using PrefrontalCortex::StorageBackend;
+
+    enum class NFCDumpKind : uint8_t
+    {
+        UNKNOWN,
+        NTAG,               // Answers READ and FAST_READ
+        ULTRALIGHT,         // READ only
+        MIFARE_CLASSIC      // Every block behind a key
+    };
+
+    struct NFCDump
+    {
+        static constexpr uint8_t MAX_UID = 10;
+        static constexpr uint16_t CAPACITY = 1024;      // Mifare Classic 1K; NTAG216 is 924
+
+        NFCDumpKind kind;
+        uint8_t uid[MAX_UID];
+        uint8_t uidLength;
+        uint8_t atqa[2];            // In the order the card sends them
+        uint8_t sak;
+        uint8_t memory[CAPACITY];   // Pages of 4 or blocks of 16 bytes, in order
+        uint16_t length;            // Through the last page or block in the file
+        uint16_t unknown;           // "??" bytes
+    };
+
+    class NFCDumpReader
+    {
+    public:
+        static constexpr uint8_t LINE_LENGTH = 96;      // Longer lines are only ever comments, cut short
+
+        /**
+         * @brief Start a dump afresh
+         */
+        explicit NFCDumpReader(NFCDump& dump);
+
+        /**
+         * @brief One line of the file, without its line ending
+         * @return false from the first line that cannot be used on
+         */
+        bool feed(const char* line);
+
+        /**
+         * @brief Whether what was fed is a whole card: header, UID, SAK and some memory
+         */
+        bool finish() const;
+        uint16_t errorLine() const { return m_errorLine; }
+
+        /**
+         * @brief Read a dump file through storage
+         */
+        static bool load(const StorageBackend& storage, const char* path, NFCDump& dump);
+
+    private:
+        NFCDump& m_dump;
+        uint16_t m_line;
+        uint16_t m_errorLine;       // 0 while every line has parsed
+        bool m_header;
+        bool m_sak;
+
+        bool fail();
+        bool parseMemory(const char* number, const char* value, uint16_t unitSize);
+
+        /**
+         * @brief Space-separated hex bytes; "??" reads as 0
+         * @return Bytes parsed, or -1 on anything else or more than capacity
+         */
+        int parseHex(const char* text, uint8_t* out, size_t capacity);
+    };
+}
+
+#endif // NFC_DUMP_H
@@ -0,0 +1,591 @@
+/**
+ * @file NFCEngine.cpp
+ * @brief Non-blocking PN532 card detection and reading
+ */
+
+#include "NFCEngine.h"
+#include "NDEFParser.h"
+#include <string.h>
+
+namespace PsychicCortex
+{
+    namespace
+    {
+        constexpr uint8_t NTAG_READ = 0x30;             // 16 bytes from a page
+        constexpr uint8_t NTAG_FAST_READ = 0x3A;        // A run of pages, first and last inclusive
+        constexpr uint8_t READ_LENGTH = 16;
+        constexpr uint8_t NDEF_MAGIC = 0xE1;            // Capability container byte 0
+        constexpr uint8_t CAPABILITY_PAGE = 3;
+        constexpr uint8_t STATUS_ERROR_MASK = 0x3F;     // InDataExchange status; the rest are flags
+        constexpr uint8_t MAX_RETRIES = 0xFF;           // Passive activation: until a card answers
+
+        // Largest answers expected, frame included
+        constexpr uint8_t CONFIGURE_RESPONSE = 10;
+        constexpr uint8_t DETECT_RESPONSE = 48;         // Room for a 10-byte UID and an ATS
+        constexpr uint8_t READ_OVERHEAD = 10;           // Frame, response code and status around the data
+    }
+
+    static_assert(CardContent::MAX_UID == NFCCard::MAX_UID && CardContent::TEXT_LENGTH == NFCCard::TEXT_LENGTH,
+                  "Cache entries must hold what a card read does");
+
+    NFCEngine::NFCEngine(const PN532Transport& transport, NFCEventCallback callback, void* context)
+        : m_transport(transport)
+        , m_callback(callback)
+        , m_context(context)
+        , m_contents(nullptr)
+        , m_stage(NFCStage::STOPPED)
+        , m_phase(Phase::IDLE)
+        , m_commandLength(0)
+        , m_responseLength(0)
+        , m_phaseMicros(0)
+        , m_stageMicros(0)
+        , m_timedStage(NFCStage::STOPPED)
+        , m_timedMicros(0)
+        , m_answeredMicros(0)
+        , m_pages(0)
+        , m_attempts(0)
+        , m_configured(false)
+        , m_present(false)
+        , m_verifying(false)
+        , m_capabilityStamp(0)
+    {
+        memset(m_command, 0, sizeof(m_command));
+        memset(&m_card, 0, sizeof(m_card));
+        memset(m_capabilities, 0, sizeof(m_capabilities));
+        memset(&m_stats, 0, sizeof(m_stats));
+        memset(m_frame, 0, sizeof(m_frame));
+    }
+
+    void NFCEngine::start()
+    {
+        stop();
+        m_configured = false;
+        const uint8_t configure[] = { PN532Frame::RF_CONFIGURATION, 0x05, 0xFF, 0x01, MAX_RETRIES };
+        issue(NFCStage::CONFIGURE, configure, sizeof(configure), CONFIGURE_RESPONSE);
+    }
+
+    void NFCEngine::stop()
+    {
+        if (m_phase == Phase::WAIT_ACK || m_phase == Phase::WAIT_RESPONSE)
+        {
+            abort();
+        }
+        m_stage = NFCStage::STOPPED;
+        m_phase = Phase::IDLE;
+        m_present = false;
+        m_verifying = false;
+    }
+
+    void NFCEngine::update(uint32_t budget)
+    {
+        uint32_t started = now();
+        bool more = true;
+        while (more)
+        {
+            more = step();
+            uint32_t current = now();
+            timeStage(current);
+            if (current - started >= budget) break;
+        }
+
+        uint32_t elapsed = now() - started;
+        m_stats.updates++;
+        m_stats.updateMicros += elapsed;
+        if (elapsed > m_stats.maxUpdateMicros) m_stats.maxUpdateMicros = elapsed;
+    }
+
+    bool NFCEngine::step()
+    {
+        uint32_t current = now();
+        switch (m_phase)
+        {
+            case Phase::IDLE:
+                return advance(current);
+
+            case Phase::SEND:
+            {
+                size_t length = PN532Frame::build(m_frame, sizeof(m_frame), m_command, m_commandLength);
+                if (length == 0 || !m_transport.write(m_transport.context, m_frame, length))
+                {
+                    fail(false, current);
+                    return false;
+                }
+                m_stats.commands++;
+                m_phase = Phase::WAIT_ACK;
+                m_phaseMicros = current;
+                return true;
+            }
+
+            case Phase::WAIT_ACK:
+                if (!m_transport.ready(m_transport.context))
+                {
+                    // The ACK follows within a millisecond, so it is worth the rest of the budget
+                    if (current - m_phaseMicros <= ACK_TIMEOUT) return true;
+                    fail(true, current);
+                    return false;
+                }
+                if (!m_transport.read(m_transport.context, m_frame, PN532Frame::ACK_LENGTH) ||
+                    !PN532Frame::isAck(m_frame, PN532Frame::ACK_LENGTH))
+                {
+                    fail(false, current);
+                    return false;
+                }
+                m_phase = Phase::WAIT_RESPONSE;
+                m_phaseMicros = current;
+                return true;
+
+            case Phase::WAIT_RESPONSE:
+            {
+                if (!m_transport.ready(m_transport.context))
+                {
+                    if (m_stage == NFCStage::CHECK_PRESENCE && current - m_phaseMicros > PRESENCE_TIMEOUT)
+                    {
+                        // Nothing answered, so the card is gone; the chip is still looking
+                        abort();
+                        removed();
+                        detect(NFCStage::DETECT);
+                        return true;
+                    }
+                    if (m_stage != NFCStage::DETECT && m_stage != NFCStage::CHECK_PRESENCE &&
+                        current - m_phaseMicros > RESPONSE_TIMEOUT)
+                    {
+                        fail(true, current);
+                    }
+                    return false;
+                }
+
+                const uint8_t* payload = nullptr;
+                int32_t length = -1;
+                if (m_transport.read(m_transport.context, m_frame, m_responseLength))
+                {
+                    length = PN532Frame::parse(m_frame, m_responseLength, m_command[0], &payload);
+                }
+                if (length < 0)
+                {
+                    fail(false, current);
+                    return false;
+                }
+                m_phase = Phase::IDLE;
+                handle(payload, static_cast<size_t>(length), current);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void NFCEngine::timeStage(uint32_t now)
+    {
+        if (m_stage == m_timedStage) return;
+
+        // Waits between updates count against the stage that was waiting
+        m_stats.stageMicros[static_cast<uint8_t>(m_timedStage)] += now - m_timedMicros;
+        m_stats.stageEntries[static_cast<uint8_t>(m_stage)]++;
+        m_timedStage = m_stage;
+        m_timedMicros = now;
+    }
+
+    bool NFCEngine::advance(uint32_t now)
+    {
+        switch (m_stage)
+        {
+            case NFCStage::PARSE:
+                finish(now);
+                return true;
+
+            case NFCStage::PRESENT:
+                if (now - m_stageMicros < PRESENCE_INTERVAL) return false;
+                detect(NFCStage::CHECK_PRESENCE);
+                return true;
+
+            case NFCStage::BACKOFF:
+                if (now - m_stageMicros < BACKOFF) return false;
+                if (!m_configured)
+                {
+                    start();
+                }
+                else
+                {
+                    detect(m_present ? NFCStage::CHECK_PRESENCE : NFCStage::DETECT);
+                }
+                return true;
+
+            default:
+                return false;
+        }
+    }
+
+    void NFCEngine::issue(NFCStage stage, const uint8_t* command, uint8_t length, uint8_t responseLength)
+    {
+        memcpy(m_command, command, length);
+        m_commandLength = length;
+        m_responseLength = responseLength;
+        m_attempts = 0;
+        m_stage = stage;
+        m_phase = Phase::SEND;
+    }
+
+    void NFCEngine::detect(NFCStage stage)
+    {
+        // One target at 106 kbps type A
+        const uint8_t command[] = { PN532Frame::IN_LIST_PASSIVE_TARGET, 0x01, 0x00 };
+        issue(stage, command, sizeof(command), DETECT_RESPONSE);
+    }
+
+    void NFCEngine::readPage(NFCStage stage, uint8_t page)
+    {
+        const uint8_t command[] = { PN532Frame::IN_DATA_EXCHANGE, 0x01, NTAG_READ, page };
+        m_pages = READ_LENGTH / 4;
+        issue(stage, command, sizeof(command), READ_OVERHEAD + READ_LENGTH);
+    }
+
+    void NFCEngine::readNext()
+    {
+        NFCCard& card = m_card;
+        if (card.dataLength >= card.capacity)
+        {
+            m_stage = NFCStage::PARSE;
+            return;
+        }
+
+        uint8_t page = static_cast<uint8_t>(NFCCard::FIRST_PAGE + card.dataLength / 4);
+        if (!card.fastRead)
+        {
+            readPage(NFCStage::READ_PAGES, page);
+            return;
+        }
+
+        // FAST_READ is not a MIFARE command the chip knows, so it goes through raw
+        uint16_t pages = (card.capacity - card.dataLength + 3) / 4;
+        if (pages > FAST_READ_PAGES) pages = FAST_READ_PAGES;
+        const uint8_t command[] = { PN532Frame::IN_COMMUNICATE_THRU, NTAG_FAST_READ, page, static_cast<uint8_t>(page + pages - 1) };
+        m_pages = static_cast<uint8_t>(pages);
+        issue(NFCStage::READ_PAGES, command, sizeof(command), static_cast<uint8_t>(READ_OVERHEAD + pages * 4));
+    }
+
+    void NFCEngine::fallBack()
+    {
+        // Older tags NAK FAST_READ and drop back to idle, so select again and READ instead
+        m_card.fastRead = false;
+        m_stats.fallbacks++;
+        rememberCapability();
+        detect(NFCStage::RESELECT);
+    }
+
+    void NFCEngine::store(const uint8_t* data, size_t length)
+    {
+        NFCCard& card = m_card;
+        size_t room = card.capacity - card.dataLength;
+        if (length > room) length = room;
+        memcpy(card.data + card.dataLength, data, length);
+        card.dataLength += static_cast<uint16_t>(length);
+    }
+
+    void NFCEngine::handle(const uint8_t* payload, size_t length, uint32_t now)
+    {
+        // Status, then the data asked for
+        bool dataRead = length >= 1u + m_pages * 4u && (payload[0] & STATUS_ERROR_MASK) == 0;
+
+        switch (m_stage)
+        {
+            case NFCStage::CONFIGURE:
+                m_configured = true;
+                detect(NFCStage::DETECT);
+                break;
+
+            case NFCStage::DETECT:
+                accept(payload, length, now);
+                break;
+
+            case NFCStage::CHECK_PRESENCE:
+                if (sameCard(payload, length))
+                {
+                    if (m_verifying)
+                    {
+                        // Still there, but an error cut the check of its cache entry short
+                        beginRead();
+                        break;
+                    }
+                    m_stage = NFCStage::PRESENT;
+                    m_stageMicros = now;
+                    break;
+                }
+
+                // Gone, or swapped for another card in the meantime
+                removed();
+                accept(payload, length, now);
+                break;
+
+            case NFCStage::READ_CAPABILITY:
+                if (!dataRead)
+                {
+                    m_card.locked = true;
+                    m_stage = NFCStage::PARSE;
+                    break;
+                }
+
+                // A READ of page 3 brings pages 4-6 along
+                useCapability(payload + 1);
+                rememberCapability();
+                if (m_card.locked)
+                {
+                    m_stage = NFCStage::PARSE;
+                    break;
+                }
+                store(payload + 5, READ_LENGTH - 4);
+                readNext();
+                break;
+
+            case NFCStage::READ_PAGES:
+                if (!dataRead && m_card.fastRead)
+                {
+                    fallBack();
+                    break;
+                }
+                if (!dataRead)
+                {
+                    m_stage = NFCStage::PARSE;
+                    break;
+                }
+                store(payload + 1, m_pages * 4u);
+                readNext();
+                break;
+
+            case NFCStage::RESELECT:
+                if (sameCard(payload, length))
+                {
+                    readNext();
+                    break;
+                }
+                accept(payload, length, now);
+                break;
+
+            default:
+                break;
+        }
+    }
+
+    void NFCEngine::accept(const uint8_t* payload, size_t length, uint32_t now)
+    {
+        NFCCard& card = m_card;
+        memset(&card, 0, sizeof(card));
+        m_verifying = false;
+        if (!parseTarget(payload, length, card.uid, card.uidLength, card.atqa, card.sak))
+        {
+            // Retries ran out, or the answer was not one we can use
+            detect(NFCStage::DETECT);
+            return;
+        }
+        m_answeredMicros = now;
+
+        const CardContent* content = m_contents ? m_contents->find(card.uid, card.uidLength) : nullptr;
+        if (content)
+        {
+            // Known: react now, and let the read only check the entry is still right
+            m_verifying = true;
+            arrived(0, content);
+        }
+        beginRead();
+    }
+
+    void NFCEngine::beginRead()
+    {
+        NFCCard& card = m_card;
+        card.dataLength = 0;
+
+        // NTAG and Ultralight answer with SAK 0; only they are offered FAST_READ
+        card.fastRead = card.sak == 0x00;
+        int known = findCapability(card.uid, card.uidLength);
+        if (known < 0)
+        {
+            readPage(NFCStage::READ_CAPABILITY, CAPABILITY_PAGE);
+            return;
+        }
+
+        Capability& entry = m_capabilities[known];
+        entry.used = ++m_capabilityStamp;
+        card.fastRead = entry.fastRead;
+        useCapability(entry.container);
+        m_stats.capabilityHits++;
+        if (card.locked)
+        {
+            m_stage = NFCStage::PARSE;
+            return;
+        }
+        readNext();
+    }
+
+    void NFCEngine::useCapability(const uint8_t* container)
+    {
+        NFCCard& card = m_card;
+        memcpy(card.capability, container, sizeof(card.capability));
+        card.locked = (container[3] & 0x0F) != 0;
+
+        uint16_t capacity = container[0] == NDEF_MAGIC ? container[2] * 8u : 0;
+        if (capacity == 0) capacity = NFCCard::DEFAULT_LENGTH;
+        card.capacity = capacity < NFCCard::DATA_CAPACITY ? capacity : NFCCard::DATA_CAPACITY;
+    }
+
+    int NFCEngine::findCapability(const uint8_t* uid, uint8_t uidLength) const
+    {
+        for (uint8_t i = 0; i < CAPABILITY_CACHE; i++)
+        {
+            const Capability& entry = m_capabilities[i];
+            if (entry.used != 0 && entry.uidLength == uidLength && memcmp(entry.uid, uid, uidLength) == 0)
+            {
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    void NFCEngine::rememberCapability()
+    {
+        const NFCCard& card = m_card;
+        int slot = findCapability(card.uid, card.uidLength);
+        if (slot < 0)
+        {
+            slot = 0;
+            for (uint8_t i = 1; i < CAPABILITY_CACHE; i++)
+            {
+                if (m_capabilities[i].used < m_capabilities[slot].used) slot = i;
+            }
+        }
+
+        Capability& entry = m_capabilities[slot];
+        memcpy(entry.uid, card.uid, card.uidLength);
+        entry.uidLength = card.uidLength;
+        memcpy(entry.container, card.capability, sizeof(entry.container));
+        entry.fastRead = card.fastRead;
+        entry.used = ++m_capabilityStamp;
+    }
+
+    bool NFCEngine::sameCard(const uint8_t* payload, size_t length) const
+    {
+        uint8_t uid[NFCCard::MAX_UID];
+        uint8_t uidLength;
+        uint16_t atqa;
+        uint8_t sak;
+        return parseTarget(payload, length, uid, uidLength, atqa, sak) &&
+               uidLength == m_card.uidLength && memcmp(uid, m_card.uid, uidLength) == 0;
+    }
+
+    void NFCEngine::finish(uint32_t now)
+    {
+        NFCCard& card = m_card;
+        if (card.locked)
+        {
+            strcpy(card.text, "CARD ENCRYPTED");
+        }
+        else if (NDEFParser::summarize(card.data, card.dataLength, card.text, sizeof(card.text)) == 0)
+        {
+            // Not NDEF, or nothing readable in it
+            uint16_t used = 0;
+            for (uint16_t i = 0; i < card.dataLength && used < NFCCard::TEXT_LENGTH - 1; i++)
+            {
+                if (card.data[i] >= 32 && card.data[i] <= 126)
+                {
+                    card.text[used++] = static_cast<char>(card.data[i]);
+                }
+            }
+            card.text[used] = '\0';
+        }
+        card.hash = CardContentCache::hash(card.data, card.dataLength);
+
+        m_stage = NFCStage::PRESENT;
+        m_stageMicros = now;
+        uint32_t readMicros = now - m_answeredMicros;
+        if (!m_verifying)
+        {
+            arrived(readMicros, nullptr);
+            return;
+        }
+
+        m_verifying = false;
+        if (!m_contents || !m_contents->validate(card.uid, card.uidLength, card.hash, card.dataLength))
+        {
+            emit(NFCEventType::CARD_CHANGED, readMicros, nullptr);
+        }
+    }
+
+    void NFCEngine::arrived(uint32_t readMicros, const CardContent* content)
+    {
+        m_stats.arrivals++;
+        m_stats.lastReadMicros = readMicros;
+        if (readMicros > m_stats.maxReadMicros) m_stats.maxReadMicros = readMicros;
+
+        m_present = true;
+        emit(NFCEventType::CARD_ARRIVED, readMicros, content);
+    }
+
+    void NFCEngine::removed()
+    {
+        if (!m_present) return;
+        m_present = false;
+        m_verifying = false;
+        m_stats.removals++;
+        emit(NFCEventType::CARD_REMOVED, 0, nullptr);
+    }
+
+    void NFCEngine::fail(bool timeout, uint32_t now)
+    {
+        m_stats.errors++;
+        if (timeout) m_stats.timeouts++;
+
+        // Harmless if the chip had nothing running
+        abort();
+
+        // A page is worth asking for again before the whole card is
+        bool reading = m_stage == NFCStage::READ_CAPABILITY || m_stage == NFCStage::READ_PAGES ||
+                       m_stage == NFCStage::RESELECT;
+        if (reading && ++m_attempts < MAX_ATTEMPTS)
+        {
+            m_phase = Phase::SEND;
+            return;
+        }
+        if (m_stage == NFCStage::READ_PAGES && m_card.fastRead)
+        {
+            // Never answered at all rather than NAKed; READ may still work
+            fallBack();
+            return;
+        }
+        m_stage = NFCStage::BACKOFF;
+        m_phase = Phase::IDLE;
+        m_stageMicros = now;
+    }
+
+    void NFCEngine::abort()
+    {
+        m_transport.write(m_transport.context, PN532Frame::ACK, PN532Frame::ACK_LENGTH);
+        m_phase = Phase::IDLE;
+    }
+
+    void NFCEngine::emit(NFCEventType type, uint32_t readMicros, const CardContent* content)
+    {
+        if (!m_callback) return;
+        NFCEvent event;
+        event.type = type;
+        event.card = &m_card;
+        event.readMicros = readMicros;
+        event.content = content;
+        m_callback(m_context, event);
+    }
+
+    bool NFCEngine::parseTarget(const uint8_t* payload, size_t length, uint8_t* uid, uint8_t& uidLength, uint16_t& atqa, uint8_t& sak)
+    {
+        // NbTg, Tg, SENS_RES (2), SEL_RES, NFCIDLength, NFCID
+        if (length < 6 || payload[0] == 0)
+        {
+            return false;
+        }
+        uint8_t idLength = payload[5];
+        if (idLength == 0 || idLength > NFCCard::MAX_UID || length < 6u + idLength)
+        {
+            return false;
+        }
+        atqa = static_cast<uint16_t>((payload[2] << 8) | payload[3]);
+        sak = payload[4];
+        uidLength = idLength;
+        memcpy(uid, payload + 6, idLength);
+        return true;
+    }
+}
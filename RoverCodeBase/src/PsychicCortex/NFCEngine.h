@@ -0,0 +1,254 @@
+/**
+ * @brief NFCEngine finds and reads cards through a PN532 without ever waiting on it
+ *
+ * The Adafruit driver sends a command and spins until the chip answers,
+ * which for a detection means until a card shows up. Here every exchange is
+ * split into send, ACK and response, and update() only moves on when the
+ * chip says a frame is ready:
+ * - Detection leaves InListPassiveTarget outstanding with unlimited retries,
+ *   so an empty field costs one ready check per update()
+ * - A found card is read as a chain of resumable stages: capability
+ *   container, user area, then a summary of its NDEF records
+ * - The user area is sized from the capability container and pulled in
+ *   FAST_READ runs of up to FAST_READ_PAGES; a tag that refuses FAST_READ is
+ *   selected again and read with 16-byte READs instead
+ * - Capability containers are one-time programmable, so the last few are
+ *   kept by UID and a card tapped again skips straight to its user area
+ * - With a CardContentCache, a card it knows is announced as soon as its UID
+ *   answers; the read still runs, and a user area that no longer hashes the
+ *   same drops the entry and announces CARD_CHANGED
+ * - Once handled, the card is checked for again every PRESENCE_INTERVAL; no
+ *   answer within PRESENCE_TIMEOUT means it was taken away
+ * - A missing ACK, a bad frame or a stalled page read aborts the command; a
+ *   page is asked for again up to MAX_ATTEMPTS times, anything else starts
+ *   over after BACKOFF without losing track of a card already seen
+ *
+ * Both costs are measured: how long an update() holds up its caller, and
+ * how long a card takes from answering to its CARD_ARRIVED event, broken
+ * down by the time spent in each stage.
+ *
+ * Platform-free: the chip is reached through PN532Transport, so the engine
+ * runs on host against a scripted stand-in.
+ */
+
+#ifndef NFC_ENGINE_H
+#define NFC_ENGINE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "PN532Frame.h"
+#include "CardContentCache.h"
+
+namespace PsychicCortex
+{
+    enum class NFCStage : uint8_t
+    {
+        STOPPED,
+        CONFIGURE,          // Passive activation retries
+        DETECT,             // Waiting for a card to answer
+        READ_CAPABILITY,    // Page 3: capability container and access bits
+        READ_PAGES,         // User area: FAST_READ runs, or 16-byte READs
+        RESELECT,           // After a tag refused FAST_READ
+        PARSE,              // Text out of the NDEF records, or the raw pages
+        PRESENT,            // Card handled; waiting to check it is still there
+        CHECK_PRESENCE,
+        BACKOFF             // After an error
+    };
+
+    constexpr uint8_t NFC_STAGE_COUNT = static_cast<uint8_t>(NFCStage::BACKOFF) + 1;
+
+    struct NFCCard
+    {
+        static constexpr uint8_t MAX_UID = 10;
+        static constexpr uint8_t FIRST_PAGE = 4;
+        static constexpr uint16_t DATA_CAPACITY = 872;  // NTAG216 user area
+        static constexpr uint16_t DEFAULT_LENGTH = 112; // Pages 4-31, without an NDEF capability container
+        static constexpr uint16_t TEXT_LENGTH = 256;
+
+        uint8_t uid[MAX_UID];
+        uint8_t uidLength;
+        uint16_t atqa;
+        uint8_t sak;
+        uint8_t capability[4];      // Page 3: magic, version, user area / 8, access
+        bool locked;                // Page 3 unreadable or its access bits set
+        bool fastRead;              // Answers FAST_READ
+        uint16_t capacity;          // User area bytes to read
+        uint8_t data[DATA_CAPACITY];    // From FIRST_PAGE
+        uint16_t dataLength;        // Up to capacity, or the first page that failed
+        char text[TEXT_LENGTH];     // NDEF text, URIs and MIME types; else printable bytes of data
+        uint32_t hash;              // CardContentCache::hash of data
+    };
+
+    enum class NFCEventType : uint8_t
+    {
+        CARD_ARRIVED,
+        CARD_CHANGED,       // Announced from the cache, then read differently
+        CARD_REMOVED
+    };
+
+    struct NFCEvent
+    {
+        NFCEventType type;
+        const NFCCard* card;
+        uint32_t readMicros;        // Card answered to CARD_ARRIVED
+        const CardContent* content; // Cached entry when announced before the read; only the UID is in card yet
+    };
+
+    /**
+     * @brief Runs inside update()
+     */
+    typedef void (*NFCEventCallback)(void* context, const NFCEvent& event);
+
+    struct NFCEngineStats
+    {
+        uint32_t arrivals;
+        uint32_t removals;
+        uint32_t commands;
+        uint32_t errors;            // Bad or missing frames, timeouts included
+        uint32_t timeouts;
+        uint32_t capabilityHits;    // Cards whose capability container was known
+        uint32_t fallbacks;         // Cards that refused FAST_READ
+        uint32_t updates;
+        uint32_t maxUpdateMicros;   // Longest update(): the stall the caller sees
+        uint64_t updateMicros;
+        uint32_t lastReadMicros;
+        uint32_t maxReadMicros;
+        uint32_t stageEntries[NFC_STAGE_COUNT];     // By NFCStage
+        uint64_t stageMicros[NFC_STAGE_COUNT];      // From entering a stage to leaving it
+    };
+
+    class NFCEngine
+    {
+    public:
+        static constexpr uint32_t ACK_TIMEOUT = 15000;          // Microseconds, as are the rest
+        static constexpr uint32_t RESPONSE_TIMEOUT = 100000;    // Page reads; detection waits indefinitely
+        static constexpr uint32_t PRESENCE_INTERVAL = 250000;
+        static constexpr uint32_t PRESENCE_TIMEOUT = 60000;
+        static constexpr uint32_t BACKOFF = 250000;
+        static constexpr uint8_t MAX_ATTEMPTS = 3;              // Per page before starting over
+        static constexpr uint32_t UPDATE_BUDGET = 2000;
+        static constexpr uint8_t FAST_READ_PAGES = 28;          // Keeps an answer inside a 128-byte I2C buffer
+        static constexpr uint8_t CAPABILITY_CACHE = 8;
+        static constexpr size_t FRAME_CAPACITY = 128;
+
+        NFCEngine(const PN532Transport& transport, NFCEventCallback callback, void* context);
+
+        /**
+         * @brief Announce known cards from cache before reading them; nullptr turns it off
+         *
+         * The engine looks entries up and validates them; storing is left to
+         * whoever works out the content from CARD_ARRIVED and CARD_CHANGED.
+         */
+        void setContentCache(CardContentCache* cache) { m_contents = cache; }
+
+        /**
+         * @brief Begin detecting; the chip must already be initialised and SAM-configured
+         */
+        void start();
+
+        /**
+         * @brief Abort whatever is outstanding; no CARD_REMOVED follows
+         */
+        void stop();
+
+        /**
+         * @brief Move on as far as the chip allows, for about budget microseconds at most
+         *
+         * Each bus operation is one short write or read. Only an ACK, due within
+         * a millisecond, is polled for inside the budget; answers that take the
+         * chip longer are picked up by a later call.
+         */
+        void update(uint32_t budget = UPDATE_BUDGET);
+
+        NFCStage stage() const { return m_stage; }
+        bool isCardPresent() const { return m_present; }
+
+        /**
+         * @brief Last card read; valid once CARD_ARRIVED has been sent
+         */
+        const NFCCard& card() const { return m_card; }
+        const NFCEngineStats& stats() const { return m_stats; }
+
+    private:
+        enum class Phase : uint8_t
+        {
+            IDLE,               // Nothing outstanding on the bus
+            SEND,
+            WAIT_ACK,
+            WAIT_RESPONSE
+        };
+
+        static constexpr uint8_t COMMAND_CAPACITY = 8;
+
+        struct Capability
+        {
+            uint8_t uid[NFCCard::MAX_UID];
+            uint8_t uidLength;
+            uint8_t container[4];
+            bool fastRead;
+            uint32_t used;          // Stamp for least recently used
+        };
+
+        PN532Transport m_transport;
+        NFCEventCallback m_callback;
+        void* m_context;
+        CardContentCache* m_contents;
+
+        NFCStage m_stage;
+        Phase m_phase;
+        uint8_t m_command[COMMAND_CAPACITY];
+        uint8_t m_commandLength;
+        uint8_t m_responseLength;       // Bytes to read for the expected answer
+        uint32_t m_phaseMicros;         // When the current phase began
+        uint32_t m_stageMicros;
+        NFCStage m_timedStage;          // Stage the time since m_timedMicros is counted against
+        uint32_t m_timedMicros;
+        uint32_t m_answeredMicros;      // When the card being read answered
+        uint8_t m_pages;                // Asked for by the outstanding read
+        uint8_t m_attempts;             // At the current command
+        bool m_configured;
+        bool m_present;
+        bool m_verifying;               // Announced from cache; the read checks the entry
+        NFCCard m_card;
+        Capability m_capabilities[CAPABILITY_CACHE];
+        uint32_t m_capabilityStamp;
+        NFCEngineStats m_stats;
+        uint8_t m_frame[FRAME_CAPACITY];
+
+        /**
+         * @brief One bus operation or stage change
+         * @return false when waiting on the chip or the clock
+         */
+        bool step();
+        void timeStage(uint32_t now);
+        bool advance(uint32_t now);
+        void issue(NFCStage stage, const uint8_t* command, uint8_t length, uint8_t responseLength);
+        void detect(NFCStage stage);
+        void readPage(NFCStage stage, uint8_t page);
+        void readNext();
+        void fallBack();
+        void store(const uint8_t* data, size_t length);
+        void useCapability(const uint8_t* container);
+        int findCapability(const uint8_t* uid, uint8_t uidLength) const;
+        void rememberCapability();
+        bool sameCard(const uint8_t* payload, size_t length) const;
+        void handle(const uint8_t* payload, size_t length, uint32_t now);
+        void accept(const uint8_t* payload, size_t length, uint32_t now);
+        void beginRead();
+        void finish(uint32_t now);
+        void arrived(uint32_t readMicros, const CardContent* content);
+        void removed();
+        void fail(bool timeout, uint32_t now);
+        void abort();
+        void emit(NFCEventType type, uint32_t readMicros, const CardContent* content);
+        uint32_t now() const { return m_transport.micros(m_transport.context); }
+
+        /**
+         * @brief Target data of an InListPassiveTarget answer
+         * @return false if no card answered or the answer is short
+         */
+        static bool parseTarget(const uint8_t* payload, size_t length, uint8_t* uid, uint8_t& uidLength, uint16_t& atqa, uint8_t& sak);
+    };
+}
+
+#endif // NFC_ENGINE_H
@@ -1,9 +1,13 @@
 #include "NFCManager.h"
+#include "NDEFParser.h"
+#include "NFCDump.h"
+#include "PN532Emulator.h"
 #include "../AuditoryCortex/SoundFxManager.h"
 #include "../VisualCortex/LEDManager.h"
 #include "../VisualCortex/RoverViewManager.h"
 #include "../VisualCortex/VisualSynesthesia.h"
 #include "../PrefrontalCortex/SDManager.h"
+#include "../PrefrontalCortex/SPIManager.h"
 #include "../PrefrontalCortex/Utilities.h"
 #include "../PrefrontalCortex/ProtoPerceptions.h"
 #include <Wire.h>
@@ -30,6 +34,31 @@ namespace PsychicCortex
     InitState NFCManager::initState = InitState::NOT_STARTED;
     uint8_t NFCManager::initRetries = 0;
     unsigned long NFCManager::initStartTime = 0;
+    const PN532Transport NFCManager::TRANSPORT = {
+        engineMicros, writeEngine, engineReady, readEngine, nullptr
+    };
+    NFCEngine NFCManager::engine(NFCManager::TRANSPORT, NFCManager::handleCardEvent, nullptr);
+    CardContentCache NFCManager::contentCache;
+    CardContent NFCManager::currentContent = {};
+    bool NFCManager::songAwaitingRead = false;
+    const char* NFCManager::CONTENT_CACHE_FILE = "/nfc/card_content.bin";
+
+    namespace {
+        const char* const STAGE_NAMES[NFC_STAGE_COUNT] = {
+            "stopped", "configure", "detect", "read capability", "read pages",
+            "reselect", "parse", "present", "check presence", "backoff"
+        };
+
+        /**
+         * @brief What a replayed tap produced
+         */
+        struct ReplayLog {
+            uint8_t arrivals;
+            uint8_t removals;
+            uint8_t other;
+            uint32_t readMicros;
+        };
+    }
 
     // Example valid card IDs for testing and validation
     const char* validCardIDs[] = {
@@ -45,6 +74,7 @@ namespace PsychicCortex
      */
     void NFCManager::init() {
         PrefrontalCortex::Utilities::LOG_PROD("Starting NFC initialization...");
+        totalScans = PC::SDManager::getSetting(PC::SDManager::SETTING_TOTAL_SCANS, totalScans);
         Wire.begin(BOARD_I2C_SDA, BOARD_I2C_SCL);
         
         nfc.begin();
@@ -60,6 +90,7 @@ namespace PsychicCortex
         PrefrontalCortex::Utilities::LOG_PROD("Firmware ver. %d.%d", (versiondata >> 16) & 0xFF, (versiondata >> 8) & 0xFF);
         
         nfc.SAMConfig();
+        startEngine();
         PrefrontalCortex::Utilities::LOG_PROD("NFC initialization complete");
         
         AuditoryCortex::SoundFxManager::playStartupSound();
@@ -99,7 +130,7 @@ namespace PsychicCortex
      * Handles initialization, card detection, and data processing
      */
     void NFCManager::update() {
-        if (initInProgress && !AC::SoundFxManager::isPlaying()) {
+        if (initInProgress) {
             if (millis() - lastInitAttempt < 1000) return; // Don't try too frequently
             
             switch (initStage) {
@@ -111,6 +142,7 @@ namespace PsychicCortex
                 case 1:
                     if (nfc.getFirmwareVersion()) {
                         nfc.SAMConfig();
+                        startEngine();
                         initInProgress = false;
                         PC::Utilities::LOG_PROD("NFC initialization complete");
                     } else {
@@ -122,75 +154,216 @@ namespace PsychicCortex
             return;
         }
         
-        if (isProcessingScan || AC::SoundFxManager::isPlaying()) return;
-        
-        static unsigned long lastScanTime = 0;
-        const unsigned long SCAN_COOLDOWN = 5000;
-        
-        if (millis() - lastScanTime < SCAN_COOLDOWN) return;
-        
-        uint8_t success;
-        uint8_t uid[] = { 0, 0, 0, 0, 0, 0, 0 };
-        uint8_t uidLength;
+        if (isProcessingScan) return;
         
-        if (nfc.readPassiveTargetID(PN532_MIFARE_ISO14443A, uid, &uidLength)) {
-            if (!cardPresent) {
-                cardPresent = true;
-                VC::LEDManager::setPattern(PC::VisualPattern::NFC_SCAN);
-                
-                if (isCardValid()) {
-                    VC::LEDManager::handleMessage(PC::VisualMessage::NFC_DETECTED);
-                    
-                    // Calculate experience based on card data
-                    uint16_t expGain = (uid[0] + uid[1] + uid[2] + uid[3]) % 50 + 10;
-                    VC::RoverViewManager::incrementExperience(expGain);
-                    
-                    // Start entertainment pattern using card data
-                    VC::LEDManager::displayCardPattern(uid, uidLength);
-                    
-                    // Read card data and generate song
-                    readCardData();
-                    VC::VisualSynesthesia::playNFCCardData(cardData);
-                } else { 
-                    VC::LEDManager::handleMessage(PC::VisualMessage::NFC_ERROR);
-                }
+        // Never waits on the chip; card reactions run from handleCardEvent()
+        engine.update();
+
+        // A cached song as long as its entry goes on from the card once the read has confirmed it
+        if (songAwaitingRead && engine.stage() == NFCStage::PRESENT) {
+            songAwaitingRead = false;
+            const NFCCard& card = engine.card();
+            if (card.hash == currentContent.hash && card.dataLength == currentContent.dataLength) {
+                VC::VisualSynesthesia::continueCardSong(card.data, card.dataLength, card.text);
             }
-        } else {
+        }
+    }
+
+    /**
+     * @brief React to a card the engine has read, or to it being taken away
+     */
+    void NFCManager::handleCardEvent(void* context, const NFCEvent& event) {
+        songAwaitingRead = false;
+        if (event.type == NFCEventType::CARD_REMOVED) {
             cardPresent = false;
             VC::LEDManager::setPattern(PC::VisualPattern::NONE);
+            saveContentCache();
+            return;
+        }
+
+        if (event.type == NFCEventType::CARD_CHANGED) {
+            // Written elsewhere since it was cached; react again to what it holds now
+            describeCard(*event.card, currentContent);
+            contentCache.store(currentContent);
+            reactToCard(currentContent, false, event.card);
+            PC::Utilities::LOG_DEBUG("NFC card changed, read in %u us", event.readMicros);
+            return;
         }
+
+        // Known cards come with their content; nothing has been read off them yet
+        if (event.content) {
+            currentContent = *event.content;
+            songAwaitingRead = currentContent.noteCount == CardContent::MAX_NOTES;
+            reactToCard(currentContent, true, nullptr);
+        } else {
+            describeCard(*event.card, currentContent);
+            contentCache.store(currentContent);
+            reactToCard(currentContent, true, event.card);
+        }
+        PC::Utilities::LOG_DEBUG("NFC card %s in %u us", event.content ? "from cache" : "read", event.readMicros);
     }
 
     /**
-     * @brief Read data from detected NFC card
-     * Processes card pages and handles encryption
+     * @brief Work out everything a card is reacted to with, for the cache
      */
-    void NFCManager::readCardData() {
-        memset(cardData, 0, sizeof(cardData));
-        
-        if (isCardEncrypted()) {
-            strcpy(cardData, "CARD ENCRYPTED");
-            return;
+    void NFCManager::describeCard(const NFCCard& card, CardContent& content) {
+        memset(&content, 0, sizeof(content));
+        memcpy(content.uid, card.uid, card.uidLength);
+        content.uidLength = card.uidLength;
+        content.locked = card.locked;
+        content.dataLength = card.dataLength;
+        content.hash = card.hash;
+        strncpy(content.text, card.text, sizeof(content.text) - 1);
+        content.experience = experienceFor(card);
+
+        // The LED pattern is seeded by the UID
+        memcpy(content.pattern, card.uid, card.uidLength);
+        content.patternLength = card.uidLength;
+
+        // Song from the card's records, or its raw text without any
+        bool found = false;
+        size_t notes = VC::VisualSynesthesia::composeNFCCardData(card.data, card.dataLength, content.notes, CardContent::MAX_NOTES, &found);
+        if (!found) {
+            notes = VC::VisualSynesthesia::composeNFCCardData(card.text, content.notes, CardContent::MAX_NOTES);
+        }
+        content.noteCount = static_cast<uint8_t>(notes);
+    }
+
+    /**
+     * @brief LEDs, song and experience for a card; a rewritten card is not counted as another scan
+     * @param card The card as read, for songs longer than content keeps; nullptr before the read
+     */
+    void NFCManager::reactToCard(const CardContent& content, bool newScan, const NFCCard* card) {
+        cardPresent = true;
+        VC::LEDManager::setPattern(PC::VisualPattern::NFC_SCAN);
+
+        if (newScan) {
+            // Scan history: one Bloom probe, at most one sector read, one log append; one lease with the count
+            PC::SPILease lease(PC::SPIDevice::SD, PC::SPIPriority::NORMAL);
+            lastCardId = (content.uid[0] << 24) | (content.uid[1] << 16) | (content.uid[2] << 8) | content.uid[3];
+            PC::SDManager::recordCardScan(lastCardId);
+            totalScans++;
+            PC::SDManager::putSetting(PC::SDManager::SETTING_TOTAL_SCANS, totalScans);
         }
         
-        uint8_t data[4];
-        int dataIndex = 0;
-        const uint8_t MAX_PAGES = 32; // Protect against buffer overflow
-        
-        for (uint8_t page = 4; page < MAX_PAGES && dataIndex < sizeof(cardData) - 1; page++) {
-            if (nfc.ntag2xx_ReadPage(page, data)) {
-                for (int i = 0; i < 4 && dataIndex < sizeof(cardData) - 1; i++) {
-                    if (data[i] >= 32 && data[i] <= 126)  // Printable ASCII only
-                    {
-                        cardData[dataIndex++] = data[i];
-                    }
-                }
+        readCardData();
+        if (isCardValid()) {
+            VC::LEDManager::handleMessage(PC::VisualMessage::NFC_DETECTED);
+            
+            if (newScan) {
+                VC::RoverViewManager::incrementExperience(content.experience);
+            }
+            
+            // Start entertainment pattern using card data
+            VC::LEDManager::displayCardPattern(content.pattern, content.patternLength);
+            if (card) {
+                VC::VisualSynesthesia::playCardNotes(content.notes, content.noteCount, card->data, card->dataLength, card->text);
             } else {
-                break; // Stop reading if page read fails
+                VC::VisualSynesthesia::playCardNotes(content.notes, content.noteCount);
             }
+        } else { 
+            VC::LEDManager::handleMessage(PC::VisualMessage::NFC_ERROR);
         }
-        
-        cardData[dataIndex] = '\0'; // Ensure null termination
+    }
+
+    /**
+     * @brief Write the card content cache to SD when it has changed
+     */
+    void NFCManager::saveContentCache() {
+        if (!contentCache.isDirty() || !PC::SDManager::isInitialized()) return;
+        PC::SPILease lease(PC::SPIDevice::SD, PC::SPIPriority::NORMAL);
+        if (!contentCache.save(PC::SDManager::getStorage(), CONTENT_CACHE_FILE)) {
+            PC::Utilities::LOG_WARNING("Card content cache not saved");
+        }
+    }
+
+    /**
+     * @brief Replayed taps get the same reactions as real ones, without counting as scans
+     */
+    void NFCManager::handleReplayEvent(void* context, const NFCEvent& event) {
+        ReplayLog& log = *static_cast<ReplayLog*>(context);
+        switch (event.type) {
+            case NFCEventType::CARD_ARRIVED:
+                log.arrivals++;
+                log.readMicros = event.readMicros;
+                describeCard(*event.card, currentContent);
+                reactToCard(currentContent, false, event.card);
+                break;
+            case NFCEventType::CARD_REMOVED:
+                log.removals++;
+                cardPresent = false;
+                VC::LEDManager::setPattern(PC::VisualPattern::NONE);
+                break;
+            default:
+                log.other++;
+                break;
+        }
+    }
+
+    bool NFCManager::replayDump(const char* path) {
+        if (!PC::SDManager::isInitialized()) {
+            PC::Utilities::LOG_ERROR("No SD card to replay %s from", path);
+            return false;
+        }
+
+        // The dump, the stand-in chip and a second engine only live for the replay; keep them off the loop stack
+        NFCDump* dump = new NFCDump;
+        bool loaded;
+        {
+            PC::SPILease lease(PC::SPIDevice::SD, PC::SPIPriority::NORMAL);
+            loaded = NFCDumpReader::load(PC::SDManager::getStorage(), path, *dump);
+        }
+        if (!loaded) {
+            PC::Utilities::LOG_ERROR("Cannot replay %s: not a whole Flipper NFC dump", path);
+            delete dump;
+            return false;
+        }
+        PN532Emulator* chip = new PN532Emulator();
+        ReplayLog log = {};
+        NFCEngine* replay = new NFCEngine(chip->transport(), handleReplayEvent, &log);
+
+        // Tap: in the field from the start, taken away once it has been handled for a while
+        replay->start();
+        chip->place(dump);
+        bool inField = true;
+        uint32_t arrivedMicros = 0;
+        while (log.removals == 0 && chip->micros() < REPLAY_TIMEOUT) {
+            replay->update();
+            chip->advance(REPLAY_LOOP);
+            if (log.arrivals == 0) {
+                arrivedMicros = chip->micros();
+            } else if (inField && chip->micros() - arrivedMicros >= REPLAY_DWELL) {
+                chip->place(nullptr);
+                inField = false;
+            }
+        }
+        replay->stop();
+
+        const NFCEngineStats& stats = replay->stats();
+        const PN532EmulatorStats& bus = chip->stats();
+        PC::Utilities::LOG_PROD("Replay %s: %u arrived, %u removed, read in %u us; %u commands, %u errors, %u bytes over RF, \"%s\"",
+            path, log.arrivals, log.removals, log.readMicros, bus.commands, stats.errors, bus.rfBytes, cardData);
+        for (uint8_t i = 0; i < NFC_STAGE_COUNT; i++) {
+            if (stats.stageEntries[i] == 0) continue;
+            PC::Utilities::LOG_DEBUG("  %-16s %3u x %8u us", STAGE_NAMES[i], stats.stageEntries[i], (uint32_t)stats.stageMicros[i]);
+        }
+        bool passed = log.arrivals == 1 && log.removals == 1 && log.other == 0;
+
+        delete replay;
+        delete chip;
+        delete dump;
+        cardPresent = engine.isCardPresent();
+        return passed;
+    }
+
+    /**
+     * @brief Read data from detected NFC card
+     * Processes card pages and handles encryption
+     */
+    void NFCManager::readCardData() {
+        // From the card's cached or freshly read content; the encrypted marker is set by the engine
+        strncpy(cardData, currentContent.text, sizeof(cardData) - 1);
+        cardData[sizeof(cardData) - 1] = '\0';
     }
 
     /**
@@ -220,13 +393,8 @@ namespace PsychicCortex
      * Reads authentication block and checks security bits
      */
     bool NFCManager::checkForEncryption() {
-        uint8_t data[4];
-        // Check authentication block
-        if (!nfc.ntag2xx_ReadPage(3, data)) {
-            return true; // If we can't read the auth block, assume encrypted
-        }
-        // Check if any authentication bits are set
-        return (data[3] & 0x0F) != 0;
+        // Page 3 as the engine read it: unreadable or with authentication bits set
+        return currentContent.locked;
     }
 
     /**
@@ -234,20 +402,13 @@ namespace PsychicCortex
      * Reads card UID and updates system state
      */
     void NFCManager::checkForCard() {
-        uint8_t success;
-        uint8_t uid[] = { 0, 0, 0, 0, 0, 0, 0 };
-        uint8_t uidLength;
-        
-        success = nfc.readPassiveTargetID(PN532_MIFARE_ISO14443A, uid, &uidLength);
-        
-        if (success) {
-            lastCardId = (uid[0] << 24) | (uid[1] << 16) | (uid[2] << 8) | uid[3];
-            cardPresent = true;
-            VC::LEDManager::displayCardPattern(uid, uidLength);
-            readCardData();
-        } else {
-            cardPresent = false;
-        }
+        cardPresent = engine.isCardPresent();
+        if (!cardPresent) return;
+
+        const CardContent& content = currentContent;
+        lastCardId = (content.uid[0] << 24) | (content.uid[1] << 16) | (content.uid[2] << 8) | content.uid[3];
+        VC::LEDManager::displayCardPattern(content.pattern, content.patternLength);
+        readCardData();
     }
 
     /**
@@ -258,6 +419,8 @@ namespace PsychicCortex
         isProcessingScan = false;
         initInProgress = false;
         cardPresent = false;
+        engine.stop();
+        saveContentCache();
     }
 
     /**
@@ -293,4 +456,80 @@ namespace PsychicCortex
         #endif
     }
 
+    /**
+     * @brief Experience for a card: a share from its UID, plus a bonus for what it carries
+     */
+    uint16_t NFCManager::experienceFor(const NFCCard& card) {
+        uint16_t exp = (card.uid[0] + card.uid[1] + card.uid[2] + card.uid[3]) % 50 + 10;
+        if (card.locked) return exp;
+
+        NDEFParser parser(card.data, card.dataLength);
+        NDEFRecord record;
+        uint16_t bonus = 0;
+        while (bonus < MAX_CONTENT_EXPERIENCE && parser.next(record)) {
+            switch (record.kind) {
+                case NDEFRecordKind::TEXT:
+                case NDEFRecordKind::URI:
+                case NDEFRecordKind::ABSOLUTE_URI:
+                    bonus += 5;
+                    break;
+                case NDEFRecordKind::MIME:
+                case NDEFRecordKind::SMART_POSTER:
+                    bonus += 10;
+                    break;
+                case NDEFRecordKind::EMPTY:
+                    break;
+                default:
+                    bonus += 2;
+                    break;
+            }
+        }
+        return exp + (bonus < MAX_CONTENT_EXPERIENCE ? bonus : MAX_CONTENT_EXPERIENCE);
+    }
+
+    void NFCManager::startEngine() {
+        if (USE_IRQ) {
+            pinMode(BOARD_PN532_IRQ, INPUT_PULLUP);
+        }
+        if (PC::SDManager::isInitialized()) {
+            PC::SPILease lease(PC::SPIDevice::SD, PC::SPIPriority::NORMAL);
+            if (contentCache.load(PC::SDManager::getStorage(), CONTENT_CACHE_FILE)) {
+                PC::Utilities::LOG_DEBUG("%u cards in the content cache", contentCache.size());
+            }
+        }
+        engine.setContentCache(&contentCache);
+        engine.start();
+    }
+
+    uint32_t NFCManager::engineMicros(void* context) {
+        return micros();
+    }
+
+    bool NFCManager::writeEngine(void* context, const uint8_t* data, size_t length) {
+        Wire.beginTransmission(BOARD_I2C_ADDR_1);
+        Wire.write(data, length);
+        return Wire.endTransmission() == 0;
+    }
+
+    bool NFCManager::engineReady(void* context) {
+        // The chip pulls IRQ low while a frame waits; without it, ask for the status byte
+        if (USE_IRQ) {
+            return digitalRead(BOARD_PN532_IRQ) == LOW;
+        }
+        if (Wire.requestFrom((uint8_t)BOARD_I2C_ADDR_1, (uint8_t)1) != 1) return false;
+        return (Wire.read() & PN532_READY) != 0;
+    }
+
+    bool NFCManager::readEngine(void* context, uint8_t* data, size_t length) {
+        size_t received = Wire.requestFrom((uint8_t)BOARD_I2C_ADDR_1, (uint8_t)(length + 1));
+        if (received != length + 1 || (Wire.read() & PN532_READY) == 0) {
+            while (Wire.available()) Wire.read();
+            return false;
+        }
+        for (size_t i = 0; i < length; i++) {
+            data[i] = Wire.read();
+        }
+        return true;
+    }
+
 }
\ No newline at end of file
@@ -6,6 +6,7 @@
 #include "../VisualCortex/LEDManager.h"
 #include "../CorpusCallosum/SynapticPathways.h"
 #include "../PrefrontalCortex/ProtoPerceptions.h"
+#include "NFCEngine.h"
 
 namespace PsychicCortex 
 {
@@ -23,6 +24,11 @@ namespace PsychicCortex
      * - Data reading and encryption checking
      * - Background initialization process
      * - User input handling for NFC operations
+     *
+     * The Adafruit driver only brings the chip up; from then on NFCEngine
+     * talks to it over I2C and update() never waits for a card. What a card
+     * is reacted to with is worked out once and kept in a CardContentCache,
+     * saved to SD, so a card seen before is reacted to before it is read.
      */
     class NFCManager {
     public:
@@ -48,6 +54,27 @@ namespace PsychicCortex
         static bool isCardValid();
         static void handleRotaryTurn(int direction);
         static void handleRotaryPress();
+
+        /**
+         * @brief Loop stall and card read times of the NFC engine
+         */
+        static const NFCEngineStats& getEngineStats() { return engine.stats(); }
+
+        /**
+         * @brief Hits, misses, evictions and stale entries of the card content cache
+         */
+        static const CardContentStats& getContentCacheStats() { return contentCache.stats(); }
+        static uint8_t getContentCacheHitRate() { return contentCache.hitRate(); }
+
+        /**
+         * @brief Tap a Flipper .nfc dump from SD through a second engine and the card reactions
+         *
+         * An emulated PN532 answers from the dump, so validation, LEDs and the
+         * song run as for a real tap; scan history, experience and the content
+         * cache are left alone. Logs the read time and each engine stage.
+         * @return false if the dump cannot be read, or the card did not arrive and leave once each
+         */
+        static bool replayDump(const char* path);
         
     private:
         // Hardware interface
@@ -68,6 +95,37 @@ namespace PsychicCortex
         static InitState initState;
         static uint8_t initRetries;
         static unsigned long initStartTime;
+
+        /**
+         * @brief NFCEngine over I2C; ready is the IRQ line when USE_IRQ, else a status read
+         */
+        static NFCEngine engine;
+        static const PN532Transport TRANSPORT;
+        static constexpr bool USE_IRQ = true;
+        static constexpr uint8_t PN532_READY = 0x01;        // Status byte ahead of every I2C read
+        static void startEngine();
+        static uint32_t engineMicros(void* context);
+        static bool writeEngine(void* context, const uint8_t* data, size_t length);
+        static bool engineReady(void* context);
+        static bool readEngine(void* context, uint8_t* data, size_t length);
+        static void handleCardEvent(void* context, const NFCEvent& event);
+        static void handleReplayEvent(void* context, const NFCEvent& event);
+        static constexpr uint32_t REPLAY_LOOP = 5000;           // Microseconds between engine updates
+        static constexpr uint32_t REPLAY_DWELL = 600000;        // In the field after arriving: two presence checks
+        static constexpr uint32_t REPLAY_TIMEOUT = 3000000;
+        static const uint16_t MAX_CONTENT_EXPERIENCE = 30;
+        static uint16_t experienceFor(const NFCCard& card);
+
+        /**
+         * @brief Content of known cards, and of the one being reacted to
+         */
+        static CardContentCache contentCache;
+        static CardContent currentContent;
+        static bool songAwaitingRead;   // Its cached notes are playing; the rest comes from the read
+        static const char* CONTENT_CACHE_FILE;
+        static void describeCard(const NFCCard& card, CardContent& content);
+        static void reactToCard(const CardContent& content, bool newScan, const NFCCard* card);
+        static void saveContentCache();
     };
 
 }
@@ -0,0 +1,283 @@
+/**
+ * @file PN532Emulator.cpp
+ * @brief PN532 and card stand-in answering from a tag dump
+ */
+
+#include "PN532Emulator.h"
+#include <string.h>
+
+namespace PsychicCortex
+{
+    namespace
+    {
+        constexpr uint8_t NTAG_READ = 0x30;
+        constexpr uint8_t NTAG_FAST_READ = 0x3A;
+        constexpr uint8_t READ_PAGES = 4;               // A READ answers 16 bytes
+        constexpr uint8_t STATUS_TIMEOUT = 0x01;        // No answer from the card
+        constexpr uint8_t STATUS_NAK = 0x14;            // Mifare authentication error, or a NAK
+        constexpr uint8_t FRAME_HEADER = 7;             // Preamble to response code
+    }
+
+    PN532Emulator::PN532Emulator()
+        : m_card(nullptr)
+        , m_placedMicros(0)
+        , m_halted(false)
+        , m_commandLength(0)
+        , m_pending(false)
+        , m_ackRead(false)
+        , m_answered(false)
+        , m_ackMicros(0)
+        , m_responseMicros(0)
+        , m_responseLength(0)
+        , m_now(0)
+    {
+        memset(m_command, 0, sizeof(m_command));
+        memset(m_response, 0, sizeof(m_response));
+        memset(&m_stats, 0, sizeof(m_stats));
+    }
+
+    PN532Transport PN532Emulator::transport()
+    {
+        PN532Transport hooks = { transportMicros, transportWrite, transportReady, transportRead, this };
+        return hooks;
+    }
+
+    void PN532Emulator::place(const NFCDump* dump)
+    {
+        m_card = dump;
+        m_placedMicros = m_now;
+        m_halted = false;
+    }
+
+    bool PN532Emulator::resolve()
+    {
+        if (!m_pending || !m_ackRead || m_answered)
+        {
+            return m_answered;
+        }
+
+        switch (m_command[0])
+        {
+            case PN532Frame::RF_CONFIGURATION:
+                answer(nullptr, 0, m_ackMicros + HANDLING);
+                break;
+
+            case PN532Frame::IN_LIST_PASSIVE_TARGET:
+                detect();
+                break;
+
+            case PN532Frame::IN_DATA_EXCHANGE:
+                exchange();
+                break;
+
+            case PN532Frame::IN_COMMUNICATE_THRU:
+                communicate();
+                break;
+
+            default:
+                // A command the chip has but the engine does not send; answer it empty
+                answer(nullptr, 0, m_ackMicros + HANDLING);
+                break;
+        }
+        return m_answered;
+    }
+
+    void PN532Emulator::detect()
+    {
+        // Retries run until a card is placed, then it takes a moment to activate
+        if (m_card == nullptr)
+        {
+            return;
+        }
+        uint32_t entered = m_placedMicros > m_ackMicros ? m_placedMicros : m_ackMicros;
+        uint32_t due = entered + ACTIVATION;
+        if (static_cast<int32_t>(m_now - due) < 0)
+        {
+            return;
+        }
+
+        // NbTg, Tg, SENS_RES, SEL_RES, NFCIDLength, NFCID
+        uint8_t body[6 + NFCDump::MAX_UID];
+        body[0] = 1;
+        body[1] = 1;
+        body[2] = m_card->atqa[0];
+        body[3] = m_card->atqa[1];
+        body[4] = m_card->sak;
+        body[5] = m_card->uidLength;
+        memcpy(body + 6, m_card->uid, m_card->uidLength);
+        m_halted = false;
+        answer(body, 6u + m_card->uidLength, due);
+    }
+
+    void PN532Emulator::exchange()
+    {
+        // Tg, card command, address
+        if (!cardInField() || m_commandLength < 4)
+        {
+            refuse(STATUS_TIMEOUT, m_ackMicros + RF_TIMEOUT);
+            return;
+        }
+        if (m_command[2] != NTAG_READ || m_card->kind == NFCDumpKind::MIFARE_CLASSIC)
+        {
+            // Mifare Classic blocks need a key first; anything else is not emulated
+            refuse(STATUS_NAK, m_ackMicros + HANDLING + 4 * RF_BYTE);
+            return;
+        }
+
+        uint8_t body[1 + READ_PAGES * 4];
+        body[0] = 0x00;
+        readPages(body + 1, m_command[3], READ_PAGES);
+        m_stats.rfBytes += READ_PAGES * 4;
+        answer(body, sizeof(body), m_ackMicros + HANDLING + (4 + READ_PAGES * 4) * RF_BYTE);
+    }
+
+    void PN532Emulator::communicate()
+    {
+        // Card command, first page, last page
+        if (!cardInField())
+        {
+            refuse(STATUS_TIMEOUT, m_ackMicros + RF_TIMEOUT);
+            return;
+        }
+
+        uint16_t first = m_command[2];
+        uint16_t last = m_command[3];
+        bool fits = m_commandLength >= 4 && first <= last && last < pageCount() &&
+                    FRAME_HEADER + 1u + (last - first + 1u) * 4u + 2u <= RESPONSE_CAPACITY;
+        if (m_command[1] != NTAG_FAST_READ || m_card->kind != NFCDumpKind::NTAG || !fits)
+        {
+            // A NAK leaves the tag idle until it is selected again
+            m_halted = true;
+            refuse(STATUS_NAK, m_ackMicros + HANDLING + 4 * RF_BYTE);
+            return;
+        }
+
+        uint16_t pages = last - first + 1;
+        uint8_t body[RESPONSE_CAPACITY];
+        body[0] = 0x00;
+        readPages(body + 1, first, pages);
+        m_stats.rfBytes += pages * 4u;
+        answer(body, 1u + pages * 4u, m_ackMicros + HANDLING + (4u + pages * 4u) * RF_BYTE);
+    }
+
+    void PN532Emulator::answer(const uint8_t* body, size_t length, uint32_t due)
+    {
+        // 00 00 FF LEN LCS D5 code body DCS 00
+        uint8_t frameLength = static_cast<uint8_t>(length + 2);
+        uint8_t code = static_cast<uint8_t>(m_command[0] + 1);
+        uint8_t* out = m_response;
+        out[0] = 0x00;
+        out[1] = 0x00;
+        out[2] = 0xFF;
+        out[3] = frameLength;
+        out[4] = static_cast<uint8_t>(-frameLength);
+        out[5] = PN532Frame::PN532_TO_HOST;
+        out[6] = code;
+        uint8_t sum = static_cast<uint8_t>(PN532Frame::PN532_TO_HOST + code);
+        for (size_t i = 0; i < length; i++)
+        {
+            out[FRAME_HEADER + i] = body[i];
+            sum = static_cast<uint8_t>(sum + body[i]);
+        }
+        out[FRAME_HEADER + length] = static_cast<uint8_t>(-sum);
+        out[FRAME_HEADER + length + 1] = 0x00;
+        m_responseLength = static_cast<uint8_t>(FRAME_HEADER + length + 2);
+        m_responseMicros = due;
+        m_answered = true;
+    }
+
+    void PN532Emulator::refuse(uint8_t status, uint32_t due)
+    {
+        m_stats.refused++;
+        answer(&status, 1, due);
+    }
+
+    void PN532Emulator::readPages(uint8_t* out, uint16_t first, uint16_t count) const
+    {
+        // READ rolls over past the last page, as the tags do
+        uint16_t pages = pageCount();
+        if (pages == 0)
+        {
+            memset(out, 0, count * 4u);
+            return;
+        }
+        for (uint16_t i = 0; i < count; i++)
+        {
+            memcpy(out + i * 4, m_card->memory + ((first + i) % pages) * 4, 4);
+        }
+    }
+
+    uint32_t PN532Emulator::transportMicros(void* context)
+    {
+        return static_cast<PN532Emulator*>(context)->m_now;
+    }
+
+    bool PN532Emulator::transportWrite(void* context, const uint8_t* data, size_t length)
+    {
+        PN532Emulator& chip = *static_cast<PN532Emulator*>(context);
+        chip.m_now += (length + 1) * BUS_BYTE;
+        chip.m_stats.busBytes += length;
+
+        if (length == PN532Frame::ACK_LENGTH && memcmp(data, PN532Frame::ACK, length) == 0)
+        {
+            chip.m_stats.aborts++;
+            chip.m_pending = false;
+            return true;
+        }
+
+        // Only well-formed host frames are taken; the chip ignores the rest
+        size_t commandLength = length > 6 ? data[3] - 1u : 0;
+        if (commandLength == 0 || commandLength > COMMAND_CAPACITY || length < 6 + commandLength + 2 ||
+            data[5] != PN532Frame::HOST_TO_PN532)
+        {
+            return false;
+        }
+        memcpy(chip.m_command, data + 6, commandLength);
+        chip.m_commandLength = static_cast<uint8_t>(commandLength);
+        chip.m_pending = true;
+        chip.m_ackRead = false;
+        chip.m_answered = false;
+        chip.m_ackMicros = chip.m_now + ACK_DELAY;
+        chip.m_stats.commands++;
+        return true;
+    }
+
+    bool PN532Emulator::transportReady(void* context)
+    {
+        PN532Emulator& chip = *static_cast<PN532Emulator*>(context);
+        chip.m_now += READY_POLL;
+        if (!chip.m_pending)
+        {
+            return false;
+        }
+        if (!chip.m_ackRead)
+        {
+            return static_cast<int32_t>(chip.m_now - chip.m_ackMicros) >= 0;
+        }
+        return chip.resolve() && static_cast<int32_t>(chip.m_now - chip.m_responseMicros) >= 0;
+    }
+
+    bool PN532Emulator::transportRead(void* context, uint8_t* data, size_t length)
+    {
+        PN532Emulator& chip = *static_cast<PN532Emulator*>(context);
+        chip.m_now += (length + 1) * BUS_BYTE;
+        chip.m_stats.busBytes += length + 1;
+        if (!chip.m_pending || length + 1 > RESPONSE_CAPACITY)
+        {
+            return false;
+        }
+
+        memset(data, 0, length);
+        if (!chip.m_ackRead)
+        {
+            // The ACK is read first; the answer is worked out from when it was
+            memcpy(data, PN532Frame::ACK, length < PN532Frame::ACK_LENGTH ? length : PN532Frame::ACK_LENGTH);
+            chip.m_ackRead = true;
+            chip.m_ackMicros = chip.m_now;
+            return true;
+        }
+        memcpy(data, chip.m_response, length < chip.m_responseLength ? length : chip.m_responseLength);
+        chip.m_pending = false;
+        return true;
+    }
+}
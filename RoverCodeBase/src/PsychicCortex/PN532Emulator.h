@@ -0,0 +1,109 @@
+/**
+ * @brief PN532Emulator stands in for a PN532 and a card, answering from an NFCDump
+ *
+ * It is reached through the same PN532Transport as the real chip, so
+ * NFCEngine and everything downstream of it run unchanged against a dump:
+ * - Commands are ACKed and answered as the chip frames them, and an ACK
+ *   from the host aborts the one outstanding
+ * - Detection answers once a card has been in the field long enough to
+ *   activate, and never while the field is empty
+ * - NTAG pages answer READ and FAST_READ; Ultralight NAKs FAST_READ and
+ *   drops to idle; Mifare Classic refuses every unauthenticated read
+ * - The emulator keeps its own clock, moved on by every bus transfer and
+ *   RF exchange at rates close to the chip's, and by advance() for the rest
+ *   of a loop, so a replay takes the same time on host as on the rover
+ */
+
+#ifndef PN532_EMULATOR_H
+#define PN532_EMULATOR_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include "PN532Frame.h"
+#include "NFCDump.h"
+
+namespace PsychicCortex
+{
+    struct PN532EmulatorStats
+    {
+        uint32_t commands;
+        uint32_t aborts;
+        uint32_t refused;           // NAKs, authentication errors and RF timeouts
+        uint32_t rfBytes;           // Card memory sent over the air
+        uint32_t busBytes;          // Both ways over I2C
+    };
+
+    class PN532Emulator
+    {
+    public:
+        // Microseconds
+        static constexpr uint32_t BUS_BYTE = 23;            // 400 kHz I2C
+        static constexpr uint32_t ACK_DELAY = 800;
+        static constexpr uint32_t HANDLING = 1000;          // Chip firmware per command
+        static constexpr uint32_t RF_BYTE = 90;             // 106 kbps
+        static constexpr uint32_t ACTIVATION = 4000;        // Field to a selected card
+        static constexpr uint32_t RF_TIMEOUT = 5000;        // Before the chip gives up on the card
+        static constexpr uint32_t READY_POLL = 2;           // One look at the IRQ line
+
+        PN532Emulator();
+
+        /**
+         * @brief Hooks for NFCEngine, bound to this emulator
+         */
+        PN532Transport transport();
+
+        /**
+         * @brief Put a card in the field now, or take it away with nullptr
+         *
+         * The dump is not copied and must outlive its time in the field.
+         */
+        void place(const NFCDump* dump);
+
+        /**
+         * @brief Let time pass outside the transport, as the rest of a loop would
+         */
+        void advance(uint32_t micros) { m_now += micros; }
+        uint32_t micros() const { return m_now; }
+        const PN532EmulatorStats& stats() const { return m_stats; }
+
+    private:
+        static constexpr uint8_t COMMAND_CAPACITY = 16;
+        static constexpr uint8_t RESPONSE_CAPACITY = 128;
+
+        const NFCDump* m_card;
+        uint32_t m_placedMicros;
+        bool m_halted;              // Dropped to idle by a NAK until selected again
+        uint8_t m_command[COMMAND_CAPACITY];
+        uint8_t m_commandLength;
+        bool m_pending;             // A command is ACKed or answered but not yet read
+        bool m_ackRead;
+        bool m_answered;
+        uint32_t m_ackMicros;
+        uint32_t m_responseMicros;
+        uint8_t m_response[RESPONSE_CAPACITY];
+        uint8_t m_responseLength;
+        uint32_t m_now;
+        PN532EmulatorStats m_stats;
+
+        /**
+         * @brief Work out the answer to the outstanding command once it is due
+         * @return true if there is one
+         */
+        bool resolve();
+        void detect();
+        void exchange();
+        void communicate();
+        void answer(const uint8_t* body, size_t length, uint32_t due);
+        void refuse(uint8_t status, uint32_t due);
+        void readPages(uint8_t* out, uint16_t first, uint16_t count) const;
+        uint16_t pageCount() const { return m_card->length / 4; }
+        bool cardInField() const { return m_card != nullptr && !m_halted; }
+
+        static uint32_t transportMicros(void* context);
+        static bool transportWrite(void* context, const uint8_t* data, size_t length);
+        static bool transportReady(void* context);
+        static bool transportRead(void* context, uint8_t* data, size_t length);
+    };
+}
+
+#endif // PN532_EMULATOR_H
@@ -0,0 +1,86 @@
+/**
+ * @file PN532Frame.cpp
+ * @brief PN532 normal information frames and the ACK frame
+ */
+
+#include "PN532Frame.h"
+#include <string.h>
+
+namespace PsychicCortex
+{
+    const uint8_t PN532Frame::ACK[PN532Frame::ACK_LENGTH] = { 0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00 };
+
+    size_t PN532Frame::build(uint8_t* out, size_t capacity, const uint8_t* command, size_t length)
+    {
+        // LEN counts the frame identifier as well and is a single byte
+        if (length == 0 || length > 254 || length + OVERHEAD > capacity)
+        {
+            return 0;
+        }
+
+        uint8_t frameLength = static_cast<uint8_t>(length + 1);
+        out[0] = 0x00;
+        out[1] = 0x00;
+        out[2] = 0xFF;
+        out[3] = frameLength;
+        out[4] = static_cast<uint8_t>(~frameLength + 1);
+        out[5] = HOST_TO_PN532;
+        memcpy(out + 6, command, length);
+
+        uint8_t sum = HOST_TO_PN532;
+        for (size_t i = 0; i < length; i++)
+        {
+            sum += command[i];
+        }
+        out[6 + length] = static_cast<uint8_t>(~sum + 1);
+        out[7 + length] = 0x00;
+        return length + OVERHEAD;
+    }
+
+    bool PN532Frame::isAck(const uint8_t* data, size_t length)
+    {
+        return length >= ACK_LENGTH && memcmp(data, ACK, ACK_LENGTH) == 0;
+    }
+
+    int32_t PN532Frame::parse(const uint8_t* data, size_t length, uint8_t command, const uint8_t** payload)
+    {
+        // The preamble may be longer than one byte
+        size_t start = 0;
+        while (start + 1 < length && !(data[start] == 0x00 && data[start + 1] == 0xFF))
+        {
+            start++;
+        }
+        if (start + 5 > length)
+        {
+            return -1;
+        }
+
+        uint8_t frameLength = data[start + 2];
+        if (static_cast<uint8_t>(frameLength + data[start + 3]) != 0 || frameLength < 2)
+        {
+            return -1;
+        }
+        const uint8_t* body = data + start + 4;
+        if (start + 4 + frameLength + 1 > length)
+        {
+            return -1;
+        }
+        if (body[0] != PN532_TO_HOST || body[1] != static_cast<uint8_t>(command + 1))
+        {
+            return -1;
+        }
+
+        uint8_t sum = 0;
+        for (size_t i = 0; i <= frameLength; i++)
+        {
+            sum += body[i];
+        }
+        if (sum != 0)
+        {
+            return -1;
+        }
+
+        *payload = body + 2;
+        return frameLength - 2;
+    }
+}
@@ -0,0 +1,73 @@
+/**
+ * @brief PN532Frame builds and checks PN532 host-interface frames
+ *
+ * Every command and response travels as a normal information frame:
+ * preamble, start code, length and its checksum, the frame identifier
+ * (D4 to the chip, D5 back), the data, a data checksum and a postamble.
+ * The chip confirms each command with a fixed ACK frame before it answers,
+ * and the host sends the same ACK to abort a command still running.
+ *
+ * Platform-free: the bus is a set of hooks, so the frames can be driven over
+ * I2C on the rover or against a scripted stand-in on host.
+ */
+
+#ifndef PN532_FRAME_H
+#define PN532_FRAME_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+namespace PsychicCortex
+{
+    /**
+     * @brief Link to a PN532; none of the hooks may wait for the chip
+     */
+    struct PN532Transport
+    {
+        uint32_t (*micros)(void* context);
+        bool (*write)(void* context, const uint8_t* data, size_t length);
+
+        /**
+         * @brief A frame is waiting: IRQ line low, or a status read says so
+         */
+        bool (*ready)(void* context);
+
+        /**
+         * @brief Read the waiting frame, padded past its end; only after ready()
+         */
+        bool (*read)(void* context, uint8_t* data, size_t length);
+        void* context;
+    };
+
+    class PN532Frame
+    {
+    public:
+        static constexpr uint8_t HOST_TO_PN532 = 0xD4;
+        static constexpr uint8_t PN532_TO_HOST = 0xD5;
+        static constexpr size_t OVERHEAD = 8;       // Around the command byte and its parameters
+        static constexpr size_t ACK_LENGTH = 6;
+        static const uint8_t ACK[ACK_LENGTH];
+
+        // Commands
+        static constexpr uint8_t RF_CONFIGURATION = 0x32;
+        static constexpr uint8_t IN_DATA_EXCHANGE = 0x40;
+        static constexpr uint8_t IN_COMMUNICATE_THRU = 0x42;
+        static constexpr uint8_t IN_LIST_PASSIVE_TARGET = 0x4A;
+
+        /**
+         * @brief Frame command (command byte first) into out
+         * @return Frame length, or 0 if it does not fit
+         */
+        static size_t build(uint8_t* out, size_t capacity, const uint8_t* command, size_t length);
+
+        static bool isAck(const uint8_t* data, size_t length);
+
+        /**
+         * @brief Check a response frame to command and find what follows its response code
+         * @return Payload length, or -1 if the frame is malformed, an error frame or for another command
+         */
+        static int32_t parse(const uint8_t* data, size_t length, uint8_t command, const uint8_t** payload);
+    };
+}
+
+#endif // PN532_FRAME_H
@@ -51,6 +51,7 @@ namespace SomatosensoryCortex
         MenuItem("Off", []() 
         {
             LEDManager::setMode(PC::VisualTypes::VisualMode::OFF_MODE);
+            LEDManager::saveSelection();
             Utilities::LOG_DEBUG("LED Mode set to Off");
         }),
         MenuItem("Encodings", []() 
@@ -66,6 +67,7 @@ namespace SomatosensoryCortex
         MenuItem("Rover Emotions", []() 
         {
             LEDManager::setMode(PC::VisualTypes::VisualMode::ROVER_EMOTION_MODE);
+            LEDManager::saveSelection();
             Utilities::LOG_DEBUG("LED Mode set to Rover Emotions");
         }),
         MenuItem("Back", []() 
@@ -80,22 +82,26 @@ namespace SomatosensoryCortex
         MenuItem("Full Mode", []() 
         {
             LEDManager::setEncodingMode(VC::EncodingModes::FULL_MODE);
+            LEDManager::saveSelection();
             Utilities::LOG_DEBUG("Encoding Mode set to Full Mode");
         }),
         MenuItem("Week Mode", []() 
         {
             LEDManager::setEncodingMode(VC::EncodingModes::WEEK_MODE);
+            LEDManager::saveSelection();
             Utilities::LOG_DEBUG("Encoding Mode set to Week Mode");
         }),
         MenuItem("Timer Mode", []() 
         {
             LEDManager::setEncodingMode(VC::EncodingModes::TIMER_MODE);
+            LEDManager::saveSelection();
             Utilities::LOG_DEBUG("Encoding Mode set to Timer Mode");
         }),
         MenuItem("Custom Mode", []() 
         {
             LEDManager::setMode(PC::VisualTypes::VisualMode::ENCODING_MODE);
             LEDManager::setEncodingMode(VC::EncodingModes::CUSTOM_MODE);
+            LEDManager::saveSelection();
             Utilities::LOG_DEBUG("Encoding Mode set to Custom Mode");
         }),
         MenuItem("Back", []() 
@@ -110,81 +116,97 @@ namespace SomatosensoryCortex
         MenuItem("New Year", []() 
         {
             LEDManager::setFestiveTheme(VC::FestiveTheme::NEW_YEAR);
+            LEDManager::saveSelection();
             Utilities::LOG_DEBUG("Festive Theme set to New Year");
         }),
         MenuItem("Valentines", []() 
         {
             LEDManager::setFestiveTheme(VC::FestiveTheme::VALENTINES);
+            LEDManager::saveSelection();
             Utilities::LOG_DEBUG("Festive Theme set to Valentines");
         }),
         MenuItem("St. Patrick", []() 
         {
             LEDManager::setFestiveTheme(VC::FestiveTheme::ST_PATRICK);
+            LEDManager::saveSelection();
             Utilities::LOG_DEBUG("Festive Theme set to St. Patrick");
         }),
         MenuItem("Easter", []() 
         {
             LEDManager::setFestiveTheme(VC::FestiveTheme::EASTER);
+            LEDManager::saveSelection();
             Utilities::LOG_DEBUG("Festive Theme set to Easter");
         }),
         MenuItem("Canada Day", []() 
         {
             LEDManager::setFestiveTheme(VC::FestiveTheme::CANADA_DAY);
+            LEDManager::saveSelection();
             Utilities::LOG_DEBUG("Festive Theme set to Canada Day");
         }),
         MenuItem("Halloween", []() 
         {
             LEDManager::setFestiveTheme(VC::FestiveTheme::HALLOWEEN);
+            LEDManager::saveSelection();
             Utilities::LOG_DEBUG("Festive Theme set to Halloween");
         }),
         MenuItem("Christmas", []() 
         {
             LEDManager::setFestiveTheme(VC::FestiveTheme::CHRISTMAS);
+            LEDManager::saveSelection();
             Utilities::LOG_DEBUG("Festive Theme set to Christmas");
         }),
         MenuItem("Thanksgiving", []() 
         {
             LEDManager::setFestiveTheme(VC::FestiveTheme::THANKSGIVING);
+            LEDManager::saveSelection();
             Utilities::LOG_DEBUG("Festive Theme set to Thanksgiving");
         }),
         MenuItem("Independence Day", []() 
         {
             LEDManager::setFestiveTheme(VC::FestiveTheme::INDEPENDENCE_DAY);
+            LEDManager::saveSelection();
             Utilities::LOG_DEBUG("Festive Theme set to Independence Day");
         }),
         MenuItem("Diwali", []() 
         {
             LEDManager::setFestiveTheme(VC::FestiveTheme::DIWALI);
+            LEDManager::saveSelection();
             Utilities::LOG_DEBUG("Festive Theme set to Diwali");
         }),
         MenuItem("Ramadan", []() 
         {
             LEDManager::setFestiveTheme(VC::FestiveTheme::RAMADAN);
+            LEDManager::saveSelection();
             Utilities::LOG_DEBUG("Festive Theme set to Ramadan");
         }),
         MenuItem("Chinese New Year", []() 
         {
             LEDManager::setFestiveTheme(VC::FestiveTheme::CHINESE_NEW_YEAR);
+            LEDManager::saveSelection();
             Utilities::LOG_DEBUG("Festive Theme set to Chinese New Year");
         }),
         MenuItem("Mardi Gras", []() 
         {
             LEDManager::setFestiveTheme(VC::FestiveTheme::MARDI_GRAS);
+            LEDManager::saveSelection();
             Utilities::LOG_DEBUG("Festive Theme set to Mardi Gras");
         }),
         MenuItem("Labor Day", []() 
         {
             LEDManager::setFestiveTheme(VC::FestiveTheme::LABOR_DAY);
+            LEDManager::saveSelection();
             Utilities::LOG_DEBUG("Festive Theme set to Labor Day");
         }),
         MenuItem("Memorial Day", []() 
         {
             LEDManager::setFestiveTheme(VC::FestiveTheme::MEMORIAL_DAY);
+            LEDManager::saveSelection();
             Utilities::LOG_DEBUG("Festive Theme set to Memorial Day");
         }),
         MenuItem("Flag Day", []() 
         {
             LEDManager::setFestiveTheme(VC::FestiveTheme::FLAG_DAY);
+            LEDManager::saveSelection();
             Utilities::LOG_DEBUG("Festive Theme set to Flag Day");
         }),
         MenuItem("Back", []() {
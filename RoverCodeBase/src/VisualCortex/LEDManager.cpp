@@ -26,6 +26,7 @@
 #include "../SomatosensoryCortex/MenuManager.h"
 #include "../VisualCortex/RoverViewManager.h"  
 #include "../VisualCortex/FastLEDConfig.h"
+#include "../PrefrontalCortex/SDManager.h"
 
 namespace VisualCortex 
 {
@@ -80,6 +81,8 @@ namespace VisualCortex
     VisualMode LEDManager::currentMode = VisualMode::ENCODING_MODE;
     VisualMode LEDManager::previousMode = VisualMode::ENCODING_MODE;
     FestiveTheme LEDManager::currentTheme = FestiveTheme::NONE;
+    FestiveTheme LEDManager::overriddenTheme = FestiveTheme::NONE;
+    bool LEDManager::festiveOverride = false;
     EncodingModes LEDManager::currentEncodingMode = EncodingModes::FULL_MODE;
 
     // Animation state tracking
@@ -101,6 +104,9 @@ namespace VisualCortex
     // Timing and state flags
     unsigned long LEDManager::lastStepTime = 0;
     unsigned long LEDManager::lastUpdate = 0;
+    LEDManager::ScheduledFrame LEDManager::frameQueue[LEDManager::FRAME_QUEUE_SIZE];
+    uint8_t LEDManager::frameHead = 0;
+    uint8_t LEDManager::frameCount = 0;
     bool LEDManager::isLoading = false;
     bool LEDManager::fadeDirection = true;
     bool LEDManager::tickTock = false;
@@ -190,6 +196,21 @@ namespace VisualCortex
         isLoading = false;
         currentMode = VisualMode::ENCODING_MODE;
         currentEncodingMode = EncodingModes::FULL_MODE;
+
+        // Come back in the mode, encoding and theme the user last picked
+        festiveOverride = false;
+        uint32_t savedMode = PC::SDManager::getSetting(PC::SDManager::SETTING_LED_MODE, static_cast<uint32_t>(currentMode));
+        if (savedMode < static_cast<uint32_t>(VisualConstants::LED_NUM_MODES)) {
+            currentMode = static_cast<VisualMode>(savedMode);
+        }
+        uint32_t savedTheme = PC::SDManager::getSetting(PC::SDManager::SETTING_FESTIVE_THEME, static_cast<uint32_t>(currentTheme));
+        if (savedTheme <= static_cast<uint32_t>(FestiveTheme::CHINESE_NEW_YEAR)) {
+            currentTheme = static_cast<FestiveTheme>(savedTheme);
+        }
+        uint32_t savedEncoding = PC::SDManager::getSetting(PC::SDManager::SETTING_ENCODING_MODE, static_cast<uint32_t>(currentEncodingMode));
+        if (savedEncoding <= static_cast<uint32_t>(EncodingModes::CUSTOM_MODE)) {
+            currentEncodingMode = static_cast<EncodingModes>(savedEncoding);
+        }
         // Initialize FULL_MODE pattern
         for (int i = 0; i < MC::PinDefinitions::VisualPathways::WS2812_NUM_LEDS; i++) {
             leds[i] = CRGB::Blue;  // Start with blue
@@ -555,6 +576,50 @@ namespace VisualCortex
         FastLED.show();
     }
 
+    bool LEDManager::scheduleFrame(uint64_t presentAtMicros, uint32_t ledMask, CRGB color) 
+    {
+        if (frameCount == FRAME_QUEUE_SIZE) 
+        {
+            // Late rather than lost: show the oldest frame now to make room
+            presentFrame(frameQueue[frameHead]);
+            frameHead = (frameHead + 1) % FRAME_QUEUE_SIZE;
+            frameCount--;
+            showLEDs();
+        }
+
+        ScheduledFrame& frame = frameQueue[(frameHead + frameCount) % FRAME_QUEUE_SIZE];
+        frame.presentAtMicros = presentAtMicros;
+        frame.ledMask = ledMask;
+        frame.color = color;
+        frameCount++;
+        return true;
+    }
+
+    void LEDManager::presentScheduledFrames() 
+    {
+        if (frameCount == 0) return;
+
+        // Present against the audio timeline, not the loop, so a stall delays both equally
+        uint64_t now = SoundFxManager::mediaMicros();
+        bool presented = false;
+        while (frameCount > 0 && frameQueue[frameHead].presentAtMicros <= now) 
+        {
+            presentFrame(frameQueue[frameHead]);
+            frameHead = (frameHead + 1) % FRAME_QUEUE_SIZE;
+            frameCount--;
+            presented = true;
+        }
+        if (presented) showLEDs();
+    }
+
+    void LEDManager::presentFrame(const ScheduledFrame& frame) 
+    {
+        for (int i = 0; i < MC::PinDefinitions::VisualPathways::WS2812_NUM_LEDS; i++) 
+        {
+            if (frame.ledMask & (1UL << i)) leds[i] = frame.color;
+        }
+    }
+
     void LEDManager::scaleLED(int index, uint8_t scale) 
     {
         Utilities::LOG_SCOPE("VisualCortex::LEDManager::scaleLED(int, uint8_t)", 
@@ -708,6 +773,8 @@ namespace VisualCortex
                 LEDManager::updateRoverEmotionMode();
                 break;
         }
+
+        presentScheduledFrames();
     }
 
     void LEDManager::updateMenuMode() {
@@ -940,6 +1007,19 @@ namespace VisualCortex
         LEDManager::updateLEDs();
     }
 
+    void LEDManager::saveSelection()
+    {
+        Utilities::LOG_SCOPE("VisualCortex::LEDManager::saveSelection()");
+        // A menu pick replaces any holiday theme the date check put up
+        festiveOverride = false;
+        PC::SDManager::putSetting(PC::SDManager::SETTING_LED_MODE, static_cast<uint32_t>(currentMode));
+        PC::SDManager::putSetting(PC::SDManager::SETTING_FESTIVE_THEME, static_cast<uint32_t>(currentTheme));
+        // MENU_MODE only lasts while the menu is open, so the last real pick stands
+        if (currentEncodingMode != EncodingModes::MENU_MODE) {
+            PC::SDManager::putSetting(PC::SDManager::SETTING_ENCODING_MODE, static_cast<uint32_t>(currentEncodingMode));
+        }
+    }
+
     void LEDManager::updateIRBlastPattern() {
         Utilities::LOG_SCOPE("VisualCortex::LEDManager::updateIRBlastPattern()");
         static uint8_t currentLEDPosition = 0;
@@ -1232,13 +1312,25 @@ namespace VisualCortex
         // Check for festive days
         for (const auto& festiveDay : festiveDays) {
             if (festiveDay.month == month && festiveDay.day == day) {
-                setFestiveTheme(festiveDay.theme);
+                // Only the default encoding display gives way to a holiday, and only for the day
+                if (!festiveOverride && currentMode == VisualMode::ENCODING_MODE) {
+                    festiveOverride = true;
+                    overriddenTheme = currentTheme;
+                    currentMode = VisualMode::FESTIVE_MODE;
+                }
+                if (festiveOverride) {
+                    currentTheme = festiveDay.theme;
+                }
                 return; // Exit after setting the festive theme
             }
         }
 
-        // Reset to default mode if no festive day
-        setMode(VisualMode::ENCODING_MODE);
+        // Hand the display back once the day is over; a mode the user picked is left alone
+        if (festiveOverride) {
+            festiveOverride = false;
+            currentMode = VisualMode::ENCODING_MODE;
+            currentTheme = overriddenTheme;
+        }
     }
 
     void LEDManager::setEncodingMode(EncodingModes mode) {
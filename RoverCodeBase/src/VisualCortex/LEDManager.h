@@ -31,7 +31,7 @@ namespace VisualCortex
     // Visual perception constants
     namespace VisualConstants
     {
-        constexpr int LED_NUM_MODES = 5;
+        constexpr int LED_NUM_MODES = static_cast<int>(VisualMode::ROVER_EMOTION_MODE) + 1;
         constexpr int NUM_RAINBOW_COLORS = 7;
         constexpr int STEP_DELAY = 100;
         constexpr int MONTH_DIM = 128;
@@ -68,6 +68,14 @@ namespace VisualCortex
         static void update();
         static void showLEDs();
 
+        /**
+         * @brief Light ledMask in color when media time reaches presentAtMicros
+         * Used for note lights so they appear with the note's first sample
+         */
+        static bool scheduleFrame(uint64_t presentAtMicros, uint32_t ledMask, CRGB color);
+        static void presentScheduledFrames();
+        static void clearScheduledFrames() { frameCount = 0; }
+
         // Mode management
         static void setMode(VisualMode mode);
         static void nextMode();
@@ -111,6 +119,11 @@ namespace VisualCortex
         // State management
         static void handleMessage(VisualMessage message);
         static void setFestiveTheme(FestiveTheme theme);
+        /**
+         * @brief Persist the current mode and theme as the user's choice
+         * Only menu selections call this; date-driven changes stay in RAM
+         */
+        static void saveSelection();
         static void checkAndSetFestiveMode();
         static void setEncodingMode(EncodingModes mode);
 
@@ -137,6 +150,8 @@ namespace VisualCortex
 
         // Mode tracking
         static VisualMode previousMode;
+        static bool festiveOverride;            // Holiday theme shown in place of ENCODING_MODE
+        static FestiveTheme overriddenTheme;
         static CRGB winningColor;
         static CRGB targetColor;
         static bool transitioningColor;
@@ -159,6 +174,19 @@ namespace VisualCortex
         static unsigned long lastStepTime;
         static unsigned long lastUpdate;
 
+        // Media-clock scheduled frames, in presentation order
+        struct ScheduledFrame
+        {
+            uint64_t presentAtMicros;
+            uint32_t ledMask;
+            CRGB color;
+        };
+        static constexpr uint8_t FRAME_QUEUE_SIZE = 8;
+        static ScheduledFrame frameQueue[FRAME_QUEUE_SIZE];
+        static uint8_t frameHead;
+        static uint8_t frameCount;
+        static void presentFrame(const ScheduledFrame& frame);
+
         // Mode update methods
         static void updateFullMode();
         static void updateWeekMode();
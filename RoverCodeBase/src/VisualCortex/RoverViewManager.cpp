@@ -78,6 +78,7 @@ namespace VisualCortex
     uint32_t RoverViewManager::errorCode = 0;
     const char* RoverViewManager::genericErrorMessage = nullptr;
     const char* RoverViewManager::detailedErrorMessage = nullptr;
+    RoverViewManager::StatsText RoverViewManager::statsText = {ULONG_MAX, UINT32_MAX, "", "", "", ""};
     bool RoverViewManager::isError = false;
     bool RoverViewManager::isFatalError = false;
     unsigned long RoverViewManager::warningStartTime = 0;
@@ -159,7 +160,7 @@ namespace VisualCortex
             drawFrame();
             
             // Push initial frame to display
-            spr.pushSprite(0, 0);
+            pushSprite();
             
             initialized = true;
             
@@ -213,7 +214,7 @@ namespace VisualCortex
                 spr.setTextFont(2);
                 spr.setTextColor(TFT_WHITE, TFT_BLACK);
                 spr.drawString("Display Error", DisplayConfig::SCREEN_CENTER_X, DisplayConfig::SCREEN_HEIGHT/2);
-                spr.pushSprite(0, 0);
+                pushSprite();
                 delay(1000);
                 isRecovering = false;
                 return;
@@ -259,7 +260,7 @@ namespace VisualCortex
                     break;
             }
             
-            spr.pushSprite(0, 0);
+            pushSprite();
             
         } catch (const std::exception& e) {
             Utilities::LOG_ERROR("Error in drawCurrentView: %s", e.what());
@@ -314,7 +315,7 @@ namespace VisualCortex
         boneSpr.deleteSprite();
         
         // Push main sprite to display
-        spr.pushSprite(0, 0);
+        pushSprite();
     }
 
     void RoverViewManager::drawFrame() {
@@ -390,14 +391,29 @@ namespace VisualCortex
         spr.drawString("System Stats", DisplayConfig::SCREEN_CENTER_X - DisplayConfig::FRAME_OFFSET_X, FRAME_Y + TITLE_Y_OFFSET + 15);
         
         spr.setTextFont(2);
-        unsigned long uptime = millis(); // Get the uptime in milliseconds
-        String uptimeString = RoverViewManager::formatUptime(uptime);
-        
-        spr.drawString("Uptime: " + uptimeString, DisplayConfig::SCREEN_CENTER_X - DisplayConfig::FRAME_OFFSET_X, FRAME_Y + 15);
-        spr.drawString("SD Card Size: " + String(SDManager::getCardSize()) + "MB", DisplayConfig::SCREEN_CENTER_X - DisplayConfig::FRAME_OFFSET_X, FRAME_Y + 75);
-        spr.drawString("SD Card Used: " + String(SDManager::getUsedSpace()) + "MB", DisplayConfig::SCREEN_CENTER_X - DisplayConfig::FRAME_OFFSET_X, FRAME_Y + 95);
-        spr.drawString("SD Card Total: " + String(SDManager::getTotalSpace()) + "MB", DisplayConfig::SCREEN_CENTER_X - DisplayConfig::FRAME_OFFSET_X, FRAME_Y + 115);
-        spr.drawString("WiFi: " + String(WiFiManager::isConnected() ? "Connected" : "Disconnected"), DisplayConfig::SCREEN_CENTER_X - DisplayConfig::FRAME_OFFSET_X, FRAME_Y + 135);
+
+        // Runs every frame: format only what changed, and never touch the card
+        unsigned long uptimeSeconds = millis() / 1000;
+        if (uptimeSeconds != statsText.uptimeSeconds) {
+            statsText.uptimeSeconds = uptimeSeconds;
+            snprintf(statsText.uptime, sizeof(statsText.uptime), "Uptime: %luh %lum %lus",
+                uptimeSeconds / 3600, uptimeSeconds / 60 % 60, uptimeSeconds % 60);
+        }
+
+        PC::StorageUsageSnapshot usage = SDManager::getUsage();
+        if (usage.revision != statsText.usageRevision) {
+            statsText.usageRevision = usage.revision;
+            snprintf(statsText.cardSize, sizeof(statsText.cardSize), "SD Card Size: %uMB", usage.cardKB / 1024);
+            snprintf(statsText.cardUsed, sizeof(statsText.cardUsed), "SD Card Used: %uMB", usage.usedKB / 1024);
+            snprintf(statsText.cardTotal, sizeof(statsText.cardTotal), "SD Card Total: %uMB", usage.totalKB / 1024);
+        }
+
+        int x = DisplayConfig::SCREEN_CENTER_X - DisplayConfig::FRAME_OFFSET_X;
+        spr.drawString(statsText.uptime, x, FRAME_Y + 15);
+        spr.drawString(statsText.cardSize, x, FRAME_Y + 75);
+        spr.drawString(statsText.cardUsed, x, FRAME_Y + 95);
+        spr.drawString(statsText.cardTotal, x, FRAME_Y + 115);
+        spr.drawString(WiFiManager::isConnected() ? "WiFi: Connected" : "WiFi: Disconnected", x, FRAME_Y + 135);
     }
 
     String RoverViewManager::formatUptime(unsigned long uptimeMillis) {
@@ -726,12 +742,20 @@ namespace VisualCortex
             showNotification("LEVEL UP", levelStr, "XP", 2000);
         }
         
+        SDManager::putSetting(SDManager::SETTING_EXPERIENCE, experience);
+        SDManager::putSetting(SDManager::SETTING_LEVEL, level);
+
         // Update experience display
         char expStr[32];
         snprintf(expStr, sizeof(expStr), "XP: %d/327", experience);
         updateExperienceBar(expStr);
     }
 
+    void RoverViewManager::restoreProgress() {
+        experience = SDManager::getSetting(SDManager::SETTING_EXPERIENCE, experience);
+        level = static_cast<uint8_t>(SDManager::getSetting(SDManager::SETTING_LEVEL, level));
+    }
+
     uint16_t RoverViewManager::calculateNextLevelExperience(uint8_t currentLevel) {
         Utilities::LOG_SCOPE("VisualCortex::RoverViewManager::calculateNextLevelExperience(uint8_t)");
         // Simple exponential growth formula
@@ -921,7 +945,7 @@ namespace VisualCortex
             y += 25;
         }
         
-        spr.pushSprite(0, 0);
+        pushSprite();
     }
 
     void RoverViewManager::drawAppSplash(const char* title, const char* description) {
@@ -1075,7 +1099,7 @@ namespace VisualCortex
             spr.drawCentreString("Press Rotary to REBOOT", DisplayConfig::SCREEN_CENTER_X - 40 + X_OFFSET, 225 + Y_OFFSET, 1);
         }
         
-        spr.pushSprite(0, 0);
+        pushSprite();
         LEDManager::setErrorPattern(errorCode, isFatal);
     }
 
@@ -1112,13 +1136,36 @@ namespace VisualCortex
     {
         Utilities::LOG_SCOPE("VisualCortex::RoverViewManager::clearSprite()");
         spr.fillSprite(TFT_BLACK);
-        spr.pushSprite(0, 0);
+        pushSprite();
     }
 
     void RoverViewManager::pushSprite() 
     {
         Utilities::LOG_SCOPE("VisualCortex::RoverViewManager::pushSprite()");
-        spr.pushSprite(0, 0);
+
+        // Bulk priority: SD and radio transfers get the bus between bands of rows
+        PC::SPITransaction push = PC::SPIArbiter::makeTransaction(
+            static_cast<uint8_t>(PC::SPIDevice::TFT), PC::SPIPriority::BULK, DisplayConfig::SCREEN_HEIGHT);
+        push.chunk = PUSH_CHUNK_ROWS;
+        push.step = pushSpriteRows;
+
+        // Waits, as the next frame draws into the same sprite. Refused before the
+        // bus task runs, on it, or under this task's own lease: the bus is ours then
+        if (spr.getPointer() == nullptr || !PC::SPIManager::submitAndWait(push)) 
+        {
+            spr.pushSprite(0, 0);
+        }
+    }
+
+    bool RoverViewManager::pushSpriteRows(void* context, uint32_t offset, uint32_t rows) 
+    {
+        // As TFT_eSprite::pushSprite() does for 16-bit sprites: pixels are stored display-ready
+        const uint16_t* pixels = static_cast<const uint16_t*>(spr.getPointer());
+        bool swapBytes = tft.getSwapBytes();
+        tft.setSwapBytes(false);
+        tft.pushImage(0, offset, DisplayConfig::SCREEN_WIDTH, rows, pixels + offset * DisplayConfig::SCREEN_WIDTH);
+        tft.setSwapBytes(swapBytes);
+        return true;
     }
 
 }
\ No newline at end of file
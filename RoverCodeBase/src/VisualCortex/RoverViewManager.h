@@ -27,6 +27,7 @@
 #include "../VisualCortex/DisplayConfig.h"
 #include "../VisualCortex/VisualSynesthesia.h"
 #include "../PrefrontalCortex/PowerManager.h"
+#include "../PrefrontalCortex/SPIManager.h"
 #include "../AuditoryCortex/SoundFxManager.h"
 #include <vector>
 #include "../SomatosensoryCortex/MenuManager.h"
@@ -66,6 +67,11 @@ namespace VisualCortex
         static ViewType getCurrentView() { return currentView; }
         static void drawLoadingScreen(const char* statusText);  
         static void incrementExperience(uint16_t amount);
+
+        /**
+         * @brief Reload experience and level from the settings store once the SD card is up
+         */
+        static void restoreProgress();
         static void drawAppSplash(const char* title, const char* description);
 
         static void setTextColor(uint16_t color);
@@ -150,6 +156,19 @@ namespace VisualCortex
         static const uint16_t FRAME_COLOR = 0xC618;
         static const uint16_t FRAME_BORDER_COLOR = TFT_DARKGREY;
 
+        /**
+         * @brief Stats view lines, reformatted only when the second or the usage revision changes
+         */
+        struct StatsText {
+            unsigned long uptimeSeconds;
+            uint32_t usageRevision;
+            char uptime[32];
+            char cardSize[32];
+            char cardUsed[32];
+            char cardTotal[32];
+        };
+        static StatsText statsText;
+
 
         
         // Drawing methods for different views
@@ -211,6 +230,12 @@ namespace VisualCortex
 
         static constexpr unsigned long WARNING_DURATION = 3000; // 3 seconds
         static unsigned long warningStartTime;
+
+        /**
+         * @brief Sprite pushes run on the SPI bus task a band of rows at a time
+         */
+        static const uint16_t PUSH_CHUNK_ROWS = 32;         // ~2 ms at 40 MHz; the longest an SD request waits
+        static bool pushSpriteRows(void* context, uint32_t offset, uint32_t rows);
     };
 }
 
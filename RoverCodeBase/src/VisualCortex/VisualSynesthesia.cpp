@@ -21,6 +21,7 @@
 #include "../VisualCortex/LEDManager.h"
 #include <FastLED.h>
 #include "../PrefrontalCortex/Utilities.h"
+#include "../PsychicCortex/NFCEngine.h"
 
 namespace VisualCortex 
 {
@@ -29,6 +30,33 @@ namespace VisualCortex
     using AC::PitchPerception;
     using namespace PC::ColorPerceptionTypes;
 
+    namespace
+    {
+        const uint32_t EVEN_LEDS = 0x55555555UL;    // Chromatic primary
+        const uint32_t ODD_LEDS = 0xAAAAAAAAUL;     // Chromatic secondary
+
+        /**
+         * @brief Queue a tone that lights two LEDs in its note colour as it starts sounding
+         */
+        void queueNoteLight(uint16_t frequency, uint16_t duration, uint16_t gap, uint8_t first, uint8_t second)
+        {
+            const uint8_t count = MC::PinDefinitions::VisualPathways::WS2812_NUM_LEDS;
+            AC::ToneLight light = { (1UL << (first % count)) | (1UL << (second % count)), VisualSynesthesia::getColorForFrequency(frequency) };
+            AC::SoundFxManager::queueLitTone(frequency, duration, gap, &light, 1);
+        }
+
+        /**
+         * @brief Queue a tone that shows context across the strip as it starts sounding
+         */
+        void queueChromaticLight(uint16_t frequency, uint16_t duration, uint16_t gap, const ChromaticContext& context)
+        {
+            AC::ToneLight lights[2] = { { EVEN_LEDS, context.primary }, { ODD_LEDS, context.secondary } };
+            lights[0].color.nscale8(context.intensity);
+            lights[1].color.nscale8(context.intensity);
+            AC::SoundFxManager::queueLitTone(frequency, duration, gap, lights, 2);
+        }
+    }
+
     CRGB VisualSynesthesia::getBase8Color(uint8_t cognitiveValue) 
     {
         PC::Utilities::LOG_SCOPE("VisualCortex::VisualSynesthesia::getBase8Color(uint8_t)", String(cognitiveValue));
@@ -128,25 +156,12 @@ namespace VisualCortex
         NoteInfo thirdInfo = AC::PitchPerception::getNoteInfo(thirdFreq);
         NoteInfo fifthInfo = AC::PitchPerception::getNoteInfo(fifthFreq);
 
-        // Play the chord sequence with visual feedback
-        AC::SoundFxManager::playTone(baseFreq, 200);
-        LEDManager::displayNote(baseFreq, 0);
-        LEDManager::displayNote(baseFreq, 1);
-        
-        AC::SoundFxManager::playTone(thirdFreq, 200);
-        LEDManager::displayNote(thirdFreq, 2);
-        LEDManager::displayNote(thirdFreq, 3);
-        
-        AC::SoundFxManager::playTone(fifthFreq, 200); 
-        LEDManager::displayNote(fifthFreq, 3);
-        LEDManager::displayNote(fifthFreq, 4);
-        
-        AC::SoundFxManager::playTone(thirdFreq, 200);
-        LEDManager::displayNote(thirdFreq, 5);
-        LEDManager::displayNote(thirdFreq, 6);
-        
-        AC::SoundFxManager::playTone(baseFreq, 200);
-        LEDManager::displayNote(baseFreq, 7);
+        // Play the chord sequence; each pair of LEDs lights as its note is heard
+        queueNoteLight(baseFreq, 200, 0, 0, 1);
+        queueNoteLight(thirdFreq, 200, 0, 2, 3);
+        queueNoteLight(fifthFreq, 200, 0, 3, 4);
+        queueNoteLight(thirdFreq, 200, 0, 5, 6);
+        queueNoteLight(baseFreq, 200, 0, 7, 7);
 
         // Get colors for the chord
         rootPerception = getColorForFrequency(AC::PitchPerception::getNoteFrequency(rootInfo));
@@ -160,14 +175,186 @@ namespace VisualCortex
         return ((neuralColor.r & 0xF8) << 8) | ((neuralColor.g & 0xFC) << 3) | (neuralColor.b >> 3);
     }
 
+    namespace 
+    {
+        const size_t MIME_NOTE_LIMIT = 32;      // Payloads can run to hundreds of bytes
+        const size_t CARD_SONG_CHUNK = 16;      // Notes composed at a time once the cached ones have played
+        const uint8_t CARD_NOTE_VOLUME = 42;
+
+        /**
+         * @brief Writes notes after the first skip, while there is room
+         */
+        struct NoteWriter 
+        {
+            PsychicCortex::CardNote* notes;
+            size_t capacity;
+            size_t skip;
+            size_t count;
+
+            bool full() const { return count >= capacity; }
+
+            void add(uint16_t frequency, uint16_t duration, uint16_t gap) {
+                if (skip > 0) {
+                    skip--;
+                } else if (count < capacity) {
+                    notes[count++] = { frequency, duration, gap };
+                }
+            }
+        };
+
+        /**
+         * @brief One note per printable byte of text while there is room
+         */
+        void appendCharacters(const uint8_t* text, size_t length, size_t stride, uint16_t duration, uint16_t gap,
+                              NoteWriter& writer) 
+        {
+            for (size_t i = 0; i < length && !writer.full(); i += stride) {
+                if (text[i] < 32 || text[i] > 126) continue;
+                writer.add(map(text[i], 32, 126, 200, 2000), duration, gap);
+            }
+        }
+
+        /**
+         * @brief The card song being fed to the tune lane
+         *
+         * Its first notes are played as given; after them, notes are composed
+         * from the card's own data a chunk at a time.
+         */
+        struct CardSong 
+        {
+            PsychicCortex::CardNote first[PsychicCortex::CardContent::MAX_NOTES];
+            size_t firstCount;
+            uint8_t data[PsychicCortex::NFCCard::DATA_CAPACITY];
+            size_t dataLength;
+            char text[PsychicCortex::NFCCard::TEXT_LENGTH];
+            bool hasCard;
+            PsychicCortex::CardNote chunk[CARD_SONG_CHUNK];
+            size_t chunkStart;
+            size_t chunkCount;
+            size_t position;
+        };
+
+        CardSong cardSong;
+
+        bool nextCardNote(void* context, AC::ToneEvent& event) {
+            CardSong& song = *static_cast<CardSong*>(context);
+            const PsychicCortex::CardNote* note;
+            if (song.position < song.firstCount) {
+                note = &song.first[song.position];
+            } else {
+                if (!song.hasCard) return false;
+                if (song.position >= song.chunkStart + song.chunkCount) {
+                    // Records as describeCard composes them, else the card's text
+                    bool found = false;
+                    song.chunkStart = song.position;
+                    song.chunkCount = VisualSynesthesia::composeNFCCardData(song.data, song.dataLength, song.chunk,
+                                                                            CARD_SONG_CHUNK, &found, song.position);
+                    if (!found) {
+                        song.chunkCount = VisualSynesthesia::composeNFCCardData(song.text, song.chunk, CARD_SONG_CHUNK, song.position);
+                    }
+                    if (song.chunkCount == 0) {
+                        song.hasCard = false;
+                        return false;
+                    }
+                }
+                note = &song.chunk[song.position - song.chunkStart];
+            }
+
+            song.position++;
+            event.frequency = note->frequency;
+            event.durationMs = note->duration;
+            event.advanceMs = note->duration + note->gap;
+            event.volume = CARD_NOTE_VOLUME;
+            event.cue = 0;
+            return true;
+        }
+    }
+
     void VisualSynesthesia::playNFCCardData(const char* cardData) {
         PC::Utilities::LOG_SCOPE("VisualCortex::VisualSynesthesia::playNFCCardData(const char*)", cardData);
-        for (int i = 0; i < strlen(cardData); i++) {
+        playCardNotes(nullptr, 0, nullptr, 0, cardData);
+    }
+
+    size_t VisualSynesthesia::composeNFCCardData(const char* cardData, PsychicCortex::CardNote* notes, size_t capacity,
+                                                 size_t skip) {
+        NoteWriter writer = { notes, capacity, skip, 0 };
+        for (size_t i = 0; cardData[i] != '\0' && !writer.full(); i++) {
             // Map each character to a frequency
             uint16_t frequency = map(cardData[i], 32, 126, 200, 2000); // Map printable ASCII to a frequency range
-            AC::SoundFxManager::playTone(frequency, 200); // Play each note for 200 ms
-            delay(250); // Delay between notes
+            writer.add(frequency, 200, 250); // 200 ms note, 250 ms gap
+        }
+        return writer.count;
+    }
+
+    bool VisualSynesthesia::playNFCCardData(const uint8_t* tagData, size_t length) {
+        bool played = false;
+        composeNFCCardData(tagData, length, nullptr, 0, &played);
+        playCardNotes(nullptr, 0, tagData, length, "");
+        return played;
+    }
+
+    size_t VisualSynesthesia::composeNFCCardData(const uint8_t* tagData, size_t length, PsychicCortex::CardNote* notes,
+                                                 size_t capacity, bool* found, size_t skip) {
+        PsychicCortex::NDEFParser parser(tagData, length);
+        PsychicCortex::NDEFRecord record;
+        PsychicCortex::NDEFText text;
+        PsychicCortex::NDEFUri uri;
+        PsychicCortex::NDEFMime mime;
+        NoteWriter writer = { notes, capacity, skip, 0 };
+        bool played = false;
+
+        while ((!writer.full() || !played) && parser.next(record)) {
+            if (PsychicCortex::NDEFParser::text(record, text)) {
+                // ASCII is the low byte of big-endian UTF-16
+                const uint8_t* bytes = reinterpret_cast<const uint8_t*>(text.text);
+                size_t offset = text.utf16 ? 1 : 0;
+                size_t stride = text.utf16 ? 2 : 1;
+                if (offset < text.textLength) {
+                    appendCharacters(bytes + offset, text.textLength - offset, stride, 200, 250, writer);
+                }
+                played = true;
+            } else if (PsychicCortex::NDEFParser::uri(record, uri)) {
+                // The prefix is boilerplate, so one low note stands in for it
+                writer.add(150, 300, 350);
+                appendCharacters(reinterpret_cast<const uint8_t*>(uri.rest), uri.restLength, 1, 120, 150, writer);
+                played = true;
+            } else if (PsychicCortex::NDEFParser::mime(record, mime)) {
+                size_t blips = mime.length < MIME_NOTE_LIMIT ? mime.length : MIME_NOTE_LIMIT;
+                for (size_t i = 0; i < blips && !writer.full(); i++) {
+                    writer.add(map(mime.data[i], 0, 255, 200, 2000), 80, 100);
+                }
+                played = true;
+            }
         }
+        if (found) *found = played;
+        return writer.count;
+    }
+
+    void VisualSynesthesia::playCardNotes(const PsychicCortex::CardNote* notes, size_t count,
+                                          const uint8_t* tagData, size_t length, const char* cardText) {
+        CardSong& song = cardSong;
+        if (count > PsychicCortex::CardContent::MAX_NOTES) count = PsychicCortex::CardContent::MAX_NOTES;
+        if (count > 0) memcpy(song.first, notes, count * sizeof(PsychicCortex::CardNote));
+        song.firstCount = count;
+        song.position = 0;
+        song.hasCard = false;
+        if (tagData || cardText) {
+            continueCardSong(tagData, length, cardText);
+        }
+        AC::SoundFxManager::playNoteSource(nextCardNote, &song);
+    }
+
+    void VisualSynesthesia::continueCardSong(const uint8_t* tagData, size_t length, const char* cardText) {
+        CardSong& song = cardSong;
+        if (!tagData) length = 0;
+        if (length > sizeof(song.data)) length = sizeof(song.data);
+        if (length > 0) memcpy(song.data, tagData, length);
+        song.dataLength = length;
+        strncpy(song.text, cardText ? cardText : "", sizeof(song.text) - 1);
+        song.text[sizeof(song.text) - 1] = '\0';
+        song.chunkStart = 0;
+        song.chunkCount = 0;
+        song.hasCard = true;
     }
 
     ChromaticContext VisualSynesthesia::getChromaticContext(uint16_t frequency) 
@@ -220,17 +407,9 @@ namespace VisualCortex
         thirdContext = getChromaticContext(thirdFreq);
         fifthContext = getChromaticContext(fifthFreq);
         
-        // Play the frequencies with visual feedbacka
-        LEDManager::displayChromatic(rootContext);
-        AC::SoundFxManager::playTone(fundamentalFreq, 200);
-        delay(250);
-        
-        LEDManager::displayChromatic(thirdContext);
-        AC::SoundFxManager::playTone(thirdFreq, 200);
-        delay(250);
-        
-        LEDManager::displayChromatic(fifthContext);
-        AC::SoundFxManager::playTone(fifthFreq, 200);
-        delay(250);
+        // Play the frequencies; the strip changes colour as each one is heard
+        queueChromaticLight(fundamentalFreq, 200, 250, rootContext);
+        queueChromaticLight(thirdFreq, 200, 250, thirdContext);
+        queueChromaticLight(fifthFreq, 200, 250, fifthContext);
     }
 }
\ No newline at end of file
@@ -23,6 +23,8 @@
 #include "../PrefrontalCortex/ProtoPerceptions.h"
 #include "../CorpusCallosum/SynapticPathways.h"
 #include "../AuditoryCortex/PitchPerception.h"
+#include "../PsychicCortex/NDEFParser.h"
+#include "../PsychicCortex/CardContentCache.h"
 
 namespace VisualCortex 
 {
@@ -58,6 +60,38 @@ namespace VisualCortex
         // Cross-modal integration methods
         static uint16_t convertToRGB565(CRGB neuralColor);
         static void playNFCCardData(const char* sensoryStimulusData);
+
+        /**
+         * @brief Play a tag's NDEF records: text as before, URIs quicker, MIME payloads as short blips
+         * @return false if the tag holds no such records
+         */
+        static bool playNFCCardData(const uint8_t* tagData, size_t length);
+
+        /**
+         * @brief The notes playNFCCardData would play, for keeping with a card
+         * @param found Set to whether the tag held any text, URI or MIME records
+         * @param skip Leading notes to leave out, so a long song can be composed a piece at a time
+         * @return Notes written, at most capacity
+         */
+        static size_t composeNFCCardData(const char* cardData, PsychicCortex::CardNote* notes, size_t capacity,
+                                         size_t skip = 0);
+        static size_t composeNFCCardData(const uint8_t* tagData, size_t length, PsychicCortex::CardNote* notes,
+                                         size_t capacity, bool* found = nullptr, size_t skip = 0);
+
+        /**
+         * @brief Play a card's song, fed to the tune lane a few notes at a time from update()
+         *
+         * notes are the song's first notes, as a cached card keeps them. With
+         * the card's data or text, the song goes on past them for as long as
+         * the card makes it; without, it ends with them.
+         */
+        static void playCardNotes(const PsychicCortex::CardNote* notes, size_t count,
+                                  const uint8_t* tagData = nullptr, size_t length = 0, const char* cardText = nullptr);
+
+        /**
+         * @brief Let a song started from cached notes go on once its card has been read
+         */
+        static void continueCardSong(const uint8_t* tagData, size_t length, const char* cardText);
         static void playVisualChord(uint16_t fundamentalFreq, 
                                   CRGB& rootPerception, 
                                   CRGB& thirdPerception, 
@@ -232,6 +232,16 @@ void loop() {
                     delay(1);
                 }
             }
+
+            // Advance queued tones and tunes without blocking the loop
+            if (SoundFxManager::isInitialized()) {
+                SoundFxManager::update();
+            }
+
+            // Commit batched SD writes once they have waited long enough
+            if (SDManager::isInitialized()) {
+                SDManager::update();
+            }
         }
         
         // Handle display updates at fixed interval
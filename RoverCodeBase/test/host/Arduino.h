@@ -0,0 +1,35 @@
+/**
+ * @file Arduino.h
+ * @brief Host stand-in for the few Arduino core names the shared headers use
+ *
+ * Only for the native test environment: lets platform-free modules that
+ * include SynapticPathways.h compile on host. Nothing here talks to hardware.
+ */
+
+#ifndef HOST_ARDUINO_H
+#define HOST_ARDUINO_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <cmath>
+#include <string>
+
+typedef uint8_t byte;
+
+class String
+{
+public:
+    String() {}
+    String(const char* text) : m_text(text) {}
+    String(int value) : m_text(std::to_string(value)) {}
+    const char* c_str() const { return m_text.c_str(); }
+
+private:
+    std::string m_text;
+};
+
+inline unsigned long millis() { return 0; }
+
+#define bitRead(value, bit) (((value) >> (bit)) & 0x01)
+
+#endif // HOST_ARDUINO_H
@@ -0,0 +1,57 @@
+/**
+ * @file FastLED.h
+ * @brief Host stand-in for the FastLED colour types the shared headers use
+ *
+ * Only for the native test environment. Colours are stored but never shown.
+ */
+
+#ifndef HOST_FASTLED_H
+#define HOST_FASTLED_H
+
+#include <stdint.h>
+
+struct CRGB
+{
+    uint8_t r;
+    uint8_t g;
+    uint8_t b;
+
+    CRGB() : r(0), g(0), b(0) {}
+    CRGB(uint8_t red, uint8_t green, uint8_t blue) : r(red), g(green), b(blue) {}
+    CRGB(uint32_t code) : r(code >> 16), g(code >> 8), b(code) {}
+
+    enum HTMLColorCode : uint32_t
+    {
+        Black = 0x000000,
+        White = 0xFFFFFF,
+        Red = 0xFF0000,
+        Green = 0x008000,
+        Blue = 0x0000FF,
+        Yellow = 0xFFFF00,
+        Orange = 0xFFA500,
+        Purple = 0x800080,
+        Cyan = 0x00FFFF,
+        Magenta = 0xFF00FF,
+        Pink = 0xFFC0CB,
+        Indigo = 0x4B0082,
+        Violet = 0xEE82EE,
+        Gold = 0xFFD700
+    };
+};
+
+struct CHSV
+{
+    uint8_t h;
+    uint8_t s;
+    uint8_t v;
+
+    CHSV(uint8_t hue, uint8_t saturation, uint8_t value) : h(hue), s(saturation), v(value) {}
+};
+
+enum EOrder
+{
+    RGB,
+    GRB
+};
+
+#endif // HOST_FASTLED_H
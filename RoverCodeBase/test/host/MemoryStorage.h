@@ -0,0 +1,309 @@
+/**
+ * @file MemoryStorage.h
+ * @brief In-memory StorageBackend for the native tests
+ *
+ * Files live in a map that tests can inspect, copy and corrupt directly.
+ * Power loss is modelled by an operation budget: when it runs out, the write
+ * in progress lands only partly and every later call fails, as if the card
+ * had lost power. The map then holds exactly what a reboot would find.
+ *
+ * Directories are implied by the paths of the files under them, plus any
+ * made explicitly; directoryBackend() lists them in name order and, like
+ * the FAT driver, positions a listing by entry index.
+ */
+
+#ifndef HOST_MEMORY_STORAGE_H
+#define HOST_MEMORY_STORAGE_H
+
+#include <stdint.h>
+#include <string.h>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "PrefrontalCortex/StorageBackend.h"
+#include "PrefrontalCortex/DirectoryWalker.h"
+
+namespace HostTest
+{
+    using PrefrontalCortex::StorageBackend;
+    using PrefrontalCortex::DirectoryBackend;
+    using PrefrontalCortex::DirectoryEntry;
+
+    typedef std::vector<uint8_t> Bytes;
+
+    class MemoryStorage
+    {
+    public:
+        static constexpr long UNLIMITED = -1;
+
+        std::map<std::string, Bytes> files;
+        std::set<std::string> directories;     // Empty ones; the rest are implied by files
+
+        uint32_t opens;
+        uint32_t reads;
+        uint32_t writes;
+        uint32_t sectorWrites;      // 512-byte sectors touched by writes
+        uint32_t syncs;
+        uint32_t directoryOpens;
+
+        MemoryStorage()
+            : opens(0), reads(0), writes(0), sectorWrites(0), syncs(0), directoryOpens(0),
+              m_budget(UNLIMITED), m_dead(false), m_tearState(1)
+        {
+        }
+
+        StorageBackend backend()
+        {
+            StorageBackend backend = { open, close, read, write, size, sync, exists, remove, rename, this };
+            return backend;
+        }
+
+        DirectoryBackend directoryBackend()
+        {
+            DirectoryBackend backend = { openDirectory, nextEntry, tellDirectory, seekDirectory, closeDirectory, this };
+            return backend;
+        }
+
+        /**
+         * @brief Lose power on the given write, remove or rename (0 = the next one)
+         * @param seed Picks how much of the interrupted write reaches the card
+         */
+        void powerLossAfter(long operations, uint32_t seed = 1)
+        {
+            m_budget = operations;
+            m_tearState = seed;
+        }
+
+        /**
+         * @brief Lose power now, so nothing else (a destructor, say) reaches the card
+         */
+        void cutPower()
+        {
+            m_dead = true;
+        }
+
+        /**
+         * @brief Reboot: calls work again and the budget is unlimited
+         */
+        void restorePower()
+        {
+            m_budget = UNLIMITED;
+            m_dead = false;
+        }
+
+        bool powerLost() const { return m_dead; }
+
+        void resetCounters()
+        {
+            opens = reads = writes = sectorWrites = syncs = directoryOpens = 0;
+        }
+
+    private:
+        struct Listing
+        {
+            std::vector<std::string> names;
+            std::vector<bool> isDirectory;
+            std::string path;           // With a trailing '/'
+            uint32_t position;
+        };
+
+        long m_budget;
+        bool m_dead;
+        uint32_t m_tearState;
+
+        static MemoryStorage& self(void* context) { return *static_cast<MemoryStorage*>(context); }
+        static const std::string& path(StorageBackend::Handle file) { return *static_cast<std::string*>(file); }
+
+        /**
+         * @brief Spend one mutating operation; false once power is gone
+         */
+        bool spend()
+        {
+            if (m_dead) return false;
+            if (m_budget == 0)
+            {
+                m_dead = true;
+                return false;
+            }
+            if (m_budget > 0) m_budget--;
+            return true;
+        }
+
+        static StorageBackend::Handle open(void* context, const char* name, bool create)
+        {
+            MemoryStorage& storage = self(context);
+            if (storage.m_dead) return nullptr;
+            if (storage.files.find(name) == storage.files.end())
+            {
+                if (!create) return nullptr;
+                storage.files[name];
+            }
+            storage.opens++;
+            return new std::string(name);
+        }
+
+        static void close(void*, StorageBackend::Handle file)
+        {
+            delete static_cast<std::string*>(file);
+        }
+
+        static size_t read(void* context, StorageBackend::Handle file, uint32_t offset, uint8_t* data, size_t length)
+        {
+            MemoryStorage& storage = self(context);
+            if (storage.m_dead) return 0;
+            storage.reads++;
+            auto it = storage.files.find(path(file));
+            if (it == storage.files.end() || offset >= it->second.size()) return 0;
+            const Bytes& bytes = it->second;
+            size_t count = bytes.size() - offset < length ? bytes.size() - offset : length;
+            memcpy(data, &bytes[offset], count);
+            return count;
+        }
+
+        static size_t write(void* context, StorageBackend::Handle file, uint32_t offset, const uint8_t* data, size_t length)
+        {
+            MemoryStorage& storage = self(context);
+            if (storage.m_dead) return 0;
+
+            // The interrupted write leaves some prefix of its data behind
+            size_t count = length;
+            bool torn = storage.m_budget == 0;
+            if (torn)
+            {
+                storage.m_tearState = storage.m_tearState * 1664525u + 1013904223u;
+                count = length ? (storage.m_tearState >> 8) % length : 0;
+                storage.m_dead = true;
+            }
+            else if (!storage.spend())
+            {
+                return 0;
+            }
+
+            storage.writes++;
+            storage.sectorWrites += (offset + length + 511) / 512 - offset / 512;
+            Bytes& bytes = storage.files[path(file)];
+            if (bytes.size() < offset + count) bytes.resize(offset + count);
+            if (count) memcpy(&bytes[offset], data, count);
+            return torn ? count : length;
+        }
+
+        static uint32_t size(void* context, StorageBackend::Handle file)
+        {
+            MemoryStorage& storage = self(context);
+            auto it = storage.files.find(path(file));
+            return it == storage.files.end() ? 0 : static_cast<uint32_t>(it->second.size());
+        }
+
+        static bool sync(void* context, StorageBackend::Handle)
+        {
+            MemoryStorage& storage = self(context);
+            if (storage.m_dead) return false;
+            storage.syncs++;
+            return true;
+        }
+
+        static bool exists(void* context, const char* name)
+        {
+            MemoryStorage& storage = self(context);
+            return !storage.m_dead && storage.files.find(name) != storage.files.end();
+        }
+
+        static bool remove(void* context, const char* name)
+        {
+            MemoryStorage& storage = self(context);
+            if (!storage.spend()) return false;
+            return storage.files.erase(name) > 0;
+        }
+
+        static bool rename(void* context, const char* from, const char* to)
+        {
+            MemoryStorage& storage = self(context);
+            if (!storage.spend()) return false;
+            auto it = storage.files.find(from);
+            if (it == storage.files.end()) return false;
+            Bytes bytes = it->second;
+            storage.files.erase(it);
+            storage.files[to] = bytes;
+            return true;
+        }
+
+        /**
+         * @brief Add the child of the listed directory that path lies under, if any
+         */
+        static void addChild(const Listing& listing, std::map<std::string, bool>& children,
+                             const std::string& path, bool isDirectory)
+        {
+            if (path.size() <= listing.path.size() || path.compare(0, listing.path.size(), listing.path) != 0) return;
+            size_t slash = path.find('/', listing.path.size());
+            std::string name = path.substr(listing.path.size(), slash - listing.path.size());
+            if (!name.empty()) children[name] = children[name] || isDirectory || slash != std::string::npos;
+        }
+
+        static DirectoryBackend::Handle openDirectory(void* context, const char* path)
+        {
+            MemoryStorage& storage = self(context);
+            if (storage.m_dead) return nullptr;
+
+            Listing* listing = new Listing();
+            listing->path = path;
+            if (listing->path.empty() || listing->path.back() != '/') listing->path += '/';
+            listing->position = 0;
+
+            std::map<std::string, bool> children;
+            for (const auto& file : storage.files) addChild(*listing, children, file.first, false);
+            for (const std::string& directory : storage.directories) addChild(*listing, children, directory, true);
+            bool known = listing->path == "/" || !children.empty() ||
+                         storage.directories.count(listing->path.substr(0, listing->path.size() - 1)) > 0;
+            if (!known)
+            {
+                delete listing;
+                return nullptr;
+            }
+            for (const auto& child : children)
+            {
+                listing->names.push_back(child.first);
+                listing->isDirectory.push_back(child.second);
+            }
+            storage.directoryOpens++;
+            return listing;
+        }
+
+        static bool nextEntry(void* context, DirectoryBackend::Handle directory, DirectoryEntry* entry, bool details)
+        {
+            MemoryStorage& storage = self(context);
+            Listing& listing = *static_cast<Listing*>(directory);
+            if (storage.m_dead || listing.position >= listing.names.size()) return false;
+
+            const std::string& name = listing.names[listing.position];
+            entry->isDirectory = listing.isDirectory[listing.position];
+            listing.position++;
+            if (name.size() < sizeof(entry->name)) memcpy(entry->name, name.c_str(), name.size() + 1);
+            else entry->name[0] = '\0';
+            entry->size = 0;
+            entry->modified = 0;
+            if (details && !entry->isDirectory)
+            {
+                entry->size = static_cast<uint32_t>(storage.files[listing.path + name].size());
+            }
+            return true;
+        }
+
+        static uint32_t tellDirectory(void*, DirectoryBackend::Handle directory)
+        {
+            return static_cast<Listing*>(directory)->position;
+        }
+
+        static void seekDirectory(void*, DirectoryBackend::Handle directory, uint32_t position)
+        {
+            static_cast<Listing*>(directory)->position = position;
+        }
+
+        static void closeDirectory(void*, DirectoryBackend::Handle directory)
+        {
+            delete static_cast<Listing*>(directory);
+        }
+    };
+}
+
+#endif // HOST_MEMORY_STORAGE_H
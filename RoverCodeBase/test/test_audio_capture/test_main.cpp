@@ -0,0 +1,298 @@
+/**
+ * @file test_main.cpp
+ * @brief CaptureRing wrap-around and overruns, CaptureWriter block alignment, tail and failures
+ *
+ * A synthetic microphone pushes numbered bytes in DMA-sized chunks and a
+ * fake sink appends every write to a file image after a 44-byte WAV header.
+ * The file must hold exactly the chunks the ring accepted, in order, with
+ * every write after the first starting on a 512-byte sector.
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "AuditoryCortex/AudioCapture.h"
+
+using namespace AuditoryCortex;
+
+namespace
+{
+    const uint32_t HEADER_BYTES = 44;
+    const uint32_t RING_BYTES = 16384;
+    const uint32_t BLOCK_BYTES = 4096;
+    const uint32_t CHUNK_BYTES = 256;          // One I2S DMA buffer
+    const uint32_t WRITE_MICROS = 150;
+
+    /**
+     * @brief File image behind the writer; can be told to come up short on one write
+     */
+    struct Sink
+    {
+        std::vector<uint8_t> file;
+        std::vector<uint32_t> offsets;
+        std::vector<uint32_t> lengths;
+        int failOnWrite;            // -1 = never
+    };
+
+    size_t sinkWrite(void* context, const uint8_t* data, size_t length)
+    {
+        Sink& sink = *static_cast<Sink*>(context);
+        int index = static_cast<int>(sink.lengths.size());
+        sink.offsets.push_back(static_cast<uint32_t>(sink.file.size()));
+        sink.lengths.push_back(static_cast<uint32_t>(length));
+        size_t written = index == sink.failOnWrite ? length / 2 : length;
+        sink.file.insert(sink.file.end(), data, data + written);
+        return written;
+    }
+
+    uint32_t clockMicros = 0;
+
+    uint32_t fakeMicros()
+    {
+        clockMicros += WRITE_MICROS / 2;
+        return clockMicros;
+    }
+
+    /**
+     * @brief Numbered samples, so a dropped or repeated byte shows up
+     */
+    struct Microphone
+    {
+        uint32_t produced;
+        std::vector<uint8_t> accepted;
+
+        void chunk(uint8_t* out, uint32_t length)
+        {
+            for (uint32_t i = 0; i < length; i++) out[i] = static_cast<uint8_t>((produced + i) * 7 + ((produced + i) >> 8));
+        }
+
+        bool push(CaptureRing& ring, uint32_t length)
+        {
+            uint8_t data[CHUNK_BYTES];
+            chunk(data, length);
+            produced += length;
+            if (!ring.push(data, length)) return false;
+            accepted.insert(accepted.end(), data, data + length);
+            return true;
+        }
+    };
+
+    uint8_t ringStorage[RING_BYTES];
+    uint8_t block[CaptureWriter::MAX_BLOCK];
+    Sink sink;
+    Microphone microphone;
+
+    void startFile()
+    {
+        sink = Sink();
+        sink.file.assign(HEADER_BYTES, 0);
+        sink.failOnWrite = -1;
+        microphone = Microphone();
+        microphone.produced = 0;
+        clockMicros = 0;
+    }
+
+    void assertFileMatches(const Sink& file, const Microphone& source)
+    {
+        TEST_ASSERT_EQUAL_UINT32(HEADER_BYTES + source.accepted.size(), file.file.size());
+        TEST_ASSERT_EQUAL_MEMORY(source.accepted.data(), file.file.data() + HEADER_BYTES, source.accepted.size());
+    }
+}
+
+void setUp()
+{
+    startFile();
+    memset(ringStorage, 0, sizeof(ringStorage));
+}
+
+void tearDown() {}
+
+void test_ring_wraps_around_its_end()
+{
+    CaptureRing ring(ringStorage, 64);
+    uint8_t in[64];
+    uint8_t out[64];
+    for (int i = 0; i < 64; i++) in[i] = static_cast<uint8_t>(i + 1);
+
+    // Leave the indices near the end so the next push and pop each split in two
+    TEST_ASSERT_TRUE(ring.push(in, 40));
+    TEST_ASSERT_EQUAL_UINT32(40, ring.pop(out, 40));
+    TEST_ASSERT_EQUAL_UINT32(0, ring.available());
+
+    TEST_ASSERT_TRUE(ring.push(in, 50));
+    TEST_ASSERT_EQUAL_UINT32(50, ring.available());
+    TEST_ASSERT_EQUAL_UINT32(14, ring.freeSpace());
+    TEST_ASSERT_EQUAL_UINT32(50, ring.pop(out, 64));
+    TEST_ASSERT_EQUAL_MEMORY(in, out, 50);
+
+    // Partial pops across the seam keep the byte order
+    for (int round = 0; round < 20; round++)
+    {
+        TEST_ASSERT_TRUE(ring.push(in, 37));
+        TEST_ASSERT_EQUAL_UINT32(20, ring.pop(out, 20));
+        TEST_ASSERT_EQUAL_UINT32(17, ring.pop(out + 20, 64));
+        TEST_ASSERT_EQUAL_MEMORY(in, out, 37);
+    }
+    TEST_ASSERT_EQUAL_UINT32(90 + 20 * 37, ring.bytesAccepted());
+    TEST_ASSERT_EQUAL_UINT32(0, ring.overrunEvents());
+}
+
+void test_overruns_drop_whole_chunks_and_are_counted()
+{
+    CaptureRing ring(ringStorage, 64);
+    uint8_t data[64] = {};
+    TEST_ASSERT_TRUE(ring.push(data, 60));
+
+    // Does not fit: nothing goes in, one event for the whole chunk
+    TEST_ASSERT_FALSE(ring.push(data, 10));
+    TEST_ASSERT_EQUAL_UINT32(60, ring.available());
+    TEST_ASSERT_EQUAL_UINT32(1, ring.overrunEvents());
+    TEST_ASSERT_EQUAL_UINT32(10, ring.overrunBytes());
+
+    TEST_ASSERT_TRUE(ring.push(data, 4));
+    TEST_ASSERT_FALSE(ring.push(data, 1));
+    TEST_ASSERT_EQUAL_UINT32(2, ring.overrunEvents());
+    TEST_ASSERT_EQUAL_UINT32(11, ring.overrunBytes());
+    TEST_ASSERT_EQUAL_UINT32(64, ring.bytesAccepted());
+
+    ring.reset();
+    TEST_ASSERT_EQUAL_UINT32(0, ring.available());
+    TEST_ASSERT_EQUAL_UINT32(0, ring.overrunEvents());
+    TEST_ASSERT_EQUAL_UINT32(0, ring.overrunBytes());
+}
+
+void test_first_block_realigns_writes_to_sectors()
+{
+    CaptureRing ring(ringStorage, RING_BYTES);
+    CaptureWriter writer(ring, block, BLOCK_BYTES, HEADER_BYTES, sinkWrite, &sink, fakeMicros);
+
+    for (int i = 0; i < 64; i++)
+    {
+        TEST_ASSERT_TRUE(microphone.push(ring, CHUNK_BYTES));
+        TEST_ASSERT_TRUE(writer.pump());
+    }
+
+    // 16 KiB in: a short first block, then whole blocks, each on a sector
+    TEST_ASSERT_EQUAL_UINT32(4, sink.lengths.size());
+    TEST_ASSERT_EQUAL_UINT32(BLOCK_BYTES - HEADER_BYTES, sink.lengths[0]);
+    for (size_t i = 1; i < sink.lengths.size(); i++)
+    {
+        TEST_ASSERT_EQUAL_UINT32(BLOCK_BYTES, sink.lengths[i]);
+        TEST_ASSERT_EQUAL_UINT32(0, sink.offsets[i] % CaptureWriter::SECTOR_SIZE);
+    }
+    TEST_ASSERT_EQUAL_UINT32(HEADER_BYTES, ring.available());
+
+    TEST_ASSERT_TRUE(writer.finish());
+    assertFileMatches(sink, microphone);
+}
+
+void test_block_size_is_clamped_to_whole_sectors()
+{
+    CaptureRing ring(ringStorage, RING_BYTES);
+    CaptureWriter small(ring, block, 1000, 0, sinkWrite, &sink, nullptr);
+    for (int i = 0; i < 20; i++) microphone.push(ring, CHUNK_BYTES);
+    TEST_ASSERT_TRUE(small.pump());
+    TEST_ASSERT_EQUAL_UINT32(CaptureWriter::MIN_BLOCK, sink.lengths[0]);
+
+    startFile();
+    CaptureWriter odd(ring, block, 6000, 512, sinkWrite, &sink, nullptr);
+    ring.reset();
+    for (int i = 0; i < 40; i++) microphone.push(ring, CHUNK_BYTES);
+    TEST_ASSERT_TRUE(odd.pump());
+    TEST_ASSERT_EQUAL_UINT32(5632, sink.lengths[0]);     // Already aligned: not shortened
+
+    startFile();
+    CaptureWriter large(ring, block, 100000, 0, sinkWrite, &sink, nullptr);
+    ring.reset();
+    for (int i = 0; i < 64; i++) microphone.push(ring, CHUNK_BYTES);
+    TEST_ASSERT_TRUE(large.pump());
+    TEST_ASSERT_EQUAL_UINT32(CaptureWriter::MAX_BLOCK, sink.lengths[0]);
+}
+
+void test_finish_writes_the_tail()
+{
+    CaptureRing ring(ringStorage, RING_BYTES);
+    CaptureWriter writer(ring, block, BLOCK_BYTES, HEADER_BYTES, sinkWrite, &sink, fakeMicros);
+
+    // Less than the shortened first block, then an odd-sized last chunk
+    for (int i = 0; i < 10; i++) microphone.push(ring, CHUNK_BYTES);
+    microphone.push(ring, 77);
+    TEST_ASSERT_TRUE(writer.pump());
+    TEST_ASSERT_EQUAL_UINT32(0, sink.lengths.size());
+
+    TEST_ASSERT_TRUE(writer.finish());
+    TEST_ASSERT_EQUAL_UINT32(1, sink.lengths.size());
+    TEST_ASSERT_EQUAL_UINT32(10 * CHUNK_BYTES + 77, sink.lengths[0]);
+    TEST_ASSERT_EQUAL_UINT32(10 * CHUNK_BYTES + 77, writer.dataBytes());
+    assertFileMatches(sink, microphone);
+
+    // An empty ring writes nothing more
+    TEST_ASSERT_TRUE(writer.finish());
+    TEST_ASSERT_EQUAL_UINT32(1, sink.lengths.size());
+}
+
+void test_short_write_latches_failure()
+{
+    CaptureRing ring(ringStorage, RING_BYTES);
+    CaptureWriter writer(ring, block, BLOCK_BYTES, HEADER_BYTES, sinkWrite, &sink, fakeMicros);
+    sink.failOnWrite = 1;
+
+    for (int i = 0; i < 40; i++) microphone.push(ring, CHUNK_BYTES);
+    TEST_ASSERT_FALSE(writer.pump());
+    TEST_ASSERT_EQUAL_UINT32(2, sink.lengths.size());
+    TEST_ASSERT_EQUAL_UINT32(BLOCK_BYTES - HEADER_BYTES + BLOCK_BYTES / 2, writer.dataBytes());
+
+    // Nothing reaches the card once a write has failed, whatever else arrives
+    for (int i = 0; i < 20; i++) microphone.push(ring, CHUNK_BYTES);
+    TEST_ASSERT_FALSE(writer.pump());
+    TEST_ASSERT_FALSE(writer.finish());
+    TEST_ASSERT_EQUAL_UINT32(2, sink.lengths.size());
+}
+
+void test_slow_writer_costs_chunks_not_order()
+{
+    CaptureRing ring(ringStorage, RING_BYTES);
+    CaptureWriter writer(ring, block, BLOCK_BYTES, HEADER_BYTES, sinkWrite, &sink, fakeMicros);
+
+    // The writer only gets to run after every 96 chunks, so the ring overflows in between
+    uint32_t rejected = 0;
+    for (int i = 0; i < 960; i++)
+    {
+        if (!microphone.push(ring, CHUNK_BYTES)) rejected++;
+        if (i % 96 == 95) TEST_ASSERT_TRUE(writer.pump());
+    }
+    TEST_ASSERT_TRUE(writer.finish());
+
+    CaptureStats stats = writer.stats();
+    TEST_ASSERT_TRUE(rejected > 0);
+    TEST_ASSERT_EQUAL_UINT32(rejected, stats.overrunEvents);
+    TEST_ASSERT_EQUAL_UINT32(rejected * CHUNK_BYTES, stats.overrunBytes);
+    TEST_ASSERT_EQUAL_UINT32(microphone.accepted.size(), stats.bytesCaptured);
+    TEST_ASSERT_EQUAL_UINT32(stats.bytesCaptured, stats.bytesWritten);
+    TEST_ASSERT_EQUAL_UINT32(microphone.produced, stats.bytesCaptured + stats.overrunBytes);
+    assertFileMatches(sink, microphone);
+
+    // Each write reads the clock twice, half a write apart
+    TEST_ASSERT_EQUAL_UINT32(WRITE_MICROS / 2, stats.maxWriteMicros);
+    TEST_ASSERT_EQUAL_UINT32(stats.writeCount * WRITE_MICROS / 2, stats.totalWriteMicros);
+    TEST_ASSERT_TRUE(stats.sustainedMBps > 0.0f);
+
+    char message[128];
+    snprintf(message, sizeof(message), "%u of %u chunks dropped, %u writes, %u bytes kept in order",
+             rejected, 960u, stats.writeCount, stats.bytesWritten);
+    TEST_MESSAGE(message);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_ring_wraps_around_its_end);
+    RUN_TEST(test_overruns_drop_whole_chunks_and_are_counted);
+    RUN_TEST(test_first_block_realigns_writes_to_sectors);
+    RUN_TEST(test_block_size_is_clamped_to_whole_sectors);
+    RUN_TEST(test_finish_writes_the_tail);
+    RUN_TEST(test_short_write_latches_failure);
+    RUN_TEST(test_slow_writer_costs_chunks_not_order);
+    return UNITY_END();
+}
@@ -0,0 +1,258 @@
+/**
+ * @file test_main.cpp
+ * @brief Recording codecs: round trips through a WAV file, SNR and throughput
+ *
+ * A two-tone signal is encoded the way the capture task does it, in DMA-sized
+ * chunks, written behind a header, then decoded the way playback does it, in
+ * short reads. The decoded signal is compared against the original.
+ */
+
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "AuditoryCortex/AudioCodecs.h"
+
+using namespace AuditoryCortex;
+
+namespace
+{
+    const uint32_t SAMPLE_RATE = 44100;
+    const size_t SIGNAL_SAMPLES = SAMPLE_RATE * 4;
+    const size_t CAPTURE_CHUNK = 256;           // Samples per capture task read
+    const size_t PLAYBACK_READ = 100;           // File bytes per playback read
+    const double MIN_ADPCM_SNR_DB = 38.0;
+    const double MIN_MU_LAW_SNR_DB = 34.0;
+    const double MIN_REALTIME_FACTOR = 20.0;    // Host encode and decode, against 44.1 kHz
+
+    struct RoundTrip
+    {
+        std::vector<uint8_t> file;
+        std::vector<int16_t> decoded;
+        WavFormatInfo info;
+        double encodeSeconds;
+        double decodeSeconds;
+    };
+
+    std::vector<int16_t> twoTones(size_t count)
+    {
+        std::vector<int16_t> samples(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            samples[i] = static_cast<int16_t>(8000 * sin(2 * M_PI * 440 * i / SAMPLE_RATE) +
+                                              3000 * sin(2 * M_PI * 1230 * i / SAMPLE_RATE));
+        }
+        return samples;
+    }
+
+    double seconds(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+
+    RoundTrip roundTrip(RecordingFormat format, uint8_t decimation, const std::vector<int16_t>& source)
+    {
+        RoundTrip result;
+        AudioEncoder encoder;
+        encoder.begin(format, decimation);
+
+        // Header space first, patched once the data length is known, as stopRecording() does
+        result.file.resize(WavCodec::MAX_HEADER_BYTES);
+        size_t headerBytes = WavCodec::buildHeader(result.file.data(), format, encoder.outputRate(SAMPLE_RATE), 0);
+        result.file.resize(headerBytes);
+
+        int16_t chunk[CAPTURE_CHUNK];
+        std::vector<uint8_t> encoded(AudioEncoder::maxEncodedBytes(CAPTURE_CHUNK));
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < source.size(); i += CAPTURE_CHUNK)
+        {
+            size_t count = source.size() - i < CAPTURE_CHUNK ? source.size() - i : CAPTURE_CHUNK;
+            memcpy(chunk, &source[i], count * sizeof(int16_t));
+            size_t bytes = encoder.encode(chunk, count, encoded.data());
+            result.file.insert(result.file.end(), encoded.begin(), encoded.begin() + bytes);
+        }
+        size_t tail = encoder.flush(encoded.data());
+        result.file.insert(result.file.end(), encoded.begin(), encoded.begin() + tail);
+        result.encodeSeconds = seconds(start);
+        WavCodec::buildHeader(result.file.data(), format, encoder.outputRate(SAMPLE_RATE),
+                              result.file.size() - headerBytes);
+
+        TEST_ASSERT_TRUE(WavCodec::parseHeader(result.file.data(), headerBytes, result.info));
+        StreamDecoder decoder;
+        decoder.begin(result.info);
+        int16_t pcm[300];
+        size_t position = result.info.dataOffset;
+        start = std::chrono::steady_clock::now();
+        for (;;)
+        {
+            size_t left = result.file.size() - position;
+            size_t consumed = 0;
+            size_t samples = decoder.decode(result.file.data() + position, left < PLAYBACK_READ ? left : PLAYBACK_READ,
+                                            consumed, pcm, sizeof(pcm) / sizeof(pcm[0]));
+            position += consumed;
+            result.decoded.insert(result.decoded.end(), pcm, pcm + samples);
+            if (samples == 0 && consumed == 0) break;
+        }
+        result.decodeSeconds = seconds(start);
+        return result;
+    }
+
+    double snrDb(const std::vector<int16_t>& reference, const std::vector<int16_t>& decoded)
+    {
+        double signal = 0;
+        double noise = 0;
+        for (size_t i = 0; i < reference.size(); i++)
+        {
+            double error = static_cast<double>(reference[i]) - decoded[i];
+            signal += static_cast<double>(reference[i]) * reference[i];
+            noise += error * error;
+        }
+        return noise == 0 ? 1000.0 : 10 * log10(signal / noise);
+    }
+
+    void report(const char* name, const std::vector<int16_t>& source, const RoundTrip& trip)
+    {
+        char message[160];
+        size_t dataBytes = trip.file.size() - trip.info.dataOffset;
+        snprintf(message, sizeof(message), "%s: %.2f:1, SNR %.1f dB, encode %.1f Msps, decode %.1f Msps", name,
+                 source.size() * 2.0 / dataBytes, snrDb(source, trip.decoded),
+                 source.size() / trip.encodeSeconds / 1e6, source.size() / trip.decodeSeconds / 1e6);
+        TEST_MESSAGE(message);
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_mu_law_codes_round_trip()
+{
+    for (int code = 0; code < 256; code++)
+    {
+        // 0x7F and 0xFF are both zero; zero encodes as 0xFF
+        uint8_t expected = code == 0x7F ? 0xFF : static_cast<uint8_t>(code);
+        TEST_ASSERT_EQUAL_HEX8(expected, MuLaw::encode(MuLaw::decode(static_cast<uint8_t>(code))));
+    }
+}
+
+void test_pcm_round_trip_is_exact()
+{
+    std::vector<int16_t> source = twoTones(SIGNAL_SAMPLES);
+    RoundTrip trip = roundTrip(RecordingFormat::PCM16, 1, source);
+    TEST_ASSERT_EQUAL(RecordingFormat::PCM16, trip.info.format);
+    TEST_ASSERT_EQUAL_UINT32(SAMPLE_RATE, trip.info.sampleRate);
+    TEST_ASSERT_EQUAL_UINT32(source.size(), trip.decoded.size());
+    TEST_ASSERT_EQUAL_MEMORY(source.data(), trip.decoded.data(), source.size() * sizeof(int16_t));
+}
+
+void test_adpcm_quarter_size_and_snr()
+{
+    std::vector<int16_t> source = twoTones(SIGNAL_SAMPLES);
+    RoundTrip trip = roundTrip(RecordingFormat::IMA_ADPCM, 1, source);
+    report("IMA-ADPCM", source, trip);
+
+    // Whole blocks only; the last is zero-padded
+    size_t blocks = (source.size() + ImaAdpcm::SAMPLES_PER_BLOCK - 1) / ImaAdpcm::SAMPLES_PER_BLOCK;
+    TEST_ASSERT_EQUAL(RecordingFormat::IMA_ADPCM, trip.info.format);
+    TEST_ASSERT_EQUAL_UINT32(blocks * ImaAdpcm::BLOCK_ALIGN, trip.info.dataBytes);
+    TEST_ASSERT_EQUAL_UINT32(blocks * ImaAdpcm::SAMPLES_PER_BLOCK, trip.decoded.size());
+    TEST_ASSERT_TRUE(snrDb(source, trip.decoded) > MIN_ADPCM_SNR_DB);
+}
+
+void test_mu_law_half_size_and_snr()
+{
+    std::vector<int16_t> source = twoTones(SIGNAL_SAMPLES);
+    RoundTrip trip = roundTrip(RecordingFormat::MU_LAW, 1, source);
+    report("mu-law", source, trip);
+
+    TEST_ASSERT_EQUAL(RecordingFormat::MU_LAW, trip.info.format);
+    TEST_ASSERT_EQUAL_UINT32(source.size(), trip.info.dataBytes);
+    TEST_ASSERT_EQUAL_UINT32(source.size(), trip.decoded.size());
+    TEST_ASSERT_TRUE(snrDb(source, trip.decoded) > MIN_MU_LAW_SNR_DB);
+}
+
+void test_decimated_recordings_declare_their_rate()
+{
+    std::vector<int16_t> source = twoTones(SIGNAL_SAMPLES);
+    for (uint8_t decimation = 2; decimation <= 4; decimation *= 2)
+    {
+        RoundTrip pcm = roundTrip(RecordingFormat::PCM16, decimation, source);
+        TEST_ASSERT_EQUAL_UINT32(SAMPLE_RATE / decimation, pcm.info.sampleRate);
+        TEST_ASSERT_EQUAL_UINT32(source.size() / decimation, pcm.decoded.size());
+
+        RoundTrip adpcm = roundTrip(RecordingFormat::IMA_ADPCM, decimation, source);
+        TEST_ASSERT_EQUAL_UINT32(SAMPLE_RATE / decimation, adpcm.info.sampleRate);
+        TEST_ASSERT_TRUE(adpcm.decoded.size() >= source.size() / decimation);
+    }
+}
+
+void test_decimator_passes_voice_and_rejects_aliases()
+{
+    std::vector<int16_t> voice(SIGNAL_SAMPLES);
+    std::vector<int16_t> alias(SIGNAL_SAMPLES);
+    for (size_t i = 0; i < SIGNAL_SAMPLES; i++)
+    {
+        voice[i] = static_cast<int16_t>(8000 * sin(2 * M_PI * 440 * i / SAMPLE_RATE));
+        alias[i] = static_cast<int16_t>(8000 * sin(2 * M_PI * 15000 * i / SAMPLE_RATE));
+    }
+
+    Decimator passing(2);
+    Decimator rejecting(2);
+    size_t kept = passing.process(voice.data(), voice.size(), voice.data());
+    size_t rejected = rejecting.process(alias.data(), alias.size(), alias.data());
+    TEST_ASSERT_EQUAL_UINT32(SIGNAL_SAMPLES / 2, kept);
+    TEST_ASSERT_EQUAL_UINT32(SIGNAL_SAMPLES / 2, rejected);
+
+    // Past the filter's start-up, 440 Hz keeps its level and 15 kHz is at least 26 dB down
+    int voicePeak = 0;
+    int aliasPeak = 0;
+    for (size_t i = 100; i < kept; i++)
+    {
+        if (abs(voice[i]) > voicePeak) voicePeak = abs(voice[i]);
+        if (abs(alias[i]) > aliasPeak) aliasPeak = abs(alias[i]);
+    }
+    TEST_ASSERT_INT_WITHIN(400, 8000, voicePeak);
+    TEST_ASSERT_LESS_THAN(400, aliasPeak);
+}
+
+void test_header_parse_rejects_other_files()
+{
+    uint8_t header[WavCodec::MAX_HEADER_BYTES];
+    size_t length = WavCodec::buildHeader(header, RecordingFormat::MU_LAW, 22050, 1000);
+    WavFormatInfo info;
+    TEST_ASSERT_TRUE(WavCodec::parseHeader(header, length, info));
+    TEST_ASSERT_EQUAL_UINT32(length, info.dataOffset);
+    TEST_ASSERT_EQUAL_UINT32(1000, info.dataBytes);
+
+    TEST_ASSERT_FALSE(WavCodec::parseHeader(header, 12, info));
+    header[0] = 'X';
+    TEST_ASSERT_FALSE(WavCodec::parseHeader(header, length, info));
+}
+
+void test_codecs_keep_up_with_capture()
+{
+    std::vector<int16_t> source = twoTones(SIGNAL_SAMPLES);
+    const RecordingFormat formats[] = { RecordingFormat::IMA_ADPCM, RecordingFormat::MU_LAW };
+    for (RecordingFormat format : formats)
+    {
+        RoundTrip trip = roundTrip(format, 1, source);
+        double audioSeconds = static_cast<double>(source.size()) / SAMPLE_RATE;
+        TEST_ASSERT_TRUE(audioSeconds / trip.encodeSeconds > MIN_REALTIME_FACTOR);
+        TEST_ASSERT_TRUE(audioSeconds / trip.decodeSeconds > MIN_REALTIME_FACTOR);
+    }
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_mu_law_codes_round_trip);
+    RUN_TEST(test_pcm_round_trip_is_exact);
+    RUN_TEST(test_adpcm_quarter_size_and_snr);
+    RUN_TEST(test_mu_law_half_size_and_snr);
+    RUN_TEST(test_decimated_recordings_declare_their_rate);
+    RUN_TEST(test_decimator_passes_voice_and_rejects_aliases);
+    RUN_TEST(test_header_parse_rejects_other_files);
+    RUN_TEST(test_codecs_keep_up_with_capture);
+    return UNITY_END();
+}
@@ -0,0 +1,207 @@
+/**
+ * @file test_main.cpp
+ * @brief AudioMixer ducking, pausing, voice priority and trigger latency
+ *
+ * The mixer runs against a real WavetableSynth and a host microsecond clock,
+ * one 128-frame block at a time as the I2S task calls it. The latency
+ * benchmark triggers a UI note before every block, so each trigger reaches
+ * the output in the very next render.
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include "AuditoryCortex/AudioMixer.h"
+
+using namespace AuditoryCortex;
+
+namespace
+{
+    const uint32_t SAMPLE_RATE = 44100;
+    const size_t BLOCK = 128;
+    const uint32_t BENCH_TRIGGERS = 2000;
+    const double BLOCK_MICROS = BLOCK * 1e6 / SAMPLE_RATE;
+    const double MAX_CPU_PERCENT = 10.0;        // Host render cost against real time
+
+    int16_t block[BLOCK * 2];
+
+    uint32_t hostMicros()
+    {
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    struct Stream
+    {
+        size_t remaining;
+        size_t pulled;
+    };
+
+    size_t pullStream(void* context, int16_t* out, size_t frames)
+    {
+        Stream& stream = *static_cast<Stream*>(context);
+        size_t count = stream.remaining < frames ? stream.remaining : frames;
+        for (size_t i = 0; i < count; i++) out[i] = 8000;
+        stream.remaining -= count;
+        stream.pulled += count;
+        return count;
+    }
+
+    /**
+     * @brief Render blocks; returns the loudest sample of the last one
+     */
+    int renderBlocks(AudioMixer& mixer, uint32_t blocks)
+    {
+        for (uint32_t b = 0; b < blocks; b++) mixer.render(block, BLOCK);
+        int peak = 0;
+        for (size_t i = 0; i < BLOCK * 2; i++)
+        {
+            if (abs(block[i]) > peak) peak = abs(block[i]);
+        }
+        return peak;
+    }
+
+    uint8_t group(MixChannel channel)
+    {
+        return static_cast<uint8_t>(channel);
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_ui_ducks_music_and_recovers()
+{
+    WavetableSynth synth(SAMPLE_RATE);
+    AudioMixer mixer(synth, hostMicros);
+    mixer.setDucking(MixChannel::MUSIC, MixChannel::UI, AudioMixer::UNITY / 2);
+
+    synth.noteOn(1, 440, 255, group(MixChannel::MUSIC));
+    mixer.trigger(MixChannel::MUSIC);
+    int alone = renderBlocks(mixer, 40);
+
+    // Even a near-silent UI note ducks the music to half
+    synth.noteOn(5, 880, 1, group(MixChannel::UI));
+    int ducked = renderBlocks(mixer, 40);
+    TEST_ASSERT_TRUE(mixer.isActive(MixChannel::UI));
+    TEST_ASSERT_INT_WITHIN(alone / 20, alone / 2, ducked);
+
+    synth.noteOff(5);
+    int recovered = renderBlocks(mixer, 200);
+    TEST_ASSERT_EQUAL_UINT8(0, synth.groupVoices(group(MixChannel::UI)));
+    TEST_ASSERT_INT_WITHIN(alone / 20, alone, recovered);
+}
+
+void test_channel_gain_scales_output()
+{
+    WavetableSynth synth(SAMPLE_RATE);
+    AudioMixer mixer(synth, hostMicros);
+    synth.noteOn(1, 440, 255, group(MixChannel::MUSIC));
+    int full = renderBlocks(mixer, 40);
+
+    mixer.setChannelGain(MixChannel::MUSIC, AudioMixer::UNITY / 4);
+    TEST_ASSERT_EQUAL_UINT8(AudioMixer::UNITY / 4, mixer.channelGain(MixChannel::MUSIC));
+    TEST_ASSERT_INT_WITHIN(full / 20, full / 4, renderBlocks(mixer, 40));
+
+    mixer.setChannelGain(MixChannel::MUSIC, 0);
+    TEST_ASSERT_EQUAL_INT(0, renderBlocks(mixer, 40));
+}
+
+void test_alert_pauses_voice_without_losing_audio()
+{
+    WavetableSynth synth(SAMPLE_RATE);
+    AudioMixer mixer(synth, hostMicros);
+    Stream voice = { SAMPLE_RATE, 0 };
+    mixer.setStream(MixChannel::VOICE, pullStream, &voice);
+    mixer.setDucking(MixChannel::VOICE, MixChannel::ALERT, 0, true);
+
+    renderBlocks(mixer, 10);
+    TEST_ASSERT_EQUAL_UINT32(10 * BLOCK, voice.pulled);
+    TEST_ASSERT_TRUE(mixer.isActive(MixChannel::VOICE));
+
+    // The stream keeps playing while it fades out, then stops being pulled
+    synth.noteOn(9, 1000, 200, group(MixChannel::ALERT));
+    mixer.trigger(MixChannel::ALERT);
+    renderBlocks(mixer, 30);
+    size_t paused = voice.pulled;
+    TEST_ASSERT_TRUE(paused > 10 * BLOCK);
+    renderBlocks(mixer, 10);
+    TEST_ASSERT_EQUAL_UINT32(paused, voice.pulled);
+
+    // Once the alert has gone, it picks up where it stopped
+    synth.noteOff(9);
+    renderBlocks(mixer, 100);
+    TEST_ASSERT_TRUE(voice.pulled > paused);
+    TEST_ASSERT_EQUAL_UINT32(SAMPLE_RATE, voice.pulled + voice.remaining);
+    TEST_ASSERT_TRUE(mixer.isActive(MixChannel::VOICE));
+}
+
+void test_alerts_steal_music_voices_but_not_the_reverse()
+{
+    WavetableSynth synth(SAMPLE_RATE);
+    AudioMixer mixer(synth, hostMicros);
+    for (uint8_t v = 0; v < WavetableSynth::MAX_VOICES; v++)
+    {
+        synth.noteOn(20 + v, 300 + v * 10, 100, group(MixChannel::MUSIC));
+    }
+    synth.noteOn(60, 500, 100, group(MixChannel::ALERT));
+    renderBlocks(mixer, 2);
+    TEST_ASSERT_EQUAL_UINT8(1, synth.groupVoices(group(MixChannel::ALERT)));
+    TEST_ASSERT_EQUAL_UINT8(WavetableSynth::MAX_VOICES - 1, synth.groupVoices(group(MixChannel::MUSIC)));
+    TEST_ASSERT_EQUAL_UINT32(1, mixer.stats().voicesStolen);
+
+    synth.allNotesOff();
+    renderBlocks(mixer, 2);
+    for (uint8_t v = 0; v < WavetableSynth::MAX_VOICES; v++)
+    {
+        synth.noteOn(80 + v, 300 + v * 10, 100, group(MixChannel::ALERT));
+    }
+    synth.noteOn(120, 200, 100, group(MixChannel::MUSIC));
+    renderBlocks(mixer, 1);
+    TEST_ASSERT_EQUAL_UINT32(1, mixer.stats().notesRejected);
+    TEST_ASSERT_EQUAL_UINT8(0, synth.groupVoices(group(MixChannel::MUSIC)));
+}
+
+void test_trigger_latency_and_render_cost()
+{
+    WavetableSynth synth(SAMPLE_RATE);
+    AudioMixer mixer(synth, hostMicros);
+    mixer.resetStats();
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t t = 0; t < BENCH_TRIGGERS; t++)
+    {
+        synth.noteOn(1, 440 + t % 100, 200, group(MixChannel::UI));
+        mixer.trigger(MixChannel::UI);
+        mixer.render(block, BLOCK);
+        synth.noteOff(1);
+        renderBlocks(mixer, 20);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    MixerStats stats = mixer.stats();
+    double averageLatency = static_cast<double>(stats.totalLatencyMicros) / stats.latencySamples;
+    double cpuPercent = 100.0 * seconds * 1e6 / (stats.blocksRendered * BLOCK_MICROS);
+
+    char message[160];
+    snprintf(message, sizeof(message),
+             "%u triggers: latency avg %.2f us, max %u us; render %.2f%% CPU, slowest block %u us of %.0f us",
+             stats.latencySamples, averageLatency, stats.maxLatencyMicros, cpuPercent,
+             stats.maxRenderMicros, BLOCK_MICROS);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL_UINT32(BENCH_TRIGGERS, stats.latencySamples);
+    TEST_ASSERT_EQUAL_UINT32(BENCH_TRIGGERS * 21, stats.blocksRendered);
+    TEST_ASSERT_TRUE(averageLatency < BLOCK_MICROS);
+    TEST_ASSERT_TRUE(cpuPercent < MAX_CPU_PERCENT);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_ui_ducks_music_and_recovers);
+    RUN_TEST(test_channel_gain_scales_output);
+    RUN_TEST(test_alert_pauses_voice_without_losing_audio);
+    RUN_TEST(test_alerts_steal_music_voices_but_not_the_reverse);
+    RUN_TEST(test_trigger_latency_and_render_cost);
+    return UNITY_END();
+}
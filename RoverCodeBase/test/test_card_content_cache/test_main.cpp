@@ -0,0 +1,319 @@
+/**
+ * @file test_main.cpp
+ * @brief CardContentCache eviction, validation and persistence, and NFCEngine reacting from it
+ *
+ * The engine runs against PN532Emulator. Known cards should be announced
+ * from the cache as soon as their UID answers, with no pages read, and a
+ * card rewritten since it was cached should be caught by the read that
+ * follows on the same tap.
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "MemoryStorage.h"
+#include "PsychicCortex/CardContentCache.h"
+#include "PsychicCortex/NFCEngine.h"
+#include "PsychicCortex/PN532Emulator.h"
+
+using namespace PsychicCortex;
+using HostTest::MemoryStorage;
+
+namespace
+{
+    const char* CACHE_FILE = "/nfc/card_content.bin";
+    const uint32_t LOOP_MICROS = 5000;
+    const uint32_t TAP_MICROS = 1000000;
+    const uint32_t MAX_CACHED_REACTION = 15000;
+    const uint32_t MIN_READ_REACTION = 100000;
+
+    CardContent entry(uint8_t id, uint32_t hash)
+    {
+        CardContent content;
+        memset(&content, 0, sizeof(content));
+        content.uidLength = 7;
+        for (uint8_t i = 0; i < content.uidLength; i++) content.uid[i] = static_cast<uint8_t>(id + i);
+        content.hash = hash;
+        content.dataLength = 100;
+        snprintf(content.text, sizeof(content.text), "card %u", id);
+        content.noteCount = 3;
+        return content;
+    }
+
+    bool cached(CardContentCache& cache, uint8_t id)
+    {
+        CardContent probe = entry(id, 0);
+        return cache.find(probe.uid, probe.uidLength) != nullptr;
+    }
+
+    struct Seen
+    {
+        NFCEventType type;
+        bool fromCache;
+        uint32_t afterPlacing;
+        uint32_t commands;          // Sent since detection, when the event came
+    };
+
+    struct Reader
+    {
+        PN532Emulator chip;
+        PN532Transport link;
+        CardContentCache contents;
+        uint32_t placedMicros;
+        uint32_t sinceDetect;
+        std::vector<Seen> seen;
+    };
+
+    uint32_t readerMicros(void* context)
+    {
+        Reader& reader = *static_cast<Reader*>(context);
+        return reader.link.micros(reader.link.context);
+    }
+
+    bool readerWrite(void* context, const uint8_t* data, size_t length)
+    {
+        Reader& reader = *static_cast<Reader*>(context);
+        if (!PN532Frame::isAck(data, length))
+        {
+            bool detect = length > 6 && data[6] == PN532Frame::IN_LIST_PASSIVE_TARGET;
+            reader.sinceDetect = detect ? 0 : reader.sinceDetect + 1;
+        }
+        return reader.link.write(reader.link.context, data, length);
+    }
+
+    bool readerReady(void* context)
+    {
+        Reader& reader = *static_cast<Reader*>(context);
+        return reader.link.ready(reader.link.context);
+    }
+
+    bool readerRead(void* context, uint8_t* data, size_t length)
+    {
+        Reader& reader = *static_cast<Reader*>(context);
+        return reader.link.read(reader.link.context, data, length);
+    }
+
+    /**
+     * @brief What NFCManager does: store what a read worked out, react to the rest
+     */
+    void handleEvent(void* context, const NFCEvent& event)
+    {
+        Reader& reader = *static_cast<Reader*>(context);
+        if (event.type == NFCEventType::CARD_REMOVED) return;
+
+        Seen seen = { event.type, event.content != nullptr, reader.chip.micros() - reader.placedMicros, reader.sinceDetect };
+        reader.seen.push_back(seen);
+        if (event.content != nullptr) return;
+
+        const NFCCard& card = *event.card;
+        CardContent content;
+        memset(&content, 0, sizeof(content));
+        memcpy(content.uid, card.uid, card.uidLength);
+        content.uidLength = card.uidLength;
+        content.hash = card.hash;
+        content.dataLength = card.dataLength;
+        memcpy(content.text, card.text, sizeof(content.text));
+        reader.contents.store(content);
+    }
+
+    void makeTag(NFCDump& dump, uint8_t id, uint16_t pages, uint16_t userBytes)
+    {
+        memset(&dump, 0, sizeof(dump));
+        dump.kind = NFCDumpKind::NTAG;
+        dump.uidLength = 7;
+        for (uint8_t i = 0; i < dump.uidLength; i++) dump.uid[i] = static_cast<uint8_t>(id + i);
+        dump.atqa[1] = 0x44;
+        dump.length = static_cast<uint16_t>(pages * 4);
+
+        uint8_t* capability = dump.memory + 3 * 4;
+        capability[0] = 0xE1;
+        capability[1] = 0x10;
+        capability[2] = static_cast<uint8_t>(userBytes / 8);
+        for (uint16_t i = 0; i < userBytes; i++) dump.memory[16 + i] = static_cast<uint8_t>('a' + i % 26);
+    }
+
+    void tap(Reader& reader, NFCEngine& engine, const NFCDump& dump)
+    {
+        reader.chip.place(&dump);
+        reader.placedMicros = reader.chip.micros();
+        while (reader.chip.micros() - reader.placedMicros < TAP_MICROS)
+        {
+            reader.chip.advance(LOOP_MICROS);
+            engine.update();
+        }
+        reader.chip.place(nullptr);
+        uint32_t start = reader.chip.micros();
+        while (reader.chip.micros() - start < TAP_MICROS)
+        {
+            reader.chip.advance(LOOP_MICROS);
+            engine.update();
+        }
+    }
+
+    Reader reader;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_least_recently_used_entry_gives_way()
+{
+    CardContentCache cache;
+    for (uint8_t i = 0; i < CardContentCache::CAPACITY; i++) cache.store(entry(i * 16, i));
+    TEST_ASSERT_EQUAL_UINT8(CardContentCache::CAPACITY, cache.size());
+    TEST_ASSERT_EQUAL_UINT32(0, cache.stats().evictions);
+
+    // Finding 0 makes it the most recent, so 16 is the oldest
+    TEST_ASSERT_TRUE(cached(cache, 0));
+    cache.store(entry(200, 9));
+    TEST_ASSERT_EQUAL_UINT32(1, cache.stats().evictions);
+    TEST_ASSERT_FALSE(cached(cache, 16));
+    TEST_ASSERT_TRUE(cached(cache, 0));
+
+    // Replacing an entry evicts nothing
+    cache.store(entry(200, 10));
+    TEST_ASSERT_EQUAL_UINT32(1, cache.stats().evictions);
+    TEST_ASSERT_EQUAL_UINT8(CardContentCache::CAPACITY, cache.size());
+}
+
+void test_validation_and_invalidation_drop_entries()
+{
+    CardContentCache cache;
+    cache.store(entry(200, 10));
+    cache.store(entry(0, 0));
+
+    // Same hash and length confirms; anything else drops the entry
+    CardContent card = entry(200, 10);
+    TEST_ASSERT_TRUE(cache.validate(card.uid, card.uidLength, 10, 100));
+    TEST_ASSERT_FALSE(cache.validate(card.uid, card.uidLength, 10, 99));
+    TEST_ASSERT_FALSE(cached(cache, 200));
+    TEST_ASSERT_EQUAL_UINT32(1, cache.stats().confirmed);
+    TEST_ASSERT_EQUAL_UINT32(1, cache.stats().stale);
+
+    CardContent other = entry(0, 0);
+    TEST_ASSERT_TRUE(cache.invalidate(other.uid, other.uidLength));
+    TEST_ASSERT_FALSE(cache.invalidate(other.uid, other.uidLength));
+    TEST_ASSERT_EQUAL_UINT8(0, cache.size());
+}
+
+void test_entries_and_their_order_survive_save_and_load()
+{
+    MemoryStorage card;
+    CardContentCache cache;
+    for (uint8_t i = 0; i < CardContentCache::CAPACITY - 2; i++) cache.store(entry(i * 16, i));
+    TEST_ASSERT_TRUE(cached(cache, 32));
+    TEST_ASSERT_TRUE(cache.isDirty());
+    TEST_ASSERT_TRUE(cache.save(card.backend(), CACHE_FILE));
+    TEST_ASSERT_FALSE(cache.isDirty());
+
+    CardContentCache loaded;
+    TEST_ASSERT_TRUE(loaded.load(card.backend(), CACHE_FILE));
+    TEST_ASSERT_EQUAL_UINT8(CardContentCache::CAPACITY - 2, loaded.size());
+    CardContent probe = entry(32, 2);
+    const CardContent* got = loaded.find(probe.uid, probe.uidLength);
+    TEST_ASSERT_NOT_NULL(got);
+    TEST_ASSERT_EQUAL_STRING("card 32", got->text);
+    TEST_ASSERT_EQUAL_UINT32(2, got->hash);
+
+    // Filling up evicts in saved order: 0 was the oldest, as 32 had been touched
+    for (uint8_t i = 0; i < 3; i++) loaded.store(entry(220 + i * 10, 0));
+    TEST_ASSERT_FALSE(cached(loaded, 0));
+    TEST_ASSERT_TRUE(cached(loaded, 32));
+
+    char message[64];
+    snprintf(message, sizeof(message), "entry %u bytes, file %u bytes",
+             static_cast<unsigned>(sizeof(CardContent)), static_cast<unsigned>(card.files[CACHE_FILE].size()));
+    TEST_MESSAGE(message);
+}
+
+void test_damaged_missing_or_interrupted_files_load_nothing()
+{
+    MemoryStorage card;
+    CardContentCache cache;
+    cache.store(entry(16, 1));
+    TEST_ASSERT_TRUE(cache.save(card.backend(), CACHE_FILE));
+    HostTest::Bytes saved = card.files[CACHE_FILE];
+
+    card.files[CACHE_FILE][40] ^= 1;
+    CardContentCache damaged;
+    damaged.store(entry(48, 3));
+    TEST_ASSERT_FALSE(damaged.load(card.backend(), CACHE_FILE));
+    TEST_ASSERT_EQUAL_UINT8(0, damaged.size());
+    TEST_ASSERT_FALSE(damaged.load(card.backend(), "/missing"));
+
+    // Power lost part way through a save leaves the old file whole
+    card.files[CACHE_FILE] = saved;
+    cache.store(entry(64, 4));
+    card.powerLossAfter(0);
+    TEST_ASSERT_FALSE(cache.save(card.backend(), CACHE_FILE));
+    card.restorePower();
+    CardContentCache reloaded;
+    TEST_ASSERT_TRUE(reloaded.load(card.backend(), CACHE_FILE));
+    TEST_ASSERT_EQUAL_UINT8(1, reloaded.size());
+    TEST_ASSERT_TRUE(cached(reloaded, 16));
+}
+
+void test_known_cards_are_announced_before_their_read()
+{
+    NFCDump first;
+    NFCDump rewritten;
+    NFCDump large;
+    makeTag(first, 0x10, 135, 496);
+    rewritten = first;
+    rewritten.memory[100 * 4 + 2] ^= 0x20;
+    makeTag(large, 0x20, 231, 872);
+
+    reader.link = reader.chip.transport();
+    PN532Transport transport = { readerMicros, readerWrite, readerReady, readerRead, &reader };
+    NFCEngine engine(transport, handleEvent, &reader);
+    engine.setContentCache(&reader.contents);
+    engine.start();
+
+    tap(reader, engine, first);
+    tap(reader, engine, first);
+    tap(reader, engine, rewritten);
+    tap(reader, engine, large);
+    tap(reader, engine, large);
+
+    const std::vector<Seen>& seen = reader.seen;
+    TEST_ASSERT_EQUAL_UINT32(6, seen.size());
+    TEST_ASSERT_FALSE(seen[0].fromCache);
+    TEST_ASSERT_TRUE(seen[0].afterPlacing > MIN_READ_REACTION);
+
+    // Announced on the UID alone, then confirmed by the read
+    TEST_ASSERT_TRUE(seen[1].fromCache);
+    TEST_ASSERT_EQUAL_UINT32(0, seen[1].commands);
+    TEST_ASSERT_TRUE(seen[1].afterPlacing < MAX_CACHED_REACTION);
+
+    // Announced, then caught as rewritten on the same tap
+    TEST_ASSERT_TRUE(seen[2].fromCache);
+    TEST_ASSERT_TRUE(seen[3].type == NFCEventType::CARD_CHANGED);
+    TEST_ASSERT_FALSE(seen[3].fromCache);
+
+    TEST_ASSERT_FALSE(seen[4].fromCache);
+    TEST_ASSERT_TRUE(seen[5].fromCache);
+    TEST_ASSERT_TRUE(seen[5].afterPlacing < MAX_CACHED_REACTION);
+
+    const CardContentStats& stats = reader.contents.stats();
+    TEST_ASSERT_EQUAL_UINT32(2, stats.confirmed);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.stale);
+    TEST_ASSERT_EQUAL_UINT32(5, engine.stats().arrivals);
+
+    char message[128];
+    snprintf(message, sizeof(message), "NTAG215 reacts in %.1f ms cached, %.1f ms read; NTAG216 %.1f / %.1f ms; hit rate %u%%",
+             seen[1].afterPlacing / 1e3, seen[0].afterPlacing / 1e3, seen[5].afterPlacing / 1e3,
+             seen[4].afterPlacing / 1e3, reader.contents.hitRate());
+    TEST_MESSAGE(message);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_least_recently_used_entry_gives_way);
+    RUN_TEST(test_validation_and_invalidation_drop_entries);
+    RUN_TEST(test_entries_and_their_order_survive_save_and_load);
+    RUN_TEST(test_damaged_missing_or_interrupted_files_load_nothing);
+    RUN_TEST(test_known_cards_are_announced_before_their_read);
+    return UNITY_END();
+}
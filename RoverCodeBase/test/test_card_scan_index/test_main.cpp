@@ -0,0 +1,238 @@
+/**
+ * @file test_main.cpp
+ * @brief CardScanIndex exactness, crash recovery, Bloom filter rate and lookup cost
+ *
+ * The index runs on the in-memory card from MemoryStorage, so a crash is a
+ * copy of the file map taken before the index is closed. Card IDs come from
+ * a fixed LCG; the benchmark reports host time per lookup and, more to the
+ * point on the rover, sector reads per lookup.
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include <set>
+#include <vector>
+#include "MemoryStorage.h"
+#include "PrefrontalCortex/CardScanIndex.h"
+
+using namespace PrefrontalCortex;
+using HostTest::MemoryStorage;
+
+namespace
+{
+    const char* const INDEX_PATH = "/nfc/scans.idx";
+    const char* const WAL_PATH = "/nfc/scans.wal";
+    const char* const TEMP_PATH = "/nfc/scans.idx.tmp";
+    const size_t SMALL_BLOOM = 16384;
+    const size_t BENCH_BLOOM = 131072;          // About 10 bits per ID at 100k
+    const uint32_t BENCH_IDS = 100000;
+    const double MAX_FALSE_POSITIVE_PERCENT = 1.5;
+    const double MAX_HIT_SECTOR_READS = 1.05;
+
+    uint32_t lcgState = 7;
+
+    uint32_t nextId()
+    {
+        lcgState = lcgState * 1664525u + 1013904223u;
+        return lcgState ^ (lcgState >> 15);
+    }
+
+    std::vector<uint32_t> uniqueIds(uint32_t count, std::set<uint32_t>& seen)
+    {
+        std::vector<uint32_t> ids;
+        while (ids.size() < count)
+        {
+            uint32_t id = nextId();
+            if (seen.insert(id).second) ids.push_back(id);
+        }
+        return ids;
+    }
+
+    double elapsedMicros(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_record_and_contains_are_exact()
+{
+    MemoryStorage card;
+    CardScanIndex index(card.backend(), malloc, free);
+    TEST_ASSERT_TRUE(index.open(INDEX_PATH, WAL_PATH, SMALL_BLOOM));
+
+    TEST_ASSERT_FALSE(index.contains(42));
+    TEST_ASSERT_TRUE(index.record(42));
+    TEST_ASSERT_FALSE(index.record(42));
+    TEST_ASSERT_TRUE(index.contains(42));
+    TEST_ASSERT_TRUE(index.record(0));
+    TEST_ASSERT_TRUE(index.contains(0));
+
+    // Thousands of IDs force several growths; record() must still know what is new
+    std::set<uint32_t> truth = { 0, 42 };
+    for (int i = 0; i < 5000; i++)
+    {
+        uint32_t id = nextId();
+        TEST_ASSERT_EQUAL(truth.insert(id).second, index.record(id));
+    }
+    CardScanStats stats = index.stats();
+    TEST_ASSERT_EQUAL_UINT32(truth.size(), stats.entries);
+    TEST_ASSERT_GREATER_THAN(0, stats.growths);
+    for (uint32_t id : truth) TEST_ASSERT_TRUE(index.contains(id));
+}
+
+void test_crash_replays_the_log()
+{
+    MemoryStorage card;
+    std::set<uint32_t> truth;
+    std::map<std::string, HostTest::Bytes> crashed;
+    {
+        CardScanIndex index(card.backend(), malloc, free);
+        TEST_ASSERT_TRUE(index.open(INDEX_PATH, WAL_PATH, SMALL_BLOOM));
+        for (int i = 0; i < 1000; i++)
+        {
+            uint32_t id = nextId();
+            truth.insert(id);
+            index.record(id);
+        }
+        TEST_ASSERT_GREATER_THAN(0, index.stats().pending);
+
+        // Power goes before the destructor can merge what is only in the log
+        crashed = card.files;
+    }
+    card.files = crashed;
+
+    // A half-written last record is ignored
+    card.files[WAL_PATH].push_back(0x01);
+    card.files[WAL_PATH].push_back(0x02);
+    card.files[WAL_PATH].push_back(0x03);
+
+    CardScanIndex index(card.backend(), malloc, free);
+    TEST_ASSERT_TRUE(index.open(INDEX_PATH, WAL_PATH, SMALL_BLOOM));
+    TEST_ASSERT_EQUAL_UINT32(truth.size(), index.stats().entries);
+    TEST_ASSERT_EQUAL_UINT8(0, index.stats().pending);
+    for (uint32_t id : truth) TEST_ASSERT_TRUE(index.contains(id));
+}
+
+void test_interrupted_growth_recovers()
+{
+    MemoryStorage card;
+    std::set<uint32_t> truth;
+    {
+        CardScanIndex index(card.backend(), malloc, free);
+        TEST_ASSERT_TRUE(index.open(INDEX_PATH, WAL_PATH, SMALL_BLOOM));
+        for (int i = 0; i < 3000; i++)
+        {
+            uint32_t id = nextId();
+            truth.insert(id);
+            index.record(id);
+        }
+    }
+
+    // A temporary table next to a complete index is an unfinished growth: dropped
+    card.files[TEMP_PATH] = HostTest::Bytes(4, 0x55);
+    {
+        CardScanIndex index(card.backend(), malloc, free);
+        TEST_ASSERT_TRUE(index.open(INDEX_PATH, WAL_PATH, SMALL_BLOOM));
+        for (uint32_t id : truth) TEST_ASSERT_TRUE(index.contains(id));
+    }
+    TEST_ASSERT_TRUE(card.files.find(TEMP_PATH) == card.files.end());
+
+    // Cut off after the old table was removed: the finished temporary is adopted
+    card.files[TEMP_PATH] = card.files[INDEX_PATH];
+    card.files.erase(INDEX_PATH);
+    CardScanIndex index(card.backend(), malloc, free);
+    TEST_ASSERT_TRUE(index.open(INDEX_PATH, WAL_PATH, SMALL_BLOOM));
+    for (uint32_t id : truth) TEST_ASSERT_TRUE(index.contains(id));
+}
+
+void test_corrupt_header_is_refused()
+{
+    MemoryStorage card;
+    {
+        CardScanIndex index(card.backend(), malloc, free);
+        TEST_ASSERT_TRUE(index.open(INDEX_PATH, WAL_PATH, SMALL_BLOOM));
+        index.record(42);
+    }
+    card.files[INDEX_PATH][8] ^= 0x55;
+
+    CardScanIndex index(card.backend(), malloc, free);
+    TEST_ASSERT_FALSE(index.open(INDEX_PATH, WAL_PATH, SMALL_BLOOM));
+    TEST_ASSERT_FALSE(index.isOpen());
+    TEST_ASSERT_FALSE(index.contains(42));
+}
+
+void test_bloom_rate_and_lookup_cost_at_100k()
+{
+    MemoryStorage card;
+    std::set<uint32_t> seen;
+    std::vector<uint32_t> ids = uniqueIds(BENCH_IDS, seen);
+    {
+        CardScanIndex index(card.backend(), malloc, free);
+        TEST_ASSERT_TRUE(index.open(INDEX_PATH, WAL_PATH, BENCH_BLOOM));
+        card.resetCounters();
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t id : ids) index.record(id);
+        index.checkpoint();
+        double micros = elapsedMicros(start);
+
+        char message[128];
+        snprintf(message, sizeof(message), "%u inserts: %.1f ms, %.2f writes per ID, %u buckets, %u growths",
+                 BENCH_IDS, micros / 1000, static_cast<double>(card.writes) / BENCH_IDS,
+                 index.stats().buckets, index.stats().growths);
+        TEST_MESSAGE(message);
+    }
+
+    CardScanIndex index(card.backend(), malloc, free);
+    auto start = std::chrono::steady_clock::now();
+    TEST_ASSERT_TRUE(index.open(INDEX_PATH, WAL_PATH, BENCH_BLOOM));
+    double openMicros = elapsedMicros(start);
+    TEST_ASSERT_EQUAL_UINT32(BENCH_IDS, index.stats().entries);
+
+    CardScanStats before = index.stats();
+    start = std::chrono::steady_clock::now();
+    for (uint32_t id : ids) TEST_ASSERT_TRUE(index.contains(id));
+    double hitMicros = elapsedMicros(start);
+    CardScanStats afterHits = index.stats();
+
+    std::vector<uint32_t> strangers = uniqueIds(BENCH_IDS, seen);
+    uint32_t falsePositives = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint32_t id : strangers)
+    {
+        if (index.contains(id)) falsePositives++;
+    }
+    double missMicros = elapsedMicros(start);
+    CardScanStats afterMisses = index.stats();
+
+    double hitReads = static_cast<double>(afterHits.sectorReads - before.sectorReads) / BENCH_IDS;
+    double missReads = static_cast<double>(afterMisses.sectorReads - afterHits.sectorReads) / BENCH_IDS;
+    double bloomPassPercent = 100.0 - 100.0 * (afterMisses.bloomRejects - afterHits.bloomRejects) / BENCH_IDS;
+
+    char message[192];
+    snprintf(message, sizeof(message),
+             "open %.1f ms; hit %.2f us, %.3f reads; miss %.2f us, %.4f reads, Bloom passes %.2f%% of strangers",
+             openMicros / 1000, hitMicros / BENCH_IDS, hitReads, missMicros / BENCH_IDS, missReads, bloomPassPercent);
+    TEST_MESSAGE(message);
+
+    // The Bloom filter may let a stranger through, but the table never claims one
+    TEST_ASSERT_EQUAL_UINT32(0, falsePositives);
+    TEST_ASSERT_TRUE(bloomPassPercent < MAX_FALSE_POSITIVE_PERCENT);
+    TEST_ASSERT_TRUE(hitReads <= MAX_HIT_SECTOR_READS);
+    TEST_ASSERT_TRUE(missReads < MAX_FALSE_POSITIVE_PERCENT / 100 * MAX_HIT_SECTOR_READS);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_record_and_contains_are_exact);
+    RUN_TEST(test_crash_replays_the_log);
+    RUN_TEST(test_interrupted_growth_recovers);
+    RUN_TEST(test_corrupt_header_is_refused);
+    RUN_TEST(test_bloom_rate_and_lookup_cost_at_100k);
+    return UNITY_END();
+}
@@ -0,0 +1,324 @@
+/**
+ * @file test_main.cpp
+ * @brief DirectoryWalker order, limits and resume; FileIndex rebuild, notes and persistence
+ *
+ * Both run over MemoryStorage holding a 10k-track library, a few NFC dumps,
+ * a tree deeper than the walker goes and one over-long name. Listings are
+ * positioned by entry index, as on the FAT driver, so save()/resume() is
+ * exercised the way the card would.
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <set>
+#include <string>
+#include <vector>
+#include "MemoryStorage.h"
+#include "PrefrontalCortex/DirectoryWalker.h"
+#include "PrefrontalCortex/FileIndex.h"
+
+using namespace PrefrontalCortex;
+using HostTest::Bytes;
+using HostTest::MemoryStorage;
+
+namespace
+{
+    const uint16_t TRACKS = 10000;
+    const uint8_t DUMPS = 50;
+    const uint32_t WALKED = 3 + TRACKS + DUMPS + 7;         // Listing stops at /deep/a/b/c/d/e/f/g
+    const uint32_t DIRECTORY_OPENS = 1 + 2 + 7;             // The root, music, nfc, and deep down to f
+    const char* const INDEX_PATH = "/files.idx";
+    const uint32_t CAPACITY = 16384;
+    const uint32_t LOOKUPS = 200000;
+    const uint8_t RESUME_EVERY = 37;
+    const uint8_t BENCH_WALKS = 20;
+
+    std::string trackPath(uint32_t i)
+    {
+        char path[40];
+        snprintf(path, sizeof(path), "/music/track%05u.mp3", i);
+        return path;
+    }
+
+    void makeLibrary(MemoryStorage& card)
+    {
+        for (uint16_t i = 0; i < TRACKS; i++) card.files[trackPath(i)] = Bytes(i % 7, 'x');
+        for (uint8_t i = 0; i < DUMPS; i++)
+        {
+            char path[32];
+            snprintf(path, sizeof(path), "/nfc/card%02u.nfc", i);
+            card.files[path] = Bytes(100, 'n');
+        }
+        card.files["/deep/a/b/c/d/e/f/g/h/i/too_deep.txt"] = Bytes(1, 'd');
+        card.files["/music/" + std::string(70, 'L') + ".wav"] = Bytes(1, 'l');
+    }
+
+    std::vector<std::string> walkAll(DirectoryWalker& walker)
+    {
+        std::vector<std::string> paths;
+        WalkEntry entry;
+        TEST_ASSERT_TRUE(walker.open("/"));
+        while (walker.next(entry)) paths.push_back(entry.path);
+        return paths;
+    }
+
+    /**
+     * @brief The old listDir() shape: recursion and a std::string per entry
+     */
+    uint32_t listRecursively(const DirectoryBackend& backend, const std::string& path)
+    {
+        DirectoryBackend::Handle directory = backend.open(backend.context, path.c_str());
+        if (directory == nullptr) return 0;
+        uint32_t count = 0;
+        DirectoryEntry entry;
+        while (backend.next(backend.context, directory, &entry, false))
+        {
+            std::string child = (path == "/" ? path : path + "/") + entry.name;
+            count++;
+            if (entry.isDirectory) count += listRecursively(backend, child);
+        }
+        backend.close(backend.context, directory);
+        return count;
+    }
+
+    void rebuild(FileIndex& index, uint32_t budget)
+    {
+        for (uint32_t step = 0; step < CAPACITY && !index.isReady(); step++) index.update(0, budget);
+    }
+
+    double elapsedMicros(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_walk_lists_everything_within_limits()
+{
+    MemoryStorage card;
+    makeLibrary(card);
+    DirectoryWalker walker(card.directoryBackend());
+
+    std::set<std::string> seen;
+    uint8_t maxDepth = 0;
+    WalkEntry entry;
+    TEST_ASSERT_TRUE(walker.open("/"));
+    while (walker.next(entry))
+    {
+        seen.insert(entry.path);
+        if (entry.depth > maxDepth) maxDepth = entry.depth;
+    }
+    TEST_ASSERT_EQUAL_UINT32(WALKED, seen.size());
+    TEST_ASSERT_EQUAL_UINT8(DirectoryWalker::MAX_DEPTH - 1, maxDepth);
+    TEST_ASSERT_TRUE(seen.count("/music/track09999.mp3") == 1);
+    TEST_ASSERT_TRUE(seen.count("/nfc/card49.nfc") == 1);
+    TEST_ASSERT_TRUE(seen.count("/deep/a/b/c/d/e/f/g") == 1);
+    TEST_ASSERT_TRUE(seen.count("/deep/a/b/c/d/e/f/g/h") == 0);
+
+    // The over-long name is skipped and counted, never truncated
+    TEST_ASSERT_EQUAL_UINT32(1, walker.skipped());
+
+    TEST_ASSERT_TRUE(walker.open("/", 1));
+    uint32_t top = 0;
+    while (walker.next(entry)) top++;
+    TEST_ASSERT_EQUAL_UINT32(3, top);
+
+    TEST_ASSERT_TRUE(walker.open("/"));
+    uint32_t withoutMusic = 0;
+    while (walker.next(entry))
+    {
+        if (entry.isDirectory && strcmp(entry.name, "music") == 0) walker.skipChildren();
+        withoutMusic++;
+    }
+    TEST_ASSERT_EQUAL_UINT32(WALKED - TRACKS, withoutMusic);
+    TEST_ASSERT_FALSE(walker.open("/missing"));
+}
+
+void test_saved_walk_resumes_in_order()
+{
+    MemoryStorage card;
+    makeLibrary(card);
+    DirectoryWalker walker(card.directoryBackend());
+    std::vector<std::string> straight = walkAll(walker);
+
+    std::vector<std::string> resumed;
+    DirectoryWalker::Cursor cursor;
+    WalkEntry entry;
+    TEST_ASSERT_TRUE(walker.open("/"));
+    bool more = true;
+    while (more)
+    {
+        for (uint8_t i = 0; i < RESUME_EVERY && (more = walker.next(entry)); i++) resumed.push_back(entry.path);
+        if (!more) break;
+
+        // Paused walks hold no directories open, and can be picked up by another walker
+        TEST_ASSERT_TRUE(walker.save(cursor));
+        TEST_ASSERT_FALSE(walker.isOpen());
+        DirectoryWalker other(card.directoryBackend());
+        TEST_ASSERT_TRUE(other.resume(cursor));
+        TEST_ASSERT_TRUE(other.save(cursor));
+        TEST_ASSERT_TRUE(walker.resume(cursor));
+    }
+    TEST_ASSERT_EQUAL_UINT32(straight.size(), resumed.size());
+    TEST_ASSERT_TRUE(straight == resumed);
+}
+
+void test_walk_throughput()
+{
+    MemoryStorage card;
+    makeLibrary(card);
+    DirectoryBackend backend = card.directoryBackend();
+    DirectoryWalker walker(backend);
+
+    card.resetCounters();
+    uint32_t walked = 0;
+    auto start = std::chrono::steady_clock::now();
+    WalkEntry entry;
+    for (uint8_t r = 0; r < BENCH_WALKS; r++)
+    {
+        TEST_ASSERT_TRUE(walker.open("/"));
+        while (walker.next(entry)) walked++;
+    }
+    double walkMicros = elapsedMicros(start);
+    uint32_t opensPerWalk = card.directoryOpens / BENCH_WALKS;
+
+    uint32_t listed = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint8_t r = 0; r < BENCH_WALKS; r++) listed += listRecursively(backend, "/");
+    double recursiveMicros = elapsedMicros(start);
+
+    char message[160];
+    snprintf(message, sizeof(message), "walker %.0f k entries/s with %u directory opens per walk; recursive listing %.0f k entries/s",
+             walked / walkMicros * 1000, opensPerWalk, listed / recursiveMicros * 1000);
+    TEST_MESSAGE(message);
+
+    // Only opening a directory costs anything beyond the entry itself
+    TEST_ASSERT_EQUAL_UINT32(DIRECTORY_OPENS, opensPerWalk);
+    TEST_ASSERT_EQUAL_UINT32(WALKED * BENCH_WALKS, walked);
+}
+
+void test_index_rebuilds_and_answers_lookups()
+{
+    MemoryStorage card;
+    makeLibrary(card);
+    FileIndex index(card.backend(), card.directoryBackend(), malloc, free);
+    TEST_ASSERT_TRUE(index.open(INDEX_PATH, "/", CAPACITY, 0));
+    TEST_ASSERT_FALSE(index.isReady());
+
+    uint32_t steps = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (!index.isReady() && steps < CAPACITY)
+    {
+        index.update(0, 64);
+        steps++;
+    }
+    double rebuildMicros = elapsedMicros(start);
+    FileIndexStats stats = index.stats();
+    TEST_ASSERT_TRUE(index.isReady());
+    TEST_ASSERT_EQUAL_UINT32(WALKED, stats.entries);
+
+    FileIndexEntry entry;
+    TEST_ASSERT_TRUE(index.find("/music/track01234.mp3", entry));
+    TEST_ASSERT_EQUAL_UINT32(1234 % 7, entry.size);
+    TEST_ASSERT_TRUE(entry.kind == FileKind::AUDIO);
+    TEST_ASSERT_FALSE(index.find("/music/nope.mp3", entry));
+    TEST_ASSERT_TRUE(index.find("/music/", entry));
+    TEST_ASSERT_TRUE(entry.kind == FileKind::DIRECTORY);
+    TEST_ASSERT_EQUAL_UINT32(TRACKS, index.count("/music", FileKind::AUDIO));
+    TEST_ASSERT_EQUAL_UINT32(DUMPS, index.count("/nfc/", FileKind::NFC_DUMP));
+
+    volatile uint32_t hits = 0;
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < LOOKUPS; i++)
+    {
+        if (index.find(trackPath(i % TRACKS).c_str(), entry)) hits = hits + 1;
+    }
+    double lookupMicros = elapsedMicros(start);
+    TEST_ASSERT_EQUAL_UINT32(LOOKUPS, hits);
+
+    char message[128];
+    snprintf(message, sizeof(message), "rebuild of %u entries: %u steps, %.1f ms; lookup %.0f ns including the path",
+             stats.entries, steps, rebuildMicros / 1000, lookupMicros * 1000 / LOOKUPS);
+    TEST_MESSAGE(message);
+}
+
+void test_notes_keep_the_index_current_and_persisted()
+{
+    MemoryStorage card;
+    makeLibrary(card);
+    FileIndexEntry entry;
+    {
+        FileIndex index(card.backend(), card.directoryBackend(), malloc, free);
+        TEST_ASSERT_TRUE(index.open(INDEX_PATH, "/", CAPACITY, 0));
+        rebuild(index, 64);
+
+        card.files["/music/new.wav"] = Bytes(42, 'w');
+        index.noteWritten("/music/new.wav", 42, 1, false);
+        card.files.erase(trackPath(0));
+        index.noteRemoved(trackPath(0).c_str());
+        index.update(1000, 64);
+        TEST_ASSERT_TRUE(index.find("/music/new.wav", entry));
+        TEST_ASSERT_EQUAL_UINT32(42, entry.size);
+        TEST_ASSERT_FALSE(index.find(trackPath(0).c_str(), entry));
+
+        // The saved header already says a change is pending, so a crash now means a rebuild
+        {
+            FileIndex probe(card.backend(), card.directoryBackend(), malloc, free);
+            probe.open(INDEX_PATH, "/", CAPACITY, 0);
+            TEST_ASSERT_FALSE(probe.isReady());
+        }
+
+        index.update(1000 + FileIndex::DEFAULT_MAX_DELAY_MS, 64);
+        TEST_ASSERT_TRUE(index.seal(777));
+    }
+
+    {
+        FileIndex index(card.backend(), card.directoryBackend(), malloc, free);
+        TEST_ASSERT_TRUE(index.open(INDEX_PATH, "/", CAPACITY, 777));
+        TEST_ASSERT_TRUE(index.isReady());
+        TEST_ASSERT_EQUAL_UINT32(0, index.stats().rebuilds);
+        TEST_ASSERT_TRUE(index.find("/music/new.wav", entry));
+        TEST_ASSERT_EQUAL_UINT32(42, entry.size);
+    }
+
+    // Usage that no longer matches the seal means the card was edited elsewhere
+    FileIndex index(card.backend(), card.directoryBackend(), malloc, free);
+    TEST_ASSERT_TRUE(index.open(INDEX_PATH, "/", CAPACITY, 778));
+    TEST_ASSERT_FALSE(index.isReady());
+    rebuild(index, 512);
+    TEST_ASSERT_TRUE(index.isReady());
+
+    // A note lost to a full queue forces a rebuild rather than a silently stale index
+    for (uint32_t i = 0; i <= FileIndex::CHANGE_DEPTH; i++) index.noteWritten("/music/x.wav", i, 0, false);
+    index.update(1, 64);
+    TEST_ASSERT_EQUAL_UINT32(1, index.stats().changesDropped);
+    TEST_ASSERT_FALSE(index.isReady());
+}
+
+void test_index_out_of_capacity_is_never_ready()
+{
+    MemoryStorage card;
+    makeLibrary(card);
+    FileIndex index(card.backend(), card.directoryBackend(), malloc, free);
+    TEST_ASSERT_TRUE(index.open("/small.idx", "/", 100, 0));
+    for (uint16_t i = 0; i < 1000 && !index.isReady(); i++) index.update(0, 64);
+    TEST_ASSERT_FALSE(index.isReady());
+    TEST_ASSERT_TRUE(index.stats().entries <= 100);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_walk_lists_everything_within_limits);
+    RUN_TEST(test_saved_walk_resumes_in_order);
+    RUN_TEST(test_walk_throughput);
+    RUN_TEST(test_index_rebuilds_and_answers_lookups);
+    RUN_TEST(test_notes_keep_the_index_current_and_persisted);
+    RUN_TEST(test_index_out_of_capacity_is_never_ready);
+    return UNITY_END();
+}
@@ -0,0 +1,536 @@
+/**
+ * @file test_main.cpp
+ * @brief IREncoder timings, IRCodeDatabase files, and how fast codes are streamed and sent
+ *
+ * Frames are decoded back from their RMT items: NEC, Sony and Samsung by
+ * pulse distance or width, RC5 and RC6 slot by slot. Databases are written
+ * to memory storage, then damaged, truncated and cut short by power loss.
+ * The benchmark reads and encodes a large database on host and works out
+ * how long the built-in set takes on air with and without the old delay.
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <utility>
+#include <vector>
+#include "MemoryStorage.h"
+#include "PsychicCortex/IRCodeDatabase.h"
+#include "PsychicCortex/IREncoder.h"
+
+using namespace PsychicCortex;
+using HostTest::MemoryStorage;
+
+namespace
+{
+    const char* CODES_FILE = "/ir/codes.bin";
+    const uint8_t BUILTIN_REGIONS = 4;
+    const uint16_t BUILTIN_REGION_CODES = 100;
+    const uint32_t BUILTIN_CODES = BUILTIN_REGIONS * BUILTIN_REGION_CODES;
+    const uint32_t OLD_SEND_DELAY_MICROS = 100000;
+    const uint32_t BENCHMARK_CODES = 100000;
+    const int BENCHMARK_PASSES = 5;
+    const double MIN_CODES_PER_SECOND = 100000;
+    const uint32_t TOLERANCE = 2;
+
+    typedef std::vector<std::pair<bool, uint32_t>> Halves;
+
+    /**
+     * @brief The rover's built-in set, laid out as IRManager::builtinCode does
+     */
+    bool builtinCode(void*, uint32_t index, IRCode& code)
+    {
+        if (index >= BUILTIN_CODES) return false;
+
+        uint32_t value = index % BUILTIN_REGION_CODES;
+        code.region = static_cast<uint8_t>(index / BUILTIN_REGION_CODES);
+        code.repeats = 0;
+        code.bits = 32;
+        switch (code.region)
+        {
+            case 0:
+                code.protocol = IRProtocol::SONY;
+                code.repeats = 2;
+                code.bits = value < 60 ? 12 : 15;
+                code.payload = value < 20 ? value + 0x10 : value < 40 ? value + 0xA80 : value < 60 ? value + 0x240 : value;
+                break;
+
+            case 1:
+                code.protocol = IRProtocol::NEC;
+                code.payload = value < 50 ? 0x04FB0000UL + value : 0x10000000UL + value;
+                break;
+
+            case 2:
+                code.protocol = value % 2 ? IRProtocol::RC5 : IRProtocol::RC6;
+                code.bits = value % 2 ? 12 : 20;
+                code.payload = value;
+                break;
+
+            default:
+                code.protocol = IRProtocol::SAMSUNG;
+                code.payload = 0xE0E0 + value;
+                break;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Every protocol in turn over eight regions, leaving region 2 empty
+     */
+    bool sequenceCode(void* context, uint32_t index, IRCode& code)
+    {
+        uint32_t count = *static_cast<uint32_t*>(context);
+        code.region = static_cast<uint8_t>(index * 8 / count);
+        if (code.region == 2) code.region = 3;
+        code.protocol = static_cast<IRProtocol>(1 + index % 5);
+        switch (code.protocol)
+        {
+            case IRProtocol::SONY:
+            case IRProtocol::RC5:
+                code.bits = 12;
+                break;
+            case IRProtocol::RC6:
+                code.bits = 20;
+                break;
+            default:
+                code.bits = 32;
+                break;
+        }
+        code.repeats = code.protocol == IRProtocol::SONY ? 2 : 0;
+        code.payload = index & ((1u << (code.bits == 32 ? 31 : code.bits)) - 1);
+        return true;
+    }
+
+    bool backwardsCode(void*, uint32_t index, IRCode& code)
+    {
+        code.protocol = IRProtocol::NEC;
+        code.bits = 32;
+        code.repeats = 0;
+        code.region = index == 5 ? 0 : 1;
+        code.payload = index;
+        return true;
+    }
+
+    /**
+     * @brief Levels and durations of a frame, same-level halves joined and the end marker dropped
+     */
+    Halves halves(const IRFrame& frame)
+    {
+        Halves result;
+        for (uint16_t i = 0; i < frame.count; i++)
+        {
+            for (uint8_t half = 0; half < 2; half++)
+            {
+                uint16_t micros = IREncoder::duration(frame.items[i], half);
+                bool high = IREncoder::level(frame.items[i], half);
+                if (micros == 0)
+                {
+                    TEST_ASSERT_TRUE(i == frame.count - 1 && half == 1);
+                    continue;
+                }
+                if (!result.empty() && result.back().first == high) result.back().second += micros;
+                else result.push_back(std::make_pair(high, micros));
+            }
+        }
+        return result;
+    }
+
+    bool near(uint32_t micros, uint32_t expected)
+    {
+        return micros + TOLERANCE >= expected && micros <= expected + TOLERANCE;
+    }
+
+    /**
+     * @brief Decode one pulse-distance or pulse-width frame from halves[at], leaving at past its gap
+     */
+    uint32_t decodePulses(const Halves& halves, size_t& at, uint8_t bits, bool widthCoded, uint32_t& gap)
+    {
+        at += 2;
+        uint32_t value = 0;
+        for (uint8_t bit = 0; bit < bits; bit++)
+        {
+            uint32_t mark = halves[at].second;
+            uint32_t space = halves[at + 1].second;
+            at += 2;
+            value = (value << 1) | (widthCoded ? (mark > 900) : (space > 1000));
+            if (bit == bits - 1 && widthCoded)
+            {
+                gap = space;
+                at--;
+            }
+        }
+        if (!widthCoded)
+        {
+            at++;       // Footer mark
+            gap = halves[at].second;
+        }
+        at++;
+        return value;
+    }
+
+    /**
+     * @brief Manchester slots of unit micros for halves[from, to)
+     */
+    std::vector<bool> slots(const Halves& halves, size_t from, size_t to, uint32_t unit)
+    {
+        std::vector<bool> result;
+        for (size_t i = from; i < to; i++)
+        {
+            uint32_t count = (halves[i].second + unit / 2) / unit;
+            for (uint32_t k = 0; k < count; k++) result.push_back(halves[i].first);
+        }
+        return result;
+    }
+
+    IRCode makeCode(IRProtocol protocol, uint8_t bits, uint8_t repeats, uint8_t region, uint32_t payload)
+    {
+        IRCode code = { protocol, bits, repeats, region, payload };
+        return code;
+    }
+
+    MemoryStorage card;
+    IRFrame frame;
+}
+
+void setUp()
+{
+    card = MemoryStorage();
+    memset(&frame, 0, sizeof(frame));
+}
+
+void tearDown() {}
+
+void test_nec_frames_and_repeats()
+{
+    IRCode code = makeCode(IRProtocol::NEC, 32, 0, 1, 0x04FB0012);
+    TEST_ASSERT_TRUE(IREncoder::encode(code, frame));
+    Halves on = halves(frame);
+    TEST_ASSERT_EQUAL_UINT32(38000, frame.carrierHz);
+    TEST_ASSERT_EQUAL_UINT32(2 + 64 + 2, on.size());
+    TEST_ASSERT_TRUE(on[0].first);
+    TEST_ASSERT_EQUAL_UINT32(8960, on[0].second);
+    TEST_ASSERT_FALSE(on[1].first);
+    TEST_ASSERT_EQUAL_UINT32(4480, on[1].second);
+
+    size_t at = 0;
+    uint32_t gap = 0;
+    TEST_ASSERT_EQUAL_HEX32(0x04FB0012, decodePulses(on, at, 32, false, gap));
+    TEST_ASSERT_EQUAL_UINT32(108000, frame.micros);
+
+    // Repeats are the short frame: header mark, 2240 space, one mark
+    code.repeats = 2;
+    TEST_ASSERT_TRUE(IREncoder::encode(code, frame));
+    on = halves(frame);
+    TEST_ASSERT_EQUAL_UINT32(3 * 108000, frame.micros);
+    TEST_ASSERT_EQUAL_UINT32(8960, on[on.size() - 4].second);
+    TEST_ASSERT_EQUAL_UINT32(2240, on[on.size() - 3].second);
+    TEST_ASSERT_EQUAL_UINT32(560, on[on.size() - 2].second);
+}
+
+void test_sony_and_samsung_frames()
+{
+    IRCode code = makeCode(IRProtocol::SONY, 12, 2, 0, 0xA90);
+    TEST_ASSERT_TRUE(IREncoder::encode(code, frame));
+    Halves on = halves(frame);
+    TEST_ASSERT_EQUAL_UINT32(40000, frame.carrierHz);
+    TEST_ASSERT_EQUAL_UINT32(3 * 45000, frame.micros);
+
+    size_t at = 0;
+    uint32_t gap = 0;
+    for (int repeat = 0; repeat < 3; repeat++)
+    {
+        TEST_ASSERT_EQUAL_UINT32(2400, on[at].second);
+        TEST_ASSERT_EQUAL_HEX32(0xA90, decodePulses(on, at, 12, true, gap));
+        TEST_ASSERT_TRUE(gap >= 10000);
+    }
+    TEST_ASSERT_EQUAL_UINT32(on.size(), at);
+
+    code = makeCode(IRProtocol::SAMSUNG, 32, 0, 3, 0xE0E040BF);
+    TEST_ASSERT_TRUE(IREncoder::encode(code, frame));
+    on = halves(frame);
+    at = 0;
+    TEST_ASSERT_EQUAL_UINT32(4480, on[0].second);
+    TEST_ASSERT_EQUAL_UINT32(4480, on[1].second);
+    TEST_ASSERT_EQUAL_HEX32(0xE0E040BF, decodePulses(on, at, 32, false, gap));
+    TEST_ASSERT_EQUAL_UINT32(108000, frame.micros);
+}
+
+void test_rc5_slots_carry_both_start_bits()
+{
+    const uint32_t payloads[] = { 0x000, 0x005, 0xFFF, 0xA5C };
+    for (uint32_t payload : payloads)
+    {
+        IRCode code = makeCode(IRProtocol::RC5, 12, 0, 2, payload);
+        TEST_ASSERT_TRUE(IREncoder::encode(code, frame));
+        Halves on = halves(frame);
+        TEST_ASSERT_EQUAL_UINT32(36000, frame.carrierHz);
+        TEST_ASSERT_EQUAL_UINT32(113778, frame.micros);
+        for (size_t i = 0; i + 1 < on.size(); i++)
+        {
+            TEST_ASSERT_TRUE(near(on[i].second, 889) || near(on[i].second, 1778));
+        }
+
+        // 14 bits of T = 889 us; a one is space then mark, and the leading space is dropped
+        std::vector<bool> bitSlots = slots(on, 0, on.size() - 1, 889);
+        bitSlots.insert(bitSlots.begin(), false);
+        if (bitSlots.size() % 2) bitSlots.push_back(false);
+        TEST_ASSERT_EQUAL_UINT32(28, bitSlots.size());
+
+        uint32_t value = 0;
+        for (size_t i = 0; i < bitSlots.size(); i += 2)
+        {
+            TEST_ASSERT_TRUE(bitSlots[i] != bitSlots[i + 1]);
+            value = (value << 1) | (bitSlots[i + 1] ? 1 : 0);
+        }
+        TEST_ASSERT_EQUAL_HEX32(0x3000 | payload, value);
+    }
+}
+
+void test_rc6_slots_double_the_trailer_bit()
+{
+    const uint32_t payloads[] = { 0x00000, 0x00001, 0x10000, 0xFFFFF, 0x5A5A5 };
+    for (uint32_t payload : payloads)
+    {
+        IRCode code = makeCode(IRProtocol::RC6, 20, 0, 2, payload);
+        TEST_ASSERT_TRUE(IREncoder::encode(code, frame));
+        Halves on = halves(frame);
+        TEST_ASSERT_EQUAL_UINT32(2664, on[0].second);
+        TEST_ASSERT_FALSE(on[1].first);
+        TEST_ASSERT_TRUE(on.back().second >= 83000);
+
+        // T = 444 us from the start bit; the leader space may have joined a leading space
+        std::vector<bool> bitSlots;
+        uint32_t lead = on[1].second - 888;
+        for (uint32_t k = 0; k < (lead + 222) / 444; k++) bitSlots.push_back(false);
+        std::vector<bool> rest = slots(on, 2, on.size() - 1, 444);
+        bitSlots.insert(bitSlots.end(), rest.begin(), rest.end());
+        while (bitSlots.size() < 2 + 19 * 2 + 4) bitSlots.push_back(false);
+
+        // Start bit, then a one is mark then space; bit 3 is the trailer, twice as wide
+        TEST_ASSERT_TRUE(bitSlots[0]);
+        TEST_ASSERT_FALSE(bitSlots[1]);
+        size_t i = 2;
+        uint32_t value = 0;
+        for (int bit = 0; bit < 20; bit++)
+        {
+            size_t width = bit == 3 ? 2 : 1;
+            bool first = bitSlots[i];
+            TEST_ASSERT_TRUE(bitSlots[i + width] != first);
+            value = (value << 1) | first;
+            i += 2 * width;
+        }
+        TEST_ASSERT_EQUAL_HEX32(payload, value);
+    }
+}
+
+void test_long_gaps_split_and_bad_codes_refused()
+{
+    IRCode code = makeCode(IRProtocol::RC6, 20, 3, 2, 0x12345);
+    TEST_ASSERT_TRUE(IREncoder::encode(code, frame));
+    for (uint16_t i = 0; i < frame.count; i++)
+    {
+        TEST_ASSERT_TRUE(IREncoder::duration(frame.items[i], 0) > 0);
+    }
+
+    code = makeCode(IRProtocol::NONE, 12, 0, 0, 1);
+    TEST_ASSERT_FALSE(IREncoder::encode(code, frame));
+    code = makeCode(IRProtocol::SONY, 32, 20, 0, 1);
+    TEST_ASSERT_FALSE(IREncoder::encode(code, frame));
+
+    uint16_t largest = 0;
+    IRCode builtin;
+    for (uint32_t i = 0; i < BUILTIN_CODES; i++)
+    {
+        builtinCode(nullptr, i, builtin);
+        TEST_ASSERT_TRUE(IREncoder::encode(builtin, frame));
+        if (frame.count > largest) largest = frame.count;
+    }
+    TEST_ASSERT_TRUE(largest <= IRFrame::CAPACITY);
+
+    char message[64];
+    snprintf(message, sizeof(message), "largest built-in frame: %u items of %u", largest, IRFrame::CAPACITY);
+    TEST_MESSAGE(message);
+}
+
+void test_builtin_set_round_trips()
+{
+    TEST_ASSERT_TRUE(IRCodeDatabase::write(card.backend(), CODES_FILE, builtinCode, nullptr, BUILTIN_CODES));
+    TEST_ASSERT_EQUAL_UINT32(IRCodeDatabase::HEADER_SIZE + BUILTIN_CODES * IRCodeDatabase::RECORD_SIZE,
+                             card.files[CODES_FILE].size());
+
+    IRCodeDatabase database(card.backend());
+    TEST_ASSERT_TRUE(database.open(CODES_FILE));
+    TEST_ASSERT_EQUAL_UINT32(BUILTIN_CODES, database.count());
+    TEST_ASSERT_EQUAL_UINT8(BUILTIN_REGIONS, database.regionCount());
+    for (uint8_t region = 0; region < BUILTIN_REGIONS; region++)
+    {
+        TEST_ASSERT_EQUAL_UINT32(region * BUILTIN_REGION_CODES, database.regionStart(region));
+    }
+    TEST_ASSERT_EQUAL_UINT32(BUILTIN_CODES, database.regionStart(BUILTIN_REGIONS));
+
+    IRCode read;
+    IRCode expected;
+    uint32_t count = 0;
+    while (database.next(read))
+    {
+        builtinCode(nullptr, count++, expected);
+        TEST_ASSERT_EQUAL_MEMORY(&expected, &read, sizeof(read));
+    }
+    TEST_ASSERT_EQUAL_UINT32(BUILTIN_CODES, count);
+    TEST_ASSERT_EQUAL_UINT32(BUILTIN_CODES, database.stats().codes);
+    TEST_ASSERT_EQUAL_UINT32(7, database.stats().blockReads);
+
+    database.seek(250);
+    TEST_ASSERT_TRUE(database.next(read));
+    TEST_ASSERT_EQUAL_UINT8(2, read.region);
+    TEST_ASSERT_EQUAL_UINT32(50, read.payload);
+    TEST_ASSERT_EQUAL_UINT32(251, database.position());
+    database.seek(1000);
+    TEST_ASSERT_FALSE(database.next(read));
+}
+
+void test_regions_and_failed_writes()
+{
+    uint32_t count = 1000;
+    IRCodeDatabase database(card.backend());
+    TEST_ASSERT_TRUE(IRCodeDatabase::write(card.backend(), "/ir/sequence.bin", sequenceCode, &count, count));
+    TEST_ASSERT_TRUE(database.open("/ir/sequence.bin"));
+    TEST_ASSERT_EQUAL_UINT8(8, database.regionCount());
+
+    // An empty region starts where the next one does
+    TEST_ASSERT_EQUAL_UINT32(250, database.regionStart(2));
+    TEST_ASSERT_EQUAL_UINT32(250, database.regionStart(3));
+
+    // Regions going backwards are refused and the file removed
+    TEST_ASSERT_FALSE(IRCodeDatabase::write(card.backend(), "/ir/backwards.bin", backwardsCode, nullptr, 10));
+    TEST_ASSERT_TRUE(card.files.find("/ir/backwards.bin") == card.files.end());
+
+    // The header goes last, so a write cut short never leaves a file that opens
+    card.resetCounters();
+    TEST_ASSERT_TRUE(IRCodeDatabase::write(card.backend(), "/ir/whole.bin", sequenceCode, &count, count));
+    long writes = static_cast<long>(card.writes);
+    for (long point = 0; point < writes; point++)
+    {
+        card.powerLossAfter(point);
+        TEST_ASSERT_FALSE(IRCodeDatabase::write(card.backend(), "/ir/cut.bin", sequenceCode, &count, count));
+        card.restorePower();
+        TEST_ASSERT_FALSE(database.open("/ir/cut.bin"));
+    }
+}
+
+void test_bad_records_and_damaged_files()
+{
+    uint32_t count = 1000;
+    const char* path = "/ir/sequence.bin";
+    TEST_ASSERT_TRUE(IRCodeDatabase::write(card.backend(), path, sequenceCode, &count, count));
+    HostTest::Bytes& bytes = card.files[path];
+    const uint16_t header = IRCodeDatabase::HEADER_SIZE;
+    const uint8_t record = IRCodeDatabase::RECORD_SIZE;
+
+    // Unknown protocol, no bits, more bits than the payload holds
+    bytes[header + record * 3] = 9;
+    bytes[header + record * 4 + 1] = 0;
+    bytes[header + record * 5 + 1] = 33;
+    IRCodeDatabase database(card.backend());
+    IRCode code;
+    uint32_t read = 0;
+    TEST_ASSERT_TRUE(database.open(path));
+    while (database.next(code)) read++;
+    TEST_ASSERT_EQUAL_UINT32(997, read);
+    TEST_ASSERT_EQUAL_UINT32(3, database.stats().badRecords);
+    database.close();
+
+    // Magic, version, record size, count, region order, truncation
+    const HostTest::Bytes good = bytes;
+    const size_t fields[] = { 0, 4, 6, 12 };
+    const uint8_t values[] = { 'X', 2, 9, 9 };
+    for (size_t i = 0; i < sizeof(fields) / sizeof(fields[0]); i++)
+    {
+        bytes = good;
+        bytes[fields[i]] = values[i];
+        TEST_ASSERT_FALSE(database.open(path));
+    }
+    bytes = good;
+    bytes[16 + 4 * 3] = 0;
+    bytes[16 + 4 * 3 + 1] = 0;
+    TEST_ASSERT_FALSE(database.open(path));
+    bytes = good;
+    bytes.resize(header + 999 * record);
+    TEST_ASSERT_FALSE(database.open(path));
+    bytes.resize(10);
+    TEST_ASSERT_FALSE(database.open(path));
+    TEST_ASSERT_FALSE(database.open("/ir/missing.bin"));
+
+    // A file shrinking under an open database ends the stream
+    bytes = good;
+    TEST_ASSERT_TRUE(database.open(path));
+    bytes.resize(header + 100 * record);
+    read = 0;
+    while (database.next(code)) read++;
+    TEST_ASSERT_EQUAL_UINT32(IRCodeDatabase::BLOCK_RECORDS - 3, read);
+}
+
+void test_codes_streamed_and_encoded_per_second()
+{
+    uint32_t count = BENCHMARK_CODES;
+    TEST_ASSERT_TRUE(IRCodeDatabase::write(card.backend(), "/ir/large.bin", sequenceCode, &count, count));
+    IRCodeDatabase database(card.backend());
+    TEST_ASSERT_TRUE(database.open("/ir/large.bin"));
+
+    IRCode code;
+    uint32_t encoded = 0;
+    uint64_t onAir = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int pass = 0; pass < BENCHMARK_PASSES; pass++)
+    {
+        database.seek(0);
+        while (database.next(code))
+        {
+            if (IREncoder::encode(code, frame)) encoded++;
+            onAir += frame.micros;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    TEST_ASSERT_EQUAL_UINT32(BENCHMARK_CODES * BENCHMARK_PASSES, encoded);
+    TEST_ASSERT_TRUE(onAir > 0);
+    double codesPerSecond = encoded / seconds;
+    TEST_ASSERT_TRUE(codesPerSecond > MIN_CODES_PER_SECOND);
+
+    // The built-in set on air: each frame used to be followed by a 100 ms wait
+    uint64_t builtinMicros = 0;
+    uint32_t longest = 0;
+    for (uint32_t i = 0; i < BUILTIN_CODES; i++)
+    {
+        builtinCode(nullptr, i, code);
+        TEST_ASSERT_TRUE(IREncoder::encode(code, frame));
+        builtinMicros += frame.micros;
+        if (frame.micros > longest) longest = frame.micros;
+    }
+    double before = (builtinMicros + static_cast<double>(BUILTIN_CODES) * OLD_SEND_DELAY_MICROS) / 1e6;
+    double now = builtinMicros / 1e6;
+    TEST_ASSERT_TRUE(now < before);
+
+    char message[160];
+    snprintf(message, sizeof(message), "host read and encode: %.0f codes/s, %.2f us per code",
+             codesPerSecond, seconds * 1e6 / encoded);
+    TEST_MESSAGE(message);
+    snprintf(message, sizeof(message), "built-in %u codes on air: %.1f s (%.1f codes/s) before, %.1f s (%.1f codes/s) now; longest frame %.0f ms",
+             BUILTIN_CODES, before, BUILTIN_CODES / before, now, BUILTIN_CODES / now, longest / 1e3);
+    TEST_MESSAGE(message);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_nec_frames_and_repeats);
+    RUN_TEST(test_sony_and_samsung_frames);
+    RUN_TEST(test_rc5_slots_carry_both_start_bits);
+    RUN_TEST(test_rc6_slots_double_the_trailer_bit);
+    RUN_TEST(test_long_gaps_split_and_bad_codes_refused);
+    RUN_TEST(test_builtin_set_round_trips);
+    RUN_TEST(test_regions_and_failed_writes);
+    RUN_TEST(test_bad_records_and_damaged_files);
+    RUN_TEST(test_codes_streamed_and_encoded_per_second);
+    return UNITY_END();
+}
@@ -0,0 +1,342 @@
+/**
+ * @file test_main.cpp
+ * @brief KeyValueStore power-loss replay, compaction and throughput
+ *
+ * Each workload of sets and removes is replayed with power cut at every card
+ * operation in turn, tearing the interrupted write. After the reboot every key
+ * must hold a value it had at some point between the last durable batch and
+ * the cut, and never one it was not given.
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+#include "MemoryStorage.h"
+#include "PrefrontalCortex/KeyValueStore.h"
+
+using namespace PrefrontalCortex;
+using HostTest::Bytes;
+using HostTest::MemoryStorage;
+
+namespace
+{
+    typedef std::map<uint8_t, Bytes> State;     // A missing key is absent
+
+    const char* const DIRECTORY = "/kv";
+    const uint8_t KEYS = 12;
+    const uint16_t OPS_PER_WORKLOAD = 900;
+    const uint8_t WORKLOADS = 8;
+    const uint32_t BATCH_DELAY_MS = 30;
+    const uint32_t BENCH_OPS = 1000000;
+    const uint16_t FLUSH_OPS = 20000;
+    const char* const SETTINGS[] = { "xp", "level", "scans", "volume", "led_mode", "theme" };
+    const uint8_t SETTING_COUNT = 6;
+
+    struct Op
+    {
+        uint8_t key;
+        bool remove;
+        Bytes value;
+    };
+
+    uint32_t lcgState = 1;
+
+    uint32_t nextRandom(uint32_t bound)
+    {
+        lcgState = lcgState * 1664525u + 1013904223u;
+        return (lcgState >> 8) % bound;
+    }
+
+    std::string keyName(uint8_t key)
+    {
+        char name[16];
+        snprintf(name, sizeof(name), "key.%02u", key);
+        return name;
+    }
+
+    /**
+     * @brief Counter-sized values on most keys, any length up to the limit on the rest
+     */
+    std::vector<Op> makeWorkload(uint32_t seed)
+    {
+        lcgState = seed;
+        std::vector<Op> ops;
+        for (uint16_t i = 0; i < OPS_PER_WORKLOAD; i++)
+        {
+            Op op;
+            op.key = static_cast<uint8_t>(nextRandom(KEYS));
+            op.remove = nextRandom(15) == 0;
+            if (!op.remove)
+            {
+                uint32_t length = op.key < 8 ? 4 : nextRandom(KeyValueStore::VALUE_LENGTH + 1);
+                for (uint32_t j = 0; j < length; j++) op.value.push_back(static_cast<uint8_t>(nextRandom(256)));
+            }
+            ops.push_back(op);
+        }
+        return ops;
+    }
+
+    std::vector<State> history(const std::vector<Op>& ops)
+    {
+        std::vector<State> states(1);
+        for (const Op& op : ops)
+        {
+            State state = states.back();
+            if (op.remove) state.erase(op.key);
+            else state[op.key] = op.value;
+            states.push_back(state);
+        }
+        return states;
+    }
+
+    /**
+     * @brief Read a key back whatever its length
+     */
+    bool readKey(const KeyValueStore& store, const std::string& name, Bytes& value)
+    {
+        uint8_t buffer[KeyValueStore::VALUE_LENGTH];
+        for (uint8_t length = 0; length <= KeyValueStore::VALUE_LENGTH; length++)
+        {
+            if (store.get(name.c_str(), buffer, length))
+            {
+                value.assign(buffer, buffer + length);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    struct CrashTotals
+    {
+        uint32_t runs;
+        uint32_t tornRuns;
+        uint32_t compactions;
+    };
+
+    /**
+     * @brief Cut power at one operation of a workload; false once a run completes
+     */
+    bool crashAt(uint32_t seed, long point, const std::vector<Op>& ops, const std::vector<State>& states,
+                 CrashTotals& totals)
+    {
+        MemoryStorage card;
+        size_t durable = 0;
+        size_t done = 0;
+        bool finished = false;
+        {
+            KeyValueStore store(card.backend());
+            store.setMaxDelay(BATCH_DELAY_MS);
+            TEST_ASSERT_TRUE(store.open(DIRECTORY));
+            card.powerLossAfter(point, seed * 7919 + static_cast<uint32_t>(point));
+
+            uint32_t now = 0;
+            for (; done < ops.size() && !card.powerLost(); done++)
+            {
+                const Op& op = ops[done];
+                std::string name = keyName(op.key);
+                if (op.remove) store.remove(name.c_str(), now);
+                else TEST_ASSERT_TRUE(store.set(name.c_str(), op.value.data(), static_cast<uint8_t>(op.value.size()), now));
+                now += 3;
+                store.update(now);
+                if (!card.powerLost() && store.stats().dirty == 0) durable = done + 1;
+            }
+            if (!card.powerLost() && store.flush() && !card.powerLost()) durable = done;
+            finished = !card.powerLost();
+            totals.compactions += store.stats().compactions;
+            card.cutPower();
+        }
+
+        card.restorePower();
+        totals.runs++;
+        KeyValueStore store(card.backend());
+        TEST_ASSERT_TRUE(store.open(DIRECTORY));
+        if (store.stats().tornRecords) totals.tornRuns++;
+
+        char message[96];
+        for (uint8_t key = 0; key < KEYS; key++)
+        {
+            Bytes value;
+            bool present = store.contains(keyName(key).c_str());
+            snprintf(message, sizeof(message), "workload %u, power cut at operation %ld, key %u", seed, point, key);
+            if (present) TEST_ASSERT_TRUE_MESSAGE(readKey(store, keyName(key), value), message);
+
+            bool matched = false;
+            for (size_t count = durable; count <= done && !matched; count++)
+            {
+                State::const_iterator it = states[count].find(key);
+                bool had = it != states[count].end();
+                matched = had == present && (!had || it->second == value);
+            }
+            TEST_ASSERT_TRUE_MESSAGE(matched, message);
+        }
+        return !finished;
+    }
+
+    double elapsedMicros(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_values_round_trip_and_reload()
+{
+    MemoryStorage card;
+    uint8_t blob[KeyValueStore::VALUE_LENGTH];
+    for (uint8_t i = 0; i < sizeof(blob); i++) blob[i] = static_cast<uint8_t>(i * 17);
+    {
+        KeyValueStore store(card.backend());
+        TEST_ASSERT_TRUE(store.open(DIRECTORY));
+        TEST_ASSERT_TRUE(store.setUInt("level", 7, 0));
+        TEST_ASSERT_TRUE(store.set("blob", blob, sizeof(blob), 0));
+        TEST_ASSERT_TRUE(store.setUInt("gone", 1, 0));
+        TEST_ASSERT_TRUE(store.remove("gone", 0));
+        TEST_ASSERT_TRUE(store.set("flag", nullptr, 0, 0));
+        TEST_ASSERT_TRUE(store.set("flag", nullptr, 0, 0));
+
+        // Keys and values past their limits are refused
+        TEST_ASSERT_FALSE(store.setUInt("a.key.that.is.too.long", 1, 0));
+        TEST_ASSERT_FALSE(store.set("big", blob, KeyValueStore::VALUE_LENGTH + 1, 0));
+        TEST_ASSERT_EQUAL_UINT32(7, store.getUInt("level", 0));
+
+        // Nothing reaches the card before the batch delay; a fresh store's first batch is a compaction
+        card.resetCounters();
+        store.update(KeyValueStore::DEFAULT_MAX_DELAY_MS - 1);
+        TEST_ASSERT_EQUAL_UINT32(0, card.writes);
+        TEST_ASSERT_EQUAL_UINT8(4, store.stats().dirty);
+        store.update(KeyValueStore::DEFAULT_MAX_DELAY_MS);
+        TEST_ASSERT_GREATER_THAN(0, card.writes);
+        TEST_ASSERT_EQUAL_UINT8(0, store.stats().dirty);
+    }
+
+    KeyValueStore store(card.backend());
+    TEST_ASSERT_TRUE(store.open(DIRECTORY));
+    TEST_ASSERT_EQUAL_UINT32(7, store.getUInt("level", 0));
+    TEST_ASSERT_EQUAL_UINT32(99, store.getUInt("missing", 99));
+    TEST_ASSERT_FALSE(store.contains("gone"));
+    TEST_ASSERT_TRUE(store.get("flag", nullptr, 0));
+    uint8_t read[KeyValueStore::VALUE_LENGTH];
+    TEST_ASSERT_FALSE(store.get("blob", read, 4));
+    TEST_ASSERT_TRUE(store.get("blob", read, sizeof(read)));
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(blob, read, sizeof(blob));
+}
+
+void test_compaction_rotates_segments_and_keeps_values()
+{
+    MemoryStorage card;
+    {
+        KeyValueStore store(card.backend());
+        TEST_ASSERT_TRUE(store.open(DIRECTORY));
+        for (uint32_t i = 0; i < 5000; i++)
+        {
+            store.setUInt(SETTINGS[i % SETTING_COUNT], i, 0);
+            TEST_ASSERT_TRUE(store.flush());
+            store.update(0);
+        }
+        KeyValueStats stats = store.stats();
+        TEST_ASSERT_GREATER_THAN(KeyValueStore::SEGMENTS, stats.compactions);
+        TEST_ASSERT_TRUE(stats.segmentBytes <= KeyValueStore::SEGMENT_BYTES);
+    }
+
+    // Every segment slot was used, and none grew past its size
+    uint8_t segments = 0;
+    for (const auto& file : card.files)
+    {
+        if (file.first.compare(0, strlen(DIRECTORY), DIRECTORY) != 0) continue;
+        segments++;
+        TEST_ASSERT_TRUE(file.second.size() <= KeyValueStore::SEGMENT_BYTES);
+    }
+    TEST_ASSERT_EQUAL_UINT8(KeyValueStore::SEGMENTS, segments);
+
+    KeyValueStore store(card.backend());
+    TEST_ASSERT_TRUE(store.open(DIRECTORY));
+    for (uint32_t i = 4994; i < 5000; i++) TEST_ASSERT_EQUAL_UINT32(i, store.getUInt(SETTINGS[i % SETTING_COUNT], 0));
+}
+
+void test_power_loss_at_every_operation_keeps_a_durable_value()
+{
+    CrashTotals totals = { 0, 0, 0 };
+    for (uint32_t seed = 1; seed <= WORKLOADS; seed++)
+    {
+        std::vector<Op> ops = makeWorkload(seed);
+        std::vector<State> states = history(ops);
+        for (long point = 0; crashAt(seed, point, ops, states, totals); point++)
+        {
+        }
+    }
+
+    char message[128];
+    snprintf(message, sizeof(message), "%u power cuts, %u left a torn tail, %u compactions on the way",
+             totals.runs, totals.tornRuns, totals.compactions);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_GREATER_THAN(WORKLOADS * 20, totals.runs);
+    TEST_ASSERT_GREATER_THAN(0, totals.tornRuns);
+    TEST_ASSERT_GREATER_THAN(0, totals.compactions);
+}
+
+void test_reads_and_batched_writes_throughput()
+{
+    MemoryStorage card;
+    KeyValueStore store(card.backend());
+    TEST_ASSERT_TRUE(store.open(DIRECTORY));
+    for (uint8_t i = 0; i < SETTING_COUNT; i++) store.setUInt(SETTINGS[i], i, 0);
+    TEST_ASSERT_TRUE(store.flush());
+
+    volatile uint32_t sink = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < BENCH_OPS; i++) sink = sink + store.getUInt(SETTINGS[i % SETTING_COUNT], 0);
+    double getMicros = elapsedMicros(start);
+
+    // One set per millisecond, batched every DEFAULT_MAX_DELAY_MS
+    card.resetCounters();
+    uint32_t batchesBefore = store.stats().batches;
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < BENCH_OPS; i++)
+    {
+        store.setUInt(SETTINGS[i % SETTING_COUNT], i, i);
+        store.update(i + 1);
+    }
+    TEST_ASSERT_TRUE(store.flush());
+    double setMicros = elapsedMicros(start);
+    uint32_t batchedWrites = card.writes;
+    uint32_t batches = store.stats().batches - batchesBefore;
+
+    card.resetCounters();
+    start = std::chrono::steady_clock::now();
+    for (uint16_t i = 0; i < FLUSH_OPS; i++)
+    {
+        store.setUInt(SETTINGS[i % SETTING_COUNT], i, 0);
+        TEST_ASSERT_TRUE(store.flush());
+    }
+    double flushMicros = elapsedMicros(start);
+    double writesPerFlush = static_cast<double>(card.writes) / FLUSH_OPS;
+
+    char message[192];
+    snprintf(message, sizeof(message),
+             "get %.1f M/s; set+update %.1f M/s, %u writes in %u batches for %u sets; set+flush %.0f k/s, %.2f writes per set",
+             BENCH_OPS / getMicros, BENCH_OPS / setMicros, batchedWrites, batches, BENCH_OPS,
+             FLUSH_OPS / flushMicros * 1000, writesPerFlush);
+    TEST_MESSAGE(message);
+
+    // A batch is one append, plus the odd compaction rewrite
+    TEST_ASSERT_TRUE(batches <= BENCH_OPS / KeyValueStore::DEFAULT_MAX_DELAY_MS + 1);
+    TEST_ASSERT_TRUE(batchedWrites < batches * 2);
+    TEST_ASSERT_TRUE(writesPerFlush < 1.1);
+    TEST_ASSERT_EQUAL_UINT32(FLUSH_OPS - 1, store.getUInt(SETTINGS[(FLUSH_OPS - 1) % SETTING_COUNT], 0));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_values_round_trip_and_reload);
+    RUN_TEST(test_compaction_rotates_segments_and_keeps_values);
+    RUN_TEST(test_power_loss_at_every_operation_keeps_a_durable_value);
+    RUN_TEST(test_reads_and_batched_writes_throughput);
+    return UNITY_END();
+}
@@ -0,0 +1,262 @@
+/**
+ * @file test_main.cpp
+ * @brief MediaClock timeline and audio/LED skew against a modelled I2S queue
+ *
+ * The skew test plays a melody through ToneSequencer on a 20 µs simulated
+ * timer. A render model keeps eight 128-frame DMA buffers in flight, and each
+ * note's LED frame is either shown when the note is started (the old way) or
+ * scheduled for queuedMicros() and shown once media time reaches it. Skew is
+ * LED time minus the time the note's first sample leaves the DAC.
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <algorithm>
+#include <deque>
+#include <vector>
+#include "AuditoryCortex/MediaClock.h"
+#include "AuditoryCortex/ToneSequencer.h"
+
+using namespace AuditoryCortex;
+
+namespace
+{
+    const uint32_t SAMPLE_RATE = 44100;
+    const uint32_t BLOCK = 128;
+    const uint32_t BUFFERS = 8;
+    const uint32_t TICK_MICROS = 20;
+    const uint32_t LOOP_MICROS = 2000;
+    const uint16_t NOTES = 200;
+    const uint32_t FRAME_MICROS = 23;           // Interpolation moves in whole frames
+    const double MAX_ALIGNED_SKEW_MS = 3.0;
+
+    uint32_t fakeMicros = 0;
+
+    uint32_t simulatedMicros()
+    {
+        return fakeMicros;
+    }
+
+    uint32_t lcgState = 7;
+
+    uint32_t nextRandom(uint32_t bound)
+    {
+        lcgState = lcgState * 1664525u + 1013904223u;
+        return (lcgState >> 8) % bound;
+    }
+
+    struct Skew
+    {
+        std::vector<double> atCommand;
+        std::vector<double> onMediaClock;
+    };
+
+    struct LedFrame
+    {
+        uint64_t mediaMicros;
+        uint16_t note;
+    };
+
+    /**
+     * @brief State shared with the sequencer's start callback
+     */
+    struct Simulation
+    {
+        MediaClock* clock;
+        std::vector<uint16_t> waitingForRender;
+        std::vector<uint64_t> startFrame;
+        std::vector<double> commandMicros;
+        std::deque<LedFrame> ledQueue;
+    };
+
+    Simulation* simulation = nullptr;
+
+    void onNoteStart(uint8_t, const ToneEvent& event)
+    {
+        simulation->waitingForRender.push_back(event.cue);
+        simulation->commandMicros[event.cue] = fakeMicros;
+        LedFrame frame = { simulation->clock->queuedMicros(), event.cue };
+        simulation->ledQueue.push_back(frame);
+    }
+
+    void onNoteStop(uint8_t) {}
+
+    double percentile(std::vector<double> values, double fraction)
+    {
+        std::sort(values.begin(), values.end());
+        return values[static_cast<size_t>(fraction * (values.size() - 1))];
+    }
+
+    /**
+     * @brief Play NOTES quarter notes; the main loop stalls with the given odds
+     */
+    Skew measureSkew(uint32_t stallPerMille, uint32_t maxStallMicros)
+    {
+        fakeMicros = 0;
+        MediaClock clock(SAMPLE_RATE, simulatedMicros);
+        ToneSequencer sequencer;
+        Simulation state;
+        state.clock = &clock;
+        state.startFrame.assign(NOTES, 0);
+        state.commandMicros.assign(NOTES, -1);
+        simulation = &state;
+
+        sequencer.setOutput(onNoteStart, onNoteStop);
+        sequencer.setPreemptive(false);
+        clock.setLatency(BUFFERS * BLOCK);
+        clock.start();
+
+        std::vector<double> heardMicros(NOTES, -1);
+        std::vector<double> ledMicros(NOTES, -1);
+        std::deque<uint16_t> rendered;
+        uint64_t renderedFrames = 0;
+        double dacFrame = 0;
+        uint16_t queuedNotes = 0;
+        uint32_t nextLoop = 0;
+
+        for (; fakeMicros < NOTES * 160000u + 2000000u; fakeMicros += TICK_MICROS)
+        {
+            // Render task: top the DMA queue up, one block at a time
+            dacFrame += SAMPLE_RATE * (TICK_MICROS / 1e6);
+            while (renderedFrames < static_cast<uint64_t>(dacFrame) + BUFFERS * BLOCK)
+            {
+                for (uint16_t note : state.waitingForRender)
+                {
+                    state.startFrame[note] = renderedFrames;
+                    rendered.push_back(note);
+                }
+                state.waitingForRender.clear();
+                clock.queued(BLOCK);
+                renderedFrames += BLOCK;
+                clock.written();
+            }
+            while (!rendered.empty() && dacFrame >= state.startFrame[rendered.front()])
+            {
+                heardMicros[rendered.front()] = fakeMicros;
+                rendered.pop_front();
+            }
+
+            if (fakeMicros < nextLoop) continue;
+
+            // Main loop: feed the sequencer and show any LED frame that is due
+            while (queuedNotes < NOTES && sequencer.freeSpace(TonePriority::TUNE) > 0)
+            {
+                ToneEvent event = { 440, 100, 150, 100, queuedNotes };
+                sequencer.enqueue(TonePriority::TUNE, event);
+                queuedNotes++;
+            }
+            sequencer.update(clock.nowMs());
+            uint64_t now = clock.nowMicros();
+            while (!state.ledQueue.empty() && state.ledQueue.front().mediaMicros <= now)
+            {
+                ledMicros[state.ledQueue.front().note] = fakeMicros;
+                state.ledQueue.pop_front();
+            }
+            nextLoop = fakeMicros + LOOP_MICROS;
+            if (stallPerMille && nextRandom(1000) < stallPerMille) nextLoop += nextRandom(maxStallMicros);
+        }
+        simulation = nullptr;
+
+        Skew skew;
+        for (uint16_t n = 0; n < NOTES; n++)
+        {
+            if (heardMicros[n] < 0 || ledMicros[n] < 0) continue;
+            skew.atCommand.push_back((state.commandMicros[n] - heardMicros[n]) / 1000);
+            skew.onMediaClock.push_back((ledMicros[n] - heardMicros[n]) / 1000);
+        }
+        return skew;
+    }
+
+    void report(const char* label, const Skew& skew)
+    {
+        char message[160];
+        snprintf(message, sizeof(message), "%s: %u notes, at command p50 %.2f ms, on media clock p5 %.2f p50 %.2f p95 %.2f ms",
+                 label, static_cast<unsigned>(skew.onMediaClock.size()), percentile(skew.atCommand, 0.5),
+                 percentile(skew.onMediaClock, 0.05), percentile(skew.onMediaClock, 0.5),
+                 percentile(skew.onMediaClock, 0.95));
+        TEST_MESSAGE(message);
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_clock_follows_rendered_frames()
+{
+    fakeMicros = 1000;
+    MediaClock clock(SAMPLE_RATE, simulatedMicros);
+    clock.setLatency(BLOCK);
+    clock.start();
+    TEST_ASSERT_TRUE(clock.isRunning());
+
+    // Nothing rendered yet: time cannot move on
+    fakeMicros += 10000;
+    TEST_ASSERT_EQUAL_UINT64(1000, clock.nowMicros());
+
+    // 441 frames queued, 313 of them played: 7.097 ms in, interpolating up to 10 ms
+    clock.queued(SAMPLE_RATE / 100);
+    clock.written();
+    TEST_ASSERT_EQUAL_UINT64(1000 + 7097, clock.nowMicros());
+    TEST_ASSERT_EQUAL_UINT64(1000 + 10000, clock.queuedMicros());
+    fakeMicros += 1000;
+    TEST_ASSERT_UINT_WITHIN(FRAME_MICROS, 1000 + 8097, clock.nowMicros());
+    fakeMicros += 50000;
+    TEST_ASSERT_EQUAL_UINT64(1000 + 10000, clock.nowMicros());
+}
+
+void test_clock_free_runs_while_stopped()
+{
+    fakeMicros = 0;
+    MediaClock clock(SAMPLE_RATE, simulatedMicros);
+    clock.start();
+    clock.queued(SAMPLE_RATE);
+    clock.written();
+    fakeMicros = 500000;
+    uint64_t before = clock.nowMicros();
+
+    clock.stop();
+    fakeMicros += 250000;
+    TEST_ASSERT_EQUAL_UINT64(before + 250000, clock.nowMicros());
+
+    // Restarting picks up where the timer left off, with no step back
+    clock.start();
+    TEST_ASSERT_EQUAL_UINT64(before + 250000, clock.nowMicros());
+    clock.queued(BLOCK);
+    clock.written();
+    TEST_ASSERT_TRUE(clock.nowMicros() >= before + 250000);
+}
+
+void test_leds_on_media_clock_match_audio()
+{
+    Skew skew = measureSkew(0, 0);
+    report("steady loop", skew);
+    TEST_ASSERT_EQUAL_UINT32(NOTES, skew.onMediaClock.size());
+
+    // Shown at command, the LED runs a whole DMA queue ahead of the sound
+    double queueMs = BUFFERS * BLOCK * 1000.0 / SAMPLE_RATE;
+    TEST_ASSERT_TRUE(percentile(skew.atCommand, 0.5) < -queueMs + MAX_ALIGNED_SKEW_MS);
+    TEST_ASSERT_TRUE(percentile(skew.onMediaClock, 0.0) > -MAX_ALIGNED_SKEW_MS);
+    TEST_ASSERT_TRUE(percentile(skew.onMediaClock, 1.0) < MAX_ALIGNED_SKEW_MS);
+}
+
+void test_loop_stalls_only_delay_leds()
+{
+    // One loop in fifty stalls for up to 80 ms
+    Skew skew = measureSkew(20, 80000);
+    report("stalling loop", skew);
+    TEST_ASSERT_TRUE(skew.onMediaClock.size() > NOTES * 9 / 10);
+
+    // A stall can make a frame late but never early, and most stay aligned
+    TEST_ASSERT_TRUE(percentile(skew.onMediaClock, 0.0) > -MAX_ALIGNED_SKEW_MS);
+    TEST_ASSERT_TRUE(percentile(skew.onMediaClock, 0.5) < MAX_ALIGNED_SKEW_MS);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_clock_follows_rendered_frames);
+    RUN_TEST(test_clock_free_runs_while_stopped);
+    RUN_TEST(test_leds_on_media_clock_match_audio);
+    RUN_TEST(test_loop_stalls_only_delay_leds);
+    return UNITY_END();
+}
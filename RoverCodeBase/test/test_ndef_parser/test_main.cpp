@@ -0,0 +1,383 @@
+/**
+ * @file test_main.cpp
+ * @brief NDEFParser views, truncated and malformed input, fuzzing and throughput
+ *
+ * Tags are built as Type 2 TLV areas from records assembled here. The fuzz
+ * pass copies every random or mutated tag into a heap buffer of exactly its
+ * size, so under a sanitizer any read past a view's end faults as well as
+ * failing the bounds check.
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "PsychicCortex/NDEFParser.h"
+
+using namespace PsychicCortex;
+
+namespace
+{
+    typedef std::vector<uint8_t> Bytes;
+
+    const uint32_t FUZZ_TAGS = 400000;
+    const uint32_t THROUGHPUT_ROUNDS = 200000;
+    const size_t NTAG216_USER_BYTES = 872;
+    const uint32_t MAX_RECORDS_PER_TAG = 1000;  // More would mean the walk is not moving on
+    const double MAX_MICROS_PER_TAG = 10.0;
+
+    const uint8_t MESSAGE_BEGIN = 0x80;
+    const uint8_t MESSAGE_END = 0x40;
+    const uint8_t SHORT_RECORD = 0x10;
+    const uint8_t ID_PRESENT = 0x08;
+
+    uint32_t lcgState = 1;
+
+    uint32_t nextRandom(uint32_t bound)
+    {
+        lcgState = lcgState * 1664525u + 1013904223u;
+        return (lcgState >> 8) % bound;
+    }
+
+    Bytes bytes(const char* text)
+    {
+        return Bytes(text, text + strlen(text));
+    }
+
+    void appendRecord(Bytes& message, uint8_t flags, uint8_t tnf, const std::string& type,
+                      const Bytes& payload, const std::string& id = "")
+    {
+        bool shortRecord = payload.size() < 256;
+        message.push_back(flags | tnf | (shortRecord ? SHORT_RECORD : 0) | (id.empty() ? 0 : ID_PRESENT));
+        message.push_back(static_cast<uint8_t>(type.size()));
+        if (shortRecord)
+        {
+            message.push_back(static_cast<uint8_t>(payload.size()));
+        }
+        else
+        {
+            uint32_t length = static_cast<uint32_t>(payload.size());
+            for (int shift = 24; shift >= 0; shift -= 8) message.push_back(static_cast<uint8_t>(length >> shift));
+        }
+        if (!id.empty()) message.push_back(static_cast<uint8_t>(id.size()));
+        message.insert(message.end(), type.begin(), type.end());
+        message.insert(message.end(), id.begin(), id.end());
+        message.insert(message.end(), payload.begin(), payload.end());
+    }
+
+    /**
+     * @brief NDEF Message TLV around message, optionally after a lock control TLV, then a terminator
+     */
+    Bytes wrap(const Bytes& message, bool lockControl)
+    {
+        Bytes area;
+        if (lockControl)
+        {
+            const uint8_t lock[] = { 0x01, 0x03, 0xA0, 0x10, 0x44 };
+            area.insert(area.end(), lock, lock + sizeof(lock));
+        }
+        area.push_back(0x03);
+        if (message.size() < 255)
+        {
+            area.push_back(static_cast<uint8_t>(message.size()));
+        }
+        else
+        {
+            area.push_back(0xFF);
+            area.push_back(static_cast<uint8_t>(message.size() >> 8));
+            area.push_back(static_cast<uint8_t>(message.size()));
+        }
+        area.insert(area.end(), message.begin(), message.end());
+        area.push_back(0xFE);
+        return area;
+    }
+
+    /**
+     * @brief Text "Hello rover", URI https://example.com/card with an id, and a MIME blob
+     */
+    Bytes sampleTag()
+    {
+        Bytes message;
+        Bytes text = { 0x02, 'e', 'n' };
+        Bytes hello = bytes("Hello rover");
+        text.insert(text.end(), hello.begin(), hello.end());
+        appendRecord(message, MESSAGE_BEGIN, 1, "T", text);
+
+        Bytes uri = { 0x04 };
+        Bytes rest = bytes("example.com/card");
+        uri.insert(uri.end(), rest.begin(), rest.end());
+        appendRecord(message, 0, 1, "U", uri, "id1");
+
+        appendRecord(message, MESSAGE_END, 2, "audio/x-rover", { 1, 2, 3, 250 });
+        return wrap(message, true);
+    }
+
+    bool inside(const uint8_t* buffer, size_t length, const void* view, size_t viewLength)
+    {
+        if (viewLength == 0) return true;
+        const uint8_t* start = static_cast<const uint8_t*>(view);
+        return start >= buffer && start + viewLength <= buffer + length;
+    }
+
+    /**
+     * @brief Walk a tag, checking every view; reads each byte so a sanitizer sees it
+     * @return Views found outside the buffer
+     */
+    uint32_t walkChecked(const uint8_t* buffer, size_t length, uint32_t& records, NDEFStatus& status)
+    {
+        uint32_t outside = 0;
+        volatile uint8_t sink = 0;
+        NDEFParser parser(buffer, length);
+        NDEFRecord record;
+        uint32_t walked = 0;
+        while (parser.next(record) && walked++ < MAX_RECORDS_PER_TAG)
+        {
+            records++;
+            if (!inside(buffer, length, record.type, record.typeLength)) outside++;
+            if (!inside(buffer, length, record.id, record.idLength)) outside++;
+            if (!inside(buffer, length, record.payload, record.payloadLength)) outside++;
+
+            NDEFText text;
+            NDEFUri uri;
+            NDEFMime mime;
+            if (NDEFParser::text(record, text))
+            {
+                if (!inside(buffer, length, text.language, text.languageLength)) outside++;
+                if (!inside(buffer, length, text.text, text.textLength)) outside++;
+                for (uint32_t i = 0; i < text.textLength; i++) sink ^= text.text[i];
+            }
+            if (NDEFParser::uri(record, uri))
+            {
+                if (!inside(buffer, length, uri.rest, uri.restLength)) outside++;
+                for (uint32_t i = 0; i < uri.restLength; i++) sink ^= uri.rest[i];
+            }
+            if (NDEFParser::mime(record, mime))
+            {
+                if (!inside(buffer, length, mime.type, mime.typeLength)) outside++;
+                if (!inside(buffer, length, mime.data, mime.length)) outside++;
+                for (uint32_t i = 0; i < mime.length; i++) sink ^= mime.data[i];
+            }
+        }
+        status = parser.status();
+        return outside;
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_records_come_out_as_typed_views_in_place()
+{
+    Bytes tag = sampleTag();
+    NDEFParser parser(tag.data(), tag.size());
+    NDEFRecord record;
+    NDEFText text;
+    NDEFUri uri;
+    NDEFMime mime;
+
+    TEST_ASSERT_TRUE(parser.next(record));
+    TEST_ASSERT_TRUE(record.kind == NDEFRecordKind::TEXT);
+    TEST_ASSERT_TRUE(record.messageBegin);
+    TEST_ASSERT_TRUE(NDEFParser::text(record, text));
+    TEST_ASSERT_EQUAL_UINT8(2, text.languageLength);
+    TEST_ASSERT_EQUAL_MEMORY("en", text.language, 2);
+    TEST_ASSERT_EQUAL_UINT32(11, text.textLength);
+    TEST_ASSERT_EQUAL_MEMORY("Hello rover", text.text, 11);
+    TEST_ASSERT_FALSE(text.utf16);
+    TEST_ASSERT_TRUE(inside(tag.data(), tag.size(), text.text, text.textLength));
+
+    TEST_ASSERT_TRUE(parser.next(record));
+    TEST_ASSERT_TRUE(record.kind == NDEFRecordKind::URI);
+    TEST_ASSERT_EQUAL_UINT8(3, record.idLength);
+    TEST_ASSERT_EQUAL_MEMORY("id1", record.id, 3);
+    TEST_ASSERT_TRUE(NDEFParser::uri(record, uri));
+    TEST_ASSERT_EQUAL_STRING("https://", uri.prefix);
+    TEST_ASSERT_EQUAL_UINT32(16, uri.restLength);
+
+    TEST_ASSERT_TRUE(parser.next(record));
+    TEST_ASSERT_TRUE(record.kind == NDEFRecordKind::MIME);
+    TEST_ASSERT_TRUE(record.messageEnd);
+    TEST_ASSERT_TRUE(NDEFParser::mime(record, mime));
+    TEST_ASSERT_EQUAL_UINT8(13, mime.typeLength);
+    TEST_ASSERT_EQUAL_UINT32(4, mime.length);
+    TEST_ASSERT_EQUAL_UINT8(250, mime.data[3]);
+
+    TEST_ASSERT_FALSE(parser.next(record));
+    TEST_ASSERT_TRUE(parser.status() == NDEFStatus::OK);
+
+    parser.rewind();
+    uint32_t count = 0;
+    while (parser.next(record)) count++;
+    TEST_ASSERT_EQUAL_UINT32(3, count);
+
+    char summary[64];
+    size_t length = NDEFParser::summarize(tag.data(), tag.size(), summary, sizeof(summary));
+    TEST_ASSERT_EQUAL_STRING("Hello rover https://example.com/card audio/x-rover", summary);
+    TEST_ASSERT_EQUAL_UINT32(strlen(summary), length);
+
+    char small[10];
+    NDEFParser::summarize(tag.data(), tag.size(), small, sizeof(small));
+    TEST_ASSERT_EQUAL_STRING("Hello rov", small);
+}
+
+void test_long_lengths_utf16_and_several_messages()
+{
+    // A long record inside a TLV with a three-byte length
+    Bytes message;
+    appendRecord(message, MESSAGE_BEGIN | MESSAGE_END, 2, "text/plain", Bytes(600, 'z'));
+    Bytes tag = wrap(message, false);
+    NDEFParser parser(tag.data(), tag.size());
+    NDEFRecord record;
+    NDEFMime mime;
+    TEST_ASSERT_TRUE(parser.next(record));
+    TEST_ASSERT_TRUE(NDEFParser::mime(record, mime));
+    TEST_ASSERT_EQUAL_UINT32(600, mime.length);
+    TEST_ASSERT_FALSE(parser.next(record));
+    TEST_ASSERT_TRUE(parser.status() == NDEFStatus::OK);
+
+    // UTF-16 text with a byte order mark, then an absolute URI in a second message
+    Bytes first;
+    Bytes second;
+    appendRecord(first, MESSAGE_BEGIN | MESSAGE_END, 1, "T", { 0x82, 'e', 'n', 0xFE, 0xFF, 0, 'H', 0, 'i', 0x4E, 0x2D });
+    appendRecord(second, MESSAGE_BEGIN | MESSAGE_END, 3, "https://rover.example", {});
+    Bytes both = wrap(first, false);
+    both.pop_back();
+    Bytes tail = wrap(second, false);
+    both.insert(both.end(), tail.begin(), tail.end());
+
+    char summary[64];
+    NDEFParser::summarize(both.data(), both.size(), summary, sizeof(summary));
+    TEST_ASSERT_EQUAL_STRING("Hi https://rover.example", summary);
+}
+
+void test_cut_short_and_malformed_input_stops_cleanly()
+{
+    // Cut inside the URI record: the text record still comes out whole
+    Bytes tag = sampleTag();
+    size_t cut = 5 + 2 + 3 + 1 + 2 + 11 + 10;
+    NDEFParser parser(tag.data(), cut);
+    NDEFRecord record;
+    TEST_ASSERT_TRUE(parser.next(record));
+    TEST_ASSERT_TRUE(record.kind == NDEFRecordKind::TEXT);
+    TEST_ASSERT_FALSE(parser.next(record));
+    TEST_ASSERT_TRUE(parser.status() == NDEFStatus::TRUNCATED);
+
+    // A long record claiming far more payload than the message holds
+    Bytes lying = wrap({ 0xC1, 0x01, 0x00, 0x00, 0x7F, 0xFF, 0xFF, 'T' }, false);
+    NDEFParser liar(lying.data(), lying.size());
+    TEST_ASSERT_FALSE(liar.next(record));
+    TEST_ASSERT_TRUE(liar.status() == NDEFStatus::MALFORMED);
+
+    // Not NDEF at all, and no buffer
+    uint8_t junk[16];
+    memset(junk, 0x41, sizeof(junk));
+    char summary[8];
+    TEST_ASSERT_EQUAL_UINT32(0, NDEFParser::summarize(junk, sizeof(junk), summary, sizeof(summary)));
+    NDEFParser empty(nullptr, 100);
+    TEST_ASSERT_FALSE(empty.next(record));
+}
+
+void test_fuzzed_tags_never_leave_their_buffer()
+{
+    Bytes base = sampleTag();
+    uint32_t records = 0;
+    uint32_t outside = 0;
+    uint32_t badSummaries = 0;
+    uint32_t statuses[3] = { 0, 0, 0 };
+    lcgState = 1234;
+
+    for (uint32_t i = 0; i < FUZZ_TAGS; i++)
+    {
+        Bytes source;
+        if (i % 3 == 0)
+        {
+            // Random bytes, half of them starting like an NDEF Message TLV
+            source.resize(nextRandom(300));
+            for (uint8_t& byte : source) byte = static_cast<uint8_t>(nextRandom(256));
+            if (!source.empty() && nextRandom(2) == 0) source[0] = 0x03;
+        }
+        else
+        {
+            // The sample with a few bytes changed, sometimes cut short
+            source = base;
+            uint32_t flips = 1 + nextRandom(4);
+            for (uint32_t f = 0; f < flips; f++) source[nextRandom(source.size())] = static_cast<uint8_t>(nextRandom(256));
+            if (nextRandom(3) == 0) source.resize(nextRandom(source.size()));
+        }
+
+        uint8_t* buffer = new uint8_t[source.empty() ? 1 : source.size()];
+        memcpy(buffer, source.data(), source.size());
+        NDEFStatus status;
+        outside += walkChecked(buffer, source.size(), records, status);
+        statuses[static_cast<uint8_t>(status)]++;
+
+        char summary[256];
+        size_t length = NDEFParser::summarize(buffer, source.size(), summary, 1 + nextRandom(sizeof(summary)));
+        if (length >= sizeof(summary) || strlen(summary) != length) badSummaries++;
+        delete[] buffer;
+    }
+
+    char message[128];
+    snprintf(message, sizeof(message), "%u tags, %u records: %u ok, %u truncated, %u malformed",
+             FUZZ_TAGS, records, statuses[0], statuses[1], statuses[2]);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL_UINT32(0, outside);
+    TEST_ASSERT_EQUAL_UINT32(0, badSummaries);
+    TEST_ASSERT_GREATER_THAN(0, statuses[0]);
+    TEST_ASSERT_GREATER_THAN(0, statuses[1]);
+    TEST_ASSERT_GREATER_THAN(0, statuses[2]);
+}
+
+void test_full_ntag216_area_throughput()
+{
+    // Short text records filling an NTAG216 user area
+    Bytes message;
+    uint32_t count = 0;
+    while (message.size() < 840)
+    {
+        appendRecord(message, count == 0 ? MESSAGE_BEGIN : 0, 1, "T", bytes("\x02" "enabcdefghij"));
+        count++;
+    }
+    Bytes tag = wrap(message, true);
+    tag.resize(NTAG216_USER_BYTES, 0);
+
+    uint64_t textBytes = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < THROUGHPUT_ROUNDS; i++)
+    {
+        NDEFParser parser(tag.data(), tag.size());
+        NDEFRecord record;
+        NDEFText text;
+        while (parser.next(record))
+        {
+            if (NDEFParser::text(record, text)) textBytes += text.textLength;
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double microsPerTag = seconds / THROUGHPUT_ROUNDS * 1e6;
+    TEST_ASSERT_EQUAL_UINT64(static_cast<uint64_t>(THROUGHPUT_ROUNDS) * count * 10, textBytes);
+
+    char summary[256];
+    start = std::chrono::steady_clock::now();
+    for (uint32_t i = 0; i < THROUGHPUT_ROUNDS; i++) NDEFParser::summarize(tag.data(), tag.size(), summary, sizeof(summary));
+    double summarizeMicros = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() / THROUGHPUT_ROUNDS * 1e6;
+
+    char report[128];
+    snprintf(report, sizeof(report), "%u records per tag: %.2f us per tag (%.0f MB/s), summarize %.2f us",
+             count, microsPerTag, NTAG216_USER_BYTES / microsPerTag, summarizeMicros);
+    TEST_MESSAGE(report);
+    TEST_ASSERT_TRUE(microsPerTag < MAX_MICROS_PER_TAG);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_records_come_out_as_typed_views_in_place);
+    RUN_TEST(test_long_lengths_utf16_and_several_messages);
+    RUN_TEST(test_cut_short_and_malformed_input_stops_cleanly);
+    RUN_TEST(test_fuzzed_tags_never_leave_their_buffer);
+    RUN_TEST(test_full_ntag216_area_throughput);
+    return UNITY_END();
+}
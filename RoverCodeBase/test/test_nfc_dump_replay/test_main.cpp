@@ -0,0 +1,271 @@
+/**
+ * @file test_main.cpp
+ * @brief Flipper NFC dumps from test/data/nfc replayed through PN532Emulator into NFCEngine
+ *
+ * Each dump is loaded the way the rover loads one from SD, placed on the
+ * emulated reader and taken away 600 ms after it is announced. Every tap
+ * should give exactly one CARD_ARRIVED and one CARD_REMOVED, pass through
+ * the stages its tag type needs, and be read within its time budget.
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include "MemoryStorage.h"
+#include "PsychicCortex/NFCDump.h"
+#include "PsychicCortex/NFCEngine.h"
+#include "PsychicCortex/PN532Emulator.h"
+
+using namespace PsychicCortex;
+using HostTest::MemoryStorage;
+
+#ifndef TEST_DATA_DIR
+#define TEST_DATA_DIR "test/data"
+#endif
+
+namespace
+{
+    const uint32_t LOOP_MICROS = 5000;
+    const uint32_t HOLD_MICROS = 600000;
+    const uint32_t REPLAY_MICROS = 3000000;
+    const uint32_t NTAG215_BUDGET = 150000;
+    const uint32_t NTAG216_BUDGET = 250000;
+    const uint32_t ULTRALIGHT_BUDGET = 100000;
+    const uint32_t CLASSIC_BUDGET = 30000;
+
+    const char* STAGE_NAMES[NFC_STAGE_COUNT] = {
+        "stopped", "configure", "detect", "read capability", "read pages",
+        "reselect", "parse", "present", "check presence", "backoff"
+    };
+
+    struct Replay
+    {
+        uint32_t arrivals;
+        uint32_t removals;
+        uint32_t changes;
+        uint32_t readMicros;
+        bool locked;
+        char text[NFCCard::TEXT_LENGTH];
+        NFCEngineStats stats;
+        PN532EmulatorStats bus;
+    };
+
+    void recordEvent(void* context, const NFCEvent& event)
+    {
+        Replay& replay = *static_cast<Replay*>(context);
+        if (event.type == NFCEventType::CARD_ARRIVED)
+        {
+            replay.arrivals++;
+            replay.readMicros = event.readMicros;
+            replay.locked = event.card->locked;
+            memcpy(replay.text, event.card->text, sizeof(replay.text));
+        }
+        else if (event.type == NFCEventType::CARD_REMOVED)
+        {
+            replay.removals++;
+        }
+        else
+        {
+            replay.changes++;
+        }
+    }
+
+    /**
+     * @brief Copy test/data/nfc/name into memory storage and load it as the rover would
+     */
+    bool loadDump(MemoryStorage& storage, const char* name, NFCDump& dump)
+    {
+        std::string path = std::string("/nfc/") + name;
+        FILE* file = fopen((std::string(TEST_DATA_DIR) + path).c_str(), "rb");
+        if (file)
+        {
+            uint8_t buffer[512];
+            size_t length;
+            HostTest::Bytes& bytes = storage.files[path];
+            while ((length = fread(buffer, 1, sizeof(buffer), file)) > 0) bytes.insert(bytes.end(), buffer, buffer + length);
+            fclose(file);
+        }
+        return NFCDumpReader::load(storage.backend(), path.c_str(), dump);
+    }
+
+    /**
+     * @brief Tap dump on a fresh reader: hold it until 600 ms after arrival, then wait for removal
+     */
+    void replayDump(const NFCDump& dump, Replay& replay)
+    {
+        memset(&replay, 0, sizeof(replay));
+        PN532Emulator chip;
+        NFCEngine engine(chip.transport(), recordEvent, &replay);
+        engine.start();
+        chip.place(&dump);
+
+        bool present = true;
+        uint32_t arrived = 0;
+        while (replay.removals == 0 && chip.micros() < REPLAY_MICROS)
+        {
+            engine.update();
+            chip.advance(LOOP_MICROS);
+            if (replay.arrivals == 0)
+            {
+                arrived = chip.micros();
+            }
+            else if (present && chip.micros() - arrived >= HOLD_MICROS)
+            {
+                chip.place(nullptr);
+                present = false;
+            }
+        }
+        replay.stats = engine.stats();
+        replay.bus = chip.stats();
+    }
+
+    void report(const char* name, const Replay& replay)
+    {
+        char message[160];
+        snprintf(message, sizeof(message), "%-18s read %6.1f ms, %2u commands, %4u RF bytes, \"%.32s\"",
+                 name, replay.readMicros / 1e3, replay.bus.commands, replay.bus.rfBytes, replay.text);
+        TEST_MESSAGE(message);
+        for (int i = 0; i < NFC_STAGE_COUNT; i++)
+        {
+            if (replay.stats.stageEntries[i] == 0) continue;
+            snprintf(message, sizeof(message), "    %-16s %3u x %8.1f ms", STAGE_NAMES[i],
+                     replay.stats.stageEntries[i], replay.stats.stageMicros[i] / 1e3);
+            TEST_MESSAGE(message);
+        }
+    }
+
+    uint32_t entries(const Replay& replay, NFCStage stage)
+    {
+        return replay.stats.stageEntries[static_cast<int>(stage)];
+    }
+
+    void assertOneTap(const Replay& replay)
+    {
+        TEST_ASSERT_EQUAL_UINT32(1, replay.arrivals);
+        TEST_ASSERT_EQUAL_UINT32(1, replay.removals);
+        TEST_ASSERT_EQUAL_UINT32(0, replay.changes);
+        TEST_ASSERT_EQUAL_UINT32(0, replay.stats.errors);
+        // Found once, then PRESENT and CHECK_PRESENCE take turns until the card leaves
+        TEST_ASSERT_EQUAL_UINT32(1, entries(replay, NFCStage::CONFIGURE));
+        TEST_ASSERT_EQUAL_UINT32(2, entries(replay, NFCStage::DETECT));
+        TEST_ASSERT_EQUAL_UINT32(entries(replay, NFCStage::CHECK_PRESENCE), entries(replay, NFCStage::PRESENT));
+    }
+
+    MemoryStorage storage;
+    NFCDump dump;
+    Replay replay;
+}
+
+void setUp()
+{
+    storage = MemoryStorage();
+    memset(&dump, 0, sizeof(dump));
+}
+
+void tearDown() {}
+
+void test_mifare_classic_capture_is_announced_as_encrypted()
+{
+    TEST_ASSERT_TRUE(loadDump(storage, "LaundryLoaded.nfc", dump));
+    TEST_ASSERT_EQUAL(static_cast<int>(NFCDumpKind::MIFARE_CLASSIC), static_cast<int>(dump.kind));
+    TEST_ASSERT_EQUAL_UINT8(4, dump.uidLength);
+    TEST_ASSERT_EQUAL_HEX8(0x82, dump.uid[0]);
+    TEST_ASSERT_EQUAL_HEX8(0x08, dump.sak);
+    TEST_ASSERT_EQUAL_UINT16(1024, dump.length);
+
+    replayDump(dump, replay);
+    report("LaundryLoaded.nfc", replay);
+    assertOneTap(replay);
+    TEST_ASSERT_TRUE(replay.locked);
+    TEST_ASSERT_EQUAL_STRING("CARD ENCRYPTED", replay.text);
+    TEST_ASSERT_TRUE(replay.readMicros < CLASSIC_BUDGET);
+
+    // Nothing behind the keys is readable, so no pages are fetched
+    TEST_ASSERT_EQUAL_UINT32(1, entries(replay, NFCStage::READ_CAPABILITY));
+    TEST_ASSERT_EQUAL_UINT32(0, entries(replay, NFCStage::READ_PAGES));
+    TEST_ASSERT_EQUAL_UINT32(0, entries(replay, NFCStage::RESELECT));
+    TEST_ASSERT_EQUAL_UINT32(1, entries(replay, NFCStage::PARSE));
+}
+
+void test_ntag215_text_is_read_within_budget()
+{
+    TEST_ASSERT_TRUE(loadDump(storage, "ntag215.nfc", dump));
+    TEST_ASSERT_EQUAL(static_cast<int>(NFCDumpKind::NTAG), static_cast<int>(dump.kind));
+    TEST_ASSERT_EQUAL_UINT16(135 * 4, dump.length);
+    TEST_ASSERT_EQUAL_UINT32(0, dump.unknown);
+
+    replayDump(dump, replay);
+    report("ntag215.nfc", replay);
+    assertOneTap(replay);
+    TEST_ASSERT_FALSE(replay.locked);
+    TEST_ASSERT_EQUAL_STRING("ROVERBYTE789", replay.text);
+    TEST_ASSERT_TRUE(replay.readMicros < NTAG215_BUDGET);
+    TEST_ASSERT_EQUAL_UINT32(1, entries(replay, NFCStage::READ_CAPABILITY));
+    TEST_ASSERT_EQUAL_UINT32(1, entries(replay, NFCStage::READ_PAGES));
+    TEST_ASSERT_EQUAL_UINT32(1, entries(replay, NFCStage::PARSE));
+    TEST_ASSERT_EQUAL_UINT32(0, entries(replay, NFCStage::RESELECT));
+}
+
+void test_ntag216_long_text_needs_no_reselect()
+{
+    TEST_ASSERT_TRUE(loadDump(storage, "ntag216.nfc", dump));
+    TEST_ASSERT_EQUAL_UINT16(231 * 4, dump.length);
+
+    replayDump(dump, replay);
+    report("ntag216.nfc", replay);
+    assertOneTap(replay);
+    // 700 characters of text, cut to what NFCCard holds
+    TEST_ASSERT_EQUAL_UINT32(NFCCard::TEXT_LENGTH - 1, strlen(replay.text));
+    TEST_ASSERT_EQUAL_UINT32(NFCCard::TEXT_LENGTH - 1, strspn(replay.text, "x"));
+    TEST_ASSERT_TRUE(replay.readMicros < NTAG216_BUDGET);
+    TEST_ASSERT_EQUAL_UINT32(1, entries(replay, NFCStage::READ_CAPABILITY));
+    TEST_ASSERT_EQUAL_UINT32(1, entries(replay, NFCStage::READ_PAGES));
+    TEST_ASSERT_EQUAL_UINT32(1, entries(replay, NFCStage::PARSE));
+    TEST_ASSERT_EQUAL_UINT32(0, entries(replay, NFCStage::RESELECT));
+    TEST_ASSERT_EQUAL_UINT32(0, replay.stats.fallbacks);
+}
+
+void test_ultralight_falls_back_from_fast_read_once()
+{
+    TEST_ASSERT_TRUE(loadDump(storage, "ultralight.nfc", dump));
+    TEST_ASSERT_EQUAL(static_cast<int>(NFCDumpKind::ULTRALIGHT), static_cast<int>(dump.kind));
+
+    replayDump(dump, replay);
+    report("ultralight.nfc", replay);
+    assertOneTap(replay);
+    TEST_ASSERT_EQUAL_STRING("UL", replay.text);
+    TEST_ASSERT_TRUE(replay.readMicros < ULTRALIGHT_BUDGET);
+    TEST_ASSERT_EQUAL_UINT32(1, replay.stats.fallbacks);
+    TEST_ASSERT_EQUAL_UINT32(1, entries(replay, NFCStage::READ_CAPABILITY));
+    TEST_ASSERT_EQUAL_UINT32(2, entries(replay, NFCStage::READ_PAGES));
+    TEST_ASSERT_EQUAL_UINT32(1, entries(replay, NFCStage::RESELECT));
+    TEST_ASSERT_EQUAL_UINT32(1, entries(replay, NFCStage::PARSE));
+}
+
+void test_malformed_dumps_are_refused()
+{
+    const char* names[] = { "bad_filetype.nfc", "bad_hex.nfc", "bad_page.nfc", "no_memory.nfc", "missing.nfc" };
+    for (const char* name : names)
+    {
+        TEST_ASSERT_FALSE_MESSAGE(loadDump(storage, name, dump), name);
+    }
+
+    NFCDumpReader reader(dump);
+    TEST_ASSERT_TRUE(reader.feed("Filetype: Flipper NFC device"));
+    TEST_ASSERT_TRUE(reader.feed(""));
+    TEST_ASSERT_TRUE(reader.feed("# comment"));
+    TEST_ASSERT_FALSE(reader.feed("Page 1: 00"));
+    TEST_ASSERT_EQUAL_UINT16(4, reader.errorLine());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_mifare_classic_capture_is_announced_as_encrypted);
+    RUN_TEST(test_ntag215_text_is_read_within_budget);
+    RUN_TEST(test_ntag216_long_text_needs_no_reselect);
+    RUN_TEST(test_ultralight_falls_back_from_fast_read_once);
+    RUN_TEST(test_malformed_dumps_are_refused);
+    return UNITY_END();
+}
@@ -0,0 +1,318 @@
+/**
+ * @file test_main.cpp
+ * @brief NFCEngine arrivals, removals, swaps and faults against PN532Emulator
+ *
+ * Cards are NFCDumps built in memory and put in and out of the emulator's
+ * field on a script. The link wraps the emulator's transport so faults can
+ * be injected, and so ready() can be made to wait the way the Adafruit
+ * driver does, for a baseline of how long the loop used to stall.
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+#include "PsychicCortex/NFCEngine.h"
+#include "PsychicCortex/PN532Emulator.h"
+
+using namespace PsychicCortex;
+
+namespace
+{
+    const uint32_t LOOP_MICROS = 5000;
+    const uint32_t SPIN_STEP = 100;
+    const uint32_t SPIN_LIMIT = 5000000;        // A blocking read gives up eventually
+    const uint32_t MAX_STALL = NFCEngine::UPDATE_BUDGET + 1000;
+    const uint32_t MAX_TAP_TO_EVENT = 250000;     // Whole NTAG215 user area at a 5 ms loop
+
+    struct Placement
+    {
+        uint32_t at;
+        const NFCDump* dump;                    // nullptr takes the card away
+    };
+
+    struct Seen
+    {
+        NFCEventType type;
+        uint32_t at;
+        uint8_t uid0;
+        char text[NFCCard::TEXT_LENGTH];
+        uint32_t readMicros;
+    };
+
+    /**
+     * @brief The emulator, a script of placements and the faults to inject
+     */
+    struct Bench
+    {
+        PN532Emulator chip;
+        PN532Transport link;
+        std::vector<Placement> script;
+        size_t next;
+        bool spin;
+        uint32_t dropAckEvery;
+        uint32_t corruptEvery;
+        uint32_t commands;
+        uint32_t responses;
+        std::vector<Seen> seen;
+    };
+
+    void play(Bench& bench)
+    {
+        while (bench.next < bench.script.size() && bench.chip.micros() >= bench.script[bench.next].at)
+        {
+            bench.chip.place(bench.script[bench.next].dump);
+            bench.next++;
+        }
+    }
+
+    uint32_t benchMicros(void* context)
+    {
+        Bench& bench = *static_cast<Bench*>(context);
+        return bench.link.micros(bench.link.context);
+    }
+
+    bool benchWrite(void* context, const uint8_t* data, size_t length)
+    {
+        Bench& bench = *static_cast<Bench*>(context);
+        play(bench);
+        if (!PN532Frame::isAck(data, length))
+        {
+            bench.commands++;
+            if (bench.dropAckEvery != 0 && bench.commands % bench.dropAckEvery == 0)
+            {
+                // Lost on the bus: the chip never sees it, so no ACK comes
+                bench.chip.advance((length + 1) * PN532Emulator::BUS_BYTE);
+                return true;
+            }
+        }
+        return bench.link.write(bench.link.context, data, length);
+    }
+
+    bool benchReady(void* context)
+    {
+        Bench& bench = *static_cast<Bench*>(context);
+        play(bench);
+        if (!bench.spin) return bench.link.ready(bench.link.context);
+
+        uint32_t start = bench.chip.micros();
+        while (!bench.link.ready(bench.link.context))
+        {
+            if (bench.chip.micros() - start > SPIN_LIMIT) return false;
+            bench.chip.advance(SPIN_STEP);
+            play(bench);
+        }
+        return true;
+    }
+
+    bool benchRead(void* context, uint8_t* data, size_t length)
+    {
+        Bench& bench = *static_cast<Bench*>(context);
+        if (!bench.link.read(bench.link.context, data, length)) return false;
+        if (!PN532Frame::isAck(data, length))
+        {
+            bench.responses++;
+            if (bench.corruptEvery != 0 && bench.responses % bench.corruptEvery == 0) data[6] ^= 0x55;
+        }
+        return true;
+    }
+
+    void resetBench(Bench& bench)
+    {
+        bench.chip = PN532Emulator();
+        bench.link = bench.chip.transport();
+        bench.script.clear();
+        bench.next = 0;
+        bench.spin = false;
+        bench.dropAckEvery = 0;
+        bench.corruptEvery = 0;
+        bench.commands = 0;
+        bench.responses = 0;
+        bench.seen.clear();
+    }
+
+    void recordEvent(void* context, const NFCEvent& event)
+    {
+        Bench& bench = *static_cast<Bench*>(context);
+        Seen seen;
+        seen.type = event.type;
+        seen.at = bench.chip.micros();
+        seen.uid0 = event.card->uid[0];
+        memcpy(seen.text, event.card->text, sizeof(seen.text));
+        seen.readMicros = event.readMicros;
+        bench.seen.push_back(seen);
+    }
+
+    /**
+     * @brief An NTAG215 holding one NDEF text record, or with its access bits set
+     */
+    void makeTag(NFCDump& dump, uint8_t id, const char* text, bool locked)
+    {
+        memset(&dump, 0, sizeof(dump));
+        dump.kind = NFCDumpKind::NTAG;
+        dump.uidLength = 7;
+        for (uint8_t i = 0; i < dump.uidLength; i++) dump.uid[i] = static_cast<uint8_t>(id + i);
+        dump.atqa[0] = 0x00;
+        dump.atqa[1] = 0x44;
+        dump.length = 135 * 4;
+
+        uint8_t* capability = dump.memory + 3 * 4;
+        capability[0] = 0xE1;
+        capability[1] = 0x10;
+        capability[2] = 0x3E;
+        capability[3] = locked ? 0x0F : 0x00;
+
+        // TLV 03, then a short well-known "T" record: status, "en", text
+        uint8_t textLength = static_cast<uint8_t>(strlen(text));
+        uint8_t* tlv = dump.memory + 4 * 4;
+        tlv[0] = 0x03;
+        tlv[1] = static_cast<uint8_t>(7 + textLength);
+        tlv[2] = 0xD1;
+        tlv[3] = 0x01;
+        tlv[4] = static_cast<uint8_t>(3 + textLength);
+        tlv[5] = 'T';
+        tlv[6] = 0x02;
+        tlv[7] = 'e';
+        tlv[8] = 'n';
+        memcpy(tlv + 9, text, textLength);
+        tlv[9 + textLength] = 0xFE;
+    }
+
+    void run(Bench& bench, NFCEngine& engine, uint32_t until)
+    {
+        while (bench.chip.micros() < until)
+        {
+            bench.chip.advance(LOOP_MICROS);
+            play(bench);
+            engine.update();
+        }
+    }
+
+    PN532Transport benchTransport(Bench& bench)
+    {
+        PN532Transport transport = { benchMicros, benchWrite, benchReady, benchRead, &bench };
+        return transport;
+    }
+
+    Bench bench;
+    NFCDump first;
+    NFCDump second;
+    NFCDump locked;
+    NFCDump swapped;
+}
+
+void setUp()
+{
+    resetBench(bench);
+    makeTag(first, 0x10, "ROVER123", false);
+    makeTag(second, 0x20, "Hello rover, this is a longer NTAG text payload!", false);
+    makeTag(locked, 0x30, "x", true);
+    makeTag(swapped, 0x40, "swapped", false);
+}
+
+void tearDown() {}
+
+void test_arrivals_removals_and_swaps_are_reported()
+{
+    bench.script = {
+        { 1000000, &first }, { 3000000, nullptr },
+        { 4000000, &second }, { 4500000, nullptr },
+        { 6000000, &locked }, { 7000000, &swapped }, { 9000000, nullptr }
+    };
+    NFCEngine engine(benchTransport(bench), recordEvent, &bench);
+    engine.start();
+    run(bench, engine, 12000000);
+
+    const std::vector<Seen>& seen = bench.seen;
+    TEST_ASSERT_EQUAL_UINT32(8, seen.size());
+    TEST_ASSERT_TRUE(seen[0].type == NFCEventType::CARD_ARRIVED);
+    TEST_ASSERT_EQUAL_HEX8(0x10, seen[0].uid0);
+    TEST_ASSERT_EQUAL_STRING("ROVER123", seen[0].text);
+    TEST_ASSERT_TRUE(seen[1].type == NFCEventType::CARD_REMOVED);
+    TEST_ASSERT_TRUE(seen[1].at >= 3000000 && seen[1].at < 3000000 + 2 * NFCEngine::PRESENCE_INTERVAL);
+    TEST_ASSERT_TRUE(seen[2].type == NFCEventType::CARD_ARRIVED);
+    TEST_ASSERT_EQUAL_STRING("Hello rover, this is a longer NTAG text payload!", seen[2].text);
+    TEST_ASSERT_TRUE(seen[3].type == NFCEventType::CARD_REMOVED);
+    TEST_ASSERT_EQUAL_STRING("CARD ENCRYPTED", seen[4].text);
+
+    // Swapped in place: the old card leaves before the new one arrives
+    TEST_ASSERT_TRUE(seen[5].type == NFCEventType::CARD_REMOVED);
+    TEST_ASSERT_EQUAL_HEX8(0x30, seen[5].uid0);
+    TEST_ASSERT_TRUE(seen[6].type == NFCEventType::CARD_ARRIVED);
+    TEST_ASSERT_EQUAL_HEX8(0x40, seen[6].uid0);
+    TEST_ASSERT_EQUAL_STRING("swapped", seen[6].text);
+    TEST_ASSERT_TRUE(seen[7].type == NFCEventType::CARD_REMOVED);
+
+    const NFCEngineStats& stats = engine.stats();
+    TEST_ASSERT_EQUAL_UINT32(0, stats.errors);
+    TEST_ASSERT_EQUAL_UINT32(4, stats.arrivals);
+    TEST_ASSERT_EQUAL_UINT32(4, stats.removals);
+    TEST_ASSERT_TRUE(stats.maxUpdateMicros <= MAX_STALL);
+    TEST_ASSERT_TRUE(seen[0].at - 1000000 < MAX_TAP_TO_EVENT);
+    TEST_ASSERT_TRUE(seen[2].at - 4000000 < MAX_TAP_TO_EVENT);
+
+    char message[128];
+    snprintf(message, sizeof(message), "tap to event %.1f / %.1f ms, longest update %u us, mean %.1f us over %u updates",
+             (seen[0].at - 1000000) / 1e3, (seen[2].at - 4000000) / 1e3, stats.maxUpdateMicros,
+             static_cast<double>(stats.updateMicros) / stats.updates, stats.updates);
+    TEST_MESSAGE(message);
+}
+
+void test_cards_are_read_through_dropped_acks_and_corrupted_frames()
+{
+    bench.script = { { 1000000, &first }, { 5000000, nullptr }, { 6000000, &second }, { 9000000, nullptr } };
+    bench.dropAckEvery = 23;
+    bench.corruptEvery = 11;
+    NFCEngine engine(benchTransport(bench), recordEvent, &bench);
+    engine.start();
+    run(bench, engine, 12000000);
+
+    uint32_t arrivals = 0;
+    uint32_t removals = 0;
+    for (const Seen& seen : bench.seen)
+    {
+        if (seen.type == NFCEventType::CARD_ARRIVED) arrivals++;
+        if (seen.type == NFCEventType::CARD_REMOVED) removals++;
+    }
+    const NFCEngineStats& stats = engine.stats();
+    TEST_ASSERT_EQUAL_UINT32(2, arrivals);
+    TEST_ASSERT_EQUAL_UINT32(2, removals);
+    TEST_ASSERT_EQUAL_STRING("ROVER123", bench.seen[0].text);
+    TEST_ASSERT_GREATER_THAN(0, stats.errors);
+    TEST_ASSERT_GREATER_THAN(0, stats.timeouts);
+    TEST_ASSERT_TRUE(stats.maxUpdateMicros <= MAX_STALL);
+
+    char message[96];
+    snprintf(message, sizeof(message), "%u errors, %u timeouts, longest update %u us",
+             stats.errors, stats.timeouts, stats.maxUpdateMicros);
+    TEST_MESSAGE(message);
+}
+
+void test_waiting_on_the_chip_stalls_until_the_tap()
+{
+    // The blocking driver's way: ready() spins, so detection holds the loop until a card comes
+    bench.script = { { 1000000, &first }, { 3000000, nullptr } };
+    bench.spin = true;
+    NFCEngine engine(benchTransport(bench), recordEvent, &bench);
+    engine.start();
+    bench.chip.advance(LOOP_MICROS);
+    engine.update(0xFFFFFFFF);
+    bench.chip.advance(LOOP_MICROS);
+    engine.update(0xFFFFFFFF);
+
+    uint32_t blockingStall = engine.stats().maxUpdateMicros;
+    TEST_ASSERT_GREATER_THAN(900000, blockingStall);
+
+    char message[64];
+    snprintf(message, sizeof(message), "waiting driver stalls %.1f ms", blockingStall / 1e3);
+    TEST_MESSAGE(message);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_arrivals_removals_and_swaps_are_reported);
+    RUN_TEST(test_cards_are_read_through_dropped_acks_and_corrupted_frames);
+    RUN_TEST(test_waiting_on_the_chip_stalls_until_the_tap);
+    return UNITY_END();
+}
@@ -0,0 +1,237 @@
+/**
+ * @file test_main.cpp
+ * @brief Commands and time NFCEngine needs to read NTAG user areas with FAST_READ
+ *
+ * Each tag is tapped on its own through PN532Emulator, and the commands
+ * sent between the card answering detection and CARD_ARRIVED are counted
+ * at the transport. The same NTAG215 is also presented as an Ultralight,
+ * which refuses FAST_READ, to compare with reading 16 bytes at a time.
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include "PsychicCortex/NFCEngine.h"
+#include "PsychicCortex/PN532Emulator.h"
+
+using namespace PsychicCortex;
+
+namespace
+{
+    const uint32_t LOOP_MICROS = 5000;
+    const uint32_t TAP_MICROS = 1000000;
+    const uint16_t NTAG213_PAGES = 45;
+    const uint16_t NTAG215_PAGES = 135;
+    const uint16_t NTAG216_PAGES = 231;
+    const uint16_t ULTRALIGHT_PAGES = 16;
+
+    struct Reader
+    {
+        PN532Emulator chip;
+        PN532Transport link;
+        const NFCEngine* engine;
+        uint32_t sinceDetect;       // Commands since detection; a reselect counts as one
+        uint32_t readCommands;      // sinceDetect at CARD_ARRIVED
+        uint32_t readMicros;
+        uint16_t dataLength;
+        uint32_t arrivals;
+    };
+
+    uint32_t readerMicros(void* context)
+    {
+        Reader& reader = *static_cast<Reader*>(context);
+        return reader.link.micros(reader.link.context);
+    }
+
+    bool readerWrite(void* context, const uint8_t* data, size_t length)
+    {
+        Reader& reader = *static_cast<Reader*>(context);
+        if (!PN532Frame::isAck(data, length))
+        {
+            bool detect = length > 6 && data[6] == PN532Frame::IN_LIST_PASSIVE_TARGET &&
+                          reader.engine->stage() != NFCStage::RESELECT;
+            reader.sinceDetect = detect ? 0 : reader.sinceDetect + 1;
+        }
+        return reader.link.write(reader.link.context, data, length);
+    }
+
+    bool readerReady(void* context)
+    {
+        Reader& reader = *static_cast<Reader*>(context);
+        return reader.link.ready(reader.link.context);
+    }
+
+    bool readerRead(void* context, uint8_t* data, size_t length)
+    {
+        Reader& reader = *static_cast<Reader*>(context);
+        return reader.link.read(reader.link.context, data, length);
+    }
+
+    void recordArrival(void* context, const NFCEvent& event)
+    {
+        Reader& reader = *static_cast<Reader*>(context);
+        if (event.type != NFCEventType::CARD_ARRIVED) return;
+        reader.readCommands = reader.sinceDetect;
+        reader.readMicros = event.readMicros;
+        reader.dataLength = event.card->dataLength;
+        reader.arrivals++;
+    }
+
+    /**
+     * @brief A tag of pages pages whose capability container claims userBytes
+     */
+    void makeTag(NFCDump& dump, NFCDumpKind kind, uint8_t id, uint16_t pages, uint16_t userBytes)
+    {
+        memset(&dump, 0, sizeof(dump));
+        dump.kind = kind;
+        dump.uidLength = 7;
+        for (uint8_t i = 0; i < dump.uidLength; i++) dump.uid[i] = static_cast<uint8_t>(id + i);
+        dump.atqa[1] = 0x44;
+        dump.length = static_cast<uint16_t>(pages * 4);
+
+        uint8_t* capability = dump.memory + 3 * 4;
+        capability[0] = 0xE1;
+        capability[1] = 0x10;
+        capability[2] = static_cast<uint8_t>(userBytes / 8);
+        for (uint16_t i = 0; i < userBytes; i++) dump.memory[16 + i] = static_cast<uint8_t>('a' + i % 26);
+    }
+
+    /**
+     * @brief Hold a card in the field for a second, then take it away for another
+     */
+    void tap(Reader& reader, NFCEngine& engine, const NFCDump& dump)
+    {
+        reader.chip.place(&dump);
+        uint32_t start = reader.chip.micros();
+        while (reader.chip.micros() - start < TAP_MICROS)
+        {
+            reader.chip.advance(LOOP_MICROS);
+            engine.update();
+        }
+        reader.chip.place(nullptr);
+        start = reader.chip.micros();
+        while (reader.chip.micros() - start < TAP_MICROS)
+        {
+            reader.chip.advance(LOOP_MICROS);
+            engine.update();
+        }
+    }
+
+    void report(const char* name, const Reader& reader)
+    {
+        char message[96];
+        snprintf(message, sizeof(message), "%-24s %3u B: %u commands, %6.1f ms",
+                 name, reader.dataLength, reader.readCommands, reader.readMicros / 1e3);
+        TEST_MESSAGE(message);
+    }
+
+    Reader reader;
+    NFCDump tag;
+
+    PN532Transport readerTransport()
+    {
+        PN532Transport transport = { readerMicros, readerWrite, readerReady, readerRead, &reader };
+        return transport;
+    }
+}
+
+void setUp()
+{
+    reader.chip = PN532Emulator();
+    reader.link = reader.chip.transport();
+    reader.engine = nullptr;
+    reader.sinceDetect = 0;
+    reader.readCommands = 0;
+    reader.readMicros = 0;
+    reader.dataLength = 0;
+    reader.arrivals = 0;
+}
+
+void tearDown() {}
+
+void test_user_areas_come_in_fast_read_runs()
+{
+    NFCEngine engine(readerTransport(), recordArrival, &reader);
+    reader.engine = &engine;
+    engine.start();
+
+    // Page 3's READ brings 12 user bytes; FAST_READ runs of 28 pages bring the rest
+    makeTag(tag, NFCDumpKind::NTAG, 0x13, NTAG213_PAGES, 144);
+    tap(reader, engine, tag);
+    report("NTAG213", reader);
+    TEST_ASSERT_EQUAL_UINT16(144, reader.dataLength);
+    TEST_ASSERT_EQUAL_UINT32(3, reader.readCommands);
+
+    makeTag(tag, NFCDumpKind::NTAG, 0x15, NTAG215_PAGES, 496);
+    tap(reader, engine, tag);
+    report("NTAG215", reader);
+    TEST_ASSERT_EQUAL_UINT16(496, reader.dataLength);
+    TEST_ASSERT_EQUAL_UINT32(6, reader.readCommands);
+    uint32_t firstTap = reader.readMicros;
+
+    // Its container is known now, so page 3 is not read again
+    tap(reader, engine, tag);
+    report("NTAG215, container known", reader);
+    TEST_ASSERT_EQUAL_UINT16(496, reader.dataLength);
+    TEST_ASSERT_EQUAL_UINT32(5, reader.readCommands);
+    TEST_ASSERT_TRUE(reader.readMicros < firstTap);
+    TEST_ASSERT_EQUAL_UINT32(1, engine.stats().capabilityHits);
+
+    makeTag(tag, NFCDumpKind::NTAG, 0x16, NTAG216_PAGES, 872);
+    tap(reader, engine, tag);
+    report("NTAG216", reader);
+    TEST_ASSERT_EQUAL_UINT16(872, reader.dataLength);
+    TEST_ASSERT_EQUAL_UINT32(9, reader.readCommands);
+
+    TEST_ASSERT_EQUAL_UINT32(4, reader.arrivals);
+    TEST_ASSERT_EQUAL_UINT32(0, engine.stats().errors);
+    TEST_ASSERT_EQUAL_UINT32(0, engine.stats().fallbacks);
+}
+
+void test_tags_refusing_fast_read_fall_back_to_reads()
+{
+    NFCEngine engine(readerTransport(), recordArrival, &reader);
+    reader.engine = &engine;
+    engine.start();
+
+    // Refused FAST_READ, select again, then READs of 16 bytes for the other 36
+    makeTag(tag, NFCDumpKind::ULTRALIGHT, 0x01, ULTRALIGHT_PAGES, 48);
+    tap(reader, engine, tag);
+    report("Ultralight", reader);
+    TEST_ASSERT_EQUAL_UINT16(48, reader.dataLength);
+    TEST_ASSERT_EQUAL_UINT32(6, reader.readCommands);
+    TEST_ASSERT_EQUAL_UINT32(1, engine.stats().fallbacks);
+}
+
+void test_fast_read_beats_16_byte_reads()
+{
+    NFCEngine engine(readerTransport(), recordArrival, &reader);
+    reader.engine = &engine;
+    engine.start();
+
+    makeTag(tag, NFCDumpKind::NTAG, 0x15, NTAG215_PAGES, 496);
+    tap(reader, engine, tag);
+    uint32_t fastCommands = reader.readCommands;
+    uint32_t fastMicros = reader.readMicros;
+
+    // The same memory from a tag that only answers READ
+    makeTag(tag, NFCDumpKind::ULTRALIGHT, 0x25, NTAG215_PAGES, 496);
+    tap(reader, engine, tag);
+    report("NTAG215 by READ only", reader);
+    TEST_ASSERT_EQUAL_UINT16(496, reader.dataLength);
+    TEST_ASSERT_TRUE(reader.readCommands > 4 * fastCommands);
+    TEST_ASSERT_TRUE(reader.readMicros > 2 * fastMicros);
+
+    char message[64];
+    snprintf(message, sizeof(message), "FAST_READ %.1fx quicker", static_cast<double>(reader.readMicros) / fastMicros);
+    TEST_MESSAGE(message);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_user_areas_come_in_fast_read_runs);
+    RUN_TEST(test_tags_refusing_fast_read_fall_back_to_reads);
+    RUN_TEST(test_fast_read_beats_16_byte_reads);
+    return UNITY_END();
+}
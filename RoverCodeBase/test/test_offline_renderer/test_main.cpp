@@ -0,0 +1,365 @@
+/**
+ * @file test_main.cpp
+ * @brief Every tune, tone and error sound against the recorded render goldens
+ *
+ * Renders go through the real ToneSequencer and WavetableSynth, as on the
+ * rover. Only the timeline hash and duration are compared: the PCM hash
+ * depends on the toolchain's sinf(), so it is checked for repeatability on
+ * this host but never against a recorded value.
+ *
+ * Every render is also written out as a WAV file and a CSV of its LED frames
+ * under RENDER_OUTPUT_DIR, for listening to and diffing by hand.
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <chrono>
+#include <string>
+#include "AuditoryCortex/AudioCodecs.h"
+#include "AuditoryCortex/OfflineRenderer.h"
+#include "AuditoryCortex/Tunes.h"
+
+// SoundEffect also names an AuditoryTypes enum, so the struct is spelled out below
+using namespace AuditoryCortex;
+using PC::AudioTypes::Tone;
+using PC::AudioTypes::TunesTypes;
+
+#ifndef RENDER_OUTPUT_DIR
+#define RENDER_OUTPUT_DIR ".pio/renders"
+#endif
+
+namespace
+{
+    const uint32_t SAMPLE_RATE = 44100;
+    const uint8_t TUNE_COUNT = static_cast<uint8_t>(TunesTypes::CHRISTMAS_SONG) + 1;
+    const uint8_t TONE_COUNT = static_cast<uint8_t>(Tone::MENU_CHANGE) + 1;
+    const double MIN_REALTIME_FACTOR = 100.0;
+
+    struct Golden
+    {
+        const char* name;
+        uint32_t timelineHash;
+        uint32_t durationMs;
+    };
+
+    /**
+     * @brief Recorded timelines; re-record when a tune or effect is changed on purpose
+     */
+    const Golden GOLDENS[] =
+    {
+        { "Quantum Tails", 0x0F2A5854u, 2330 },
+        { "Winter Dance", 0xCF6BD95Fu, 7003 },
+        { "Symphonic Threads", 0x156DBAFBu, 3959 },
+        { "Entangled Hearts", 0x4B541448u, 3578 },
+        { "Celebration Sparks", 0x1C0D9A43u, 5378 },
+        { "Spring Awakening", 0x727B168Eu, 2768 },
+        { "Heart of the Home", 0xF78B7BF7u, 3752 },
+        { "Pillars of Strength", 0xC5984BEBu, 4083 },
+        { "Northern Lights", 0xEF50293Au, 1831 },
+        { "Stars and Stripes", 0x638D0FC1u, 3332 },
+        { "Unity in Motion", 0x50512495u, 3082 },
+        { "Autumn's Farewell", 0xCC106620u, 11958 },
+        { "Phantom Waltz", 0xD166E024u, 5834 },
+        { "Harvest Hymn", 0xC738E7DEu, 2644 },
+        { "Painted Skies", 0x5E8E9FDAu, 3581 },
+
+        { "error_recording", 0x609686B6u, 1082 },
+        { "error_storage", 0x67DE0AF4u, 1082 },
+        { "error_playback", 0x24DF4EB6u, 1082 },
+        { "success", 0xC3873442u, 583 },
+        { "notification", 0xC1C55150u, 182 },
+        { "level_up", 0xAC16B1EDu, 682 },
+        { "menu_select", 0x87EE6535u, 632 }
+    };
+
+    const Golden* findGolden(const char* name)
+    {
+        for (const Golden& golden : GOLDENS)
+        {
+            if (strcmp(golden.name, name) == 0) return &golden;
+        }
+        return nullptr;
+    }
+
+    uint32_t hostMicros()
+    {
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    struct PcmCount
+    {
+        uint32_t frames;
+        uint32_t blocks;
+    };
+
+    void countPcm(void* context, const int16_t*, size_t frames)
+    {
+        PcmCount& count = *static_cast<PcmCount*>(context);
+        count.frames += frames;
+        count.blocks++;
+    }
+
+    void checkGolden(const char* name, const RenderResult& result)
+    {
+        const Golden* golden = findGolden(name);
+        TEST_ASSERT_NOT_NULL_MESSAGE(golden, name);
+        TEST_ASSERT_FALSE_MESSAGE(result.truncated, name);
+        TEST_ASSERT_EQUAL_HEX32_MESSAGE(golden->timelineHash, result.timelineHash, name);
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(golden->durationMs, result.durationMs, name);
+    }
+
+    /**
+     * @brief WAV file and LED timeline being written for one render
+     */
+    struct Export
+    {
+        FILE* wav;
+        FILE* timeline;
+        uint32_t dataBytes;
+        uint32_t ledFrames;
+    };
+
+    void writePcm(void* context, const int16_t* samples, size_t frames)
+    {
+        Export& out = *static_cast<Export*>(context);
+        for (size_t i = 0; i < frames; i++)
+        {
+            uint16_t sample = static_cast<uint16_t>(samples[i]);
+            uint8_t bytes[2] = { static_cast<uint8_t>(sample), static_cast<uint8_t>(sample >> 8) };
+            fwrite(bytes, 1, sizeof(bytes), out.wav);
+        }
+        out.dataBytes += frames * sizeof(int16_t);
+    }
+
+    void writeLedFrame(void* context, uint32_t frame, uint32_t ledMask, uint16_t noteIndex)
+    {
+        Export& out = *static_cast<Export*>(context);
+        fprintf(out.timeline, "%u,%.3f,%u,0x%02X\n", frame, frame * 1000.0 / SAMPLE_RATE, noteIndex, ledMask);
+        out.ledFrames++;
+    }
+
+    void makeDirectories(const std::string& path)
+    {
+        for (size_t slash = path.find('/', 1); slash != std::string::npos; slash = path.find('/', slash + 1))
+        {
+            mkdir(path.substr(0, slash).c_str(), 0755);
+        }
+        mkdir(path.c_str(), 0755);
+    }
+
+    /**
+     * @brief File stem for a tune or effect name: lower case, anything else as '_'
+     */
+    std::string fileStem(const char* name)
+    {
+        std::string stem;
+        for (const char* c = name; *c; c++)
+        {
+            bool alnum = (*c >= 'a' && *c <= 'z') || (*c >= '0' && *c <= '9');
+            bool upper = *c >= 'A' && *c <= 'Z';
+            stem += alnum ? *c : upper ? static_cast<char>(*c - 'A' + 'a') : '_';
+        }
+        return stem;
+    }
+
+    /**
+     * @brief Render a tune or effect to <stem>.wav and <stem>.csv, then read the WAV back
+     */
+    RenderResult exportRender(OfflineRenderer& renderer, const char* name, const Tune* tune, const AuditoryCortex::SoundEffect* effect)
+    {
+        std::string stem = std::string(RENDER_OUTPUT_DIR) + "/" + fileStem(name);
+        Export out = { fopen((stem + ".wav").c_str(), "wb"), fopen((stem + ".csv").c_str(), "w"), 0, 0 };
+        TEST_ASSERT_NOT_NULL_MESSAGE(out.wav, name);
+        TEST_ASSERT_NOT_NULL_MESSAGE(out.timeline, name);
+
+        // Header goes in first with no data, and is rewritten once the length is known
+        uint8_t header[WavCodec::MAX_HEADER_BYTES];
+        size_t headerBytes = WavCodec::buildHeader(header, RecordingFormat::PCM16, SAMPLE_RATE, 0);
+        fwrite(header, 1, headerBytes, out.wav);
+        fprintf(out.timeline, "frame,ms,note,leds\n");
+
+        renderer.setPcmSink(writePcm, &out);
+        renderer.setLedSink(writeLedFrame, &out);
+        RenderResult result = tune ? renderer.renderTune(*tune) : renderer.renderEffect(*effect);
+        renderer.setPcmSink(nullptr, nullptr);
+        renderer.setLedSink(nullptr, nullptr);
+
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(headerBytes, WavCodec::buildHeader(header, RecordingFormat::PCM16, SAMPLE_RATE, out.dataBytes), name);
+        fseek(out.wav, 0, SEEK_SET);
+        fwrite(header, 1, headerBytes, out.wav);
+        fclose(out.wav);
+        fclose(out.timeline);
+
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(result.frames * sizeof(int16_t), out.dataBytes, name);
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(result.ledFrames, out.ledFrames, name);
+
+        FILE* wav = fopen((stem + ".wav").c_str(), "rb");
+        TEST_ASSERT_NOT_NULL_MESSAGE(wav, name);
+        size_t read = fread(header, 1, sizeof(header), wav);
+        fseek(wav, 0, SEEK_END);
+        long fileBytes = ftell(wav);
+        fclose(wav);
+
+        WavFormatInfo info;
+        TEST_ASSERT_TRUE_MESSAGE(WavCodec::parseHeader(header, read, info), name);
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(SAMPLE_RATE, info.sampleRate, name);
+        TEST_ASSERT_EQUAL_UINT16_MESSAGE(1, info.channels, name);
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(out.dataBytes, info.dataBytes, name);
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(info.dataOffset + info.dataBytes, static_cast<uint32_t>(fileBytes), name);
+        return result;
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_every_tune_matches_its_golden()
+{
+    OfflineRenderer renderer(SAMPLE_RATE);
+    for (uint8_t t = 0; t < TUNE_COUNT; t++)
+    {
+        const Tune& tune = Tunes::getTune(static_cast<TunesTypes>(t));
+        RenderResult result = renderer.renderTune(tune);
+        checkGolden(tune.name, result);
+
+        // Rests start nothing, and a note past the end of the light table shows none
+        TEST_ASSERT_TRUE_MESSAGE(result.notes > 0 && result.notes <= tune.steps.size(), tune.name);
+        TEST_ASSERT_TRUE_MESSAGE(result.ledFrames > 0 && result.ledFrames <= result.notes, tune.name);
+    }
+}
+
+void test_every_tone_matches_its_golden()
+{
+    OfflineRenderer renderer(SAMPLE_RATE);
+    uint8_t rendered = 0;
+    for (uint8_t t = 0; t < TONE_COUNT; t++)
+    {
+        // NONE, TIMER_DROP and MENU_CHANGE are built in code from runtime context
+        const AuditoryCortex::SoundEffect& effect = SoundEffects::get(static_cast<Tone>(t));
+        if (effect.events.size() == 0) continue;
+
+        RenderResult result = renderer.renderEffect(effect);
+        checkGolden(effect.name, result);
+        TEST_ASSERT_EQUAL_UINT16_MESSAGE(effect.events.size(), result.notes, effect.name);
+        rendered++;
+    }
+    TEST_ASSERT_EQUAL_UINT8(7, rendered);
+}
+
+void test_every_error_sound_matches_its_golden()
+{
+    OfflineRenderer renderer(SAMPLE_RATE);
+    const ErrorSoundType types[] = { ErrorSoundType::RECORDING, ErrorSoundType::STORAGE, ErrorSoundType::PLAYBACK };
+    for (ErrorSoundType type : types)
+    {
+        const AuditoryCortex::SoundEffect& effect = SoundEffects::get(type);
+        TEST_ASSERT_TRUE(effect.events.size() > 0);
+        TEST_ASSERT_TRUE(effect.lane == TonePriority::ALERT);
+        checkGolden(effect.name, renderer.renderEffect(effect));
+    }
+}
+
+void test_renders_repeat_exactly()
+{
+    // Voices keep their phase between notes, so compare from a fresh renderer each time
+    const Tune& tune = Tunes::getTune(TunesTypes::WAKE_ME_UP_WHEN_SEPTEMBER_ENDS);
+    OfflineRenderer first(SAMPLE_RATE);
+    OfflineRenderer second(SAMPLE_RATE);
+    PcmCount count = { 0, 0 };
+    first.setPcmSink(countPcm, &count);
+    RenderResult a = first.renderTune(tune);
+    RenderResult b = second.renderTune(tune);
+
+    TEST_ASSERT_EQUAL_HEX32(a.timelineHash, b.timelineHash);
+    TEST_ASSERT_EQUAL_HEX32(a.pcmHash, b.pcmHash);
+    TEST_ASSERT_EQUAL_UINT32(a.frames, count.frames);
+    TEST_ASSERT_EQUAL_UINT32(a.frames / OfflineRenderer::BLOCK_FRAMES, count.blocks);
+
+    // A second pass on the same renderer keeps the timeline, whatever the phase
+    RenderResult again = first.renderTune(tune);
+    TEST_ASSERT_EQUAL_HEX32(a.timelineHash, again.timelineHash);
+    TEST_ASSERT_EQUAL_UINT32(a.durationMs, again.durationMs);
+}
+
+void test_volume_does_not_change_the_timeline()
+{
+    const Tune& tune = Tunes::getTune(TunesTypes::HAPPY_BIRTHDAY);
+    OfflineRenderer renderer(SAMPLE_RATE);
+    RenderResult quiet = renderer.renderTune(tune, 10);
+    RenderResult loud = renderer.renderTune(tune, 200);
+    TEST_ASSERT_EQUAL_HEX32(quiet.timelineHash, loud.timelineHash);
+    TEST_ASSERT_TRUE(quiet.pcmHash != loud.pcmHash);
+}
+
+void test_every_render_exports_wav_and_timeline()
+{
+    makeDirectories(RENDER_OUTPUT_DIR);
+    OfflineRenderer renderer(SAMPLE_RATE);
+    uint32_t files = 0;
+    uint64_t frames = 0;
+    for (uint8_t t = 0; t < TUNE_COUNT; t++)
+    {
+        const Tune& tune = Tunes::getTune(static_cast<TunesTypes>(t));
+        RenderResult result = exportRender(renderer, tune.name, &tune, nullptr);
+        checkGolden(tune.name, result);
+        TEST_ASSERT_TRUE_MESSAGE(result.ledFrames > 0, tune.name);
+        frames += result.frames;
+        files++;
+    }
+    for (const AuditoryCortex::SoundEffect* effect : SoundEffects::all())
+    {
+        RenderResult result = exportRender(renderer, effect->name, nullptr, effect);
+        checkGolden(effect->name, result);
+        frames += result.frames;
+        files++;
+    }
+
+    char message[160];
+    snprintf(message, sizeof(message), "%u WAV files and timelines, %.1f s of audio, in %s",
+             files, static_cast<double>(frames) / SAMPLE_RATE, RENDER_OUTPUT_DIR);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL_UINT32(sizeof(GOLDENS) / sizeof(GOLDENS[0]), files);
+}
+
+void test_full_set_render_throughput()
+{
+    OfflineRenderer renderer(SAMPLE_RATE, hostMicros);
+    uint64_t frames = 0;
+    uint64_t micros = 0;
+    for (uint8_t t = 0; t < TUNE_COUNT; t++)
+    {
+        RenderResult result = renderer.renderTune(Tunes::getTune(static_cast<TunesTypes>(t)));
+        frames += result.frames;
+        micros += result.renderMicros;
+    }
+    for (const AuditoryCortex::SoundEffect* effect : SoundEffects::all())
+    {
+        RenderResult result = renderer.renderEffect(*effect);
+        frames += result.frames;
+        micros += result.renderMicros;
+    }
+
+    double audioSeconds = static_cast<double>(frames) / SAMPLE_RATE;
+    double realtime = micros ? audioSeconds * 1e6 / micros : 0;
+    char message[96];
+    snprintf(message, sizeof(message), "%.1f s of audio in %.1f ms, %.0fx realtime",
+             audioSeconds, micros / 1000.0, realtime);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_TRUE(realtime > MIN_REALTIME_FACTOR);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_every_tune_matches_its_golden);
+    RUN_TEST(test_every_tone_matches_its_golden);
+    RUN_TEST(test_every_error_sound_matches_its_golden);
+    RUN_TEST(test_renders_repeat_exactly);
+    RUN_TEST(test_volume_does_not_change_the_timeline);
+    RUN_TEST(test_every_render_exports_wav_and_timeline);
+    RUN_TEST(test_full_set_render_throughput);
+    return UNITY_END();
+}
@@ -0,0 +1,198 @@
+/**
+ * @file test_main.cpp
+ * @brief PitchTracker accuracy over the vocal range, voicing and throughput
+ *
+ * Tones are fed in capture-sized chunks at 44.1 kHz, as the microphone task
+ * does. Noise comes from a fixed LCG so every run sees the same signal.
+ */
+
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <chrono>
+#include <vector>
+#include "AuditoryCortex/PitchTracker.h"
+
+using namespace AuditoryCortex;
+
+namespace
+{
+    const uint32_t SAMPLE_RATE = 44100;
+    const size_t CHUNK = 256;
+    const double SWEEP_LOW = 75.0;
+    const double SWEEP_HIGH = 1550.0;
+    const double SWEEP_STEP = 1.037;            // About 0.6 semitone
+    const double MAX_ERROR_CENTS = 20.0;
+    const double MIN_REALTIME_FACTOR = 50.0;    // Host analysis, against 44.1 kHz input
+
+    uint32_t lcgState = 1;
+
+    /**
+     * @brief Uniform in -1..1
+     */
+    double noise()
+    {
+        lcgState = lcgState * 1664525u + 1013904223u;
+        return static_cast<int32_t>(lcgState) / 2147483648.0;
+    }
+
+    enum class Wave
+    {
+        SINE,
+        NOISY_SAW
+    };
+
+    std::vector<int16_t> tone(double frequency, Wave wave, size_t count)
+    {
+        std::vector<int16_t> samples(count);
+        for (size_t i = 0; i < count; i++)
+        {
+            double phase = fmod(frequency * i / SAMPLE_RATE, 1.0);
+            double value = wave == Wave::SINE ? sin(2 * M_PI * phase) : (2 * phase - 1) * 0.8 + 0.05 * noise();
+            samples[i] = static_cast<int16_t>(8000 * value);
+        }
+        return samples;
+    }
+
+    struct SweepResult
+    {
+        uint32_t updates;
+        uint32_t voiced;
+        double worstCents;
+    };
+
+    SweepResult track(PitchTracker& tracker, const std::vector<int16_t>& samples, double frequency)
+    {
+        SweepResult result = { 0, 0, 0.0 };
+        uint32_t first = tracker.latest().sequence;
+        for (size_t i = 0; i + CHUNK <= samples.size(); i += CHUNK)
+        {
+            if (!tracker.process(&samples[i], CHUNK)) continue;
+            const PitchEstimate& estimate = tracker.latest();
+            if (!estimate.voiced) continue;
+            result.voiced++;
+            double cents = 1200 * log2(estimate.frequencyQ4 / 16.0 / frequency);
+            if (fabs(cents) > fabs(result.worstCents)) result.worstCents = cents;
+        }
+        result.updates = tracker.latest().sequence - first;
+        return result;
+    }
+
+    void sweep(Wave wave)
+    {
+        PitchTracker tracker;
+        double worst = 0;
+        for (double frequency = SWEEP_LOW; frequency < SWEEP_HIGH; frequency *= SWEEP_STEP)
+        {
+            TEST_ASSERT_TRUE(tracker.begin(SAMPLE_RATE));
+            SweepResult result = track(tracker, tone(frequency, wave, SAMPLE_RATE / 2), frequency);
+
+            // Only the first window, still filling, may go unvoiced
+            char message[64];
+            snprintf(message, sizeof(message), "%.1f Hz", frequency);
+            TEST_ASSERT_TRUE_MESSAGE(result.updates > 0, message);
+            TEST_ASSERT_TRUE_MESSAGE(result.voiced + 1 >= result.updates, message);
+            TEST_ASSERT_TRUE_MESSAGE(fabs(result.worstCents) <= MAX_ERROR_CENTS, message);
+            if (fabs(result.worstCents) > worst) worst = fabs(result.worstCents);
+        }
+
+        char message[64];
+        snprintf(message, sizeof(message), "%s sweep: worst %.2f cents", wave == Wave::SINE ? "sine" : "noisy saw", worst);
+        TEST_MESSAGE(message);
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_analysis_rate_and_range()
+{
+    PitchTracker tracker;
+    TEST_ASSERT_TRUE(tracker.begin(SAMPLE_RATE));
+    TEST_ASSERT_EQUAL_UINT32(22050, tracker.analysisRate());
+
+    // A window of 1024 cannot hold two periods of 20 Hz
+    TEST_ASSERT_FALSE(tracker.begin(SAMPLE_RATE, 20, 1600));
+}
+
+void test_sine_sweep_within_cents()
+{
+    sweep(Wave::SINE);
+}
+
+void test_noisy_sawtooth_sweep_within_cents()
+{
+    sweep(Wave::NOISY_SAW);
+}
+
+void test_silence_and_noise_are_unvoiced()
+{
+    PitchTracker tracker;
+    tracker.begin(SAMPLE_RATE);
+    std::vector<int16_t> samples(SAMPLE_RATE / 2, 0);
+    TEST_ASSERT_TRUE(tracker.process(samples.data(), samples.size()));
+    TEST_ASSERT_FALSE(tracker.latest().voiced);
+    TEST_ASSERT_EQUAL_UINT32(0, tracker.latest().frequencyQ4);
+
+    for (int16_t& sample : samples) sample = static_cast<int16_t>(8000 * noise());
+    TEST_ASSERT_TRUE(tracker.process(samples.data(), samples.size()));
+    TEST_ASSERT_FALSE(tracker.latest().voiced);
+}
+
+void test_note_lookup_matches_equal_temperament()
+{
+    // Every Q4 step from 25 Hz to 5.2 kHz, against 12 * log2(f / 440) in floating point
+    for (uint32_t q = 16 * 25; q < 16 * 5200; q++)
+    {
+        double semitones = 12 * log2(q / 16.0 / 440.0);
+        long rounded = lround(semitones);
+        long index = PitchTracker::A4_INDEX + rounded;
+        if (index < 0 || index >= PitchTracker::NOTE_COUNT) continue;
+
+        double cents = (semitones - rounded) * 100;
+        NoteMatch match = PitchTracker::nearestNote(q);
+        if (fabs(fabs(cents) - 50) <= 1)
+        {
+            // Within a cent of halfway, either neighbour is right
+            TEST_ASSERT_TRUE(match.index == index || match.index == index + (cents > 0 ? 1 : -1));
+            continue;
+        }
+        TEST_ASSERT_EQUAL_UINT8(index, match.index);
+        TEST_ASSERT_TRUE(fabs(match.cents - cents) <= 1.5);
+    }
+
+    NoteMatch a4 = PitchTracker::nearestNote(440 * 16);
+    TEST_ASSERT_EQUAL_UINT8(PitchTracker::A4_INDEX, a4.index);
+    TEST_ASSERT_EQUAL_INT8(0, a4.cents);
+}
+
+void test_analysis_throughput()
+{
+    std::vector<int16_t> samples = tone(220, Wave::SINE, SAMPLE_RATE * 10);
+    PitchTracker tracker;
+    tracker.begin(SAMPLE_RATE);
+    uint32_t first = tracker.latest().sequence;
+
+    auto start = std::chrono::steady_clock::now();
+    tracker.process(samples.data(), samples.size());
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    uint32_t updates = tracker.latest().sequence - first;
+
+    char message[96];
+    snprintf(message, sizeof(message), "10 s of audio in %.1f ms, %.1f updates/s", seconds * 1000, updates / 10.0);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_UINT_WITHIN(5, 250, updates);
+    TEST_ASSERT_TRUE(10.0 / seconds > MIN_REALTIME_FACTOR);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_analysis_rate_and_range);
+    RUN_TEST(test_sine_sweep_within_cents);
+    RUN_TEST(test_noisy_sawtooth_sweep_within_cents);
+    RUN_TEST(test_silence_and_noise_are_unvoiced);
+    RUN_TEST(test_note_lookup_matches_equal_temperament);
+    RUN_TEST(test_analysis_throughput);
+    return UNITY_END();
+}
@@ -0,0 +1,288 @@
+/**
+ * @file test_main.cpp
+ * @brief SampleBank decoding, eviction and memory budget, plus SamplePlayer
+ *
+ * Clips are WAV files built in memory with the same codecs the recorder
+ * uses. The allocator counts live bytes itself, so the budget is checked
+ * against what was really allocated rather than what the bank reports.
+ */
+
+#include <unity.h>
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+#include <string>
+#include <vector>
+#include "AuditoryCortex/SampleBank.h"
+
+using namespace AuditoryCortex;
+
+namespace
+{
+    const uint32_t CLIP_SAMPLES = 10000;
+    const uint32_t BUDGET = 45000;
+    const uint32_t CHURN_ROUNDS = 20000;
+    const uint8_t CHURN_FILES = 12;
+
+    std::map<std::string, std::vector<uint8_t>> files;
+    const std::vector<uint8_t>* openFile = nullptr;
+    size_t filePosition = 0;
+
+    size_t liveBytes = 0;
+    size_t peakLiveBytes = 0;
+
+    bool openClip(void*, const char* path)
+    {
+        auto it = files.find(path);
+        if (it == files.end()) return false;
+        openFile = &it->second;
+        filePosition = 0;
+        return true;
+    }
+
+    size_t readClip(void*, uint8_t* data, size_t length)
+    {
+        size_t count = openFile->size() - filePosition < length ? openFile->size() - filePosition : length;
+        memcpy(data, openFile->data() + filePosition, count);
+        filePosition += count;
+        return count;
+    }
+
+    void closeClip(void*)
+    {
+        openFile = nullptr;
+    }
+
+    void* countedAllocate(size_t bytes)
+    {
+        size_t* block = static_cast<size_t*>(malloc(bytes + 2 * sizeof(size_t)));
+        block[0] = bytes;
+        liveBytes += bytes;
+        if (liveBytes > peakLiveBytes) peakLiveBytes = liveBytes;
+        return block + 2;
+    }
+
+    void countedRelease(void* memory)
+    {
+        size_t* block = static_cast<size_t*>(memory) - 2;
+        liveBytes -= block[0];
+        free(block);
+    }
+
+    const SampleSource SOURCE = { openClip, readClip, closeClip, nullptr };
+
+    int16_t sample(uint32_t i)
+    {
+        return static_cast<int16_t>(10000 * sin(i * 0.05));
+    }
+
+    void makeWav(const char* path, RecordingFormat format, uint32_t sampleRate, uint32_t samples)
+    {
+        std::vector<int16_t> pcm(samples);
+        for (uint32_t i = 0; i < samples; i++) pcm[i] = sample(i);
+
+        std::vector<uint8_t> data;
+        if (format == RecordingFormat::PCM16)
+        {
+            data.resize(samples * 2);
+            memcpy(data.data(), pcm.data(), data.size());
+        }
+        else if (format == RecordingFormat::MU_LAW)
+        {
+            for (int16_t s : pcm) data.push_back(MuLaw::encode(s));
+        }
+        else
+        {
+            AdpcmState state = { 0, 0 };
+            uint8_t block[ImaAdpcm::BLOCK_ALIGN];
+            for (uint32_t i = 0; i + ImaAdpcm::SAMPLES_PER_BLOCK <= samples; i += ImaAdpcm::SAMPLES_PER_BLOCK)
+            {
+                ImaAdpcm::encodeBlock(&pcm[i], state, block);
+                data.insert(data.end(), block, block + sizeof(block));
+            }
+        }
+
+        uint8_t header[WavCodec::MAX_HEADER_BYTES];
+        size_t headerLength = WavCodec::buildHeader(header, format, sampleRate, data.size());
+        std::vector<uint8_t>& file = files[path];
+        file.assign(header, header + headerLength);
+        file.insert(file.end(), data.begin(), data.end());
+    }
+
+    uint32_t lcgState = 1;
+
+    uint32_t nextRandom(uint32_t bound)
+    {
+        lcgState = lcgState * 1664525u + 1013904223u;
+        return (lcgState >> 8) % bound;
+    }
+}
+
+void setUp()
+{
+    files.clear();
+    makeWav("/a.wav", RecordingFormat::PCM16, 22050, CLIP_SAMPLES);
+    makeWav("/b.wav", RecordingFormat::MU_LAW, 11025, CLIP_SAMPLES);
+    makeWav("/c.wav", RecordingFormat::IMA_ADPCM, 22050, ImaAdpcm::SAMPLES_PER_BLOCK * 10);
+    makeWav("/d.wav", RecordingFormat::PCM16, 44100, CLIP_SAMPLES);
+    liveBytes = 0;
+    peakLiveBytes = 0;
+}
+
+void tearDown() {}
+
+void test_each_format_decodes_to_pcm()
+{
+    SampleBank bank(SOURCE, countedAllocate, countedRelease);
+    const SampleClip* a = bank.acquire("/a.wav");
+    TEST_ASSERT_NOT_NULL(a);
+    TEST_ASSERT_EQUAL_UINT32(CLIP_SAMPLES, a->count);
+    TEST_ASSERT_EQUAL_UINT32(22050, a->sampleRate);
+    TEST_ASSERT_EQUAL_INT16(sample(20), a->samples[20]);
+
+    // The lossy codecs land close to the source
+    const SampleClip* b = bank.acquire("/b.wav");
+    TEST_ASSERT_EQUAL_UINT32(11025, b->sampleRate);
+    TEST_ASSERT_INT_WITHIN(200, sample(20), b->samples[20]);
+    const SampleClip* c = bank.acquire("/c.wav");
+    TEST_ASSERT_EQUAL_UINT32(ImaAdpcm::SAMPLES_PER_BLOCK * 10, c->count);
+    TEST_ASSERT_INT_WITHIN(200, sample(20), c->samples[20]);
+
+    bank.release(a);
+    bank.release(b);
+    bank.release(c);
+    TEST_ASSERT_EQUAL_UINT32(liveBytes, bank.stats().bytesUsed);
+}
+
+void test_least_recent_unheld_clip_is_evicted()
+{
+    SampleBank bank(SOURCE, countedAllocate, countedRelease);
+    bank.setBudget(BUDGET);
+    const SampleClip* a = bank.acquire("/a.wav");
+    const SampleClip* b = bank.acquire("/b.wav");
+    bank.release(b);
+
+    // c does not fit beside a and b; a is held, so b goes
+    const SampleClip* c = bank.acquire("/c.wav");
+    TEST_ASSERT_NOT_NULL(c);
+    TEST_ASSERT_TRUE(bank.contains("/a.wav"));
+    TEST_ASSERT_FALSE(bank.contains("/b.wav"));
+
+    // With a and c both held there is no room for d
+    TEST_ASSERT_NULL(bank.acquire("/d.wav"));
+    bank.release(a);
+    bank.release(c);
+    const SampleClip* d = bank.acquire("/d.wav");
+    TEST_ASSERT_NOT_NULL(d);
+    TEST_ASSERT_FALSE(bank.contains("/a.wav"));
+    TEST_ASSERT_TRUE(bank.contains("/c.wav"));
+    bank.release(d);
+
+    SampleBankStats stats = bank.stats();
+    TEST_ASSERT_EQUAL_UINT32(2, stats.evictions);
+    TEST_ASSERT_EQUAL_UINT32(1, stats.loadFailures);
+    TEST_ASSERT_TRUE(stats.peakBytes <= BUDGET);
+    TEST_ASSERT_TRUE(peakLiveBytes <= BUDGET);
+}
+
+void test_missing_clip_is_not_retried()
+{
+    SampleBank bank(SOURCE, countedAllocate, countedRelease);
+    TEST_ASSERT_NULL(bank.acquire("/none.wav"));
+    TEST_ASSERT_NULL(bank.acquire("/none.wav"));
+    SampleBankStats stats = bank.stats();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.loadFailures);
+    TEST_ASSERT_EQUAL_UINT32(0, stats.loads);
+}
+
+void test_pinned_clip_survives_pressure()
+{
+    SampleBank bank(SOURCE, countedAllocate, countedRelease);
+    bank.setBudget(BUDGET);
+    TEST_ASSERT_TRUE(bank.preload("/a.wav"));
+    for (int i = 0; i < 6; i++)
+    {
+        const SampleClip* clip = bank.acquire(i % 2 ? "/b.wav" : "/c.wav");
+        TEST_ASSERT_NOT_NULL(clip);
+        bank.release(clip);
+    }
+    TEST_ASSERT_TRUE(bank.contains("/a.wav"));
+    TEST_ASSERT_EQUAL_UINT8(1, bank.stats().pinned);
+
+    bank.clear();
+    TEST_ASSERT_FALSE(bank.contains("/a.wav"));
+    TEST_ASSERT_EQUAL_UINT32(0, bank.stats().bytesUsed);
+    TEST_ASSERT_EQUAL_UINT32(0, liveBytes);
+}
+
+void test_random_churn_stays_within_budget()
+{
+    char paths[CHURN_FILES][16];
+    for (uint8_t f = 0; f < CHURN_FILES; f++)
+    {
+        snprintf(paths[f], sizeof(paths[f]), "/clip%u.wav", f);
+        makeWav(paths[f], static_cast<RecordingFormat>(f % 3), 22050, 2000 + f * 1500);
+    }
+
+    SampleBank bank(SOURCE, countedAllocate, countedRelease);
+    bank.setBudget(BUDGET);
+    const SampleClip* held[4] = { nullptr, nullptr, nullptr, nullptr };
+    for (uint32_t round = 0; round < CHURN_ROUNDS; round++)
+    {
+        uint32_t slot = nextRandom(4);
+        if (held[slot]) bank.release(held[slot]);
+        held[slot] = bank.acquire(paths[nextRandom(CHURN_FILES)]);
+        TEST_ASSERT_EQUAL_UINT32(liveBytes, bank.stats().bytesUsed);
+        TEST_ASSERT_TRUE(liveBytes <= BUDGET);
+    }
+    for (const SampleClip* clip : held)
+    {
+        if (clip) bank.release(clip);
+    }
+
+    SampleBankStats stats = bank.stats();
+    char message[128];
+    snprintf(message, sizeof(message), "%u rounds: %u hits, %u loads, %u evictions, %u refused, peak %u bytes",
+             CHURN_ROUNDS, stats.hits, stats.loads, stats.evictions, stats.loadFailures, stats.peakBytes);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_TRUE(peakLiveBytes <= BUDGET);
+    TEST_ASSERT_GREATER_THAN(0, stats.evictions);
+
+    // Shrinking the budget frees unheld clips straight away
+    bank.setBudget(BUDGET / 4);
+    TEST_ASSERT_TRUE(liveBytes <= BUDGET / 4);
+}
+
+void test_player_resamples_and_releases()
+{
+    SampleBank bank(SOURCE, countedAllocate, countedRelease);
+    SamplePlayer player(bank, 44100);
+    player.start(bank.acquire("/a.wav"));
+    TEST_ASSERT_TRUE(player.isPlaying());
+
+    // A 22.05 kHz clip at 44.1 kHz plays twice as many frames
+    int16_t out[128];
+    size_t total = 0;
+    size_t frames;
+    while ((frames = SamplePlayer::read(&player, out, 128)) > 0) total += frames;
+    TEST_ASSERT_EQUAL_UINT32(CLIP_SAMPLES * 2, total);
+    TEST_ASSERT_FALSE(player.isPlaying());
+
+    // The player gave its hold back, so clear() can free the clip
+    bank.clear();
+    TEST_ASSERT_EQUAL_UINT32(0, liveBytes);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_each_format_decodes_to_pcm);
+    RUN_TEST(test_least_recent_unheld_clip_is_evicted);
+    RUN_TEST(test_missing_clip_is_not_retried);
+    RUN_TEST(test_pinned_clip_survives_pressure);
+    RUN_TEST(test_random_churn_stays_within_budget);
+    RUN_TEST(test_player_resamples_and_releases);
+    return UNITY_END();
+}
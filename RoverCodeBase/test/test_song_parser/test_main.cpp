@@ -0,0 +1,314 @@
+/**
+ * @file test_main.cpp
+ * @brief SongParser on RTTTL and MIDI, a mutation fuzz and a large-file benchmark
+ *
+ * Songs are read through the same offset/length callback the SD file uses,
+ * from memory. The fuzz mutates valid seeds with a fixed LCG, so any failure
+ * reproduces; every mutant must either be rejected or play out to the end
+ * with no more notes than it has bytes.
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <chrono>
+#include <vector>
+#include "AuditoryCortex/SongParser.h"
+
+using namespace AuditoryCortex;
+
+namespace
+{
+    const uint32_t FUZZ_ITERATIONS = 100000;
+    const uint8_t FUZZ_MAX_MUTATIONS = 8;
+    const uint16_t BENCH_TRACKS = 16;
+    const uint32_t BENCH_NOTES_PER_TRACK = 20000;
+    const double MIN_BENCH_MBPS = 2.0;          // Well above what an SD read sustains for a song
+
+    const char* const TETRIS = "Tetris:d=4,o=5,b=160:e6,8b,8c6,8d6,16e6,16d6,8c6,8b,a,8a,8c6,e6,8d6,8c6,b,8b,8c6,d6,e6,c6,a,2a.,p";
+
+    struct Source
+    {
+        std::vector<uint8_t> data;
+        uint32_t reads;
+    };
+
+    size_t readSource(void* context, uint32_t offset, uint8_t* out, size_t length)
+    {
+        Source& source = *static_cast<Source*>(context);
+        source.reads++;
+        if (offset >= source.data.size()) return 0;
+        size_t count = source.data.size() - offset < length ? source.data.size() - offset : length;
+        memcpy(out, &source.data[offset], count);
+        return count;
+    }
+
+    void variableLength(std::vector<uint8_t>& out, uint32_t value)
+    {
+        uint8_t bytes[5];
+        int count = 0;
+        bytes[count++] = value & 0x7F;
+        while (value >>= 7) bytes[count++] = (value & 0x7F) | 0x80;
+        while (count) out.push_back(bytes[--count]);
+    }
+
+    void bigEndian(std::vector<uint8_t>& out, uint32_t value, int bytes)
+    {
+        for (int i = bytes - 1; i >= 0; i--) out.push_back(static_cast<uint8_t>(value >> (8 * i)));
+    }
+
+    /**
+     * @brief Format 1 file at 120 bpm in 3/4; each track plays eighths a half note apart
+     *
+     * Tracks stay off channel 10, which the parser skips as percussion.
+     */
+    std::vector<uint8_t> midi(uint16_t tracks, uint32_t notesPerTrack, bool runningStatus)
+    {
+        std::vector<uint8_t> file = { 'M', 'T', 'h', 'd' };
+        bigEndian(file, 6, 4);
+        bigEndian(file, 1, 2);
+        bigEndian(file, tracks, 2);
+        bigEndian(file, 480, 2);
+
+        for (uint16_t t = 0; t < tracks; t++)
+        {
+            std::vector<uint8_t> track;
+            if (t == 0)
+            {
+                const uint8_t meta[] = { 0x00, 0xFF, 0x51, 3, 0x07, 0xA1, 0x20,
+                                         0x00, 0xFF, 0x58, 4, 3, 2, 24, 8,
+                                         0x00, 0xFF, 0x03, 4, 'T', 'e', 's', 't' };
+                track.insert(track.end(), meta, meta + sizeof(meta));
+            }
+            for (uint32_t n = 0; n < notesPerTrack; n++)
+            {
+                uint8_t key = static_cast<uint8_t>(48 + (n * 7 + t * 4) % 36);
+                uint8_t channel = t % 9;
+                if (n == 0) variableLength(track, 0);
+                if (!runningStatus || n == 0) track.push_back(0x90 | channel);
+                track.push_back(key);
+                track.push_back(100);
+                variableLength(track, 240);
+                // With running status the note ends as a note-on at velocity 0
+                if (!runningStatus) track.push_back(0x80 | channel);
+                track.push_back(key);
+                track.push_back(0);
+                variableLength(track, 240);
+            }
+            const uint8_t end[] = { 0xFF, 0x2F, 0 };
+            track.insert(track.end(), end, end + sizeof(end));
+
+            const uint8_t chunk[] = { 'M', 'T', 'r', 'k' };
+            file.insert(file.end(), chunk, chunk + sizeof(chunk));
+            bigEndian(file, track.size(), 4);
+            file.insert(file.end(), track.begin(), track.end());
+        }
+        return file;
+    }
+
+    Source text(const char* song)
+    {
+        Source source = { std::vector<uint8_t>(song, song + strlen(song)), 0 };
+        return source;
+    }
+
+    size_t playAll(SongParser& parser, std::vector<SongEvent>* events = nullptr, uint64_t* totalMs = nullptr)
+    {
+        SongEvent event;
+        size_t count = 0;
+        uint64_t total = 0;
+        while (parser.next(event))
+        {
+            count++;
+            total += event.advanceMs;
+            if (events) events->push_back(event);
+        }
+        if (totalMs) *totalMs = total;
+        return count;
+    }
+
+    uint32_t lcgState = 1;
+
+    uint32_t nextRandom(uint32_t bound)
+    {
+        lcgState = lcgState * 1664525u + 1013904223u;
+        return (lcgState >> 8) % bound;
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_rtttl_notes_and_timing()
+{
+    Source source = text(TETRIS);
+    SongParser parser;
+    TEST_ASSERT_TRUE(parser.open(readSource, &source, source.data.size()));
+    TEST_ASSERT_EQUAL_STRING("Tetris", parser.title());
+    TEST_ASSERT_EQUAL_UINT16(375, parser.beatMs());
+
+    std::vector<SongEvent> events;
+    uint64_t total = 0;
+    TEST_ASSERT_EQUAL_UINT32(23, playAll(parser, &events, &total));
+    TEST_ASSERT_EQUAL(SongError::NONE, parser.error());
+    TEST_ASSERT_EQUAL_UINT32(6756, total);
+
+    // e6 quarter, then b5 eighth
+    TEST_ASSERT_EQUAL_UINT16(1319, events[0].frequency);
+    TEST_ASSERT_EQUAL_UINT16(375, events[0].durationMs);
+    TEST_ASSERT_EQUAL_UINT8(4, events[0].noteValue);
+    TEST_ASSERT_EQUAL_UINT16(988, events[1].frequency);
+    TEST_ASSERT_EQUAL_UINT8(8, events[1].noteValue);
+
+    // 2a. is a dotted half, and the closing p a rest
+    TEST_ASSERT_TRUE(events[21].dotted);
+    TEST_ASSERT_EQUAL_UINT16(1125, events[21].durationMs);
+    TEST_ASSERT_EQUAL_UINT16(0, events[22].frequency);
+}
+
+void test_midi_single_track()
+{
+    Source source = { midi(1, 10, false), 0 };
+    SongParser parser;
+    TEST_ASSERT_TRUE(parser.open(readSource, &source, source.data.size()));
+
+    // Meta events are read as the track plays, so check them afterwards
+    std::vector<SongEvent> events;
+    TEST_ASSERT_EQUAL_UINT32(10, playAll(parser, &events));
+    TEST_ASSERT_EQUAL(SongError::NONE, parser.error());
+    TEST_ASSERT_EQUAL_STRING("Test", parser.title());
+    TEST_ASSERT_EQUAL_UINT8(3, parser.signatureNumerator());
+    TEST_ASSERT_EQUAL_UINT8(4, parser.signatureDenominator());
+    TEST_ASSERT_EQUAL_UINT16(500, parser.beatMs());
+    TEST_ASSERT_EQUAL_UINT16(131, events[0].frequency);     // C3
+    TEST_ASSERT_EQUAL_UINT16(250, events[0].durationMs);
+    TEST_ASSERT_EQUAL_UINT16(500, events[0].advanceMs);
+    TEST_ASSERT_EQUAL_UINT8(100, events[0].velocity);
+}
+
+void test_midi_tracks_merge_in_onset_order()
+{
+    Source source = { midi(3, 10, true), 0 };
+    SongParser parser;
+    TEST_ASSERT_TRUE(parser.open(readSource, &source, source.data.size()));
+
+    // Three simultaneous notes: the first two advance nothing, the third the whole step
+    std::vector<SongEvent> events;
+    uint64_t total = 0;
+    TEST_ASSERT_EQUAL_UINT32(30, playAll(parser, &events, &total));
+    TEST_ASSERT_EQUAL(SongError::NONE, parser.error());
+    TEST_ASSERT_EQUAL_UINT64(4750, total);
+    for (size_t i = 0; i < events.size(); i += 3)
+    {
+        TEST_ASSERT_EQUAL_UINT16(0, events[i].advanceMs);
+        TEST_ASSERT_EQUAL_UINT16(0, events[i + 1].advanceMs);
+    }
+    TEST_ASSERT_EQUAL_UINT16(131, events[0].frequency);
+    TEST_ASSERT_EQUAL_UINT16(165, events[1].frequency);
+    TEST_ASSERT_EQUAL_UINT16(208, events[2].frequency);
+}
+
+void test_bad_files_are_rejected()
+{
+    SongParser parser;
+    Source empty = text("");
+    TEST_ASSERT_FALSE(parser.open(readSource, &empty, 0));
+
+    Source smpte = { midi(1, 2, false), 0 };
+    smpte.data[12] = 0xE7;      // Negative division: SMPTE frames
+    TEST_ASSERT_FALSE(parser.open(readSource, &smpte, smpte.data.size()));
+    TEST_ASSERT_EQUAL(SongError::UNSUPPORTED, parser.error());
+
+    // A data byte where the first status byte belongs has no running status to reuse
+    Source orphan = { midi(1, 10, false), 0 };
+    const size_t FIRST_STATUS = 14 + 8 + 23 + 1;
+    TEST_ASSERT_EQUAL_HEX8(0x90, orphan.data[FIRST_STATUS]);
+    orphan.data[FIRST_STATUS] = 0x40;
+    TEST_ASSERT_TRUE(parser.open(readSource, &orphan, orphan.data.size()));
+    TEST_ASSERT_EQUAL_UINT32(0, playAll(parser));
+    TEST_ASSERT_EQUAL(SongError::MALFORMED, parser.error());
+
+    // A track cut short just ends early, keeping the notes before the cut
+    Source truncated = { midi(1, 10, false), 0 };
+    truncated.data.resize(truncated.data.size() - 20);
+    TEST_ASSERT_TRUE(parser.open(readSource, &truncated, truncated.data.size()));
+    size_t kept = playAll(parser);
+    TEST_ASSERT_TRUE(kept > 0 && kept < 10);
+    TEST_ASSERT_EQUAL(SongError::NONE, parser.error());
+}
+
+void test_mutated_files_never_run_away()
+{
+    const std::vector<uint8_t> seeds[] = { text(TETRIS).data, midi(1, 10, false), midi(3, 10, true) };
+    uint32_t played = 0;
+    uint32_t rejected = 0;
+    uint32_t stopped = 0;
+    for (uint32_t i = 0; i < FUZZ_ITERATIONS; i++)
+    {
+        Source source = { seeds[i % 3], 0 };
+        uint32_t mutations = 1 + nextRandom(FUZZ_MAX_MUTATIONS);
+        for (uint32_t m = 0; m < mutations && !source.data.empty(); m++)
+        {
+            size_t at = nextRandom(source.data.size());
+            switch (nextRandom(4))
+            {
+                case 0: source.data[at] = static_cast<uint8_t>(nextRandom(256)); break;
+                case 1: source.data.resize(at); break;
+                case 2: source.data.insert(source.data.begin() + at, static_cast<uint8_t>(nextRandom(256))); break;
+                default: source.data[at] ^= static_cast<uint8_t>(1 << nextRandom(8)); break;
+            }
+        }
+
+        SongParser parser;
+        if (!parser.open(readSource, &source, source.data.size()))
+        {
+            rejected++;
+            continue;
+        }
+        size_t events = playAll(parser);
+        TEST_ASSERT_TRUE(events <= source.data.size());
+        if (parser.error() == SongError::NONE) played++;
+        else stopped++;
+    }
+
+    char message[96];
+    snprintf(message, sizeof(message), "%u mutants: %u played, %u stopped early, %u rejected",
+             FUZZ_ITERATIONS, played, stopped, rejected);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_GREATER_THAN(0, played);
+    TEST_ASSERT_GREATER_THAN(0, stopped);
+    TEST_ASSERT_GREATER_THAN(0, rejected);
+}
+
+void test_large_midi_streams_through_small_reads()
+{
+    Source source = { midi(BENCH_TRACKS, BENCH_NOTES_PER_TRACK, true), 0 };
+    SongParser parser;
+    TEST_ASSERT_TRUE(parser.open(readSource, &source, source.data.size()));
+
+    auto start = std::chrono::steady_clock::now();
+    size_t events = playAll(parser);
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double mbps = source.data.size() / seconds / 1e6;
+
+    char message[128];
+    snprintf(message, sizeof(message), "%u bytes, %u notes in %.1f ms (%.1f MB/s), %u reads, parser %u bytes",
+             static_cast<unsigned>(source.data.size()), static_cast<unsigned>(events), seconds * 1000, mbps,
+             source.reads, static_cast<unsigned>(sizeof(SongParser)));
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL(SongError::NONE, parser.error());
+    TEST_ASSERT_EQUAL_UINT32(BENCH_TRACKS * BENCH_NOTES_PER_TRACK, events);
+    TEST_ASSERT_TRUE(mbps > MIN_BENCH_MBPS);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_rtttl_notes_and_timing);
+    RUN_TEST(test_midi_single_track);
+    RUN_TEST(test_midi_tracks_merge_in_onset_order);
+    RUN_TEST(test_bad_files_are_rejected);
+    RUN_TEST(test_mutated_files_never_run_away);
+    RUN_TEST(test_large_midi_streams_through_small_reads);
+    return UNITY_END();
+}
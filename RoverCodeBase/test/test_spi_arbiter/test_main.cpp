@@ -0,0 +1,415 @@
+/**
+ * @file test_main.cpp
+ * @brief SPIArbiter priority ordering, starvation guard and lease exclusion
+ *
+ * The ordering tests drive processOne() by hand against a simulated bus that
+ * logs which device was selected for each chunk. The lease tests run the bus
+ * on its own thread and take leases the way SPIManager does: a step that
+ * signals the waiting task, then parks the bus until release.
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "PrefrontalCortex/SPIArbiter.h"
+
+using namespace PrefrontalCortex;
+
+namespace
+{
+    const uint8_t TFT = 0;
+    const uint8_t SD = 1;
+    const uint8_t LORA = 2;
+    const uint32_t BYTE_MICROS = 1;
+    const uint32_t HOLD_MICROS = 20000;
+    const uint32_t WAIT_MICROS = 1000000;
+    const uint16_t LEASES_PER_THREAD = 200;
+
+    const SPIDeviceConfig DEVICES[] = {
+        { "tft", 5, 40000000, 0 },
+        { "sd", 13, 20000000, 0 },
+        { "lora", 7, 8000000, 0 },
+    };
+
+    uint32_t hostMicros(void*)
+    {
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    void sleepMicros(uint32_t micros)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(micros));
+    }
+
+    /**
+     * @brief The calling thread, as xTaskGetCurrentTaskHandle() names a task
+     */
+    SPIArbiter::TaskId self()
+    {
+        static thread_local char token;
+        return &token;
+    }
+
+    /**
+     * @brief Bus on a simulated clock; each chunk is logged by the device it selected
+     */
+    struct SimulatedBus
+    {
+        uint32_t clock;
+        std::vector<uint8_t> selected;
+        const SPIDeviceConfig* devices;         // The arbiter's own table, to name a device by its id
+
+        static uint32_t micros(void* context)
+        {
+            return static_cast<SimulatedBus*>(context)->clock;
+        }
+
+        static void select(void* context, const SPIDeviceConfig& device, bool on)
+        {
+            SimulatedBus& bus = *static_cast<SimulatedBus*>(context);
+            if (on) bus.selected.push_back(static_cast<uint8_t>(&device - bus.devices));
+        }
+
+        static bool transfer(void* context, const uint8_t*, uint8_t*, uint32_t length)
+        {
+            static_cast<SimulatedBus*>(context)->clock += length * BYTE_MICROS;
+            return true;
+        }
+
+        SPIBusHooks hooks()
+        {
+            SPIBusHooks hooks = { micros, nullptr, select, transfer, nullptr, this };
+            return hooks;
+        }
+    };
+
+    /**
+     * @brief Binary semaphore, as the rover's leases use
+     */
+    struct Signal
+    {
+        std::mutex lock;
+        std::condition_variable changed;
+        bool given = false;
+
+        void give()
+        {
+            std::lock_guard<std::mutex> hold(lock);
+            given = true;
+            changed.notify_one();
+        }
+
+        void take()
+        {
+            std::unique_lock<std::mutex> hold(lock);
+            changed.wait(hold, [this] { return given; });
+            given = false;
+        }
+    };
+
+    /**
+     * @brief Bus thread and leases, shaped like SPIManager
+     */
+    struct ThreadedBus
+    {
+        SPIArbiter arbiter;
+        Signal released;
+        std::atomic<bool> running;
+        std::atomic<SPIArbiter::TaskId> busTask;
+        std::thread thread;
+
+        struct Grant
+        {
+            ThreadedBus* bus;
+            Signal granted;
+        };
+
+        ThreadedBus() : arbiter(hooks()), running(true), busTask(nullptr)
+        {
+            for (const SPIDeviceConfig& device : DEVICES) arbiter.addDevice(device);
+            thread = std::thread([this] {
+                arbiter.setBusTask(self());
+                busTask.store(self());
+                while (running.load())
+                {
+                    if (!arbiter.processOne()) sleepMicros(50);
+                }
+            });
+            while (busTask.load() == nullptr) sleepMicros(50);
+        }
+
+        ~ThreadedBus()
+        {
+            running.store(false);
+            thread.join();
+        }
+
+        static SPIBusHooks hooks()
+        {
+            SPIBusHooks hooks = { hostMicros, nullptr, select, transfer, nullptr, nullptr };
+            return hooks;
+        }
+
+        static void select(void*, const SPIDeviceConfig&, bool) {}
+
+        static bool transfer(void*, const uint8_t*, uint8_t*, uint32_t length)
+        {
+            sleepMicros(length * BYTE_MICROS);
+            return true;
+        }
+
+        static bool holdLease(void* context, uint32_t, uint32_t)
+        {
+            // The grant lives on the acquiring task's stack, gone once it is given
+            Grant& grant = *static_cast<Grant*>(context);
+            ThreadedBus* bus = grant.bus;
+            grant.granted.give();
+            bus->released.take();
+            return true;
+        }
+
+        bool acquire(uint8_t device)
+        {
+            if (!arbiter.canWait(self())) return false;
+
+            Grant grant;
+            grant.bus = this;
+            SPITransaction lease = SPIArbiter::makeTransaction(device, SPIPriority::NORMAL, 1);
+            lease.step = holdLease;
+            lease.context = &grant;
+            while (arbiter.submit(lease) == 0) sleepMicros(50);
+            grant.granted.take();
+            arbiter.beginLease(self());
+            return true;
+        }
+
+        void release()
+        {
+            arbiter.endLease(self());
+            released.give();
+        }
+    };
+
+    bool waitFor(const SPIFuture& future)
+    {
+        for (uint32_t waited = 0; waited < WAIT_MICROS; waited += 100)
+        {
+            if (future.done.load(std::memory_order_acquire)) return true;
+            sleepMicros(100);
+        }
+        return false;
+    }
+
+    SimulatedBus bus;
+}
+
+void setUp()
+{
+    bus.clock = 0;
+    bus.selected.clear();
+    bus.devices = nullptr;
+}
+
+void tearDown() {}
+
+void test_bulk_push_yields_to_more_urgent_work_within_one_chunk()
+{
+    SPIArbiter arbiter(bus.hooks());
+    for (const SPIDeviceConfig& device : DEVICES) arbiter.addDevice(device);
+    bus.devices = &arbiter.device(0);
+
+    SPIFuture push, read, radio;
+    SPITransaction frame = SPIArbiter::makeTransaction(TFT, SPIPriority::BULK, 4096);
+    frame.chunk = 512;
+    frame.future = &push;
+    TEST_ASSERT_NOT_EQUAL(0, arbiter.submit(frame));
+    TEST_ASSERT_TRUE(arbiter.processOne());
+    TEST_ASSERT_TRUE(arbiter.processOne());
+
+    // Queued lowest first, run most urgent first, both ahead of the rest of the frame
+    SPITransaction block = SPIArbiter::makeTransaction(SD, SPIPriority::NORMAL, 512);
+    block.future = &read;
+    SPITransaction packet = SPIArbiter::makeTransaction(LORA, SPIPriority::URGENT, 64);
+    packet.future = &radio;
+    TEST_ASSERT_NOT_EQUAL(0, arbiter.submit(block));
+    TEST_ASSERT_NOT_EQUAL(0, arbiter.submit(packet));
+    while (arbiter.processOne()) {}
+
+    const uint8_t expected[] = { TFT, TFT, LORA, SD, TFT, TFT, TFT, TFT, TFT, TFT };
+    TEST_ASSERT_EQUAL_UINT32(sizeof(expected), bus.selected.size());
+    TEST_ASSERT_EQUAL_UINT8_ARRAY(expected, bus.selected.data(), sizeof(expected));
+    TEST_ASSERT_TRUE(push.done.load() && read.done.load() && radio.done.load());
+    TEST_ASSERT_EQUAL_UINT16(8, push.result.chunks);
+
+    // The radio packet waited for one chunk of the frame, no more
+    TEST_ASSERT_TRUE(radio.result.queuedMicros <= 512 * BYTE_MICROS);
+    SPIBusStats stats = arbiter.stats();
+    TEST_ASSERT_EQUAL_UINT32(1, stats.preemptions);
+    TEST_ASSERT_EQUAL_UINT32(3, stats.completed);
+    TEST_ASSERT_EQUAL_UINT32(8, stats.devices[TFT].chunks);
+    TEST_ASSERT_EQUAL_UINT32(4096, stats.devices[TFT].bytes);
+}
+
+void test_bypassed_bulk_push_gets_a_chunk()
+{
+    SPIArbiter arbiter(bus.hooks());
+    for (const SPIDeviceConfig& device : DEVICES) arbiter.addDevice(device);
+    bus.devices = &arbiter.device(0);
+
+    // An SD transfer long enough to keep NORMAL busy throughout
+    SPITransaction flood = SPIArbiter::makeTransaction(SD, SPIPriority::NORMAL, 100);
+    flood.chunk = 1;
+    SPITransaction frame = SPIArbiter::makeTransaction(TFT, SPIPriority::BULK, 2);
+    frame.chunk = 1;
+    TEST_ASSERT_NOT_EQUAL(0, arbiter.submit(frame));
+    TEST_ASSERT_NOT_EQUAL(0, arbiter.submit(flood));
+
+    const uint32_t rounds = 2 * (SPIArbiter::MAX_BYPASS + 1);
+    for (uint32_t i = 0; i < rounds; i++)
+    {
+        TEST_ASSERT_TRUE(arbiter.processOne());
+    }
+
+    // MAX_BYPASS NORMAL chunks, then one BULK chunk, twice over
+    for (uint32_t i = 0; i < rounds; i++)
+    {
+        uint8_t expected = i % (SPIArbiter::MAX_BYPASS + 1) == SPIArbiter::MAX_BYPASS ? TFT : SD;
+        TEST_ASSERT_EQUAL_UINT8_MESSAGE(expected, bus.selected[i], "chunk order");
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, arbiter.stats().completed);
+}
+
+void test_malformed_and_overflowing_submits_are_rejected()
+{
+    SPIArbiter arbiter(bus.hooks());
+    for (const SPIDeviceConfig& device : DEVICES) arbiter.addDevice(device);
+
+    TEST_ASSERT_EQUAL_UINT32(0, arbiter.submit(SPIArbiter::makeTransaction(3, SPIPriority::NORMAL, 1)));
+    TEST_ASSERT_EQUAL_UINT32(0, arbiter.submit(SPIArbiter::makeTransaction(SD, SPIPriority::NORMAL, 0)));
+    TEST_ASSERT_EQUAL_UINT32(0, arbiter.submit(SPIArbiter::makeTransaction(SD, SPIPriority::COUNT, 1)));
+
+    for (uint32_t i = 0; i < SPIArbiter::QUEUE_DEPTH; i++)
+    {
+        TEST_ASSERT_NOT_EQUAL(0, arbiter.submit(SPIArbiter::makeTransaction(SD, SPIPriority::BULK, 1)));
+    }
+    TEST_ASSERT_EQUAL_UINT32(0, arbiter.submit(SPIArbiter::makeTransaction(SD, SPIPriority::BULK, 1)));
+    TEST_ASSERT_NOT_EQUAL(0, arbiter.submit(SPIArbiter::makeTransaction(SD, SPIPriority::NORMAL, 1)));
+
+    arbiter.processOne();
+    SPIBusStats stats = arbiter.stats();
+    TEST_ASSERT_EQUAL_UINT32(4, stats.rejected);
+    TEST_ASSERT_EQUAL_UINT32(SPIArbiter::QUEUE_DEPTH + 1, stats.submitted);
+}
+
+void test_lease_holds_back_other_transfers_until_released()
+{
+    ThreadedBus threaded;
+    TEST_ASSERT_TRUE(threaded.acquire(SD));
+    TEST_ASSERT_TRUE(threaded.arbiter.leaseHolder() == self());
+
+    // Queued behind the lease at a higher priority, and still not run while it is held
+    SPIFuture radio;
+    SPITransaction packet = SPIArbiter::makeTransaction(LORA, SPIPriority::URGENT, 16);
+    packet.future = &radio;
+    TEST_ASSERT_NOT_EQUAL(0, threaded.arbiter.submit(packet));
+    sleepMicros(HOLD_MICROS);
+    TEST_ASSERT_FALSE(radio.done.load());
+
+    threaded.release();
+    TEST_ASSERT_TRUE(waitFor(radio));
+    TEST_ASSERT_TRUE(radio.result.ok);
+    TEST_ASSERT_TRUE(radio.result.queuedMicros >= HOLD_MICROS);
+    TEST_ASSERT_NULL(threaded.arbiter.leaseHolder());
+}
+
+void test_leases_from_two_tasks_never_overlap()
+{
+    ThreadedBus threaded;
+    std::atomic<int> inside(0);
+    std::atomic<int> overlaps(0);
+    std::atomic<int> granted(0);
+
+    auto worker = [&](uint8_t device) {
+        for (uint16_t i = 0; i < LEASES_PER_THREAD; i++)
+        {
+            if (!threaded.acquire(device)) continue;
+            if (inside.fetch_add(1) != 0) overlaps++;
+            if (threaded.arbiter.leaseHolder() != self()) overlaps++;
+            sleepMicros(20);
+            inside.fetch_sub(1);
+            granted++;
+            threaded.release();
+        }
+    };
+    std::thread display(worker, TFT);
+    std::thread storage(worker, SD);
+    display.join();
+    storage.join();
+
+    char message[96];
+    snprintf(message, sizeof(message), "%d leases, %d chunks on the bus",
+             granted.load(), static_cast<int>(threaded.arbiter.stats().completed));
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL(0, overlaps.load());
+    TEST_ASSERT_EQUAL(2 * LEASES_PER_THREAD, granted.load());
+}
+
+void test_nested_acquire_and_waits_on_the_bus_task_are_refused()
+{
+    ThreadedBus threaded;
+    TEST_ASSERT_TRUE(threaded.arbiter.canWait(self()));
+    TEST_ASSERT_FALSE(threaded.arbiter.canWait(threaded.busTask.load()));
+    TEST_ASSERT_FALSE(threaded.arbiter.canWait(nullptr));
+
+    // Under a lease the bus task is parked: a second acquire or any wait would never return
+    TEST_ASSERT_TRUE(threaded.acquire(SD));
+    TEST_ASSERT_FALSE(threaded.arbiter.canWait(self()));
+    TEST_ASSERT_FALSE(threaded.acquire(TFT));
+    TEST_ASSERT_TRUE(threaded.arbiter.leaseHolder() == self());
+
+    // Bookkeeping belongs to the holder alone
+    char otherTask;
+    TEST_ASSERT_FALSE(threaded.arbiter.beginLease(&otherTask));
+    threaded.arbiter.endLease(&otherTask);
+    TEST_ASSERT_TRUE(threaded.arbiter.leaseHolder() == self());
+    threaded.release();
+    TEST_ASSERT_TRUE(threaded.arbiter.canWait(self()));
+
+    // A step asking for the bus from the bus task itself is refused, not deadlocked
+    struct Probe
+    {
+        ThreadedBus* bus;
+        std::atomic<int> result;
+    } probe = { &threaded, { -1 } };
+    SPIFuture done;
+    SPITransaction nested = SPIArbiter::makeTransaction(SD, SPIPriority::NORMAL, 1);
+    nested.step = [](void* context, uint32_t, uint32_t) {
+        Probe& probe = *static_cast<Probe*>(context);
+        probe.result.store(probe.bus->acquire(TFT) ? 1 : 0);
+        return true;
+    };
+    nested.context = &probe;
+    nested.future = &done;
+    TEST_ASSERT_NOT_EQUAL(0, threaded.arbiter.submit(nested));
+    TEST_ASSERT_TRUE(waitFor(done));
+    TEST_ASSERT_EQUAL(0, probe.result.load());
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_bulk_push_yields_to_more_urgent_work_within_one_chunk);
+    RUN_TEST(test_bypassed_bulk_push_gets_a_chunk);
+    RUN_TEST(test_malformed_and_overflowing_submits_are_rejected);
+    RUN_TEST(test_lease_holds_back_other_transfers_until_released);
+    RUN_TEST(test_leases_from_two_tasks_never_overlap);
+    RUN_TEST(test_nested_acquire_and_waits_on_the_bus_task_are_refused);
+    return UNITY_END();
+}
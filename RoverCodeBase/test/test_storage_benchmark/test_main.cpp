@@ -0,0 +1,321 @@
+/**
+ * @file test_main.cpp
+ * @brief StorageBenchmark run against the in-memory backend, row by row
+ *
+ * The clock is simulated from the backend's own counters: each open, read,
+ * sector written and sync costs a fixed number of microseconds, and each
+ * bus-load call a fixed slice. That keeps every figure repeatable, so the
+ * checks can hold the CSV to what the suite actually did: operation and byte
+ * counts per block size, worst times inside totals, throughput that matches
+ * bytes over time, bus load kept off the storage rows, and nothing left
+ * behind in the directory.
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include "MemoryStorage.h"
+#include "PrefrontalCortex/StorageBenchmark.h"
+
+using namespace PrefrontalCortex;
+using HostTest::MemoryStorage;
+
+namespace
+{
+    const char* DIRECTORY = "/bench";
+    const uint32_t FILE_BYTES = 64 * 1024;
+    const uint32_t BUFFER_BYTES = 16 * 1024;
+    const uint32_t SMALL_BUFFER_BYTES = 2048;
+    const uint32_t CHURN_FILE_BYTES = 64;
+
+    const uint32_t OPEN_MICROS = 500;
+    const uint32_t READ_MICROS = 100;
+    const uint32_t SECTOR_WRITE_MICROS = 250;
+    const uint32_t SYNC_MICROS = 2000;
+    const uint32_t BUS_LOAD_MICROS = 1000;
+
+    struct Row
+    {
+        std::string medium;
+        std::string test;
+        uint32_t blockBytes;
+        uint32_t operations;
+        uint32_t bytes;
+        uint32_t elapsedMicros;
+        uint32_t kbPerSecond;
+        uint32_t worstMicros;
+        bool ok;
+    };
+
+    struct Bench
+    {
+        MemoryStorage* storage;
+        uint32_t ticks;             // One per clock read, so time always moves
+        uint32_t busLoads;
+        std::vector<std::string> lines;
+    };
+
+    uint32_t simulatedMicros(void* context)
+    {
+        Bench& bench = *static_cast<Bench*>(context);
+        const MemoryStorage& storage = *bench.storage;
+        return ++bench.ticks
+            + storage.opens * OPEN_MICROS
+            + storage.reads * READ_MICROS
+            + storage.sectorWrites * SECTOR_WRITE_MICROS
+            + storage.syncs * SYNC_MICROS
+            + bench.busLoads * BUS_LOAD_MICROS;
+    }
+
+    uint32_t countEntries(void* context, const char* path)
+    {
+        Bench& bench = *static_cast<Bench*>(context);
+        DirectoryBackend directories = bench.storage->directoryBackend();
+        DirectoryBackend::Handle directory = directories.open(directories.context, path);
+        if (!directory) return 0;
+
+        uint32_t count = 0;
+        DirectoryEntry entry;
+        while (directories.next(directories.context, directory, &entry, false)) count++;
+        directories.close(directories.context, directory);
+        return count;
+    }
+
+    void busLoad(void* context)
+    {
+        static_cast<Bench*>(context)->busLoads++;
+    }
+
+    void collect(void* context, const char* line)
+    {
+        static_cast<Bench*>(context)->lines.push_back(line);
+    }
+
+    BenchmarkHooks fullHooks(Bench& bench)
+    {
+        BenchmarkHooks hooks = { simulatedMicros, countEntries, busLoad, collect, &bench };
+        return hooks;
+    }
+
+    Row parseRow(const std::string& line)
+    {
+        char medium[16] = "";
+        char test[16] = "";
+        unsigned long fields[7] = { 0 };
+        int matched = sscanf(line.c_str(), "%15[^,],%15[^,],%lu,%lu,%lu,%lu,%lu,%lu,%lu", medium, test,
+                             &fields[0], &fields[1], &fields[2], &fields[3], &fields[4], &fields[5], &fields[6]);
+        TEST_ASSERT_EQUAL_INT_MESSAGE(9, matched, line.c_str());
+
+        Row row = { medium, test, static_cast<uint32_t>(fields[0]), static_cast<uint32_t>(fields[1]),
+                    static_cast<uint32_t>(fields[2]), static_cast<uint32_t>(fields[3]),
+                    static_cast<uint32_t>(fields[4]), static_cast<uint32_t>(fields[5]), fields[6] == 1 };
+        return row;
+    }
+
+    std::vector<Row> parseRows(const Bench& bench)
+    {
+        TEST_ASSERT_TRUE(bench.lines.size() > 1);
+        TEST_ASSERT_EQUAL_STRING(StorageBenchmark::CSV_HEADER, bench.lines[0].c_str());
+        std::vector<Row> rows;
+        for (size_t i = 1; i < bench.lines.size(); i++) rows.push_back(parseRow(bench.lines[i]));
+        return rows;
+    }
+
+    const Row* findRow(const std::vector<Row>& rows, const char* test, uint32_t blockBytes)
+    {
+        for (const Row& row : rows)
+        {
+            if (row.test == test && row.blockBytes == blockBytes) return &row;
+        }
+        return nullptr;
+    }
+
+    MemoryStorage storage;
+    Bench bench;
+    uint8_t buffer[BUFFER_BYTES];
+}
+
+void setUp()
+{
+    storage = MemoryStorage();
+    storage.directories.insert(DIRECTORY);
+    bench = Bench();
+    bench.storage = &storage;
+}
+
+void tearDown() {}
+
+void test_full_run_reports_every_row_and_cleans_up()
+{
+    StorageBenchmark benchmark(storage.backend(), fullHooks(bench), buffer, sizeof(buffer));
+    benchmark.setLabel("host");
+    benchmark.setFileBytes(FILE_BYTES);
+    TEST_ASSERT_EQUAL_UINT16(0, benchmark.run(DIRECTORY));
+
+    for (const std::string& line : bench.lines) TEST_MESSAGE(line.c_str());
+    std::vector<Row> rows = parseRows(bench);
+
+    // 512 B to 16 KB is six sizes of four rows, then four churn rows and three mixed
+    TEST_ASSERT_EQUAL_UINT32(6 * 4 + 4 + 3, rows.size());
+    for (const Row& row : rows)
+    {
+        TEST_ASSERT_EQUAL_STRING("host", row.medium.c_str());
+        TEST_ASSERT_TRUE_MESSAGE(row.ok, row.test.c_str());
+        TEST_ASSERT_TRUE_MESSAGE(row.elapsedMicros > 0, row.test.c_str());
+        TEST_ASSERT_TRUE_MESSAGE(row.worstMicros <= row.elapsedMicros, row.test.c_str());
+        uint32_t kbPerSecond = static_cast<uint32_t>(static_cast<uint64_t>(row.bytes) * 1000000 / 1024 / row.elapsedMicros);
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(kbPerSecond, row.kbPerSecond, row.test.c_str());
+    }
+
+    // Nothing created by the suite survives it
+    TEST_ASSERT_EQUAL_UINT32(0, storage.files.size());
+    TEST_ASSERT_EQUAL_UINT32(0, countEntries(&bench, DIRECTORY));
+}
+
+void test_block_rows_count_what_was_moved()
+{
+    StorageBenchmark benchmark(storage.backend(), fullHooks(bench), buffer, sizeof(buffer));
+    benchmark.setFileBytes(FILE_BYTES);
+    TEST_ASSERT_EQUAL_UINT16(0, benchmark.run(DIRECTORY));
+    std::vector<Row> rows = parseRows(bench);
+
+    uint32_t lastReadRate = 0;
+    for (uint32_t block = StorageBenchmark::MIN_BLOCK; block <= BUFFER_BYTES; block *= 2)
+    {
+        const Row* seqWrite = findRow(rows, "seq_write", block);
+        const Row* seqRead = findRow(rows, "seq_read", block);
+        const Row* randRead = findRow(rows, "rand_read", block);
+        const Row* randWrite = findRow(rows, "rand_write", block);
+        TEST_ASSERT_NOT_NULL(seqWrite);
+        TEST_ASSERT_NOT_NULL(seqRead);
+        TEST_ASSERT_NOT_NULL(randRead);
+        TEST_ASSERT_NOT_NULL(randWrite);
+
+        TEST_ASSERT_EQUAL_UINT32(FILE_BYTES / block, seqWrite->operations);
+        TEST_ASSERT_EQUAL_UINT32(FILE_BYTES, seqWrite->bytes);
+        TEST_ASSERT_EQUAL_UINT32(FILE_BYTES / block, seqRead->operations);
+        TEST_ASSERT_EQUAL_UINT32(FILE_BYTES, seqRead->bytes);
+        TEST_ASSERT_EQUAL_UINT32(StorageBenchmark::RANDOM_OPERATIONS, randRead->operations);
+        TEST_ASSERT_EQUAL_UINT32(StorageBenchmark::RANDOM_OPERATIONS * block, randRead->bytes);
+        TEST_ASSERT_EQUAL_UINT32(StorageBenchmark::RANDOM_OPERATIONS, randWrite->operations);
+        TEST_ASSERT_EQUAL_UINT32(StorageBenchmark::RANDOM_OPERATIONS * block, randWrite->bytes);
+
+        // Each read costs the same whatever its size, so bigger blocks must read faster
+        TEST_ASSERT_TRUE(seqRead->kbPerSecond > lastReadRate);
+        lastReadRate = seqRead->kbPerSecond;
+
+        // A write pays per sector, plus one open and one sync for the whole pass
+        uint32_t sectors = FILE_BYTES / 512;
+        TEST_ASSERT_TRUE(seqWrite->elapsedMicros >= sectors * SECTOR_WRITE_MICROS + OPEN_MICROS + SYNC_MICROS);
+        TEST_ASSERT_TRUE(seqWrite->worstMicros >= block / 512 * SECTOR_WRITE_MICROS);
+    }
+    TEST_ASSERT_NULL(findRow(rows, "seq_write", BUFFER_BYTES * 2));
+
+    // One sync per writing pass: two per block size and the mixed write
+    TEST_ASSERT_EQUAL_UINT32(6 * 2 + 1, storage.syncs);
+}
+
+void test_churn_and_mixed_rows()
+{
+    StorageBenchmark benchmark(storage.backend(), fullHooks(bench), buffer, sizeof(buffer));
+    benchmark.setFileBytes(FILE_BYTES);
+    TEST_ASSERT_EQUAL_UINT16(0, benchmark.run(DIRECTORY));
+    std::vector<Row> rows = parseRows(bench);
+
+    const Row* create = findRow(rows, "create", CHURN_FILE_BYTES);
+    TEST_ASSERT_NOT_NULL(create);
+    TEST_ASSERT_EQUAL_UINT32(StorageBenchmark::CHURN_FILES, create->operations);
+    TEST_ASSERT_EQUAL_UINT32(StorageBenchmark::CHURN_FILES * CHURN_FILE_BYTES, create->bytes);
+    const Row* reopen = findRow(rows, "open_close", 0);
+    TEST_ASSERT_NOT_NULL(reopen);
+    TEST_ASSERT_EQUAL_UINT32(StorageBenchmark::CHURN_FILES, reopen->operations);
+    TEST_ASSERT_TRUE(reopen->elapsedMicros >= StorageBenchmark::CHURN_FILES * OPEN_MICROS);
+    const Row* list = findRow(rows, "list", 0);
+    TEST_ASSERT_NOT_NULL(list);
+    TEST_ASSERT_EQUAL_UINT32(StorageBenchmark::CHURN_FILES, list->operations);
+    const Row* remove = findRow(rows, "remove", 0);
+    TEST_ASSERT_NOT_NULL(remove);
+    TEST_ASSERT_EQUAL_UINT32(StorageBenchmark::CHURN_FILES, remove->operations);
+
+    // A quarter of the file in 4 KB blocks, with one bus transfer after each
+    uint32_t blocks = FILE_BYTES / 4 / StorageBenchmark::MIXED_BLOCK;
+    const Row* mixedWrite = findRow(rows, "mixed_write", StorageBenchmark::MIXED_BLOCK);
+    const Row* mixedRead = findRow(rows, "mixed_read", StorageBenchmark::MIXED_BLOCK);
+    const Row* load = findRow(rows, "bus_load", 0);
+    TEST_ASSERT_NOT_NULL(mixedWrite);
+    TEST_ASSERT_NOT_NULL(mixedRead);
+    TEST_ASSERT_NOT_NULL(load);
+    TEST_ASSERT_EQUAL_UINT32(blocks, mixedWrite->operations);
+    TEST_ASSERT_EQUAL_UINT32(blocks * StorageBenchmark::MIXED_BLOCK, mixedRead->bytes);
+    TEST_ASSERT_EQUAL_UINT32(2 * blocks, bench.busLoads);
+    TEST_ASSERT_EQUAL_UINT32(2 * blocks, load->operations);
+
+    // The bus time is on its own row, not folded into the storage rows
+    TEST_ASSERT_TRUE(load->elapsedMicros >= 2 * blocks * BUS_LOAD_MICROS);
+    TEST_ASSERT_TRUE(load->elapsedMicros < 2 * blocks * (BUS_LOAD_MICROS + 10));
+    TEST_ASSERT_TRUE(mixedRead->elapsedMicros < blocks * (READ_MICROS + 10) + OPEN_MICROS + 10);
+}
+
+void test_small_buffer_and_missing_hooks_skip_rows()
+{
+    BenchmarkHooks hooks = { simulatedMicros, nullptr, nullptr, collect, &bench };
+    static uint8_t small[SMALL_BUFFER_BYTES];
+    StorageBenchmark benchmark(storage.backend(), hooks, small, sizeof(small));
+    benchmark.setFileBytes(FILE_BYTES);
+    TEST_ASSERT_EQUAL_UINT16(0, benchmark.run(DIRECTORY));
+    std::vector<Row> rows = parseRows(bench);
+
+    // 512, 1024 and 2048 byte blocks, then create, open_close and remove
+    TEST_ASSERT_EQUAL_UINT32(3 * 4 + 3, rows.size());
+    TEST_ASSERT_NOT_NULL(findRow(rows, "seq_read", SMALL_BUFFER_BYTES));
+    TEST_ASSERT_NULL(findRow(rows, "seq_read", SMALL_BUFFER_BYTES * 2));
+    TEST_ASSERT_NULL(findRow(rows, "list", 0));
+    TEST_ASSERT_NULL(findRow(rows, "bus_load", 0));
+    TEST_ASSERT_EQUAL_UINT32(0, storage.files.size());
+}
+
+void test_failed_medium_is_reported_not_hidden()
+{
+    StorageBenchmark benchmark(storage.backend(), fullHooks(bench), buffer, sizeof(buffer));
+    benchmark.setFileBytes(FILE_BYTES);
+    // The 512-byte passes take 194 writes and removes; the card dies in the next size
+    storage.powerLossAfter(250);
+    uint16_t failures = benchmark.run(DIRECTORY);
+    std::vector<Row> rows = parseRows(bench);
+
+    uint16_t failedRows = 0;
+    for (const Row& row : rows)
+    {
+        if (!row.ok) failedRows++;
+    }
+    TEST_ASSERT_TRUE(failures > 0);
+    TEST_ASSERT_EQUAL_UINT16(failedRows, failures);
+
+    // Rows before the card died are still good, and the suite ran to the end
+    for (size_t i = 0; i < 4; i++) TEST_ASSERT_TRUE(rows[i].ok);
+    TEST_ASSERT_FALSE(findRow(rows, "seq_write", 1024)->ok);
+    TEST_ASSERT_EQUAL_UINT32(6 * 4 + 4 + 3, rows.size());
+}
+
+void test_overlong_directory_fails_once()
+{
+    StorageBenchmark benchmark(storage.backend(), fullHooks(bench), buffer, sizeof(buffer));
+    std::string directory(StorageBenchmark::PATH_LENGTH, 'd');
+    TEST_ASSERT_EQUAL_UINT16(1, benchmark.run(directory.c_str()));
+    TEST_ASSERT_EQUAL_UINT32(1, bench.lines.size());
+    TEST_ASSERT_EQUAL_UINT32(0, storage.opens);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_full_run_reports_every_row_and_cleans_up);
+    RUN_TEST(test_block_rows_count_what_was_moved);
+    RUN_TEST(test_churn_and_mixed_rows);
+    RUN_TEST(test_small_buffer_and_missing_hooks_skip_rows);
+    RUN_TEST(test_failed_medium_is_reported_not_hidden);
+    RUN_TEST(test_overlong_directory_fails_once);
+    return UNITY_END();
+}
@@ -0,0 +1,266 @@
+/**
+ * @file test_main.cpp
+ * @brief StorageUsage delta folding, quiet rescans, concurrency and per-frame cost
+ *
+ * The measure hook stands in for a FAT walk: it loops over a configurable
+ * number of clusters, so the benchmark can compare scanning on every frame
+ * (as drawStats() used to) with taking a snapshot and checking its revision.
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include "PrefrontalCortex/StorageUsage.h"
+
+using namespace PrefrontalCortex;
+
+namespace
+{
+    const uint64_t CARD_BYTES = 8ull << 30;
+    const uint64_t START_USED_BYTES = 100ull << 20;
+    const uint32_t CONCURRENT_MILLIS = 300;
+    const uint32_t SNAPSHOT_FRAMES = 1000000;
+    const uint32_t SCAN_FRAMES = 200;
+    const double MIN_SPEEDUP_AT_1M_CLUSTERS = 100.0;
+
+    struct FakeCard
+    {
+        std::atomic<uint64_t> usedBytes;
+        uint32_t clusters;
+        uint32_t scans;
+    };
+
+    bool measureCard(void* context, uint64_t* totalBytes, uint64_t* usedBytes)
+    {
+        FakeCard& card = *static_cast<FakeCard*>(context);
+        volatile uint32_t sum = 0;
+        for (uint32_t i = 0; i < card.clusters; i++) sum = sum + i;
+        card.scans++;
+        *totalBytes = CARD_BYTES;
+        *usedBytes = card.usedBytes.load();
+        return true;
+    }
+
+    /**
+     * @brief The Stats view's lines, reformatted only when the revision moves
+     */
+    struct StatsText
+    {
+        uint32_t revision;
+        char size[32];
+        char used[32];
+        char total[32];
+    };
+
+    void drawFrame(const StorageUsage& usage, StatsText& text)
+    {
+        StorageUsageSnapshot snapshot = usage.snapshot();
+        if (snapshot.revision == text.revision) return;
+        text.revision = snapshot.revision;
+        snprintf(text.size, sizeof(text.size), "SD Card Size: %uMB", snapshot.cardKB / 1024);
+        snprintf(text.used, sizeof(text.used), "SD Card Used: %uMB", snapshot.usedKB / 1024);
+        snprintf(text.total, sizeof(text.total), "SD Card Total: %uMB", snapshot.totalKB / 1024);
+    }
+
+    double nanosPerFrame(std::chrono::steady_clock::time_point start, uint32_t frames)
+    {
+        return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / frames;
+    }
+
+    struct Concurrency
+    {
+        StorageUsage* usage;
+        std::atomic<bool> stop;
+        std::atomic<uint32_t> inconsistent;
+    };
+
+    void runPublisher(Concurrency* state)
+    {
+        for (uint32_t now = 10; !state->stop.load(); now++)
+        {
+            state->usage->recordDelta(4096);
+            state->usage->recordDelta(-4096);
+            state->usage->recordDelta(1024);
+            state->usage->update(now, now);
+        }
+    }
+
+    void runGrower(Concurrency* state)
+    {
+        while (!state->stop.load()) state->usage->recordDelta(512);
+    }
+
+    void runShrinker(Concurrency* state)
+    {
+        while (!state->stop.load()) state->usage->recordDelta(-512);
+    }
+
+    void runReader(Concurrency* state)
+    {
+        uint32_t last = 0;
+        while (!state->stop.load())
+        {
+            StorageUsageSnapshot snapshot = state->usage->snapshot();
+            bool consistent = snapshot.revision >= last &&
+                              snapshot.cardKB == CARD_BYTES / 1024 &&
+                              snapshot.usedKB <= snapshot.totalKB;
+            if (!consistent) state->inconsistent++;
+            last = snapshot.revision;
+        }
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_deltas_fold_in_and_revision_tracks_changes()
+{
+    FakeCard card;
+    card.usedBytes = START_USED_BYTES;
+    card.clusters = 1000;
+    card.scans = 0;
+    StorageUsageHooks hooks = { measureCard, &card };
+    StorageUsage usage(hooks);
+
+    TEST_ASSERT_EQUAL_UINT32(0, usage.snapshot().revision);
+    TEST_ASSERT_TRUE(usage.mount(CARD_BYTES, 0));
+    StorageUsageSnapshot snapshot = usage.snapshot();
+    TEST_ASSERT_EQUAL_UINT32(1, snapshot.revision);
+    TEST_ASSERT_EQUAL_UINT32(CARD_BYTES / 1024, snapshot.cardKB);
+    TEST_ASSERT_EQUAL_UINT32(CARD_BYTES / 1024, snapshot.totalKB);
+    TEST_ASSERT_EQUAL_UINT32(START_USED_BYTES / 1024, snapshot.usedKB);
+    TEST_ASSERT_EQUAL_UINT32(1, card.scans);
+
+    // +1 MB and -512 KB fold into one new revision, without a scan
+    usage.recordDelta(1 << 20);
+    usage.recordDelta(-(512 << 10));
+    usage.update(1000, 1000);
+    snapshot = usage.snapshot();
+    TEST_ASSERT_EQUAL_UINT32(2, snapshot.revision);
+    TEST_ASSERT_EQUAL_UINT32((START_USED_BYTES + (512 << 10)) / 1024, snapshot.usedKB);
+    TEST_ASSERT_EQUAL_UINT32(1, card.scans);
+
+    // Nothing changed, so a view has nothing to reformat
+    usage.update(2000, 1000);
+    TEST_ASSERT_EQUAL_UINT32(2, usage.snapshot().revision);
+}
+
+void test_rescan_waits_for_a_quiet_card()
+{
+    FakeCard card;
+    card.usedBytes = START_USED_BYTES;
+    card.clusters = 1000;
+    card.scans = 0;
+    StorageUsageHooks hooks = { measureCard, &card };
+    StorageUsage usage(hooks);
+    usage.mount(CARD_BYTES, 0);
+
+    // Due, but nothing changed since the mount
+    usage.update(StorageUsage::REFRESH_MS + StorageUsage::QUIET_MS, 0);
+    TEST_ASSERT_EQUAL_UINT32(1, card.scans);
+
+    // Changed and due, but the card was busy a moment ago
+    usage.recordDelta(1 << 20);
+    card.usedBytes = START_USED_BYTES + (600 << 10);
+    usage.update(StorageUsage::REFRESH_MS + 10, StorageUsage::REFRESH_MS);
+    TEST_ASSERT_EQUAL_UINT32(1, card.scans);
+    TEST_ASSERT_EQUAL_UINT32((START_USED_BYTES + (1 << 20)) / 1024, usage.snapshot().usedKB);
+
+    // Quiet: the measurement replaces the estimate
+    uint32_t now = StorageUsage::REFRESH_MS + 5000;
+    usage.update(now, StorageUsage::REFRESH_MS);
+    StorageUsageSnapshot snapshot = usage.snapshot();
+    TEST_ASSERT_EQUAL_UINT32(2, card.scans);
+    TEST_ASSERT_EQUAL_UINT32((START_USED_BYTES + (600 << 10)) / 1024, snapshot.usedKB);
+    TEST_ASSERT_EQUAL_UINT32(now, snapshot.measuredMs);
+
+    // Estimates clamp at empty and at full
+    usage.recordDelta(-static_cast<int32_t>(200u << 20));
+    usage.update(now + 1000, 0);
+    TEST_ASSERT_EQUAL_UINT32(0, usage.snapshot().usedKB);
+    for (uint32_t i = 1; i <= 5; i++)
+    {
+        usage.recordDelta(2000000000);
+        usage.update(now + 1000 + i, 0);
+    }
+    TEST_ASSERT_EQUAL_UINT32(CARD_BYTES / 1024, usage.snapshot().usedKB);
+}
+
+void test_snapshots_stay_consistent_across_tasks()
+{
+    FakeCard card;
+    card.usedBytes = START_USED_BYTES;
+    card.clusters = 10;
+    card.scans = 0;
+    StorageUsageHooks hooks = { measureCard, &card };
+    StorageUsage usage(hooks);
+    usage.mount(CARD_BYTES, 0);
+
+    Concurrency state;
+    state.usage = &usage;
+    state.stop = false;
+    state.inconsistent = 0;
+    std::thread publisher(runPublisher, &state);
+    std::thread grower(runGrower, &state);
+    std::thread shrinker(runShrinker, &state);
+    std::thread reader(runReader, &state);
+    std::this_thread::sleep_for(std::chrono::milliseconds(CONCURRENT_MILLIS));
+    state.stop = true;
+    publisher.join();
+    grower.join();
+    shrinker.join();
+    reader.join();
+
+    char message[64];
+    snprintf(message, sizeof(message), "%u revisions published", usage.snapshot().revision);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL_UINT32(0, state.inconsistent.load());
+    TEST_ASSERT_GREATER_THAN(1, usage.snapshot().revision);
+}
+
+void test_snapshot_per_frame_beats_scanning_per_frame()
+{
+    const uint32_t clusterCounts[] = { 1000, 100000, 1000000 };
+    double speedup = 0;
+    for (uint32_t clusters : clusterCounts)
+    {
+        FakeCard card;
+        card.usedBytes = START_USED_BYTES;
+        card.clusters = clusters;
+        card.scans = 0;
+        StorageUsageHooks hooks = { measureCard, &card };
+        StorageUsage usage(hooks);
+        usage.mount(CARD_BYTES, 0);
+
+        uint64_t total = 0;
+        uint64_t used = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < SCAN_FRAMES; i++) measureCard(&card, &total, &used);
+        double scanNanos = nanosPerFrame(start, SCAN_FRAMES);
+
+        StatsText text = { 0, "", "", "" };
+        start = std::chrono::steady_clock::now();
+        for (uint32_t i = 0; i < SNAPSHOT_FRAMES; i++) drawFrame(usage, text);
+        double snapshotNanos = nanosPerFrame(start, SNAPSHOT_FRAMES);
+        TEST_ASSERT_EQUAL_STRING("SD Card Used: 100MB", text.used);
+
+        char message[96];
+        snprintf(message, sizeof(message), "%7u clusters: scan per frame %9.0f ns, snapshot per frame %5.1f ns",
+                 clusters, scanNanos, snapshotNanos);
+        TEST_MESSAGE(message);
+        speedup = scanNanos / snapshotNanos;
+    }
+    TEST_ASSERT_TRUE(speedup > MIN_SPEEDUP_AT_1M_CLUSTERS);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_deltas_fold_in_and_revision_tracks_changes);
+    RUN_TEST(test_rescan_waits_for_a_quiet_card);
+    RUN_TEST(test_snapshots_stay_consistent_across_tasks);
+    RUN_TEST(test_snapshot_per_frame_beats_scanning_per_frame);
+    return UNITY_END();
+}
@@ -0,0 +1,417 @@
+/**
+ * @file test_main.cpp
+ * @brief StorageWorker ordering, back-pressure and latency under a slow card
+ *
+ * The priority tests drive processOne() by hand. The load test runs the
+ * worker on its own thread against MemoryStorage wrapped in delays, with one
+ * operation in twenty stalling for 20 ms, while an audio thread awaits each
+ * block's future and the main thread floods logging appends.
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "MemoryStorage.h"
+#include "PrefrontalCortex/StorageWorker.h"
+
+using namespace PrefrontalCortex;
+using HostTest::MemoryStorage;
+
+namespace
+{
+    const uint16_t AUDIO_BLOCKS = 200;
+    const uint16_t BLOCK_BYTES = 512;
+    const uint32_t FLOOD_MILLIS = 1500;
+    const char LOG_LINE[] = "log line\n";
+    const uint32_t LOG_LINE_BYTES = sizeof(LOG_LINE) - 1;
+    const uint32_t SPIKE_MICROS = 20000;
+    const uint32_t MAX_AUDIO_WAIT_MICROS = 3 * SPIKE_MICROS;
+
+    uint32_t hostMicros(void*)
+    {
+        return static_cast<uint32_t>(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    void sleepMicros(uint32_t micros)
+    {
+        std::this_thread::sleep_for(std::chrono::microseconds(micros));
+    }
+
+    /**
+     * @brief Directory listing straight from the in-memory card
+     */
+    int32_t listFiles(void* context, const char* path, char* out, uint32_t length, uint32_t* used)
+    {
+        MemoryStorage& card = *static_cast<MemoryStorage*>(context);
+        int32_t count = 0;
+        *used = 0;
+        for (const auto& file : card.files)
+        {
+            if (file.first.compare(0, strlen(path), path) != 0) continue;
+            std::string name = file.first.substr(strlen(path)) + "\n";
+            if (*used + name.size() > length) break;
+            memcpy(out + *used, name.data(), name.size());
+            *used += static_cast<uint32_t>(name.size());
+            count++;
+        }
+        return count;
+    }
+
+    /**
+     * @brief MemoryStorage behind SD-like latency, with the odd long stall
+     */
+    struct SlowCard
+    {
+        MemoryStorage card;
+        StorageBackend inner;
+        std::mutex lock;
+        uint32_t lcgState;
+
+        SlowCard() : inner(card.backend()), lcgState(1) {}
+
+        void delay(uint32_t micros)
+        {
+            {
+                std::lock_guard<std::mutex> guard(lock);
+                lcgState = lcgState * 1664525u + 1013904223u;
+                if ((lcgState >> 8) % 20 == 0) micros += SPIKE_MICROS;
+            }
+            sleepMicros(micros);
+        }
+
+        StorageBackend backend()
+        {
+            StorageBackend backend = { open, close, read, write, size, sync, exists, remove, rename, this };
+            return backend;
+        }
+
+        static SlowCard& self(void* context) { return *static_cast<SlowCard*>(context); }
+
+        static StorageBackend::Handle open(void* context, const char* path, bool create)
+        {
+            SlowCard& slow = self(context);
+            slow.delay(500);
+            return slow.inner.open(slow.inner.context, path, create);
+        }
+
+        static void close(void* context, StorageBackend::Handle file)
+        {
+            SlowCard& slow = self(context);
+            slow.inner.close(slow.inner.context, file);
+        }
+
+        static size_t read(void* context, StorageBackend::Handle file, uint32_t offset, uint8_t* data, size_t length)
+        {
+            SlowCard& slow = self(context);
+            slow.delay(300);
+            return slow.inner.read(slow.inner.context, file, offset, data, length);
+        }
+
+        static size_t write(void* context, StorageBackend::Handle file, uint32_t offset, const uint8_t* data, size_t length)
+        {
+            SlowCard& slow = self(context);
+            slow.delay(1000);
+            return slow.inner.write(slow.inner.context, file, offset, data, length);
+        }
+
+        static uint32_t size(void* context, StorageBackend::Handle file)
+        {
+            SlowCard& slow = self(context);
+            return slow.inner.size(slow.inner.context, file);
+        }
+
+        static bool sync(void* context, StorageBackend::Handle file)
+        {
+            SlowCard& slow = self(context);
+            return slow.inner.sync(slow.inner.context, file);
+        }
+
+        static bool exists(void* context, const char* path)
+        {
+            SlowCard& slow = self(context);
+            return slow.inner.exists(slow.inner.context, path);
+        }
+
+        static bool remove(void* context, const char* path)
+        {
+            SlowCard& slow = self(context);
+            return slow.inner.remove(slow.inner.context, path);
+        }
+
+        static bool rename(void* context, const char* from, const char* to)
+        {
+            SlowCard& slow = self(context);
+            return slow.inner.rename(slow.inner.context, from, to);
+        }
+    };
+
+    struct Delivered
+    {
+        std::vector<uint32_t> ids;
+        uint32_t failures;
+        bool ordered;
+    };
+
+    void onCompletion(void* context, const StorageCompletion& completion)
+    {
+        Delivered& delivered = *static_cast<Delivered*>(context);
+        if (!completion.ok) delivered.failures++;
+        if (!delivered.ids.empty() && completion.id < delivered.ids.back()) delivered.ordered = false;
+        delivered.ids.push_back(completion.id);
+    }
+
+    StorageRequest appendRequest(StoragePriority priority, Delivered* delivered)
+    {
+        StorageRequest request = StorageWorker::makeRequest(StorageOp::APPEND, "/log.txt", priority);
+        request.data = reinterpret_cast<uint8_t*>(const_cast<char*>(LOG_LINE));
+        request.length = LOG_LINE_BYTES;
+        request.callback = onCompletion;
+        request.context = delivered;
+        return request;
+    }
+
+    void await(StorageWorker& worker, const StorageRequest& request)
+    {
+        TEST_ASSERT_TRUE(worker.submit(request) != 0);
+        while (!request.future->done.load(std::memory_order_acquire)) sleepMicros(100);
+    }
+
+    struct WorkerThread
+    {
+        StorageWorker* worker;
+        std::atomic<bool> stop;
+    };
+
+    void runWorker(WorkerThread* thread)
+    {
+        while (!thread->stop.load())
+        {
+            if (!thread->worker->processOne()) sleepMicros(200);
+        }
+    }
+
+    struct AudioThread
+    {
+        StorageWorker* worker;
+        uint32_t failures;
+    };
+
+    /**
+     * @brief One block every 2 ms at rising offsets, each awaited like the recorder does
+     */
+    void runAudio(AudioThread* audio)
+    {
+        uint8_t block[BLOCK_BYTES];
+        StorageFuture future;
+        for (uint16_t i = 0; i < AUDIO_BLOCKS; i++)
+        {
+            memset(block, i & 0xFF, sizeof(block));
+            StorageRequest request = StorageWorker::makeRequest(StorageOp::WRITE, "/rec.wav", StoragePriority::AUDIO);
+            request.offset = i * BLOCK_BYTES;
+            request.data = block;
+            request.length = BLOCK_BYTES;
+            request.future = &future;
+            while (!audio->worker->submit(request)) sleepMicros(100);
+            while (!future.done.load(std::memory_order_acquire)) sleepMicros(50);
+            if (!future.result.ok) audio->failures++;
+            sleepMicros(2000);
+        }
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_higher_priority_runs_first()
+{
+    MemoryStorage card;
+    StorageWorkerHooks hooks = { hostMicros, listFiles, nullptr, &card };
+    StorageWorker worker(card.backend(), hooks);
+    Delivered delivered = { {}, 0, true };
+
+    uint32_t log = worker.submit(appendRequest(StoragePriority::LOGGING, &delivered));
+    uint32_t normal = worker.submit(appendRequest(StoragePriority::NORMAL, &delivered));
+    uint32_t audio = worker.submit(appendRequest(StoragePriority::AUDIO, &delivered));
+    TEST_ASSERT_FALSE(worker.idle());
+    while (worker.processOne())
+    {
+    }
+    TEST_ASSERT_TRUE(worker.idle());
+    TEST_ASSERT_EQUAL_UINT32(3, worker.poll());
+
+    TEST_ASSERT_EQUAL_UINT32(3, delivered.ids.size());
+    TEST_ASSERT_EQUAL_UINT32(audio, delivered.ids[0]);
+    TEST_ASSERT_EQUAL_UINT32(normal, delivered.ids[1]);
+    TEST_ASSERT_EQUAL_UINT32(log, delivered.ids[2]);
+    TEST_ASSERT_EQUAL_UINT32(3 * LOG_LINE_BYTES, card.files["/log.txt"].size());
+
+    // One open served the burst, and it was closed once the queues drained
+    TEST_ASSERT_EQUAL_UINT32(1, card.opens);
+    TEST_ASSERT_EQUAL_UINT32(2, worker.stats().handleReuses);
+    TEST_ASSERT_EQUAL_UINT32(1, card.syncs);
+}
+
+void test_logging_is_not_starved()
+{
+    MemoryStorage card;
+    StorageWorkerHooks hooks = { hostMicros, listFiles, nullptr, &card };
+    StorageWorker worker(card.backend(), hooks);
+    Delivered delivered = { {}, 0, true };
+
+    uint32_t log = worker.submit(appendRequest(StoragePriority::LOGGING, &delivered));
+    for (uint32_t i = 0; i < StorageWorker::QUEUE_DEPTH; i++)
+    {
+        TEST_ASSERT_TRUE(worker.submit(appendRequest(StoragePriority::NORMAL, &delivered)) != 0);
+    }
+    while (worker.processOne())
+    {
+    }
+    worker.poll();
+
+    TEST_ASSERT_EQUAL_UINT32(StorageWorker::QUEUE_DEPTH + 1, delivered.ids.size());
+    TEST_ASSERT_EQUAL_UINT32(log, delivered.ids[StorageWorker::MAX_BYPASS]);
+}
+
+void test_full_queues_reject_instead_of_losing_completions()
+{
+    MemoryStorage card;
+    StorageWorkerHooks hooks = { hostMicros, listFiles, nullptr, &card };
+    StorageWorker worker(card.backend(), hooks);
+    Delivered delivered = { {}, 0, true };
+
+    // The logging queue fills first
+    uint32_t accepted = 0;
+    while (worker.submit(appendRequest(StoragePriority::LOGGING, &delivered))) accepted++;
+    TEST_ASSERT_EQUAL_UINT32(StorageWorker::QUEUE_DEPTH, accepted);
+
+    // Callback slots are reserved at submit, so a main loop that stops polling is refused up front
+    while (worker.processOne())
+    {
+    }
+    while (worker.submit(appendRequest(StoragePriority::NORMAL, &delivered)))
+    {
+        accepted++;
+        while (worker.processOne())
+        {
+        }
+    }
+    TEST_ASSERT_EQUAL_UINT32(StorageWorker::COMPLETION_DEPTH, accepted);
+    TEST_ASSERT_GREATER_THAN(0, worker.stats().rejected);
+
+    TEST_ASSERT_EQUAL_UINT32(StorageWorker::COMPLETION_DEPTH, worker.poll());
+    TEST_ASSERT_EQUAL_UINT32(0, delivered.failures);
+    TEST_ASSERT_TRUE(worker.submit(appendRequest(StoragePriority::NORMAL, &delivered)) != 0);
+
+    // A path that does not fit is refused rather than truncated
+    char longPath[StorageRequest::PATH_LENGTH + 8];
+    memset(longPath, 'p', sizeof(longPath) - 1);
+    longPath[sizeof(longPath) - 1] = '\0';
+    TEST_ASSERT_EQUAL_UINT32(0, worker.submit(StorageWorker::makeRequest(StorageOp::STAT, longPath)));
+}
+
+void test_audio_keeps_up_under_a_logging_flood()
+{
+    SlowCard slow;
+    StorageWorkerHooks hooks = { hostMicros, listFiles, nullptr, &slow.card };
+    StorageWorker worker(slow.backend(), hooks);
+    Delivered delivered = { {}, 0, true };
+
+    WorkerThread workerThread;
+    workerThread.worker = &worker;
+    workerThread.stop = false;
+    AudioThread audio = { &worker, 0 };
+    std::thread workerTask(runWorker, &workerThread);
+    std::thread audioTask(runAudio, &audio);
+
+    uint32_t submitted = 0;
+    uint32_t rejected = 0;
+    auto start = std::chrono::steady_clock::now();
+    while (std::chrono::steady_clock::now() - start < std::chrono::milliseconds(FLOOD_MILLIS))
+    {
+        if (worker.submit(appendRequest(StoragePriority::LOGGING, &delivered))) submitted++;
+        else rejected++;
+        worker.poll();
+        sleepMicros(300);
+    }
+    audioTask.join();
+    while (!worker.idle())
+    {
+        worker.poll();
+        sleepMicros(1000);
+    }
+    worker.poll();
+
+    // Stat, list and read back through the same worker
+    StorageFuture future;
+    StorageRequest stat = StorageWorker::makeRequest(StorageOp::STAT, "/rec.wav");
+    stat.future = &future;
+    await(worker, stat);
+    TEST_ASSERT_TRUE(future.result.ok);
+    TEST_ASSERT_EQUAL_UINT32(AUDIO_BLOCKS * BLOCK_BYTES, future.result.size);
+
+    stat = StorageWorker::makeRequest(StorageOp::STAT, "/missing");
+    stat.future = &future;
+    await(worker, stat);
+    TEST_ASSERT_FALSE(future.result.ok);
+
+    char names[64];
+    StorageRequest list = StorageWorker::makeRequest(StorageOp::LIST, "/");
+    list.data = reinterpret_cast<uint8_t*>(names);
+    list.length = sizeof(names);
+    list.future = &future;
+    await(worker, list);
+    TEST_ASSERT_TRUE(future.result.ok);
+    TEST_ASSERT_EQUAL_UINT32(2, future.result.size);
+    TEST_ASSERT_EQUAL_STRING_LEN("log.txt\nrec.wav\n", names, future.result.bytes);
+
+    uint8_t block[BLOCK_BYTES];
+    StorageRequest read = StorageWorker::makeRequest(StorageOp::READ, "/rec.wav");
+    read.offset = (AUDIO_BLOCKS - 1) * BLOCK_BYTES;
+    read.data = block;
+    read.length = BLOCK_BYTES;
+    read.future = &future;
+    await(worker, read);
+    TEST_ASSERT_TRUE(future.result.ok);
+    TEST_ASSERT_EQUAL_UINT8((AUDIO_BLOCKS - 1) & 0xFF, block[0]);
+
+    workerThread.stop = true;
+    workerTask.join();
+
+    StorageWorkerStats stats = worker.stats();
+    char message[192];
+    snprintf(message, sizeof(message),
+             "%u log appends (%u rejected), %u opens, %u handle reuses; worst wait audio %u us, normal %u us, logging %u us",
+             submitted, rejected, slow.card.opens, stats.handleReuses, stats.maxQueuedMicros[0],
+             stats.maxQueuedMicros[1], stats.maxQueuedMicros[2]);
+    TEST_MESSAGE(message);
+
+    // Every block landed in place and every log line arrived once, in order
+    const HostTest::Bytes& recording = slow.card.files["/rec.wav"];
+    TEST_ASSERT_EQUAL_UINT32(AUDIO_BLOCKS * BLOCK_BYTES, recording.size());
+    for (uint16_t i = 0; i < AUDIO_BLOCKS; i++) TEST_ASSERT_EQUAL_UINT8(i & 0xFF, recording[i * BLOCK_BYTES]);
+    TEST_ASSERT_EQUAL_UINT32(0, audio.failures);
+    TEST_ASSERT_EQUAL_UINT32(submitted, delivered.ids.size());
+    TEST_ASSERT_EQUAL_UINT32(0, delivered.failures);
+    TEST_ASSERT_TRUE(delivered.ordered);
+    TEST_ASSERT_EQUAL_UINT32(submitted * LOG_LINE_BYTES, slow.card.files["/log.txt"].size());
+
+    // Audio waits behind at most the request in service, spike included
+    TEST_ASSERT_TRUE(stats.maxQueuedMicros[0] < MAX_AUDIO_WAIT_MICROS);
+    TEST_ASSERT_TRUE(stats.maxQueuedMicros[0] < stats.maxQueuedMicros[2]);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_higher_priority_runs_first);
+    RUN_TEST(test_logging_is_not_starved);
+    RUN_TEST(test_full_queues_reject_instead_of_losing_completions);
+    RUN_TEST(test_audio_keeps_up_under_a_logging_flood);
+    return UNITY_END();
+}
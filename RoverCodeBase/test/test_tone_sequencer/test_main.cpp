@@ -0,0 +1,309 @@
+/**
+ * @file test_main.cpp
+ * @brief ToneSequencer timing against a simulated clock
+ *
+ * Every start and stop the sequencer emits is logged with the simulated
+ * time it happened at, and the log is checked against the schedule.
+ */
+
+#include <unity.h>
+#include "AuditoryCortex/ToneSequencer.h"
+
+using namespace AuditoryCortex;
+
+namespace
+{
+    struct Emitted
+    {
+        uint32_t atMs;
+        bool start;
+        uint8_t slot;
+        uint16_t frequency;
+    };
+
+    const size_t LOG_CAPACITY = 256;
+    Emitted emitted[LOG_CAPACITY];
+    size_t emittedCount = 0;
+    uint32_t nowMs = 0;
+
+    void onStart(uint8_t slot, const ToneEvent& event)
+    {
+        if (emittedCount < LOG_CAPACITY) emitted[emittedCount++] = { nowMs, true, slot, event.frequency };
+    }
+
+    void onStop(uint8_t slot)
+    {
+        if (emittedCount < LOG_CAPACITY) emitted[emittedCount++] = { nowMs, false, slot, 0 };
+    }
+
+    void run(ToneSequencer& sequencer, uint32_t untilMs, uint32_t stepMs = 1)
+    {
+        for (; nowMs <= untilMs; nowMs += stepMs) sequencer.update(nowMs);
+    }
+
+    /**
+     * @brief Onset times of the starts on one lane, in order
+     */
+    size_t onsets(TonePriority lane, uint32_t* out, size_t capacity)
+    {
+        size_t found = 0;
+        for (size_t i = 0; i < emittedCount && found < capacity; i++)
+        {
+            if (emitted[i].start && emitted[i].slot / ToneSequencer::VOICES_PER_LANE == static_cast<uint8_t>(lane))
+            {
+                out[found++] = emitted[i].atMs;
+            }
+        }
+        return found;
+    }
+
+    size_t count(bool start, TonePriority lane)
+    {
+        size_t found = 0;
+        for (size_t i = 0; i < emittedCount; i++)
+        {
+            if (emitted[i].start == start && emitted[i].slot / ToneSequencer::VOICES_PER_LANE == static_cast<uint8_t>(lane)) found++;
+        }
+        return found;
+    }
+}
+
+void setUp(void)
+{
+    emittedCount = 0;
+    nowMs = 0;
+}
+
+void tearDown(void)
+{
+}
+
+void test_onsets_and_gaps_follow_the_schedule(void)
+{
+    ToneSequencer sequencer;
+    sequencer.setOutput(onStart, onStop);
+    for (uint16_t i = 0; i < 3; i++) TEST_ASSERT_TRUE(sequencer.enqueueTone(TonePriority::TUNE, 400 + i, 200, 50));
+
+    run(sequencer, 1000);
+
+    // start 0, stop 200, start 250, stop 450, start 500, stop 700
+    const uint32_t expected[] = { 0, 200, 250, 450, 500, 700 };
+    TEST_ASSERT_EQUAL_UINT(6, emittedCount);
+    for (size_t i = 0; i < 6; i++)
+    {
+        TEST_ASSERT_EQUAL_UINT32(expected[i], emitted[i].atMs);
+        TEST_ASSERT_EQUAL(i % 2 == 0, emitted[i].start);
+    }
+    TEST_ASSERT_EQUAL_UINT16(402, emitted[4].frequency);
+    TEST_ASSERT_FALSE(sequencer.isBusy());
+    TEST_ASSERT_EQUAL(-1, sequencer.activeLane());
+}
+
+void test_late_ticks_do_not_stretch_the_rhythm(void)
+{
+    ToneSequencer sequencer;
+    sequencer.setOutput(onStart, onStop);
+    for (uint16_t i = 0; i < 8; i++) sequencer.enqueueTone(TonePriority::TUNE, 500, 100, 25);
+
+    // A 30 ms loop sees each onset late, but never by more than one tick
+    run(sequencer, 2000, 30);
+    uint32_t starts[8];
+    TEST_ASSERT_EQUAL_UINT(8, onsets(TonePriority::TUNE, starts, 8));
+    for (uint32_t i = 0; i < 8; i++)
+    {
+        uint32_t scheduled = i * 125;
+        TEST_ASSERT_GREATER_OR_EQUAL_UINT32(scheduled, starts[i]);
+        TEST_ASSERT_LESS_THAN_UINT32(scheduled + 30, starts[i]);
+    }
+}
+
+void test_notes_missed_during_a_stall_are_skipped(void)
+{
+    ToneSequencer sequencer;
+    sequencer.setOutput(onStart, onStop);
+    for (uint16_t i = 0; i < 4; i++) sequencer.enqueueTone(TonePriority::TUNE, 600 + i, 100, 100);
+
+    sequencer.update(0);
+    nowMs = 450;                    // Loop stalled through the second note and into the third
+    sequencer.update(nowMs);
+    run(sequencer, 1000);
+
+    // The first plays; the second is over and dropped; the third is joined late; the fourth is on time
+    uint16_t frequencies[4];
+    size_t starts = 0;
+    for (size_t i = 0; i < emittedCount; i++)
+    {
+        if (emitted[i].start && starts < 4) frequencies[starts++] = emitted[i].frequency;
+    }
+    TEST_ASSERT_EQUAL_UINT(3, starts);
+    TEST_ASSERT_EQUAL_UINT16(600, frequencies[0]);
+    TEST_ASSERT_EQUAL_UINT16(602, frequencies[1]);
+    TEST_ASSERT_EQUAL_UINT16(603, frequencies[2]);
+    uint32_t times[3];
+    onsets(TonePriority::TUNE, times, 3);
+    TEST_ASSERT_EQUAL_UINT32(600, times[2]);
+}
+
+void test_ui_preempts_tune_and_tune_resumes(void)
+{
+    ToneSequencer sequencer;
+    sequencer.setOutput(onStart, onStop);
+    for (uint16_t i = 0; i < 4; i++) sequencer.enqueueTone(TonePriority::TUNE, 400 + i, 200, 50);
+
+    run(sequencer, 299);
+    sequencer.enqueueTone(TonePriority::UI, 1000, 100, 50);
+    sequencer.enqueueTone(TonePriority::UI, 1100, 100);
+    run(sequencer, 300);
+    TEST_ASSERT_EQUAL(static_cast<int>(TonePriority::UI), sequencer.activeLane());
+    run(sequencer, 2000);
+
+    // The tune note sounding at 300 is cut, UI plays at 300 and 450
+    uint32_t ui[2];
+    TEST_ASSERT_EQUAL_UINT(2, onsets(TonePriority::UI, ui, 2));
+    TEST_ASSERT_EQUAL_UINT32(300, ui[0]);
+    TEST_ASSERT_EQUAL_UINT32(450, ui[1]);
+
+    // The remaining tune shifts by the 250 ms it was held (300 to 550)
+    uint32_t tune[4];
+    TEST_ASSERT_EQUAL_UINT(4, onsets(TonePriority::TUNE, tune, 4));
+    TEST_ASSERT_EQUAL_UINT32(0, tune[0]);
+    TEST_ASSERT_EQUAL_UINT32(250, tune[1]);
+    TEST_ASSERT_EQUAL_UINT32(750, tune[2]);
+    TEST_ASSERT_EQUAL_UINT32(1000, tune[3]);
+
+    // Nothing from the tune sounds while the UI lane holds the output
+    for (size_t i = 0; i < emittedCount; i++)
+    {
+        bool tuneStart = emitted[i].start && emitted[i].slot < ToneSequencer::VOICES_PER_LANE;
+        TEST_ASSERT_FALSE(tuneStart && emitted[i].atMs > 300 && emitted[i].atMs < 550);
+    }
+    TEST_ASSERT_EQUAL_UINT(count(true, TonePriority::TUNE), count(false, TonePriority::TUNE));
+    TEST_ASSERT_FALSE(sequencer.isBusy());
+}
+
+void test_alert_preempts_ui_and_both_lower_lanes_resume(void)
+{
+    ToneSequencer sequencer;
+    sequencer.setOutput(onStart, onStop);
+    sequencer.enqueueTone(TonePriority::TUNE, 300, 400, 0);
+    sequencer.enqueueTone(TonePriority::TUNE, 310, 400, 0);
+    run(sequencer, 100);
+    sequencer.enqueueTone(TonePriority::UI, 900, 200, 0);
+    run(sequencer, 150);
+    sequencer.enqueueTone(TonePriority::ALERT, 2000, 100, 0);
+    run(sequencer, 3000);
+
+    uint32_t tune[2], ui[1], alert[1];
+    TEST_ASSERT_EQUAL_UINT(1, onsets(TonePriority::ALERT, alert, 1));
+    TEST_ASSERT_EQUAL_UINT32(151, alert[0]);
+    TEST_ASSERT_EQUAL_UINT(1, onsets(TonePriority::UI, ui, 1));
+    TEST_ASSERT_EQUAL_UINT32(101, ui[0]);
+    TEST_ASSERT_EQUAL_UINT(2, onsets(TonePriority::TUNE, tune, 2));
+
+    // UI was held 151..251 and plays out its shifted timeline to 401; the tune was held 101..401
+    TEST_ASSERT_EQUAL_UINT32(400 + 300, tune[1]);
+    TEST_ASSERT_FALSE(sequencer.isBusy());
+}
+
+void test_replace_pending_drops_queued_notes(void)
+{
+    ToneSequencer sequencer;
+    sequencer.setOutput(onStart, onStop);
+    for (uint16_t i = 0; i < 5; i++) sequencer.enqueueTone(TonePriority::TUNE, 400, 100, 0);
+    run(sequencer, 150);
+
+    ToneEvent click = { 1500, 20, 20, 42, 7 };
+    TEST_ASSERT_TRUE(sequencer.enqueue(TonePriority::TUNE, click, true));
+    TEST_ASSERT_EQUAL_UINT8(1, sequencer.pendingCount(TonePriority::TUNE));
+    run(sequencer, 1000);
+
+    uint32_t tune[8];
+    TEST_ASSERT_EQUAL_UINT(3, onsets(TonePriority::TUNE, tune, 8));
+    TEST_ASSERT_EQUAL_UINT32(151, tune[2]);
+    TEST_ASSERT_EQUAL_UINT16(1500, emitted[emittedCount - 2].frequency);
+}
+
+void test_lane_capacity_and_rests(void)
+{
+    ToneSequencer sequencer;
+    sequencer.setOutput(onStart, onStop);
+    for (uint8_t i = 0; i < ToneSequencer::LANE_CAPACITY; i++)
+    {
+        TEST_ASSERT_TRUE(sequencer.enqueueTone(TonePriority::TUNE, i % 2 ? 0 : 440, 10, 0));
+    }
+    TEST_ASSERT_FALSE(sequencer.enqueueTone(TonePriority::TUNE, 440, 10, 0));
+    TEST_ASSERT_EQUAL_UINT8(0, sequencer.freeSpace(TonePriority::TUNE));
+
+    run(sequencer, 1000);
+    TEST_ASSERT_EQUAL_UINT(ToneSequencer::LANE_CAPACITY / 2, count(true, TonePriority::TUNE));
+    TEST_ASSERT_EQUAL_UINT(ToneSequencer::LANE_CAPACITY / 2, count(false, TonePriority::TUNE));
+}
+
+void test_non_preemptive_lanes_sound_together(void)
+{
+    ToneSequencer sequencer;
+    sequencer.setOutput(onStart, onStop);
+    sequencer.setPreemptive(false);
+    sequencer.enqueueTone(TonePriority::TUNE, 400, 300, 0);
+    sequencer.enqueueTone(TonePriority::TUNE, 410, 300, 0);
+    run(sequencer, 100);
+    sequencer.enqueueTone(TonePriority::UI, 900, 100, 0);
+    run(sequencer, 1000);
+
+    uint32_t tune[2], ui[1];
+    TEST_ASSERT_EQUAL_UINT(2, onsets(TonePriority::TUNE, tune, 2));
+    TEST_ASSERT_EQUAL_UINT32(300, tune[1]);
+    TEST_ASSERT_EQUAL_UINT(1, onsets(TonePriority::UI, ui, 1));
+    TEST_ASSERT_EQUAL_UINT32(101, ui[0]);
+}
+
+void test_overlapping_notes_take_separate_voices(void)
+{
+    ToneSequencer sequencer;
+    sequencer.setOutput(onStart, onStop);
+    ToneEvent chord = { 262, 300, 0, 42, 0 };
+    sequencer.enqueue(TonePriority::TUNE, chord);
+    chord.frequency = 330;
+    sequencer.enqueue(TonePriority::TUNE, chord);
+    chord.frequency = 392;
+    chord.advanceMs = 300;
+    sequencer.enqueue(TonePriority::TUNE, chord);
+    run(sequencer, 500);
+
+    TEST_ASSERT_EQUAL_UINT(6, emittedCount);
+    TEST_ASSERT_EQUAL_UINT8(0, emitted[0].slot);
+    TEST_ASSERT_EQUAL_UINT8(1, emitted[1].slot);
+    TEST_ASSERT_EQUAL_UINT8(2, emitted[2].slot);
+    for (size_t i = 3; i < 6; i++) TEST_ASSERT_EQUAL_UINT32(300, emitted[i].atMs);
+}
+
+void test_clock_wraparound(void)
+{
+    ToneSequencer sequencer;
+    sequencer.setOutput(onStart, onStop);
+    for (uint16_t i = 0; i < 3; i++) sequencer.enqueueTone(TonePriority::TUNE, 500, 100, 100);
+
+    // Run 700 ms across the 32-bit wrap
+    nowMs = 0xFFFFFF00u;
+    for (uint32_t step = 0; step <= 700; step++, nowMs++) sequencer.update(nowMs);
+
+    TEST_ASSERT_EQUAL_UINT(6, emittedCount);
+    TEST_ASSERT_EQUAL_UINT32(0xFFFFFF00u + 400, emitted[4].atMs);
+    TEST_ASSERT_EQUAL_UINT32(0xFFFFFF00u + 500, emitted[5].atMs);
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_onsets_and_gaps_follow_the_schedule);
+    RUN_TEST(test_late_ticks_do_not_stretch_the_rhythm);
+    RUN_TEST(test_notes_missed_during_a_stall_are_skipped);
+    RUN_TEST(test_ui_preempts_tune_and_tune_resumes);
+    RUN_TEST(test_alert_preempts_ui_and_both_lower_lanes_resume);
+    RUN_TEST(test_replace_pending_drops_queued_notes);
+    RUN_TEST(test_lane_capacity_and_rests);
+    RUN_TEST(test_non_preemptive_lanes_sound_together);
+    RUN_TEST(test_overlapping_notes_take_separate_voices);
+    RUN_TEST(test_clock_wraparound);
+    return UNITY_END();
+}
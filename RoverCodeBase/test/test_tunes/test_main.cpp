@@ -0,0 +1,559 @@
+/**
+ * @file test_main.cpp
+ * @brief Every tune against the note lists it had before the tables became constexpr
+ *
+ * The notes, LED frames and time signatures below were transcribed by script
+ * from the original Tunes.cpp, and the expected Hz and ms worked out from the
+ * original NOTE_FREQUENCIES table and getNoteDuration(), not from the code
+ * under test. A slip in the constexpr tables or in buildTuneSteps() shows up
+ * here even though the render goldens were recorded after the change.
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <string.h>
+#include "AuditoryCortex/Tunes.h"
+
+using namespace AuditoryCortex;
+
+namespace
+{
+    struct BaselineNote
+    {
+        NoteIndex note;
+        uint8_t octave;
+        NoteType type;
+        uint16_t frequency;   // Hz, 0 for rests
+        uint16_t durationMs;
+    };
+
+    // ROVERBYTE_JINGLE, Quantum Tails: TIME_6_8
+    const BaselineNote ROVERBYTE_JINGLE_NOTES[] =
+    {
+        { NoteIndex::NOTE_G, 4, NoteType::QUARTER, 370, 125 },
+        { NoteIndex::NOTE_A, 4, NoteType::EIGHTH, 415, 62 },
+        { NoteIndex::NOTE_B, 4, NoteType::EIGHTH, 466, 62 },
+        { NoteIndex::REST, 0, NoteType::EIGHTH, 0, 62 },
+        { NoteIndex::NOTE_C, 5, NoteType::QUARTER, 494, 125 },
+        { NoteIndex::NOTE_E, 5, NoteType::QUARTER, 622, 125 },
+        { NoteIndex::NOTE_D, 5, NoteType::EIGHTH, 554, 62 },
+        { NoteIndex::REST, 0, NoteType::QUARTER, 0, 125 },
+        { NoteIndex::NOTE_F, 5, NoteType::HALF, 659, 250 },
+        { NoteIndex::NOTE_A, 4, NoteType::EIGHTH, 415, 62 },
+        { NoteIndex::NOTE_C, 5, NoteType::QUARTER, 494, 125 },
+        { NoteIndex::NOTE_B, 4, NoteType::EIGHTH, 466, 62 },
+        { NoteIndex::NOTE_G, 4, NoteType::QUARTER, 370, 125 },
+        { NoteIndex::REST, 0, NoteType::QUARTER, 0, 125 },
+        { NoteIndex::NOTE_D, 5, NoteType::HALF, 554, 250 },
+        { NoteIndex::NOTE_G, 4, NoteType::WHOLE, 370, 500 }
+    };
+    const uint8_t ROVERBYTE_JINGLE_LEDS[] =
+    {
+        0b00000001, 0b00000010, 0b00000100, 0b00001000,
+        0b00010000, 0b00100000, 0b01000000, 0b10000000,
+        0b11000000, 0b01100000, 0b00110000, 0b00011000,
+        0b00001100, 0b00000110, 0b00000011, 0b00000001
+    };
+
+    // CHRISTMAS_SONG, Painted Skies: TIME_4_4
+    const BaselineNote CHRISTMAS_SONG_NOTES[] =
+    {
+        { NoteIndex::NOTE_C, 4, NoteType::QUARTER, 247, 250 },
+        { NoteIndex::NOTE_G, 4, NoteType::EIGHTH, 370, 125 },
+        { NoteIndex::NOTE_A, 4, NoteType::EIGHTH, 415, 125 },
+        { NoteIndex::REST, 0, NoteType::QUARTER, 0, 250 },
+        { NoteIndex::NOTE_B, 4, NoteType::HALF, 466, 500 },
+        { NoteIndex::NOTE_D, 5, NoteType::QUARTER, 554, 250 },
+        { NoteIndex::NOTE_E, 5, NoteType::EIGHTH, 622, 125 },
+        { NoteIndex::NOTE_C, 5, NoteType::EIGHTH, 494, 125 },
+        { NoteIndex::REST, 0, NoteType::QUARTER, 0, 250 },
+        { NoteIndex::NOTE_G, 4, NoteType::QUARTER, 370, 250 },
+        { NoteIndex::NOTE_F, 4, NoteType::QUARTER, 330, 250 },
+        { NoteIndex::NOTE_E, 4, NoteType::QUARTER, 311, 250 },
+        { NoteIndex::NOTE_C, 4, NoteType::QUARTER, 247, 250 },
+        { NoteIndex::NOTE_A, 4, NoteType::HALF, 415, 500 }
+    };
+    const uint8_t CHRISTMAS_SONG_LEDS[] =
+    {
+        0b00000001, 0b00000011, 0b00000111, 0b00001110,
+        0b00011100, 0b00111000, 0b01110000, 0b11100000,
+        0b11000000, 0b10000001, 0b00000001, 0b00000111,
+        0b11111111, 0b00000000, 0b00000001
+    };
+
+    // AULD_LANG_SYNE, Symphonic Threads: TIME_3_4
+    const BaselineNote AULD_LANG_SYNE_NOTES[] =
+    {
+        { NoteIndex::NOTE_E, 4, NoteType::EIGHTH, 311, 125 },
+        { NoteIndex::NOTE_F, 4, NoteType::EIGHTH, 330, 125 },
+        { NoteIndex::NOTE_G, 4, NoteType::QUARTER, 370, 250 },
+        { NoteIndex::REST, 0, NoteType::EIGHTH, 0, 125 },
+        { NoteIndex::NOTE_A, 4, NoteType::QUARTER, 415, 250 },
+        { NoteIndex::NOTE_B, 4, NoteType::QUARTER, 466, 250 },
+        { NoteIndex::NOTE_C, 5, NoteType::HALF, 494, 500 },
+        { NoteIndex::NOTE_D, 5, NoteType::QUARTER, 554, 250 },
+        { NoteIndex::NOTE_C, 5, NoteType::QUARTER, 494, 250 },
+        { NoteIndex::NOTE_A, 4, NoteType::HALF, 415, 500 },
+        { NoteIndex::NOTE_B, 4, NoteType::QUARTER, 466, 250 },
+        { NoteIndex::REST, 0, NoteType::QUARTER, 0, 250 },
+        { NoteIndex::NOTE_C, 5, NoteType::HALF, 494, 500 },
+        { NoteIndex::NOTE_E, 5, NoteType::QUARTER, 622, 250 }
+    };
+    const uint8_t AULD_LANG_SYNE_LEDS[] =
+    {
+        0b00000001, 0b10000001, 0b11000011, 0b11100111,
+        0b11111111, 0b11100111, 0b11000011, 0b10000001,
+        0b00000001, 0b10001000, 0b11111111, 0b00000000,
+        0b00001100, 0b11110000
+    };
+
+    // JINGLE_BELLS, Winter Dance: TIME_4_4
+    const BaselineNote JINGLE_BELLS_NOTES[] =
+    {
+        { NoteIndex::NOTE_E, 4, NoteType::QUARTER, 311, 250 },
+        { NoteIndex::NOTE_E, 4, NoteType::QUARTER, 311, 250 },
+        { NoteIndex::NOTE_E, 4, NoteType::HALF, 311, 500 },
+        { NoteIndex::NOTE_E, 4, NoteType::QUARTER, 311, 250 },
+        { NoteIndex::NOTE_E, 4, NoteType::QUARTER, 311, 250 },
+        { NoteIndex::NOTE_E, 4, NoteType::HALF, 311, 500 },
+        { NoteIndex::NOTE_E, 4, NoteType::QUARTER, 311, 250 },
+        { NoteIndex::NOTE_G, 4, NoteType::QUARTER, 370, 250 },
+        { NoteIndex::NOTE_C, 5, NoteType::QUARTER, 494, 250 },
+        { NoteIndex::NOTE_D, 5, NoteType::QUARTER, 554, 250 },
+        { NoteIndex::NOTE_E, 5, NoteType::WHOLE, 622, 1000 },
+        { NoteIndex::NOTE_F, 5, NoteType::QUARTER, 659, 250 },
+        { NoteIndex::NOTE_F, 5, NoteType::EIGHTH, 659, 125 },
+        { NoteIndex::NOTE_F, 5, NoteType::EIGHTH, 659, 125 },
+        { NoteIndex::NOTE_F, 5, NoteType::HALF, 659, 500 },
+        { NoteIndex::NOTE_E, 5, NoteType::QUARTER, 622, 250 },
+        { NoteIndex::NOTE_D, 5, NoteType::QUARTER, 554, 250 },
+        { NoteIndex::NOTE_C, 5, NoteType::HALF, 494, 500 },
+        { NoteIndex::NOTE_G, 4, NoteType::QUARTER, 370, 250 },
+        { NoteIndex::NOTE_E, 4, NoteType::QUARTER, 311, 250 },
+        { NoteIndex::REST, 0, NoteType::HALF, 0, 500 }
+    };
+    const uint8_t JINGLE_BELLS_LEDS[] =
+    {
+        0b00000001, 0b00010001, 0b00100010, 0b01000100,
+        0b10001000, 0b11111111, 0b00000001, 0b00110000,
+        0b00001110, 0b11100111, 0b11111111, 0b00010001,
+        0b00100010, 0b01000100, 0b10001000, 0b11111111,
+        0b00100010, 0b00010001, 0b00000001, 0b00000000
+    };
+
+    // LOVE_SONG, Entangled Hearts: TIME_6_8
+    const BaselineNote LOVE_SONG_NOTES[] =
+    {
+        { NoteIndex::NOTE_A, 4, NoteType::EIGHTH, 415, 62 },
+        { NoteIndex::NOTE_C, 5, NoteType::QUARTER, 494, 125 },
+        { NoteIndex::NOTE_E, 5, NoteType::QUARTER, 622, 125 },
+        { NoteIndex::NOTE_G, 5, NoteType::EIGHTH, 740, 62 },
+        { NoteIndex::NOTE_F, 5, NoteType::EIGHTH, 659, 62 },
+        { NoteIndex::NOTE_E, 5, NoteType::QUARTER, 622, 125 },
+        { NoteIndex::NOTE_D, 5, NoteType::HALF, 554, 250 },
+        { NoteIndex::REST, 0, NoteType::EIGHTH, 0, 62 },
+        { NoteIndex::NOTE_C, 5, NoteType::QUARTER, 494, 125 },
+        { NoteIndex::NOTE_A, 4, NoteType::QUARTER, 415, 125 },
+        { NoteIndex::NOTE_B, 4, NoteType::HALF, 466, 250 },
+        { NoteIndex::NOTE_C, 5, NoteType::QUARTER, 494, 125 },
+        { NoteIndex::NOTE_E, 5, NoteType::QUARTER, 622, 125 },
+        { NoteIndex::NOTE_G, 5, NoteType::EIGHTH, 740, 62 },
+        { NoteIndex::NOTE_A, 5, NoteType::HALF, 831, 250 },
+        { NoteIndex::REST, 0, NoteType::EIGHTH, 0, 62 },
+        { NoteIndex::NOTE_F, 5, NoteType::QUARTER, 659, 125 },
+        { NoteIndex::NOTE_E, 5, NoteType::EIGHTH, 622, 62 },
+        { NoteIndex::NOTE_C, 5, NoteType::EIGHTH, 494, 62 },
+        { NoteIndex::NOTE_A, 4, NoteType::QUARTER, 415, 125 },
+        { NoteIndex::NOTE_F, 4, NoteType::HALF, 330, 250 },
+        { NoteIndex::NOTE_G, 4, NoteType::QUARTER, 370, 125 },
+        { NoteIndex::NOTE_A, 4, NoteType::HALF, 415, 250 },
+        { NoteIndex::NOTE_C, 5, NoteType::WHOLE, 494, 500 }
+    };
+    const uint8_t LOVE_SONG_LEDS[] =
+    {
+        0b00011000, 0b00111100, 0b01111110, 0b11111111,
+        0b01111110, 0b00111100, 0b00011000, 0b00000000,
+        0b00011000, 0b00111100, 0b01111110, 0b11111111,
+        0b01111110, 0b00111100, 0b00011000, 0b00000000,
+        0b00011000, 0b00111100, 0b01111110, 0b11111111,
+        0b01111110, 0b00111100, 0b00011000, 0b00000000
+    };
+
+    // HAPPY_BIRTHDAY, Celebration Sparks: TIME_3_4
+    const BaselineNote HAPPY_BIRTHDAY_NOTES[] =
+    {
+        { NoteIndex::NOTE_C, 4, NoteType::QUARTER, 247, 250 },
+        { NoteIndex::NOTE_C, 4, NoteType::EIGHTH, 247, 125 },
+        { NoteIndex::NOTE_D, 4, NoteType::QUARTER, 277, 250 },
+        { NoteIndex::NOTE_C, 4, NoteType::EIGHTH, 247, 125 },
+        { NoteIndex::NOTE_F, 4, NoteType::HALF, 330, 500 },
+        { NoteIndex::NOTE_E, 4, NoteType::QUARTER, 311, 250 },
+        { NoteIndex::NOTE_C, 4, NoteType::QUARTER, 247, 250 },
+        { NoteIndex::NOTE_C, 4, NoteType::QUARTER, 247, 250 },
+        { NoteIndex::NOTE_D, 4, NoteType::QUARTER, 277, 250 },
+        { NoteIndex::NOTE_C, 4, NoteType::EIGHTH, 247, 125 },
+        { NoteIndex::NOTE_G, 4, NoteType::HALF, 370, 500 },
+        { NoteIndex::NOTE_F, 4, NoteType::HALF, 330, 500 },
+        { NoteIndex::NOTE_C, 4, NoteType::QUARTER, 247, 250 },
+        { NoteIndex::NOTE_C, 4, NoteType::EIGHTH, 247, 125 },
+        { NoteIndex::NOTE_D, 4, NoteType::QUARTER, 277, 250 },
+        { NoteIndex::NOTE_C, 4, NoteType::EIGHTH, 247, 125 },
+        { NoteIndex::NOTE_C, 4, NoteType::HALF, 247, 500 },
+        { NoteIndex::NOTE_C, 4, NoteType::QUARTER, 247, 250 },
+        { NoteIndex::REST, 0, NoteType::HALF, 0, 500 }
+    };
+    const uint8_t HAPPY_BIRTHDAY_LEDS[] =
+    {
+        0b00011000, 0b00111100, 0b01111110, 0b11111111,
+        0b01111110, 0b00111100, 0b00011000, 0b00111100,
+        0b11111111, 0b01111110, 0b11111111, 0b00011000,
+        0b00001100, 0b00111100, 0b01111110, 0b11111111,
+        0b00111100, 0b00000000
+    };
+
+    // EASTER_SONG, Spring Awakening: TIME_6_8
+    const BaselineNote EASTER_SONG_NOTES[] =
+    {
+        { NoteIndex::NOTE_E, 4, NoteType::QUARTER, 311, 125 },
+        { NoteIndex::NOTE_G, 4, NoteType::QUARTER, 370, 125 },
+        { NoteIndex::NOTE_A, 4, NoteType::EIGHTH, 415, 62 },
+        { NoteIndex::NOTE_B, 4, NoteType::EIGHTH, 466, 62 },
+        { NoteIndex::NOTE_C, 5, NoteType::HALF, 494, 250 },
+        { NoteIndex::NOTE_B, 4, NoteType::QUARTER, 466, 125 },
+        { NoteIndex::NOTE_A, 4, NoteType::QUARTER, 415, 125 },
+        { NoteIndex::REST, 0, NoteType::EIGHTH, 0, 62 },
+        { NoteIndex::NOTE_G, 4, NoteType::QUARTER, 370, 125 },
+        { NoteIndex::NOTE_E, 4, NoteType::QUARTER, 311, 125 },
+        { NoteIndex::NOTE_F, 4, NoteType::QUARTER, 330, 125 },
+        { NoteIndex::NOTE_G, 4, NoteType::HALF, 370, 250 },
+        { NoteIndex::NOTE_A, 4, NoteType::QUARTER, 415, 125 },
+        { NoteIndex::NOTE_B, 4, NoteType::QUARTER, 466, 125 },
+        { NoteIndex::NOTE_C, 5, NoteType::HALF, 494, 250 },
+        { NoteIndex::NOTE_D, 5, NoteType::QUARTER, 554, 125 },
+        { NoteIndex::NOTE_E, 5, NoteType::WHOLE, 622, 500 }
+    };
+    const uint8_t EASTER_SONG_LEDS[] =
+    {
+        0b00000001, 0b00000011, 0b00000111, 0b00001110,
+        0b00011111, 0b00111111, 0b01111110, 0b11111111,
+        0b00111110, 0b00011100, 0b00001100, 0b00000100,
+        0b00000000, 0b00000001, 0b00001111, 0b11111111,
+        0b00000000
+    };
+
+    // MOTHERS_SONG, Heart of the Home: TIME_4_4
+    const BaselineNote MOTHERS_SONG_NOTES[] =
+    {
+        { NoteIndex::NOTE_C, 4, NoteType::HALF, 247, 500 },
+        { NoteIndex::NOTE_E, 4, NoteType::QUARTER, 311, 250 },
+        { NoteIndex::NOTE_G, 4, NoteType::QUARTER, 370, 250 },
+        { NoteIndex::NOTE_A, 4, NoteType::HALF, 415, 500 },
+        { NoteIndex::NOTE_F, 4, NoteType::QUARTER, 330, 250 },
+        { NoteIndex::NOTE_D, 4, NoteType::HALF, 277, 500 },
+        { NoteIndex::NOTE_E, 4, NoteType::QUARTER, 311, 250 },
+        { NoteIndex::NOTE_C, 4, NoteType::HALF, 247, 500 },
+        { NoteIndex::NOTE_G, 4, NoteType::QUARTER, 370, 250 },
+        { NoteIndex::REST, 0, NoteType::HALF, 0, 500 }
+    };
+    const uint8_t MOTHERS_SONG_LEDS[] =
+    {
+        0b00110000, 0b01111000, 0b11111100, 0b11111111,
+        0b01111000, 0b00110000, 0b00011000, 0b00001100,
+        0b00000100, 0b00000000
+    };
+
+    // FATHERS_SONG, Pillars of Strength: TIME_4_4
+    const BaselineNote FATHERS_SONG_NOTES[] =
+    {
+        { NoteIndex::NOTE_C, 4, NoteType::HALF, 247, 500 },
+        { NoteIndex::NOTE_G, 4, NoteType::QUARTER, 370, 250 },
+        { NoteIndex::NOTE_A, 4, NoteType::QUARTER, 415, 250 },
+        { NoteIndex::NOTE_F, 4, NoteType::HALF, 330, 500 },
+        { NoteIndex::NOTE_D, 4, NoteType::QUARTER, 277, 250 },
+        { NoteIndex::NOTE_E, 4, NoteType::QUARTER, 311, 250 },
+        { NoteIndex::NOTE_C, 4, NoteType::HALF, 247, 500 },
+        { NoteIndex::NOTE_G, 4, NoteType::QUARTER, 370, 250 },
+        { NoteIndex::NOTE_A, 4, NoteType::QUARTER, 415, 250 },
+        { NoteIndex::NOTE_C, 4, NoteType::WHOLE, 247, 1000 }
+    };
+    const uint8_t FATHERS_SONG_LEDS[] =
+    {
+        0b00010001, 0b00100010, 0b01000100, 0b10001000,
+        0b11111111, 0b01000100, 0b00100010, 0b00010001,
+        0b11111111, 0b00000000
+    };
+
+    // CANADA_SONG, Northern Lights: TIME_6_8
+    const BaselineNote CANADA_SONG_NOTES[] =
+    {
+        { NoteIndex::NOTE_C, 5, NoteType::QUARTER, 494, 125 },
+        { NoteIndex::NOTE_E, 5, NoteType::QUARTER, 622, 125 },
+        { NoteIndex::NOTE_G, 5, NoteType::QUARTER, 740, 125 },
+        { NoteIndex::NOTE_F, 5, NoteType::QUARTER, 659, 125 },
+        { NoteIndex::NOTE_A, 4, NoteType::HALF, 415, 250 },
+        { NoteIndex::NOTE_B, 4, NoteType::QUARTER, 466, 125 },
+        { NoteIndex::NOTE_C, 5, NoteType::QUARTER, 494, 125 },
+        { NoteIndex::NOTE_D, 5, NoteType::HALF, 554, 250 },
+        { NoteIndex::NOTE_E, 5, NoteType::WHOLE, 622, 500 }
+    };
+    const uint8_t CANADA_SONG_LEDS[] =
+    {
+        0b00000001, 0b00000011, 0b00000111, 0b00001111,
+        0b11111111, 0b00011111, 0b00001111, 0b00000011,
+        0b00000001
+    };
+
+    // USA_SONG, Stars and Stripes: TIME_4_4
+    const BaselineNote USA_SONG_NOTES[] =
+    {
+        { NoteIndex::NOTE_G, 4, NoteType::QUARTER, 370, 250 },
+        { NoteIndex::NOTE_C, 5, NoteType::QUARTER, 494, 250 },
+        { NoteIndex::NOTE_D, 5, NoteType::QUARTER, 554, 250 },
+        { NoteIndex::NOTE_E, 5, NoteType::HALF, 622, 500 },
+        { NoteIndex::NOTE_F, 5, NoteType::QUARTER, 659, 250 },
+        { NoteIndex::NOTE_E, 5, NoteType::HALF, 622, 500 },
+        { NoteIndex::NOTE_D, 5, NoteType::QUARTER, 554, 250 },
+        { NoteIndex::NOTE_C, 5, NoteType::WHOLE, 494, 1000 }
+    };
+    const uint8_t USA_SONG_LEDS[] =
+    {
+        0b10101010, 0b01010101, 0b10101010, 0b11111111,
+        0b10000001, 0b01000010, 0b00111100, 0b11111111
+    };
+
+    // CIVIC_SONG, Unity in Motion: TIME_4_4
+    const BaselineNote CIVIC_SONG_NOTES[] =
+    {
+        { NoteIndex::NOTE_D, 4, NoteType::QUARTER, 277, 250 },
+        { NoteIndex::NOTE_E, 4, NoteType::QUARTER, 311, 250 },
+        { NoteIndex::NOTE_F, 4, NoteType::HALF, 330, 500 },
+        { NoteIndex::NOTE_G, 4, NoteType::QUARTER, 370, 250 },
+        { NoteIndex::NOTE_A, 4, NoteType::HALF, 415, 500 },
+        { NoteIndex::NOTE_B, 4, NoteType::QUARTER, 466, 250 },
+        { NoteIndex::NOTE_G, 4, NoteType::WHOLE, 370, 1000 }
+    };
+    const uint8_t CIVIC_SONG_LEDS[] =
+    {
+        0b00000001, 0b00000011, 0b00000111, 0b00001111,
+        0b11111111, 0b11110000, 0b00000000
+    };
+
+    // WAKE_ME_UP_WHEN_SEPTEMBER_ENDS, Autumn's Farewell: TIME_4_4
+    const BaselineNote WAKE_ME_UP_WHEN_SEPTEMBER_ENDS_NOTES[] =
+    {
+        { NoteIndex::NOTE_E, 4, NoteType::QUARTER, 311, 250 },
+        { NoteIndex::NOTE_G, 4, NoteType::QUARTER, 370, 250 },
+        { NoteIndex::NOTE_F, 4, NoteType::HALF, 330, 500 },
+        { NoteIndex::NOTE_E, 4, NoteType::QUARTER, 311, 250 },
+        { NoteIndex::REST, 0, NoteType::QUARTER, 0, 250 },
+        { NoteIndex::NOTE_D, 4, NoteType::QUARTER, 277, 250 },
+        { NoteIndex::NOTE_C, 4, NoteType::HALF, 247, 500 },
+        { NoteIndex::NOTE_E, 4, NoteType::QUARTER, 311, 250 },
+        { NoteIndex::NOTE_F, 4, NoteType::QUARTER, 330, 250 },
+        { NoteIndex::NOTE_G, 4, NoteType::HALF, 370, 500 },
+        { NoteIndex::REST, 0, NoteType::EIGHTH, 0, 125 },
+        { NoteIndex::NOTE_A, 4, NoteType::QUARTER, 415, 250 },
+        { NoteIndex::NOTE_G, 4, NoteType::QUARTER, 370, 250 },
+        { NoteIndex::NOTE_F, 4, NoteType::HALF, 330, 500 },
+        { NoteIndex::NOTE_C, 4, NoteType::QUARTER, 247, 250 },
+        { NoteIndex::NOTE_E, 4, NoteType::HALF, 311, 500 },
+        { NoteIndex::NOTE_A, 4, NoteType::QUARTER, 415, 250 },
+        { NoteIndex::NOTE_F, 4, NoteType::QUARTER, 330, 250 },
+        { NoteIndex::NOTE_G, 4, NoteType::HALF, 370, 500 },
+        { NoteIndex::REST, 0, NoteType::QUARTER, 0, 250 },
+        { NoteIndex::NOTE_D, 4, NoteType::QUARTER, 277, 250 },
+        { NoteIndex::NOTE_C, 4, NoteType::WHOLE, 247, 1000 },
+        { NoteIndex::NOTE_A, 4, NoteType::HALF, 415, 500 },
+        { NoteIndex::NOTE_F, 4, NoteType::QUARTER, 330, 250 },
+        { NoteIndex::NOTE_G, 4, NoteType::QUARTER, 370, 250 },
+        { NoteIndex::NOTE_E, 4, NoteType::HALF, 311, 500 },
+        { NoteIndex::NOTE_D, 4, NoteType::QUARTER, 277, 250 },
+        { NoteIndex::NOTE_C, 4, NoteType::WHOLE, 247, 1000 },
+        { NoteIndex::REST, 0, NoteType::HALF, 0, 500 },
+        { NoteIndex::NOTE_A, 4, NoteType::WHOLE, 415, 1000 }
+    };
+    const uint8_t WAKE_ME_UP_WHEN_SEPTEMBER_ENDS_LEDS[] =
+    {
+        0b11111111, 0b01111110, 0b00111100, 0b00011000,
+        0b00000000, 0b00010000, 0b00111000, 0b00011100,
+        0b00001100, 0b00000011, 0b00000000, 0b11110000,
+        0b01111000, 0b00011100, 0b00001110, 0b00000110,
+        0b00000011, 0b00000000, 0b11111111, 0b00111000,
+        0b01111110, 0b11111111, 0b01111110, 0b00011000,
+        0b00000001, 0b00000000, 0b11111111, 0b00000000
+    };
+
+    // HALLOWEEN_SONG, Phantom Waltz: TIME_3_4
+    const BaselineNote HALLOWEEN_SONG_NOTES[] =
+    {
+        { NoteIndex::NOTE_E, 5, NoteType::QUARTER, 622, 250 },
+        { NoteIndex::NOTE_D, 5, NoteType::QUARTER, 554, 250 },
+        { NoteIndex::NOTE_C, 5, NoteType::HALF, 494, 500 },
+        { NoteIndex::REST, 0, NoteType::QUARTER, 0, 250 },
+        { NoteIndex::NOTE_B, 4, NoteType::QUARTER, 466, 250 },
+        { NoteIndex::NOTE_G, 4, NoteType::EIGHTH, 370, 125 },
+        { NoteIndex::NOTE_A, 4, NoteType::EIGHTH, 415, 125 },
+        { NoteIndex::NOTE_C, 5, NoteType::QUARTER, 494, 250 },
+        { NoteIndex::NOTE_E, 5, NoteType::HALF, 622, 500 },
+        { NoteIndex::REST, 0, NoteType::HALF, 0, 500 },
+        { NoteIndex::NOTE_D, 5, NoteType::QUARTER, 554, 250 },
+        { NoteIndex::NOTE_C, 5, NoteType::QUARTER, 494, 250 },
+        { NoteIndex::NOTE_B, 4, NoteType::HALF, 466, 500 },
+        { NoteIndex::NOTE_G, 4, NoteType::QUARTER, 370, 250 },
+        { NoteIndex::NOTE_A, 4, NoteType::HALF, 415, 500 },
+        { NoteIndex::NOTE_C, 5, NoteType::WHOLE, 494, 1000 }
+    };
+    const uint8_t HALLOWEEN_SONG_LEDS[] =
+    {
+        0b00000001, 0b00000100, 0b00001000, 0b10000000,
+        0b11000000, 0b01100000, 0b00011000, 0b00100100,
+        0b00010001, 0b11111111, 0b01111110, 0b00011000,
+        0b00000001, 0b00000000, 0b00111100, 0b11111111
+    };
+
+    // THANKSGIVING_SONG, Harvest Hymn: TIME_6_8
+    const BaselineNote THANKSGIVING_SONG_NOTES[] =
+    {
+        { NoteIndex::NOTE_C, 4, NoteType::EIGHTH, 247, 62 },
+        { NoteIndex::NOTE_E, 4, NoteType::QUARTER, 311, 125 },
+        { NoteIndex::NOTE_G, 4, NoteType::HALF, 370, 250 },
+        { NoteIndex::NOTE_A, 4, NoteType::QUARTER, 415, 125 },
+        { NoteIndex::NOTE_F, 4, NoteType::QUARTER, 330, 125 },
+        { NoteIndex::NOTE_D, 4, NoteType::EIGHTH, 277, 62 },
+        { NoteIndex::NOTE_B, 4, NoteType::EIGHTH, 466, 62 },
+        { NoteIndex::NOTE_C, 5, NoteType::HALF, 494, 250 },
+        { NoteIndex::NOTE_D, 5, NoteType::QUARTER, 554, 125 },
+        { NoteIndex::NOTE_E, 5, NoteType::QUARTER, 622, 125 },
+        { NoteIndex::NOTE_F, 5, NoteType::HALF, 659, 250 },
+        { NoteIndex::NOTE_E, 5, NoteType::QUARTER, 622, 125 },
+        { NoteIndex::NOTE_C, 5, NoteType::QUARTER, 494, 125 },
+        { NoteIndex::NOTE_A, 4, NoteType::HALF, 415, 250 },
+        { NoteIndex::NOTE_G, 4, NoteType::WHOLE, 370, 500 }
+    };
+    const uint8_t THANKSGIVING_SONG_LEDS[] =
+    {
+        0b00000001, 0b00000011, 0b00000111, 0b00001110,
+        0b00011100, 0b00111100, 0b01111110, 0b11111111,
+        0b01111110, 0b00111100, 0b00011100, 0b00001110,
+        0b00000110, 0b00000011, 0b00000001
+    };
+
+    struct BaselineTune
+    {
+        TunesTypes type;
+        const char* label;
+        const char* name;
+        const BaselineNote* notes;
+        size_t noteCount;
+        const uint8_t* leds;
+        size_t ledCount;
+        TimeSignature timeSignature;
+    };
+
+#define BASELINE_TUNE(id, title, signature) \
+    { TunesTypes::id, #id, title, id##_NOTES, sizeof(id##_NOTES) / sizeof(id##_NOTES[0]), \
+      id##_LEDS, sizeof(id##_LEDS), signature }
+
+    // In TunesTypes order
+    const BaselineTune BASELINE[] =
+    {
+        BASELINE_TUNE(ROVERBYTE_JINGLE, "Quantum Tails", TimeSignature::TIME_6_8),
+        BASELINE_TUNE(JINGLE_BELLS, "Winter Dance", TimeSignature::TIME_4_4),
+        BASELINE_TUNE(AULD_LANG_SYNE, "Symphonic Threads", TimeSignature::TIME_3_4),
+        BASELINE_TUNE(LOVE_SONG, "Entangled Hearts", TimeSignature::TIME_6_8),
+        BASELINE_TUNE(HAPPY_BIRTHDAY, "Celebration Sparks", TimeSignature::TIME_3_4),
+        BASELINE_TUNE(EASTER_SONG, "Spring Awakening", TimeSignature::TIME_6_8),
+        BASELINE_TUNE(MOTHERS_SONG, "Heart of the Home", TimeSignature::TIME_4_4),
+        BASELINE_TUNE(FATHERS_SONG, "Pillars of Strength", TimeSignature::TIME_4_4),
+        BASELINE_TUNE(CANADA_SONG, "Northern Lights", TimeSignature::TIME_6_8),
+        BASELINE_TUNE(USA_SONG, "Stars and Stripes", TimeSignature::TIME_4_4),
+        BASELINE_TUNE(CIVIC_SONG, "Unity in Motion", TimeSignature::TIME_4_4),
+        BASELINE_TUNE(WAKE_ME_UP_WHEN_SEPTEMBER_ENDS, "Autumn's Farewell", TimeSignature::TIME_4_4),
+        BASELINE_TUNE(HALLOWEEN_SONG, "Phantom Waltz", TimeSignature::TIME_3_4),
+        BASELINE_TUNE(THANKSGIVING_SONG, "Harvest Hymn", TimeSignature::TIME_6_8),
+        BASELINE_TUNE(CHRISTMAS_SONG, "Painted Skies", TimeSignature::TIME_4_4)
+    };
+
+#undef BASELINE_TUNE
+
+    const size_t TUNE_COUNT = sizeof(BASELINE) / sizeof(BASELINE[0]);
+
+    void assertMatchesBaseline(const BaselineTune& expected)
+    {
+        char message[96];
+        const Tune& tune = Tunes::getTune(expected.type);
+        TEST_ASSERT_EQUAL_STRING_MESSAGE(expected.name, tune.name, expected.label);
+        TEST_ASSERT_EQUAL_MESSAGE(static_cast<int>(expected.timeSignature), static_cast<int>(tune.timeSignature), expected.label);
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(expected.noteCount, tune.notes.size(), expected.label);
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(expected.noteCount, tune.steps.size(), expected.label);
+        TEST_ASSERT_EQUAL_INT_MESSAGE(static_cast<int>(expected.noteCount), Tunes::getTuneLength(expected.type), expected.label);
+
+        for (size_t i = 0; i < expected.noteCount; i++)
+        {
+            const BaselineNote& note = expected.notes[i];
+            snprintf(message, sizeof(message), "%s note %u", expected.label, static_cast<unsigned>(i));
+            TEST_ASSERT_EQUAL_MESSAGE(static_cast<int>(note.note), static_cast<int>(tune.notes[i].note), message);
+            TEST_ASSERT_EQUAL_UINT8_MESSAGE(note.octave, tune.notes[i].octave, message);
+            TEST_ASSERT_EQUAL_MESSAGE(static_cast<int>(note.type), static_cast<int>(tune.notes[i].type), message);
+            TEST_ASSERT_EQUAL_UINT16_MESSAGE(note.frequency, tune.steps[i].frequency, message);
+            TEST_ASSERT_EQUAL_UINT16_MESSAGE(note.durationMs, tune.steps[i].durationMs, message);
+        }
+
+        TEST_ASSERT_EQUAL_UINT32_MESSAGE(expected.ledCount, tune.ledAnimation.size(), expected.label);
+        TEST_ASSERT_EQUAL_HEX8_ARRAY_MESSAGE(expected.leds, tune.ledAnimation.begin(), expected.ledCount, expected.label);
+    }
+}
+
+void setUp() {}
+
+void tearDown() {}
+
+void test_baseline_covers_every_tune_type()
+{
+    TEST_ASSERT_EQUAL_UINT32(static_cast<size_t>(TunesTypes::CHRISTMAS_SONG) + 1, TUNE_COUNT);
+    for (size_t i = 0; i < TUNE_COUNT; i++)
+    {
+        TEST_ASSERT_EQUAL_MESSAGE(static_cast<int>(i), static_cast<int>(BASELINE[i].type), BASELINE[i].label);
+    }
+}
+
+void test_every_tune_matches_its_baseline()
+{
+    for (size_t i = 0; i < TUNE_COUNT; i++)
+    {
+        assertMatchesBaseline(BASELINE[i]);
+    }
+}
+
+void test_tunes_are_distinct()
+{
+    // The old getTune() fell back to the jingle for three types; each now has its own table
+    for (size_t i = 1; i < TUNE_COUNT; i++)
+    {
+        const Tune& tune = Tunes::getTune(BASELINE[i].type);
+        TEST_ASSERT_TRUE_MESSAGE(&tune != &Tunes::getTune(TunesTypes::ROVERBYTE_JINGLE), BASELINE[i].label);
+    }
+}
+
+void test_tone_events_follow_the_steps()
+{
+    const Tune& tune = Tunes::getTune(TunesTypes::ROVERBYTE_JINGLE);
+    for (size_t i = 0; i < tune.steps.size(); i++)
+    {
+        ToneEvent event = Tunes::toneEvent(tune, i, 42);
+        TEST_ASSERT_EQUAL_UINT16(tune.steps[i].frequency, event.frequency);
+        TEST_ASSERT_EQUAL_UINT16(tune.steps[i].durationMs, event.durationMs);
+        TEST_ASSERT_EQUAL_UINT8(42, event.volume);
+        TEST_ASSERT_EQUAL_UINT16(i + 1, event.cue);
+    }
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_baseline_covers_every_tune_type);
+    RUN_TEST(test_every_tune_matches_its_baseline);
+    RUN_TEST(test_tunes_are_distinct);
+    RUN_TEST(test_tone_events_follow_the_steps);
+    return UNITY_END();
+}
@@ -0,0 +1,208 @@
+/**
+ * @file test_main.cpp
+ * @brief WavetableSynth voices, stealing and render cost on host
+ *
+ * The render benchmark reports how many voices one percent of a host CPU
+ * keeps going at 44.1 kHz; the bound asserted is far below what a host
+ * manages, so it only catches a kernel that has become much slower.
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <chrono>
+#include "AuditoryCortex/WavetableSynth.h"
+
+using namespace AuditoryCortex;
+
+namespace
+{
+    const uint32_t SAMPLE_RATE = 44100;
+    const size_t BLOCK = 512;
+    const uint32_t BENCH_BLOCKS = 2000;
+    const int MIN_VOICES_PER_CPU_PERCENT = 10;
+
+    int16_t block[BLOCK * 2];
+
+    size_t blocksFor(uint32_t ms)
+    {
+        return (static_cast<size_t>(SAMPLE_RATE) * ms / 1000 + BLOCK - 1) / BLOCK;
+    }
+
+    /**
+     * @brief Render at least ms of mono audio, in whole blocks; returns the loudest sample
+     */
+    int renderFor(WavetableSynth& synth, uint32_t ms, uint32_t* crossings = nullptr)
+    {
+        size_t blocks = blocksFor(ms);
+        int peak = 0;
+        int16_t previous = 0;
+        for (size_t b = 0; b < blocks; b++)
+        {
+            synth.render(block, BLOCK);
+            for (size_t i = 0; i < BLOCK; i++)
+            {
+                if (abs(block[i]) > peak) peak = abs(block[i]);
+                if (crossings && (previous < 0) != (block[i] < 0)) (*crossings)++;
+                previous = block[i];
+            }
+        }
+        return peak;
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_note_sounds_at_its_pitch_and_releases()
+{
+    WavetableSynth synth(SAMPLE_RATE);
+    TEST_ASSERT_TRUE(synth.noteOn(1, 441, 255));
+
+    // Let the attack and decay settle, then count a second of zero crossings
+    renderFor(synth, 100);
+    uint32_t crossings = 0;
+    int peak = renderFor(synth, 1000, &crossings);
+    TEST_ASSERT_EQUAL_UINT8(1, synth.activeVoices());
+    TEST_ASSERT_GREATER_THAN(16000, peak);
+    TEST_ASSERT_UINT_WITHIN(4, 2 * 441 * blocksFor(1000) * BLOCK / SAMPLE_RATE, crossings);
+
+    TEST_ASSERT_TRUE(synth.noteOff(1));
+    renderFor(synth, 200);
+    TEST_ASSERT_EQUAL_UINT8(0, synth.activeVoices());
+    TEST_ASSERT_EQUAL_INT(0, renderFor(synth, 50));
+}
+
+void test_note_off_releases_only_its_tag()
+{
+    WavetableSynth synth(SAMPLE_RATE);
+    synth.noteOn(1, 300, 200);
+    synth.noteOn(2, 500, 200);
+    renderFor(synth, 50);
+    TEST_ASSERT_EQUAL_UINT8(2, synth.activeVoices());
+
+    synth.noteOff(2);
+    renderFor(synth, 200);
+    TEST_ASSERT_EQUAL_UINT8(1, synth.activeVoices());
+    TEST_ASSERT_GREATER_THAN(0, renderFor(synth, 20));
+}
+
+void test_oldest_voice_is_stolen_when_full()
+{
+    WavetableSynth synth(SAMPLE_RATE);
+    for (uint8_t v = 0; v <= WavetableSynth::MAX_VOICES; v++)
+    {
+        synth.noteOn(v, 200 + v * 50, 100);
+    }
+    renderFor(synth, 20);
+    TEST_ASSERT_EQUAL_UINT8(WavetableSynth::MAX_VOICES, synth.activeVoices());
+    TEST_ASSERT_EQUAL_UINT32(1, synth.stolenVoices());
+    TEST_ASSERT_EQUAL_UINT32(0, synth.rejectedNotes());
+
+    // Tag 0 lost its voice, so releasing it leaves everything sounding
+    synth.noteOff(0);
+    renderFor(synth, 200);
+    TEST_ASSERT_EQUAL_UINT8(WavetableSynth::MAX_VOICES, synth.activeVoices());
+}
+
+void test_lower_group_cannot_steal_from_higher()
+{
+    WavetableSynth synth(SAMPLE_RATE);
+    for (uint8_t v = 0; v < WavetableSynth::MAX_VOICES; v++)
+    {
+        synth.noteOn(v, 200 + v * 50, 100, 3);
+    }
+    synth.noteOn(100, 1000, 100, 0);
+    renderFor(synth, 20);
+    TEST_ASSERT_EQUAL_UINT32(1, synth.rejectedNotes());
+    TEST_ASSERT_EQUAL_UINT8(WavetableSynth::MAX_VOICES, synth.groupVoices(3));
+    TEST_ASSERT_EQUAL_UINT8(0, synth.groupVoices(0));
+
+    // The same note in the top group takes the oldest voice instead
+    synth.noteOn(101, 1000, 100, 3);
+    renderFor(synth, 20);
+    TEST_ASSERT_EQUAL_UINT32(1, synth.stolenVoices());
+}
+
+void test_group_gain_silences_its_voices()
+{
+    WavetableSynth synth(SAMPLE_RATE);
+    synth.noteOn(1, 440, 255, 1);
+    synth.setGroupGain(1, 0);
+    renderFor(synth, 50);
+    TEST_ASSERT_EQUAL_INT(0, renderFor(synth, 100));
+    TEST_ASSERT_EQUAL_UINT8(1, synth.activeVoices());
+}
+
+void test_full_mix_saturates_without_wrapping()
+{
+    WavetableSynth synth(SAMPLE_RATE);
+    synth.setWaveform(SynthWaveform::SQUARE);
+    for (uint8_t v = 0; v < WavetableSynth::MAX_VOICES; v++)
+    {
+        synth.noteOn(v, 110, 255);
+    }
+    renderFor(synth, 100);
+
+    // Identical in-phase squares add up far past full scale; clipped, the
+    // mix stays a square of the same sign instead of folding over
+    synth.render(block, BLOCK);
+    uint32_t clipped = 0;
+    for (size_t i = 0; i < BLOCK; i++)
+    {
+        if (block[i] == 32767 || block[i] == -32768) clipped++;
+        else TEST_ASSERT_GREATER_THAN(20000, abs(block[i]));
+    }
+    TEST_ASSERT_GREATER_THAN(BLOCK / 2, clipped);
+}
+
+void test_stereo_channels_match()
+{
+    WavetableSynth synth(SAMPLE_RATE);
+    synth.noteOn(1, 523, 180);
+    synth.renderStereo(block, BLOCK);
+    for (size_t i = 0; i < BLOCK; i++)
+    {
+        TEST_ASSERT_EQUAL_INT16(block[2 * i], block[2 * i + 1]);
+    }
+}
+
+void test_render_cost_per_voice()
+{
+    WavetableSynth synth(SAMPLE_RATE);
+    for (uint8_t v = 0; v < WavetableSynth::MAX_VOICES; v++)
+    {
+        synth.noteOn(v, 200 + v * 50, 100);
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    for (uint32_t b = 0; b < BENCH_BLOCKS; b++)
+    {
+        synth.renderStereo(block, BLOCK);
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double audioSeconds = static_cast<double>(BENCH_BLOCKS) * BLOCK / SAMPLE_RATE;
+    double cpuPercent = 100.0 * seconds / audioSeconds;
+    double voicesPerPercent = WavetableSynth::MAX_VOICES / cpuPercent;
+
+    char message[96];
+    snprintf(message, sizeof(message), "%u voices: %.3f%% CPU, %.1f voices per CPU percent",
+             WavetableSynth::MAX_VOICES, cpuPercent, voicesPerPercent);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL_UINT8(WavetableSynth::MAX_VOICES, synth.activeVoices());
+    TEST_ASSERT_GREATER_THAN(MIN_VOICES_PER_CPU_PERCENT, static_cast<int>(voicesPerPercent));
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_note_sounds_at_its_pitch_and_releases);
+    RUN_TEST(test_note_off_releases_only_its_tag);
+    RUN_TEST(test_oldest_voice_is_stolen_when_full);
+    RUN_TEST(test_lower_group_cannot_steal_from_higher);
+    RUN_TEST(test_group_gain_silences_its_voices);
+    RUN_TEST(test_full_mix_saturates_without_wrapping);
+    RUN_TEST(test_stereo_channels_match);
+    RUN_TEST(test_render_cost_per_voice);
+    return UNITY_END();
+}
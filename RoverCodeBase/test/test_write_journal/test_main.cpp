@@ -0,0 +1,287 @@
+/**
+ * @file test_main.cpp
+ * @brief WriteJournal power-loss injection, replay and write coalescing
+ *
+ * Each workload is replayed with power cut at every single card operation in
+ * turn. After the reboot the target files must equal the state after some
+ * prefix of the operations: never a torn or reordered mix, and never less
+ * than what the last completed flush made durable.
+ */
+
+#include <unity.h>
+#include <stdio.h>
+#include <chrono>
+#include <map>
+#include <string>
+#include <vector>
+#include "MemoryStorage.h"
+#include "PrefrontalCortex/WriteJournal.h"
+
+using namespace PrefrontalCortex;
+using HostTest::Bytes;
+using HostTest::MemoryStorage;
+
+namespace
+{
+    typedef std::map<std::string, Bytes> Files;
+
+    const char* const JOURNAL_PATH = "/journal.bin";
+    const char* const TARGETS[] = { "/log/a.txt", "/log/b.txt", "/cfg/c.txt", "/log/d.txt" };
+    const uint8_t TARGET_COUNT = 4;
+    const uint8_t OPS_PER_WORKLOAD = 120;
+    const uint8_t WORKLOADS = 6;
+    const uint16_t BENCH_LINES = 2000;
+    const uint8_t LINE_LENGTH = 40;
+
+    struct Op
+    {
+        uint8_t target;
+        bool replace;
+        Bytes data;
+    };
+
+    uint32_t lcgState = 1;
+
+    uint32_t nextRandom(uint32_t bound)
+    {
+        lcgState = lcgState * 1664525u + 1013904223u;
+        return (lcgState >> 8) % bound;
+    }
+
+    /**
+     * @brief Mostly short appends, with the odd replace, empty write and multi-sector record
+     */
+    std::vector<Op> makeWorkload(uint32_t seed)
+    {
+        lcgState = seed;
+        std::vector<Op> ops;
+        for (uint8_t i = 0; i < OPS_PER_WORKLOAD; i++)
+        {
+            Op op;
+            op.target = static_cast<uint8_t>(nextRandom(TARGET_COUNT));
+            op.replace = nextRandom(10) == 0;
+            size_t length = nextRandom(25) == 0 ? 700 + nextRandom(2500) : nextRandom(90);
+            if (nextRandom(40) == 0) length = 0;
+            for (size_t j = 0; j < length; j++) op.data.push_back(static_cast<uint8_t>('a' + (i + j) % 26));
+            ops.push_back(op);
+        }
+        return ops;
+    }
+
+    Files stateAfter(const Files& base, const std::vector<Op>& ops, size_t count)
+    {
+        Files state = base;
+        for (size_t i = 0; i < count; i++)
+        {
+            Bytes& file = state[TARGETS[ops[i].target]];
+            if (ops[i].replace) file = ops[i].data;
+            else file.insert(file.end(), ops[i].data.begin(), ops[i].data.end());
+        }
+        return state;
+    }
+
+    bool targetsMatch(const Files& expected, const Files& actual)
+    {
+        for (const char* path : TARGETS)
+        {
+            auto want = expected.find(path);
+            auto have = actual.find(path);
+            Bytes a = want == expected.end() ? Bytes() : want->second;
+            Bytes b = have == actual.end() ? Bytes() : have->second;
+            if (a != b) return false;
+        }
+        return true;
+    }
+
+    struct CrashTotals
+    {
+        uint32_t runs;
+        uint32_t tornRuns;
+        uint32_t lostOps;
+    };
+
+    /**
+     * @brief Cut power at every operation of one workload; false once a run completes
+     */
+    bool crashAt(uint32_t seed, long point, const std::vector<Op>& ops, CrashTotals& totals)
+    {
+        MemoryStorage card;
+        card.files[TARGETS[0]] = Bytes{ 'x', 'y' };
+        const Files base = card.files;
+
+        size_t durable = 0;
+        size_t done = 0;
+        bool finished = false;
+        {
+            WriteJournal journal(card.backend());
+            journal.setFlushPolicy(seed % 2 ? 1024 : 4096, 50);
+            TEST_ASSERT_TRUE(journal.open(JOURNAL_PATH));
+            card.powerLossAfter(point, seed * 7919 + static_cast<uint32_t>(point));
+
+            uint32_t now = 0;
+            for (; done < ops.size() && !card.powerLost(); done++)
+            {
+                const Op& op = ops[done];
+                uint32_t flushes = journal.stats().flushes;
+                bool accepted = op.replace
+                    ? journal.write(TARGETS[op.target], op.data.data(), op.data.size(), now)
+                    : journal.append(TARGETS[op.target], op.data.data(), op.data.size(), now);
+                if (!accepted) break;
+                now += 7;
+                journal.update(now);
+                if (journal.stats().flushes != flushes && !journal.hasPending()) durable = done + 1;
+            }
+            if (!card.powerLost() && journal.flush() && !card.powerLost()) durable = done;
+            finished = !card.powerLost();
+            card.cutPower();
+        }
+
+        card.restorePower();
+        totals.runs++;
+        {
+            WriteJournal journal(card.backend());
+            TEST_ASSERT_TRUE(journal.open(JOURNAL_PATH));
+            if (journal.stats().rejectedRecords) totals.tornRuns++;
+        }
+
+        bool matched = false;
+        for (size_t count = durable; count <= done && !matched; count++)
+        {
+            if (targetsMatch(stateAfter(base, ops, count), card.files))
+            {
+                matched = true;
+                totals.lostOps += static_cast<uint32_t>(done - count);
+            }
+        }
+        char message[96];
+        snprintf(message, sizeof(message), "workload %u, power cut at operation %ld", seed, point);
+        TEST_ASSERT_TRUE_MESSAGE(matched, message);
+
+        // Replay is idempotent: opening again applies nothing and changes no target
+        Files replayed = card.files;
+        {
+            WriteJournal journal(card.backend());
+            TEST_ASSERT_TRUE(journal.open(JOURNAL_PATH));
+            TEST_ASSERT_EQUAL_UINT32(0, journal.stats().replayedRecords);
+        }
+        TEST_ASSERT_TRUE_MESSAGE(targetsMatch(replayed, card.files), message);
+        return !finished;
+    }
+
+    double elapsedMicros(std::chrono::steady_clock::time_point start)
+    {
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    }
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_power_loss_at_every_operation_leaves_a_prefix()
+{
+    CrashTotals totals = { 0, 0, 0 };
+    for (uint32_t seed = 1; seed <= WORKLOADS; seed++)
+    {
+        std::vector<Op> ops = makeWorkload(seed);
+        for (long point = 0; crashAt(seed, point, ops, totals); point++)
+        {
+        }
+    }
+
+    char message[128];
+    snprintf(message, sizeof(message), "%u power cuts, %u left torn records, %u unflushed operations lost in total",
+             totals.runs, totals.tornRuns, totals.lostOps);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_GREATER_THAN(WORKLOADS * 20, totals.runs);
+    TEST_ASSERT_GREATER_THAN(0, totals.tornRuns);
+}
+
+void test_stale_records_behind_a_torn_batch_do_not_replay()
+{
+    MemoryStorage card;
+    Bytes big(3000, 'S');
+    Bytes small(10, 'n');
+    {
+        WriteJournal journal(card.backend());
+        TEST_ASSERT_TRUE(journal.open(JOURNAL_PATH));
+        for (int i = 0; i < 3; i++)
+        {
+            TEST_ASSERT_TRUE(journal.append("/s.txt", big.data(), big.size(), 0));
+            TEST_ASSERT_TRUE(journal.flush());
+        }
+        TEST_ASSERT_EQUAL_UINT32(9000, card.files["/s.txt"].size());
+
+        // The short batch tears, leaving older 3000-byte records further into the journal
+        TEST_ASSERT_TRUE(journal.append("/s.txt", small.data(), small.size(), 0));
+        card.powerLossAfter(0);
+        journal.flush();
+        card.cutPower();
+    }
+
+    card.restorePower();
+    {
+        WriteJournal journal(card.backend());
+        TEST_ASSERT_TRUE(journal.open(JOURNAL_PATH));
+    }
+    size_t length = card.files["/s.txt"].size();
+    TEST_ASSERT_TRUE(length == 9000 || length == 9010);
+
+    // A corrupt journal header restarts the journal without applying anything
+    card.files[JOURNAL_PATH][3] ^= 0xFF;
+    WriteJournal journal(card.backend());
+    TEST_ASSERT_TRUE(journal.open(JOURNAL_PATH));
+    TEST_ASSERT_EQUAL_UINT32(0, journal.stats().replayedRecords);
+    TEST_ASSERT_EQUAL_UINT32(length, card.files["/s.txt"].size());
+}
+
+void test_small_appends_are_coalesced()
+{
+    Bytes line(LINE_LENGTH, 'L');
+    for (uint8_t files = 1; files <= 2; files++)
+    {
+        // Open, append, sync and close per line, as the loggers used to
+        MemoryStorage direct;
+        StorageBackend backend = direct.backend();
+        auto start = std::chrono::steady_clock::now();
+        for (uint16_t i = 0; i < BENCH_LINES; i++)
+        {
+            StorageBackend::Handle file = backend.open(backend.context, TARGETS[i % files], true);
+            backend.write(backend.context, file, backend.size(backend.context, file), line.data(), line.size());
+            backend.sync(backend.context, file);
+            backend.close(backend.context, file);
+        }
+        double directMicros = elapsedMicros(start);
+
+        MemoryStorage journaled;
+        WriteJournal journal(journaled.backend());
+        TEST_ASSERT_TRUE(journal.open(JOURNAL_PATH));
+        journaled.resetCounters();
+        start = std::chrono::steady_clock::now();
+        for (uint16_t i = 0; i < BENCH_LINES; i++)
+        {
+            TEST_ASSERT_TRUE(journal.append(TARGETS[i % files], line.data(), line.size(), i));
+        }
+        TEST_ASSERT_TRUE(journal.flush());
+        double journalMicros = elapsedMicros(start);
+
+        char message[192];
+        snprintf(message, sizeof(message),
+                 "%u file(s): direct %u opens %u sectors %u syncs (%.0f us); journal %u opens %u sectors %u syncs, %u flushes (%.0f us)",
+                 files, direct.opens, direct.sectorWrites, direct.syncs, directMicros,
+                 journaled.opens, journaled.sectorWrites, journaled.syncs, journal.stats().flushes, journalMicros);
+        TEST_MESSAGE(message);
+        TEST_ASSERT_EQUAL_UINT32(BENCH_LINES * LINE_LENGTH / files, journaled.files[TARGETS[0]].size());
+        TEST_ASSERT_TRUE(journaled.sectorWrites * 3 < direct.sectorWrites);
+        TEST_ASSERT_TRUE(journaled.syncs * 10 < direct.syncs);
+        TEST_ASSERT_TRUE(journaled.opens * 10 < direct.opens);
+    }
+}
+
+int main()
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_power_loss_at_every_operation_leaves_a_prefix);
+    RUN_TEST(test_stale_records_behind_a_torn_batch_do_not_replay);
+    RUN_TEST(test_small_appends_are_coalesced);
+    return UNITY_END();
+}